@@ -566,6 +566,242 @@ def test_delete_aci_with_invalid_syntax(topo_fn, request):
     assert invalid_aci not in suffix.get_attr_vals_utf8('aci')
 
 
+def test_eval_cache(request, topo):
+    """Test that repeated access checks are answered from the ACI evaluation cache
+
+    :id: 3b9e7c41-2f6a-4d8e-b1c5-7a0d9e4f2c68
+    :setup: Standalone Instance
+    :steps:
+        1. Enable the evaluation cache and restart
+        2. Replace the suffix acis with a read aci on cn, sn and uid
+        3. Bind as a user and search the same entry twice
+        4. Check the cache counters under cn=ACL Plugin,cn=monitor
+        5. Remove the aci and search again
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Attributes are returned both times
+        4. EvalCacheHits is greater than zero
+        5. No attributes are returned and the cache was flushed
+    """
+
+    ACI = ('(targetattr = "cn || sn || uid")(version 3.0; acl "Eval cache read"; '
+           'allow (read,search,compare) (userdn = "ldap:///all");)')
+
+    acl_plugin = ACLPlugin(topo.standalone)
+    suffix = Domain(topo.standalone, DEFAULT_SUFFIX)
+    preserved_acis = suffix.get_attr_vals_utf8('aci')
+
+    def fin():
+        domain = Domain(topo.standalone, DEFAULT_SUFFIX)
+        try:
+            domain.remove_all('aci')
+            domain.replace_values('aci', preserved_acis)
+        except:
+            pass
+        acl_plugin.remove_all('nsslapd-acl-eval-cache-size')
+        topo.standalone.restart()
+    request.addfinalizer(fin)
+
+    acl_plugin.replace('nsslapd-acl-eval-cache-size', '1000')
+    topo.standalone.restart()
+
+    suffix.remove_all('aci')
+    suffix.add('aci', ACI)
+
+    users = UserAccounts(topo.standalone, DEFAULT_SUFFIX)
+    user = users.create_test_user(uid=2001)
+    user.set('userPassword', PW_DM)
+    request.addfinalizer(user.delete)
+
+    conn = UserAccount(topo.standalone, user.dn).bind(PW_DM)
+    for _ in range(2):
+        assert UserAccount(conn, user.dn).get_attr_val_utf8('sn')
+
+    monitor = DSLdapObject(topo.standalone, 'cn=ACL Plugin,cn=monitor')
+    assert int(monitor.get_attr_val_utf8('EvalCacheHits')) > 0
+    invalidations = int(monitor.get_attr_val_utf8('EvalCacheInvalidations'))
+
+    suffix.remove('aci', ACI)
+    assert UserAccount(conn, user.dn).get_attr_val_utf8('sn') is None
+    assert int(monitor.get_attr_val_utf8('EvalCacheInvalidations')) > invalidations
+
+
+OUTER = "ou=aci_outer,{}".format(DEFAULT_SUFFIX)
+MIDDLE = "ou=aci_middle,{}".format(OUTER)
+INNER = "ou=aci_inner,{}".format(MIDDLE)
+
+
+@pytest.fixture(scope="function")
+def nested_containers(request, topo):
+    """Three nested containers carrying an aci each, one user per
+    container and a user bound to read them.
+
+    outer allows reading everything but userPassword, middle denies sn,
+    inner denies description and cn.
+    """
+    inst = topo.standalone
+    suffix = Domain(inst, DEFAULT_SUFFIX)
+    preserved_acis = suffix.get_attr_vals_utf8('aci')
+    suffix.remove_all('aci')
+
+    containers = [
+        (OUTER, 'aci_outer', '(targetattr != "userPassword")(version 3.0; acl "outer read"; '
+                             'allow (read,search,compare) (userdn = "ldap:///all");)'),
+        (MIDDLE, 'aci_middle', '(targetattr = "sn")(version 3.0; acl "middle deny sn"; '
+                               'deny (read,search,compare) (userdn = "ldap:///all");)'),
+        (INNER, 'aci_inner', '(targetattr = "description || cn")(version 3.0; acl "inner deny"; '
+                             'deny (read,search,compare) (userdn = "ldap:///all");)'),
+    ]
+    for dn, ou, aci in containers:
+        OrganizationalUnit(inst, dn).create(properties={'ou': ou, 'aci': aci})
+
+    for i, dn in enumerate((OUTER, MIDDLE, INNER)):
+        users = UserAccounts(inst, DEFAULT_SUFFIX, rdn=dn[:-len(DEFAULT_SUFFIX) - 1])
+        users.create(properties={
+            'uid': 'aci_user_{}'.format(i),
+            'cn': 'aci_user_{}'.format(i),
+            'cn;lang-en': 'aci user {}'.format(i),
+            'sn': 'user',
+            'description': 'level {}'.format(i),
+            'uidNumber': str(3000 + i),
+            'gidNumber': '2000',
+            'homeDirectory': '/home/aci_user_{}'.format(i),
+        })
+
+    reader = UserAccounts(inst, DEFAULT_SUFFIX).create_test_user(uid=3100)
+    reader.set('userPassword', PW_DM)
+
+    def fin():
+        reader.delete()
+        DSLdapObject(inst, OUTER).delete(recursive=True)
+        domain = Domain(inst, DEFAULT_SUFFIX)
+        domain.remove_all('aci')
+        domain.replace_values('aci', preserved_acis)
+
+    request.addfinalizer(fin)
+    return reader.bind(PW_DM)
+
+
+def _visible(conn, base, uid, scope=ldap.SCOPE_SUBTREE):
+    """Returns the attribute types of uid readable by conn below base"""
+    entries = conn.search_s(base, scope, '(uid={})'.format(uid), ['*'])
+    assert len(entries) == 1
+    return {a.lower() for a in entries[0].getAttrs()}
+
+
+def test_nested_aci_containers(topo, nested_containers):
+    """Check that the acis of all the containers above an entry apply
+
+    :id: 5d2a8f16-3c47-4b9e-a0d1-8e6f2b7c9a34
+    :setup: Standalone Instance
+    :steps:
+        1. Create three nested containers, each with an aci and a user
+        2. Search each user from the suffix
+        3. Search the users from the middle container
+        4. Search the middle user with the middle container as base
+    :expectedresults:
+        1. Success
+        2. Each user is restricted by the acis of all its containers
+        3. The acis above the search base still apply, the ones below it too
+        4. The aci of the base container applies
+    """
+    conn = nested_containers
+
+    attrs = _visible(conn, DEFAULT_SUFFIX, 'aci_user_0')
+    assert {'sn', 'description', 'cn'} <= attrs
+    attrs = _visible(conn, DEFAULT_SUFFIX, 'aci_user_1')
+    assert 'sn' not in attrs
+    assert {'description', 'cn'} <= attrs
+    attrs = _visible(conn, DEFAULT_SUFFIX, 'aci_user_2')
+    assert not {'sn', 'description', 'cn'} & attrs
+    assert 'uid' in attrs
+
+    # The lookup stops at the search base, the acis of the containers
+    # above it come from the base handles
+    attrs = _visible(conn, MIDDLE, 'aci_user_1')
+    assert 'sn' not in attrs
+    assert {'uid', 'description'} <= attrs
+    attrs = _visible(conn, MIDDLE, 'aci_user_2')
+    assert not {'sn', 'description', 'cn'} & attrs
+    assert 'uid' in attrs
+    attrs = _visible(conn, INNER, 'aci_user_2', ldap.SCOPE_ONELEVEL)
+    assert not {'sn', 'description', 'cn'} & attrs
+    assert 'uid' in attrs
+
+    entries = conn.search_s(MIDDLE, ldap.SCOPE_BASE, '(objectclass=*)', ['*'])
+    assert len(entries) == 1
+    assert entries[0].hasAttr('ou')
+
+
+def test_modrdn_aci_container(topo, nested_containers):
+    """Check that the acis of a container follow it when it is renamed
+
+    :id: 9b4e1c73-6f28-4d05-8a9e-c2d7f3b1e580
+    :setup: Standalone Instance
+    :steps:
+        1. Create three nested containers, each with an aci and a user
+        2. Rename the inner container
+        3. Search its user
+        4. Move the inner container directly under the outer one
+        5. Search its user and the user of the middle container
+    :expectedresults:
+        1. Success
+        2. Success
+        3. The aci of the inner container still applies under its new dn
+        4. Success
+        5. The aci of the middle container no longer applies to the
+           moved user, the one of the inner container still does and
+           it no longer applies below the middle container
+    """
+    inst = topo.standalone
+    conn = nested_containers
+
+    OrganizationalUnit(inst, INNER).rename('ou=aci_inner_renamed')
+    attrs = _visible(conn, DEFAULT_SUFFIX, 'aci_user_2')
+    assert not {'sn', 'description', 'cn'} & attrs
+    assert 'uid' in attrs
+
+    inner = "ou=aci_inner_renamed,{}".format(MIDDLE)
+    attrs = _visible(conn, inner, 'aci_user_2', ldap.SCOPE_ONELEVEL)
+    assert not {'sn', 'description', 'cn'} & attrs
+
+    OrganizationalUnit(inst, inner).rename('ou=aci_inner_renamed', newsuperior=OUTER)
+    attrs = _visible(conn, DEFAULT_SUFFIX, 'aci_user_2')
+    assert 'sn' in attrs
+    assert not {'description', 'cn'} & attrs
+    # the middle container is left with its own aci only
+    attrs = _visible(conn, MIDDLE, 'aci_user_1')
+    assert 'sn' not in attrs
+    assert {'description', 'cn'} <= attrs
+
+
+def test_targetattr_matches_subtypes(topo, nested_containers):
+    """Check that a targetattr names the subtypes of its attributes too
+
+    :id: 2e7c5a90-d41b-4f3a-96e8-1b0f4c8d7e25
+    :setup: Standalone Instance
+    :steps:
+        1. Create a user with cn;lang-en below a container denying cn
+        2. Read cn;lang-en of that user
+        3. Read cn;lang-en of a user outside of that container
+    :expectedresults:
+        1. Success
+        2. The value is not returned
+        3. The value is returned
+    """
+    conn = nested_containers
+
+    entries = conn.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(uid=aci_user_2)', ['cn;lang-en'])
+    assert len(entries) == 1
+    assert not entries[0].hasAttr('cn;lang-en')
+    assert not entries[0].hasAttr('cn')
+
+    entries = conn.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(uid=aci_user_1)', ['cn;lang-en'])
+    assert len(entries) == 1
+    assert entries[0].getValue('cn;lang-en') == b'aci user 1'
+
+
 if __name__ == "__main__":
     CURRENT_FILE = os.path.realpath(__file__)
     pytest.main("-s -v %s" % CURRENT_FILE)
@@ -23,6 +23,7 @@ from lib389.dbgen import dbgen_users
 from lib389.tasks import BackupTask, RestoreTask
 from lib389.config import BDB_LDBMConfig
 from lib389.idm.nscontainer import nsContainers
+from lib389.idm.user import UserAccounts
 from lib389 import DSEldif
 from lib389.utils import ds_is_older, get_default_db_lib
 from lib389.replica import ReplicationManager
@@ -389,6 +390,67 @@ def test_online_backup_and_dse_write(topo):
     event.clear()
 
 
+@pytest.mark.skipif(get_default_db_lib() != "mdb", reason="Incremental backups need lmdb")
+def test_incremental_backup(topo):
+    """Test that an incremental backup only stores the changed pages
+    and restores the database as it was when it was taken.
+
+    :id: 8f1864e4-526f-405e-b94a-bbf8ff0a51be
+    :setup: Standalone Instance
+    :steps:
+        1. Perform a compressed full backup
+        2. Add some users
+        3. Perform an incremental backup based on the full one
+        4. Delete the users
+        5. Move both backups to another directory
+        6. Restore the incremental backup
+        7. Check that the users are back
+    :expectedresults:
+        1. Success and the database map is compressed
+        2. Success
+        3. Success, only a page delta is stored and the base is relative
+        4. Success
+        5. Success
+        6. Success
+        7. Success
+    """
+    inst = topo.standalone
+    backup_dir = inst.ds_paths.backup_dir
+    full = os.path.join(backup_dir, "full-%s" % datetime.now().strftime("%Y_%m_%d_%H_%M_%S"))
+    incr = full.replace("full-", "incr-")
+
+    assert inst.tasks.db2bak(backup_dir=full, args={TASK_WAIT: True, 'compress': True}) == 0
+    assert os.path.exists(os.path.join(full, "data.mdb.gz"))
+
+    users = UserAccounts(inst, DEFAULT_SUFFIX)
+    for i in range(20):
+        users.create_test_user(uid=5000 + i)
+
+    assert inst.tasks.db2bak(backup_dir=incr, args={TASK_WAIT: True, 'incremental_base': full}) == 0
+    assert os.path.exists(os.path.join(incr, "data.mdb.delta"))
+    assert not os.path.exists(os.path.join(incr, "data.mdb"))
+    with open(os.path.join(incr, "data.mdb.base")) as base_file:
+        assert base_file.read().strip() == os.path.join("..", os.path.basename(full))
+
+    for i in range(20):
+        users.get('test_user_%d' % (5000 + i)).delete()
+
+    # The chain of backups still restores once moved elsewhere
+    moved = os.path.join(backup_dir, "moved-%s" % datetime.now().strftime("%Y_%m_%d_%H_%M_%S"))
+    os.mkdir(moved)
+    backup_stat = os.stat(backup_dir)
+    os.chown(moved, backup_stat.st_uid, backup_stat.st_gid)
+    shutil.move(full, moved)
+    shutil.move(incr, moved)
+    incr = os.path.join(moved, os.path.basename(incr))
+
+    assert inst.tasks.bak2db(backup_dir=incr, args={TASK_WAIT: True}) == 0
+    for i in range(20):
+        assert users.get('test_user_%d' % (5000 + i))
+
+    shutil.rmtree(moved, ignore_errors=True)
+
+
 if __name__ == '__main__':
     # Run isolated
     # -s for DEBUG mode
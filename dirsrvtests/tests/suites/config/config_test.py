@@ -11,6 +11,9 @@ import logging
 import pytest
 import os
 import ldap
+import signal
+import threading
+import time
 from lib389 import DirSrv, pid_from_file
 from lib389.dseldif import DSEldif
 from lib389.tasks import *
@@ -24,11 +27,12 @@ from lib389.cli_base import FakeArgs
 from lib389.cli_conf.backend import db_config_set
 from lib389.idm.user import UserAccounts, TEST_USER_PROPERTIES
 from lib389.idm.group import Groups
+from lib389.idm.nscontainer import nsContainer
 from lib389.instance.setup import SetupDs
 from lib389.config import LDBMConfig, BDB_LDBMConfig, Config
 from lib389.cos import CosPointerDefinitions, CosTemplates
 from lib389.backend import Backends, DatabaseConfig
-from lib389.monitor import MonitorLDBM, Monitor
+from lib389.monitor import MonitorLDBM, Monitor, MonitorDatabase
 from lib389.plugins import ReferentialIntegrityPlugin
 from lib389.replica import BootstrapReplicationManager, Replicas
 from lib389.passwd import password_generate
@@ -1043,6 +1047,60 @@ def test_lmdb_config(create_lmdb_instance):
     set_and_check(inst, db_config, 'mdb_max_dbs', 'nsslapd-mdb-max-dbs', 200)
 
 
+def test_lmdb_group_commit(create_lmdb_instance):
+    """Verify that LMDB group commit can be enabled and keeps the writes
+
+    :id: 3a7c9e15-4d2b-4f8a-b6e1-9c0d5f2a8e47
+    :setup: Custom instance named 'i_lmdb' having db_lib=mdb
+    :steps:
+        1. Enable nsslapd-mdb-group-commit, set the batch size and window
+        2. Restart the instance
+        3. Add users from concurrent connections
+        4. Restart the instance and check the users are there
+        5. Check that groupCommitSyncs is reported by the database monitor
+        6. Disable nsslapd-mdb-group-commit and restart
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Success
+        4. Success
+        5. Success
+        6. Success
+    """
+
+    inst = create_lmdb_instance
+    db_config = DatabaseConfig(inst)
+    set_and_check(inst, db_config, 'mdb_group_commit', 'nsslapd-mdb-group-commit', 'on')
+    set_and_check(inst, db_config, 'mdb_group_commit_batch_size', 'nsslapd-mdb-group-commit-batch-size', 8)
+    set_and_check(inst, db_config, 'mdb_group_commit_window', 'nsslapd-mdb-group-commit-window', 2000)
+    inst.restart()
+
+    def add_users(idx):
+        conn = inst.clone()
+        conn.open()
+        users = UserAccounts(conn, DEFAULT_SUFFIX)
+        for i in range(20):
+            users.create_test_user(uid=1000 + idx * 100 + i)
+        conn.close()
+
+    threads = [threading.Thread(target=add_users, args=(idx,)) for idx in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+
+    inst.restart()
+    users = UserAccounts(inst, DEFAULT_SUFFIX)
+    assert len([u for u in users.list() if u.get_attr_val_utf8('uid').startswith('test_user_1')]) == 80
+
+    monitor = MonitorDatabase(inst)
+    status = monitor.get_status()
+    assert 'groupcommitsyncs' in status
+
+    set_and_check(inst, db_config, 'mdb_group_commit', 'nsslapd-mdb-group-commit', 'off')
+    inst.restart()
+
+
 def test_numlisteners_limit(topo):
     """Test higher limit of nsslapd-numlisteners than 4
     DS allows a higher value of nsslapd-numlisteners than it's limit of 4
@@ -1103,6 +1161,158 @@ def test_numlisteners_limit(topo):
     assert numlisteners[0] == '4'
 
 
+def test_result_batch(topo):
+    """Test that batched search result entries are all returned
+
+    :id: 0f8a6d2c-93b1-4c52-8e7a-5f4d1c2b9a61
+    :setup: Standalone Instance
+    :steps:
+        1. Check the default nsslapd-result-batch-size, nsslapd-result-batch-entries
+           and nsslapd-result-batch-delay values
+        2. Set invalid nsslapd-result-batch-entries and nsslapd-result-batch-delay values
+        3. Add 100 users
+        4. Search them with several batch thresholds and delays, batching disabled included
+        5. Search them with a size limit
+    :expectedresults:
+        1. The defaults are 65536, 256 and 50
+        2. The values are rejected
+        3. Success
+        4. All the users are returned every time
+        5. The size limit is returned after the limited entries
+    """
+    inst = topo.standalone
+    assert inst.config.get_attr_val_utf8('nsslapd-result-batch-size') == '65536'
+    assert inst.config.get_attr_val_utf8('nsslapd-result-batch-entries') == '256'
+    assert inst.config.get_attr_val_utf8('nsslapd-result-batch-delay') == '50'
+
+    with pytest.raises(ldap.LDAPError):
+        inst.config.replace('nsslapd-result-batch-entries', '-1')
+    with pytest.raises(ldap.LDAPError):
+        inst.config.replace('nsslapd-result-batch-delay', '0')
+
+    users = UserAccounts(inst, DEFAULT_SUFFIX, rdn=None)
+    for idx in range(100):
+        users.create_test_user(uid=5000 + idx)
+    search_filter = '(uid=test_user_5*)'
+
+    for (size, entries, delay) in [('65536', '256', '50'), ('1024', '7', '50'), ('0', '256', '50'),
+                                   ('65536', '1', '50'), ('65536', '256', '1')]:
+        inst.config.replace('nsslapd-result-batch-size', size)
+        inst.config.replace('nsslapd-result-batch-entries', entries)
+        inst.config.replace('nsslapd-result-batch-delay', delay)
+        found = inst.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, search_filter, ['uid'])
+        assert len(found) == 100
+
+    inst.config.replace('nsslapd-result-batch-size', '65536')
+    inst.config.replace('nsslapd-result-batch-entries', '7')
+    with pytest.raises(ldap.SIZELIMIT_EXCEEDED):
+        inst.search_ext_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, search_filter, ['uid'], sizelimit=10)
+
+    inst.config.replace('nsslapd-result-batch-entries', '256')
+    inst.config.replace('nsslapd-result-batch-delay', '50')
+    for user in users.list():
+        if user.get_attr_val_utf8('uid').startswith('test_user_5'):
+            user.delete()
+
+
+def test_dse_journal(topo):
+    """Test that the changes kept in the dse.ldif journal survive a crash
+
+    :id: 4d4d5742-3bd9-44a2-aad4-10d144195487
+    :setup: Standalone Instance
+    :steps:
+        1. Check the default nsslapd-dse-journal-delay value
+        2. Set nsslapd-dse-journal-delay to 3600 and change several config attributes
+        3. Check dse.ldif and its journal
+        4. Kill the server and start it again
+        5. Check the config attributes and dse.ldif
+        6. Add two entries under cn=config, delete one of them and append
+           a record that was not completely written to the journal
+        7. Kill the server and start it again
+        8. Change a config attribute, kill the server and edit dse.ldif
+        9. Start the server
+        10. Change a config attribute and restart the server
+    :expectedresults:
+        1. The default is 0
+        2. Success
+        3. The changes are in the journal but not in dse.ldif yet
+        4. Success
+        5. The changes were applied from the journal
+        6. Success
+        7. The added entry is there, the deleted entry and the torn
+           record are not
+        8. Success
+        9. The journal no longer applies to dse.ldif: it is moved to
+           dse.ldif.journal.ignored and the edit of dse.ldif is kept
+        10. The journal is written to dse.ldif at shutdown
+    """
+    inst = topo.standalone
+    journal = os.path.join(inst.ds_paths.config_dir, 'dse.ldif.journal')
+    assert inst.config.get_attr_val_utf8('nsslapd-dse-journal-delay') == '0'
+
+    inst.config.replace('nsslapd-dse-journal-delay', '3600')
+    for value in ['101', '102', '103']:
+        inst.config.replace('nsslapd-sizelimit', value)
+    inst.config.replace('nsslapd-lookthroughlimit', '7001')
+
+    assert os.path.exists(journal)
+    dse_ldif = DSEldif(inst)
+    assert dse_ldif.get(DN_CONFIG, 'nsslapd-sizelimit', single=True) != '103'
+
+    os.kill(pid_from_file(inst.pid_file()), signal.SIGKILL)
+    time.sleep(5)
+    inst.start()
+    assert inst.config.get_attr_val_utf8('nsslapd-sizelimit') == '103'
+    assert inst.config.get_attr_val_utf8('nsslapd-lookthroughlimit') == '7001'
+    assert inst.config.get_attr_val_utf8('nsslapd-dse-journal-delay') == '3600'
+    dse_ldif = DSEldif(inst)
+    assert dse_ldif.get(DN_CONFIG, 'nsslapd-sizelimit', single=True) == '103'
+
+    log.info('Check the deleted entries and a torn record')
+    kept = nsContainer(inst, 'cn=journal_kept,cn=config')
+    kept.create(properties={'cn': 'journal_kept'})
+    gone = nsContainer(inst, 'cn=journal_gone,cn=config')
+    gone.create(properties={'cn': 'journal_gone'})
+    gone.delete()
+    assert os.path.exists(journal)
+    with open(journal, 'a') as f:
+        f.write('dn: cn=journal_torn,cn=config\nobjectClass: top\nobjectClass: nsContainer\n')
+
+    os.kill(pid_from_file(inst.pid_file()), signal.SIGKILL)
+    time.sleep(5)
+    inst.start()
+    assert kept.exists()
+    assert not gone.exists()
+    assert not nsContainer(inst, 'cn=journal_torn,cn=config').exists()
+    dse_ldif = DSEldif(inst)
+    assert dse_ldif.get('cn=journal_kept,cn=config', 'cn', single=True) == 'journal_kept'
+    assert dse_ldif.get('cn=journal_gone,cn=config', 'cn') is None
+    assert dse_ldif.get('cn=journal_torn,cn=config', 'cn') is None
+    kept.delete()
+
+    log.info('Check that a journal older than dse.ldif is set aside')
+    ignored = journal + '.ignored'
+    inst.config.replace('nsslapd-sizelimit', '555')
+    assert os.path.exists(journal)
+    os.kill(pid_from_file(inst.pid_file()), signal.SIGKILL)
+    time.sleep(5)
+    DSEldif(inst).replace(DN_CONFIG, 'nsslapd-sizelimit', '777')
+    inst.start()
+    assert os.path.exists(ignored)
+    assert not os.path.exists(journal)
+    assert inst.config.get_attr_val_utf8('nsslapd-sizelimit') == '777'
+    os.remove(ignored)
+
+    inst.config.replace('nsslapd-sizelimit', '2000')
+    inst.config.replace('nsslapd-lookthroughlimit', '5000')
+    assert os.path.exists(journal)
+    inst.restart()
+    assert not os.path.exists(journal)
+    dse_ldif = DSEldif(inst)
+    assert dse_ldif.get(DN_CONFIG, 'nsslapd-sizelimit', single=True) == '2000'
+    inst.config.replace('nsslapd-dse-journal-delay', '0')
+
+
 def bootstrap_replication(inst_from, inst_to, creds):
     manager = BootstrapReplicationManager(inst_to)
     rdn_val = 'replication manager'
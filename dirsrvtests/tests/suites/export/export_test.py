@@ -11,6 +11,7 @@ import pytest
 import subprocess
 import ldap
 from lib389.idm.organizationalunit import OrganizationalUnit
+from lib389.backend import DatabaseConfig
 from test389.topologies import topology_st as topo
 from lib389._constants import DEFAULT_SUFFIX, DEFAULT_BENAME
 from lib389.utils import *
@@ -181,3 +182,205 @@ def test_db2ldif_preserves_dn_case_in_exported_ldif(topo):
     test_ou.delete()
     if os.path.exists(export_ldif):
         os.remove(export_ldif)
+
+
+def test_db2ldif_binary_id2entry_format(topo):
+    """Entries stored in the binary id2entry format are read back and exported
+
+    :id: 5c0f3b0e-3d55-4c1e-9a53-1f7f8e2c6a41
+    :setup: Standalone Instance
+    :steps:
+        1. Enable nsslapd-id2entry-binary-format
+        2. Add an organizational unit and modify it
+        3. Restart the server to empty the entry cache
+        4. Read the entry back
+        5. Perform an offline db2ldif export
+        6. Check the exported LDIF
+        7. Disable nsslapd-id2entry-binary-format and rewrite the entry
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Success
+        4. The entry is decoded from its binary record with all its values
+        5. Offline export succeeds
+        6. The entry is exported as regular LDIF
+        7. The entry is still readable after being written back as LDIF
+    """
+    inst = topo.standalone
+    inst.start()
+    db_config = DatabaseConfig(inst)
+    db_config.set([('nsslapd-id2entry-binary-format', 'on')])
+
+    test_dn = f"ou=test_binary_format,{DEFAULT_SUFFIX}"
+    export_ldif = os.path.join(inst.get_ldif_dir(), "export_binary_format.ldif")
+    test_ou = OrganizationalUnit(inst, test_dn)
+    test_ou.create(properties={'ou': 'test_binary_format',
+                               'description': ['first', 'second', 'd\u00e9j\u00e0 vu']})
+    test_ou.remove('description', 'second')
+
+    inst.restart()
+    assert sorted(test_ou.get_attr_vals_utf8('description')) == sorted(['first', 'd\u00e9j\u00e0 vu'])
+    assert test_ou.get_attr_val_utf8('nsUniqueId')
+
+    inst.stop()
+    try:
+        assert inst.db2ldif(DEFAULT_BENAME, (DEFAULT_SUFFIX,), None, None, None, export_ldif)
+    finally:
+        inst.start()
+
+    with open(export_ldif, "r", encoding="utf-8") as export_file:
+        content = export_file.read()
+    assert f"dn: {test_dn}" in content
+    assert "description: first" in content
+    assert "description: second" not in content
+
+    db_config.set([('nsslapd-id2entry-binary-format', 'off')])
+    test_ou.replace('description', 'third')
+    inst.restart()
+    assert test_ou.get_attr_vals_utf8('description') == ['third']
+
+    test_ou.delete()
+    if os.path.exists(export_ldif):
+        os.remove(export_ldif)
+
+
+
+def test_binary_id2entry_format_moved_subtree(topo):
+    """A subtree moved under a newer parent is exported and reindexed from binary records
+
+    :id: 0b7c1f62-5a7e-4f0d-b3b1-7d2b9a6e4c18
+    :setup: Standalone Instance
+    :steps:
+        1. Enable nsslapd-id2entry-binary-format
+        2. Add a subtree, then a new parent, and move the subtree under it
+        3. Perform an offline db2ldif export
+        4. Check the exported LDIF
+        5. Reindex entryrdn offline
+        6. Search the moved subtree
+    :expectedresults:
+        1. Success
+        2. The new parent has a higher ID than the moved entries
+        3. Offline export succeeds
+        4. The moved entries are exported with their new DN, after their parent
+        5. Success
+        6. The moved entries are found under their new parent
+    """
+    inst = topo.standalone
+    inst.start()
+    db_config = DatabaseConfig(inst)
+    db_config.set([('nsslapd-id2entry-binary-format', 'on')])
+
+    export_ldif = os.path.join(inst.get_ldif_dir(), "export_binary_moved.ldif")
+    old_parent = OrganizationalUnit(inst, f"ou=binary_old_parent,{DEFAULT_SUFFIX}")
+    old_parent.create(properties={'ou': 'binary_old_parent'})
+    mover = OrganizationalUnit(inst, f"ou=binary_mover,{old_parent.dn}")
+    mover.create(properties={'ou': 'binary_mover'})
+    leaf = OrganizationalUnit(inst, f"ou=binary_leaf,{mover.dn}")
+    leaf.create(properties={'ou': 'binary_leaf'})
+    new_parent = OrganizationalUnit(inst, f"ou=binary_new_parent,{DEFAULT_SUFFIX}")
+    new_parent.create(properties={'ou': 'binary_new_parent'})
+    mover.rename('ou=binary_mover', newsuperior=new_parent.dn)
+    moved_dn = f"ou=binary_mover,{new_parent.dn}"
+    leaf_dn = f"ou=binary_leaf,{moved_dn}"
+
+    inst.stop()
+    try:
+        assert inst.db2ldif(DEFAULT_BENAME, (DEFAULT_SUFFIX,), None, None, None, export_ldif)
+        assert inst.db2index(DEFAULT_BENAME, attrs=['entryrdn'])
+    finally:
+        inst.start()
+
+    with open(export_ldif, "r", encoding="utf-8") as export_file:
+        content = export_file.read().replace('\n ', '')
+    dns = [line[4:].lower() for line in content.splitlines() if line.startswith('dn: ')]
+    assert moved_dn.lower() in dns
+    assert leaf_dn.lower() in dns
+    assert dns.index(new_parent.dn.lower()) < dns.index(moved_dn.lower()) < dns.index(leaf_dn.lower())
+
+    assert OrganizationalUnit(inst, moved_dn).exists()
+    assert OrganizationalUnit(inst, leaf_dn).exists()
+    found = inst.search_s(new_parent.dn, ldap.SCOPE_SUBTREE, '(ou=binary_leaf)', ['ou'])
+    assert [e.dn.lower() for e in found] == [leaf_dn.lower()]
+
+    db_config.set([('nsslapd-id2entry-binary-format', 'off')])
+    OrganizationalUnit(inst, leaf_dn).delete()
+    OrganizationalUnit(inst, moved_dn).delete()
+    new_parent.delete()
+    old_parent.delete()
+    os.remove(export_ldif)
+
+def test_db2ldif_compressed_parallel_export(topo):
+    """Export the database to a gzip compressed LDIF with several formatting threads
+
+    :id: 0c6f4f0e-8b52-11f0-a4c1-482ae39447e5
+    :setup: Standalone Instance
+    :steps:
+        1. Add some organizational units, some of them with a child unit, and
+           move a unit added first under the last one
+        2. With lmdb, set nsslapd-mdb-export-threads to 4
+        3. Perform an offline db2ldif export with compression
+        4. Check the exported LDIF
+        5. Reset nsslapd-mdb-export-threads
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Offline export succeeds and the LDIF file name ends with .gz
+        4. The LDIF is gzip compressed, contains all the entries and the
+           parents are exported before their children
+        5. Success
+    """
+    import gzip
+
+    inst = topo.standalone
+    inst.start()
+    db_config = DatabaseConfig(inst)
+    ous = []
+    children = []
+    # Added first, so that its id is lower than the one of its parent once moved
+    moved = OrganizationalUnit(inst, f"ou=test_compressed_moved,{DEFAULT_SUFFIX}")
+    moved.create(properties={'ou': 'test_compressed_moved'})
+    for i in range(50):
+        ou = OrganizationalUnit(inst, f"ou=test_compressed_{i},{DEFAULT_SUFFIX}")
+        ou.create(properties={'ou': f'test_compressed_{i}'})
+        ous.append(ou)
+    for i in range(0, 50, 5):
+        child = OrganizationalUnit(inst, f"ou=child_{i},ou=test_compressed_{i},{DEFAULT_SUFFIX}")
+        child.create(properties={'ou': f'child_{i}'})
+        children.append(child)
+    moved.rename('ou=test_compressed_moved', newsuperior=f"ou=test_compressed_49,{DEFAULT_SUFFIX}")
+    children.append(moved)
+    if get_default_db_lib() == "mdb":
+        db_config.set([('nsslapd-mdb-export-threads', '4')])
+
+    export_ldif = os.path.join(inst.get_ldif_dir(), "export_compressed.ldif")
+    inst.stop()
+    try:
+        assert inst.db2ldif(DEFAULT_BENAME, (DEFAULT_SUFFIX,), None, None, None, export_ldif, compress=True)
+    finally:
+        inst.start()
+
+    assert not os.path.exists(export_ldif)
+    with gzip.open(export_ldif + '.gz', 'rt', encoding='utf-8') as export_file:
+        # Unfold the continuation lines before picking the dns
+        content = export_file.read().replace('\n ', '')
+    dns = [line[4:].strip().lower() for line in content.splitlines() if line.startswith('dn: ')]
+    assert dns[0] == DEFAULT_SUFFIX.lower()
+    for i in range(50):
+        assert f"ou=test_compressed_{i},{DEFAULT_SUFFIX}".lower() in dns
+    for i in range(0, 50, 5):
+        assert f"ou=child_{i},ou=test_compressed_{i},{DEFAULT_SUFFIX}".lower() in dns
+    assert f"ou=test_compressed_moved,ou=test_compressed_49,{DEFAULT_SUFFIX}".lower() in dns
+    assert len(dns) == len(set(dns))
+
+    # Every entry comes after its parent, whatever thread formatted it
+    positions = {dn: pos for pos, dn in enumerate(dns)}
+    for pos, dn in enumerate(dns):
+        parent = dn.split(',', 1)[1] if ',' in dn else None
+        if parent in positions:
+            assert positions[parent] < pos, f"{dn} is exported before its parent"
+
+    if get_default_db_lib() == "mdb":
+        db_config.set([('nsslapd-mdb-export-threads', '0')])
+    for ou in children + ous:
+        ou.delete()
+    os.remove(export_ldif + '.gz')
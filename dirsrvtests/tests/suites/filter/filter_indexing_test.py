@@ -12,6 +12,7 @@ verify and testing  indexing Filter from a search
 """
 
 import os
+import ldap
 import pytest
 
 from lib389._constants import DEFAULT_SUFFIX, PW_DM
@@ -20,6 +21,7 @@ from lib389.idm.user import UserAccounts
 from lib389.idm.account import Accounts
 from lib389.cos import CosTemplates
 from lib389.schema import Schema
+from lib389.backend import DatabaseConfig
 
 pytestmark = pytest.mark.tier1
 
@@ -165,6 +167,176 @@ def test_indexing_negative(topo, _create_entries, real_value):
     assert not cos.filter(real_value)
 
 
+BITMAP_FILTERS = ["(objectclass=inetorgperson)",
+                  "(&(objectclass=inetorgperson)(sn=even))",
+                  "(|(sn=even)(sn=odd))",
+                  "(|(sn=even)(uid=bitmap_user_1*))",
+                  "(&(objectclass=inetorgperson)(!(sn=even)))",
+                  "(&(sn=odd)(!(uid=bitmap_user_1*)))",
+                  "(&(objectclass=person)(objectclass=inetorgperson)(sn=odd))"]
+
+
+def test_indexing_bitmap_idl(topo, _create_entries):
+    """Searches return the same entries when large id lists are kept as bitmaps
+
+    :id: 3f1c1a8e-6d7b-4b1e-9f0a-2c4e5d8b7a61
+    :setup: Standalone
+    :steps:
+        1. Add 60 users, half of them with sn=even and half with sn=odd
+        2. Run the filters with nsslapd-idl-bitmap-threshold set to 0
+        3. Set nsslapd-idl-bitmap-threshold to 10
+        4. Run the filters again
+        5. Restore nsslapd-idl-bitmap-threshold
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Success
+        4. Each filter returns the same entries as with plain id lists
+        5. Success
+    """
+    inst = topo.standalone
+    users = UserAccounts(inst, DEFAULT_SUFFIX)
+    for count in range(60):
+        users.create(properties={
+            'cn': f'bitmap_user_{count}',
+            'sn': 'even' if count % 2 == 0 else 'odd',
+            'uid': f'bitmap_user_{count}',
+            'uidNumber': f'{5000 + count}',
+            'gidNumber': f'{5000 + count}',
+            'homeDirectory': f'/home/bitmap_user_{count}',
+        })
+
+    db_config = DatabaseConfig(inst)
+    threshold = db_config.get_attr_val_utf8('nsslapd-idl-bitmap-threshold')
+    accounts = Accounts(inst, DEFAULT_SUFFIX)
+
+    db_config.set([('nsslapd-idl-bitmap-threshold', '0')])
+    expected = {}
+    for search_filter in BITMAP_FILTERS:
+        expected[search_filter] = sorted(a.dn for a in accounts.filter(search_filter))
+        assert expected[search_filter]
+
+    db_config.set([('nsslapd-idl-bitmap-threshold', '10')])
+    try:
+        for search_filter in BITMAP_FILTERS:
+            assert sorted(a.dn for a in accounts.filter(search_filter)) == expected[search_filter]
+    finally:
+        db_config.set([('nsslapd-idl-bitmap-threshold', threshold)])
+
+
+PLANNER_FILTERS = ["(&(objectclass=inetorgperson)(sn=planner_rare))",
+                   "(&(sn=planner_common)(uid=planner_user_7))",
+                   "(&(objectclass=person)(sn=planner_common)(!(uid=planner_user_1*)))",
+                   "(&(objectclass=inetorgperson)(|(sn=planner_rare)(uid=planner_user_3)))",
+                   "(&(objectclass=inetorgperson)(sn=planner_missing))"]
+
+
+def test_indexing_filter_planner(topo, _create_entries):
+    """AND filters return the same entries with and without the filter planner
+
+    :id: 8d2b7c4e-1f3a-4e6b-a5c9-0b7d9e2f4a13
+    :setup: Standalone
+    :steps:
+        1. Add 100 users, one of them with sn=planner_rare
+        2. Run the filters with nsslapd-filter-planner off
+        3. Turn nsslapd-filter-planner on
+        4. Run the filters again
+        5. Restore nsslapd-filter-planner
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Success
+        4. Each filter returns the same entries, even when the planner leaves
+           the objectclass component to the filter test
+        5. Success
+    """
+    inst = topo.standalone
+    users = UserAccounts(inst, DEFAULT_SUFFIX)
+    for count in range(100):
+        users.create(properties={
+            'cn': f'planner_user_{count}',
+            'sn': 'planner_rare' if count == 42 else 'planner_common',
+            'uid': f'planner_user_{count}',
+            'uidNumber': f'{6000 + count}',
+            'gidNumber': f'{6000 + count}',
+            'homeDirectory': f'/home/planner_user_{count}',
+        })
+
+    db_config = DatabaseConfig(inst)
+    planner = db_config.get_attr_val_utf8('nsslapd-filter-planner')
+    accounts = Accounts(inst, DEFAULT_SUFFIX)
+
+    db_config.set([('nsslapd-filter-planner', 'off')])
+    try:
+        expected = {}
+        for search_filter in PLANNER_FILTERS:
+            expected[search_filter] = sorted(a.dn for a in accounts.filter(search_filter))
+
+        db_config.set([('nsslapd-filter-planner', 'on')])
+        for search_filter in PLANNER_FILTERS:
+            assert sorted(a.dn for a in accounts.filter(search_filter)) == expected[search_filter]
+    finally:
+        db_config.set([('nsslapd-filter-planner', planner)])
+
+
+SCAN_FILTERS = ["(description=scan_*)",
+                "(&(objectclass=inetorgperson)(description=scan_even))",
+                "(|(description=scan_odd)(uid=planner_user_5))",
+                "(description=scan_missing)"]
+
+
+def test_indexing_parallel_scan(topo, _create_entries):
+    """Unindexed searches return the same entries with the search scan threads
+
+    :id: 2c6e9a1d-7b4f-4d30-8e52-f1a3c7b9d046
+    :setup: Standalone
+    :steps:
+        1. Add 300 users with an unindexed description value
+        2. Run unindexed filters without the search scan threads
+        3. Start 4 search scan threads, from 100 candidates
+        4. Run the filters again, with and without a size limit
+        5. Restore the configuration
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Success
+        4. Each filter returns the same entries, in the same order,
+           and the size limit still applies
+        5. Success
+    """
+    inst = topo.standalone
+    users = UserAccounts(inst, DEFAULT_SUFFIX)
+    for count in range(300):
+        users.create(properties={
+            'cn': f'scan_user_{count}',
+            'sn': 'scan_user',
+            'uid': f'scan_user_{count}',
+            'uidNumber': f'{7000 + count}',
+            'gidNumber': f'{7000 + count}',
+            'homeDirectory': f'/home/scan_user_{count}',
+            'description': 'scan_even' if count % 2 == 0 else 'scan_odd',
+        })
+
+    db_config = DatabaseConfig(inst)
+    accounts = Accounts(inst, DEFAULT_SUFFIX)
+    expected = {}
+    for search_filter in SCAN_FILTERS:
+        expected[search_filter] = [a.dn for a in accounts.filter(search_filter)]
+
+    db_config.set([('nsslapd-search-scan-threads', '4'),
+                   ('nsslapd-search-scan-min-candidates', '100')])
+    inst.restart()
+    try:
+        for search_filter in SCAN_FILTERS:
+            assert [a.dn for a in accounts.filter(search_filter)] == expected[search_filter]
+        with pytest.raises(ldap.SIZELIMIT_EXCEEDED):
+            inst.search_ext_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(description=scan_*)', sizelimit=10)
+    finally:
+        db_config.set([('nsslapd-search-scan-threads', '0'),
+                       ('nsslapd-search-scan-min-candidates', '10000')])
+        inst.restart()
+
+
 if __name__ == '__main__':
     CURRENT_FILE = os.path.realpath(__file__)
     pytest.main("-s -v %s" % CURRENT_FILE)
@@ -111,6 +111,31 @@ def test_sub(topology_st_f):
         ])
 
 
+def test_sub_any_final(topology_st_f):
+    """Test filter logic with "sub" using any and final components
+
+    :id: 5f0d6c1e-8a43-4b7e-9d2a-3c6e1f7b2a94
+    :setup: Standalone instance with 20 test users added
+            from uid=user0 to uid=user20
+    :steps:
+         1. Search for test users with filter ``(uid=*er1*)``
+         2. Search for test users with filter ``(uid=u*r*9)``
+         3. Search for test users with filter ``(uid=user1*1)``
+    :expectedresults:
+         1. There should be 11 users listed, user1 and user10 to user19
+         2. There should be 2 users listed, user9 and user19
+         3. There should be 1 user listed user11, the initial and final
+            components must not overlap
+    """
+    _check_filter(topology_st_f, '(uid=*er1*)', 11, [
+            USER1_DN, USER10_DN, USER11_DN, USER12_DN, USER13_DN,
+            USER14_DN, USER15_DN, USER16_DN, USER17_DN, USER18_DN,
+            USER19_DN
+        ])
+    _check_filter(topology_st_f, '(uid=u*r*9)', 2, [USER9_DN, USER19_DN])
+    _check_filter(topology_st_f, '(uid=user1*1)', 1, [USER11_DN])
+
+
 def test_not_eq(topology_st_f):
     """Test filter logic with "not equal to" operator
 
@@ -730,6 +730,47 @@ def test_crash_on_ldif2db_with_lmdb(topo, _import_clean):
         _import_offline(topo, 500_000)
     __check_for_core(now)
 
+@pytest.mark.skipif(get_default_db_lib() != "mdb", reason="lmdb specific test")
+def test_ldif2db_with_lmdb_sorted_runs(topo, _import_clean):
+    """Check that an offline import loading the indexes from sorted runs
+    gives the same result as a regular import.
+
+    :id: 3f0b7e52-8a4c-11f0-9d2e-482ae39447e5
+    :setup: Standalone Instance
+    :steps:
+        1. Set nsslapd-mdb-import-sorted-runs to on and lower
+           nsslapd-mdb-import-run-size to its minimum
+        2. Import an ldif with 1K users
+        3. Check that the index records were spilled to several runs
+        4. Check that indexed searches return the imported users
+        5. Check that no import run file is left in the db directory
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Success
+        4. Success
+        5. Success
+    """
+    inst = topo.standalone
+    handler = LMDB_LDBMConfig(inst)
+    handler.replace('nsslapd-mdb-import-sorted-runs', 'on')
+    # Small enough for the index records of 1K users to need several runs
+    handler.replace('nsslapd-mdb-import-run-size', '65536')
+    try:
+        _import_offline(topo, 1000)
+        merges = inst.ds_error_log.match(r'.*Merging [0-9]+ import runs spilled to disk.*')
+        assert merges
+        assert int(re.search(r'Merging ([0-9]+) import runs', merges[-1]).group(1)) > 1
+        accounts = Accounts(inst, DEFAULT_SUFFIX)
+        assert len(accounts.filter('(objectclass=posixAccount)')) == 1000
+        assert len(accounts.filter('(uidNumber=42)')) == 1
+        assert len(accounts.filter('(uid=*)')) == 1000
+        assert not glob.glob(f'{inst.dbdir}/*-import-run-*')
+    finally:
+        handler.replace('nsslapd-mdb-import-run-size', '67108864')
+        handler.replace('nsslapd-mdb-import-sorted-runs', 'off')
+
+
 def test_online_import_under_load(topo):
     """Perform an online import while the server is under load
 
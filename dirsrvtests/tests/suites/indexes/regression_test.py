@@ -15,7 +15,7 @@ import glob
 import re
 from lib389.backend import Backend, Backends, DatabaseConfig
 from lib389.cli_ctl.dblib import DbscanHelper
-from lib389.config import LDBMConfig
+from lib389.config import LDBMConfig, LMDB_LDBMConfig
 from lib389._constants import DEFAULT_BENAME, DEFAULT_SUFFIX, PW_DM, SER_ROOT_DN, SER_ROOT_PW
 from lib389.cos import CosClassicDefinition, CosTemplate
 from lib389.dbgen import dbgen_users
@@ -30,7 +30,7 @@ from lib389.plugins import MemberOfPlugin
 from lib389.properties import TASK_WAIT
 from lib389.tasks import Tasks, Task
 from test389.topologies import topology_st as topo
-from lib389.utils import ds_is_older
+from lib389.utils import ds_is_older, get_default_db_lib
 
 pytestmark = pytest.mark.tier1
 
@@ -1335,6 +1335,46 @@ def test_large_multivalued_sn_attribute(topo):
     user.delete()
     log.info("User entry deleted successfully")
 
+@pytest.mark.skipif(get_default_db_lib() != "mdb", reason="lmdb specific test")
+def test_online_reindex_with_shadow_index(topo, add_some_entries):
+    """Check that an online reindex building the index aside keeps the
+    index usable until it is switched over
+
+    :id: 5b1d3c8e-9a2f-11f0-8c41-482ae39447e5
+    :setup: Standalone Instance with some entries
+    :steps:
+        1. Set nsslapd-mdb-reindex-shadow to on
+        2. Start a reindex task on uid
+        3. Search on uid while the task is running
+        4. Check the task exit code
+        5. Check that the index was switched over
+        6. Check that indexed searches still return the entries
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Every search should find the entry
+        4. Should be 0
+        5. Error log should contain the switch over message
+        6. Success
+    """
+    inst = topo.standalone
+    handler = LMDB_LDBMConfig(inst)
+    handler.replace('nsslapd-mdb-reindex-shadow', 'on')
+    try:
+        tasks = Tasks(inst)
+        tasks.reindex(suffix=DEFAULT_SUFFIX, attrname='uid')
+        reindex_task = Task(inst, tasks.dn)
+        while not reindex_task.is_complete():
+            entries = inst.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(uid=uid1_42)', ['uid'])
+            assert len(entries) == 1
+            time.sleep(0.1)
+        assert reindex_task.get_exit_code() == 0
+        assert inst.searchErrorsLog('Index uid switched over')
+        entries = inst.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(uid=uid1_*)', ['uid'])
+        assert len(entries) == 100
+    finally:
+        handler.replace('nsslapd-mdb-reindex-shadow', 'off')
+
 
 if __name__ == "__main__":
     # Run isolated
@@ -39,7 +39,7 @@ def uid_index(topology_st):
         """Remove substring index config, ignore errors if attrs not present."""
         if not inst.status():
             inst.start()
-        for attr in ['nsSubStrBegin', 'nsSubStrMiddle', 'nsSubStrEnd']:
+        for attr in ['nsSubStrBegin', 'nsSubStrMiddle', 'nsSubStrEnd', 'nsSubStrPositions']:
             try:
                 index.remove_all(attr)
             except (ldap.NO_SUCH_ATTRIBUTE, ldap.SERVER_DOWN):
@@ -53,7 +53,7 @@ def uid_index(topology_st):
             pass
 
         # Remove nssubstr matching rules from nsMatchingRule
-        for rule in ['nssubstrbegin', 'nssubstrmiddle', 'nssubstrend']:
+        for rule in ['nssubstrbegin', 'nssubstrmiddle', 'nssubstrend', 'nssubstrpositions']:
             try:
                 mrs = index.get_attr_vals_utf8('nsMatchingRule')
                 for mr in mrs:
@@ -458,6 +458,50 @@ def test_substr_mixed_end_gt_middle(topology_st, uid_index, create_user):
     _search_and_assert(topology_st, '(uid=*nd*)', 2, 'middle=2 any search')
 
 
+def test_substr_positions(topology_st, uid_index, create_user):
+    """Test the substring index keys carrying the gram offsets (nsSubStrPositions)
+
+    :id: 2b7c4e91-5d0a-4f3e-8c6b-a1e9d7f05c28
+    :setup: Standalone instance
+    :steps:
+        1. Configure uid index with nsSubStrPositions=4
+        2. Add users whose uid has "smith", or only its grams at unrelated offsets
+        3. Reindex uid attribute
+        4. Search with initial, any and final components
+        5. Search with an any component longer than the positions
+        6. Add a user and search it without reindexing
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Success
+        4. Only the entries with the substrings are returned
+        5. Success
+        6. The index is updated with the positional keys
+    """
+    uid_index.add_many(
+        ('objectClass', 'extensibleObject'),
+        ('nsIndexType', 'sub'),
+        ('nsSubStrPositions', '4'),
+    )
+
+    create_user(f'{UID_PREFIX}smith', 'p user0', 'user0')
+    create_user(f'{UID_PREFIX}xsmithy', 'p user1', 'user1')
+    create_user(f'{UID_PREFIX}smixmitxith', 'p user2', 'user2')
+    create_user(f'{UID_PREFIX}smiith', 'p user3', 'user3')
+
+    _reindex_uid(topology_st)
+
+    _search_and_assert(topology_st, '(uid=*smith*)', 2, 'positions any')
+    _search_and_assert(topology_st, '(uid=*smi*ith*)', 2, 'positions two any')
+    _search_and_assert(topology_st, f'(uid={UID_PREFIX}smi*)', 3, 'positions initial')
+    _search_and_assert(topology_st, '(uid=*mith)', 1, 'positions final')
+    _search_and_assert(topology_st, f'(uid={UID_PREFIX}x*ithy)', 1, 'positions initial and final')
+    _search_and_assert(topology_st, '(uid=*subtestxsmith*)', 1, 'positions long any')
+
+    create_user(f'{UID_PREFIX}ysmith', 'p user4', 'user4')
+    _search_and_assert(topology_st, '(uid=*smith*)', 3, 'positions after add')
+
+
 if __name__ == '__main__':
     CURRENT_FILE = os.path.realpath(__file__)
     pytest.main("-s %s" % CURRENT_FILE)
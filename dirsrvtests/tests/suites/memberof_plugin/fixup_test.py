@@ -284,6 +284,70 @@ def test_fixup_task_invalid_filter(topology_st, memberof):
     assert topology_st.standalone.ds_error_log.match('.*Bad search filter.*')
 
 
+def test_fixup_task_parallel(topology_st, request):
+    """Test the memberOf fixup task with several fixup threads
+
+    :id: 6a3e1f0c-8d2b-4f7a-b5c9-2e4d8a1c7f63
+    :setup: Standalone Instance
+    :steps:
+        1. Add users, a group of users and a group containing this group
+        2. Enable the memberOf plugin with 4 fixup threads and a batch size of 7
+        3. Run the fixup task
+        4. Check the memberOf values of the users
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Success
+        4. Every user is a member of both groups
+    """
+
+    inst = topology_st.standalone
+    groups = Groups(inst, DEFAULT_SUFFIX)
+    users = UserAccounts(inst, DEFAULT_SUFFIX)
+    inner = groups.create(properties={'cn': 'parallel_inner'})
+    outer = groups.create(properties={'cn': 'parallel_outer'})
+    outer.add('member', inner.dn)
+    members = []
+    for idx in range(100):
+        user = users.create(properties={
+            'uid': 'paralleluser%s' % idx,
+            'cn' : 'paralleluser%s' % idx,
+            'sn' : 'user%s' % idx,
+            'uidNumber' : '%s' % (3000 + idx),
+            'gidNumber' : '%s' % (3000 + idx),
+            'homeDirectory' : '/home/paralleluser%s' % idx
+        })
+        inner.add('member', user.dn)
+        members.append(user)
+
+    memberof = MemberOfPlugin(inst)
+    memberof.enable()
+    memberof.replace('memberOfFixupThreads', '4')
+    memberof.replace('memberOfFixupBatchSize', '7')
+    inst.restart()
+
+    def fin():
+        memberof.remove_all('memberOfFixupThreads')
+        memberof.remove_all('memberOfFixupBatchSize')
+        memberof.disable()
+        inst.restart()
+        for user in members:
+            user.delete()
+        inner.delete()
+        outer.delete()
+
+    request.addfinalizer(fin)
+
+    task = memberof.fixup(DEFAULT_SUFFIX)
+    task.wait()
+    assert task.get_exit_code() == 0
+
+    for user in members:
+        values = [v.lower() for v in user.get_attr_vals_utf8('memberOf')]
+        assert inner.dn.lower() in values
+        assert outer.dn.lower() in values
+
+
 if __name__ == '__main__':
     # Run isolated
     # -s for DEBUG mode
@@ -16,7 +16,7 @@ from lib389.monitor import *
 from lib389.backend import Backends, DatabaseConfig
 from lib389._constants import *
 from test389.topologies import topology_st as topo
-from lib389._mapped_object import DSLdapObjects
+from lib389._mapped_object import DSLdapObject, DSLdapObjects
 from lib389.utils import get_default_db_lib
 from lib389.plugins import MemberOfPlugin
 from lib389.idm.user import UserAccounts
@@ -282,6 +282,256 @@ def test_monitor_work_queue(topo):
     assert 'maxbusyworkers' in status
 
 
+def test_monitor_work_queue_shards(topo):
+    """Verify the per listener work queue shards are exposed via cn=monitor
+
+    :id: 0c5b3e8a-2f4d-4b7e-9d61-5a8c1e3f7b20
+    :setup: Standalone Instance
+    :steps:
+        1. Set nsslapd-numlisteners to 2 and restart the server
+        2. Query cn=monitor for workqueueshards and workqueueshard
+        3. Verify there is one workqueueshard value per shard
+        4. Generate some load and verify the shard counters are consistent
+        5. Restore nsslapd-numlisteners
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Success
+        4. Success
+        5. Success
+    """
+    inst = topo.standalone
+    monitor = Monitor(inst)
+    orig_listeners = inst.config.get_attr_val_utf8('nsslapd-numlisteners')
+
+    inst.config.replace('nsslapd-numlisteners', '2')
+    inst.restart()
+    try:
+        for _ in range(10):
+            inst.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(objectclass=*)')
+
+        (workqueueshards, workqueueshard) = monitor.get_work_queue_shards()
+        nshards = int(workqueueshards[0])
+        log.info(f"workqueueshards={nshards} workqueueshard={workqueueshard}")
+        assert nshards == 2
+        assert len(workqueueshard) == nshards
+
+        for value in workqueueshard:
+            (shard, cur_wq, max_wq, steals) = [int(v) for v in value.split(':')]
+            assert 0 <= shard < nshards
+            assert cur_wq >= 0
+            assert max_wq >= cur_wq
+            assert steals >= 0
+    finally:
+        inst.config.replace('nsslapd-numlisteners', orig_listeners)
+        inst.restart()
+
+
+def test_monitor_access_log_writer(topo):
+    """Verify the access log writer thread metrics are exposed via cn=monitor
+
+    :id: 5d9e2c71-8b3a-4f06-a4e7-2c1f6b8d0e93
+    :setup: Standalone Instance
+    :steps:
+        1. Generate some load with access log buffering on
+        2. Query cn=monitor for the access log writer attributes
+        3. Verify they are parseable and consistent
+        4. Turn access log buffering off and search again
+        5. Verify the search is in the access log
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Success
+        4. Success
+        5. Success
+    """
+    inst = topo.standalone
+    monitor = Monitor(inst)
+
+    for _ in range(10):
+        inst.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(objectclass=*)')
+
+    (queuedepth, flushes, latencyavg, latencymax,
+     dropped, blocked) = monitor.get_access_log_writer()
+    log.info(f"accesslogqueuedepth={queuedepth} accesslogflushes={flushes} "
+             f"accesslogflushlatencyavg={latencyavg} accesslogflushlatencymax={latencymax} "
+             f"accesslogdropped={dropped} accesslogblocked={blocked}")
+    assert int(queuedepth[0]) >= 0
+    assert int(flushes[0]) >= 0
+    assert int(latencymax[0]) >= int(latencyavg[0])
+    # The default overflow policy blocks instead of dropping lines
+    assert int(dropped[0]) == 0
+    assert int(blocked[0]) >= 0
+
+    inst.config.replace('nsslapd-accesslog-logbuffering', 'off')
+    try:
+        inst.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(uid=access_log_writer)')
+        assert inst.ds_access_log.match(r'.*filter="\(uid=access_log_writer\)".*')
+    finally:
+        inst.config.replace('nsslapd-accesslog-logbuffering', 'on')
+
+
+def test_monitor_pw_verify_cache(topo):
+    """Verify the bind password verification cache and its cn=monitor counters
+
+    :id: 8f2b4c6e-1d3a-4e57-b9c0-7a6d5e4f3b21
+    :setup: Standalone Instance
+    :steps:
+        1. Enable the verified password cache
+        2. Bind twice as a user with the same password
+        3. Change the user password and bind with the old one
+        4. Bind with the new password
+        5. Disable the cache
+    :expectedresults:
+        1. Success
+        2. The second bind is a cache hit
+        3. The bind fails
+        4. Success, this is a cache miss
+        5. Success
+    """
+    inst = topo.standalone
+    monitor = Monitor(inst)
+    users = UserAccounts(inst, DEFAULT_SUFFIX)
+    user = users.create_test_user(uid=1100)
+    user.set('userPassword', 'password1')
+
+    inst.config.replace('nsslapd-pwverify-cache-ttl', '60')
+    try:
+        (threads, _, _, _, hits, misses, _) = monitor.get_pw_verify()
+        assert int(threads[0]) >= 1
+        hits_before = int(hits[0])
+        misses_before = int(misses[0])
+
+        user.bind('password1')
+        user.bind('password1')
+        (_, _, ops, entries, hits, misses, _) = monitor.get_pw_verify()
+        assert int(ops[0]) >= 1
+        assert int(entries[0]) >= 1
+        assert int(hits[0]) == hits_before + 1
+        assert int(misses[0]) == misses_before + 1
+
+        user.replace('userPassword', 'password2')
+        with pytest.raises(ldap.INVALID_CREDENTIALS):
+            user.bind('password1')
+        user.bind('password2')
+        (_, _, _, _, hits, _, _) = monitor.get_pw_verify()
+        assert int(hits[0]) == hits_before + 1
+    finally:
+        inst.config.replace('nsslapd-pwverify-cache-ttl', '0')
+        user.delete()
+
+
+def test_monitor_bind_state_write_behind(topo):
+    """Verify the bind state updates are merged and the lockout still applies
+
+    :id: 3e7a9b15-6c2d-4f80-a1e4-9d5b8c0f2a63
+    :setup: Standalone Instance
+    :steps:
+        1. Enable the password lockout after 3 failures and a 2 seconds bind state write window
+        2. Fail 3 binds as a user
+        3. Bind with the right password before the failures are written
+        4. Wait for the window to expire
+        5. Check the retry count of the entry and the cn=monitor counters
+    :expectedresults:
+        1. Success
+        2. The failures are queued and merged
+        3. The account is locked
+        4. Success
+        5. The retry count is written, in fewer writes than failures
+    """
+    inst = topo.standalone
+    monitor = Monitor(inst)
+    users = UserAccounts(inst, DEFAULT_SUFFIX)
+    user = users.create_test_user(uid=1200)
+    user.set('userPassword', 'password1')
+    max_failure = inst.config.get_attr_val_utf8('passwordMaxFailure')
+
+    inst.config.set('passwordLockout', 'on')
+    inst.config.set('passwordMaxFailure', '3')
+    inst.config.replace('nsslapd-bind-state-write-window', '2000')
+    try:
+        (_, queued, merged, written, _) = monitor.get_bind_state()
+        queued_before = int(queued[0])
+        merged_before = int(merged[0])
+        written_before = int(written[0])
+
+        for _ in range(3):
+            with pytest.raises(ldap.INVALID_CREDENTIALS):
+                user.bind('wrong')
+        with pytest.raises(ldap.CONSTRAINT_VIOLATION):
+            user.bind('password1')
+
+        (_, queued, merged, _, _) = monitor.get_bind_state()
+        assert int(queued[0]) >= queued_before + 3
+        assert int(merged[0]) >= merged_before + 2
+
+        time.sleep(4)
+        assert user.get_attr_val_int('passwordRetryCount') == 3
+        (pending, _, _, written, batches) = monitor.get_bind_state()
+        assert int(pending[0]) == 0
+        assert int(written[0]) - written_before < 3
+        assert int(batches[0]) >= 1
+    finally:
+        inst.config.replace('nsslapd-bind-state-write-window', '0')
+        inst.config.set('passwordLockout', 'off')
+        inst.config.set('passwordMaxFailure', max_failure)
+        user.delete()
+
+
+def test_monitor_index_stats(topo):
+    """Verify the index usage statistics and advice of a backend
+
+    :id: 6d1e8a3f-5b27-4c9e-a0f4-2e7c9b1d8a54
+    :setup: Standalone Instance
+    :steps:
+        1. Search userRoot with an equality filter on the indexed uid attribute
+        2. Search userRoot with an equality filter on the unindexed description attribute
+        3. Read cn=index-stats of userRoot
+        4. Disable nsslapd-index-stats and repeat the unindexed search
+    :expectedresults:
+        1. Success
+        2. Success
+        3. uid and description eq lookups are listed, the unindexed searches are
+           counted as filter test fallbacks and a missing description index is advised
+        4. The counters do not change
+    """
+    inst = topo.standalone
+    stats = DSLdapObject(inst, 'cn=index-stats,cn=userRoot,cn=ldbm database,cn=plugins,cn=config')
+    db_cfg = DatabaseConfig(inst)
+
+    def lookups(name):
+        count = int(stats.get_attr_val_utf8('indexCount'))
+        for i in range(count):
+            if stats.get_attr_val_utf8(f'indexName-{i}') == name and \
+               stats.get_attr_val_utf8(f'indexType-{i}') == 'eq':
+                return (int(stats.get_attr_val_utf8(f'indexLookups-{i}')),
+                        int(stats.get_attr_val_utf8(f'indexUnindexed-{i}')),
+                        int(stats.get_attr_val_utf8(f'indexFilterTests-{i}')))
+        return (0, 0, 0)
+
+    assert db_cfg.get_attr_val_utf8('nsslapd-index-stats') == 'on'
+    inst.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(uid=index_stats)')
+    inst.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(description=index_stats)')
+
+    (uid_lookups, uid_unindexed, uid_filter_tests) = lookups('uid')
+    assert uid_lookups >= 1
+    assert uid_unindexed == 0
+    assert uid_filter_tests <= uid_lookups
+    (desc_lookups, desc_unindexed, desc_filter_tests) = lookups('description')
+    assert desc_lookups >= 1
+    assert desc_unindexed == desc_lookups
+    assert desc_filter_tests >= 1
+    advice = stats.get_attr_vals_utf8('indexAdvice')
+    assert any(a.startswith('description: missing eq index') for a in advice)
+
+    db_cfg.replace('nsslapd-index-stats', 'off')
+    try:
+        inst.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(description=index_stats)')
+        assert lookups('description') == (desc_lookups, desc_unindexed, desc_filter_tests)
+    finally:
+        db_cfg.replace('nsslapd-index-stats', 'on')
+
+
 def test_monitor_busy_workers_concurrent(topo):
     """Verify currentbusyworkers increments under concurrent operations
 
@@ -68,6 +68,45 @@ def test_psearch(topology_st):
     assert(group.dn == results[0])
 
 
+def test_psearch_equality_filter(topology_st):
+    """Check that a persistent search with an equality filter only gets the matching changes
+
+    :id: 0d7c4a52-2f6e-4b8e-9a43-6c1f0e9b7d21
+    :setup: Standalone instance
+    :steps:
+        1. Run a persistent search on the suffix with an equality filter on cn
+        2. Run a persistent search on ou=people with no equality filter
+        3. Create two groups, one matching the filter
+        4. Modify the matching group
+        5. Check the changes returned by both searches
+    :expectedresults:
+        1. Operation should be successful
+        2. Operation should be successful
+        3. Groups should be successfully created
+        4. Group should be successfully modified
+        5. Only the matching group is returned, twice, by the first search
+           and nothing is returned by the second one
+    """
+
+    inst = topology_st.standalone
+    psc = PersistentSearchControl()
+    msg_eq = inst.search_ext(base=DEFAULT_SUFFIX, scope=ldap.SCOPE_SUBTREE,
+                             filterstr='(&(objectclass=groupofnames)(cn=psearch_eq))',
+                             attrlist=['*'], serverctrls=[psc])
+    msg_people = inst.search_ext(base='ou=people,%s' % DEFAULT_SUFFIX, scope=ldap.SCOPE_SUBTREE,
+                                 attrlist=['*'], serverctrls=[psc])
+    _run_psearch(inst, msg_eq)
+    _run_psearch(inst, msg_people)
+
+    groups = Groups(inst, DEFAULT_SUFFIX)
+    group = groups.create(properties={'cn': 'psearch_eq', 'description': 'testgroup'})
+    groups.create(properties={'cn': 'psearch_other', 'description': 'testgroup'})
+    group.replace('description', 'modified')
+
+    assert _run_psearch(inst, msg_eq) == [group.dn, group.dn]
+    assert _run_psearch(inst, msg_people) == []
+
+
 if __name__ == '__main__':
     # Run isolated
     # -s for DEBUG mode
@@ -891,6 +891,45 @@ def test_default_cl_trimming_enabled(topo_m2):
     assert cl.get_attr_val_utf8("nsslapd-changelogmaxage") == "7d"
 
 
+def test_decoded_change_cache(topo_m4, create_entry):
+    """Check that agreements reading the same changelog share decoded changes
+
+    :id: 5b0c7e52-3a4d-4f8e-9f1c-2d7a6b8e4c13
+    :setup: Four suppliers replication setup, an entry
+    :steps:
+        1. Modify the test entry several times on supplier1
+        2. Wait for the changes to reach the other suppliers
+        3. Read the decoded change cache counters of the supplier1 agreements
+    :expectedresults:
+        1. Success
+        2. Success
+        3. Every change was looked up, and some were found already
+           decoded by another agreement
+    """
+
+    m1 = topo_m4.ms["supplier1"]
+    test_user = UserAccount(m1, TEST_ENTRY_DN)
+    for num in range(10):
+        test_user.replace('description', 'decoded cache {}'.format(num))
+
+    repl = ReplicationManager(DEFAULT_SUFFIX)
+    for num in range(2, 5):
+        repl.wait_for_replication(m1, topo_m4.ms["supplier{}".format(num)])
+
+    hits = 0
+    lookups = 0
+    for agmt in m1.agreement.list(suffix=DEFAULT_SUFFIX):
+        entries = m1.search_s(agmt.dn, ldap.SCOPE_BASE, "objectclass=*",
+                              ['nsds5replicaDecodedCacheHits', 'nsds5replicaDecodedCacheMisses'])
+        agmt_hits = int(entries[0].getValue('nsds5replicaDecodedCacheHits'))
+        agmt_misses = int(entries[0].getValue('nsds5replicaDecodedCacheMisses'))
+        log.info('{}: hits {} misses {}'.format(agmt.dn, agmt_hits, agmt_misses))
+        hits += agmt_hits
+        lookups += agmt_hits + agmt_misses
+    assert lookups >= 10
+    assert hits > 0
+
+
 if __name__ == '__main__':
     # Run isolated
     # -s for DEBUG mode
@@ -11,6 +11,7 @@ import logging
 import pytest
 import os
 import ldap
+import threading
 from lib389.dbgen import dbgen_users
 from lib389._constants import *
 from test389.topologies import topology_st as topo
@@ -62,6 +63,57 @@ def test_sss_mr(topo):
     log.info("Test PASSED")
 
 
+
+def test_sss_with_concurrent_deletes(topo):
+    """Test that a server side sorted search tolerates deleted candidates
+
+    :id: 6f1f4a3c-8d1e-4c52-9f07-2b5e0c9a7d31
+    :setup: Standalone Instance
+    :steps:
+        1. Add sample entries to the database
+        2. Delete the entries while running server side sorted searches on them
+        3. Check the results of every search
+    :expectedresults:
+        1. Success
+        2. No search fails
+        3. The returned entries are sorted
+    """
+
+    inst = topo.standalone
+    ldif_file = os.path.join(inst.get_ldif_dir(), 'sss-delete.ldif')
+    dbgen_users(inst, 3000, ldif_file, DEFAULT_SUFFIX)
+    inst.stop()
+    assert inst.ldif2db(DEFAULT_BENAME, None, None, None, ldif_file)
+    inst.start()
+
+    dns = [e.dn for e in inst.search_s(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(uid=*)', ['dn'])]
+    done = threading.Event()
+
+    def delete_entries():
+        conn = inst.clone()
+        conn.open()
+        try:
+            for dn in dns:
+                conn.delete_s(dn)
+        finally:
+            done.set()
+
+    deleter = threading.Thread(target=delete_entries)
+    deleter.start()
+    searches = 0
+    try:
+        while not done.is_set() or searches == 0:
+            msg_id = inst.search_ext(DEFAULT_SUFFIX, ldap.SCOPE_SUBTREE, '(uid=*)', ['uid'],
+                                     serverctrls=[SSSRequestControl(True, ['uid'])])
+            _, rdata, _, _ = inst.result3(msg_id)
+            uids = [e[1]['uid'][0].lower() for e in rdata]
+            assert uids == sorted(uids)
+            searches += 1
+    finally:
+        deleter.join()
+    log.info(f'{searches} sorted searches raced the deletes')
+    os.remove(ldif_file)
+
 if __name__ == '__main__':
     # Run isolated
     # -s for DEBUG mode
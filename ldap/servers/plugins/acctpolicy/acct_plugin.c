@@ -92,7 +92,7 @@ acct_inact_limit(Slapi_PBlock *pb, const char *dn, Slapi_Entry *target_entry, ac
         /*
          * Check both state and alternate state attributes.
          */
-        if ((lasttimestr = get_attr_string_val(target_entry, cfg->state_attr_name)) != NULL) {
+        if ((lasttimestr = get_state_attr_string_val(target_entry, cfg->state_attr_name)) != NULL) {
             slapi_log_err(SLAPI_LOG_PLUGIN, PRE_PLUGIN_NAME,
                           "acct_inact_limit - \"%s\" login timestamp is %s (found in attribute '%s')\n",
                           dn, lasttimestr, cfg->state_attr_name);
@@ -112,7 +112,7 @@ acct_inact_limit(Slapi_PBlock *pb, const char *dn, Slapi_Entry *target_entry, ac
 
         /* Check alternate state attribute next... */
         if (cfg->alt_state_attr_name &&
-                ((lasttimestr = get_attr_string_val(target_entry, cfg->alt_state_attr_name)) == NULL))
+                ((lasttimestr = get_state_attr_string_val(target_entry, cfg->alt_state_attr_name)) == NULL))
         {
             goto done;
         }
@@ -139,12 +139,12 @@ acct_inact_limit(Slapi_PBlock *pb, const char *dn, Slapi_Entry *target_entry, ac
          * Check state attribute, if not present in entry only then try
          * alternate state attribute
          */
-        if ((lasttimestr = get_attr_string_val(target_entry, cfg->state_attr_name)) != NULL) {
+        if ((lasttimestr = get_state_attr_string_val(target_entry, cfg->state_attr_name)) != NULL) {
             slapi_log_err(SLAPI_LOG_PLUGIN, PRE_PLUGIN_NAME,
                           "acct_inact_limit - \"%s\" login timestamp is %s (found in attribute '%s')\n",
                           dn, lasttimestr, cfg->state_attr_name);
         } else if (cfg->alt_state_attr_name &&
-            ((lasttimestr = get_attr_string_val(target_entry, cfg->alt_state_attr_name)) != NULL))
+            ((lasttimestr = get_state_attr_string_val(target_entry, cfg->alt_state_attr_name)) != NULL))
         {
             slapi_log_err(SLAPI_LOG_PLUGIN, PRE_PLUGIN_NAME,
                           "acct_inact_limit - \"%s\" alternate timestamp is %s (found in attribute '%s')\n",
@@ -208,6 +208,7 @@ acct_update_login_history(const char *dn, char *timestr)
     acctPluginCfg *cfg;
     LDAPMod attribute;
     LDAPMod *list_of_mods[2];
+    Slapi_Mods smods;
 
     /* nothing to do if timestr is empty */
     if (!timestr) {
@@ -217,29 +218,40 @@ acct_update_login_history(const char *dn, char *timestr)
     plugin_id = get_identity();
     sdn = slapi_sdn_new_normdn_byref(dn);
     slapi_search_get_entry(&entry_pb, sdn, NULL, &e, plugin_id);
-    slapi_sdn_free(&sdn);
 
     /* if the entry doesn't exist, just return */
     if (e == NULL) {
+        slapi_sdn_free(&sdn);
         return (rc);
     }
 
     config_rd_lock();
     cfg = get_config();
 
+    /* the history of the last binds may not be written to the entry yet */
+    login_hist = slapi_bind_state_get_charray(dn, cfg->login_history_attr);
+
     /* does this value already exist in the entry */
     Slapi_Value *timestr_val = slapi_value_new();
     slapi_value_set_string(timestr_val, timestr);
-    if (slapi_entry_attr_has_syntax_value(e, cfg->login_history_attr, timestr_val)) {
+    if (login_hist ? charray_inlist(login_hist, timestr)
+                   : slapi_entry_attr_has_syntax_value(e, cfg->login_history_attr, timestr_val)) {
         slapi_search_get_entry_done(&entry_pb);
         slapi_value_free(&timestr_val);
+        slapi_ch_array_free(login_hist);
+        slapi_sdn_free(&sdn);
         config_unlock();
         return 0;
     }
     slapi_value_free(&timestr_val);
 
     /* now we have an entry that doesnt contain the current timestr */
-    login_hist = slapi_entry_attr_get_charray_ext(e, cfg->login_history_attr, &num_entries);
+    if (login_hist) {
+        for (num_entries = 0; login_hist[num_entries]; num_entries++)
+            ;
+    } else {
+        login_hist = slapi_entry_attr_get_charray_ext(e, cfg->login_history_attr, &num_entries);
+    }
     if (login_hist && num_entries) {
         /* do we need to trim the array */
         if (num_entries >= cfg->login_history_size) {
@@ -288,6 +300,14 @@ acct_update_login_history(const char *dn, char *timestr)
         list_of_mods[0] = &attribute;
         list_of_mods[1] = NULL;
 
+        /* merged with the other bind state updates of the entry, if they are held */
+        slapi_mods_init_byref(&smods, list_of_mods);
+        rc = slapi_bind_state_write(sdn, &smods);
+        slapi_mods_done(&smods);
+        if (rc == 0) {
+            goto done;
+        }
+
         mod_pb = slapi_pblock_new();
         slapi_modify_internal_set_pb(mod_pb, dn, list_of_mods, NULL, NULL, plugin_id,
                                      SLAPI_OP_FLAG_NO_ACCESS_CHECK |SLAPI_OP_FLAG_BYPASS_REFERRALS);
@@ -299,6 +319,8 @@ acct_update_login_history(const char *dn, char *timestr)
         slapi_pblock_destroy(mod_pb);
     }
 
+done:
+    slapi_sdn_free(&sdn);
     config_unlock();
     slapi_ch_array_free(login_hist);
     slapi_search_get_entry_done(&entry_pb);
@@ -324,6 +346,8 @@ acct_record_login(const char *dn)
     acctPluginCfg *cfg;
     void *plugin_id;
     Slapi_PBlock *modpb = NULL;
+    Slapi_DN *sdn = NULL;
+    Slapi_Mods smods;
     int skip_mod_attrs = 1; /* value doesn't matter as long as not NULL */
 
     config_rd_lock();
@@ -351,6 +375,21 @@ acct_record_login(const char *dn)
     mods[0] = &mod;
     mods[1] = NULL;
 
+    /* Hold the login time with the other bind state updates of the entry, if enabled */
+    sdn = slapi_sdn_new_normdn_byref(dn);
+    slapi_mods_init_byref(&smods, mods);
+    ldrc = slapi_bind_state_write(sdn, &smods);
+    slapi_mods_done(&smods);
+    slapi_sdn_free(&sdn);
+    if (ldrc == 0) {
+        slapi_log_err(SLAPI_LOG_PLUGIN, POST_PLUGIN_NAME,
+                      "acct_record_login - Queued %s=%s on \"%s\"\n", cfg->always_record_login_attr, timestr, dn);
+        if (cfg->login_history_attr) {
+            acct_update_login_history(dn, timestr);
+        }
+        goto done;
+    }
+
     modpb = slapi_pblock_new();
 
     slapi_modify_internal_set_pb(modpb, dn, mods, NULL, NULL,
@@ -79,6 +79,21 @@ get_attr_string_val(Slapi_Entry *target_entry, char *attr_name)
     return (ret);
 }
 
+/*
+  Like get_attr_string_val(), for the login state attributes: the login
+  time recorded by the last binds may not be written to the entry yet.
+*/
+char *
+get_state_attr_string_val(Slapi_Entry *target_entry, char *attr_name)
+{
+    char *ret = slapi_bind_state_get_charptr(slapi_entry_get_ndn(target_entry), attr_name);
+
+    if (ret == NULL) {
+        ret = get_attr_string_val(target_entry, attr_name);
+    }
+    return (ret);
+}
+
 /*
   Given an entry, provide the account policy in effect for that entry.
   Returns non-0 if function fails.  If account policy comes back NULL, it's
@@ -79,6 +79,7 @@ int get_acctpolicy(Slapi_PBlock *pb, Slapi_Entry *target_entry, void *plugin_id,
 void free_acctpolicy(acctPolicy **policy);
 int has_attr(Slapi_Entry *target_entry, char *attr_name, char **val);
 char *get_attr_string_val(Slapi_Entry *e, char *attr_name);
+char *get_state_attr_string_val(Slapi_Entry *e, char *attr_name);
 void *get_identity(void);
 void set_identity(void *);
 time_t gentimeToEpochtime(char *gentimestr);
@@ -295,6 +295,8 @@ acl_access_allowed(
     int loglevel;
     PRUint64 o_connid = 0xffffffffffffffff; /* no op */
     int o_opid = -1;                        /* no op */
+    char *eval_cache_key = NULL;
+    uint64_t eval_cache_gen = 0;
 
     loglevel = slapi_is_loglevel_set(SLAPI_LOG_ACL) ? SLAPI_LOG_ACL : SLAPI_LOG_ACLSUMMARY;
     slapi_pblock_get(pb, SLAPI_OPERATION, &op); /* for logging */
@@ -629,6 +631,22 @@ acl_access_allowed(
         goto cleanup_and_ret;
     }
 
+    /*
+    ** If none of the candidate acis depend on the entry or the connection,
+    ** the decision may already be in the global evaluation cache.
+    */
+    if ((ret_val = acl_eval_cache_lookup(aclpb, attr, access,
+                                         &eval_cache_key, &eval_cache_gen)) != -1) {
+        if (ret_val == LDAP_SUCCESS) {
+            decision_reason.reason = ACL_REASON_RESULT_CACHED_ALLOW;
+        } else {
+            decision_reason.reason = ACL_REASON_RESULT_CACHED_DENY;
+        }
+        /* no aci was matched, so don't let later attrs use the star shortcut */
+        aclpb->aclpb_state &= ~ACLPB_ATTR_STAR_MATCHED;
+        goto cleanup_and_ret;
+    }
+
     /*
     ** Now we have all the information about the resource. Now we need to
     ** figure out if there are any ACLs which can be applied.
@@ -676,9 +694,16 @@ acl_access_allowed(
         ret_val = LDAP_INSUFFICIENT_ACCESS;
     }
 
+    /* still under the aci read lock, so no aci change can slip in between */
+    if (eval_cache_key && (rv == ACL_RES_ALLOW || rv == ACL_RES_DENY)) {
+        acl_eval_cache_store(eval_cache_key, eval_cache_gen, ret_val);
+        eval_cache_key = NULL;
+    }
+
 cleanup_and_ret:
 
     TNF_PROBE_0_DEBUG(acl_cleanup_start, "ACL", "");
+    slapi_ch_free_string(&eval_cache_key);
 
     /* I am ready to get out. */
     if (got_reader_locked)
@@ -1758,11 +1783,16 @@ acl_modified(Slapi_PBlock *pb, int optype, Slapi_DN *e_sdn, void *change)
             aclg_regen_group_signature();
             if ((optype == SLAPI_OPERATION_MODIFY) || (optype == SLAPI_OPERATION_DELETE)) {
                 /* Then we need to invalidate the acl signature also */
-                acl_signature = aclutil_gen_signature(acl_signature);
+                acl_regen_aclsignature();
             }
         }
     }
 
+    /* Decisions cached for this entry as a client may no longer hold */
+    if (optype != SLAPI_OPERATION_ADD) {
+        acl_eval_cache_invalidate_identity(slapi_sdn_get_ndn(e_sdn));
+    }
+
     /*
      * Here if the target entry is in the group cache
      * as a user then, as it's being changed it may move out of any dynamic
@@ -2839,7 +2869,15 @@ acl__resource_match_aci(Acl_PBlock *aclpb, aci_t *aci, int skip_attrEval, int *a
             star_matched = ACL_FALSE;
             num_attrs = 0;
 
-            while (attrArray[num_attrs] && !attr_matched) {
+            if (c_attrEval->attrEval_mask == 0) {
+                c_attrEval->attrEval_mask = aclutil_attrtype_mask(res_attr);
+            }
+            if (aci->targetAttrMask && !(aci->targetAttrMask & c_attrEval->attrEval_mask)) {
+                /* none of the named types can be res_attr */
+                attrArray = NULL;
+            }
+
+            while (attrArray && attrArray[num_attrs] && !attr_matched) {
                 attr = attrArray[num_attrs];
                 if (attr->attr_type & ACL_ATTR_STRING) {
                     /*
@@ -3927,6 +3965,8 @@ acl_copyEval_context(struct acl_pblock *aclpb, aclEvalContext *src, aclEvalConte
 
             dest->acle_attrEval[dd_slot].attrEval_name =
                 slapi_ch_strdup(src->acle_attrEval[i].attrEval_name);
+            dest->acle_attrEval[dd_slot].attrEval_mask =
+                src->acle_attrEval[i].attrEval_mask;
         }
         /* Copy the result status and the aci index */
         dest->acle_attrEval[dd_slot].attrEval_r_status =
@@ -4148,6 +4188,7 @@ acl__get_attrEval(struct acl_pblock *aclpb, char *attr)
         /* clean it before use */
         slapi_ch_free_string(&c_attrEval->attrEval_name);
         c_attrEval->attrEval_name = slapi_ch_strdup(attr);
+        c_attrEval->attrEval_mask = aclutil_attrtype_mask(attr);
         aclpb->aclpb_curr_attrEval = c_attrEval;
     }
     return deallocate_attrEval;
@@ -4213,6 +4254,7 @@ void
 acl_regen_aclsignature()
 {
     acl_signature = aclutil_gen_signature(acl_signature);
+    acl_eval_cache_flush();
 }
 
 
@@ -234,6 +234,7 @@ typedef struct aci
 #define ACI_TARGET_MODDN              (int)0x1000000
 #define ACI_TARGET_MODDN_FROM_PATTERN (int)0x2000000
 #define ACI_TARGET_MODDN_TO_PATTERN   (int)0x4000000
+#define ACI_USERDN_ENTRY_RULE         (int)0x8000000  /* userdn parent/filter */
 
     int aci_access;
 
@@ -275,6 +276,7 @@ typedef struct aci
     Slapi_DN *aci_sdn;    /* location */
     Slapi_Filter *target; /* Target is a DN */
     Targetattr **targetAttr;
+    PRUint64 targetAttrMask;          /* types named in targetAttr, 0 if it has patterns */
     char *targetFilterStr;
     struct slapi_filter *targetFilter; /* Target has a filter */
     Targetattrfilter **targetAttrAddFilters;
@@ -311,7 +313,15 @@ typedef struct aci
 #define ATTR_ACLPB_MAX_SELECTED_ACLS    "nsslapd-aclpb-max-selected-acls"
 #define DEFAULT_ACLPB_MAX_SELECTED_ACLS 200
 
+/*
+ * Maximum number of decisions kept in the global aci evaluation cache
+ * (see aclcache.c); 0 disables it.
+ */
+#define ATTR_ACL_EVAL_CACHE_SIZE    "nsslapd-acl-eval-cache-size"
+#define DEFAULT_ACL_EVAL_CACHE_SIZE 0
+
 extern int aclpb_max_selected_acls; /* initialized from plugin config entry */
+extern int acl_eval_cache_size;     /* initialized from plugin config entry */
 extern int aclpb_max_cache_results; /* initialized from plugin config entry */
 
 typedef struct result_cache
@@ -340,6 +350,7 @@ struct acl_attrEval
     short attrEval_s_status; /* status of search evaluation */
     int attrEval_r_aciIndex; /* Index of the ACL which grants access*/
     int attrEval_s_aciIndex; /* Index of the ACL which grants access*/
+    PRUint64 attrEval_mask;  /* aclutil_attrtype_mask() of the name */
 
 #define ACL_ATTREVAL_SUCCESS       0x1
 #define ACL_ATTREVAL_FAIL          0x2
@@ -560,7 +571,6 @@ struct acl_pblock
     PRUint16 aclpb_stat_num_tmatched_acls;
     PRUint16 aclpb_stat_unused;
     CERTCertificate *aclpb_clientcert;
-    AciContainer *aclpb_aclContainer;
     struct acl_pblock *aclpb_proxy; /* Child proxy block */
     acl_ht_t *aclpb_macro_ht;       /* ht for partial macro strs */
 
@@ -776,6 +786,7 @@ int aclutil_str_append(char **str1, const char *str2);
 void aclutil_print_err(int rv, const Slapi_DN *sdn, const struct berval *val, char **errbuf);
 void aclutil_print_aci(aci_t *aci_item, char *type);
 short aclutil_gen_signature(short c_signature);
+PRUint64 aclutil_attrtype_mask(const char *type);
 void aclutil_print_resource(struct acl_pblock *aclpb, const char *right, char *attr, char *clientdn);
 char *aclutil_expand_paramString(char *str, Slapi_Entry *e);
 
@@ -791,15 +802,13 @@ void acllist_acicache_WRITE_UNLOCK(void);
 void acllist_acicache_WRITE_LOCK(void);
 void acllist_aciscan_update_scan(Acl_PBlock *aclpb, char *edn);
 int acllist_remove_aci_needsLock(const Slapi_DN *sdn, const struct berval *attr);
-void free_acl_avl_list(void);
+void free_acl_list(void);
 int acllist_insert_aci_needsLock(const Slapi_DN *e_sdn, const struct berval *aci_attr);
 int acllist_init(void);
 void acllist_free(void);
 int acllist_moddn_aci_needsLock(Slapi_DN *oldsdn, char *newdn);
-void acllist_print_tree(Avlnode *root, int *depth, char *start, char *side);
 AciContainer *acllist_get_aciContainer_new(void);
 void acllist_free_aciContainer(AciContainer **container);
-void acllist_done_aciContainer(AciContainer *);
 void free_targetattrfilters(Targetattrfilter ***attrFilterArray);
 
 aclUserGroup *aclg_find_userGroup(const char *n_dn);
@@ -807,6 +816,15 @@ void aclg_regen_ugroup_signature(aclUserGroup *ugroup);
 void aclg_markUgroupForRemoval(aclUserGroup *u_group);
 void aclg_reader_incr_ugroup_refcnt(aclUserGroup *u_group);
 int aclg_numof_usergroups(void);
+int acl_eval_cache_init(int max);
+void acl_eval_cache_free(void);
+int acl_eval_cache_lookup(Acl_PBlock *aclpb, const char *attr, int access, char **key, uint64_t *generation);
+void acl_eval_cache_store(char *key, uint64_t generation, int result);
+void acl_eval_cache_flush(void);
+void acl_eval_cache_invalidate_identity(const char *ndn);
+void acl_eval_cache_monitor_init(void);
+void acl_eval_cache_monitor_cleanup(void);
+
 int aclgroup_init(void);
 void aclgroup_free(void);
 void aclg_regen_group_signature(void);
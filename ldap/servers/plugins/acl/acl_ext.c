@@ -24,6 +24,7 @@ static Acl_PBlock *acl__malloc_aclpb(void);
 static void acl__free_aclpb(Acl_PBlock **aclpb_ptr);
 
 int aclpb_max_selected_acls = DEFAULT_ACLPB_MAX_SELECTED_ACLS;
+int acl_eval_cache_size = DEFAULT_ACL_EVAL_CACHE_SIZE;
 int aclpb_max_cache_results = DEFAULT_ACLPB_MAX_SELECTED_ACLS;
 
 struct acl_pbqueue
@@ -380,6 +381,9 @@ acl__handle_plugin_config_entry(Slapi_Entry *e, void *callback_data __attribute_
         aclpb_max_cache_results = DEFAULT_ACLPB_MAX_SELECTED_ACLS;
     }
 
+    value = slapi_entry_attr_get_int(e, ATTR_ACL_EVAL_CACHE_SIZE);
+    acl_eval_cache_size = (value > 0) ? value : DEFAULT_ACL_EVAL_CACHE_SIZE;
+
     return 0;
 }
 
@@ -668,8 +672,6 @@ acl__malloc_aclpb(void)
     aclpb->aclpb_authorization_sdn = slapi_sdn_new();
     aclpb->aclpb_curr_entry_sdn = slapi_sdn_new();
 
-    aclpb->aclpb_aclContainer = acllist_get_aciContainer_new();
-
     /* hash table to store macro matched values from targets */
     aclpb->aclpb_macro_ht = acl_ht_new();
 
@@ -737,8 +739,6 @@ acl__free_aclpb(Acl_PBlock **aclpb_ptr)
     }
     slapi_ch_free((void **)&(aclpb->aclpb_allow_handles));
     slapi_ch_free((void **)&(aclpb->aclpb_deny_handles));
-    acllist_free_aciContainer(&aclpb->aclpb_aclContainer);
-    slapi_ch_free((void **)&(aclpb->aclpb_aclContainer));
     slapi_ch_free_string(&aclpb->aclpb_Evalattr);
     slapi_ch_array_free(aclpb->aclpb_grpsearchbase);
 
@@ -992,8 +992,6 @@ acl__done_aclpb(struct acl_pblock *aclpb)
     aclpb->aclpb_clientcert = NULL;
     aclpb->aclpb_proxy = NULL;
 
-    acllist_done_aciContainer(aclpb->aclpb_aclContainer);
-
     /*
      * Here, decide which things need to be freed/removed/whatever from the
      * aclpb_proplist.
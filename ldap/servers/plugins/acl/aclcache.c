@@ -0,0 +1,533 @@
+/** BEGIN COPYRIGHT BLOCK
+ * Copyright (C) 2026 Red Hat, Inc.
+ * All rights reserved.
+ *
+ * License: GPL (version 3 or any later version).
+ * See LICENSE for details.
+ * END COPYRIGHT BLOCK **/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "acl.h"
+
+/***************************************************************************
+ *
+ * This module deals with the global aci evaluation cache.
+ *
+ * acl_access_allowed() evaluates the same identity/right/attribute for
+ * every entry a search returns. When none of the candidate acis look at
+ * the entry's content (no target filter, pattern or macro, no userattr or
+ * parent style bind rule) or at the connection (ip, dns, ssf, authmethod,
+ * time), the decision only depends on the authorization identity, the aci
+ * containers above the entry, the plain target dns the entry is under,
+ * whether the entry is the client itself, the right and the attribute.
+ * Such decisions are kept here across operations and connections.
+ *
+ * Results are grouped per identity so that a change to the identity's own
+ * entry only drops its results; any aci or group change flushes the whole
+ * cache. Every invalidation bumps a generation number so that an
+ * evaluation that raced with it does not insert a stale result.
+ **************************************************************************/
+
+#define ACL_EVAL_CACHE_MONITOR_DN "cn=ACL Plugin,cn=monitor"
+
+/* aci types and bind rules that make a decision entry or connection specific */
+#define ACL_EVAL_CACHE_SKIP_TYPES                                                 \
+    (ACI_TARGET_MACRO_DN | ACI_TARGET_FILTER_MACRO_DN | ACI_TARGET_PATTERN |      \
+     ACI_TARGET_FILTER | ACI_TARGET_FILTER_NOT | ACI_TARGET_ATTR_ADD_FILTERS |    \
+     ACI_TARGET_ATTR_DEL_FILTERS | ACI_TARGET_MODDN |                             \
+     ACI_TARGET_MODDN_FROM_PATTERN | ACI_TARGET_MODDN_TO_PATTERN |                \
+     ACI_USERDN_ENTRY_RULE)
+#define ACL_EVAL_CACHE_SKIP_RULES                                                 \
+    ((ACI_ATTR_RULES & ~ACI_USERDN_SELFRULE) | ACI_AUTHMETHOD_RULE | ACI_IP_RULE | \
+     ACI_DNS_RULE | ACI_TIMEOFDAY_RULE | ACI_DAYOFWEEK_RULE | ACI_ROLEDN_RULE | ACI_SSF_RULE)
+
+/* rights whose evaluation depends on more than the entry's location */
+#define ACL_EVAL_CACHE_SKIP_RIGHTS (SLAPI_ACL_SEARCH | SLAPI_ACL_PROXY | SLAPI_ACL_MODDN)
+
+typedef struct acl_eval_identity acl_eval_identity;
+
+typedef struct acl_eval_node
+{
+    char *aen_key;                    /* ndn '\1' access:containers:attr */
+    int aen_result;                   /* LDAP_SUCCESS or LDAP_INSUFFICIENT_ACCESS */
+    acl_eval_identity *aen_identity;  /* owning identity */
+    struct acl_eval_node *aen_id_prev;
+    struct acl_eval_node *aen_id_next;
+    struct acl_eval_node *aen_lru_prev;
+    struct acl_eval_node *aen_lru_next;
+} acl_eval_node;
+
+struct acl_eval_identity
+{
+    char *aei_ndn;
+    acl_eval_node *aei_nodes;
+};
+
+static struct
+{
+    pthread_mutex_t lock;
+    PLHashTable *nodes;      /* key -> acl_eval_node */
+    PLHashTable *identities; /* ndn -> acl_eval_identity */
+    acl_eval_node *lru_head; /* most recently used */
+    acl_eval_node *lru_tail;
+    uint64_t generation;
+    int32_t count;
+    int32_t max;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t inserts;
+    uint64_t evictions;
+    uint64_t invalidations;
+    int initialized;
+} acl_eval_cache;
+
+static void
+acl_eval_cache_lru_unlink(acl_eval_node *node)
+{
+    if (node->aen_lru_prev) {
+        node->aen_lru_prev->aen_lru_next = node->aen_lru_next;
+    } else {
+        acl_eval_cache.lru_head = node->aen_lru_next;
+    }
+    if (node->aen_lru_next) {
+        node->aen_lru_next->aen_lru_prev = node->aen_lru_prev;
+    } else {
+        acl_eval_cache.lru_tail = node->aen_lru_prev;
+    }
+    node->aen_lru_prev = node->aen_lru_next = NULL;
+}
+
+static void
+acl_eval_cache_lru_push(acl_eval_node *node)
+{
+    node->aen_lru_prev = NULL;
+    node->aen_lru_next = acl_eval_cache.lru_head;
+    if (acl_eval_cache.lru_head) {
+        acl_eval_cache.lru_head->aen_lru_prev = node;
+    }
+    acl_eval_cache.lru_head = node;
+    if (acl_eval_cache.lru_tail == NULL) {
+        acl_eval_cache.lru_tail = node;
+    }
+}
+
+/* Remove a node from every list it is on and free it. Needs the lock. */
+static void
+acl_eval_cache_remove_node(acl_eval_node *node)
+{
+    acl_eval_identity *ident = node->aen_identity;
+
+    PL_HashTableRemove(acl_eval_cache.nodes, node->aen_key);
+    acl_eval_cache_lru_unlink(node);
+
+    if (node->aen_id_prev) {
+        node->aen_id_prev->aen_id_next = node->aen_id_next;
+    } else {
+        ident->aei_nodes = node->aen_id_next;
+    }
+    if (node->aen_id_next) {
+        node->aen_id_next->aen_id_prev = node->aen_id_prev;
+    }
+    if (ident->aei_nodes == NULL) {
+        PL_HashTableRemove(acl_eval_cache.identities, ident->aei_ndn);
+        slapi_ch_free_string(&ident->aei_ndn);
+        slapi_ch_free((void **)&ident);
+    }
+
+    slapi_ch_free_string(&node->aen_key);
+    slapi_ch_free((void **)&node);
+    acl_eval_cache.count--;
+}
+
+/* Drop every node. Needs the lock. */
+static void
+acl_eval_cache_clear(void)
+{
+    while (acl_eval_cache.lru_head) {
+        acl_eval_cache_remove_node(acl_eval_cache.lru_head);
+    }
+}
+
+int
+acl_eval_cache_init(int max)
+{
+    if (acl_eval_cache.initialized) {
+        return 0;
+    }
+    if (pthread_mutex_init(&acl_eval_cache.lock, NULL) != 0) {
+        slapi_log_err(SLAPI_LOG_ERR, plugin_name,
+                      "acl_eval_cache_init - Unable to create the evaluation cache lock\n");
+        return 1;
+    }
+    acl_eval_cache.nodes = PL_NewHashTable(64, PL_HashString, PL_CompareStrings,
+                                           PL_CompareValues, NULL, NULL);
+    acl_eval_cache.identities = PL_NewHashTable(64, PL_HashString, PL_CompareStrings,
+                                                PL_CompareValues, NULL, NULL);
+    acl_eval_cache.max = max > 0 ? max : 0;
+    acl_eval_cache.initialized = 1;
+
+    return 0;
+}
+
+void
+acl_eval_cache_free(void)
+{
+    if (!acl_eval_cache.initialized) {
+        return;
+    }
+    pthread_mutex_lock(&acl_eval_cache.lock);
+    acl_eval_cache_clear();
+    PL_HashTableDestroy(acl_eval_cache.nodes);
+    PL_HashTableDestroy(acl_eval_cache.identities);
+    acl_eval_cache.nodes = NULL;
+    acl_eval_cache.identities = NULL;
+    acl_eval_cache.initialized = 0;
+    pthread_mutex_unlock(&acl_eval_cache.lock);
+    pthread_mutex_destroy(&acl_eval_cache.lock);
+}
+
+/*
+ * Build the cache key for this evaluation, or return NULL if the decision
+ * can't be cached. The caller holds the aci cache read lock, so the
+ * containers walked here are the ones acl__scan_for_acis() would use.
+ *
+ * Besides the identity, right, attribute and containers, the key records
+ * whether the entry is the client's own entry (for userdn "self") and,
+ * for every aci with a plain target dn, whether the entry is under it.
+ */
+static char *
+acl_eval_cache_make_key(Acl_PBlock *aclpb, const char *attr, int access)
+{
+    const char *ndn;
+    const char *res_ndn;
+    char buf[BUFSIZ];
+    size_t len;
+    aci_t *aci;
+    PRUint32 cookie;
+    int i;
+
+    if (access & ACL_EVAL_CACHE_SKIP_RIGHTS) {
+        return NULL;
+    }
+    /*
+     * The first attribute of an entry and the entry-list scan record
+     * state in the aclpb that later checks rely on; effective rights
+     * evaluate someone else's rights.
+     */
+    if ((aclpb->aclpb_state & (ACLPB_EVALUATING_FIRST_ATTR | ACLPB_SEARCH_BASED_ON_ENTRY_LIST)) ||
+        (aclpb->aclpb_res_type & ACLPB_EFFECTIVE_RIGHTS)) {
+        return NULL;
+    }
+    /* an empty list means every aci is scanned and matched by dn */
+    if (aclpb->aclpb_handles_index[0] == -1 ||
+        aclpb->aclpb_signature != acl_get_aclsignature()) {
+        return NULL;
+    }
+    if (aclpb->aclpb_authorization_sdn == NULL ||
+        (ndn = slapi_sdn_get_ndn(aclpb->aclpb_authorization_sdn)) == NULL ||
+        (res_ndn = slapi_sdn_get_ndn(aclpb->aclpb_curr_entry_sdn)) == NULL) {
+        return NULL;
+    }
+
+    len = snprintf(buf, sizeof(buf), "%s\1%d:", ndn, access);
+    for (i = 0; len < sizeof(buf) && i < aclpb_max_selected_acls &&
+                aclpb->aclpb_handles_index[i] != -1;
+         i++) {
+        len += snprintf(buf + len, sizeof(buf) - len, "%d,", aclpb->aclpb_handles_index[i]);
+    }
+    if (len < sizeof(buf)) {
+        len += snprintf(buf + len, sizeof(buf) - len, ":%c:",
+                        slapi_utf8casecmp((ACLUCHP)ndn, (ACLUCHP)res_ndn) == 0 ? 's' : '-');
+    }
+
+    for (aci = acllist_get_first_aci(aclpb, &cookie); aci && len < sizeof(buf);
+         aci = acllist_get_next_aci(aclpb, aci, &cookie)) {
+        if ((aci->aci_type & ACL_EVAL_CACHE_SKIP_TYPES) ||
+            (aci->aci_ruleType & ACL_EVAL_CACHE_SKIP_RULES) ||
+            aci->aci_macro) {
+            return NULL;
+        }
+        if ((aci->aci_type & ACI_TARGET_DN) && aci->target) {
+            char *avaType;
+            struct berval *avaValue;
+
+            slapi_filter_get_ava(aci->target, &avaType, &avaValue);
+            buf[len++] = slapi_dn_issuffix(res_ndn, avaValue->bv_val) ? '1' : '0';
+        }
+    }
+
+    if (len < sizeof(buf)) {
+        len += snprintf(buf + len, sizeof(buf) - len, ":%s", attr ? attr : "");
+    }
+    if (len >= sizeof(buf)) {
+        return NULL;
+    }
+
+    return slapi_ch_strdup(slapi_dn_ignore_case(buf));
+}
+
+/*
+ * Look up a cached decision.
+ *
+ * Returns LDAP_SUCCESS or LDAP_INSUFFICIENT_ACCESS on a hit, -1 otherwise.
+ * On a cacheable miss *key is set (to be passed to acl_eval_cache_store()
+ * or freed) together with the generation the lookup saw.
+ */
+int
+acl_eval_cache_lookup(Acl_PBlock *aclpb, const char *attr, int access, char **key, uint64_t *generation)
+{
+    acl_eval_node *node;
+    int rc = -1;
+
+    *key = NULL;
+    if (!acl_eval_cache.initialized || acl_eval_cache.max == 0) {
+        return -1;
+    }
+    if ((*key = acl_eval_cache_make_key(aclpb, attr, access)) == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&acl_eval_cache.lock);
+    *generation = acl_eval_cache.generation;
+    node = (acl_eval_node *)PL_HashTableLookup(acl_eval_cache.nodes, *key);
+    if (node) {
+        rc = node->aen_result;
+        acl_eval_cache_lru_unlink(node);
+        acl_eval_cache_lru_push(node);
+        acl_eval_cache.hits++;
+    } else {
+        acl_eval_cache.misses++;
+    }
+    pthread_mutex_unlock(&acl_eval_cache.lock);
+
+    if (node) {
+        slapi_ch_free_string(key);
+    }
+    return rc;
+}
+
+/* Insert a decision; takes ownership of key */
+void
+acl_eval_cache_store(char *key, uint64_t generation, int result)
+{
+    acl_eval_identity *ident;
+    acl_eval_node *node;
+    char *sep;
+
+    if (key == NULL) {
+        return;
+    }
+    if ((result != LDAP_SUCCESS && result != LDAP_INSUFFICIENT_ACCESS) ||
+        (sep = strchr(key, '\1')) == NULL) {
+        slapi_ch_free_string(&key);
+        return;
+    }
+
+    pthread_mutex_lock(&acl_eval_cache.lock);
+    if (generation != acl_eval_cache.generation ||
+        PL_HashTableLookup(acl_eval_cache.nodes, key)) {
+        pthread_mutex_unlock(&acl_eval_cache.lock);
+        slapi_ch_free_string(&key);
+        return;
+    }
+
+    while (acl_eval_cache.count >= acl_eval_cache.max && acl_eval_cache.lru_tail) {
+        acl_eval_cache_remove_node(acl_eval_cache.lru_tail);
+        acl_eval_cache.evictions++;
+    }
+
+    *sep = '\0';
+    ident = (acl_eval_identity *)PL_HashTableLookup(acl_eval_cache.identities, key);
+    if (ident == NULL) {
+        ident = (acl_eval_identity *)slapi_ch_calloc(1, sizeof(acl_eval_identity));
+        ident->aei_ndn = slapi_ch_strdup(key);
+        PL_HashTableAdd(acl_eval_cache.identities, ident->aei_ndn, ident);
+    }
+    *sep = '\1';
+
+    node = (acl_eval_node *)slapi_ch_calloc(1, sizeof(acl_eval_node));
+    node->aen_key = key;
+    node->aen_result = result;
+    node->aen_identity = ident;
+    node->aen_id_next = ident->aei_nodes;
+    if (ident->aei_nodes) {
+        ident->aei_nodes->aen_id_prev = node;
+    }
+    ident->aei_nodes = node;
+    PL_HashTableAdd(acl_eval_cache.nodes, node->aen_key, node);
+    acl_eval_cache_lru_push(node);
+    acl_eval_cache.count++;
+    acl_eval_cache.inserts++;
+    pthread_mutex_unlock(&acl_eval_cache.lock);
+}
+
+/* Called when acis or groups change */
+void
+acl_eval_cache_flush(void)
+{
+    if (!acl_eval_cache.initialized) {
+        return;
+    }
+    pthread_mutex_lock(&acl_eval_cache.lock);
+    acl_eval_cache.generation++;
+    if (acl_eval_cache.count) {
+        acl_eval_cache_clear();
+        acl_eval_cache.invalidations++;
+    }
+    pthread_mutex_unlock(&acl_eval_cache.lock);
+}
+
+/* Called when an entry changes: drop the decisions made for it as a client */
+void
+acl_eval_cache_invalidate_identity(const char *ndn)
+{
+    acl_eval_identity *ident;
+
+    if (!acl_eval_cache.initialized || ndn == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&acl_eval_cache.lock);
+    acl_eval_cache.generation++;
+    ident = (acl_eval_identity *)PL_HashTableLookup(acl_eval_cache.identities, ndn);
+    if (ident) {
+        /* removing the last node frees the identity */
+        while (ident->aei_nodes->aen_id_next) {
+            acl_eval_cache_remove_node(ident->aei_nodes);
+        }
+        acl_eval_cache_remove_node(ident->aei_nodes);
+        acl_eval_cache.invalidations++;
+    }
+    pthread_mutex_unlock(&acl_eval_cache.lock);
+}
+
+/* DSE monitor entry for the evaluation cache */
+static const char *acl_eval_cache_monitor_skeleton_entry =
+    "dn: " ACL_EVAL_CACHE_MONITOR_DN "\n"
+    "objectclass: top\n"
+    "objectclass: extensibleObject\n"
+    "cn: ACL Plugin\n";
+
+#define MSET(_attr)                                   \
+    do {                                              \
+        val.bv_val = buf;                             \
+        val.bv_len = strlen(buf);                     \
+        attrlist_replace(&e->e_attrs, (_attr), vals); \
+    } while (0)
+
+/*
+ * DSE search callback for the evaluation cache:
+ *
+ * - EvalCacheSize: configured maximum number of decisions
+ * - EvalCacheEntries: decisions currently cached
+ * - EvalCacheHits / EvalCacheMisses: lookups of cacheable decisions
+ * - EvalCacheInserts: decisions added
+ * - EvalCacheEvictions: decisions dropped to stay within the size
+ * - EvalCacheInvalidations: flushes and per-identity invalidations
+ */
+static int
+acl_eval_cache_monitor_search(Slapi_PBlock *pb __attribute__((unused)),
+                              Slapi_Entry *e,
+                              Slapi_Entry *entryAfter __attribute__((unused)),
+                              int *returncode,
+                              char *returntext,
+                              void *arg __attribute__((unused)))
+{
+    struct berval val;
+    struct berval *vals[2];
+    char buf[BUFSIZ];
+    int32_t max, count;
+    uint64_t hits, misses, inserts, evictions, invalidations;
+
+    vals[0] = &val;
+    vals[1] = NULL;
+
+    returntext[0] = '\0';
+
+    pthread_mutex_lock(&acl_eval_cache.lock);
+    max = acl_eval_cache.max;
+    count = acl_eval_cache.count;
+    hits = acl_eval_cache.hits;
+    misses = acl_eval_cache.misses;
+    inserts = acl_eval_cache.inserts;
+    evictions = acl_eval_cache.evictions;
+    invalidations = acl_eval_cache.invalidations;
+    pthread_mutex_unlock(&acl_eval_cache.lock);
+
+    snprintf(buf, sizeof(buf), "%d", max);
+    MSET("EvalCacheSize");
+    snprintf(buf, sizeof(buf), "%d", count);
+    MSET("EvalCacheEntries");
+    snprintf(buf, sizeof(buf), "%" PRIu64, hits);
+    MSET("EvalCacheHits");
+    snprintf(buf, sizeof(buf), "%" PRIu64, misses);
+    MSET("EvalCacheMisses");
+    snprintf(buf, sizeof(buf), "%" PRIu64, inserts);
+    MSET("EvalCacheInserts");
+    snprintf(buf, sizeof(buf), "%" PRIu64, evictions);
+    MSET("EvalCacheEvictions");
+    snprintf(buf, sizeof(buf), "%" PRIu64, invalidations);
+    MSET("EvalCacheInvalidations");
+
+    *returncode = LDAP_SUCCESS;
+    return SLAPI_DSE_CALLBACK_OK;
+}
+
+/*
+ * Add the monitor entry and register the search callback that fills it.
+ */
+void
+acl_eval_cache_monitor_init(void)
+{
+    Slapi_PBlock *pb;
+    Slapi_Entry *e;
+    char *ldif;
+    int result = 0;
+
+    if (!acl_eval_cache.initialized) {
+        return;
+    }
+
+    /* slapi_str2entry() parses the string in place */
+    ldif = slapi_ch_strdup(acl_eval_cache_monitor_skeleton_entry);
+    e = slapi_str2entry(ldif, 0);
+    slapi_ch_free_string(&ldif);
+    pb = slapi_pblock_new();
+    slapi_add_entry_internal_set_pb(pb, e, NULL,
+                                    aclplugin_get_identity(ACL_PLUGIN_IDENTITY), 0);
+    slapi_add_internal_pb(pb);
+    slapi_pblock_get(pb, SLAPI_PLUGIN_INTOP_RESULT, &result);
+    slapi_pblock_destroy(pb);
+
+    if (result != LDAP_SUCCESS && result != LDAP_ALREADY_EXISTS) {
+        slapi_log_err(SLAPI_LOG_WARNING, plugin_name,
+                      "acl_eval_cache_monitor_init - Unable to add %s: %s\n",
+                      ACL_EVAL_CACHE_MONITOR_DN, ldap_err2string(result));
+        return;
+    }
+    slapi_config_register_callback(SLAPI_OPERATION_SEARCH, DSE_FLAG_PREOP, ACL_EVAL_CACHE_MONITOR_DN,
+                                   LDAP_SCOPE_BASE, "(objectclass=*)", acl_eval_cache_monitor_search, NULL);
+}
+
+/*
+ * Remove the callback and the monitor entry.
+ */
+void
+acl_eval_cache_monitor_cleanup(void)
+{
+    Slapi_PBlock *pb;
+
+    if (!acl_eval_cache.initialized) {
+        return;
+    }
+    slapi_config_remove_callback(SLAPI_OPERATION_SEARCH, DSE_FLAG_PREOP, ACL_EVAL_CACHE_MONITOR_DN,
+                                 LDAP_SCOPE_BASE, "(objectclass=*)", acl_eval_cache_monitor_search);
+
+    pb = slapi_pblock_new();
+    slapi_delete_internal_set_pb(pb, ACL_EVAL_CACHE_MONITOR_DN, NULL, NULL,
+                                 aclplugin_get_identity(ACL_PLUGIN_IDENTITY), 0);
+    slapi_delete_internal_pb(pb);
+    slapi_pblock_destroy(pb);
+}
@@ -430,6 +430,7 @@ void
 aclg_regen_group_signature()
 {
     aclUserGroups->aclg_signature = aclutil_gen_signature(aclUserGroups->aclg_signature);
+    acl_eval_cache_flush();
 }
 
 void
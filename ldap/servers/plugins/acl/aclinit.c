@@ -152,6 +152,11 @@ aclinit_main()
     /* Initialize the user-group cache */
     rv = aclgroup_init();
 
+    /* Initialize the evaluation cache and its monitor entry */
+    if (acl_eval_cache_init(acl_eval_cache_size) == 0) {
+        acl_eval_cache_monitor_init();
+    }
+
     aclanom_gen_anomProfile(DO_TAKE_ACLCACHE_READLOCK);
 
     /* Register both of the proxied authorization controls (version 1 and 2) */
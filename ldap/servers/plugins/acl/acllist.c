@@ -17,8 +17,11 @@
  * ACLLIST
  *
  * All the ACLs are read when the server is started. The ACLs are
- * parsed and kept in an AVL tree. All the ACL List management are
- * in this file.
+ * parsed and kept in containers, one per entry holding acis. The
+ * containers are indexed by a trie of dn components (rdns), rooted at
+ * the empty dn, so the containers that apply to an entry are found with
+ * one hash lookup per rdn while walking down from its suffix. All the
+ * ACL List management are in this file.
  *
  * The locking on the aci cache is implemented using the acllist_acicache*()
  * routines--a read/write lock.
@@ -49,8 +52,37 @@ static Slapi_RWLock *aci_rwlock = NULL;
 #define ACILIST_UNLOCK_WRITE() slapi_rwlock_unlock(aci_rwlock)
 
 
+/*
+ * A node of the dn trie. The node for "ou=people,dc=example,dc=com" is the
+ * child "ou=people" of the node "dc=example" under the child "dc=com" of
+ * the root. Nodes exist only on the path to a container.
+ */
+typedef struct acl_dn_key
+{
+    const char *adk_rdn; /* not NUL terminated */
+    size_t adk_len;
+} AclDnKey;
+
+typedef struct acl_dn_node
+{
+    AclDnKey adn_key;               /* points into adn_rdn */
+    char *adn_rdn;
+    AciContainer *adn_container;    /* acis of the entry at this dn */
+    struct acl_dn_node *adn_parent;
+    PLHashTable *adn_children;      /* AclDnKey -> AclDnNode */
+} AclDnNode;
+
+/* One rdn of a dn being looked up, and its node if there is one */
+typedef struct acl_dn_level
+{
+    AclDnKey adl_key;
+    AclDnNode *adl_node;
+} AclDnLevel;
+
+#define ACLLIST_DN_LEVELS 32
+
 /* Root of the TREE */
-static Avlnode *acllistRoot = NULL;
+static AclDnNode *acllistRoot = NULL;
 
 #define CONTAINER_INCR 2000
 
@@ -62,10 +94,10 @@ static int curAciIndex = 1;
 
 /* PROTOTYPES */
 static int __acllist_add_aci(aci_t *aci);
-static int __acllist_aciContainer_node_cmp(caddr_t d1, caddr_t d2);
-static int __acllist_aciContainer_node_dup(caddr_t d1, caddr_t d2);
-
-void my_print(Avlnode *root);
+static AclDnNode *acllist_dn_node_new(AclDnNode *parent, const AclDnKey *key);
+static void acllist_dn_node_prune(AclDnNode *node);
+static int acllist_dn_levels(const char *ndn, AclDnLevel **levels, AclDnLevel *stack);
+static AclDnNode *acllist_dn_find(const char *ndn, int create);
 
 int
 acllist_init(void)
@@ -81,6 +113,7 @@ acllist_init(void)
                                                          CONTAINER_INCR * sizeof(AciContainer *));
     maxContainerIndex = CONTAINER_INCR;
     currContainerIndex = 0;
+    acllistRoot = acllist_dn_node_new(NULL, NULL);
 
     return 0;
 }
@@ -93,6 +126,169 @@ acllist_free(void)
         aci_rwlock = NULL;
     }
     slapi_ch_free((void **)&aciContainerArray);
+    slapi_ch_free((void **)&acllistRoot);
+}
+
+static PLHashNumber
+acllist_dn_key_hash(const void *key)
+{
+    const AclDnKey *k = (const AclDnKey *)key;
+    PLHashNumber h = 0;
+    size_t i;
+
+    for (i = 0; i < k->adk_len; i++) {
+        h = (h >> 28) ^ (h << 4) ^ (unsigned char)k->adk_rdn[i];
+    }
+    return h;
+}
+
+static PRIntn
+acllist_dn_key_cmp(const void *v1, const void *v2)
+{
+    const AclDnKey *k1 = (const AclDnKey *)v1;
+    const AclDnKey *k2 = (const AclDnKey *)v2;
+
+    return (k1->adk_len == k2->adk_len &&
+            memcmp(k1->adk_rdn, k2->adk_rdn, k1->adk_len) == 0);
+}
+
+static AclDnNode *
+acllist_dn_node_new(AclDnNode *parent, const AclDnKey *key)
+{
+    AclDnNode *node;
+
+    node = (AclDnNode *)slapi_ch_calloc(1, sizeof(AclDnNode));
+    node->adn_parent = parent;
+    if (key) {
+        node->adn_rdn = slapi_ch_malloc(key->adk_len + 1);
+        memcpy(node->adn_rdn, key->adk_rdn, key->adk_len);
+        node->adn_rdn[key->adk_len] = '\0';
+        node->adn_key.adk_rdn = node->adn_rdn;
+        node->adn_key.adk_len = key->adk_len;
+    }
+    if (parent) {
+        if (parent->adn_children == NULL) {
+            parent->adn_children = PL_NewHashTable(8, acllist_dn_key_hash,
+                                                   acllist_dn_key_cmp,
+                                                   PL_CompareValues, NULL, NULL);
+        }
+        PL_HashTableAdd(parent->adn_children, &node->adn_key, node);
+    }
+    return node;
+}
+
+/* Free node and the ancestors left without a container or children */
+static void
+acllist_dn_node_prune(AclDnNode *node)
+{
+    AclDnNode *parent;
+
+    while (node && node != acllistRoot && node->adn_container == NULL &&
+           (node->adn_children == NULL || node->adn_children->nentries == 0)) {
+        parent = node->adn_parent;
+        PL_HashTableRemove(parent->adn_children, &node->adn_key);
+        if (node->adn_children) {
+            PL_HashTableDestroy(node->adn_children);
+        }
+        slapi_ch_free_string(&node->adn_rdn);
+        slapi_ch_free((void **)&node);
+        node = parent;
+    }
+}
+
+/*
+ * Split a normalized, case-ignored dn into its rdns and look up the trie
+ * node of each one. levels[0] is the dn itself and levels[n - 1] its
+ * suffix; adl_node is NULL below the deepest node on the path. The empty
+ * dn has the root as its single level. levels is stack unless the dn has
+ * more than ACLLIST_DN_LEVELS rdns, in which case the caller frees it.
+ * Must be called with the acicache lock taken.
+ */
+static int
+acllist_dn_levels(const char *ndn, AclDnLevel **levels, AclDnLevel *stack)
+{
+    AclDnLevel *l = stack;
+    AclDnNode *node = acllistRoot;
+    const char *p;
+    size_t len;
+    int size = ACLLIST_DN_LEVELS;
+    int n = 0;
+    int i;
+
+    *levels = stack;
+    if (ndn == NULL) {
+        return 0;
+    }
+    if (*ndn == '\0') {
+        stack[0].adl_key.adk_rdn = ndn;
+        stack[0].adl_key.adk_len = 0;
+        stack[0].adl_node = acllistRoot;
+        return 1;
+    }
+
+    for (p = ndn; p; p = slapi_dn_find_parent(p)) {
+        if (n == size) {
+            size *= 2;
+            if (l == stack) {
+                l = (AclDnLevel *)slapi_ch_malloc(size * sizeof(AclDnLevel));
+                memcpy(l, stack, n * sizeof(AclDnLevel));
+            } else {
+                l = (AclDnLevel *)slapi_ch_realloc((char *)l, size * sizeof(AclDnLevel));
+            }
+        }
+        l[n].adl_key.adk_rdn = p;
+        n++;
+    }
+    for (i = 0; i < n; i++) {
+        if (i + 1 < n) {
+            /* drop the separator(s) before the parent */
+            len = l[i + 1].adl_key.adk_rdn - l[i].adl_key.adk_rdn;
+            while (len > 0 && (l[i].adl_key.adk_rdn[len - 1] == ',' ||
+                               l[i].adl_key.adk_rdn[len - 1] == ';')) {
+                len--;
+            }
+        } else {
+            len = strlen(l[i].adl_key.adk_rdn);
+        }
+        l[i].adl_key.adk_len = len;
+    }
+    for (i = n - 1; i >= 0; i--) {
+        if (node && node->adn_children) {
+            node = (AclDnNode *)PL_HashTableLookupConst(node->adn_children, &l[i].adl_key);
+        } else {
+            node = NULL;
+        }
+        l[i].adl_node = node;
+    }
+
+    *levels = l;
+    return n;
+}
+
+/* Return the trie node of ndn, creating the path to it if asked */
+static AclDnNode *
+acllist_dn_find(const char *ndn, int create)
+{
+    AclDnLevel stack[ACLLIST_DN_LEVELS];
+    AclDnLevel *levels;
+    AclDnNode *node = NULL;
+    int n, i;
+
+    n = acllist_dn_levels(ndn, &levels, stack);
+    if (n > 0) {
+        node = levels[0].adl_node;
+        if (node == NULL && create) {
+            node = acllistRoot;
+            for (i = n - 1; i >= 0; i--) {
+                node = levels[i].adl_node ? levels[i].adl_node
+                                          : acllist_dn_node_new(node, &levels[i].adl_key);
+            }
+        }
+    }
+    if (levels != stack) {
+        slapi_ch_free((void **)&levels);
+    }
+    return node;
 }
 
 /*
@@ -226,104 +422,66 @@ __acllist_add_aci(aci_t *aci)
 
     int rv = 0; /* OK */
     AciContainer *aciListHead;
-    AciContainer *head;
+    AclDnNode *node;
     PRUint32 i;
 
-    aciListHead = acllist_get_aciContainer_new();
-    slapi_sdn_set_ndn_byval(aciListHead->acic_sdn, slapi_sdn_get_ndn(aci->aci_sdn));
-
-    /* insert the aci */
-    switch (avl_insert(&acllistRoot, (caddr_t)aciListHead, __acllist_aciContainer_node_cmp,
-                       __acllist_aciContainer_node_dup)) {
-
-    case 1: /* duplicate ACL on the same entry */
-
-        /* Find the node that contains the acl. */
-        if (NULL == (head = (AciContainer *)avl_find(acllistRoot, (caddr_t)aciListHead,
-                                                     __acllist_aciContainer_node_cmp))) {
-            slapi_log_err(SLAPI_PLUGIN_ACL, plugin_name,
-                          "__acllist_add_aci - Can't insert the acl in the tree\n");
-            rv = 1;
-        } else {
-            aci_t *t_aci;
-            ;
-
-            /* Attach the list */
-            t_aci = head->acic_list;
-            ;
-            while (t_aci && t_aci->aci_next)
-                t_aci = t_aci->aci_next;
-
-            /* Now add the new one to the end of the list */
-            if (t_aci) {
-                t_aci->aci_next = aci;
-            }
-
-            slapi_log_err(SLAPI_LOG_ACL, plugin_name, "__acllist_add_aci - Added the ACL:%s to existing container:[%d]%s\n",
-                          aci->aclName, head->acic_index, slapi_sdn_get_ndn(head->acic_sdn));
-        }
-
-        /* now free the tmp container */
-        aciListHead->acic_list = NULL;
-        acllist_free_aciContainer(&aciListHead);
+    node = acllist_dn_find(slapi_sdn_get_ndn(aci->aci_sdn), 1 /* create */);
+    if (NULL == node) {
+        slapi_log_err(SLAPI_PLUGIN_ACL, plugin_name,
+                      "__acllist_add_aci - Can't insert the acl in the tree\n");
+        return 1;
+    }
 
-        break;
-    default:
-        /*  The container is inserted. Now hook up the aci and setup the
-         * container index. Donot free the "aciListHead" here.
-         */
-        aciListHead->acic_list = aci;
+    if (node->adn_container) {
+        /* duplicate ACL on the same entry */
+        aci_t *t_aci;
 
-        /*
-         * First, see if we have an open slot or not - -if we have reuse it
-         */
-        i = 0;
-        while ((i < currContainerIndex) && aciContainerArray[i])
-            i++;
+        /* Attach the list */
+        t_aci = node->adn_container->acic_list;
+        while (t_aci && t_aci->aci_next)
+            t_aci = t_aci->aci_next;
 
-        if (currContainerIndex >= (maxContainerIndex - 2)) {
-            maxContainerIndex += CONTAINER_INCR;
-            aciContainerArray = (AciContainer **)slapi_ch_realloc((char *)aciContainerArray,
-                                                                  maxContainerIndex * sizeof(AciContainer *));
+        /* Now add the new one to the end of the list */
+        if (t_aci) {
+            t_aci->aci_next = aci;
         }
-        aciListHead->acic_index = i;
-        /* If i < currContainerIndex, we are just re-using an old slot.               */
-        /* We don't need to increase currContainerIndex if we just re-use an old one. */
-        if (i == currContainerIndex)
-            currContainerIndex++;
-
-        aciContainerArray[aciListHead->acic_index] = aciListHead;
 
-        slapi_log_err(SLAPI_LOG_ACL, plugin_name, "__acllist_add_aci - Added %s to container:%d\n",
-                      slapi_sdn_get_ndn(aciListHead->acic_sdn), aciListHead->acic_index);
-        break;
+        slapi_log_err(SLAPI_LOG_ACL, plugin_name, "__acllist_add_aci - Added the ACL:%s to existing container:[%d]%s\n",
+                      aci->aclName, node->adn_container->acic_index,
+                      slapi_sdn_get_ndn(node->adn_container->acic_sdn));
+        return rv;
     }
 
-    return rv;
-}
-
-
-static int
-__acllist_aciContainer_node_cmp(caddr_t d1, caddr_t d2)
-{
-
-    int rc = 0;
-    AciContainer *c1 = (AciContainer *)d1;
-    AciContainer *c2 = (AciContainer *)d2;
+    /* Create the container and hook up the aci and the container index. */
+    aciListHead = acllist_get_aciContainer_new();
+    slapi_sdn_set_ndn_byval(aciListHead->acic_sdn, slapi_sdn_get_ndn(aci->aci_sdn));
+    aciListHead->acic_list = aci;
 
+    /*
+     * First, see if we have an open slot or not - -if we have reuse it
+     */
+    i = 0;
+    while ((i < currContainerIndex) && aciContainerArray[i])
+        i++;
+
+    if (currContainerIndex >= (maxContainerIndex - 2)) {
+        maxContainerIndex += CONTAINER_INCR;
+        aciContainerArray = (AciContainer **)slapi_ch_realloc((char *)aciContainerArray,
+                                                              maxContainerIndex * sizeof(AciContainer *));
+    }
+    aciListHead->acic_index = i;
+    /* If i < currContainerIndex, we are just re-using an old slot.               */
+    /* We don't need to increase currContainerIndex if we just re-use an old one. */
+    if (i == currContainerIndex)
+        currContainerIndex++;
 
-    rc = slapi_sdn_compare(c1->acic_sdn, c2->acic_sdn);
-    return rc;
-}
+    aciContainerArray[aciListHead->acic_index] = aciListHead;
+    node->adn_container = aciListHead;
 
-static int
-__acllist_aciContainer_node_dup(caddr_t d1 __attribute__((unused)), caddr_t d2 __attribute__((unused)))
-{
+    slapi_log_err(SLAPI_LOG_ACL, plugin_name, "__acllist_add_aci - Added %s to container:%d\n",
+                  slapi_sdn_get_ndn(aciListHead->acic_sdn), aciListHead->acic_index);
 
-    /* we allow duplicates  -- they are not exactly duplicates
-    ** but multiple aci value on the same node
-    */
-    return 1;
+    return rv;
 }
 
 /*
@@ -343,8 +501,8 @@ acllist_remove_aci_needsLock(const Slapi_DN *sdn, const struct berval *attr)
 
     aci_t *head, *next;
     int rv = 0;
-    AciContainer *aciListHead, *root;
-    AciContainer *dContainer;
+    AciContainer *root;
+    AclDnNode *node;
     int removed_anom_acl = 0;
 
     /* we used to delete the ACL by value but we don't do that anymore.
@@ -352,15 +510,11 @@ acllist_remove_aci_needsLock(const Slapi_DN *sdn, const struct berval *attr)
      * there are any more acls.
      */
 
-    aciListHead = acllist_get_aciContainer_new();
-    slapi_sdn_set_ndn_byval(aciListHead->acic_sdn, slapi_sdn_get_ndn(sdn));
-
     /* now find it */
-    if (NULL == (root = (AciContainer *)avl_find(acllistRoot, (caddr_t)aciListHead,
-                                                 __acllist_aciContainer_node_cmp))) {
+    node = acllist_dn_find(slapi_sdn_get_ndn(sdn), 0);
+    if (NULL == node || NULL == (root = node->adn_container)) {
         /* In that case we don't have any acl for this entry. cool !!! */
 
-        acllist_free_aciContainer(&aciListHead);
         slapi_log_err(SLAPI_LOG_ACL, plugin_name,
                       "acllist_remove_aci_needsLock - No acis to remove in this entry\n");
         return 0;
@@ -389,9 +543,9 @@ acllist_remove_aci_needsLock(const Slapi_DN *sdn, const struct berval *attr)
     slapi_log_err(SLAPI_LOG_ACL, plugin_name,
                   "acllist_remove_aci_needsLock - Removing container[%d]=%s\n", root->acic_index,
                   slapi_sdn_get_ndn(root->acic_sdn));
-    dContainer = (AciContainer *)avl_delete(&acllistRoot, (caddr_t)aciListHead,
-                                            __acllist_aciContainer_node_cmp);
-    acllist_free_aciContainer(&dContainer);
+    node->adn_container = NULL;
+    acllist_dn_node_prune(node);
+    acllist_free_aciContainer(&root);
 
     acl_regen_aclsignature();
     if (removed_anom_acl)
@@ -417,9 +571,6 @@ acllist_remove_aci_needsLock(const Slapi_DN *sdn, const struct berval *attr)
         }
     }
 
-    /* Now free the tmp container we used */
-    acllist_free_aciContainer(&aciListHead);
-
     /*
      * regenerate the anonymous profile if we have deleted
      * anyone acls.
@@ -458,23 +609,9 @@ acllist_free_aciContainer(AciContainer **container)
     slapi_ch_free((void **)container);
 }
 
-void
-acllist_done_aciContainer(AciContainer *head)
-{
-
-    PR_ASSERT(head != NULL);
-
-    slapi_sdn_done(head->acic_sdn);
-    head->acic_index = -1;
-
-    /* The caller is responsible for taking care of list */
-    head->acic_list = NULL;
-}
-
-static int
-free_aci_avl_container(caddr_t d)
+static void
+free_aci_container(AciContainer *data)
 {
-    AciContainer *data = (AciContainer *)d;
     aci_t *head, *next = NULL;
 
     head = data->acic_list;
@@ -487,14 +624,40 @@ free_aci_avl_container(caddr_t d)
     data->acic_list = NULL;
 
     acllist_free_aciContainer(&data);
-    return 0;
+}
+
+static PRIntn
+free_acl_dn_node(PLHashEntry *he, PRIntn i __attribute__((unused)), void *arg __attribute__((unused)))
+{
+    AclDnNode *node = (AclDnNode *)he->value;
+
+    if (node->adn_children) {
+        PL_HashTableEnumerateEntries(node->adn_children, free_acl_dn_node, NULL);
+        PL_HashTableDestroy(node->adn_children);
+    }
+    if (node->adn_container) {
+        free_aci_container(node->adn_container);
+    }
+    slapi_ch_free_string(&node->adn_rdn);
+    slapi_ch_free((void **)&node);
+    return HT_ENUMERATE_NEXT;
 }
 
 void
-free_acl_avl_list(void)
+free_acl_list(void)
 {
-    avl_free(acllistRoot, free_aci_avl_container);
-    acllistRoot = NULL;
+    if (acllistRoot == NULL) {
+        return;
+    }
+    if (acllistRoot->adn_children) {
+        PL_HashTableEnumerateEntries(acllistRoot->adn_children, free_acl_dn_node, NULL);
+        PL_HashTableDestroy(acllistRoot->adn_children);
+        acllistRoot->adn_children = NULL;
+    }
+    if (acllistRoot->adn_container) {
+        free_aci_container(acllistRoot->adn_container);
+        acllistRoot->adn_container = NULL;
+    }
 }
 
 aci_t *
@@ -616,16 +779,16 @@ void
 acllist_init_scan(Slapi_PBlock *pb, int scope __attribute__((unused)), const char *base)
 {
     Acl_PBlock *aclpb;
-    AciContainer *root;
+    AclDnLevel stack[ACLLIST_DN_LEVELS];
+    AclDnLevel *levels;
     char *basedn = NULL;
     int index;
+    int n, i;
 
     if (acl_skip_access_check(pb, NULL, 0)) {
         return;
     }
 
-    /*acllist_print_tree ( acllistRoot, &depth, "top", "top")    ; */
-    /* my_print ( acllistRoot );*/
     /* If we have an anonymous profile and I am an anom dude - let's skip it */
     if (aclanom_is_client_anonymous(pb)) {
         return;
@@ -650,38 +813,25 @@ acllist_init_scan(Slapi_PBlock *pb, int scope __attribute__((unused)), const cha
     acllist_acicache_READ_LOCK();
 
     basedn = slapi_ch_strdup(base);
+    slapi_dn_ignore_case(basedn);
     index = 0;
     slapi_ch_free_string(&aclpb->aclpb_search_base);
     aclpb->aclpb_search_base = slapi_ch_strdup(base);
 
-    while (basedn) {
-        char *tmp = NULL;
-
-        slapi_sdn_set_normdn_byref(aclpb->aclpb_aclContainer->acic_sdn, basedn);
-
-        root = (AciContainer *)avl_find(acllistRoot,
-                                        (caddr_t)aclpb->aclpb_aclContainer,
-                                        __acllist_aciContainer_node_cmp);
+    n = acllist_dn_levels(basedn, &levels, stack);
+    for (i = 0; i < n; i++) {
         if (index >= aclpb_max_selected_acls - 2) {
             aclpb->aclpb_handles_index[0] = -1;
-            slapi_ch_free_string(&basedn);
             break;
-        } else if (NULL != root) {
-            aclpb->aclpb_base_handles_index[index++] = root->acic_index;
+        } else if (levels[i].adl_node && levels[i].adl_node->adn_container) {
+            aclpb->aclpb_base_handles_index[index++] = levels[i].adl_node->adn_container->acic_index;
             aclpb->aclpb_base_handles_index[index] = -1;
-        } else if (NULL == root) {
-            /* slapi_dn_parent returns the "parent" dn syntactically.
-             * Most likely, basedn is above suffix (e.g., dn=com).
-             * Thus, no need to make it FATAL. */
-            slapi_log_err(SLAPI_LOG_ACL, plugin_name,
-                          "acllist_init_scan - Failed to find root for base: %s \n", basedn);
         }
-        tmp = slapi_dn_parent(basedn);
-        slapi_ch_free_string(&basedn);
-        basedn = tmp;
     }
-
-    acllist_done_aciContainer(aclpb->aclpb_aclContainer);
+    if (levels != stack) {
+        slapi_ch_free((void **)&levels);
+    }
+    slapi_ch_free_string(&basedn);
 
     if (aclpb->aclpb_base_handles_index[0] == -1)
         aclpb->aclpb_state &= ~ACLPB_SEARCH_BASED_ON_LIST;
@@ -701,10 +851,11 @@ void
 acllist_aciscan_update_scan(Acl_PBlock *aclpb, char *edn)
 {
 
+    AclDnLevel stack[ACLLIST_DN_LEVELS];
+    AclDnLevel *levels;
     int index = 0;
-    char *basedn = NULL;
-    AciContainer *root;
     int is_not_search_base = 1;
+    int n, i;
 
     if (!aclpb) {
         slapi_log_err(SLAPI_LOG_ACL, plugin_name,
@@ -734,50 +885,41 @@ acllist_aciscan_update_scan(Acl_PBlock *aclpb, char *edn)
      * Here, make a list of all the aci's that will apply
      * to edn ie. all aci's at and above edn in the DIT tree.
      *
-     * Do this by walking up edn, looking at corresponding
-     * points in the acllistRoot aci tree.
+     * Do this by walking down the dn trie along edn and picking
+     * up the containers found on the way, edn first.
      *
      * If is_not_search_base is true, then we need to iterate on edn, otherwise
-     * we've already got all the base handles above.
+     * we've already got all the base handles above. We stop below the
+     * search base, its handles are already in the list.
      *
     */
 
     if (is_not_search_base) {
 
-        basedn = slapi_ch_strdup(edn);
-
-        while (basedn) {
-            char *tmp = NULL;
-
-            slapi_sdn_set_ndn_byref(aclpb->aclpb_aclContainer->acic_sdn, basedn);
-
-            root = (AciContainer *)avl_find(acllistRoot,
-                                            (caddr_t)aclpb->aclpb_aclContainer,
-                                            __acllist_aciContainer_node_cmp);
-
+        acllist_acicache_READ_LOCK();
+        n = acllist_dn_levels(edn, &levels, stack);
+        for (i = 0; i < n; i++) {
+            if (i > 0 && aclpb->aclpb_search_base &&
+                (0 == strcasecmp(levels[i].adl_key.adk_rdn, aclpb->aclpb_search_base))) {
+                break;
+            }
             slapi_log_err(SLAPI_LOG_ACL, plugin_name,
-                          "acllist_aciscan_update_scan - Searching AVL tree for update:%s: container:%d\n",
-                          basedn, root ? root->acic_index : -1);
+                          "acllist_aciscan_update_scan - Searching for update:%s: container:%d\n",
+                          levels[i].adl_key.adk_rdn,
+                          (levels[i].adl_node && levels[i].adl_node->adn_container) ? levels[i].adl_node->adn_container->acic_index : -1);
             if (index >= aclpb_max_selected_acls - 2) {
                 aclpb->aclpb_handles_index[0] = -1;
-                slapi_ch_free((void **)&basedn);
                 break;
-            } else if (NULL != root) {
-                aclpb->aclpb_handles_index[index++] = root->acic_index;
+            } else if (levels[i].adl_node && levels[i].adl_node->adn_container) {
+                aclpb->aclpb_handles_index[index++] = levels[i].adl_node->adn_container->acic_index;
                 aclpb->aclpb_handles_index[index] = -1;
             }
-            tmp = slapi_dn_parent(basedn);
-            slapi_ch_free((void **)&basedn);
-            basedn = tmp;
-            if (aclpb->aclpb_search_base && tmp &&
-                (0 == strcasecmp(tmp, aclpb->aclpb_search_base))) {
-                slapi_ch_free((void **)&basedn);
-                tmp = NULL;
-            }
-        } /* while */
+        }
+        acllist_acicache_READ_UNLOCK();
+        if (levels != stack) {
+            slapi_ch_free((void **)&levels);
+        }
     }
-
-    acllist_done_aciContainer(aclpb->aclpb_aclContainer);
 }
 
 aci_t *
@@ -902,27 +1044,23 @@ acllist_acicache_WRITE_LOCK(void)
 int
 acllist_moddn_aci_needsLock(Slapi_DN *oldsdn, char *newdn)
 {
-    AciContainer *aciListHead;
     AciContainer *head;
+    AclDnNode *node;
     aci_t *acip;
     const char *oldndn;
 
     /* first get the container */
 
-    aciListHead = acllist_get_aciContainer_new();
-    slapi_sdn_free(&aciListHead->acic_sdn);
-    aciListHead->acic_sdn = oldsdn;
-
-    if (NULL == (head = (AciContainer *)avl_find(acllistRoot, (caddr_t)aciListHead,
-                                                 __acllist_aciContainer_node_cmp))) {
+    node = acllist_dn_find(slapi_sdn_get_ndn(oldsdn), 0);
+    if (NULL == node || NULL == (head = node->adn_container)) {
 
         slapi_log_err(SLAPI_PLUGIN_ACL, plugin_name,
                       "acllist_moddn_aci_needsLock - Can't find the acl in the tree for moddn operation:olddn%s\n",
                       slapi_sdn_get_ndn(oldsdn));
-        aciListHead->acic_sdn = NULL;
-        acllist_free_aciContainer(&aciListHead);
         return 1;
     }
+    node->adn_container = NULL;
+    acllist_dn_node_prune(node);
 
     /* Now set the new DN */
     slapi_sdn_set_normdn_byval(head->acic_sdn, newdn);
@@ -946,62 +1084,22 @@ acllist_moddn_aci_needsLock(Slapi_DN *oldsdn, char *newdn)
         }
     }
 
-    aciListHead->acic_sdn = NULL;
-    acllist_free_aciContainer(&aciListHead);
-
-    return 0;
-}
-
-void
-acllist_print_tree(Avlnode *root, int *depth, char *start, char *side)
-{
-
-    AciContainer *aciHeadList;
-
-    if (NULL == root) {
-        return;
+    /* and hang the container under its new dn */
+    node = acllist_dn_find(slapi_sdn_get_ndn(head->acic_sdn), 1 /* create */);
+    if (node->adn_container) {
+        /* the new entry already has acis: keep them first */
+        for (acip = node->adn_container->acic_list; acip && acip->aci_next; acip = acip->aci_next)
+            ;
+        if (acip) {
+            acip->aci_next = head->acic_list;
+        } else {
+            node->adn_container->acic_list = head->acic_list;
+        }
+        head->acic_list = NULL;
+        acllist_free_aciContainer(&head);
+    } else {
+        node->adn_container = head;
     }
-    aciHeadList = (AciContainer *)root->avl_data;
-    slapi_log_err(SLAPI_LOG_ACL, "plugin_name",
-                  "acllist_print_tree - Container[ Depth=%d%s-%s]: %s\n", *depth, start, side,
-                  slapi_sdn_get_ndn(aciHeadList->acic_sdn));
-
-    (*depth)++;
-
-    acllist_print_tree(root->avl_left, depth, side, "L");
-    acllist_print_tree(root->avl_right, depth, side, "R");
-
-    (*depth)--;
-}
-
-static void
-ravl_print(Avlnode *root, int depth)
-{
-    int i;
-
-    AciContainer *aciHeadList;
-    if (root == 0)
-        return;
-
-    ravl_print(root->avl_right, depth + 1);
-
-    for (i = 0; i < depth; i++)
-        printf("   ");
-    aciHeadList = (AciContainer *)root->avl_data;
-    printf("%s\n", slapi_sdn_get_ndn(aciHeadList->acic_sdn));
 
-    ravl_print(root->avl_left, depth + 1);
-}
-
-void
-my_print(Avlnode *root)
-{
-    printf("********\n");
-
-    if (root == 0)
-        printf("\tNULL\n");
-    else
-        (void)ravl_print(root, 0);
-
-    printf("********\n");
+    return 0;
 }
@@ -1018,6 +1018,13 @@ normalize_nextACERule:
                 goto error;
             }
 
+            /* parent and url filters look at the target or the
+             * client's entry: keep these out of the evaluation cache */
+            if (PL_strncasestr(s, "///parent", end - s) ||
+                PL_strnchr(s, '?', end - s)) {
+                aci_item->aci_type |= ACI_USERDN_ENTRY_RULE;
+            }
+
             /* skip the ldap prefix */
             prefix = PL_strncasestr(p, LDAP_URL_prefix, end - p);
             if (prefix) {
@@ -1730,6 +1737,16 @@ __aclp__init_targetattr(aci_t *aci, char *attr_val, char **errbuf)
 
     /* NULL teminate the list */
     attrArray[numattr] = NULL;
+
+    /* Summarize plain type names so most non-matching attrs skip the compares */
+    aci->targetAttrMask = 0;
+    for (numattr = 0; attrArray[numattr]; numattr++) {
+        if (!(attrArray[numattr]->attr_type & ACL_ATTR_STRING)) {
+            aci->targetAttrMask = 0;
+            break;
+        }
+        aci->targetAttrMask |= aclutil_attrtype_mask(attrArray[numattr]->u.attr_str);
+    }
     return 0;
 }
 
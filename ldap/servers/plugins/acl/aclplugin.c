@@ -267,7 +267,9 @@ aclplugin_stop(Slapi_PBlock *pb __attribute__((unused)))
 {
     int rc = 0; /* OK */
 
-    free_acl_avl_list();
+    acl_eval_cache_monitor_cleanup();
+    acl_eval_cache_free();
+    free_acl_list();
     ACL_Destroy();
     acl_destroy_aclpb_pool();
     acl_remove_ext();
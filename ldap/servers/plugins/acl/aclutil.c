@@ -472,6 +472,22 @@ aclutil_gen_signature(short c_signature)
     return o_signature;
 }
 
+/*
+ * Map the base name of an attribute type (options and case ignored) to
+ * one bit of a 64 bit set. Two types that compare equal with
+ * slapi_attr_type_cmp() always map to the same bit.
+ */
+PRUint64
+aclutil_attrtype_mask(const char *type)
+{
+    PRUint32 h = 0;
+
+    for (; type && *type && *type != ';'; type++) {
+        h = h * 31 + (unsigned char)tolower((unsigned char)*type);
+    }
+    return (PRUint64)1 << (h & 63);
+}
+
 void
 aclutil_print_resource(struct acl_pblock *aclpb, const char *right, char *attr, char *clientdn)
 {
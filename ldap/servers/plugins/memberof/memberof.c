@@ -174,7 +174,10 @@ static int memberof_add_objectclass(char *auto_add_oc, const char *dn);
 static int memberof_add_memberof_attr(LDAPMod **mods, const char *dn, char *add_oc);
 static memberof_cached_value *ancestors_cache_lookup(MemberOfConfig *config, const char *ndn);
 static PRBool ancestors_cache_remove(MemberOfConfig *config, const char *ndn);
-static PLHashEntry *ancestors_cache_add(MemberOfConfig *config, const void *key, void *value);
+static memberof_cached_value *ancestors_cache_add(MemberOfConfig *config, const void *key, memberof_cached_value *value);
+static int memberof_fixup_get_groups(MemberOfConfig *config, Slapi_Entry *e, Slapi_ValueSet **groups);
+static int memberof_fixup_apply(MemberOfConfig *config, Slapi_Entry *e, Slapi_ValueSet *groups);
+static int memberof_fix_memberof_parallel(MemberOfConfig *config, Slapi_Task *task, task_data *td, Slapi_Backend *be);
 static void memberof_set_entry_info(Slapi_Entry *e, MemberOfConfig *config, MemberofEntryInfo *entry_info);
 static int memberof_test_specific_filters(MemberOfConfig *config, MemberofEntryInfo *entry_info);
 static int memberof_monitor_search(Slapi_PBlock *pb, Slapi_Entry *e, Slapi_Entry *entryAfter, int *returncode, char *returntext, void *arg);
@@ -3443,9 +3446,7 @@ cache_ancestors(MemberOfConfig *config, Slapi_Value **member_ndn_val, memberof_g
     int count;
     int index;
     memberof_cached_value *cache_entry;
-#if MEMBEROF_CACHE_DEBUG
     memberof_cached_value *double_check;
-#endif
 
     if ((member_ndn_val == NULL) || (*member_ndn_val == NULL)) {
         slapi_log_err(SLAPI_LOG_FATAL, MEMBEROF_PLUGIN_SUBSYSTEM, "cache_ancestors: Fail to cache groups ancestor of unknown member\n");
@@ -3527,8 +3528,12 @@ cache_ancestors(MemberOfConfig *config, Slapi_Value **member_ndn_val, memberof_g
 #if MEMBEROF_CACHE_DEBUG
     dump_cache_entry(cache_entry, key);
 #endif
-    if (ancestors_cache_add(config, (const void*) key_copy, (void *) cache_entry) == NULL) {
-        slapi_log_err( SLAPI_LOG_FATAL, MEMBEROF_PLUGIN_SUBSYSTEM, "cache_ancestors: Failed to cache ancestor of %s\n", key);
+    double_check = ancestors_cache_add(config, (const void*) key_copy, cache_entry);
+    if (double_check != cache_entry) {
+        if (double_check == NULL) {
+            slapi_log_err( SLAPI_LOG_FATAL, MEMBEROF_PLUGIN_SUBSYSTEM, "cache_ancestors: Failed to cache ancestor of %s\n", key);
+        }
+        /* else another fixup thread cached the same ancestors meanwhile */
         ancestor_hashtable_entry_free(cache_entry);
         slapi_ch_free ((void**)&cache_entry);
         return;
@@ -4194,6 +4199,9 @@ memberof_fixup_task_thread(void *arg)
     task_data *td = NULL;
     int rc = 0;
     Slapi_PBlock *fixup_pb = NULL;
+    Slapi_Backend *be = NULL;
+    int64_t elapsed;
+    int parallel;
 
     if (!task) {
         return; /* no task */
@@ -4231,15 +4239,19 @@ memberof_fixup_task_thread(void *arg)
     /* Mark this as a task operation */
     configCopy.fixup_task = 1;
     configCopy.task = task;
+    /* The deferred update thread is not designed for concurrent fixups */
+    parallel = (configCopy.fixup_threads > 1 && !configCopy.deferred_update);
     Slapi_DN *sdn = slapi_sdn_new_dn_byref(td->dn);
     if (usetxn) {
-        Slapi_Backend *be = slapi_be_select_exact(sdn);
+        be = slapi_be_select_exact(sdn);
 
         if (be) {
             fixup_pb = slapi_pblock_new();
             slapi_pblock_set(fixup_pb, SLAPI_BACKEND, be);
-            /* Start a txn but not in deferred case: Should not do big txn in txn mode  */
-            if (!configCopy.deferred_update) {
+            /* Start a txn but not in deferred case: Should not do big txn in txn mode
+             * nor in parallel mode: the fixup threads have their own txn.
+             */
+            if (!configCopy.deferred_update && !parallel) {
                 rc = slapi_back_transaction_begin(fixup_pb);
                 if (rc) {
                     slapi_log_err(SLAPI_LOG_ERR, MEMBEROF_PLUGIN_SUBSYSTEM,
@@ -4259,23 +4271,30 @@ memberof_fixup_task_thread(void *arg)
     }
 
     /* do real work */
-    rc = memberof_fix_memberof(&configCopy, task, td);
+    if (parallel) {
+        rc = memberof_fix_memberof_parallel(&configCopy, task, td, be);
+    } else {
+        rc = memberof_fix_memberof(&configCopy, task, td);
+    }
 
 done:
     if (usetxn && fixup_pb) {
-        if (rc) { /* failed */
-            slapi_back_transaction_abort(fixup_pb);
-        } else {
-            slapi_back_transaction_commit(fixup_pb);
+        if (!parallel) {
+            if (rc) { /* failed */
+                slapi_back_transaction_abort(fixup_pb);
+            } else {
+                slapi_back_transaction_commit(fixup_pb);
+            }
         }
         slapi_pblock_destroy(fixup_pb);
     }
     memberof_free_config(&configCopy);
 
-    slapi_task_log_notice(task, "Memberof task finished (processed %d entries in %ld seconds)",
-                          fixup_progress_count, slapi_current_rel_time_t() - fixup_start_time);
-    slapi_task_log_status(task, "Memberof task finished (processed %d entries in %ld seconds)",
-                          fixup_progress_count, slapi_current_rel_time_t() - fixup_start_time);
+    elapsed = slapi_current_rel_time_t() - fixup_start_time;
+    slapi_task_log_notice(task, "Memberof task finished (processed %d entries in %ld seconds, %ld entries/s)",
+                          fixup_progress_count, elapsed, fixup_progress_count / (elapsed ? elapsed : 1));
+    slapi_task_log_status(task, "Memberof task finished (processed %d entries in %ld seconds, %ld entries/s)",
+                          fixup_progress_count, elapsed, fixup_progress_count / (elapsed ? elapsed : 1));
     slapi_task_inc_progress(task);
 
     /* Cleanup task linked list */
@@ -4441,9 +4460,9 @@ memberof_task_destructor(Slapi_Task *task)
                   "memberof_task_destructor <--\n");
 }
 
-/* The fixup task meat */
-int
-memberof_fix_memberof(MemberOfConfig *config, Slapi_Task *task, task_data *td)
+/* Runs the fixup search of the task, callback is called for each candidate */
+static int
+memberof_fixup_search(Slapi_Task *task, task_data *td, plugin_search_entry_callback callback, void *callback_data)
 {
     int rc = 0;
     Slapi_PBlock *search_pb = slapi_pblock_new();
@@ -4454,8 +4473,8 @@ memberof_fix_memberof(MemberOfConfig *config, Slapi_Task *task, task_data *td)
                                  memberof_get_plugin_id(),
                                  0);
     rc = slapi_search_internal_callback_pb(search_pb,
-                                           config,
-                                           0, memberof_fixup_memberof_callback,
+                                           callback_data,
+                                           0, callback,
                                            0);
     if (rc) {
         char *errmsg;
@@ -4475,6 +4494,260 @@ memberof_fix_memberof(MemberOfConfig *config, Slapi_Task *task, task_data *td)
     return rc;
 }
 
+/* The fixup task meat */
+int
+memberof_fix_memberof(MemberOfConfig *config, Slapi_Task *task, task_data *td)
+{
+    return memberof_fixup_search(task, td, memberof_fixup_memberof_callback, config);
+}
+
+/*
+ * Parallel fixup (memberOfFixupThreads > 1)
+ *
+ * The task thread runs the fixup search and hands the candidate entries
+ * to the fixup threads through a bounded queue. A fixup thread takes up
+ * to memberOfFixupBatchSize entries, computes their groups (searches
+ * only, so the fixup threads run concurrently), then replaces their
+ * memberOf values in a single backend transaction.
+ * The ancestors cache of the task config is shared by the fixup threads.
+ */
+typedef struct _fixup_queue
+{
+    pthread_mutex_t lock;
+    pthread_cond_t notempty;
+    pthread_cond_t notfull;
+    Slapi_Entry **entries; /* ring buffer of the candidates */
+    size_t first;
+    size_t count;
+    size_t size;
+    int done;              /* the search is over */
+    int rc;                /* first failure, stops the fixup */
+    MemberOfConfig *config;
+    Slapi_Backend *be;     /* backend of the transactions (txn mode only) */
+    char *bind_dn;
+} mo_fixup_queue;
+
+static void
+memberof_fixup_queue_fail(mo_fixup_queue *q, int rc)
+{
+    pthread_mutex_lock(&q->lock);
+    if (q->rc == 0) {
+        q->rc = rc;
+    }
+    pthread_cond_broadcast(&q->notempty);
+    pthread_cond_broadcast(&q->notfull);
+    pthread_mutex_unlock(&q->lock);
+}
+
+/* Search callback of the task thread: queues a candidate */
+static int
+memberof_fixup_queue_callback(Slapi_Entry *e, void *callback_data)
+{
+    mo_fixup_queue *q = (mo_fixup_queue *)callback_data;
+    int rc;
+
+    /* Always check shutdown in fixup task */
+    if (slapi_is_shutting_down()) {
+        memberof_fixup_queue_fail(q, -1);
+        return -1;
+    }
+
+    pthread_mutex_lock(&q->lock);
+    while (q->count == q->size && q->rc == 0) {
+        pthread_cond_wait(&q->notfull, &q->lock);
+    }
+    rc = q->rc;
+    if (rc == 0) {
+        q->entries[(q->first + q->count) % q->size] = slapi_entry_dup(e);
+        q->count++;
+        pthread_cond_signal(&q->notempty);
+    }
+    pthread_mutex_unlock(&q->lock);
+
+    return rc;
+}
+
+/* Fixes up a batch of entries, returns 0 or the first failure */
+static int
+memberof_fixup_batch(mo_fixup_queue *q, Slapi_Entry **entries, Slapi_ValueSet **groups, size_t count)
+{
+    MemberOfConfig *config = q->config;
+    Slapi_PBlock *txn_pb = NULL;
+    int rc = 0;
+
+    for (size_t i = 0; i < count && rc == 0; i++) {
+        rc = memberof_fixup_get_groups(config, entries[i], &groups[i]);
+    }
+
+    if (rc == 0 && usetxn && q->be) {
+        txn_pb = slapi_pblock_new();
+        slapi_pblock_set(txn_pb, SLAPI_BACKEND, q->be);
+        if ((rc = slapi_back_transaction_begin(txn_pb))) {
+            slapi_log_err(SLAPI_LOG_ERR, MEMBEROF_PLUGIN_SUBSYSTEM,
+                          "memberof_fixup_batch - Failed to start transaction\n");
+        }
+    }
+    for (size_t i = 0; i < count && rc == 0; i++) {
+        if (groups[i]) {
+            rc = memberof_fixup_apply(config, entries[i], groups[i]);
+        }
+    }
+    if (txn_pb) {
+        if (rc) {
+            slapi_back_transaction_abort(txn_pb);
+        } else {
+            slapi_back_transaction_commit(txn_pb);
+        }
+        slapi_pblock_destroy(txn_pb);
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        slapi_valueset_free(groups[i]);
+        groups[i] = NULL;
+    }
+    if (rc) {
+        slapi_log_err(SLAPI_LOG_PLUGIN, MEMBEROF_PLUGIN_SUBSYSTEM,
+                      "memberof_fixup_batch failed. rc=%d\n", rc);
+    }
+    return rc;
+}
+
+static void
+memberof_fixup_worker_thread(void *arg)
+{
+    slapi_set_thread_name("memberof-fixw");
+    mo_fixup_queue *q = (mo_fixup_queue *)arg;
+    size_t batch_size = q->config->fixup_batch_size;
+    Slapi_Entry **entries = (Slapi_Entry **)slapi_ch_calloc(batch_size, sizeof(Slapi_Entry *));
+    Slapi_ValueSet **groups = (Slapi_ValueSet **)slapi_ch_calloc(batch_size, sizeof(Slapi_ValueSet *));
+    int rc = 0;
+
+    /* set bind DN in the thread data */
+    slapi_td_set_dn(slapi_ch_strdup(q->bind_dn));
+
+    while (rc == 0) {
+        size_t count = 0;
+
+        pthread_mutex_lock(&q->lock);
+        while (q->count == 0 && !q->done && q->rc == 0) {
+            pthread_cond_wait(&q->notempty, &q->lock);
+        }
+        if (q->rc == 0) {
+            for (; q->count > 0 && count < batch_size; count++) {
+                entries[count] = q->entries[q->first];
+                q->first = (q->first + 1) % q->size;
+                q->count--;
+            }
+            pthread_cond_signal(&q->notfull);
+        }
+        pthread_mutex_unlock(&q->lock);
+
+        if (count == 0) {
+            /* the queue is drained, or the fixup failed */
+            break;
+        }
+        rc = memberof_fixup_batch(q, entries, groups, count);
+        for (size_t i = 0; i < count; i++) {
+            slapi_entry_free(entries[i]);
+        }
+    }
+    if (rc) {
+        memberof_fixup_queue_fail(q, rc);
+    }
+
+    slapi_ch_free((void **)&entries);
+    slapi_ch_free((void **)&groups);
+    slapi_td_set_dn(NULL);
+}
+
+static int
+memberof_fix_memberof_parallel(MemberOfConfig *config, Slapi_Task *task, task_data *td, Slapi_Backend *be)
+{
+    mo_fixup_queue q = {0};
+    pthread_mutex_t cache_lock;
+    PRThread **threads;
+    int nthreads = 0;
+    int rc = 0;
+
+    pthread_mutex_init(&cache_lock, NULL);
+    pthread_mutex_init(&q.lock, NULL);
+    pthread_cond_init(&q.notempty, NULL);
+    pthread_cond_init(&q.notfull, NULL);
+    q.size = (size_t)config->fixup_threads * config->fixup_batch_size * 2;
+    q.entries = (Slapi_Entry **)slapi_ch_calloc(q.size, sizeof(Slapi_Entry *));
+    q.config = config;
+    q.be = be;
+    q.bind_dn = td->bind_dn;
+    config->cache_lock = &cache_lock;
+
+    threads = (PRThread **)slapi_ch_calloc(config->fixup_threads, sizeof(PRThread *));
+    for (; nthreads < config->fixup_threads; nthreads++) {
+        threads[nthreads] = PR_CreateThread(PR_USER_THREAD, memberof_fixup_worker_thread,
+                                            (void *)&q, PR_PRIORITY_NORMAL, PR_GLOBAL_THREAD,
+                                            PR_JOINABLE_THREAD, SLAPD_DEFAULT_THREAD_STACKSIZE);
+        if (threads[nthreads] == NULL) {
+            slapi_log_err(SLAPI_LOG_ERR, MEMBEROF_PLUGIN_SUBSYSTEM,
+                          "memberof_fix_memberof_parallel - Unable to create fixup thread %d\n", nthreads);
+            break;
+        }
+    }
+
+    if (nthreads == 0) {
+        /* fall back to the sequential fixup */
+        rc = memberof_fix_memberof(config, task, td);
+    } else {
+        slapi_task_log_notice(task, "Memberof task runs with %d threads (%d entries per transaction)",
+                              nthreads, config->fixup_batch_size);
+        rc = memberof_fixup_search(task, td, memberof_fixup_queue_callback, &q);
+
+        pthread_mutex_lock(&q.lock);
+        q.done = 1;
+        pthread_cond_broadcast(&q.notempty);
+        pthread_mutex_unlock(&q.lock);
+        for (int i = 0; i < nthreads; i++) {
+            PR_JoinThread(threads[i]);
+        }
+        if (rc == 0) {
+            rc = q.rc;
+        }
+    }
+
+    /* entries left by a failed fixup */
+    for (; q.count > 0; q.count--) {
+        slapi_entry_free(q.entries[q.first]);
+        q.first = (q.first + 1) % q.size;
+    }
+    config->cache_lock = NULL;
+    slapi_ch_free((void **)&threads);
+    slapi_ch_free((void **)&q.entries);
+    pthread_cond_destroy(&q.notfull);
+    pthread_cond_destroy(&q.notempty);
+    pthread_mutex_destroy(&q.lock);
+    pthread_mutex_destroy(&cache_lock);
+
+    return rc;
+}
+
+/*
+ * The ancestors and fixup caches of a config are only shared, and locked,
+ * by the threads of a parallel fixup task
+ */
+static void
+memberof_cache_lock(MemberOfConfig *config)
+{
+    if (config->cache_lock) {
+        pthread_mutex_lock(config->cache_lock);
+    }
+}
+
+static void
+memberof_cache_unlock(MemberOfConfig *config)
+{
+    if (config->cache_lock) {
+        pthread_mutex_unlock(config->cache_lock);
+    }
+}
+
 static memberof_cached_value *
 ancestors_cache_lookup(MemberOfConfig *config, const char *ndn)
 {
@@ -4494,7 +4767,9 @@ ancestors_cache_lookup(MemberOfConfig *config, const char *ndn)
     }
 #endif
 
+    memberof_cache_lock(config);
     e = (memberof_cached_value *) PL_HashTableLookupConst(config->ancestors_cache, (const void *) ndn);
+    memberof_cache_unlock(config);
 
 #if defined(DEBUG)
     if (start) {
@@ -4528,7 +4803,9 @@ ancestors_cache_remove(MemberOfConfig *config, const char *ndn)
 #endif
 
 
+    memberof_cache_lock(config);
     rc = PL_HashTableRemove(config->ancestors_cache, (const void *)ndn);
+    memberof_cache_unlock(config);
 
 #if defined(DEBUG)
     if (start) {
@@ -4540,10 +4817,15 @@ ancestors_cache_remove(MemberOfConfig *config, const char *ndn)
     return rc;
 }
 
-static PLHashEntry *
-ancestors_cache_add(MemberOfConfig *config, const void *key, void *value)
+/*
+ * Caches value under key and returns it. If the parallel fixup threads
+ * share the cache and key is already cached, returns the cached value
+ * instead (the values of a key are identical). Returns NULL on failure.
+ */
+static memberof_cached_value *
+ancestors_cache_add(MemberOfConfig *config, const void *key, memberof_cached_value *value)
 {
-    PLHashEntry *e;
+    memberof_cached_value *cached = NULL;
 #if defined(DEBUG)
     long int start;
     struct timespec tsnow;
@@ -4558,7 +4840,14 @@ ancestors_cache_add(MemberOfConfig *config, const void *key, void *value)
     }
 #endif
 
-    e = PL_HashTableAdd(config->ancestors_cache, key, value);
+    memberof_cache_lock(config);
+    if (config->cache_lock) {
+        cached = (memberof_cached_value *)PL_HashTableLookupConst(config->ancestors_cache, key);
+    }
+    if (cached == NULL && PL_HashTableAdd(config->ancestors_cache, key, value) != NULL) {
+        cached = value;
+    }
+    memberof_cache_unlock(config);
 
 #if defined(DEBUG)
     if (start) {
@@ -4567,7 +4856,7 @@ ancestors_cache_add(MemberOfConfig *config, const void *key, void *value)
         }
     }
 #endif
-    return e;
+    return cached;
 }
 
 int
@@ -4590,13 +4879,36 @@ memberof_fixup_memberof_callback(Slapi_Entry *e, void *callback_data)
 int
 memberof_fix_memberof_callback(Slapi_Entry *e, void *callback_data)
 {
-    int rc = 0;
-    Slapi_DN *sdn = slapi_entry_get_sdn(e);
     MemberOfConfig *config = (MemberOfConfig *)callback_data;
-    memberof_del_dn_data del_data = {0, config->memberof_attr, config};
-    Slapi_ValueSet *groups = 0;
+    Slapi_ValueSet *groups = NULL;
+    int rc;
+
+    rc = memberof_fixup_get_groups(config, e, &groups);
+    if (rc == 0 && groups) {
+        rc = memberof_fixup_apply(config, e, groups);
+    }
+    slapi_valueset_free(groups);
+
+    if (rc) {
+        slapi_log_err(SLAPI_LOG_PLUGIN, MEMBEROF_PLUGIN_SUBSYSTEM,
+                      "memberof_fix_memberof_callback failed. rc=%d\n", rc);
+    }
+    return rc;
+}
+
+/*
+ * First step of the fixup of an entry: computes in *groups all the groups
+ * e belongs to. *groups is left NULL if e was already fixed up.
+ * This step only reads the database.
+ */
+static int
+memberof_fixup_get_groups(MemberOfConfig *config, Slapi_Entry *e, Slapi_ValueSet **groups)
+{
+    Slapi_DN *sdn = slapi_entry_get_sdn(e);
     const char *ndn;
-    char *dn_copy;
+    int fixed = 0;
+
+    *groups = NULL;
 
     /*
      * If the server is ordered to shutdown, stop the fixup and return an error.
@@ -4604,26 +4916,30 @@ memberof_fix_memberof_callback(Slapi_Entry *e, void *callback_data)
     if (!config->deferred_update && slapi_is_shutting_down()) {
         slapi_log_err(SLAPI_LOG_PLUGIN, MEMBEROF_PLUGIN_SUBSYSTEM, "memberof_fix_memberof_callback - "
                 "Aborted because shutdown is in progress. rc = -1\n");
-        rc = -1;
-        goto bail;
+        return -1;
     }
 
     /* Check if the entry has not already been fixed */
     ndn = slapi_sdn_get_ndn(sdn);
-    if (ndn && config->fixup_cache && PL_HashTableLookupConst(config->fixup_cache, (void *)ndn)) {
+    if (ndn && config->fixup_cache) {
+        memberof_cache_lock(config);
+        fixed = (PL_HashTableLookupConst(config->fixup_cache, (void *)ndn) != NULL);
+        memberof_cache_unlock(config);
+    }
+    if (fixed) {
         slapi_log_err(SLAPI_LOG_PLUGIN, MEMBEROF_PLUGIN_SUBSYSTEM, "memberof_fix_memberof_callback - "
                 "Entry %s already fixed up\n", ndn);
-        goto bail;
+        return 0;
     }
 
     /* get a list of all of the groups this user belongs to */
-    groups = memberof_get_groups(config, e, sdn);
+    *groups = memberof_get_groups(config, e, sdn);
 #if MEMBEROF_CACHE_DEBUG
     {
         Slapi_Value *val = 0;
         int hint = 0;
         struct berval *bv;
-        hint = slapi_valueset_first_value(groups, &val);
+        hint = slapi_valueset_first_value(*groups, &val);
         while (val) {
             /* this makes a copy of the berval */
             bv = slapi_value_get_berval(val);
@@ -4633,12 +4949,15 @@ memberof_fix_memberof_callback(Slapi_Entry *e, void *callback_data)
                               ndn,
                               bv->bv_val);
             }
-            hint = slapi_valueset_next_value(groups, hint, &val);
+            hint = slapi_valueset_next_value(*groups, hint, &val);
         }
     }
 #endif
 
-    if (config->group_filter) {
+    /* The cached ancestors of a leaf are only freed when the cache is not
+     * shared: a parallel fixup thread may be reading them.
+     */
+    if (config->group_filter && config->cache_lock == NULL) {
         if (slapi_filter_test_simple(e, config->group_filter)) {
             memberof_cached_value *ht_grp;
 
@@ -4670,6 +4989,22 @@ memberof_fix_memberof_callback(Slapi_Entry *e, void *callback_data)
             }
         }
     }
+    return 0;
+}
+
+/*
+ * Second step of the fixup of an entry: replaces its memberOf values
+ * with groups (computed by memberof_fixup_get_groups)
+ */
+static int
+memberof_fixup_apply(MemberOfConfig *config, Slapi_Entry *e, Slapi_ValueSet *groups)
+{
+    int rc = 0;
+    Slapi_DN *sdn = slapi_entry_get_sdn(e);
+    const char *ndn = slapi_sdn_get_ndn(sdn);
+    memberof_del_dn_data del_data = {0, config->memberof_attr, config};
+    char *dn_copy;
+
     /* If we found some groups, replace the existing memberOf attribute
      * with the found values.  */
     if (groups && slapi_valueset_count(groups)) {
@@ -4704,12 +5039,15 @@ memberof_fix_memberof_callback(Slapi_Entry *e, void *callback_data)
         memberof_del_dn_type_callback(e, &del_data);
     }
 
-    slapi_valueset_free(groups);
-
     /* records that this entry has been fixed up */
     if (config->fixup_cache) {
+        PLHashEntry *he;
+
         dn_copy = slapi_ch_strdup(ndn);
-        if (PL_HashTableAdd(config->fixup_cache, dn_copy, dn_copy) == NULL) {
+        memberof_cache_lock(config);
+        he = PL_HashTableAdd(config->fixup_cache, dn_copy, dn_copy);
+        memberof_cache_unlock(config);
+        if (he == NULL) {
             slapi_log_err(SLAPI_LOG_FATAL, MEMBEROF_PLUGIN_SUBSYSTEM, "memberof_fix_memberof_callback - "
                           "failed to add dn (%s) in the fixup hashtable; NSPR error - %d\n",
                           dn_copy, PR_GetError());
@@ -4719,28 +5057,31 @@ memberof_fix_memberof_callback(Slapi_Entry *e, void *callback_data)
     }
 
     if (config->task) {
+        int64_t now = slapi_current_rel_time_t();
+
+        PR_Lock(fixup_lock);
         fixup_progress_count++;
         if (fixup_progress_count % FIXUP_PROGRESS_LIMIT == 0 ) {
+            int64_t rate = FIXUP_PROGRESS_LIMIT / ((now > fixup_progress_elapsed) ? (now - fixup_progress_elapsed) : 1);
+
             slapi_task_log_notice(config->task,
-                    "Processed %d entries in %ld seconds (+%ld seconds)",
+                    "Processed %d entries in %ld seconds (+%ld seconds, %ld entries/s)",
                     fixup_progress_count,
-                    slapi_current_rel_time_t() - fixup_start_time,
-                    slapi_current_rel_time_t() - fixup_progress_elapsed);
+                    now - fixup_start_time,
+                    now - fixup_progress_elapsed,
+                    rate);
             slapi_task_log_status(config->task,
-                    "Processed %d entries in %ld seconds (+%ld seconds)",
+                    "Processed %d entries in %ld seconds (+%ld seconds, %ld entries/s)",
                     fixup_progress_count,
-                    slapi_current_rel_time_t() - fixup_start_time,
-                    slapi_current_rel_time_t() - fixup_progress_elapsed);
+                    now - fixup_start_time,
+                    now - fixup_progress_elapsed,
+                    rate);
             slapi_task_inc_progress(config->task);
-            fixup_progress_elapsed = slapi_current_rel_time_t();
+            fixup_progress_elapsed = now;
         }
+        PR_Unlock(fixup_lock);
     }
 
-bail:
-    if (rc) {
-        slapi_log_err(SLAPI_LOG_PLUGIN, MEMBEROF_PLUGIN_SUBSYSTEM,
-                      "memberof_fix_memberof_callback failed. rc=%d\n", rc);
-    }
     return rc;
 }
 
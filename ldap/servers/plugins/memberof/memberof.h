@@ -45,6 +45,10 @@
 #define MEMBEROF_AUTO_ADD_OC      "memberOfAutoAddOC"
 #define MEMBEROF_NEED_FIXUP       "memberOfNeedFixup"
 #define MEMBEROF_LAUNCH_FIXUP     "memberOfLaunchFixup"
+#define MEMBEROF_FIXUP_THREADS    "memberOfFixupThreads"
+#define MEMBEROF_FIXUP_BATCH_SIZE "memberOfFixupBatchSize"
+#define MEMBEROF_FIXUP_THREADS_DEFAULT    1   /* sequential fixup */
+#define MEMBEROF_FIXUP_BATCH_SIZE_DEFAULT 100 /* entries per transaction of a fixup thread */
 #define NSMEMBEROF                "nsMemberOf"
 #define MEMBEROF_ENTRY_SCOPE_EXCLUDE_SUBTREE "memberOfEntryScopeExcludeSubtree"
 #define DN_SYNTAX_OID             "1.3.6.1.4.1.1466.115.121.1.12"
@@ -150,6 +154,9 @@ typedef struct memberofconfig
     int need_fixup;
     PRBool launch_fixup;
     bool is_lmdb;
+    int fixup_threads;
+    int fixup_batch_size;
+    pthread_mutex_t *cache_lock; /* set while the caches are shared by parallel fixup threads */
 } MemberOfConfig;
 
 /* The key to access the hash table is the normalized DN
@@ -98,6 +98,21 @@ memberof_free_filter(Slapi_Filter ***filters, int *count)
     *count = 0;
 }
 
+/* Returns the value of a numeric config attribute, or -1 if it is not a number */
+static int
+memberof_config_number(const char *value)
+{
+    char *endp = NULL;
+    long num;
+
+    errno = 0;
+    num = strtol(value, &endp, 10);
+    if (errno || endp == value || *endp != '\0' || num < 0 || num > INT_MAX) {
+        return -1;
+    }
+    return (int)num;
+}
+
 /*
  * memberof_config()
  *
@@ -210,6 +225,7 @@ memberof_validate_config(Slapi_PBlock *pb,
     const char *skip_nested = NULL;
     const char *auto_add_oc = NULL;
     const char *all_backends = NULL;
+    const char *fixup_value = NULL;
     char **entry_scopes = NULL;
     char **entry_exclude_scopes = NULL;
     char **specific_group_filter = NULL;
@@ -296,6 +312,23 @@ memberof_validate_config(Slapi_PBlock *pb,
         }
     }
 
+    if ((fixup_value = slapi_entry_attr_get_ref(e, MEMBEROF_FIXUP_THREADS)) &&
+        memberof_config_number(fixup_value) < 1) {
+        PR_snprintf(returntext, SLAPI_DSE_RETURNTEXT_SIZE,
+                    "The %s configuration attribute must be set to "
+                    "a positive number.  (illegal value: %s)",
+                    MEMBEROF_FIXUP_THREADS, fixup_value);
+        goto done;
+    }
+    if ((fixup_value = slapi_entry_attr_get_ref(e, MEMBEROF_FIXUP_BATCH_SIZE)) &&
+        memberof_config_number(fixup_value) < 1) {
+        PR_snprintf(returntext, SLAPI_DSE_RETURNTEXT_SIZE,
+                    "The %s configuration attribute must be set to "
+                    "a positive number.  (illegal value: %s)",
+                    MEMBEROF_FIXUP_BATCH_SIZE, fixup_value);
+        goto done;
+    }
+
     /* Setup a default auto add OC */
     auto_add_oc = slapi_entry_attr_get_ref(e, MEMBEROF_AUTO_ADD_OC);
     if (auto_add_oc == NULL) {
@@ -591,6 +624,8 @@ memberof_apply_config(Slapi_PBlock *pb __attribute__((unused)),
     char *auto_add_oc = NULL;
     const char *needfixup = NULL;
     const char *launchfixup = NULL;
+    const char *fixup_threads = NULL;
+    const char *fixup_batch_size = NULL;
     int num_vals = 0;
 
     *returncode = LDAP_SUCCESS;
@@ -628,6 +663,8 @@ memberof_apply_config(Slapi_PBlock *pb __attribute__((unused)),
     auto_add_oc = slapi_entry_attr_get_charptr(e, MEMBEROF_AUTO_ADD_OC);
     needfixup = slapi_entry_attr_get_ref(e, MEMBEROF_NEED_FIXUP);
     launchfixup = slapi_entry_attr_get_ref(e, MEMBEROF_LAUNCH_FIXUP);
+    fixup_threads = slapi_entry_attr_get_ref(e, MEMBEROF_FIXUP_THREADS);
+    fixup_batch_size = slapi_entry_attr_get_ref(e, MEMBEROF_FIXUP_BATCH_SIZE);
 
     if (auto_add_oc == NULL) {
         auto_add_oc = slapi_ch_strdup(NSMEMBEROF);
@@ -778,6 +815,15 @@ memberof_apply_config(Slapi_PBlock *pb __attribute__((unused)),
         }
     }
 
+    theConfig.fixup_threads = MEMBEROF_FIXUP_THREADS_DEFAULT;
+    if (fixup_threads && memberof_config_number(fixup_threads) > 0) {
+        theConfig.fixup_threads = memberof_config_number(fixup_threads);
+    }
+    theConfig.fixup_batch_size = MEMBEROF_FIXUP_BATCH_SIZE_DEFAULT;
+    if (fixup_batch_size && memberof_config_number(fixup_batch_size) > 0) {
+        theConfig.fixup_batch_size = memberof_config_number(fixup_batch_size);
+    }
+
     if (allBackends) {
         if (strcasecmp(allBackends, "on") == 0) {
             theConfig.allBackends = 1;
@@ -955,8 +1001,10 @@ memberof_copy_config(MemberOfConfig *dest, MemberOfConfig *src)
 
         dest->deferred_update = src->deferred_update;
         dest->need_fixup = src->need_fixup;
+        dest->fixup_threads = src->fixup_threads;
+        dest->fixup_batch_size = src->fixup_batch_size;
         /*
-         * deferred_list, ancestors_cache, fixup_cache are not config parameters
+         * deferred_list, ancestors_cache, fixup_cache, cache_lock are not config parameters
          *  but simple global parameters and should not be copied as
          *  and they are only meaningful in the original config (i.e: theConfig)
          */
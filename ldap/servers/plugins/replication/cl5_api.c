@@ -1136,15 +1136,34 @@ cl5GetNextOperationToReplay(CL5ReplayIterator *iterator, CL5Entry *entry)
 
     /* there is an entry we should return */
     /* Callers of this function should cl5_operation_parameters_done(op) */
+    if (0 == clcache_get_decoded_change(iterator->clcache, csn, entry->op, &entry->time)) {
+        /* Another agreement already decoded this change */
+        return CL5_SUCCESS;
+    }
     if (0 != cl5DBData2Entry(data, datalen, entry, iterator->it_cldb->clcrypt_handle)) {
         slapi_log_err(SLAPI_LOG_ERR, repl_plugin_name_cl,
                       "cl5GetNextOperationToReplay - %s - Failed to format entry rc=%d\n", agmt_name, rc);
         return rc;
     }
+    clcache_put_decoded_change(iterator->clcache, entry->op, entry->time);
 
     return CL5_SUCCESS;
 }
 
+/* Name:        cl5GetReplayIteratorCacheStats
+   Description: returns how many changes of the session were found already
+                decoded in the shared changelog cache, and how many were not
+   Parameters:  iterator - replay iterator
+                hits - changes copied from the cache
+                misses - changes decoded from the changelog
+   Return:      none
+ */
+void
+cl5GetReplayIteratorCacheStats(CL5ReplayIterator *iterator, uint64_t *hits, uint64_t *misses)
+{
+    clcache_get_decoded_stats(iterator ? iterator->clcache : NULL, hits, misses);
+}
+
 /* Name:        cl5DestroyReplayIterator
    Description:    destorys iterator
    Parameters:  iterator - iterator to destory
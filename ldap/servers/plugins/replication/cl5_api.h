@@ -274,6 +274,15 @@ int cl5CreateReplayIteratorEx(Private_Repl_Protocol *prp, const RUV *consumerRuv
 int cl5GetNextOperationToReplay(CL5ReplayIterator *iterator,
                                 CL5Entry *entry);
 
+/* Name:        cl5GetReplayIteratorCacheStats
+   Description: returns the shared decoded change cache hits and misses
+                of the iterator session
+   Parameters:  iterator - replay iterator
+                hits, misses - output counters
+   Return:      none
+ */
+void cl5GetReplayIteratorCacheStats(CL5ReplayIterator *iterator, uint64_t *hits, uint64_t *misses);
+
 /* Name:        cl5DestroyReplayIterator
    Description: destroys iterator
    Parameters:  iterator - iterator to destroy
@@ -33,6 +33,20 @@
 #define DEFAULT_CLC_BUFFER_PAGE_SIZE 1024
 #define WORK_CLC_BUFFER_PAGE_SIZE 8 * DEFAULT_CLC_BUFFER_PAGE_SIZE
 
+/*
+ * Number of slots of the per changelog table of decoded changes.
+ * The table is direct mapped on the CSN so that agreements replaying
+ * the same window of the changelog decode each change only once.
+ */
+#define DEFAULT_CLC_DECODED_SLOTS 512
+
+/*
+ * Number of the last buffer loads kept per changelog, so that the
+ * agreements starting a load where another one just did reuse its
+ * records instead of reading the changelog again.
+ */
+#define DEFAULT_CLC_SHARED_LOADS 8
+
 enum
 {
     CLC_STATE_READY = 0,         /* ready to iterate */
@@ -46,6 +60,40 @@ enum
 
 typedef struct clc_busy_list CLC_Busy_List;
 
+/*
+ * A decoded (and decrypted) changelog record shared by the agreements.
+ * The slot holds one reference, each reader holds one while copying it.
+ */
+typedef struct clc_decoded_change
+{
+    uint64_t dc_refcnt;                 /* atomic */
+    time_t dc_time;                     /* CL5Entry time */
+    slapi_operation_parameters dc_op;   /* never modified once published */
+} CLC_Decoded_Change;
+
+typedef struct clc_record
+{
+    char *rec_key;
+    size_t rec_keylen;
+    void *rec_data;
+    size_t rec_datalen;
+} CLC_Record;
+
+/*
+ * The records of one buffer load, shared by the buffers of a changelog.
+ * The busy list holds one reference while the load is in bl_loads, each
+ * buffer iterating over it holds another one.
+ */
+typedef struct clc_load
+{
+    uint64_t ld_refcnt;                 /* atomic */
+    uint64_t ld_seq;                    /* bl_load_seq before the changelog was read */
+    dbi_op_t ld_dbop;                   /* how the load was positioned on ld_key */
+    char ld_key[CSN_STRSIZE + 1];
+    size_t ld_count;
+    CLC_Record *ld_records;
+} CLC_Load;
+
 struct csn_seq_ctrl_block
 {
     ReplicaId rid;          /* RID this block serves */
@@ -69,6 +117,7 @@ struct clc_buffer
     const RUV *buf_local_ruv;    /* used to refresh local_maxcsn */
     int buf_ignoreConsumerRID;   /* how to handle updates from consumer */
     int buf_load_cnt;            /* number of loads for session */
+    int buf_shared_load_cnt;     /* number of loads copied from another buffer */
 
     /*
      * fields for retriving data from DB
@@ -78,6 +127,9 @@ struct clc_buffer
     dbi_cursor_t buf_cursor;
     dbi_val_t buf_key;         /* current csn string */
     dbi_bulk_t buf_bulk;       /* bulk operation buffer */
+    CLC_Load *buf_load;        /* records of the current load, copied from buf_bulk or shared */
+    size_t buf_load_pos;       /* next record of buf_load */
+    uint64_t buf_ruv_seq;      /* bl_load_seq after the last local RUV snapshot */
     CSN *buf_missing_csn;      /* used to detect persistent missing of CSN */
     CSN *buf_prev_missing_csn; /* used to surpress the repeated messages */
     char buf_bulkdata[WORK_CLC_BUFFER_PAGE_SIZE];  /* default buf_bulk storage */
@@ -96,6 +148,8 @@ struct clc_buffer
     int buf_skipped_up_to_date;         /* number of changes skipped due to consumer being up-to-date for the given rid */
     int buf_skipped_csn_gt_ruv;         /* number of changes skipped due to preceedents are not covered by local RUV snapshot */
     int buf_skipped_csn_covered;        /* number of changes skipped due to CSNs already covered by consumer RUV */
+    uint64_t buf_decoded_hits;          /* number of changes found already decoded */
+    uint64_t buf_decoded_misses;        /* number of changes decoded by this session */
 
     /*
      * fields that should be accessed via bl_lock or pl_lock
@@ -114,6 +168,11 @@ struct clc_busy_list
     CLC_Buffer *bl_buffers; /* busy buffers of this list */
     CLC_Busy_List *bl_next; /* next busy list in the pool */
     Slapi_Backend *bl_be;   /* backend (to use dbimpl API) */
+    pthread_mutex_t bl_decoded_lock;    /* protects bl_decoded */
+    CLC_Decoded_Change **bl_decoded;    /* decoded changes shared by the buffers */
+    uint64_t bl_load_seq;               /* atomic, orders the RUV snapshots and the loads */
+    CLC_Load *bl_loads[DEFAULT_CLC_SHARED_LOADS]; /* last loads, protected by bl_lock */
+    int bl_next_load;                   /* slot of bl_loads to replace next */
 };
 
 /*
@@ -149,6 +208,11 @@ static CLC_Busy_List *clcache_new_busy_list(void);
 static void clcache_delete_busy_list(CLC_Busy_List **bl);
 static int clcache_enqueue_busy_list(Replica *replica, dbi_db_t *db, CLC_Buffer *buf);
 static void csn_dup_or_init_by_csn(CSN **csn1, CSN *csn2);
+static void clcache_release_decoded_change(CLC_Decoded_Change **dc);
+static void clcache_release_load(CLC_Load **ld);
+static int clcache_find_load(CLC_Buffer *buf, dbi_op_t dbop);
+static void clcache_publish_load(CLC_Buffer *buf, dbi_op_t dbop, uint64_t seq);
+static int clcache_load_next_record(CLC_Buffer *buf, dbi_val_t *key, dbi_val_t *data);
 
 /*
  * Initiates the process buffer pool. This should be done
@@ -224,6 +288,7 @@ clcache_get_buffer(Replica *replica, CLC_Buffer **buf, dbi_db_t *db, ReplicaId c
                       (_pool && _pool->pl_busy_lists) ? _pool->pl_busy_lists->bl_buffers : NULL);
         (*buf)->buf_state = CLC_STATE_READY;
         (*buf)->buf_load_cnt = 0;
+        (*buf)->buf_shared_load_cnt = 0;
         (*buf)->buf_record_cnt = 0;
         (*buf)->buf_record_skipped = 0;
         (*buf)->buf_cursor = cursor0;
@@ -232,6 +297,8 @@ clcache_get_buffer(Replica *replica, CLC_Buffer **buf, dbi_db_t *db, ReplicaId c
         (*buf)->buf_skipped_up_to_date = 0;
         (*buf)->buf_skipped_csn_gt_ruv = 0;
         (*buf)->buf_skipped_csn_covered = 0;
+        (*buf)->buf_decoded_hits = 0;
+        (*buf)->buf_decoded_misses = 0;
         (*buf)->buf_cscbs = (struct csn_seq_ctrl_block **)slapi_ch_calloc(MAX_NUM_OF_SUPPLIERS + 1,
                                                                           sizeof(struct csn_seq_ctrl_block *));
         (*buf)->buf_num_cscbs = 0;
@@ -289,21 +356,25 @@ clcache_return_buffer(CLC_Buffer **buf)
     int i;
 
     slapi_log_err(SLAPI_LOG_REPL, (*buf)->buf_agmt_name,
-                  "clcache_return_buffer - session end: state=%d load=%d sent=%d skipped=%d skipped_new_rid=%d "
+                  "clcache_return_buffer - session end: state=%d load=%d shared_load=%d sent=%d skipped=%d skipped_new_rid=%d "
                   "skipped_csn_gt_cons_maxcsn=%d skipped_up_to_date=%d "
-                  "skipped_csn_gt_ruv=%d skipped_csn_covered=%d\n",
+                  "skipped_csn_gt_ruv=%d skipped_csn_covered=%d "
+                  "decoded_hits=%" PRIu64 " decoded_misses=%" PRIu64 "\n",
                   (*buf)->buf_state,
                   (*buf)->buf_load_cnt,
+                  (*buf)->buf_shared_load_cnt,
                   (*buf)->buf_record_cnt - (*buf)->buf_record_skipped,
                   (*buf)->buf_record_skipped, (*buf)->buf_skipped_new_rid,
                   (*buf)->buf_skipped_csn_gt_cons_maxcsn,
                   (*buf)->buf_skipped_up_to_date, (*buf)->buf_skipped_csn_gt_ruv,
-                  (*buf)->buf_skipped_csn_covered);
+                  (*buf)->buf_skipped_csn_covered,
+                  (*buf)->buf_decoded_hits, (*buf)->buf_decoded_misses);
 
     for (i = 0; i < (*buf)->buf_num_cscbs; i++) {
         clcache_free_cscb(&(*buf)->buf_cscbs[i]);
     }
     slapi_ch_free((void **)&(*buf)->buf_cscbs);
+    clcache_release_load(&(*buf)->buf_load);
 
     dblayer_cursor_op(&(*buf)->buf_cursor, DBI_OP_CLOSE, NULL, NULL);
 }
@@ -332,6 +403,10 @@ clcache_load_buffer(CLC_Buffer *buf, CSN **anchorCSN, int *continue_on_miss, cha
     if (anchorCSN)
         *anchorCSN = NULL;
     clcache_refresh_local_maxcsns(buf);
+    if (buf->buf_busy_list) {
+        /* Only the loads read from now on cover this RUV snapshot */
+        buf->buf_ruv_seq = slapi_atomic_incr_64(&buf->buf_busy_list->bl_load_seq, __ATOMIC_ACQ_REL);
+    }
 
     if (buf->buf_load_cnt == 0) {
         clcache_refresh_consumer_maxcsns(buf);
@@ -443,6 +518,7 @@ clcache_load_buffer_bulk(CLC_Buffer *buf, dbi_op_t dbop)
     dbi_cursor_t cursor = {0};
     dbi_val_t data = {0};
     dbi_txn_t *txn = NULL;
+    uint64_t seq = 0;
     int tries = 0;
     int rc = 0;
 
@@ -460,6 +536,16 @@ clcache_load_buffer_bulk(CLC_Buffer *buf, dbi_op_t dbop)
     }
 
     PR_Lock(buf->buf_busy_list->bl_lock);
+    if (DBI_OP_MOVE_NEAR_KEY != dbop && clcache_find_load(buf, dbop)) {
+        /* Another agreement has just loaded these records */
+        PR_Unlock(buf->buf_busy_list->bl_lock);
+        buf->buf_shared_load_cnt++;
+        buf->buf_load_cnt++;
+        return 0;
+    }
+    /* Taken before reading so that the buffers which refreshed their RUV
+     * snapshot after this point do not reuse the records */
+    seq = slapi_atomic_incr_64(&buf->buf_busy_list->bl_load_seq, __ATOMIC_ACQ_REL);
 retry:
     if (0 == (rc = clcache_open_cursor(txn, buf, &cursor))) {
 
@@ -506,6 +592,11 @@ retry:
                       tries);
     }
 
+    clcache_release_load(&buf->buf_load);
+    if (0 == rc) {
+        clcache_publish_load(buf, dbop, seq);
+    }
+
     PR_Unlock(buf->buf_busy_list->bl_lock);
 
     if (0 == rc) {
@@ -529,14 +620,14 @@ clcache_get_next_change(CLC_Buffer *buf, void **key, size_t *keylen, void **data
     int rc = 0;
 
     do {
-        rc = dblayer_bulk_nextrecord(&buf->buf_bulk, &dbi_key, &dbi_data);
+        rc = clcache_load_next_record(buf, &dbi_key, &dbi_data);
         if (rc == DBI_RC_NOTFOUND && CLC_STATE_READY == buf->buf_state) {
             /*
              * We're done with the current buffer. Now load the next chunk.
              */
             rc = clcache_load_buffer(buf, NULL, NULL, initial_starting_csn);
             if (0 == rc) {
-                rc = dblayer_bulk_nextrecord(&buf->buf_bulk, &dbi_key, &dbi_data);
+                rc = clcache_load_next_record(buf, &dbi_key, &dbi_data);
             }
         }
 
@@ -981,6 +1072,7 @@ clcache_delete_buffer(CLC_Buffer **buf)
         if (bulkdata->data != (*buf)->buf_bulkdata) {
             slapi_ch_free(&bulkdata->data);
         }
+        clcache_release_load(&(*buf)->buf_load);
         csn_free(&((*buf)->buf_current_csn));
         csn_free(&((*buf)->buf_missing_csn));
         csn_free(&((*buf)->buf_prev_missing_csn));
@@ -1001,6 +1093,10 @@ clcache_new_busy_list(void)
         if (NULL == (bl->bl_lock = PR_NewLock()))
             break;
 
+        pthread_mutex_init(&bl->bl_decoded_lock, NULL);
+        bl->bl_decoded = (CLC_Decoded_Change **)slapi_ch_calloc(DEFAULT_CLC_DECODED_SLOTS,
+                                                                 sizeof(CLC_Decoded_Change *));
+
         /*
         if ( NULL == (bl->bl_max_csn = csn_new ()) )
             break;
@@ -1032,6 +1128,16 @@ clcache_delete_busy_list(CLC_Busy_List **bl)
         }
         (*bl)->bl_buffers = NULL;
         (*bl)->bl_db = NULL;
+        if ((*bl)->bl_decoded) {
+            for (size_t i = 0; i < DEFAULT_CLC_DECODED_SLOTS; i++) {
+                clcache_release_decoded_change(&(*bl)->bl_decoded[i]);
+            }
+            slapi_ch_free((void **)&(*bl)->bl_decoded);
+            pthread_mutex_destroy(&(*bl)->bl_decoded_lock);
+        }
+        for (size_t i = 0; i < DEFAULT_CLC_SHARED_LOADS; i++) {
+            clcache_release_load(&(*bl)->bl_loads[i]);
+        }
         if ((*bl)->bl_lock) {
             PR_Unlock((*bl)->bl_lock);
             PR_DestroyLock((*bl)->bl_lock);
@@ -1077,6 +1183,230 @@ clcache_enqueue_busy_list(Replica *replica, dbi_db_t *db, CLC_Buffer *buf)
     return rc;
 }
 
+static size_t
+clcache_decoded_slot(const CSN *csn)
+{
+    uint64_t h = (uint64_t)csn_get_time(csn);
+
+    h = h * 31 + csn_get_seqnum(csn);
+    h = h * 31 + csn_get_replicaid(csn);
+    h = h * 31 + csn_get_subseqnum(csn);
+    return (size_t)(h % DEFAULT_CLC_DECODED_SLOTS);
+}
+
+static void
+clcache_release_decoded_change(CLC_Decoded_Change **dc)
+{
+    if (dc && *dc) {
+        if (slapi_atomic_decr_64(&(*dc)->dc_refcnt, __ATOMIC_ACQ_REL) == 0) {
+            operation_parameters_done(&(*dc)->dc_op);
+            slapi_ch_free((void **)dc);
+        }
+        *dc = NULL;
+    }
+}
+
+/*
+ * Looks up the decoded change for csn in the table shared by all the
+ * buffers of the changelog. On a hit a private copy of the operation is
+ * stored in op (replay_update may strip the mods in place) and 0 is
+ * returned. The caller frees it with cl5_operation_parameters_done.
+ */
+int
+clcache_get_decoded_change(CLC_Buffer *buf, const CSN *csn, slapi_operation_parameters *op, time_t *time)
+{
+    CLC_Busy_List *bl = buf ? buf->buf_busy_list : NULL;
+    CLC_Decoded_Change *dc = NULL;
+    slapi_operation_parameters *copy = NULL;
+    size_t slot;
+
+    if (NULL == bl || NULL == bl->bl_decoded || NULL == csn || NULL == op) {
+        return -1;
+    }
+
+    slot = clcache_decoded_slot(csn);
+    pthread_mutex_lock(&bl->bl_decoded_lock);
+    dc = bl->bl_decoded[slot];
+    if (dc && csn_compare(dc->dc_op.csn, csn) == 0) {
+        slapi_atomic_incr_64(&dc->dc_refcnt, __ATOMIC_RELEASE);
+    } else {
+        dc = NULL;
+    }
+    pthread_mutex_unlock(&bl->bl_decoded_lock);
+
+    if (NULL == dc) {
+        buf->buf_decoded_misses++;
+        return -1;
+    }
+
+    /* Copy outside of the lock, our reference keeps the change alive */
+    copy = operation_parameters_dup(&dc->dc_op);
+    csn_free(&op->csn);
+    memcpy(op, copy, sizeof(slapi_operation_parameters));
+    slapi_ch_free((void **)&copy);
+    *time = dc->dc_time;
+    clcache_release_decoded_change(&dc);
+
+    buf->buf_decoded_hits++;
+    return 0;
+}
+
+/*
+ * Publishes a freshly decoded change so that the other agreements
+ * reading the same changelog do not decode it again. The table keeps
+ * its own copy, op still belongs to the caller.
+ */
+void
+clcache_put_decoded_change(CLC_Buffer *buf, const slapi_operation_parameters *op, time_t time)
+{
+    CLC_Busy_List *bl = buf ? buf->buf_busy_list : NULL;
+    CLC_Decoded_Change *dc = NULL;
+    CLC_Decoded_Change *old = NULL;
+    slapi_operation_parameters *copy = NULL;
+    size_t slot;
+
+    if (NULL == bl || NULL == bl->bl_decoded || NULL == op || NULL == op->csn) {
+        return;
+    }
+
+    dc = (CLC_Decoded_Change *)slapi_ch_calloc(1, sizeof(CLC_Decoded_Change));
+    copy = operation_parameters_dup((slapi_operation_parameters *)op);
+    memcpy(&dc->dc_op, copy, sizeof(slapi_operation_parameters));
+    slapi_ch_free((void **)&copy);
+    dc->dc_time = time;
+    dc->dc_refcnt = 1;
+
+    slot = clcache_decoded_slot(op->csn);
+    pthread_mutex_lock(&bl->bl_decoded_lock);
+    old = bl->bl_decoded[slot];
+    bl->bl_decoded[slot] = dc;
+    pthread_mutex_unlock(&bl->bl_decoded_lock);
+
+    clcache_release_decoded_change(&old);
+}
+
+/*
+ * Returns the decoded change lookups of the current session of buf.
+ */
+void
+clcache_get_decoded_stats(CLC_Buffer *buf, uint64_t *hits, uint64_t *misses)
+{
+    *hits = buf ? buf->buf_decoded_hits : 0;
+    *misses = buf ? buf->buf_decoded_misses : 0;
+}
+
+static void
+clcache_release_load(CLC_Load **ld)
+{
+    if (ld && *ld) {
+        if (slapi_atomic_decr_64(&(*ld)->ld_refcnt, __ATOMIC_ACQ_REL) == 0) {
+            for (size_t i = 0; i < (*ld)->ld_count; i++) {
+                slapi_ch_free_string(&(*ld)->ld_records[i].rec_key);
+                slapi_ch_free(&(*ld)->ld_records[i].rec_data);
+            }
+            slapi_ch_free((void **)&(*ld)->ld_records);
+            slapi_ch_free((void **)ld);
+        }
+        *ld = NULL;
+    }
+}
+
+/*
+ * Looks for a load of the busy list starting at the same place as the
+ * one buf is about to do. The load can only be reused if the changelog
+ * was read after buf took its local RUV snapshot, otherwise it could
+ * miss changes that buf expects to find.
+ * Called with bl_lock held.
+ */
+static int
+clcache_find_load(CLC_Buffer *buf, dbi_op_t dbop)
+{
+    CLC_Busy_List *bl = buf->buf_busy_list;
+
+    for (size_t i = 0; i < DEFAULT_CLC_SHARED_LOADS; i++) {
+        CLC_Load *ld = bl->bl_loads[i];
+
+        if (ld && ld->ld_dbop == dbop && ld->ld_seq > buf->buf_ruv_seq &&
+            strncmp(ld->ld_key, (char *)buf->buf_key.data, CSN_STRSIZE) == 0) {
+            slapi_atomic_incr_64(&ld->ld_refcnt, __ATOMIC_RELEASE);
+            clcache_release_load(&buf->buf_load);
+            buf->buf_load = ld;
+            buf->buf_load_pos = 0;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Copies the records just read in buf_bulk so that the other buffers
+ * of the busy list can reuse them, and makes them the current load of buf.
+ * Called with bl_lock held.
+ */
+static void
+clcache_publish_load(CLC_Buffer *buf, dbi_op_t dbop, uint64_t seq)
+{
+    CLC_Busy_List *bl = buf->buf_busy_list;
+    CLC_Load *ld = (CLC_Load *)slapi_ch_calloc(1, sizeof(CLC_Load));
+    dbi_val_t key = {0};
+    dbi_val_t data = {0};
+    size_t size = 0;
+
+    ld->ld_refcnt = 1;
+    ld->ld_seq = seq;
+    ld->ld_dbop = dbop;
+    PL_strncpyz(ld->ld_key, (char *)buf->buf_key.data, sizeof(ld->ld_key));
+
+    dblayer_bulk_start(&buf->buf_bulk);
+    while (dblayer_bulk_nextrecord(&buf->buf_bulk, &key, &data) == 0) {
+        CLC_Record *rec;
+
+        if (ld->ld_count == size) {
+            size = size ? 2 * size : 64;
+            ld->ld_records = (CLC_Record *)slapi_ch_realloc((char *)ld->ld_records, size * sizeof(CLC_Record));
+        }
+        rec = &ld->ld_records[ld->ld_count++];
+        /* keep the key NUL terminated for csn_init_by_string */
+        rec->rec_key = slapi_ch_calloc(1, key.size + 1);
+        memcpy(rec->rec_key, key.data, key.size);
+        rec->rec_keylen = key.size;
+        rec->rec_data = slapi_ch_malloc(data.size);
+        memcpy(rec->rec_data, data.data, data.size);
+        rec->rec_datalen = data.size;
+    }
+
+    /* The busy list keeps the initial reference */
+    clcache_release_load(&bl->bl_loads[bl->bl_next_load]);
+    bl->bl_loads[bl->bl_next_load] = ld;
+    bl->bl_next_load = (bl->bl_next_load + 1) % DEFAULT_CLC_SHARED_LOADS;
+
+    slapi_atomic_incr_64(&ld->ld_refcnt, __ATOMIC_RELEASE);
+    buf->buf_load = ld;
+    buf->buf_load_pos = 0;
+}
+
+/*
+ * Returns the next record of the current load of buf,
+ * DBI_RC_NOTFOUND once they have all been returned.
+ */
+static int
+clcache_load_next_record(CLC_Buffer *buf, dbi_val_t *key, dbi_val_t *data)
+{
+    CLC_Record *rec;
+
+    if (NULL == buf->buf_load || buf->buf_load_pos >= buf->buf_load->ld_count) {
+        key->data = NULL;
+        data->data = NULL;
+        return DBI_RC_NOTFOUND;
+    }
+    rec = &buf->buf_load->ld_records[buf->buf_load_pos++];
+    key->data = rec->rec_key;
+    key->size = rec->rec_keylen;
+    data->data = rec->rec_data;
+    data->size = rec->rec_datalen;
+    return 0;
+}
+
 static int
 clcache_open_cursor(dbi_txn_t *txn, CLC_Buffer *buf, dbi_cursor_t *cursor)
 {
@@ -26,6 +26,9 @@ int clcache_get_buffer(Replica *replica, CLC_Buffer **buf, dbi_db_t *db, Replica
 int clcache_load_buffer(CLC_Buffer *buf, CSN **anchorCSN, int *continue_on_miss, char *initial_starting_csn);
 void clcache_return_buffer(CLC_Buffer **buf);
 int clcache_get_next_change(CLC_Buffer *buf, void **key, size_t *keylen, void **data, size_t *datalen, CSN **csn, char *initial_starting_csn);
+int clcache_get_decoded_change(CLC_Buffer *buf, const CSN *csn, slapi_operation_parameters *op, time_t *time);
+void clcache_put_decoded_change(CLC_Buffer *buf, const slapi_operation_parameters *op, time_t time);
+void clcache_get_decoded_stats(CLC_Buffer *buf, uint64_t *hits, uint64_t *misses);
 void clcache_destroy(void);
 
 #endif
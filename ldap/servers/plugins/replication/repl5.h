@@ -455,6 +455,7 @@ void agmt_set_last_init_start(Repl_Agmt *ra, time_t start_time);
 void agmt_set_last_init_end(Repl_Agmt *ra, time_t end_time);
 void agmt_set_last_init_status(Repl_Agmt *ra, int ldaprc, int replrc, int connrc, const char *msg);
 void agmt_inc_last_update_changecount(Repl_Agmt *ra, ReplicaId rid, int skipped);
+void agmt_inc_decoded_cache_stats(Repl_Agmt *ra, uint64_t hits, uint64_t misses);
 void agmt_get_changecount_string(Repl_Agmt *ra, char *buf, int bufsize);
 int agmt_set_replicated_attributes_from_entry(Repl_Agmt *ra, const Slapi_Entry *e);
 int agmt_set_replicated_attributes_total_from_entry(Repl_Agmt *ra, const Slapi_Entry *e);
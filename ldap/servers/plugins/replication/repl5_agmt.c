@@ -106,6 +106,8 @@ typedef struct repl5agmt
     struct changecounter **changecounters; /* changes sent/skipped since server start up */
     int64_t num_changecounters;
     int64_t max_changecounters;
+    uint64_t decoded_cache_hits;           /* changes found decoded in the shared changelog cache */
+    uint64_t decoded_cache_misses;         /* changes decoded from the changelog */
     time_t last_update_start_time;         /* Local start time of last update session */
     time_t last_update_end_time;           /* Local end time of last update session */
     char last_update_status[STATUS_LEN];   /* Status of last update. Format = numeric code <space> textual description */
@@ -3091,6 +3093,18 @@ agmt_inc_last_update_changecount(Repl_Agmt *ra, ReplicaId rid, int skipped)
     }
 }
 
+void
+agmt_inc_decoded_cache_stats(Repl_Agmt *ra, uint64_t hits, uint64_t misses)
+{
+    PR_ASSERT(NULL != ra);
+    if (NULL != ra) {
+        PR_Lock(ra->lock);
+        ra->decoded_cache_hits += hits;
+        ra->decoded_cache_misses += misses;
+        PR_Unlock(ra->lock);
+    }
+}
+
 void
 agmt_get_changecount_string(Repl_Agmt *ra, char *buf, int bufsize)
 {
@@ -3127,6 +3141,8 @@ get_agmt_status(Slapi_PBlock *pb __attribute__((unused)),
     if (NULL != ra) {
         PRBool reapActive = PR_FALSE;
         Slapi_DN *replarea_sdn = NULL;
+        uint64_t decoded_hits = 0;
+        uint64_t decoded_misses = 0;
 
         replarea_sdn = agmt_get_replarea(ra);
         if (!replarea_sdn) {
@@ -3180,6 +3196,12 @@ get_agmt_status(Slapi_PBlock *pb __attribute__((unused)),
             slapi_entry_add_string(e, "nsds5replicaLastUpdateStatusJSON", ra->last_update_status_json);
         }
         slapi_entry_add_string(e, "nsds5replicaUpdateInProgress", ra->update_in_progress ? "TRUE" : "FALSE");
+        PR_Lock(ra->lock);
+        decoded_hits = ra->decoded_cache_hits;
+        decoded_misses = ra->decoded_cache_misses;
+        PR_Unlock(ra->lock);
+        slapi_entry_attr_set_ulong(e, "nsds5replicaDecodedCacheHits", decoded_hits);
+        slapi_entry_attr_set_ulong(e, "nsds5replicaDecodedCacheMisses", decoded_misses);
 
         /* In case last_init_start_time is not set, 19700101000000Z is set. */
         time_tmp = format_genTime(ra->last_init_start_time);
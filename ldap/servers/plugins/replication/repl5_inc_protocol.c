@@ -1552,6 +1552,8 @@ send_updates(Private_Repl_Protocol *prp, RUV *remote_update_vector, PRUint32 *nu
     CL5ReplayIterator *changelog_iterator;
     int message_id = 0;
     result_data *rd = NULL;
+    uint64_t decoded_hits = 0;
+    uint64_t decoded_misses = 0;
 
     *num_changes_sent = 0;
     /*
@@ -1928,6 +1930,8 @@ send_updates(Private_Repl_Protocol *prp, RUV *remote_update_vector, PRUint32 *nu
         repl5_inc_rd_destroy(&rd);
 
         cl5_operation_parameters_done(entry.op);
+        cl5GetReplayIteratorCacheStats(changelog_iterator, &decoded_hits, &decoded_misses);
+        agmt_inc_decoded_cache_stats(prp->agmt, decoded_hits, decoded_misses);
         cl5DestroyReplayIterator(&changelog_iterator, replica);
     }
     return return_value;
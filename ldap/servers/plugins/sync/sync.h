@@ -196,6 +196,7 @@ typedef struct sync_request
     Slapi_PBlock *req_pblock;
     Slapi_Operation *req_orig_op;
     PRLock *req_lock;
+    pthread_cond_t req_cvar; /* the request thread sleeps on this */
     PRThread *req_tid;
     char *req_orig_base;
     Slapi_Filter *req_filter;
@@ -217,8 +218,7 @@ typedef struct sync_request_list
 {
     Slapi_RWLock *sync_req_rwlock; /* R/W lock struct to serialize access */
     SyncRequest *sync_req_head;    /* Head of list */
-    pthread_mutex_t sync_req_cvarlock;    /* Lock for cvar */
-    pthread_cond_t sync_req_cvar;         /* ps threads sleep on this */
+    pthread_mutex_t sync_req_cvarlock;    /* Lock for the req_cvar of the requests */
     int sync_req_max_persist;
     int sync_req_cur_persist;
 } SyncRequestList;
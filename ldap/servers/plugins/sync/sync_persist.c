@@ -36,6 +36,7 @@ static SyncRequest *sync_request_alloc(void);
 void sync_queue_change(OPERATION_PL_CTX_T *operation);
 static void sync_send_results(void *arg);
 static void sync_request_wakeup_all(void);
+static void sync_request_wakeup(SyncRequest *req);
 static void sync_node_free(SyncQueueNode **node);
 
 static int sync_acquire_connection(Slapi_Connection *conn);
@@ -99,6 +100,7 @@ sync_request_free(SyncRequest **reqp)
     if (req->req_lock) {
         PR_DestroyLock(req->req_lock);
         req->req_lock = NULL;
+        pthread_cond_destroy(&(req->req_cvar));
     }
 
     slapi_ch_free((void **)reqp);
@@ -606,6 +608,9 @@ sync_queue_change(OPERATION_PL_CTX_T *operation)
                                                               "\"%s\" \n",
                       slapi_entry_get_dn_const(node->sync_entry));
             PR_Unlock(req->req_lock);
+
+            /* Notify the update thread of this request only */
+            sync_request_wakeup(req);
         }
     }
     /* Were there any matches? */
@@ -619,12 +624,6 @@ sync_queue_change(OPERATION_PL_CTX_T *operation)
                       slapi_entry_get_dn_const(e));
     }
     SYNC_UNLOCK_READ();
-
-    /* Were there any matches? */
-    if (matched) {
-        /* Notify update threads */
-        sync_request_wakeup_all();
-    }
 }
 /*
  * Initialize the list structure which contains the list
@@ -634,7 +633,6 @@ int
 sync_persist_initialize(int argc, char **argv)
 {
     if (!SYNC_IS_INITIALIZED()) {
-        pthread_condattr_t sync_req_condAttr; /* cond var attribute */
         int rc = 0;
 
         sync_request_list = (SyncRequestList *)slapi_ch_calloc(1, sizeof(SyncRequestList));
@@ -648,25 +646,6 @@ sync_persist_initialize(int argc, char **argv)
                           rc, strerror(rc));
             return (-1);
         }
-        if ((rc = pthread_condattr_init(&sync_req_condAttr)) != 0) {
-            slapi_log_err(SLAPI_LOG_ERR, "sync_persist_initialize",
-                          "Failed to create new condition attribute variable. error %d (%s)\n",
-                          rc, strerror(rc));
-            return (-1);
-        }
-        if ((rc = pthread_condattr_setclock(&sync_req_condAttr, CLOCK_MONOTONIC)) != 0) {
-            slapi_log_err(SLAPI_LOG_ERR, "sync_persist_initialize",
-                          "Cannot set condition attr clock. error %d (%s)\n",
-                          rc, strerror(rc));
-            return (-1);
-        }
-        if ((rc = pthread_cond_init(&(sync_request_list->sync_req_cvar), &sync_req_condAttr)) != 0) {
-            slapi_log_err(SLAPI_LOG_ERR, "sync_persist_initialize",
-                          "Failed to create new condition variable. error %d (%s)\n",
-                          rc, strerror(rc));
-            return (-1);
-        }
-        pthread_condattr_destroy(&sync_req_condAttr); /* no longer needed */
 
         sync_request_list->sync_req_head = NULL;
         sync_request_list->sync_req_cur_persist = 0;
@@ -809,7 +788,6 @@ sync_persist_terminate_all()
 
         slapi_destroy_rwlock(sync_request_list->sync_req_rwlock);
         pthread_mutex_destroy(&(sync_request_list->sync_req_cvarlock));
-		pthread_cond_destroy(&(sync_request_list->sync_req_cvar));
 
         /* it frees the structures, just in case it remained connected sync_repl client */
         for (req = sync_request_list->sync_req_head; NULL != req; req = next) {
@@ -829,6 +807,8 @@ static SyncRequest *
 sync_request_alloc(void)
 {
     SyncRequest *req;
+    pthread_condattr_t req_condAttr; /* cond var attribute */
+    int rc;
 
     req = (SyncRequest *)slapi_ch_calloc(1, sizeof(SyncRequest));
 
@@ -838,6 +818,18 @@ sync_request_alloc(void)
         slapi_ch_free((void **)&req);
         return (NULL);
     }
+    /* the request thread wakes up every second on a monotonic clock */
+    if ((rc = pthread_condattr_init(&req_condAttr)) != 0 ||
+        (rc = pthread_condattr_setclock(&req_condAttr, CLOCK_MONOTONIC)) != 0 ||
+        (rc = pthread_cond_init(&(req->req_cvar), &req_condAttr)) != 0) {
+        slapi_log_err(SLAPI_LOG_ERR, SYNC_PLUGIN_SUBSYSTEM,
+                      "sync_request_alloc - Failed to create new condition variable. error %d (%s)\n",
+                      rc, strerror(rc));
+        PR_DestroyLock(req->req_lock);
+        slapi_ch_free((void **)&req);
+        return (NULL);
+    }
+    pthread_condattr_destroy(&req_condAttr); /* no longer needed */
     req->req_tid = (PRThread *)NULL;
     req->req_complete = 0;
     req->req_cookie = NULL;
@@ -908,13 +900,30 @@ sync_remove_request(SyncRequest *req)
     }
 }
 
+/*
+ * Wakes up the thread of a request, the caller holds the list lock.
+ */
+static void
+sync_request_wakeup(SyncRequest *req)
+{
+    pthread_mutex_lock(&(sync_request_list->sync_req_cvarlock));
+    pthread_cond_signal(&(req->req_cvar));
+    pthread_mutex_unlock(&(sync_request_list->sync_req_cvarlock));
+}
+
 static void
 sync_request_wakeup_all(void)
 {
+    SyncRequest *req;
+
     if (SYNC_IS_INITIALIZED()) {
+        SYNC_LOCK_READ();
         pthread_mutex_lock(&(sync_request_list->sync_req_cvarlock));
-        pthread_cond_broadcast(&(sync_request_list->sync_req_cvar));
+        for (req = sync_request_list->sync_req_head; NULL != req; req = req->req_next) {
+            pthread_cond_signal(&(req->req_cvar));
+        }
         pthread_mutex_unlock(&(sync_request_list->sync_req_cvarlock));
+        SYNC_UNLOCK_READ();
     }
 }
 
@@ -1022,7 +1031,7 @@ sync_send_results(void *arg)
             struct timespec current_time = {0};
             clock_gettime(CLOCK_MONOTONIC, &current_time);
             current_time.tv_sec += 1;
-            pthread_cond_timedwait(&(sync_request_list->sync_req_cvar),
+            pthread_cond_timedwait(&(req->req_cvar),
                                    &(sync_request_list->sync_req_cvarlock),
                                    &current_time);
         } else {
@@ -186,22 +186,84 @@ string_filter_approx(struct berval *bvfilter, Slapi_Value **bvals, Slapi_Value *
     return (rc);
 }
 
+/*
+ * Match a normalized value against the normalized substring components.
+ * The components are plain strings (the filter parser has already split
+ * on '*'), so a prefix compare, a left-to-right strstr for each "any"
+ * piece and a suffix compare are equivalent to the "^i.*a.*f$" pattern
+ * we used to compile, without going through the regex engine.
+ * Returns 1 on a match, 0 otherwise.
+ */
+static int
+string_sub_match(const char *val, size_t vlen, const char *initial, char **any, const char * final, size_t minlen)
+{
+    const char *p = val;
+    const char *end = val + vlen;
+    size_t n;
+    int i;
+
+    if (vlen < minlen) {
+        return 0;
+    }
+    if (initial != NULL) {
+        n = strlen(initial);
+        if (memcmp(p, initial, n) != 0) {
+            return 0;
+        }
+        p += n;
+    }
+    for (i = 0; any && any[i]; i++) {
+        const char *q;
+
+        if (any[i][0] == '\0') {
+            continue;
+        }
+        q = strstr(p, any[i]);
+        if (q == NULL) {
+            return 0;
+        }
+        p = q + strlen(any[i]);
+    }
+    if (final != NULL) {
+        n = strlen(final);
+        if ((size_t)(end - p) < n) {
+            return 0;
+        }
+        return memcmp(end - n, final, n) == 0;
+    }
+    return 1;
+}
+
+/*
+ * Normalize one substring component of the filter, unless the caller
+ * tells us the filter is already normalized.  Returns an allocated copy.
+ */
+static char *
+string_sub_norm_comp(char *comp, int syntax, int trim_spaces, int filter_normalized)
+{
+    char *alt = NULL;
+
+    if (!filter_normalized) {
+        value_normalize_ext(comp, syntax, trim_spaces, &alt);
+    }
+    return alt ? alt : slapi_ch_strdup(comp);
+}
+
 int
 string_filter_sub(Slapi_PBlock *pb, char *initial, char **any, char * final, Slapi_Value **bvals, int syntax)
 {
-    int i, j, rc, size = 0;
-    char *p, *end, *realval, *tmpbuf = NULL, *bigpat = NULL;
+    int i, j, rc;
+    char *realval, *tmpbuf = NULL;
     size_t tmpbufsize;
-    char pat[BUFSIZ];
     char buf[BUFSIZ];
     struct timespec expire_time = {0};
     Operation *op = NULL;
-    Slapi_Regex *re = NULL;
-    char *re_result = NULL;
     char *alt = NULL;
+    char *ninitial = NULL;
+    char **nany = NULL;
+    char *nfinal = NULL;
+    size_t minlen = 0;
     int filter_normalized = 0;
-    int free_re = 1;
-    struct subfilt *sf = NULL;
 
     slapi_log_err(SLAPI_LOG_TRACE, SYNTAX_PLUGIN_SUBSYSTEM, "=> string_filter_sub\n");
     if (pb) {
@@ -214,114 +276,32 @@ string_filter_sub(Slapi_PBlock *pb, char *initial, char **any, char * final, Sla
     }
     if (pb) {
         slapi_pblock_get(pb, SLAPI_PLUGIN_SYNTAX_FILTER_NORMALIZED, &filter_normalized);
-        slapi_pblock_get(pb, SLAPI_PLUGIN_SYNTAX_FILTER_DATA, &sf);
     }
-    if (sf) {
-        re = (Slapi_Regex *)sf->sf_private;
-        if (re) {
-            free_re = 0;
-        }
-    }
-
-    if (!re) {
-        /*
-         * construct a regular expression corresponding to the
-         * filter and let regex do the work for each value
-         * XXX should do this once and save it somewhere XXX
-         */
-        pat[0] = '\0';
-        p = pat;
-        end = pat + sizeof(pat) - 2; /* leave room for null */
-
-        if (initial != NULL) {
-            size = strlen(initial) + 1; /* add 1 for "^" */
-        }
-
-        if (any != NULL) {
-            i = 0;
-            while (any[i]) {
-                size += strlen(any[i++]) + 2; /* add 2 for ".*" */
-            }
-        }
-
-        if (final != NULL) {
-            size += strlen(final) + 3; /* add 3 for ".*" and "$" */
-        }
-
-        size *= 2; /* doubled in case all filter chars need escaping */
-        size++;    /* add 1 for null */
 
-        if (p + size > end) {
-            bigpat = slapi_ch_malloc(size);
-            p = bigpat;
-        }
-
-        if (initial != NULL) {
-            /* 3rd arg: 1 - trim leading blanks */
-            if (!filter_normalized) {
-                value_normalize_ext(initial, syntax, 1, &alt);
-            }
-            *p++ = '^';
-            if (alt) {
-                filter_strcpy_special_ext(p, alt, FILTER_STRCPY_ESCAPE_RECHARS);
-                slapi_ch_free_string(&alt);
-            } else {
-                filter_strcpy_special_ext(p, initial, FILTER_STRCPY_ESCAPE_RECHARS);
-            }
-            p = strchr(p, '\0');
-        }
-        if (any != NULL) {
-            for (i = 0; any[i] != NULL; i++) {
-                /* 3rd arg: 0 - DO NOT trim leading blanks */
-                if (!filter_normalized) {
-                    value_normalize_ext(any[i], syntax, 0, &alt);
-                }
-                /* ".*" + value */
-                *p++ = '.';
-                *p++ = '*';
-                if (alt) {
-                    filter_strcpy_special_ext(p, alt, FILTER_STRCPY_ESCAPE_RECHARS);
-                    slapi_ch_free_string(&alt);
-                } else {
-                    filter_strcpy_special_ext(p, any[i], FILTER_STRCPY_ESCAPE_RECHARS);
-                }
-                p = strchr(p, '\0');
-            }
-        }
-        if (final != NULL) {
+    /*
+     * normalize the filter components once; the shortest value that can
+     * match is the sum of their lengths
+     */
+    if (initial != NULL) {
+        /* 3rd arg: 1 - trim leading blanks */
+        ninitial = string_sub_norm_comp(initial, syntax, 1, filter_normalized);
+        minlen += strlen(ninitial);
+    }
+    if (any != NULL) {
+        for (i = 0; any[i] != NULL; i++)
+            ;
+        nany = (char **)slapi_ch_calloc(i + 1, sizeof(char *));
+        for (i = 0; any[i] != NULL; i++) {
             /* 3rd arg: 0 - DO NOT trim leading blanks */
-            if (!filter_normalized) {
-                value_normalize_ext(final, syntax, 0, &alt);
-            }
-            /* ".*" + value */
-            *p++ = '.';
-            *p++ = '*';
-            if (alt) {
-                filter_strcpy_special_ext(p, alt, FILTER_STRCPY_ESCAPE_RECHARS);
-                slapi_ch_free_string(&alt);
-            } else {
-                filter_strcpy_special_ext(p, final, FILTER_STRCPY_ESCAPE_RECHARS);
-            }
-            strcat(p, "$");
-        }
-
-        /* compile the regex */
-        p = (bigpat) ? bigpat : pat;
-        tmpbuf = NULL;
-        re = slapi_re_comp(p, &re_result);
-        if (NULL == re) {
-            slapi_log_err(SLAPI_LOG_ERR, SYNTAX_PLUGIN_SUBSYSTEM,
-                          "string_filter_sub - re_comp (%s) failed (%s): %s\n",
-                          pat, p, re_result ? re_result : "unknown");
-            slapi_ch_free_string(&re_result);
-            rc = LDAP_OPERATIONS_ERROR;
-            goto bailout;
-        } else if (slapi_is_loglevel_set(SLAPI_LOG_TRACE)) {
-            char ebuf[BUFSIZ];
-            slapi_log_err(SLAPI_LOG_TRACE, SYNTAX_PLUGIN_SUBSYSTEM,
-                          "string_filter_sub - re_comp (%s)\n", escape_string(p, ebuf));
+            nany[i] = string_sub_norm_comp(any[i], syntax, 0, filter_normalized);
+            minlen += strlen(nany[i]);
         }
     }
+    if (final != NULL) {
+        /* 3rd arg: 0 - DO NOT trim leading blanks */
+        nfinal = string_sub_norm_comp(final, syntax, 0, filter_normalized);
+        minlen += strlen(nfinal);
+    }
 
     if (slapi_timespec_expire_check(&expire_time) == TIMER_EXPIRED) {
         slapi_log_err(SLAPI_LOG_TRACE, SYNTAX_PLUGIN_SUBSYSTEM, "LDAP_TIMELIMIT_EXCEEDED\n");
@@ -330,7 +310,7 @@ string_filter_sub(Slapi_PBlock *pb, char *initial, char **any, char * final, Sla
     }
 
     /*
-     * test the regex against each value
+     * test the components against each value
      */
     rc = -1;
     tmpbuf = NULL;
@@ -361,43 +341,34 @@ string_filter_sub(Slapi_PBlock *pb, char *initial, char **any, char * final, Sla
         } else if (syntax & SYNTAX_DN) {
             slapi_dn_ignore_case(realval);
         }
+        if (slapi_timespec_expire_check(&expire_time) == TIMER_EXPIRED) {
+            slapi_log_err(SLAPI_LOG_TRACE, SYNTAX_PLUGIN_SUBSYSTEM, "LDAP_TIMELIMIT_EXCEEDED\n");
+            rc = LDAP_TIMELIMIT_EXCEEDED;
+            goto bailout;
+        }
         if (alt) {
-            if (slapi_timespec_expire_check(&expire_time) == TIMER_EXPIRED) {
-                slapi_log_err(SLAPI_LOG_TRACE, SYNTAX_PLUGIN_SUBSYSTEM, "LDAP_TIMELIMIT_EXCEEDED\n");
-                rc = LDAP_TIMELIMIT_EXCEEDED;
-                goto bailout;
-            }
-            tmprc = slapi_re_exec_nt(re, alt);
+            tmprc = string_sub_match(alt, strlen(alt), ninitial, nany, nfinal, minlen);
             slapi_ch_free_string(&alt);
         } else {
-            if (slapi_timespec_expire_check(&expire_time) == TIMER_EXPIRED) {
-                slapi_log_err(SLAPI_LOG_TRACE, SYNTAX_PLUGIN_SUBSYSTEM, "LDAP_TIMELIMIT_EXCEEDED\n");
-                rc = LDAP_TIMELIMIT_EXCEEDED;
-                goto bailout;
-            }
-            tmprc = slapi_re_exec_nt(re, realval);
+            tmprc = string_sub_match(realval, strlen(realval), ninitial, nany, nfinal, minlen);
         }
 
         if (slapi_is_loglevel_set(SLAPI_LOG_TRACE)) {
             char ebuf[BUFSIZ];
-            slapi_log_err(SLAPI_LOG_TRACE, SYNTAX_PLUGIN_SUBSYSTEM, "re_exec (%s) %i\n",
+            slapi_log_err(SLAPI_LOG_TRACE, SYNTAX_PLUGIN_SUBSYSTEM, "string_filter_sub - (%s) %i\n",
                           escape_string(realval, ebuf), tmprc);
         }
         if (tmprc == 1) {
             rc = 0;
             break;
-        } else if (tmprc != 0) {
-            rc = tmprc;
-            break;
         }
     }
 bailout:
-    if (free_re) {
-        slapi_re_free(re);
-    }
     slapi_ch_free_string(&alt);
+    slapi_ch_free_string(&ninitial);
+    slapi_ch_array_free(nany);
+    slapi_ch_free_string(&nfinal);
     slapi_ch_free((void **)&tmpbuf); /* NULL is fine */
-    slapi_ch_free((void **)&bigpat); /* NULL is fine */
 
     slapi_log_err(SLAPI_LOG_TRACE, SYNTAX_PLUGIN_SUBSYSTEM, "<= string_filter_sub %d\n", rc);
     return (rc);
@@ -492,7 +463,7 @@ string_values2keys(Slapi_PBlock *pb, Slapi_Value **bvals, Slapi_Value ***ivals,
         char *buf;
         int i;
         int *substrlens = NULL;
-        int localsublens[3] = {SUBBEGIN, SUBMIDDLE, SUBEND}; /* default values */
+        int localsublens[INDEX_SUBSTRLEN] = {SUBBEGIN, SUBMIDDLE, SUBEND, 0}; /* default values */
         int maxsublen;
         /*
           * Substring key has 3 types:
@@ -512,6 +483,9 @@ string_values2keys(Slapi_PBlock *pb, Slapi_Value **bvals, Slapi_Value ***ivals,
           * [...]
           *
           * By default, begin == 3, middle == 3, end == 3 (defined in syntax.h)
+         *
+         * With nsSubStrPositions: N the middle keys also carry the offset of
+         * their gram in the value modulo N (e.g., *abc#2), see slap.h.
          */
 
         /* If nsSubStrLen is specified in each index entry,
@@ -534,7 +508,8 @@ string_values2keys(Slapi_PBlock *pb, Slapi_Value **bvals, Slapi_Value ***ivals,
         maxsublen = MAX_VAL(substrlens[INDEX_SUBSTRBEGIN], substrlens[INDEX_SUBSTRMIDDLE]);
         maxsublen = MAX_VAL(maxsublen, substrlens[INDEX_SUBSTREND]);
 
-        buf = (char *)slapi_ch_calloc(1, maxsublen + 1);
+        /* room for the #<offset> of the positional keys */
+        buf = (char *)slapi_ch_calloc(1, maxsublen + 3);
 
         nsubs = 0;
         for (bvlp = bvals; bvlp && *bvlp; bvlp++) {
@@ -612,6 +587,11 @@ string_values2keys(Slapi_PBlock *pb, Slapi_Value **bvals, Slapi_Value ***ivals,
                     buf[i] = p[i];
                 }
                 buf[substrlens[INDEX_SUBSTRMIDDLE]] = '\0';
+                if (substrlens[INDEX_SUBSTRPOSITIONS] > 0) {
+                    buf[i++] = INDEX_SUBSTRPOS_SEP;
+                    buf[i++] = "0123456789abcdef"[(p - bvp->bv_val) % substrlens[INDEX_SUBSTRPOSITIONS]];
+                    buf[i] = '\0';
+                }
                 (*ivals)[n] = slapi_value_new_string(buf);
                 slapi_value_set_flags((*ivals)[n], value_flags);
                 n++;
@@ -761,7 +741,7 @@ string_assertion2keys_sub(
     int nsubs, i, len;
     int initiallen = 0, finallen = 0;
     int *substrlens = NULL;
-    int localsublens[3] = {SUBBEGIN, SUBMIDDLE, SUBEND}; /* default values */
+    int localsublens[INDEX_SUBSTRLEN] = {SUBBEGIN, SUBMIDDLE, SUBEND, 0}; /* default values */
     int maxsublen;
     char *comp_buf = NULL;
     /* altinit|any|final: store alt string from value_normalize_ext if any,
@@ -872,7 +852,8 @@ string_assertion2keys_sub(
     maxsublen = MAX_VAL(maxsublen, substrlens[INDEX_SUBSTREND]);
 
     nsubs = 0;
-    comp_buf = (char *)slapi_ch_malloc(maxsublen + 1);
+    /* room for the #+<offset> of the positional keys */
+    comp_buf = (char *)slapi_ch_malloc(maxsublen + 16);
     if (altinit != NULL) {
         substring_comp_keys(ivals, &nsubs, altinit, initiallen, '^', syntax,
                             comp_buf, substrlens);
@@ -941,6 +922,20 @@ substring_comp_keys(
             comp_buf[i] = p[i];
         }
         comp_buf[substrlen] = '\0';
+        /*
+         * Positional keys: the initial component is at the start of the
+         * value so its offsets are known, the offsets of the others are
+         * relative to the component and the backend tries each alignment.
+         */
+        if (substrlens[INDEX_SUBSTRPOSITIONS] > 0) {
+            if (prepost == '^') {
+                snprintf(comp_buf + substrlen, 16, "%c%x", INDEX_SUBSTRPOS_SEP,
+                         (int)((p - str) % substrlens[INDEX_SUBSTRPOSITIONS]));
+            } else {
+                snprintf(comp_buf + substrlen, 16, "%c%c%d", INDEX_SUBSTRPOS_SEP,
+                         INDEX_SUBSTRPOS_REL, (int)(p - str));
+            }
+        }
         (*ivals)[*nsubs] = slapi_value_new_string(comp_buf);
         (*nsubs)++;
     }
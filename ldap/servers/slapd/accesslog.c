@@ -865,6 +865,15 @@ slapd_log_access_stat(slapd_log_pblock *logpb)
     if (logpb->stat_etime) {
         /* this is the summary stat */
         json_add_str(json_obj, "stat_etime", logpb->stat_etime);
+    } else if (logpb->stat_filter) {
+        /* this is a filter planner decision */
+        json_add_str(json_obj, "stat_filter", logpb->stat_filter);
+        json_object_object_add(json_obj, "stat_estimate", json_object_new_int64(logpb->stat_estimate));
+        if (logpb->stat_skipped) {
+            json_object_object_add(json_obj, "stat_skipped", json_object_new_boolean(true));
+        } else {
+            json_object_object_add(json_obj, "stat_count", json_object_new_int(logpb->stat_count));
+        }
     } else {
         json_add_str(json_obj, "stat_attr", logpb->stat_attr);
         json_add_str(json_obj, "stat_key", logpb->stat_key);
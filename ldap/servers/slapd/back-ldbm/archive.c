@@ -271,8 +271,11 @@ ldbm_back_ldbm2archive(Slapi_PBlock *pb)
     char *rawdirectory = NULL; /* -a <directory> */
     char *directory = NULL;    /* normalized */
     char *dir_bak = NULL;
+    char *rawbase = NULL;      /* incremental backup base */
+    char *base = NULL;         /* normalized */
     int return_value = -1;
     int task_flags = 0;
+    int backup_flags = 0;
     int run_from_cmdline = 0;
     Slapi_Task *task;
     struct stat sbuf;
@@ -280,6 +283,8 @@ ldbm_back_ldbm2archive(Slapi_PBlock *pb)
 
     slapi_pblock_get(pb, SLAPI_PLUGIN_PRIVATE, &li);
     slapi_pblock_get(pb, SLAPI_SEQ_VAL, &rawdirectory);
+    slapi_pblock_get(pb, SLAPI_BACKUP_INCREMENTAL_BASE, &rawbase);
+    slapi_pblock_get(pb, SLAPI_BACKUP_FLAGS, &backup_flags);
     slapi_pblock_get(pb, SLAPI_TASK_FLAGS, &task_flags);
     li->li_flags = run_from_cmdline = (task_flags & SLAPI_TASK_RUNNING_FROM_COMMANDLINE);
 
@@ -323,6 +328,37 @@ ldbm_back_ldbm2archive(Slapi_PBlock *pb)
         directory = slapi_ch_strdup(rawdirectory);
     }
 
+    if ((rawbase && *rawbase) || backup_flags) {
+        if (strcasecmp(li->li_backend_implement, LMDB_IMPL)) {
+            slapi_log_err(SLAPI_LOG_WARNING, "ldbm_back_ldbm2archive",
+                          "Incremental and compressed backups are only supported by lmdb. "
+                          "Performing a full backup.\n");
+            if (task) {
+                slapi_task_log_notice(task, "Incremental and compressed backups are only supported by lmdb. "
+                                            "Performing a full backup.");
+            }
+            backup_flags = 0;
+        } else if (rawbase && *rawbase) {
+            if (!is_abspath(rawbase)) {
+                char *bakdir = config_get_bakdir();
+                base = slapi_ch_smprintf("%s/%s", bakdir, rawbase);
+                slapi_ch_free_string(&bakdir);
+            } else {
+                base = slapi_ch_strdup(rawbase);
+            }
+            if (slapd_comp_path(directory, base) == 0) {
+                /* The directory is renamed (then removed) before the backup */
+                slapi_log_err(SLAPI_LOG_ERR,
+                              "ldbm_back_ldbm2archive", "A backup cannot be based on itself (%s).\n", base);
+                if (task) {
+                    slapi_task_log_notice(task, "A backup cannot be based on itself (%s).", base);
+                }
+                return_value = -1;
+                goto out;
+            }
+        }
+    }
+
     if (stat(directory, &sbuf) == 0) {
         if (slapd_comp_path(directory, li->li_directory) == 0) {
             slapi_log_err(SLAPI_LOG_ERR,
@@ -418,7 +454,11 @@ ldbm_back_ldbm2archive(Slapi_PBlock *pb)
     }
 
     /* tell it to archive */
+    li->li_backup_base = base;
+    li->li_backup_flags = backup_flags;
     return_value = dblayer_backup(li, directory, task);
+    li->li_backup_base = NULL;
+    li->li_backup_flags = 0;
     if (return_value) {
         slapi_log_err(SLAPI_LOG_BACKLDBM,
                       "ldbm_back_ldbm2archive", "dblayer_backup failed (%d).\n", return_value);
@@ -494,6 +534,7 @@ out:
 
     slapi_ch_free_string(&dir_bak);
     slapi_ch_free_string(&directory);
+    slapi_ch_free_string(&base);
     return return_value;
 }
 
@@ -197,6 +197,59 @@ extern int ldbm_warn_if_no_db;
  */
 #define FILTER_TEST_THRESHOLD (NIDS)10
 
+/*
+ * With the filter planner, an AND component whose estimated size is this
+ * many times larger than the smallest IDL already fetched is not read from
+ * the index: the filter test checks it on the few candidates left instead.
+ */
+#define FILTER_PLAN_SKIP_RATIO 64
+
+/*
+ * Index key estimates are cached per index (see index_read_estimate) in a
+ * table of this many slots, and trusted for this many seconds.
+ */
+#define INDEX_ESTIMATE_SLOTS 256
+#define INDEX_ESTIMATE_TTL 10
+
+/*
+ * Index usage statistics, published under cn=index-stats of each backend
+ * instance. An index is reported as not narrowing searches once it has
+ * been read this many times and returned ALLIDS for this share of them.
+ */
+#define INDEX_STATS_PRES   0
+#define INDEX_STATS_EQ     1
+#define INDEX_STATS_APPROX 2
+#define INDEX_STATS_SUB    3
+#define INDEX_STATS_RULES  4
+#define INDEX_STATS_TYPES  5
+#define INDEX_STATS_ADVICE_MIN_LOOKUPS  100
+#define INDEX_STATS_ADVICE_ALLIDS_PCT   90
+#define INDEX_STATS_OTHER_MAX           256
+#define INDEX_STATS_SEARCH_MAX          16
+
+struct index_stat
+{
+    uint64_t is_lookups;    /* index reads */
+    uint64_t is_candidates; /* ids returned, ALLIDS not counted */
+    uint64_t is_allids;     /* reads of an index that returned ALLIDS */
+    uint64_t is_unindexed;  /* reads answered with ALLIDS for lack of an index */
+    uint64_t is_filtertest; /* searches that read it and still ran the filter test */
+    uint64_t is_usec;       /* time spent in the reads */
+};
+
+struct index_stats
+{
+    struct index_stat iss_types[INDEX_STATS_TYPES];
+};
+
+/* Stats of the attributes that have no index configuration at all */
+struct index_stats_other
+{
+    char *iso_type;
+    struct index_stats iso_stats;
+    struct index_stats_other *iso_next;
+};
+
 /* flags to indicate what kind of startup the dblayer should do */
 #define DBLAYER_IMPORT_MODE                 0x1
 #define DBLAYER_NORMAL_MODE                 0x2
@@ -252,6 +305,9 @@ typedef uint32_t NIDS;
  *      containing a list of other blocks containing actual ids.
  *      the list is terminated by an id of NOID.
  *  b_ids   a list of the actual ids themselves
+ *  b_bitmap when set, the ids are held in this compressed bitmap instead
+ *      of b_ids (see idl_bitmap.c), and b_nids is the number of ids in
+ *      the bitmap.
  */
 #define ALLIDSBLOCK 0 /* == 0 => this is an allid block  */
 #define INDBLOCK    0 /* == 0 => this is an indirect blk */
@@ -259,6 +315,12 @@ typedef uint32_t NIDS;
 /* Default to holding 8 ids for idl_fetch_ext */
 #define IDLIST_MIN_BLOCK_SIZE 8
 
+/*
+ * When one id list is this many times larger than the other, intersecting
+ * them gallops in the large one (see idl_gallop) instead of merging both.
+ */
+#define IDL_GALLOP_RATIO 16
+
 typedef struct block
 {
     NIDS b_nmax;        /* max number of ids in this list  */
@@ -267,13 +329,17 @@ typedef struct block
                          * used by idl_set
                          */
     size_t itr;         /* internal tracker of iteration for set ops */
+    struct idl_bitmap *b_bitmap; /* compressed form of a large list */
     ID b_ids[1];        /* the ids - actually bigger       */
 } Block, IDList;
 
+typedef struct idl_bitmap IDBitmap;
+
 typedef struct _idlist_set
 {
     int64_t count;
     int64_t allids;
+    int64_t bitmaps;
     size_t total_size;
     IDList *minimum;
     IDList *head;
@@ -283,6 +349,7 @@ typedef struct _idlist_set
 #define ALLIDS(idl)         ((idl)->b_nmax == ALLIDSBLOCK)
 #define INDIRECT_BLOCK(idl) ((idl)->b_nids == INDBLOCK)
 #define IDL_NIDS(idl)       (idl ? (idl)->b_nids : (NIDS)0)
+#define IDL_BITMAP(idl)     ((idl)->b_bitmap != NULL)
 
 /*
  * used by the supplier during online total init
@@ -399,6 +466,13 @@ struct cache_stats
 };
 
 /* for the in-core cache of entries */
+/*
+ * Number of lock stripes protecting the buckets of the entry/dn cache hash
+ * tables. The table sizes are kept a multiple of it, so that every entry of
+ * a hash chain maps to the same stripe.
+ */
+#define CACHE_STRIPES 31
+
 struct cache
 {
     Hashtable *c_dntable;
@@ -415,6 +489,7 @@ struct cache
     struct cache_stats c_stats;
     struct ldbm_instance *c_inst;
     struct pinned_ctx  *c_pinned_ctx; /* Pinned entries handler context */
+    pthread_rwlock_t c_stripes[CACHE_STRIPES]; /* hash bucket locks, see cache_find_shared() */
 };
 
 #define CACHE_ADD(cache, p, a) cache_add((cache), (void *)(p), (void **)(a))
@@ -455,6 +530,14 @@ typedef struct attrcrypt_private   attrcrypt_private;
  * The length is changed by setting the triplets nsSubStrBegin, nsSubStrMiddle,
  * nsSubStrEnd, respectively.
  *
+ * nsSubStrPositions: N (2 to 16, off by default) adds the offset of each
+ * middle key in the value, modulo N, to the key. A search then only keeps
+ * the entries whose keys of an "any" component are at consecutive offsets,
+ * (mail=*smith*) no longer returns the entries that have "smi", "mit" and
+ * "ith" in unrelated places, and much fewer candidates go through the
+ * filter test. Each middle key is split in N keys, the index is not bigger
+ * but a search reads N times more keys.
+ *
  * Note: If any of the key length value is modified, the index file needs
  * to be regenerated.  Otherwise, the index file is going to have mixed
  * key length.
@@ -463,13 +546,15 @@ typedef struct attrcrypt_private   attrcrypt_private;
  * 2) run db2index -t <attr>,
  * 3) start the server.
  */
-#define INDEX_ATTR_SUBSTRBEGIN  "nsSubStrBegin"
-#define INDEX_ATTR_SUBSTRMIDDLE "nsSubStrMiddle"
-#define INDEX_ATTR_SUBSTREND    "nsSubStrEnd"
+#define INDEX_ATTR_SUBSTRBEGIN     "nsSubStrBegin"
+#define INDEX_ATTR_SUBSTRMIDDLE    "nsSubStrMiddle"
+#define INDEX_ATTR_SUBSTREND       "nsSubStrEnd"
+#define INDEX_ATTR_SUBSTRPOSITIONS "nsSubStrPositions"
 
-#define INDEX_SUBSTRBEGIN  0
-#define INDEX_SUBSTRMIDDLE 1
-#define INDEX_SUBSTREND    2
+#define INDEX_SUBSTRBEGIN     0
+#define INDEX_SUBSTRMIDDLE    1
+#define INDEX_SUBSTREND       2
+#define INDEX_SUBSTRPOSITIONS 3
 
 struct index_idlistsizeinfo
 {
@@ -534,6 +619,8 @@ struct attrinfo
                              */
     Slapi_Attr ai_sattr;                 /* interface to syntax and matching rule plugins */
     DataList *ai_idlistinfo;             /* fine grained id list */
+    struct index_estimates *ai_estimates; /* cached key cardinalities, see index_read_estimate */
+    struct index_stats *ai_stats;         /* usage counters, see index_stats_record */
 };
 
 struct id_array
@@ -659,6 +746,8 @@ struct ldbminfo
     char **li_attrs_to_exclude_from_export;
 
     int li_flags;
+    char *li_backup_base;                 /* db2archive: base of an incremental backup (lmdb) */
+    int li_backup_flags;                  /* db2archive: SLAPI_BACKUP_FLAG_* options */
     int li_fat_lock;                      /* 608146 -- make this configurable, first */
     int li_legacy_errcode;                /* 615428 -- in case legacy err code is expected */
     Slapi_Counter *li_global_usn_counter; /* global USN counter */
@@ -683,6 +772,22 @@ struct ldbminfo
     char *li_dynamic_lists_attr;
     char *li_dynamic_lists_oc;
     char *li_dynamic_lists_url_attr;
+
+    /* write id2entry records in the binary entry format */
+    bool li_id2entry_binary;
+
+    /* id lists longer than this are kept as compressed bitmaps (0: never) */
+    int li_idl_bitmap_threshold;
+
+    /* order and prune AND filter components on index key estimates */
+    bool li_filter_planner;
+
+    /* count index reads per attribute for cn=index-stats */
+    bool li_index_stats;
+
+    /* threads reading the candidates of large searches ahead of the worker */
+    int li_search_scan_threads;
+    int li_search_scan_min_candidates;
 };
 
 
@@ -840,8 +945,18 @@ typedef struct ldbm_instance
                                       * when they get added/removed from entry cache
                                       */
     Slapi_Regex *cache_debug_re;     /* Compiled version of cache_debug_pattern */
+    PRLock *inst_index_stats_mutex;  /* protects inst_index_stats_other */
+    PRLock *inst_attrs_mutex;        /* serializes the changes of inst_attrs with its walk by the index stats */
+    struct index_stats_other *inst_index_stats_other;
 } ldbm_instance;
 
+/* Read ahead of the candidates by the scan threads, see ldbm_search_scan.c */
+typedef struct ldbm_search_scan ldbm_search_scan;
+#define LDBM_SCAN_ENTRY 0
+#define LDBM_SCAN_SKIP 1
+#define LDBM_SCAN_MATCHED 2
+#define LDBM_SCAN_DONE 3
+
 /*
  * This structure is passed through the PBlock from ldbm_back_search to
  * ldbm_back_next_search_entry.  It contains the candidate result set
@@ -860,8 +975,12 @@ typedef struct _back_search_result_set
     int sr_current_sizelimit;     /* Current sizelimit */
     Slapi_Filter *sr_norm_filter; /* search filter pre-normalized */
     Slapi_Filter *sr_norm_filter_intent; /* intended search filter pre-normalized */
+    ldbm_search_scan *sr_scan;    /* candidates read by the scan threads */
+    struct index_stat *sr_index_stats[INDEX_STATS_SEARCH_MAX]; /* counters of the indexes read */
+    size_t sr_index_stats_count;
 } back_search_result_set;
 #define SR_FLAG_MUST_APPLY_FILTER_TEST 1 /* If set in sr_flags, means that we MUST apply the filter test */
+#define SR_FLAG_SCAN_CHECKED 2           /* sr_scan was set up, or is not used */
 
 #include "proto-back-ldbm.h"
 #include "ldbm_config.h"
@@ -103,12 +103,31 @@ static int dncache_replace(struct cache *cache, struct backdn *olddn, struct bac
 static int dncache_add_int(struct cache *cache, struct backdn *bdn, int state, struct backdn **alt);
 static struct backdn *dncache_flush(struct cache *cache);
 static int cache_is_in_cache_nolock(void *ptr);
+static int cache_remove_hash(struct cache *cache, Hashtable *ht, const void *key, uint32_t keylen);
 void pinned_remove(struct cache *cache, void *ptr);
 void pinned_flush(struct cache *cache);
 #ifdef LDAP_CACHE_DEBUG_LRU
 static void dn_lru_verify(struct cache *cache, struct backdn *dn, int in);
 #endif
 
+/*
+ * Locking
+ *
+ * The LRU, the pinned list, the statistics and any change of the hash
+ * tables are protected by c_mutex (cache_lock).  In addition, the buckets
+ * of the hash tables are protected by CACHE_STRIPES reader/writer locks:
+ * a writer must hold c_mutex and then the write lock of the stripe of the
+ * bucket it changes (see cache_add_hash/cache_remove_hash).
+ *
+ * That allows cache_find_shared() to take one more reference on an entry
+ * that is already referenced by another thread while only holding the read
+ * lock of its stripe.  Such entries are neither on the LRU nor evictable,
+ * so nothing but the refcnt is changed.  The refcnt is only ever modified
+ * atomically, and its 0 <-> 1 transitions (which move the entry off/on
+ * the LRU) always happen under c_mutex.  That keeps the hot entries (search
+ * bases, their parents, groups) from serializing every worker on c_mutex.
+ */
+
 /***** tiny hashtable implementation *****/
 
 #define HASH_VALUE(_key, _keylen) \
@@ -289,7 +308,7 @@ cache_remove_dn_hash(struct cache *cache, struct backentry *e)
 {
     const char *ndn = slapi_sdn_get_ndn(backentry_get_sdn(e));
     if (ndn) {
-        remove_hash(cache->c_dntable, (void *)ndn, strlen(ndn));
+        cache_remove_hash(cache, cache->c_dntable, (void *)ndn, strlen(ndn));
     }
 }
 
@@ -325,6 +344,120 @@ remove_hash_entry(Hashtable *ht, const void *key, uint32_t keylen, void *entry)
     return 0;
 }
 
+#define CACHE_STRIPE(cache, val) (&(cache)->c_stripes[(val) % CACHE_STRIPES])
+
+/*
+ * Wrappers of the hash table modifiers for the entry/dn cache tables:
+ * the caller holds the cache lock, they take the write lock of the stripe.
+ */
+static int
+cache_add_hash(struct cache *cache, Hashtable *ht, void *key, uint32_t keylen, void *entry, void **alt)
+{
+    pthread_rwlock_t *stripe = CACHE_STRIPE(cache, HASH_VALUE(key, keylen));
+    int rc;
+
+    pthread_rwlock_wrlock(stripe);
+    rc = add_hash(ht, key, keylen, entry, alt);
+    pthread_rwlock_unlock(stripe);
+    return rc;
+}
+
+static int
+cache_remove_hash(struct cache *cache, Hashtable *ht, const void *key, uint32_t keylen)
+{
+    pthread_rwlock_t *stripe = CACHE_STRIPE(cache, HASH_VALUE(key, keylen));
+    int rc;
+
+    pthread_rwlock_wrlock(stripe);
+    rc = remove_hash(ht, key, keylen);
+    pthread_rwlock_unlock(stripe);
+    return rc;
+}
+
+static int
+cache_remove_hash_entry(struct cache *cache, Hashtable *ht, const void *key, uint32_t keylen, void *entry)
+{
+    pthread_rwlock_t *stripe = CACHE_STRIPE(cache, HASH_VALUE(key, keylen));
+    int rc;
+
+    pthread_rwlock_wrlock(stripe);
+    rc = remove_hash_entry(ht, key, keylen, entry);
+    pthread_rwlock_unlock(stripe);
+    return rc;
+}
+
+/* Lock all the stripes, before swapping or freeing the hash tables */
+static void
+cache_stripes_wrlock(struct cache *cache)
+{
+    for (size_t i = 0; i < CACHE_STRIPES; i++) {
+        pthread_rwlock_wrlock(&cache->c_stripes[i]);
+    }
+}
+
+static void
+cache_stripes_unlock(struct cache *cache)
+{
+    for (size_t i = 0; i < CACHE_STRIPES; i++) {
+        pthread_rwlock_unlock(&cache->c_stripes[i]);
+    }
+}
+
+/*
+ * Lookup fast path: if the entry is already referenced by another thread,
+ * take one more reference while only holding the read lock of the stripe.
+ * 'htp' is read under that lock as the tables are only swapped with all
+ * the stripes locked.
+ * Returns NULL if the caller has to take the slow path: the entry is not
+ * in the table, is not available, or nobody else references it.
+ */
+static void *
+cache_find_shared(struct cache *cache, Hashtable **htp, const void *key, uint32_t keylen, u_long hashval, uint8_t unavailable)
+{
+    pthread_rwlock_t *stripe = CACHE_STRIPE(cache, hashval);
+    struct backcommon *e = NULL;
+    int32_t refcnt = 0;
+
+    pthread_rwlock_rdlock(stripe);
+    if (*htp && find_hash(*htp, key, keylen, (void **)&e) && (e->ep_state & unavailable) == 0) {
+        refcnt = slapi_atomic_load_32(&e->ep_refcnt, __ATOMIC_ACQUIRE);
+        while (refcnt > 0 &&
+               !__atomic_compare_exchange_n(&e->ep_refcnt, &refcnt, refcnt + 1,
+                                            false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            /* refcnt was reloaded, try again */
+        }
+    }
+    pthread_rwlock_unlock(stripe);
+    if (refcnt <= 0) {
+        return NULL;
+    }
+    slapi_atomic_incr_64(&cache->c_stats.hits, __ATOMIC_RELAXED);
+    slapi_atomic_incr_64(&cache->c_stats.tries, __ATOMIC_RELAXED);
+    return e;
+}
+
+/*
+ * Return fast path: drop a reference without the cache lock as long as it
+ * is not the last one.  Returns false if the caller has to take the slow path.
+ */
+static bool
+cache_return_shared(struct backcommon *e)
+{
+    int32_t refcnt;
+
+    if (e->ep_state & ENTRY_STATE_NOTINCACHE) {
+        return false;
+    }
+    refcnt = slapi_atomic_load_32(&e->ep_refcnt, __ATOMIC_ACQUIRE);
+    while (refcnt > 1) {
+        if (__atomic_compare_exchange_n(&e->ep_refcnt, &refcnt, refcnt - 1,
+                                        false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            return true;
+        }
+    }
+    return false;
+}
+
 #ifdef LDAP_CACHE_DEBUG
 void
 dump_hash(Hashtable *ht)
@@ -563,11 +696,43 @@ lru_add(struct cache *cache, void *ptr)
 
 /***** cache overhead *****/
 
+/*
+ * Round the hash table size up to a multiple of CACHE_STRIPES, so that a
+ * hash chain is covered by a single stripe.  new_hash() keeps that size as
+ * long as the multiplier is odd and relatively prime to its small primes.
+ */
+static u_long
+cache_hash_size(u_long hashsize)
+{
+    static u_long prime[] = {3, 5, 7, 11, 13, 17, 19};
+    u_long mult;
+    int ok = 0;
+
+    if (hashsize < MINHASHSIZE) {
+        hashsize = MINHASHSIZE;
+    }
+    mult = ((hashsize + CACHE_STRIPES - 1) / CACHE_STRIPES) | 1;
+    do {
+        ok = 1;
+        for (size_t i = 0; i < (sizeof(prime) / sizeof(prime[0])); i++) {
+            if (!(mult % prime[i])) {
+                ok = 0;
+            }
+        }
+        if (!ok) {
+            mult += 2;
+        }
+    } while (!ok);
+    return mult * CACHE_STRIPES;
+}
+
 static void
 cache_make_hashes(struct cache *cache, int type)
 {
     u_long hashsize = (cache->c_stats.maxentries > 0) ? cache->c_stats.maxentries : (cache->c_stats.maxsize / 512);
 
+    hashsize = cache_hash_size(hashsize);
+
     if (CACHE_TYPE_ENTRY == type) {
         cache->c_dntable = new_hash(hashsize,
                                     HASHLOC(struct backentry, ep_dn_link),
@@ -681,7 +846,13 @@ flush_hash(struct cache *cache, struct timespec *start_time, int32_t type)
                 /* since we have the cache lock we know we can trust refcnt */
                 entry->ep_state |= ENTRY_STATE_INVALID;
                 if (entry->ep_refcnt == 0) {
-                    entry->ep_refcnt++;
+                    /* Unhash it before taking a reference, see cache_find_shared */
+                    if (type == ENTRY_CACHE) {
+                        entrycache_remove_int(cache, laste);
+                    } else {
+                        dncache_remove_int(cache, laste);
+                    }
+                    slapi_atomic_incr_32(&entry->ep_refcnt, __ATOMIC_ACQ_REL);
                     if (entry->ep_state & ENTRY_STATE_PINNED) {
                         /* Entry is in pinned list, not LRU - remove from pinned only.
                          * pinned_remove clears lru pointers and won't add to LRU since refcnt > 0.
@@ -692,10 +863,8 @@ flush_hash(struct cache *cache, struct timespec *start_time, int32_t type)
                         lru_delete(cache, laste);
                     }
                     if (type == ENTRY_CACHE) {
-                        entrycache_remove_int(cache, laste);
                         entrycache_return(cache, (struct backentry **)&laste, PR_TRUE);
                     } else {
-                        dncache_remove_int(cache, laste);
                         dncache_return(cache, (struct backdn **)&laste);
                     }
                 } else {
@@ -732,7 +901,9 @@ flush_hash(struct cache *cache, struct timespec *start_time, int32_t type)
                     /* since we have the cache lock we know we can trust refcnt */
                     entry->ep_state |= ENTRY_STATE_INVALID;
                     if (entry->ep_refcnt == 0) {
-                        entry->ep_refcnt++;
+                        /* Unhash it before taking a reference, see cache_find_shared */
+                        entrycache_remove_int(cache, laste);
+                        slapi_atomic_incr_32(&entry->ep_refcnt, __ATOMIC_ACQ_REL);
                         if (entry->ep_state & ENTRY_STATE_PINNED) {
                             /* Entry is in pinned list, not LRU - remove from pinned only.
                              * pinned_remove clears lru pointers and won't add to LRU since refcnt > 0.
@@ -742,7 +913,6 @@ flush_hash(struct cache *cache, struct timespec *start_time, int32_t type)
                             /* Entry is in LRU list - remove from LRU */
                             lru_delete(cache, laste);
                         }
-                        entrycache_remove_int(cache, laste);
                         entrycache_return(cache, (struct backentry **)&laste, PR_TRUE);
                     } else {
                         /* Entry flagged for removal */
@@ -785,6 +955,9 @@ cache_init(struct cache *cache, struct ldbm_instance *inst, uint64_t maxsize, in
     cache->c_stats.maxentries = maxentries;
     cache->c_inst = inst;
     cache->c_lruhead = cache->c_lrutail = NULL;
+    for (size_t i = 0; i < CACHE_STRIPES; i++) {
+        pthread_rwlock_init(&cache->c_stripes[i], NULL);
+    }
     cache_make_hashes(cache, type);
     cache->c_pinned_ctx = (struct pinned_ctx*)slapi_ch_calloc(1, sizeof (struct pinned_ctx));
 
@@ -838,12 +1011,13 @@ entrycache_flush(struct cache *cache)
             break;
         }
         ASSERT(e->ep_refcnt == 0);
-        e->ep_refcnt++;
+        /* Unhash it before taking a reference, see cache_find_shared */
         if (entrycache_remove_int(cache, e) < 0) {
             slapi_log_err(SLAPI_LOG_ERR,
                           "entrycache_flush", "Unable to delete entry\n");
             break;
         }
+        slapi_atomic_incr_32(&e->ep_refcnt, __ATOMIC_ACQ_REL);
         if (e == CACHE_LRU_HEAD(cache, struct backentry *)) {
             break;
         }
@@ -895,27 +1069,37 @@ cache_clear(struct cache *cache, int type)
     cache_unlock(cache);
 }
 
+/* Free the hash tables and, if 'rehash' is set, allocate new ones */
 static void
-erase_cache(struct cache *cache, int type)
+erase_cache(struct cache *cache, int type, bool rehash)
 {
     if (CACHE_TYPE_ENTRY == type) {
         entrycache_clear_int(cache);
     } else if (CACHE_TYPE_DN == type) {
         dncache_clear_int(cache);
     }
+    /* no lookup may walk the tables while they are swapped */
+    cache_stripes_wrlock(cache);
     slapi_ch_free((void **)&cache->c_dntable);
     slapi_ch_free((void **)&cache->c_idtable);
 #ifdef UUIDCACHE_ON
     slapi_ch_free((void **)&cache->c_uuidtable);
 #endif
+    if (rehash) {
+        cache_make_hashes(cache, type);
+    }
+    cache_stripes_unlock(cache);
 }
 
 /* to be used on shutdown or when destroying a backend instance */
 void
 cache_destroy_please(struct cache *cache, int type)
 {
-    erase_cache(cache, type);
+    erase_cache(cache, type, false);
     slapi_ch_free((void**)&cache->c_pinned_ctx);
+    for (size_t i = 0; i < CACHE_STRIPES; i++) {
+        pthread_rwlock_destroy(&cache->c_stripes[i]);
+    }
     PR_DestroyMonitor(cache->c_mutex);
     PR_DestroyLock(cache->c_emutexalloc_mutex);
 }
@@ -965,8 +1149,7 @@ entrycache_set_max_size(struct cache *cache, uint64_t bytes, bool autotuned)
         /* there's hardly anything left in the cache -- clear it out and
         * resize the hashtables for efficiency.
         */
-        erase_cache(cache, CACHE_TYPE_ENTRY);
-        cache_make_hashes(cache, CACHE_TYPE_ENTRY);
+        erase_cache(cache, CACHE_TYPE_ENTRY, true);
     }
     cache_unlock(cache);
     /* This may already have been called by one of the functions in
@@ -1164,7 +1347,7 @@ entrycache_remove_int(struct cache *cache, struct backentry *e)
      * of these return errors.
      */
     ndn = slapi_sdn_get_ndn(backentry_get_sdn(e));
-    if (remove_hash(cache->c_dntable, (void *)ndn, strlen(ndn))) {
+    if (cache_remove_hash(cache, cache->c_dntable, (void *)ndn, strlen(ndn))) {
         ret = 0;
     } else {
         LOG("remove %s from dn hash failed\n", ndn);
@@ -1176,7 +1359,7 @@ entrycache_remove_int(struct cache *cache, struct backentry *e)
        imbalance
     */
     if (!(e->ep_state & ENTRY_STATE_CREATING)) {
-        if (remove_hash(cache->c_idtable, &(e->ep_id), sizeof(ID))) {
+        if (cache_remove_hash(cache, cache->c_idtable, &(e->ep_id), sizeof(ID))) {
             ret = 0;
         } else {
             LOG("remove %s (%d) from id hash failed\n", ndn, e->ep_id);
@@ -1184,7 +1367,7 @@ entrycache_remove_int(struct cache *cache, struct backentry *e)
     }
 #ifdef UUIDCACHE_ON
     uuid = slapi_entry_get_uniqueid(e->ep_entry);
-    if (remove_hash(cache->c_uuidtable, (void *)uuid, strlen(uuid))) {
+    if (cache_remove_hash(cache, cache->c_uuidtable, (void *)uuid, strlen(uuid))) {
         ret = 0;
     } else {
         LOG("remove %d from uuid hash failed\n", uuid);
@@ -1473,10 +1656,10 @@ entrycache_replace(struct cache *cache, struct backentry *olde, struct backentry
      * cache tables, operation error
      */
     if ((olde->ep_state & ENTRY_STATE_NOTINCACHE) == 0) {
-        found_in_dn = remove_hash(cache->c_dntable, (void *)oldndn, strlen(oldndn));
-        found_in_id = remove_hash(cache->c_idtable, &(olde->ep_id), sizeof(ID));
+        found_in_dn = cache_remove_hash(cache, cache->c_dntable, (void *)oldndn, strlen(oldndn));
+        found_in_id = cache_remove_hash(cache, cache->c_idtable, &(olde->ep_id), sizeof(ID));
 #ifdef UUIDCACHE_ON
-        found_in_uuid = remove_hash(cache->c_uuidtable, (void *)olduuid, strlen(olduuid));
+        found_in_uuid = cache_remove_hash(cache, cache->c_uuidtable, (void *)olduuid, strlen(olduuid));
 #endif
         found = found_in_dn && found_in_id;
 #ifdef UUIDCACHE_ON
@@ -1489,10 +1672,10 @@ entrycache_replace(struct cache *cache, struct backentry *olde, struct backentry
         /* if we're doing a modrdn or turning an entry to a tombstone,
          * the new entry can be in the dn table already, so we need to remove that too.
          */
-        if (remove_hash(cache->c_dntable, (void *)newndn, strlen(newndn))) {
+        if (cache_remove_hash(cache, cache->c_dntable, (void *)newndn, strlen(newndn))) {
             cache->c_stats.size -= newe->ep_size;
             cache->c_stats.nentries--;
-            newe->ep_refcnt--;
+            slapi_atomic_decr_32(&newe->ep_refcnt, __ATOMIC_ACQ_REL);
             LOG("entry cache replace remove entry size %lu\n", newe->ep_size);
         }
     }
@@ -1539,28 +1722,28 @@ entrycache_replace(struct cache *cache, struct backentry *olde, struct backentry
     /* (probably don't need such extensive error handling, once this has been
      * tested enough that we believe it works.)
      */
-    if (!add_hash(cache->c_dntable, (void *)newndn, strlen(newndn), newe, (void **)&alte)) {
+    if (!cache_add_hash(cache, cache->c_dntable, (void *)newndn, strlen(newndn), newe, (void **)&alte)) {
         LOG("entry cache replace (%s): can't add to dn table (returned %s)\n",
             newndn, alte ? slapi_entry_get_dn(alte->ep_entry) : "none");
         cache_unlock(cache);
         return 1;
     }
-    if (!add_hash(cache->c_idtable, &(newe->ep_id), sizeof(ID), newe, (void **)&alte)) {
+    if (!cache_add_hash(cache, cache->c_idtable, &(newe->ep_id), sizeof(ID), newe, (void **)&alte)) {
         LOG("entry cache replace (%s): can't add to id table (returned %s)\n",
             newndn, alte ? slapi_entry_get_dn(alte->ep_entry) : "none");
-        if (remove_hash(cache->c_dntable, (void *)newndn, strlen(newndn)) == 0) {
+        if (cache_remove_hash(cache, cache->c_dntable, (void *)newndn, strlen(newndn)) == 0) {
             LOG("entry cache replace: failed to remove dn table\n");
         }
         cache_unlock(cache);
         return 1;
     }
 #ifdef UUIDCACHE_ON
-    if (newuuid && !add_hash(cache->c_uuidtable, (void *)newuuid, strlen(newuuid), newe, NULL)) {
+    if (newuuid && !cache_add_hash(cache, cache->c_uuidtable, (void *)newuuid, strlen(newuuid), newe, NULL)) {
         LOG("entry cache replace: can't add uuid\n", 0, 0, 0);
-        if (remove_hash(cache->c_dntable, (void *)newndn, strlen(newndn)) == 0) {
+        if (cache_remove_hash(cache, cache->c_dntable, (void *)newndn, strlen(newndn)) == 0) {
             LOG("entry cache replace: failed to remove dn table(uuid cache)\n");
         }
-        if (remove_hash(cache->c_idtable, &(newe->ep_id), sizeof(ID)) == 0) {
+        if (cache_remove_hash(cache, cache->c_idtable, &(newe->ep_id), sizeof(ID)) == 0) {
             LOG("entry cache replace: failed to remove id table(uuid cache)\n");
         }
         cache_unlock(cache);
@@ -1568,7 +1751,7 @@ entrycache_replace(struct cache *cache, struct backentry *olde, struct backentry
     }
 #endif
     /* adjust cache meta info */
-    newe->ep_refcnt++;
+    slapi_atomic_incr_32(&newe->ep_refcnt, __ATOMIC_ACQ_REL);
     newe->ep_size = entry_size;
     if (newe->ep_size > olde->ep_size) {
         cache->c_stats.size += newe->ep_size - olde->ep_size;
@@ -1618,13 +1801,17 @@ entrycache_return(struct cache *cache, struct backentry **bep, PRBool locked)
         backentry_get_ndn(e), e->ep_refcnt, cache->c_stats.nentries);
 
     if (locked == PR_FALSE) {
+        if (cache_return_shared((struct backcommon *)e)) {
+            /* not the last reference, nothing else to do */
+            return;
+        }
         cache_lock(cache);
     }
     if (e->ep_state & ENTRY_STATE_NOTINCACHE) {
         backentry_free(bep);
     } else {
         ASSERT(e->ep_refcnt > 0);
-        if (!--e->ep_refcnt) {
+        if (slapi_atomic_decr_32(&e->ep_refcnt, __ATOMIC_ACQ_REL) == 0) {
             if (e->ep_state & (ENTRY_STATE_DELETED | ENTRY_STATE_INVALID)) {
                 const char *ndn = slapi_sdn_get_ndn(backentry_get_sdn(e));
                 if (ndn) {
@@ -1633,7 +1820,7 @@ entrycache_return(struct cache *cache, struct backentry **bep, PRBool locked)
                      * so we need to remove the entry from the DN cache because
                      * we don't/can't always call cache_remove().
                      */
-                    if (remove_hash(cache->c_dntable, (void *)ndn, strlen(ndn)) == 0) {
+                    if (cache_remove_hash(cache, cache->c_dntable, (void *)ndn, strlen(ndn)) == 0) {
                         LOG("entrycache_return -Failed to remove %s from dn table\n", ndn);
                     }
                 }
@@ -1682,6 +1869,12 @@ cache_find_dn(struct cache *cache, const char *dn, unsigned long ndnlen)
     LOG("=> cache_find_dn - (%s)\n", dn);
 
     /*entry normalized by caller (dn2entry.c)  */
+    e = cache_find_shared(cache, &cache->c_dntable, dn, ndnlen,
+                          dn_hash(dn, ndnlen), ENTRY_STATE_UNAVAILABLE);
+    if (e) {
+        LOG("<= cache_find_dn - (FOUND)\n");
+        return e;
+    }
     cache_lock(cache);
     if (find_hash(cache->c_dntable, (void *)dn, ndnlen, (void **)&e)) {
         /* need to check entry state */
@@ -1693,10 +1886,10 @@ cache_find_dn(struct cache *cache, const char *dn, unsigned long ndnlen)
         }
         if (e->ep_refcnt == 0 && (e->ep_state & ENTRY_STATE_PINNED) == 0)
             lru_delete(cache, (void *)e);
-        e->ep_refcnt++;
-        cache->c_stats.hits++;
+        slapi_atomic_incr_32(&e->ep_refcnt, __ATOMIC_ACQ_REL);
+        slapi_atomic_incr_64(&cache->c_stats.hits, __ATOMIC_RELAXED);
     }
-    cache->c_stats.tries++;
+    slapi_atomic_incr_64(&cache->c_stats.tries, __ATOMIC_RELAXED);
     cache_unlock(cache);
 
     LOG("<= cache_find_dn - (%sFOUND)\n", e ? "" : "NOT ");
@@ -1712,6 +1905,12 @@ cache_find_id(struct cache *cache, ID id)
 
     LOG("=> cache_find_id (%lu)\n", (u_long)id);
 
+    e = cache_find_shared(cache, &cache->c_idtable, &id, sizeof(ID),
+                          id, ENTRY_STATE_UNAVAILABLE);
+    if (e) {
+        LOG("<= cache_find_id (FOUND)\n");
+        return e;
+    }
     cache_lock(cache);
     if (find_hash(cache->c_idtable, &id, sizeof(ID), (void **)&e)) {
         /* need to check entry state */
@@ -1723,10 +1922,10 @@ cache_find_id(struct cache *cache, ID id)
         }
         if (e->ep_refcnt == 0 && (e->ep_state & ENTRY_STATE_PINNED) == 0)
             lru_delete(cache, (void *)e);
-        e->ep_refcnt++;
-        cache->c_stats.hits++;
+        slapi_atomic_incr_32(&e->ep_refcnt, __ATOMIC_ACQ_REL);
+        slapi_atomic_incr_64(&cache->c_stats.hits, __ATOMIC_RELAXED);
     }
-    cache->c_stats.tries++;
+    slapi_atomic_incr_64(&cache->c_stats.tries, __ATOMIC_RELAXED);
     cache_unlock(cache);
 
     LOG("<= cache_find_id (%sFOUND)\n", e ? "" : "NOT ");
@@ -1753,10 +1952,10 @@ cache_find_uuid(struct cache *cache, const char *uuid)
         }
         if (e->ep_refcnt == 0 && (e->ep_state & ENTRY_STATE_PINNED) == 0)
             lru_delete(cache, (void *)e);
-        e->ep_refcnt++;
-        cache->c_stats.hits++;
+        slapi_atomic_incr_32(&e->ep_refcnt, __ATOMIC_ACQ_REL);
+        slapi_atomic_incr_64(&cache->c_stats.hits, __ATOMIC_RELAXED);
     }
-    cache->c_stats.tries++;
+    slapi_atomic_incr_64(&cache->c_stats.tries, __ATOMIC_RELAXED);
     cache_unlock(cache);
 
     LOG("<= cache_find_uuid (%sFOUND)\n", e ? "" : "NOT ");
@@ -1822,13 +2021,13 @@ entrycache_add_int(struct cache *cache, struct backentry *e, int state, struct b
      */
     if ((e->ep_state & ENTRY_STATE_CREATING) && (state == 0)) {
         if (e->ep_dn_hash_ndn) {
-            if (remove_hash_entry(cache->c_dntable,
+            if (cache_remove_hash_entry(cache, cache->c_dntable,
                     e->ep_dn_hash_ndn,
                     strlen(e->ep_dn_hash_ndn), e)) {
                 /*
                  * Set `already_in = 1` because the tentative add already
                  * counted this entry in `c_stats`. This flag is checked
-                 * later when `add_hash(cache->c_idtable, ...)` fails
+                 * later when `cache_add_hash(cache, cache->c_idtable, ...)` fails
                  * (the ID is already in `c_idtable` from the tentative add),
                  * so the failure is expected and we return success instead
                  * of an error.
@@ -1839,7 +2038,7 @@ entrycache_add_int(struct cache *cache, struct backentry *e, int state, struct b
         }
     }
 
-    if (!add_hash(cache->c_dntable, (void *)ndn, strlen(ndn), e,
+    if (!cache_add_hash(cache, cache->c_dntable, (void *)ndn, strlen(ndn), e,
                   (void **)&my_alt)) {
         LOG("entry \"%s\" already in dn cache\n", ndn);
         /* add_hash filled in 'my_alt' if necessary */
@@ -1863,7 +2062,7 @@ entrycache_add_int(struct cache *cache, struct backentry *e, int state, struct b
                  */
                 if (e->ep_refcnt == 0 && (e->ep_state & ENTRY_STATE_PINNED) == 0)
                     lru_delete(cache, (void *)e);
-                e->ep_refcnt++;
+                slapi_atomic_incr_32(&e->ep_refcnt, __ATOMIC_ACQ_REL);
                 e->ep_state &= ~ENTRY_STATE_UNAVAILABLE;
                 e->ep_state |= state; /* might be CREATING */
                 /* returning 1 (entry already existed), but don't set to alt
@@ -1890,7 +2089,7 @@ entrycache_add_int(struct cache *cache, struct backentry *e, int state, struct b
                     *alt = my_alt;
                     if (my_alt->ep_refcnt == 0 && (my_alt->ep_state & ENTRY_STATE_PINNED) == 0)
                         lru_delete(cache, (void *)*alt);
-                    (*alt)->ep_refcnt++;
+                    slapi_atomic_incr_32(&(*alt)->ep_refcnt, __ATOMIC_ACQ_REL);
                     LOG("the entry %s already exists.  returning existing entry %s (state: 0x%x)\n",
                         ndn, backentry_get_ndn(my_alt), state);
                     cache_unlock(cache);
@@ -1911,7 +2110,7 @@ entrycache_add_int(struct cache *cache, struct backentry *e, int state, struct b
      */
     if (state == 0) {
         /* neither of these should fail, or something is very wrong. */
-        if (!add_hash(cache->c_idtable, &(e->ep_id), sizeof(ID), e, NULL)) {
+        if (!cache_add_hash(cache, cache->c_idtable, &(e->ep_id), sizeof(ID), e, NULL)) {
             LOG("entry %s already in id cache!\n", ndn);
             if (already_in) {
                 /* there's a bug in the implementatin of 'modify' and 'modrdn'
@@ -1933,7 +2132,7 @@ entrycache_add_int(struct cache *cache, struct backentry *e, int state, struct b
                 cache_unlock(cache);
                 return 0;
             }
-            if (remove_hash(cache->c_dntable, (void *)ndn, strlen(ndn)) == 0) {
+            if (cache_remove_hash(cache, cache->c_dntable, (void *)ndn, strlen(ndn)) == 0) {
                 LOG("entrycache_add_int: failed to remove %s from dn table\n", ndn);
             }
             e->ep_state |= ENTRY_STATE_NOTINCACHE;
@@ -1945,14 +2144,14 @@ entrycache_add_int(struct cache *cache, struct backentry *e, int state, struct b
 #ifdef UUIDCACHE_ON
         if (uuid) {
             /* (only insert entries with a uuid) */
-            if (!add_hash(cache->c_uuidtable, (void *)uuid, strlen(uuid), e,
+            if (!cache_add_hash(cache, cache->c_uuidtable, (void *)uuid, strlen(uuid), e,
                           NULL)) {
                 LOG("entry %s already in uuid cache!\n", backentry_get_ndn(e),
                     0, 0);
-                if (remove_hash(cache->c_dntable, (void *)ndn, strlen(ndn)) == 0) {
+                if (cache_remove_hash(cache, cache->c_dntable, (void *)ndn, strlen(ndn)) == 0) {
                     LOG("entrycache_add_int: failed to remove dn table(uuid cache)\n");
                 }
-                if (remove_hash(cache->c_idtable, &(e->ep_id), sizeof(ID)) == 0) {
+                if (cache_remove_hash(cache, cache->c_idtable, &(e->ep_id), sizeof(ID)) == 0) {
                     LOG("entrycache_add_int: failed to remove id table(uuid cache)\n";
                 }
                 e->ep_state |= ENTRY_STATE_NOTINCACHE;
@@ -1977,7 +2176,7 @@ entrycache_add_int(struct cache *cache, struct backentry *e, int state, struct b
     }
 
     if (!already_in) {
-        e->ep_refcnt = 1;
+        slapi_atomic_store_32(&e->ep_refcnt, 1, __ATOMIC_RELEASE);
         e->ep_size = entry_size;
         cache->c_stats.size += e->ep_size;
         cache->c_stats.nentries++;
@@ -2199,8 +2398,7 @@ dncache_set_max_size(struct cache *cache, uint64_t bytes, bool autotuned)
         /* there's hardly anything left in the cache -- clear it out and
         * resize the hashtables for efficiency.
         */
-        erase_cache(cache, CACHE_TYPE_DN);
-        cache_make_hashes(cache, CACHE_TYPE_DN);
+        erase_cache(cache, CACHE_TYPE_DN, true);
     }
     cache_unlock(cache);
     /* This may already have been called by one of the functions in
@@ -2227,7 +2425,7 @@ dncache_remove_int(struct cache *cache, struct backdn *bdn)
     }
 
     /* remove from id hashtable */
-    if (remove_hash(cache->c_idtable, &(bdn->ep_id), sizeof(ID))) {
+    if (cache_remove_hash(cache, cache->c_idtable, &(bdn->ep_id), sizeof(ID))) {
         ret = 0;
     } else {
         LOG("remove %d from id hash failed\n", bdn->ep_id);
@@ -2257,12 +2455,16 @@ dncache_return(struct cache *cache, struct backdn **bdn)
     LOG("=> dncache_return (%s) reference count: %d, dn in cache:%ld\n",
         slapi_sdn_get_dn((*bdn)->dn_sdn), (*bdn)->ep_refcnt, cache->c_stats.nentries);
 
+    if (cache_return_shared((struct backcommon *)*bdn)) {
+        /* not the last reference, nothing else to do */
+        return;
+    }
     cache_lock(cache);
     if ((*bdn)->ep_state & ENTRY_STATE_NOTINCACHE) {
         backdn_free(bdn);
     } else {
         ASSERT((*bdn)->ep_refcnt > 0);
-        if (!--(*bdn)->ep_refcnt) {
+        if (slapi_atomic_decr_32(&(*bdn)->ep_refcnt, __ATOMIC_ACQ_REL) == 0) {
             if ((*bdn)->ep_state & (ENTRY_STATE_DELETED | ENTRY_STATE_INVALID)) {
                 if ((*bdn)->ep_state & ENTRY_STATE_INVALID) {
                     /* Remove it from the hash table before we free the back dn */
@@ -2297,6 +2499,12 @@ dncache_find_id(struct cache *cache, ID id)
 
     LOG("=> dncache_find_id (%lu)\n", (u_long)id);
 
+    /* any state other than 0 makes the dn unavailable */
+    bdn = cache_find_shared(cache, &cache->c_idtable, &id, sizeof(ID), id, 0xff);
+    if (bdn) {
+        LOG("<= dncache_find_id (FOUND)\n");
+        return bdn;
+    }
     cache_lock(cache);
     if (find_hash(cache->c_idtable, &id, sizeof(ID), (void **)&bdn)) {
         /* need to check entry state */
@@ -2308,10 +2516,10 @@ dncache_find_id(struct cache *cache, ID id)
         }
         if (bdn->ep_refcnt == 0)
             lru_delete(cache, (void *)bdn);
-        bdn->ep_refcnt++;
-        cache->c_stats.hits++;
+        slapi_atomic_incr_32(&bdn->ep_refcnt, __ATOMIC_ACQ_REL);
+        slapi_atomic_incr_64(&cache->c_stats.hits, __ATOMIC_RELAXED);
     }
-    cache->c_stats.tries++;
+    slapi_atomic_incr_64(&cache->c_stats.tries, __ATOMIC_RELAXED);
     cache_unlock(cache);
 
     LOG("<= cache_find_id (%sFOUND)\n", bdn ? "" : "NOT ");
@@ -2332,7 +2540,7 @@ dncache_add_int(struct cache *cache, struct backdn *bdn, int state, struct backd
 
     cache_lock(cache);
 
-    if (!add_hash(cache->c_idtable, &(bdn->ep_id), sizeof(ID), bdn,
+    if (!cache_add_hash(cache, cache->c_idtable, &(bdn->ep_id), sizeof(ID), bdn,
                   (void **)&my_alt)) {
         LOG("entry %s already in id cache!\n", slapi_sdn_get_dn(bdn->dn_sdn));
         if (my_alt == bdn) {
@@ -2355,7 +2563,7 @@ dncache_add_int(struct cache *cache, struct backdn *bdn, int state, struct backd
                  */
                 if (bdn->ep_refcnt == 0)
                     lru_delete(cache, (void *)bdn);
-                bdn->ep_refcnt++;
+                slapi_atomic_incr_32(&bdn->ep_refcnt, __ATOMIC_ACQ_REL);
                 bdn->ep_state = state; /* might be CREATING */
                 /* returning 1 (entry already existed), but don't set to alt
                  * to prevent that the caller accidentally thinks the existing
@@ -2380,7 +2588,7 @@ dncache_add_int(struct cache *cache, struct backdn *bdn, int state, struct backd
                     *alt = my_alt;
                     if ((*alt)->ep_refcnt == 0)
                         lru_delete(cache, (void *)*alt);
-                    (*alt)->ep_refcnt++;
+                    slapi_atomic_incr_32(&(*alt)->ep_refcnt, __ATOMIC_ACQ_REL);
                 }
                 cache_unlock(cache);
                 return 1;
@@ -2391,7 +2599,7 @@ dncache_add_int(struct cache *cache, struct backdn *bdn, int state, struct backd
     bdn->ep_state = state;
 
     if (!already_in) {
-        bdn->ep_refcnt = 1;
+        slapi_atomic_store_32(&bdn->ep_refcnt, 1, __ATOMIC_RELEASE);
         if (0 == bdn->ep_size) {
             bdn->ep_size = slapi_sdn_get_size(bdn->dn_sdn);
         }
@@ -2443,7 +2651,7 @@ dncache_replace(struct cache *cache, struct backdn *olddn, struct backdn *newdn)
      */
     if ((olddn->ep_state & ENTRY_STATE_NOTINCACHE) == 0) {
 
-        found = remove_hash(cache->c_idtable, &(olddn->ep_id), sizeof(ID));
+        found = cache_remove_hash(cache, cache->c_idtable, &(olddn->ep_id), sizeof(ID));
         if (!found) {
             LOG("cache index tables out of sync\n");
             cache_unlock(cache);
@@ -2455,13 +2663,13 @@ dncache_replace(struct cache *cache, struct backdn *olddn, struct backdn *newdn)
     /* (probably don't need such extensive error handling, once this has been
      * tested enough that we believe it works.)
      */
-    if (!add_hash(cache->c_idtable, &(newdn->ep_id), sizeof(ID), newdn, NULL)) {
+    if (!cache_add_hash(cache, cache->c_idtable, &(newdn->ep_id), sizeof(ID), newdn, NULL)) {
         LOG("dn cache replace: can't add id\n");
         cache_unlock(cache);
         return 1;
     }
     /* adjust cache meta info */
-    newdn->ep_refcnt = 1;
+    slapi_atomic_store_32(&newdn->ep_refcnt, 1, __ATOMIC_RELEASE);
     if (0 == newdn->ep_size) {
         newdn->ep_size = slapi_sdn_get_size(newdn->dn_sdn);
     }
@@ -2505,11 +2713,12 @@ dncache_flush(struct cache *cache)
             break;
         }
         ASSERT(dn->ep_refcnt == 0);
-        dn->ep_refcnt++;
+        /* Unhash it before taking a reference, see cache_find_shared */
         if (dncache_remove_int(cache, dn) < 0) {
             slapi_log_err(SLAPI_LOG_ERR, "dncache_flush", "Unable to delete entry\n");
             break;
         }
+        slapi_atomic_incr_32(&dn->ep_refcnt, __ATOMIC_ACQ_REL);
         if (dn == CACHE_LRU_HEAD(cache, struct backdn *)) {
             break;
         }
@@ -2615,20 +2824,25 @@ check_entry_cache(struct cache *cache, struct backentry *e)
 }
 #endif
 
+/*
+ * Returns 1 if another thread holds a reference on the entry.
+ * Shared references are taken and dropped by cache_find_shared() and
+ * cache_return_shared() without c_mutex, so holding the cache lock does not
+ * make the answer any more stable: it is only a snapshot.  But as the caller
+ * holds one reference itself, the count can never go through the 0 <-> 1
+ * transitions behind its back, and a result of 0 means no other thread had
+ * the entry at the time of the call.
+ */
 int
-cache_has_otherref(struct cache *cache, void *ptr)
+cache_has_otherref(struct cache *cache __attribute__((unused)), void *ptr)
 {
     struct backcommon *bep;
-    int hasref = 0;
 
     if (NULL == ptr) {
-        return hasref;
+        return 0;
     }
     bep = (struct backcommon *)ptr;
-    cache_lock(cache);
-    hasref = bep->ep_refcnt;
-    cache_unlock(cache);
-    return (hasref > 1) ? 1 : 0;
+    return (slapi_atomic_load_32(&bep->ep_refcnt, __ATOMIC_ACQUIRE) > 1) ? 1 : 0;
 }
 
 static int
@@ -28,6 +28,9 @@ ldbm_back_close(Slapi_PBlock *pb)
     li->li_shutdown = 1;
     PR_Unlock(li->li_shutdown_mutex);
 
+    /* no more searches, stop the search scan threads */
+    ldbm_search_scan_stop();
+
     /* close down all the ldbm instances */
     dblayer_close(li, DBLAYER_NORMAL_MODE);
 
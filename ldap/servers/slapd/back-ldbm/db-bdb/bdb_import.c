@@ -698,6 +698,8 @@ bdb_ancestorid_default_create_index(backend *be, ImportJob *job)
             ldbm_nasty("bdb_ancestorid_default_create_index", sourcefile, 13070, ret);
             break;
         }
+        /* idl_old_store_block walks b_ids, the lists must be arrays */
+        idl_expand(&children);
 
         /* check if we need to abort */
         if (job->flags & FLAG_ABORT) {
@@ -724,6 +726,7 @@ bdb_ancestorid_default_create_index(backend *be, ImportJob *job)
         /* Insert into ancestorid for this node */
         if (bdb_id2idl_hash_lookup(ht, &id, &ididl)) {
             descendants = bdb_idl_union_allids(be, ai_aid, ididl->idl, children);
+            idl_expand(&descendants);
             idl_free(&children);
             if (bdb_id2idl_hash_remove(ht, &id) == 0) {
                 slapi_log_err(SLAPI_LOG_ERR, "bdb_ancestorid_default_create_index",
@@ -754,6 +757,7 @@ bdb_ancestorid_default_create_index(backend *be, ImportJob *job)
         /* Insert into ancestorid for this node's parent */
         if (bdb_id2idl_hash_lookup(ht, &parentid, &ididl)) {
             IDList *idl = bdb_idl_union_allids(be, ai_aid, ididl->idl, descendants);
+            idl_expand(&idl);
             idl_free(&descendants);
             idl_free(&(ididl->idl));
             ididl->idl = idl;
@@ -999,6 +999,17 @@ bdb_index_producer(void *param)
         /* call post-entry plugin */
         plugin_call_entryfetch_plugins((char **)&data.dptr, &data.dsize);
 
+        /* binary id2entry records are processed in their LDIF form */
+        {
+            size_t ldif_size = 0;
+            char *ldif = id2entry_data2str(data.dptr, data.dsize, &ldif_size);
+            if (ldif) {
+                slapi_ch_free(&(data.data));
+                data.dptr = ldif;
+                data.dsize = ldif_size;
+            }
+        }
+
         char *rdn = NULL;
 
         /* rdn is allocated in get_value_from_string */
@@ -1564,6 +1575,17 @@ bdb_upgradedn_producer(void *param)
         /* call post-entry plugin */
         plugin_call_entryfetch_plugins((char **)&data.dptr, &data.dsize);
 
+        /* binary id2entry records are processed in their LDIF form */
+        {
+            size_t ldif_size = 0;
+            char *ldif = id2entry_data2str(data.dptr, data.dsize, &ldif_size);
+            if (ldif) {
+                slapi_ch_free(&(data.data));
+                data.dptr = ldif;
+                data.dsize = ldif_size;
+            }
+        }
+
         slapi_ch_free_string(&ecopy);
         ecopy = (char *)slapi_ch_malloc(data.dsize + 1);
         memcpy(ecopy, data.dptr, data.dsize);
@@ -3698,6 +3720,16 @@ bdb_import_get_and_add_parent_rdns(ImportWorkerInfo *info,
                           "Failed to position at ID " ID_FMT "\n", id);
             return rc;
         }
+        /* binary id2entry records are processed in their LDIF form */
+        {
+            size_t ldif_size = 0;
+            char *ldif = id2entry_data2str(data.dptr, data.dsize, &ldif_size);
+            if (ldif) {
+                slapi_ch_free(&(data.data));
+                data.dptr = ldif;
+                data.dsize = ldif_size;
+            }
+        }
         /* rdn is allocated in get_value_from_string */
         rc = get_value_from_string((const char *)data.dptr, "rdn", &rdn);
         if (rc) {
@@ -19,6 +19,7 @@
 
 #include "bdb_layer.h"
 #include "../vlv_srch.h"
+#include "zlib.h"
 
 #define indextype_EQUALITY "eq"
 
@@ -40,6 +41,7 @@ typedef struct _export_args
     NIDS idindex;
     ID lastid;
     int fd;
+    gzFile gzfd; /* Set when exporting to a .gz file */
     Slapi_Task *task;
     char **include_suffix;
     char **exclude_suffix;
@@ -520,10 +522,22 @@ bdb_fetch_subtrees(backend *be, char **include, int *err)
         }
     } /* for (i = 0; include[i]; i++) */
 
+    /* the callers walk b_ids */
+    idl_expand(&idltotal);
     return idltotal;
 }
 
 
+/* Write a chunk of the ldif file (either directly or through the gzip stream) */
+static int
+bdb_export_write(export_args *expargs, const char *buf, size_t len)
+{
+    if (expargs->gzfd) {
+        return gzwrite(expargs->gzfd, buf, len);
+    }
+    return write(expargs->fd, buf, len);
+}
+
 static int
 bdb_export_one_entry(struct ldbminfo *li,
                  ldbm_instance *inst,
@@ -605,12 +619,12 @@ bdb_export_one_entry(struct ldbminfo *li,
         char idstr[32];
 
         sprintf(idstr, "# entry-id: %lu\n", (u_long)expargs->ep->ep_id);
-        rc = write(expargs->fd, idstr, strlen(idstr));
+        rc = bdb_export_write(expargs, idstr, strlen(idstr));
         PR_ASSERT(rc > 0);
     }
-    rc = write(expargs->fd, data.data, len);
+    rc = bdb_export_write(expargs, data.data, len);
     PR_ASSERT(rc > 0);
-    rc = write(expargs->fd, "\n", 1);
+    rc = bdb_export_write(expargs, "\n", 1);
     PR_ASSERT(rc > 0);
     rc = 0;
     if ((*expargs->cnt) % 1000 == 0) {
@@ -689,6 +703,7 @@ bdb_db2ldif(Slapi_PBlock *pb)
     int we_start_the_backends = 0;
     int server_running;
     export_args eargs = {0};
+    size_t fname_len = 0;
     int32_t suffix_written = 0;
     int32_t skip_ruv = 0;
     int return_orig_dn = config_get_return_orig_dn();
@@ -840,9 +855,23 @@ bdb_db2ldif(Slapi_PBlock *pb)
             return_value = -1;
             goto bye;
         }
+        fname_len = strlen(fname);
+        if (fname_len > 3 && strcasecmp(fname + fname_len - 3, ".gz") == 0) {
+            /* Compress the ldif on the fly (gzclose will close fd) */
+            eargs.gzfd = gzdopen(fd, "wb");
+            if (eargs.gzfd == NULL) {
+                slapi_task_log_notice(task, "Backend %s: can't compress %s", inst->inst_name, fname);
+                slapi_log_err(SLAPI_LOG_ERR, "bdb_db2ldif",
+                              "db2ldif: %s: can't compress %s\n", inst->inst_name, fname);
+                we_start_the_backends = 0;
+                return_value = -1;
+                goto bye;
+            }
+        }
     } else { /* '-' */
         fd = STDOUT_FILENO;
     }
+    eargs.fd = fd;
 
     if (we_start_the_backends) {
         if (0 != bdb_start(li, DBLAYER_EXPORT_MODE)) {
@@ -954,7 +983,7 @@ bdb_db2ldif(Slapi_PBlock *pb)
                  */
 
         sprintf(vstr, "version: %d\n\n", myversion);
-        rc = write(fd, vstr, strlen(vstr));
+        rc = bdb_export_write(&eargs, vstr, strlen(vstr));
         PR_ASSERT(rc > 0);
         rc = 0;
     }
@@ -964,7 +993,6 @@ bdb_db2ldif(Slapi_PBlock *pb)
     eargs.printkey = printkey;
     eargs.idl = idl;
     eargs.lastid = lastid;
-    eargs.fd = fd;
     eargs.task = task;
     eargs.include_suffix = include_suffix;
     eargs.exclude_suffix = exclude_suffix;
@@ -1058,6 +1086,17 @@ bdb_db2ldif(Slapi_PBlock *pb)
         /* call post-entry plugin */
         plugin_call_entryfetch_plugins((char **)&data.dptr, &data.dsize);
 
+        /* binary id2entry records are processed in their LDIF form */
+        {
+            size_t ldif_size = 0;
+            char *ldif = id2entry_data2str(data.dptr, data.dsize, &ldif_size);
+            if (ldif) {
+                slapi_ch_free(&(data.data));
+                data.dptr = ldif;
+                data.dsize = ldif_size;
+            }
+        }
+
         ep = backentry_alloc();
 
         char *rdn = NULL;
@@ -1274,7 +1313,13 @@ bye:
 
     dblayer_release_id2entry(be, db);
 
-    if (fd > STDERR_FILENO) {
+    if (eargs.gzfd) {
+        if (gzclose(eargs.gzfd) != Z_OK) {
+            slapi_log_err(SLAPI_LOG_ERR, "bdb_db2ldif",
+                          "export %s: Failed to write in export file.\n", inst->inst_name);
+            return_value = -1;
+        }
+    } else if (fd > STDERR_FILENO) {
         close(fd);
     }
 
@@ -1639,6 +1684,17 @@ bdb_db2index(Slapi_PBlock *pb)
         /* call post-entry plugin */
         plugin_call_entryfetch_plugins((char **)&data.dptr, &data.dsize);
 
+        /* binary id2entry records are processed in their LDIF form */
+        {
+            size_t ldif_size = 0;
+            char *ldif = id2entry_data2str(data.dptr, data.dsize, &ldif_size);
+            if (ldif) {
+                slapi_ch_free(&(data.data));
+                data.dptr = ldif;
+                data.dsize = ldif_size;
+            }
+        }
+
         ep = backentry_alloc();
         char *rdn = NULL;
         int rc = 0;
@@ -2780,6 +2836,16 @@ _get_and_add_parent_rdns(backend *be,
                           "Failed to position cursor at ID " ID_FMT "\n", id);
             goto bail;
         }
+        /* binary id2entry records are processed in their LDIF form */
+        {
+            size_t ldif_size = 0;
+            char *ldif = id2entry_data2str(data.dptr, data.dsize, &ldif_size);
+            if (ldif) {
+                slapi_ch_free(&(data.data));
+                data.dptr = ldif;
+                data.dsize = ldif_size;
+            }
+        }
         /* rdn is allocated in get_value_from_string */
         rc = get_value_from_string((const char *)data.dptr, "rdn", &rdn);
         if (rc) {
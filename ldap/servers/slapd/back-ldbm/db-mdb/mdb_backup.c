@@ -0,0 +1,632 @@
+/** BEGIN COPYRIGHT BLOCK
+ * Copyright (C) 2026 Red Hat, Inc.
+ * All rights reserved.
+ *
+ * License: GPL (version 3 or any later version).
+ * See LICENSE for details.
+ * END COPYRIGHT BLOCK **/
+
+/*
+ * Streamed and incremental backup of the lmdb database map.
+ *
+ * The map is copied by mdb_env_copyfd in a pipe (so the copy is consistent
+ * and no temporary copy is needed) and the stream is cut in pages:
+ *  - a full backup writes all the pages in data.mdb.gz
+ *  - an incremental backup only writes the pages whose checksum differs
+ *    from the base backup one in data.mdb.delta as <pgno, page> records.
+ *    data.mdb.base contains the base backup directory, relative to the
+ *    backup directory so that a set of backups can be moved together.
+ * As the copy is not compacted, the pages keep their offset in the map and
+ * the pages that were not modified since the base backup are identical.
+ * Both kind of backups write data.mdb.pages (the page checksums and the last
+ * txn id of the backed up map) so that they can be the base of the next
+ * incremental backup. (The checksums of a regular backup are computed
+ * from its data.mdb when it is used as a base)
+ *
+ * Restoring an incremental backup restores its base then writes the
+ * changed pages, and the resulting map is verified against data.mdb.pages.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+#include <unistd.h>
+#include <fcntl.h>
+#include "mdb_layer.h"
+#include "zlib.h"
+
+#define BACKUP_PAGES_MAGIC    "MDBPAGES"
+#define BACKUP_PAGES_VERSION  1
+#define BACKUP_MAX_CHAIN      64        /* Max number of incremental backups between a full one */
+#define BACKUP_GZMODE         "wb1"     /* Favor speed over ratio */
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t psize;
+    uint64_t npages;
+    uint64_t txnid;     /* Last committed txn when the backup started */
+} dbmdb_backup_pages_hdr_t;
+
+typedef struct {
+    dbmdb_backup_pages_hdr_t hdr;
+    uint64_t *sums;
+} dbmdb_backup_pages_t;
+
+typedef struct {
+    MDB_env *env;
+    int fd;
+    int rc;
+} dbmdb_backup_copy_t;
+
+static uint64_t
+dbmdb_backup_page_sum(const unsigned char *page, uint32_t psize)
+{
+    uint64_t crc = crc32(0L, page, psize);
+    uint64_t adler = adler32(1L, page, psize);
+    return (crc << 32) | adler;
+}
+
+static void
+dbmdb_backup_add_sum(dbmdb_backup_pages_t *pages, uint64_t sum, uint64_t *maxpages)
+{
+    if (pages->hdr.npages >= *maxpages) {
+        *maxpages = *maxpages ? 2 * *maxpages : 1024;
+        pages->sums = (uint64_t *)slapi_ch_realloc((char *)pages->sums, *maxpages * sizeof(uint64_t));
+    }
+    pages->sums[pages->hdr.npages++] = sum;
+}
+
+static int
+dbmdb_backup_file_exists(const char *dir, const char *filename)
+{
+    char *path = slapi_ch_smprintf("%s/%s", dir, filename);
+    int rc = (access(path, F_OK) == 0);
+    slapi_ch_free_string(&path);
+    return rc;
+}
+
+/* Tells whether dir contains a database map (plain, compressed or incremental) */
+int
+dbmdb_backup_has_image(const char *dir)
+{
+    return dbmdb_backup_file_exists(dir, DBMAPFILE) ||
+           dbmdb_backup_file_exists(dir, DBMAPFILE_GZ) ||
+           (dbmdb_backup_file_exists(dir, DBMAPFILE_DELTA) &&
+            dbmdb_backup_file_exists(dir, DBMAPFILE_BASE) &&
+            dbmdb_backup_file_exists(dir, DBMAPFILE_PAGES));
+}
+
+/* Read exactly len bytes (unless end of file is reached) */
+static ssize_t
+dbmdb_backup_read(int fd, void *buf, size_t len)
+{
+    size_t done = 0;
+    ssize_t rc = 0;
+
+    while (done < len) {
+        rc = read(fd, (char *)buf + done, len - done);
+        if (rc < 0 && errno == EINTR) {
+            continue;
+        }
+        if (rc <= 0) {
+            break;
+        }
+        done += rc;
+    }
+    return rc < 0 ? rc : done;
+}
+
+/* Compute the page checksums of a map (data.mdb or data.mdb.gz) */
+static int
+dbmdb_backup_sum_image(const char *path, uint32_t psize, dbmdb_backup_pages_t *pages)
+{
+    unsigned char *page = (unsigned char *)slapi_ch_malloc(psize);
+    uint64_t maxpages = 0;
+    gzFile gzfd = gzopen(path, "rb");
+    int len = 0;
+    int rc = 0;
+
+    if (!gzfd) {
+        rc = errno ? errno : ENOMEM;
+    }
+    while (!rc && (len = gzread(gzfd, page, psize)) == (int)psize) {
+        dbmdb_backup_add_sum(pages, dbmdb_backup_page_sum(page, psize), &maxpages);
+    }
+    if (!rc && len != 0) {
+        rc = EINVAL;
+    }
+    if (gzfd) {
+        gzclose(gzfd);
+    }
+    slapi_ch_free((void **)&page);
+    return rc;
+}
+
+/* Get the page checksums of a backup */
+static int
+dbmdb_backup_read_pages(const char *dir, uint32_t psize, dbmdb_backup_pages_t *pages)
+{
+    char *path = slapi_ch_smprintf("%s/%s", dir, DBMAPFILE_PAGES);
+    FILE *fd = fopen(path, "r");
+    int rc = 0;
+
+    memset(pages, 0, sizeof *pages);
+    slapi_ch_free_string(&path);
+    if (!fd) {
+        /* Regular backup: compute the checksums from the map */
+        path = slapi_ch_smprintf("%s/%s", dir, DBMAPFILE);
+        memcpy(pages->hdr.magic, BACKUP_PAGES_MAGIC, sizeof pages->hdr.magic);
+        pages->hdr.version = BACKUP_PAGES_VERSION;
+        pages->hdr.psize = psize;
+        rc = dbmdb_backup_sum_image(path, psize, pages);
+        slapi_ch_free_string(&path);
+        return rc;
+    }
+    if (fread(&pages->hdr, sizeof pages->hdr, 1, fd) != 1 ||
+        memcmp(pages->hdr.magic, BACKUP_PAGES_MAGIC, sizeof pages->hdr.magic) ||
+        pages->hdr.version != BACKUP_PAGES_VERSION) {
+        rc = EINVAL;
+    } else if (pages->hdr.npages > 0) {
+        pages->sums = (uint64_t *)slapi_ch_malloc(pages->hdr.npages * sizeof(uint64_t));
+        if (fread(pages->sums, sizeof(uint64_t), pages->hdr.npages, fd) != pages->hdr.npages) {
+            rc = EINVAL;
+        }
+    }
+    fclose(fd);
+    return rc;
+}
+
+static int
+dbmdb_backup_write_pages(const char *dir, dbmdb_backup_pages_t *pages)
+{
+    char *path = slapi_ch_smprintf("%s/%s", dir, DBMAPFILE_PAGES);
+    FILE *fd = fopen(path, "w");
+    int rc = 0;
+
+    if (!fd) {
+        rc = errno;
+    } else {
+        if (fwrite(&pages->hdr, sizeof pages->hdr, 1, fd) != 1 ||
+            fwrite(pages->sums, sizeof(uint64_t), pages->hdr.npages, fd) != pages->hdr.npages) {
+            rc = errno ? errno : EIO;
+        }
+        if (fclose(fd) && !rc) {
+            rc = errno;
+        }
+    }
+    slapi_ch_free_string(&path);
+    return rc;
+}
+
+/* The path of base_dir relative to dir (both must exist) */
+static char *
+dbmdb_backup_relative_path(const char *dir, const char *base_dir)
+{
+    char dir_real[MAXPATHLEN] = {0};
+    char base_real[MAXPATHLEN] = {0};
+    const char *rest = NULL;
+    size_t common = 0;
+    size_t ups = 0;
+    size_t i = 0;
+    char *rel = NULL;
+    char *pt = NULL;
+
+    if (!realpath(dir, dir_real) || !realpath(base_dir, base_real)) {
+        return slapi_ch_strdup(base_dir);
+    }
+    /* Longest common prefix ending at a directory boundary */
+    for (i = 0; dir_real[i] && dir_real[i] == base_real[i]; i++) {
+        if (dir_real[i] == '/') {
+            common = i;
+        }
+    }
+    if ((dir_real[i] == '\0' && (base_real[i] == '/' || base_real[i] == '\0')) ||
+        (base_real[i] == '\0' && dir_real[i] == '/')) {
+        common = i;
+    }
+    for (i = common; dir_real[i]; i++) {
+        if (dir_real[i] == '/') {
+            ups++;
+        }
+    }
+    rest = (base_real[common] == '/') ? base_real + common + 1 : "";
+
+    pt = rel = (char *)slapi_ch_malloc(3 * ups + strlen(rest) + 2);
+    for (i = 0; i < ups; i++) {
+        memcpy(pt, "../", 3);
+        pt += 3;
+    }
+    strcpy(pt, rest);
+    if (*rel == '\0') {
+        strcpy(rel, ".");
+    } else if (*rest == '\0') {
+        /* Drop the trailing / of the last ../ */
+        rel[strlen(rel) - 1] = '\0';
+    }
+    return rel;
+}
+
+static int
+dbmdb_backup_write_base(const char *dir, const char *base_dir)
+{
+    char *path = slapi_ch_smprintf("%s/%s", dir, DBMAPFILE_BASE);
+    char *rel = dbmdb_backup_relative_path(dir, base_dir);
+    FILE *fd = fopen(path, "w");
+    int rc = 0;
+
+    if (!fd) {
+        rc = errno;
+    } else {
+        if (fprintf(fd, "%s\n", rel) < 0) {
+            rc = errno ? errno : EIO;
+        }
+        if (fclose(fd) && !rc) {
+            rc = errno;
+        }
+    }
+    slapi_ch_free_string(&rel);
+    slapi_ch_free_string(&path);
+    return rc;
+}
+
+static char *
+dbmdb_backup_read_base(const char *dir)
+{
+    char *path = slapi_ch_smprintf("%s/%s", dir, DBMAPFILE_BASE);
+    char buf[MAXPATHLEN + 2] = {0};
+    FILE *fd = fopen(path, "r");
+    char *base = NULL;
+    char *pt = NULL;
+
+    slapi_ch_free_string(&path);
+    if (!fd) {
+        return NULL;
+    }
+    if (fgets(buf, sizeof buf, fd)) {
+        pt = strchr(buf, '\n');
+        if (pt) {
+            *pt = '\0';
+        }
+        if (*buf == '/') {
+            base = slapi_ch_strdup(buf);
+        } else if (*buf) {
+            /* Relative to the backup directory */
+            base = slapi_ch_smprintf("%s/%s", dir, buf);
+        }
+    }
+    fclose(fd);
+    return base;
+}
+
+static void
+dbmdb_backup_copy_thread(void *arg)
+{
+    dbmdb_backup_copy_t *cp = (dbmdb_backup_copy_t *)arg;
+
+    slapi_set_thread_name("backup-copy");
+    cp->rc = mdb_env_copyfd(cp->env, cp->fd);
+    close(cp->fd);
+}
+
+/*
+ * Backup the database map in dest_dir.
+ * If base_dir is set, only the pages that changed since that backup are written.
+ */
+int
+dbmdb_backup_stream(dbmdb_ctx_t *conf, const char *dest_dir, const char *base_dir, int compress, Slapi_Task *task)
+{
+    dbmdb_backup_pages_t base = {0};
+    dbmdb_backup_pages_t pages = {0};
+    dbmdb_backup_copy_t cp = {0};
+    PRThread *thread = NULL;
+    const char *filename = base_dir ? DBMAPFILE_DELTA : DBMAPFILE_GZ;
+    unsigned char *page = NULL;
+    uint64_t maxpages = 0;
+    uint64_t nbchanged = 0;
+    uint64_t pgno = 0;
+    gzFile gzfd = NULL;
+    MDB_envinfo info = {0};
+    MDB_stat st = {0};
+    char *path = NULL;
+    int fds[2] = {-1, -1};
+    ssize_t len = 0;
+    int rc = 0;
+
+    mdb_env_stat(conf->env, &st);
+    mdb_env_info(conf->env, &info);
+    memcpy(pages.hdr.magic, BACKUP_PAGES_MAGIC, sizeof pages.hdr.magic);
+    pages.hdr.version = BACKUP_PAGES_VERSION;
+    pages.hdr.psize = st.ms_psize;
+    pages.hdr.txnid = info.me_last_txnid;
+
+    if (base_dir) {
+        if (!dbmdb_backup_has_image(base_dir)) {
+            slapi_log_err(SLAPI_LOG_ERR, "dbmdb_backup_stream",
+                          "%s does not contain a backup.\n", base_dir);
+            if (task) {
+                slapi_task_log_notice(task, "dbmdb_backup - %s does not contain a backup.", base_dir);
+            }
+            return LDAP_UNWILLING_TO_PERFORM;
+        }
+        rc = dbmdb_backup_read_pages(base_dir, st.ms_psize, &base);
+        if (rc || base.hdr.psize != st.ms_psize) {
+            slapi_log_err(SLAPI_LOG_ERR, "dbmdb_backup_stream",
+                          "Failed to get the page checksums of backup %s. Error is %d.\n", base_dir, rc);
+            if (task) {
+                slapi_task_log_notice(task, "dbmdb_backup - Failed to get the page checksums of backup %s.", base_dir);
+            }
+            slapi_ch_free((void **)&base.sums);
+            return LDAP_UNWILLING_TO_PERFORM;
+        }
+        if (base.hdr.txnid) {
+            slapi_log_err(SLAPI_LOG_INFO, "dbmdb_backup_stream",
+                          "Backing up the pages changed since txn %" PRIu64 " (%s).\n", base.hdr.txnid, base_dir);
+        }
+    }
+
+    path = slapi_ch_smprintf("%s/%s", dest_dir, filename);
+    gzfd = gzopen(path, compress ? BACKUP_GZMODE : "wbT");
+    if (!gzfd || pipe(fds)) {
+        rc = errno ? errno : ENOMEM;
+        slapi_log_err(SLAPI_LOG_ERR, "dbmdb_backup_stream",
+                      "Failed to open %s. Error is %d: %s.\n", path, rc, slapd_system_strerror(rc));
+        goto done;
+    }
+
+    cp.env = conf->env;
+    cp.fd = fds[1];
+    thread = PR_CreateThread(PR_USER_THREAD, (VFP)dbmdb_backup_copy_thread, &cp,
+                             PR_PRIORITY_NORMAL, PR_GLOBAL_THREAD, PR_JOINABLE_THREAD,
+                             SLAPD_DEFAULT_THREAD_STACKSIZE);
+    if (!thread) {
+        PRErrorCode prerr = PR_GetError();
+        slapi_log_err(SLAPI_LOG_ERR, "dbmdb_backup_stream",
+                      "Unable to create the copy thread, " SLAPI_COMPONENT_NAME_NSPR " error %d (%s)\n",
+                      prerr, slapd_pr_strerror(prerr));
+        close(fds[1]);
+        rc = -1;
+        goto done;
+    }
+
+    page = (unsigned char *)slapi_ch_malloc(st.ms_psize);
+    while ((len = dbmdb_backup_read(fds[0], page, st.ms_psize)) == (ssize_t)st.ms_psize) {
+        uint64_t sum = dbmdb_backup_page_sum(page, st.ms_psize);
+
+        dbmdb_backup_add_sum(&pages, sum, &maxpages);
+        if (base_dir) {
+            if (pgno < base.hdr.npages && base.sums[pgno] == sum) {
+                pgno++;
+                continue;
+            }
+            if (gzwrite(gzfd, &pgno, sizeof pgno) != sizeof pgno) {
+                break;
+            }
+        }
+        if (gzwrite(gzfd, page, st.ms_psize) != (int)st.ms_psize) {
+            break;
+        }
+        nbchanged++;
+        pgno++;
+    }
+    if (len != 0) {
+        /* Write error, read error or truncated stream */
+        rc = (len < 0 && errno) ? errno : EIO;
+    }
+    /* Closing the read side aborts the copy if it is not finished */
+    close(fds[0]);
+    fds[0] = -1;
+    PR_JoinThread(thread);
+    if (!rc) {
+        rc = cp.rc;
+    }
+    if (gzclose(gzfd) != Z_OK && !rc) {
+        rc = EIO;
+    }
+    gzfd = NULL;
+    if (rc) {
+        slapi_log_err(SLAPI_LOG_ERR, "dbmdb_backup_stream",
+                      "Failed to backup mdb database to %s. Error is %d: %s.\n",
+                      path, rc, mdb_strerror(rc));
+        goto done;
+    }
+
+    rc = dbmdb_backup_write_pages(dest_dir, &pages);
+    if (!rc && base_dir) {
+        rc = dbmdb_backup_write_base(dest_dir, base_dir);
+    }
+    if (rc) {
+        slapi_log_err(SLAPI_LOG_ERR, "dbmdb_backup_stream",
+                      "Failed to write the page checksums in %s. Error is %d: %s.\n",
+                      dest_dir, rc, slapd_system_strerror(rc));
+        goto done;
+    }
+    if (base_dir) {
+        slapi_log_err(SLAPI_LOG_INFO, "dbmdb_backup_stream",
+                      "Backed up %" PRIu64 " changed pages out of %" PRIu64 " in %s.\n",
+                      nbchanged, pages.hdr.npages, path);
+        if (task) {
+            slapi_task_log_notice(task, "Backed up %" PRIu64 " changed pages out of %" PRIu64 " in %s.",
+                                  nbchanged, pages.hdr.npages, path);
+        }
+    } else {
+        slapi_log_err(SLAPI_LOG_INFO, "dbmdb_backup_stream",
+                      "Backed up %" PRIu64 " pages in %s.\n", pages.hdr.npages, path);
+        if (task) {
+            slapi_task_log_notice(task, "Backed up %" PRIu64 " pages in %s.", pages.hdr.npages, path);
+        }
+    }
+
+done:
+    if (fds[0] >= 0) {
+        close(fds[0]);
+    }
+    if (gzfd) {
+        gzclose(gzfd);
+    }
+    slapi_ch_free((void **)&page);
+    slapi_ch_free((void **)&pages.sums);
+    slapi_ch_free((void **)&base.sums);
+    slapi_ch_free_string(&path);
+    return rc ? LDAP_UNWILLING_TO_PERFORM : 0;
+}
+
+/* Check the restored map against the page checksums of the backup */
+static int
+dbmdb_restore_verify(int fd, const char *src_dir, dbmdb_backup_pages_t *pages, Slapi_Task *task)
+{
+    unsigned char *page = (unsigned char *)slapi_ch_malloc(pages->hdr.psize);
+    uint64_t pgno = 0;
+    int rc = 0;
+
+    for (pgno = 0; !rc && pgno < pages->hdr.npages; pgno++) {
+        if (pread(fd, page, pages->hdr.psize, pgno * pages->hdr.psize) != (ssize_t)pages->hdr.psize) {
+            rc = EIO;
+        } else if (dbmdb_backup_page_sum(page, pages->hdr.psize) != pages->sums[pgno]) {
+            rc = EINVAL;
+        }
+    }
+    slapi_ch_free((void **)&page);
+    if (rc) {
+        slapi_log_err(SLAPI_LOG_ERR, "dbmdb_restore_verify",
+                      "Restored database does not match backup %s (page %" PRIu64 ").\n", src_dir, pgno - 1);
+        if (task) {
+            slapi_task_log_notice(task, "Restore: restored database does not match backup %s (page %" PRIu64 ").",
+                                  src_dir, pgno - 1);
+        }
+    }
+    return rc;
+}
+
+/* Write the map of a backup in fd (recursing on the base backups) */
+static int
+dbmdb_restore_image_fd(int fd, const char *src_dir, int depth, Slapi_Task *task)
+{
+    dbmdb_backup_pages_t pages = {0};
+    unsigned char *page = NULL;
+    char *base_dir = NULL;
+    char *path = NULL;
+    gzFile gzfd = NULL;
+    uint64_t pgno = 0;
+    int len = 0;
+    int rc = 0;
+
+    if (!dbmdb_backup_file_exists(src_dir, DBMAPFILE_DELTA)) {
+        /* Full backup: copy (and uncompress) the map */
+        path = slapi_ch_smprintf("%s/%s", src_dir,
+                                 dbmdb_backup_file_exists(src_dir, DBMAPFILE_GZ) ? DBMAPFILE_GZ : DBMAPFILE);
+        page = (unsigned char *)slapi_ch_malloc(MEGABYTE);
+        gzfd = gzopen(path, "rb");
+        if (!gzfd) {
+            rc = errno ? errno : ENOMEM;
+        }
+        if (!rc && (ftruncate(fd, 0) || lseek(fd, 0, SEEK_SET) < 0)) {
+            rc = errno;
+        }
+        while (!rc && (len = gzread(gzfd, page, MEGABYTE)) > 0) {
+            if (write(fd, page, len) != len) {
+                rc = errno ? errno : EIO;
+            }
+        }
+        if (!rc && len < 0) {
+            rc = EIO;
+        }
+        if (!rc && dbmdb_backup_file_exists(src_dir, DBMAPFILE_PAGES)) {
+            rc = dbmdb_backup_read_pages(src_dir, 0, &pages);
+            if (!rc) {
+                rc = dbmdb_restore_verify(fd, src_dir, &pages, task);
+            }
+        }
+        goto done;
+    }
+
+    if (depth >= BACKUP_MAX_CHAIN) {
+        slapi_log_err(SLAPI_LOG_ERR, "dbmdb_restore_image",
+                      "Too many incremental backups are chained from %s.\n", src_dir);
+        rc = EINVAL;
+        goto done;
+    }
+    base_dir = dbmdb_backup_read_base(src_dir);
+    if (!base_dir || !dbmdb_backup_has_image(base_dir)) {
+        slapi_log_err(SLAPI_LOG_ERR, "dbmdb_restore_image",
+                      "The base backup (%s) of incremental backup %s is missing.\n",
+                      base_dir ? base_dir : "unknown", src_dir);
+        if (task) {
+            slapi_task_log_notice(task, "Restore: the base backup (%s) of incremental backup %s is missing.",
+                                  base_dir ? base_dir : "unknown", src_dir);
+        }
+        rc = ENOENT;
+        goto done;
+    }
+    rc = dbmdb_restore_image_fd(fd, base_dir, depth + 1, task);
+    if (!rc) {
+        rc = dbmdb_backup_read_pages(src_dir, 0, &pages);
+    }
+    if (rc) {
+        goto done;
+    }
+
+    /* Write the changed pages over the base map */
+    path = slapi_ch_smprintf("%s/%s", src_dir, DBMAPFILE_DELTA);
+    page = (unsigned char *)slapi_ch_malloc(pages.hdr.psize);
+    gzfd = gzopen(path, "rb");
+    if (!gzfd) {
+        rc = errno ? errno : ENOMEM;
+    }
+    while (!rc && (len = gzread(gzfd, &pgno, sizeof pgno)) == sizeof pgno) {
+        if (pgno >= pages.hdr.npages || gzread(gzfd, page, pages.hdr.psize) != (int)pages.hdr.psize) {
+            rc = EINVAL;
+        } else if (pwrite(fd, page, pages.hdr.psize, pgno * pages.hdr.psize) != (ssize_t)pages.hdr.psize) {
+            rc = errno ? errno : EIO;
+        }
+    }
+    if (!rc && len != 0) {
+        rc = EINVAL;
+    }
+    if (!rc && ftruncate(fd, pages.hdr.npages * pages.hdr.psize)) {
+        rc = errno;
+    }
+    if (!rc) {
+        rc = dbmdb_restore_verify(fd, src_dir, &pages, task);
+    }
+
+done:
+    if (rc) {
+        slapi_log_err(SLAPI_LOG_ERR, "dbmdb_restore_image",
+                      "Failed to restore the database map from %s. Error is %d: %s.\n",
+                      src_dir, rc, slapd_system_strerror(rc));
+    }
+    if (gzfd) {
+        gzclose(gzfd);
+    }
+    slapi_ch_free((void **)&page);
+    slapi_ch_free((void **)&pages.sums);
+    slapi_ch_free_string(&base_dir);
+    slapi_ch_free_string(&path);
+    return rc;
+}
+
+/* Restore the database map of a compressed or incremental backup */
+int
+dbmdb_restore_image(struct ldbminfo *li, const char *src_dir, Slapi_Task *task)
+{
+    char *path = slapi_ch_smprintf("%s/%s", MDB_CONFIG(li)->home, DBMAPFILE);
+    int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, li->li_mode);
+    int rc = 0;
+
+    if (fd < 0) {
+        rc = errno;
+        slapi_log_err(SLAPI_LOG_ERR, "dbmdb_restore_image",
+                      "Failed to open %s. Error is %d: %s.\n", path, rc, slapd_system_strerror(rc));
+    } else {
+        rc = dbmdb_restore_image_fd(fd, src_dir, 0, task);
+        if (close(fd) && !rc) {
+            rc = errno;
+        }
+    }
+    if (rc && task) {
+        slapi_task_log_notice(task, "Restore: Failed to restore database map file to %s.", path);
+    }
+    slapi_ch_free_string(&path);
+    return rc ? -1 : 0;
+}
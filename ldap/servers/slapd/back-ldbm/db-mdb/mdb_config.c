@@ -155,6 +155,7 @@ int mdb_init(struct ldbminfo *li, config_info *config_array)
     pthread_mutex_init(&conf->dbis_lock, NULL);
     pthread_mutex_init(&conf->rcmutex, NULL);
     pthread_rwlock_init(&conf->dbmdb_env_lock, NULL);
+    dbmdb_group_commit_init(conf);
 
     dbmdb_ctx_t_setup_default(li);
     /* Do not compute limit if dse.ldif is not taken in account (i.e. dbscan) */
@@ -179,6 +180,7 @@ int mdb_init(struct ldbminfo *li, config_info *config_array)
     priv->dblayer_txn_begin_fn = &dbmdb_txn_begin;
     priv->dblayer_txn_commit_fn = &dbmdb_txn_commit;
     priv->dblayer_txn_abort_fn = &dbmdb_txn_abort;
+    priv->dblayer_txn_sync_fn = &dbmdb_txn_sync;
     priv->dblayer_get_info_fn = &dbmdb_get_info;
     priv->dblayer_set_info_fn = &dbmdb_set_info;
     priv->dblayer_back_ctrl_fn = &dbmdb_back_ctrl;
@@ -477,6 +479,87 @@ dbmdb_ctx_t_db_durable_transactions_set(void *arg, void *value, char *errorbuf _
     return retval;
 }
 
+static void *
+dbmdb_ctx_t_db_group_commit_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)(MDB_CONFIG(li)->dsecfg.group_commit));
+}
+
+static int
+dbmdb_ctx_t_db_group_commit_set(void *arg, void *value, char *errorbuf __attribute__((unused)), int phase, int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int retval = LDAP_SUCCESS;
+    int val = (int)((uintptr_t)value);
+
+    if (apply) {
+        MDB_CONFIG(li)->dsecfg.group_commit = val;
+        if (CONFIG_PHASE_RUNNING == phase) {
+            slapi_log_err(SLAPI_LOG_NOTICE, "dbmdb_ctx_t_db_group_commit_set",
+                "New nsslapd-mdb-group-commit will not take affect until the server is restarted\n");
+        }
+    }
+
+    return retval;
+}
+
+static void *
+dbmdb_ctx_t_db_group_commit_batch_size_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)(MDB_CONFIG(li)->dsecfg.group_commit_batch_size));
+}
+
+static int
+dbmdb_ctx_t_db_group_commit_batch_size_set(void *arg, void *value, char *errorbuf, int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int val = (int)((uintptr_t)value);
+
+    if (val < 1) {
+        slapi_create_errormsg(errorbuf, SLAPI_DSE_RETURNTEXT_SIZE,
+                              "Error: Invalid value for %s (%d). The value must be greater than \"0\"\n",
+                              CONFIG_MDB_GROUP_COMMIT_BATCH_SIZE, val);
+        return LDAP_UNWILLING_TO_PERFORM;
+    }
+    if (apply) {
+        MDB_CONFIG(li)->dsecfg.group_commit_batch_size = val;
+    }
+
+    return LDAP_SUCCESS;
+}
+
+static void *
+dbmdb_ctx_t_db_group_commit_window_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)(MDB_CONFIG(li)->dsecfg.group_commit_window));
+}
+
+static int
+dbmdb_ctx_t_db_group_commit_window_set(void *arg, void *value, char *errorbuf, int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int val = (int)((uintptr_t)value);
+
+    /* The window is in microseconds, a second is already way too long */
+    if (val < 0 || val > 1000000) {
+        slapi_create_errormsg(errorbuf, SLAPI_DSE_RETURNTEXT_SIZE,
+                              "Error: Invalid value for %s (%d). The value must be between \"0\" and \"1000000\"\n",
+                              CONFIG_MDB_GROUP_COMMIT_WINDOW, val);
+        return LDAP_UNWILLING_TO_PERFORM;
+    }
+    if (apply) {
+        MDB_CONFIG(li)->dsecfg.group_commit_window = val;
+    }
+
+    return LDAP_SUCCESS;
+}
+
 static void *
 dbmdb_ctx_t_db_import_stats_get(void *arg)
 {
@@ -499,6 +582,104 @@ dbmdb_ctx_t_db_import_stats_set(void *arg, void *value, char *errorbuf __attribu
     return retval;
 }
 
+static void *
+dbmdb_ctx_t_db_reindex_shadow_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)(MDB_CONFIG(li)->dsecfg.reindex_shadow));
+}
+
+static int
+dbmdb_ctx_t_db_reindex_shadow_set(void *arg, void *value, char *errorbuf __attribute__((unused)), int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int retval = LDAP_SUCCESS;
+    int val = (int)((uintptr_t)value);
+
+    if (apply) {
+        MDB_CONFIG(li)->dsecfg.reindex_shadow = val;
+    }
+
+    return retval;
+}
+
+static void *
+dbmdb_ctx_t_db_import_sorted_runs_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)(MDB_CONFIG(li)->dsecfg.import_sorted_runs));
+}
+
+static int
+dbmdb_ctx_t_db_import_sorted_runs_set(void *arg, void *value, char *errorbuf __attribute__((unused)), int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int retval = LDAP_SUCCESS;
+    int val = (int)((uintptr_t)value);
+
+    if (apply) {
+        MDB_CONFIG(li)->dsecfg.import_sorted_runs = val;
+    }
+
+    return retval;
+}
+
+static void *
+dbmdb_ctx_t_db_import_run_size_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)(MDB_CONFIG(li)->dsecfg.import_run_size));
+}
+
+static int
+dbmdb_ctx_t_db_import_run_size_set(void *arg, void *value, char *errorbuf, int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int val = (int)((uintptr_t)value);
+
+    if (val < DBMDB_IMPORT_RUN_SIZE_MIN || val > DBMDB_IMPORT_RUN_SIZE_MAX) {
+        slapi_create_errormsg(errorbuf, SLAPI_DSE_RETURNTEXT_SIZE,
+                              "Error: Invalid value for %s (%d). The value must be between \"%d\" and \"%d\"\n",
+                              CONFIG_MDB_IMPORT_RUN_SIZE, val, DBMDB_IMPORT_RUN_SIZE_MIN, DBMDB_IMPORT_RUN_SIZE_MAX);
+        return LDAP_UNWILLING_TO_PERFORM;
+    }
+    if (apply) {
+        MDB_CONFIG(li)->dsecfg.import_run_size = val;
+    }
+
+    return LDAP_SUCCESS;
+}
+
+static void *
+dbmdb_ctx_t_db_export_threads_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)(MDB_CONFIG(li)->dsecfg.export_threads));
+}
+
+static int
+dbmdb_ctx_t_db_export_threads_set(void *arg, void *value, char *errorbuf, int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int val = (int)((uintptr_t)value);
+
+    if (val < 0 || val > DBMDB_EXPORT_THREADS_MAX) {
+        slapi_create_errormsg(errorbuf, SLAPI_DSE_RETURNTEXT_SIZE,
+                              "Error: Invalid value for %s (%d). The value must be between \"0\" and \"%d\"\n",
+                              CONFIG_MDB_EXPORT_THREADS, val, DBMDB_EXPORT_THREADS_MAX);
+        return LDAP_UNWILLING_TO_PERFORM;
+    }
+    if (apply) {
+        MDB_CONFIG(li)->dsecfg.export_threads = val;
+    }
+
+    return LDAP_SUCCESS;
+}
+
 static int
 dbmdb_ctx_t_set_bypass_filter_test(void *arg,
                                    void *value,
@@ -611,7 +792,14 @@ static config_info dbmdb_ctx_t_param[] = {
     {CONFIG_MDB_MAX_DBS, CONFIG_TYPE_INT, "512", &dbmdb_ctx_t_db_max_dbs_get, &dbmdb_ctx_t_db_max_dbs_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
     {CONFIG_MAXPASSBEFOREMERGE, CONFIG_TYPE_INT, "100", &dbmdb_ctx_t_maxpassbeforemerge_get, &dbmdb_ctx_t_maxpassbeforemerge_set, 0},
     {CONFIG_DB_DURABLE_TRANSACTIONS, CONFIG_TYPE_ONOFF, "on", &dbmdb_ctx_t_db_durable_transactions_get, &dbmdb_ctx_t_db_durable_transactions_set, CONFIG_FLAG_ALWAYS_SHOW},
+    {CONFIG_MDB_GROUP_COMMIT, CONFIG_TYPE_ONOFF, "off", &dbmdb_ctx_t_db_group_commit_get, &dbmdb_ctx_t_db_group_commit_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
+    {CONFIG_MDB_GROUP_COMMIT_BATCH_SIZE, CONFIG_TYPE_INT, "64", &dbmdb_ctx_t_db_group_commit_batch_size_get, &dbmdb_ctx_t_db_group_commit_batch_size_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
+    {CONFIG_MDB_GROUP_COMMIT_WINDOW, CONFIG_TYPE_INT, "1000", &dbmdb_ctx_t_db_group_commit_window_get, &dbmdb_ctx_t_db_group_commit_window_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
     {CONFIG_MDB_IMPORT_STATS, CONFIG_TYPE_ONOFF, "off", &dbmdb_ctx_t_db_import_stats_get, &dbmdb_ctx_t_db_import_stats_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
+    {CONFIG_MDB_IMPORT_SORTED_RUNS, CONFIG_TYPE_ONOFF, "off", &dbmdb_ctx_t_db_import_sorted_runs_get, &dbmdb_ctx_t_db_import_sorted_runs_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
+    {CONFIG_MDB_IMPORT_RUN_SIZE, CONFIG_TYPE_INT, "67108864", &dbmdb_ctx_t_db_import_run_size_get, &dbmdb_ctx_t_db_import_run_size_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
+    {CONFIG_MDB_REINDEX_SHADOW, CONFIG_TYPE_ONOFF, "off", &dbmdb_ctx_t_db_reindex_shadow_get, &dbmdb_ctx_t_db_reindex_shadow_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
+    {CONFIG_MDB_EXPORT_THREADS, CONFIG_TYPE_INT, "0", &dbmdb_ctx_t_db_export_threads_get, &dbmdb_ctx_t_db_export_threads_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
     {CONFIG_BYPASS_FILTER_TEST, CONFIG_TYPE_STRING, "on", &dbmdb_ctx_t_get_bypass_filter_test, &dbmdb_ctx_t_set_bypass_filter_test, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
     {CONFIG_SERIAL_LOCK, CONFIG_TYPE_ONOFF, "on", &dbmdb_ctx_t_serial_lock_get, &dbmdb_ctx_t_serial_lock_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
     {CONFIG_CACHE_AUTOSIZE, CONFIG_TYPE_INT, "25", &mdb_config_cache_autosize_get, &mdb_config_cache_autosize_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
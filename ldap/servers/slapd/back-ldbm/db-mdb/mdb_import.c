@@ -957,6 +957,15 @@ dbmdb_public_dbmdb_import_main(void *arg)
         goto error;
     }
 
+    if (ctx->role == IM_INDEX) {
+        /* Replace the indexes that were rebuilt aside (if any) */
+        ret = dbmdb_import_switch_shadow_indexes(ctx);
+        if (ret != 0) {
+            import_log_notice(job, SLAPI_LOG_ERR, "dbmdb_public_dbmdb_import_main",
+                              "Failed to switch over the rebuilt indexes");
+            goto error;
+        }
+    }
 
     import_log_notice(job, SLAPI_LOG_INFO, "dbmdb_public_dbmdb_import_main", "Indexing complete.  Post-processing...");
 
@@ -115,6 +115,7 @@ typedef struct _mdb_index_info {
     struct attrinfo *ai;
     int flags;
     dbmdb_dbi_t *dbi;
+    dbmdb_dbi_t *livedbi;       /* Index replaced by dbi once reindex is done (NULL if rebuilt in place) */
     struct _mdb_index_info *next;
 } MdbIndexInfo_t;
 
@@ -179,5 +180,6 @@ void dbmdb_free_worker_slot(struct importqueue *q, void *slot);
 int dbmdb_import_init_writer(ImportJob *job, ImportRole_t role);
 void dbmdb_free_import_ctx(ImportJob *job);
 void dbmdb_build_import_index_list(ImportCtx_t *ctx);
+int dbmdb_import_switch_shadow_indexes(ImportCtx_t *ctx);
 
 int is_reindexed_attr(const char *attrname, const ImportCtx_t *ctx, char **list);
@@ -1861,9 +1861,11 @@ dbmdb_import_index_prepare_worker_entry(WorkerQueueData_t *wqelmnt)
     Slapi_Entry *e = NULL;
     char *normdn = NULL;
     char *rdn = NULL;
+    int binary = 0;
 
     /* call post-entry plugin */
     plugin_call_entryfetch_plugins(&entry_str, &entry_len);
+    binary = entrybin_is_binary(entry_str, entry_len);
 
     /*
      * dn is yet unknown so lets use the rdn instead.
@@ -1872,10 +1874,11 @@ dbmdb_import_index_prepare_worker_entry(WorkerQueueData_t *wqelmnt)
      * if needed (upgrade case) dn could be recomputed when walking
      * the ancestors in process_entryrdn_byrdn
      */
-    if (get_value_from_string(entry_str, "rdn", &rdn)) {
+    if (binary ? entrybin_get_value(entry_str, entry_len, "rdn", &rdn)
+               : get_value_from_string(entry_str, "rdn", &rdn)) {
         slapi_log_err(SLAPI_LOG_ERR, "dbmdb_import_index_prepare_worker_entry",
                 "Invalid entry (no rdn) in database for id %d entry: %s\n",
-                id, entry_str);
+                id, binary ? "(binary)" : entry_str);
         slapi_ch_free(&wqelmnt->data);
         thread_abort(info);
         return NULL;
@@ -1885,13 +1888,17 @@ dbmdb_import_index_prepare_worker_entry(WorkerQueueData_t *wqelmnt)
     } else {
         normdn = slapi_ch_smprintf("%s,%s", rdn, suffix);
     }
-    e = slapi_str2entry_ext(normdn, NULL, entry_str, SLAPI_STR2ENTRY_NO_ENTRYDN);
+    if (binary) {
+        e = bin2entry(normdn, NULL, entry_str, entry_len, SLAPI_STR2ENTRY_NO_ENTRYDN);
+    } else {
+        e = slapi_str2entry_ext(normdn, NULL, entry_str, SLAPI_STR2ENTRY_NO_ENTRYDN);
+    }
     slapi_ch_free_string(&normdn);
     slapi_ch_free_string(&rdn);
     if (e==NULL) {
         slapi_log_err(SLAPI_LOG_ERR, "dbmdb_import_index_prepare_worker_entry",
                 "Invalid entry (Conversion failed) in database for id %d entry: %s\n",
-                id, entry_str);
+                id, binary ? "(binary)" : entry_str);
     }
     slapi_ch_free(&wqelmnt->data);
     ep = dbmdb_import_make_backentry(e, id);
@@ -2070,6 +2077,8 @@ dbmdb_upgrade_prepare_worker_entry(WorkerQueueData_t *wqelmnt)
     struct upgradedn_attr *ud_ptr = NULL;
     Slapi_Attr *ud_attr = NULL;
     char *ecopy = NULL;
+    char *ldif = NULL;
+    size_t ldif_size = 0;
     char *normdn = NULL;
     char *rdn = NULL;       /* original rdn */
     int is_dryrun = 0;      /* FLAG_DRYRUN */
@@ -2109,6 +2118,14 @@ dbmdb_upgrade_prepare_worker_entry(WorkerQueueData_t *wqelmnt)
          entry_len = data.mv_size;
          plugin_call_entryfetch_plugins(&entry_str, &entry_len);
 
+        /* binary id2entry records are upgraded from their LDIF form */
+        slapi_ch_free_string(&ldif);
+        ldif = id2entry_data2str(entry_str, entry_len, &ldif_size);
+        if (ldif) {
+            entry_str = ldif;
+            entry_len = (uint)ldif_size;
+        }
+
         slapi_ch_free_string(&ecopy);
         ecopy = (char *)slapi_ch_malloc(entry_len + 1);
         memcpy(ecopy, entry_str, entry_len);
@@ -2691,9 +2708,10 @@ done:
     dbmdb_close_cursor(&dbc, 1 /* Abort txn */);
     dbmdb_free_IDarray(&dn_norm_sp_conflicts);
     slapi_ch_free_string(&ecopy);
-    if(data.mv_data!=entry_str){
+    if(data.mv_data!=entry_str && ldif!=entry_str){
         slapi_ch_free_string(&entry_str);
     }
+    slapi_ch_free_string(&ldif);
     slapi_ch_free_string(&rdn);
     if (job->upgradefd) {
         fclose(job->upgradefd);
@@ -2782,7 +2800,7 @@ int dbmdb_import_add_id2entry_add(ImportJob *job, backend *be, struct backentry
 {
     int encrypt = job->encrypt;
     WriterQueueData_t wqd = {0};
-    int len = 0;
+    size_t dsize = 0;
     int rc = 0;
     char temp_id[sizeof(ID)];
     struct backentry *encrypted_entry = NULL;
@@ -2808,10 +2826,9 @@ int dbmdb_import_add_id2entry_add(ImportJob *job, backend *be, struct backentry
         }
     }
     {
-        int options = SLAPI_DUMP_STATEINFO | SLAPI_DUMP_UNIQUEID | SLAPI_DUMP_RDN_ENTRY;
         Slapi_Entry *entry_to_use = encrypted_entry ? encrypted_entry->ep_entry : e->ep_entry;
-        wqd.data.mv_data = slapi_entry2str_with_options(entry_to_use, &len, options);
-        esize = (uint32_t)len+1;
+        wqd.data.mv_data = id2entry_entry2data(be, entry_to_use, &dsize);
+        esize = (uint32_t)dsize;
         plugin_call_entrystore_plugins((char **)&wqd.data.mv_data, &esize);
         wqd.data.mv_size = esize;
         dbmdb_import_writeq_push(ctx, &wqd);
@@ -3393,6 +3410,121 @@ cmp_mii(caddr_t data1, caddr_t data2)
     return conv[*n1] - conv[*n2];
 }
 
+/* Shadow indexes
+ *
+ * When nsslapd-mdb-reindex-shadow is set, an online reindex does not
+ * truncate the attribute indexes it rebuilds (that would mark them dirty
+ * and the searches could not use them until the end of the task).
+ * It rather builds each of them in a "<index>@reindex" dbi, and once all
+ * the entries are indexed, the content of the live index is replaced by
+ * the shadow one within a single write txn. So the searches see either the
+ * old index or the new one. The shadow dbi is removed afterwards.
+ * System indexes (entryrdn, parentid, ancestorid, ...) and the vlv indexes
+ * are still rebuilt in place.
+ */
+#define REINDEX_SHADOW_SUFFIX "@reindex"
+
+static int
+dbmdb_open_shadow_index(ImportCtx_t *ctx, MdbIndexInfo_t *mii)
+{
+    int dbi_flags = MDB_CREATE|MDB_MARK_DIRTY_DBI|MDB_OPEN_DIRTY_DBI|MDB_TRUNCATE_DBI;
+    backend *be = ctx->job->inst->inst_be;
+    char *shadowname = NULL;
+    int rc = 0;
+
+    /* The live index is only read during the reindex (the backend is read-only) */
+    rc = dbmdb_open_dbi_from_filename(&mii->livedbi, be, mii->name, mii->ai, MDB_CREATE|MDB_OPEN_DIRTY_DBI);
+    if (rc == 0) {
+        shadowname = slapi_ch_smprintf("%s%s", mii->name, REINDEX_SHADOW_SUFFIX);
+        DBG_LOG(DBGMDB_LEVEL_OTHER,"Calling dbmdb_open_dbi_from_filename for %s flags = 0x%x", shadowname, dbi_flags);
+        rc = dbmdb_open_dbi_from_filename(&mii->dbi, be, shadowname, mii->ai, dbi_flags);
+        slapi_ch_free_string(&shadowname);
+    }
+    if (rc) {
+        slapi_log_err(SLAPI_LOG_WARNING, "dbmdb_open_shadow_index",
+                      "Failed to open the shadow index of %s (error %d: %s). The index is rebuilt in place.\n",
+                      mii->name, rc, mdb_strerror(rc));
+        mii->livedbi = NULL;
+        mii->dbi = NULL;
+    }
+    return rc;
+}
+
+/* Replace the content of the live index by the shadow one */
+static int
+dbmdb_switch_shadow_index(caddr_t data, caddr_t arg)
+{
+    MdbIndexInfo_t *mii = (MdbIndexInfo_t *)data;
+    ImportCtx_t *ctx = (ImportCtx_t *)arg;
+    MDB_cursor *cursor = NULL;
+    MDB_txn *txn = NULL;
+    MDB_val key = {0};
+    MDB_val val = {0};
+    size_t nbrecs = 0;
+    int rc = 0;
+
+    if (!mii->livedbi) {
+        return 0;
+    }
+    rc = TXN_BEGIN(ctx->ctx->env, NULL, 0, &txn);
+    if (!rc) {
+        rc = MDB_DROP(txn, mii->livedbi->dbi, 0);
+    }
+    if (!rc) {
+        rc = MDB_CURSOR_OPEN(txn, mii->dbi->dbi, &cursor);
+    }
+    if (!rc) {
+        rc = MDB_CURSOR_GET(cursor, &key, &val, MDB_FIRST);
+        while (rc == 0) {
+            /* Both dbis have the same compare functions so the records come in order */
+            rc = MDB_PUT(txn, mii->livedbi->dbi, &key, &val, MDB_APPENDDUP);
+            if (rc == MDB_KEYEXIST) {
+                rc = MDB_PUT(txn, mii->livedbi->dbi, &key, &val, 0);
+            }
+            if (rc) {
+                break;
+            }
+            nbrecs++;
+            rc = MDB_CURSOR_GET(cursor, &key, &val, MDB_NEXT);
+        }
+        if (rc == MDB_NOTFOUND) {
+            rc = 0;
+        }
+        MDB_CURSOR_CLOSE(cursor);
+    }
+    if (!rc) {
+        rc = TXN_COMMIT(txn);
+    } else if (txn) {
+        TXN_ABORT(txn);
+    }
+    if (rc) {
+        slapi_log_err(SLAPI_LOG_ERR, "dbmdb_switch_shadow_index",
+                      "Failed to switch over the rebuilt index %s. Error is %d: %s.\n",
+                      mii->name, rc, mdb_strerror(rc));
+        return -1;
+    }
+    import_log_notice(ctx->job, SLAPI_LOG_INFO, "dbmdb_switch_shadow_index",
+                      "%s: Index %s switched over (%lu records).",
+                      ctx->job->inst->inst_name, mii->name, (unsigned long)nbrecs);
+    rc = dbmdb_dbi_remove(ctx->ctx, (dbi_db_t **)&mii->dbi);
+    if (rc) {
+        /* The index is fine, only the shadow dbi is left behind */
+        slapi_log_err(SLAPI_LOG_WARNING, "dbmdb_switch_shadow_index",
+                      "Failed to remove the shadow index of %s. Error is %d: %s.\n",
+                      mii->name, rc, mdb_strerror(rc));
+    }
+    mii->dbi = mii->livedbi;
+    mii->livedbi = NULL;
+    return 0;
+}
+
+/* Called once all the reindex threads are finished */
+int
+dbmdb_import_switch_shadow_indexes(ImportCtx_t *ctx)
+{
+    return avl_apply(ctx->indexes, dbmdb_switch_shadow_index, (caddr_t)ctx, -1, AVL_INORDER);
+}
+
 /* Create MdbIndexInfo_t for the naming attributes that are missing */
 void
 dbmdb_add_import_index(ImportCtx_t *ctx, const char *name, IndexInfo *ii)
@@ -3456,6 +3588,17 @@ dbmdb_add_import_index(ImportCtx_t *ctx, const char *name, IndexInfo *ii)
         }
     }
 
+    if (ctx->role == IM_INDEX && (job->flags & FLAG_ONLINE) && ctx->ctx->dsecfg.reindex_shadow &&
+        !(mii->flags & (MII_SKIP | MII_NOATTR)) && ii->ai->ai_indexmask != INDEX_VLV) {
+        /* Online reindex: build the index aside so that the searches
+         * keep using the current one until the switch over
+         */
+        if (dbmdb_open_shadow_index(ctx, mii) == 0) {
+            avl_insert(&ctx->indexes, (caddr_t)mii, cmp_mii, NULL);
+            return;
+        }
+    }
+
     DBG_LOG(DBGMDB_LEVEL_OTHER,"Calling dbmdb_open_dbi_from_filename for %s flags = 0x%x", mii->name, dbi_flags);
     dbmdb_open_dbi_from_filename(&mii->dbi, job->inst->inst_be, mii->name, mii->ai, dbi_flags);
     avl_insert(&ctx->indexes, (caddr_t)mii, cmp_mii, NULL);
@@ -3912,6 +4055,492 @@ _get_import_entryusn(ImportJob *job, Slapi_Value **usn_value)
     return 0;
 }
 
+/* Sorted runs
+ *
+ * When nsslapd-mdb-import-sorted-runs is set, the ldif2db and db2index
+ * writer does not put the records of the DUPSORT dbis (i.e the indexes) as
+ * soon as they are dequeued: it stores them in a buffer that is sorted (by dbi, key and data)
+ * and spilled in a temporary file when it is full. Once the workers have
+ * finished, the runs are merged and the dbis are loaded in key order with
+ * MDB_APPENDDUP so that lmdb only fills the last page instead of updating
+ * pages spread all over the b-tree.
+ * The other dbis (id2entry, redirect) are still written directly because the
+ * last written value of a key must win, but id2entry records are appended
+ * when their key is greater than the previous one (the workers produce them
+ * almost in ID order).
+ * The size of the in memory run is nsslapd-mdb-import-run-size.
+ */
+#define IMPORT_RUN_FILE       "%s/%s-import-run-%d.tmp"
+
+typedef struct {
+    MDB_dbi dbi;
+    uint32_t keylen;
+    uint32_t datalen;
+} ImportRunHdr_t;
+
+typedef struct {
+    ImportRunHdr_t hdr;
+    MDB_val key;
+    MDB_val data;
+} ImportRunRec_t;
+
+typedef struct {
+    FILE *fd;                  /* Run file (NULL for the in memory run) */
+    ImportRunRec_t *rec;       /* Current record */
+    ImportRunRec_t filerec;    /* Last record read from the run file */
+    char *buf;                 /* filerec key and data */
+    size_t bufsize;
+    ImportRunRec_t **recs;     /* In memory run records */
+    size_t nbrecs;
+    size_t idx;
+} ImportRunReader_t;
+
+typedef struct {
+    ImportCtx_t *ctx;
+    MDB_txn *txn;              /* Txn used to compare the keys */
+    char *arena;               /* In memory run records */
+    size_t arenalen;
+    size_t arenasize;          /* Size of the in memory run */
+    size_t maxrec;             /* Larger records are not deferred */
+    ImportRunRec_t **recs;
+    size_t nbrecs;
+    size_t maxrecs;
+    FILE **fds;                /* Spilled runs */
+    int nbruns;
+    dbmdb_dbi_t **dbis;        /* dbi whose flags are known (indexed by MDB_dbi) */
+    unsigned int *dbflags;
+    MDB_dbi nbdbis;
+    char lastid[sizeof(ID)];   /* Last key appended in id2entry */
+    size_t lastidlen;
+} ImportRuns_t;
+
+static ImportRuns_t *
+dbmdb_import_runs_new(ImportCtx_t *ctx)
+{
+    ImportRuns_t *runs = CALLOC(ImportRuns_t);
+
+    runs->ctx = ctx;
+    runs->arenasize = ctx->ctx->dsecfg.import_run_size;
+    runs->maxrec = runs->arenasize / 16;
+    runs->arena = slapi_ch_malloc(runs->arenasize);
+    return runs;
+}
+
+static void
+dbmdb_import_runs_free(ImportRuns_t **runs)
+{
+    int i;
+
+    if (*runs) {
+        for (i = 0; i < (*runs)->nbruns; i++) {
+            fclose((*runs)->fds[i]);
+        }
+        slapi_ch_free((void**)&(*runs)->fds);
+        slapi_ch_free((void**)&(*runs)->recs);
+        slapi_ch_free((void**)&(*runs)->arena);
+        slapi_ch_free((void**)&(*runs)->dbis);
+        slapi_ch_free((void**)&(*runs)->dbflags);
+        slapi_ch_free((void**)runs);
+    }
+}
+
+static int
+import_run_cmp(ImportRuns_t *runs, const ImportRunRec_t *r1, const ImportRunRec_t *r2)
+{
+    int rc;
+
+    if (r1->hdr.dbi != r2->hdr.dbi) {
+        return (r1->hdr.dbi < r2->hdr.dbi) ? -1 : 1;
+    }
+    rc = mdb_cmp(runs->txn, r1->hdr.dbi, &r1->key, &r2->key);
+    if (rc == 0) {
+        /* Only DUPSORT dbis records are deferred */
+        rc = mdb_dcmp(runs->txn, r1->hdr.dbi, &r1->data, &r2->data);
+    }
+    return rc;
+}
+
+/* Merge sort (there is no qsort_r and the comparison needs the txn) */
+static void
+import_run_sort(ImportRuns_t *runs, ImportRunRec_t **recs, ImportRunRec_t **tmp, size_t nb)
+{
+    size_t half = nb / 2;
+    size_t i = 0;
+    size_t j = half;
+    size_t k = 0;
+
+    if (nb < 2) {
+        return;
+    }
+    import_run_sort(runs, recs, tmp, half);
+    import_run_sort(runs, recs + half, tmp, nb - half);
+    while (i < half && j < nb) {
+        tmp[k++] = (import_run_cmp(runs, recs[j], recs[i]) < 0) ? recs[j++] : recs[i++];
+    }
+    while (i < half) {
+        tmp[k++] = recs[i++];
+    }
+    /* recs[j..nb-1] are already at the right place */
+    memcpy(recs, tmp, k * sizeof(*recs));
+}
+
+static void
+import_run_sort_buffer(ImportRuns_t *runs)
+{
+    ImportRunRec_t **tmp = (ImportRunRec_t **)slapi_ch_malloc((runs->nbrecs + 1) * sizeof(*tmp));
+
+    import_run_sort(runs, runs->recs, tmp, runs->nbrecs);
+    slapi_ch_free((void**)&tmp);
+}
+
+/* Sort the in memory run and write it in a temporary file */
+static int
+import_run_spill(ImportRuns_t *runs)
+{
+    ImportJob *job = runs->ctx->job;
+    char path[MAXPATHLEN];
+    FILE *fd = NULL;
+    size_t i;
+    int rc = 0;
+
+    PR_snprintf(path, (sizeof path), IMPORT_RUN_FILE, runs->ctx->ctx->home,
+                job->inst->inst_name, runs->nbruns);
+    fd = fopen(path, "w+");
+    if (!fd) {
+        rc = errno;
+        import_log_notice(job, SLAPI_LOG_ERR, "import_run_spill",
+                          "Failed to create import run file %s. Error is %d: %s.",
+                          path, rc, slapd_system_strerror(rc));
+        return rc;
+    }
+    /* The file is only used through fd: remove it now so it never survives the import */
+    unlink(path);
+
+    import_run_sort_buffer(runs);
+    for (i = 0; i < runs->nbrecs; i++) {
+        ImportRunRec_t *rec = runs->recs[i];
+        if (fwrite(&rec->hdr, sizeof(rec->hdr), 1, fd) != 1 ||
+            (rec->hdr.datalen && fwrite(rec->data.mv_data, rec->hdr.datalen, 1, fd) != 1) ||
+            (rec->hdr.keylen && fwrite(rec->key.mv_data, rec->hdr.keylen, 1, fd) != 1)) {
+            rc = errno ? errno : EIO;
+            break;
+        }
+    }
+    if (!rc && fflush(fd)) {
+        rc = errno ? errno : EIO;
+    }
+    if (rc) {
+        import_log_notice(job, SLAPI_LOG_ERR, "import_run_spill",
+                          "Failed to write import run file %s. Error is %d: %s.",
+                          path, rc, slapd_system_strerror(rc));
+        fclose(fd);
+        return rc;
+    }
+    runs->fds = (FILE **)slapi_ch_realloc((char*)runs->fds, (runs->nbruns + 1) * sizeof(FILE *));
+    runs->fds[runs->nbruns++] = fd;
+    runs->nbrecs = 0;
+    runs->arenalen = 0;
+    return 0;
+}
+
+static int
+import_run_dbflags(ImportRuns_t *runs, MDB_txn *txn, dbmdb_dbi_t *dbi, unsigned int *flags)
+{
+    int rc = 0;
+
+    if (dbi->dbi >= runs->nbdbis) {
+        MDB_dbi nb = dbi->dbi + 1;
+        runs->dbis = (dbmdb_dbi_t **)slapi_ch_realloc((char*)runs->dbis, nb * sizeof(dbmdb_dbi_t *));
+        runs->dbflags = (unsigned int *)slapi_ch_realloc((char*)runs->dbflags, nb * sizeof(unsigned int));
+        memset(&runs->dbis[runs->nbdbis], 0, (nb - runs->nbdbis) * sizeof(dbmdb_dbi_t *));
+        memset(&runs->dbflags[runs->nbdbis], 0, (nb - runs->nbdbis) * sizeof(unsigned int));
+        runs->nbdbis = nb;
+    }
+    if (!runs->dbis[dbi->dbi]) {
+        rc = mdb_dbi_flags(txn, dbi->dbi, &runs->dbflags[dbi->dbi]);
+        if (rc) {
+            return rc;
+        }
+        runs->dbis[dbi->dbi] = dbi;
+    }
+    *flags = runs->dbflags[dbi->dbi];
+    return rc;
+}
+
+/* Write a record in id2entry, appending it if possible */
+static int
+import_run_put_id2entry(ImportRuns_t *runs, MDB_txn *txn, WriterQueueData_t *slot)
+{
+    MDB_val lastkey = { runs->lastidlen, runs->lastid };
+    int append = (slot->key.mv_size == sizeof(runs->lastid)) &&
+                 (!runs->lastidlen || mdb_cmp(txn, slot->dbi->dbi, &slot->key, &lastkey) > 0);
+    int rc = MDB_KEYEXIST;
+
+    if (append) {
+        rc = MDB_PUT(txn, slot->dbi->dbi, &slot->key, &slot->data, MDB_APPEND);
+        if (!rc) {
+            memcpy(runs->lastid, slot->key.mv_data, sizeof(runs->lastid));
+            runs->lastidlen = sizeof(runs->lastid);
+        }
+    }
+    if (rc == MDB_KEYEXIST) {
+        /* Out of order record or the dbi already contains greater keys */
+        rc = MDB_PUT(txn, slot->dbi->dbi, &slot->key, &slot->data, 0);
+    }
+    return rc;
+}
+
+/* Either write the record or add it to the in memory run */
+static int
+import_run_put(ImportRuns_t *runs, MDB_txn *txn, WriterQueueData_t *slot)
+{
+    ImportRunRec_t *rec = NULL;
+    unsigned int flags = 0;
+    size_t reclen = 0;
+    int rc = 0;
+
+    if (runs->ctx->id2entry && slot->dbi == runs->ctx->id2entry->dbi) {
+        return import_run_put_id2entry(runs, txn, slot);
+    }
+    rc = import_run_dbflags(runs, txn, slot->dbi, &flags);
+    if (rc) {
+        return rc;
+    }
+    reclen = sizeof(ImportRunRec_t) + slot->key.mv_size + slot->data.mv_size;
+    reclen += ALIGN_TO_LONG(reclen);
+    if (!(flags & MDB_DUPSORT) || reclen > runs->maxrec) {
+        return MDB_PUT(txn, slot->dbi->dbi, &slot->key, &slot->data, 0);
+    }
+
+    runs->txn = txn;
+    if (runs->arenalen + reclen > runs->arenasize) {
+        rc = import_run_spill(runs);
+        if (rc) {
+            return rc;
+        }
+    }
+    rec = (ImportRunRec_t *)(runs->arena + runs->arenalen);
+    rec->hdr.dbi = slot->dbi->dbi;
+    rec->hdr.keylen = slot->key.mv_size;
+    rec->hdr.datalen = slot->data.mv_size;
+    /* Data first to keep the MDB_INTEGERDUP values aligned */
+    rec->data.mv_size = slot->data.mv_size;
+    rec->data.mv_data = &rec[1];
+    memcpy(rec->data.mv_data, slot->data.mv_data, slot->data.mv_size);
+    rec->key.mv_size = slot->key.mv_size;
+    rec->key.mv_data = ((char *)&rec[1]) + slot->data.mv_size;
+    memcpy(rec->key.mv_data, slot->key.mv_data, slot->key.mv_size);
+    runs->arenalen += reclen;
+
+    if (runs->nbrecs >= runs->maxrecs) {
+        runs->maxrecs = runs->maxrecs ? 2 * runs->maxrecs : 1024;
+        runs->recs = (ImportRunRec_t **)slapi_ch_realloc((char*)runs->recs, runs->maxrecs * sizeof(ImportRunRec_t *));
+    }
+    runs->recs[runs->nbrecs++] = rec;
+    return 0;
+}
+
+/* Get the next record of a run. Returns 1 if there is one, 0 at the end of the run and -1 on error */
+static int
+import_run_next(ImportRunReader_t *r)
+{
+    ImportRunHdr_t *hdr = &r->filerec.hdr;
+    size_t len = 0;
+
+    if (!r->fd) {
+        if (r->idx >= r->nbrecs) {
+            return 0;
+        }
+        r->rec = r->recs[r->idx++];
+        return 1;
+    }
+    if (fread(hdr, sizeof(*hdr), 1, r->fd) != 1) {
+        return ferror(r->fd) ? -1 : 0;
+    }
+    len = hdr->keylen + hdr->datalen;
+    if (len > r->bufsize) {
+        r->buf = slapi_ch_realloc(r->buf, len);
+        r->bufsize = len;
+    }
+    if (len && fread(r->buf, len, 1, r->fd) != 1) {
+        return -1;
+    }
+    r->filerec.data.mv_size = hdr->datalen;
+    r->filerec.data.mv_data = r->buf;
+    r->filerec.key.mv_size = hdr->keylen;
+    r->filerec.key.mv_data = r->buf + hdr->datalen;
+    r->rec = &r->filerec;
+    return 1;
+}
+
+static void
+import_run_heap_down(ImportRuns_t *runs, ImportRunReader_t **heap, int nb, int i)
+{
+    for (;;) {
+        int min = i;
+        int left = 2 * i + 1;
+        int right = left + 1;
+        ImportRunReader_t *tmp = NULL;
+
+        if (left < nb && import_run_cmp(runs, heap[left]->rec, heap[min]->rec) < 0) {
+            min = left;
+        }
+        if (right < nb && import_run_cmp(runs, heap[right]->rec, heap[min]->rec) < 0) {
+            min = right;
+        }
+        if (min == i) {
+            return;
+        }
+        tmp = heap[i];
+        heap[i] = heap[min];
+        heap[min] = tmp;
+        i = min;
+    }
+}
+
+static void
+import_run_copy_rec(ImportRunRec_t *to, char **buf, size_t *bufsize, const ImportRunRec_t *from)
+{
+    size_t len = from->key.mv_size + from->data.mv_size;
+
+    if (len > *bufsize) {
+        *buf = slapi_ch_realloc(*buf, len);
+        *bufsize = len;
+    }
+    to->hdr = from->hdr;
+    to->data.mv_size = from->data.mv_size;
+    to->data.mv_data = *buf;
+    memcpy(to->data.mv_data, from->data.mv_data, from->data.mv_size);
+    to->key.mv_size = from->key.mv_size;
+    to->key.mv_data = *buf + from->data.mv_size;
+    memcpy(to->key.mv_data, from->key.mv_data, from->key.mv_size);
+}
+
+/*
+ * Merge the spilled runs and the in memory run and load the records in key order.
+ * *txn is the writer txn: it is committed every WRITER_MAX_OPS_IN_TXN records and
+ * the last one is left open for the caller.
+ */
+static int
+dbmdb_import_runs_load(ImportRuns_t *runs, MDB_txn **txn)
+{
+    ImportJob *job = runs->ctx->job;
+    int nbreaders = runs->nbruns + 1;
+    ImportRunReader_t *readers = (ImportRunReader_t *)slapi_ch_calloc(nbreaders, sizeof(ImportRunReader_t));
+    ImportRunReader_t **heap = (ImportRunReader_t **)slapi_ch_calloc(nbreaders, sizeof(ImportRunReader_t *));
+    ImportRunRec_t last = {0};
+    char *lastbuf = NULL;
+    size_t lastbufsize = 0;
+    size_t nbputs = 0;
+    int count = 0;
+    int nb = 0;
+    int rc = 0;
+    int i;
+
+    if (!*txn) {
+        rc = TXN_BEGIN(runs->ctx->ctx->env, NULL, 0, txn);
+    }
+    runs->txn = *txn;
+    if (!rc) {
+        import_run_sort_buffer(runs);
+        if (runs->nbruns) {
+            import_log_notice(job, SLAPI_LOG_INFO, "dbmdb_import_runs_load",
+                              "Merging %d import runs spilled to disk.", runs->nbruns);
+        }
+    }
+    for (i = 0; !rc && i < nbreaders; i++) {
+        if (i < runs->nbruns) {
+            readers[i].fd = runs->fds[i];
+            if (fseek(readers[i].fd, 0L, SEEK_SET)) {
+                rc = errno ? errno : EIO;
+                break;
+            }
+        } else {
+            readers[i].recs = runs->recs;
+            readers[i].nbrecs = runs->nbrecs;
+        }
+        switch (import_run_next(&readers[i])) {
+            case 1:
+                heap[nb++] = &readers[i];
+                break;
+            case 0:
+                break;
+            default:
+                rc = errno ? errno : EIO;
+                break;
+        }
+    }
+    for (i = nb / 2 - 1; i >= 0; i--) {
+        import_run_heap_down(runs, heap, nb, i);
+    }
+
+    while (!rc && nb > 0) {
+        ImportRunReader_t *r = heap[0];
+        ImportRunRec_t *rec = r->rec;
+
+        /* The same record may have been generated several times */
+        if (!last.key.mv_data || import_run_cmp(runs, &last, rec)) {
+            rc = MDB_PUT(*txn, rec->hdr.dbi, &rec->key, &rec->data, MDB_APPENDDUP);
+            if (rc == MDB_KEYEXIST) {
+                /* The dbi already contains greater records */
+                rc = MDB_PUT(*txn, rec->hdr.dbi, &rec->key, &rec->data, 0);
+            }
+            if (rc) {
+                slapi_log_err(SLAPI_LOG_ERR, "dbmdb_import_runs_load",
+                              "Failed to write record in dbi %s. Error is 0x%x: %s.\n",
+                              runs->dbis[rec->hdr.dbi]->dbname, rc, mdb_strerror(rc));
+                break;
+            }
+            import_run_copy_rec(&last, &lastbuf, &lastbufsize, rec);
+            nbputs++;
+            if (++count >= WRITER_MAX_OPS_IN_TXN) {
+                rc = TXN_COMMIT(*txn);
+                *txn = NULL;
+                if (!rc) {
+                    rc = TXN_BEGIN(runs->ctx->ctx->env, NULL, 0, txn);
+                }
+                if (rc) {
+                    slapi_log_err(SLAPI_LOG_ERR, "dbmdb_import_runs_load",
+                                  "Failed to renew the txn. Error is 0x%x: %s.\n",
+                                  rc, mdb_strerror(rc));
+                    break;
+                }
+                runs->txn = *txn;
+                count = 0;
+            }
+        }
+        switch (import_run_next(r)) {
+            case 1:
+                break;
+            case 0:
+                heap[0] = heap[--nb];
+                break;
+            default:
+                rc = errno ? errno : EIO;
+                slapi_log_err(SLAPI_LOG_ERR, "dbmdb_import_runs_load",
+                              "Failed to read import run. Error is %d: %s.\n",
+                              rc, slapd_system_strerror(rc));
+                break;
+        }
+        if (rc) {
+            break;
+        }
+        import_run_heap_down(runs, heap, nb, 0);
+    }
+    if (!rc) {
+        import_log_notice(job, SLAPI_LOG_INFO, "dbmdb_import_runs_load",
+                          "Loaded %lu index records from %d sorted runs.",
+                          (unsigned long)nbputs, nbreaders);
+    }
+    for (i = 0; i < nbreaders; i++) {
+        slapi_ch_free((void**)&readers[i].buf);
+    }
+    slapi_ch_free((void**)&readers);
+    slapi_ch_free((void**)&heap);
+    slapi_ch_free((void**)&lastbuf);
+    return rc;
+}
+
 /* writer thread */
 
 int
@@ -3942,7 +4571,11 @@ dbmdb_import_writer(void*param)
     int rc = 0;
     mdb_stat_info_t stats = {0};
     int stats_enabled = ctx->ctx->dsecfg.import_stats;
+    ImportRuns_t *runs = NULL;
 
+    if ((ctx->role == IM_IMPORT || ctx->role == IM_INDEX) && ctx->ctx->dsecfg.import_sorted_runs) {
+        runs = dbmdb_import_runs_new(ctx);
+    }
     MDB_STAT_INIT(stats, stats_enabled);
     while (!rc && !info_is_finished(info)) {
         MDB_STAT_STEP(stats, MDB_STAT_PAUSE, stats_enabled);
@@ -3970,7 +4603,11 @@ dbmdb_import_writer(void*param)
             }
             if (!rc) {
                 MDB_STAT_STEP(stats, MDB_STAT_WRITE, stats_enabled);
-                rc = MDB_PUT(txn, slot->dbi->dbi, &slot->key, &slot->data, 0);
+                if (runs) {
+                    rc = import_run_put(runs, txn, slot);
+                } else {
+                    rc = MDB_PUT(txn, slot->dbi->dbi, &slot->key, &slot->data, 0);
+                }
                 if (rc) {
                     slapi_log_err(SLAPI_LOG_ERR, "dbmdb_import_writer",
                                   "Failed to write record in dbi %s. Error is 0x%x: %s.\n",
@@ -4002,6 +4639,14 @@ dbmdb_import_writer(void*param)
             txn = NULL;
         }
     }
+    if (runs) {
+        if (!rc && !info_is_finished(info)) {
+            MDB_STAT_STEP(stats, MDB_STAT_WRITE, stats_enabled);
+            rc = dbmdb_import_runs_load(runs, &txn);
+            MDB_STAT_STEP(stats, MDB_STAT_RUN, stats_enabled);
+        }
+        dbmdb_import_runs_free(&runs);
+    }
     if (txn && !rc) {
         MDB_STAT_STEP(stats, MDB_STAT_TXNSTOP, stats_enabled);
         rc = TXN_COMMIT(txn);
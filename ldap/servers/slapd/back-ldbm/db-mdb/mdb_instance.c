@@ -736,6 +736,11 @@ int dbmdb_make_env(dbmdb_ctx_t *ctx, int readOnly, mdb_mode_t mode)
         dbmdb_set_is_env_open(true);
         rc = mdb_env_info(env, &envinfo);
     }
+    if (rc == 0 && !readOnly && ctx->startcfg.group_commit) {
+        /* The write txns are synced by dbmdb_group_sync_wait */
+        rc = mdb_env_set_flags(env, MDB_NOSYNC, 1);
+        ctx->group_commit.enabled = (rc == 0);
+    }
     if (rc ==0) { /* Update the INFO file with the real size provided by the db */
         dbmdb_cfg_t oldcfg = ctx->startcfg;
         ctx->startcfg.max_size = envinfo.me_mapsize;
@@ -751,6 +756,10 @@ int dbmdb_make_env(dbmdb_ctx_t *ctx, int readOnly, mdb_mode_t mode)
                   convert_bytes_to_str((double)(ctx->startcfg.max_size), size_buffer, 0));
     slapi_log_err(SLAPI_LOG_INFO, "dbmdb_make_env", "MDB environment created with max readers=%d\n", ctx->startcfg.max_readers);
     slapi_log_err(SLAPI_LOG_INFO, "dbmdb_make_env", "MDB environment created with max database instances=%d\n", ctx->startcfg.max_dbs);
+    if (ctx->group_commit.enabled) {
+        slapi_log_err(SLAPI_LOG_INFO, "dbmdb_make_env", "MDB environment created with group commit (batch size=%d, window=%d us)\n",
+                      ctx->dsecfg.group_commit_batch_size, ctx->dsecfg.group_commit_window);
+    }
 
     /* If some upgrade is needed based on libmdb version, then another test must be done here.
      *  and the new test should be based on infofileinfo.libversion
@@ -80,6 +80,8 @@ static int dbmdb_force_checkpoint(struct ldbminfo *li);
 #define FLUSH_REMOTEOFF 0
 
 static const char *backupfilelists[] = { INFOFILE, DBMAPFILE, DSE_INSTANCE, DSE_INDEX, NULL };
+/* Files that replace DBMAPFILE in compressed or incremental backups */
+static const char *backupmapfilelists[] = { DBMAPFILE_GZ, DBMAPFILE_DELTA, DBMAPFILE_PAGES, DBMAPFILE_BASE, NULL };
 
 /*
  * if ATTRINFO_DEBUG_DELAY > 0
@@ -638,7 +640,10 @@ dbmdb_txn_commit(struct ldbminfo *li, back_txn *txn, PRBool use_lock)
         if (!txn || (cur_txn && (cur_txn->back_txn_txn == db_txn))) {
             dblayer_pop_pvt_txn();
         }
+        /* With group commit, the wait for the sync is done by dbmdb_txn_sync */
+        dbmdb_group_sync_defer(1);
         return_value = END_TXN(&db_txn, 0);
+        dbmdb_group_sync_defer(0);
         return_value = dbmdb_map_error(__FUNCTION__, return_value);
         if (txn) {
             /* this handle is no longer value - set it to NULL */
@@ -661,6 +666,26 @@ dbmdb_txn_commit(struct ldbminfo *li, back_txn *txn, PRBool use_lock)
     return return_value;
 }
 
+/*
+ * Wait until the write txn committed by dbmdb_txn_commit is on disk.
+ * Called by dblayer once the backend lock is released.
+ */
+int
+dbmdb_txn_sync(struct ldbminfo *li __attribute__((unused)))
+{
+    int return_value = dbmdb_map_error(__FUNCTION__, dbmdb_group_sync_deferred());
+
+    if (0 != return_value) {
+        slapi_log_err(SLAPI_LOG_CRIT,
+                      "dbmdb_txn_sync", "Serious Error---Failed to sync the committed txn, err=%d (%s)\n",
+                      return_value, dblayer_strerror(return_value));
+        if (LDBM_OS_ERR_IS_DISKFULL(return_value)) {
+            operation_out_of_disk_space();
+        }
+    }
+    return return_value;
+}
+
 int
 dbmdb_txn_abort(struct ldbminfo *li, back_txn *txn, PRBool use_lock)
 {
@@ -963,7 +988,13 @@ dbmdb_backup(struct ldbminfo *li, char *dest_dir, Slapi_Task *task)
         goto error_out;
     }
     /* Copy the mdb database */
-    return_value = mdb_env_copy(conf->env, dest_dir);
+    if (li->li_backup_base || (li->li_backup_flags & SLAPI_BACKUP_FLAG_COMPRESS)) {
+        /* Stream the map and keep only the changed pages (or compress it) */
+        return_value = dbmdb_backup_stream(conf, dest_dir, li->li_backup_base,
+                                           li->li_backup_flags & SLAPI_BACKUP_FLAG_COMPRESS, task);
+    } else {
+        return_value = mdb_env_copy(conf->env, dest_dir);
+    }
     if (return_value) {
         slapi_log_err(SLAPI_LOG_ERR, "dbmdb_backup", "Failed to backup mdb database to %s.\n", dest_dir);
         if (task) {
@@ -1023,6 +1054,11 @@ error_out:
         unlink(pathname2);
         slapi_ch_free_string(&pathname2);
     }
+    for (pt=backupmapfilelists; *pt; pt++) {
+        pathname2 = slapi_ch_smprintf("%s/%s", dest_dir, *pt);
+        unlink(pathname2);
+        slapi_ch_free_string(&pathname2);
+    }
     rmdir(dest_dir);
     return_value = LDAP_UNWILLING_TO_PERFORM;
 bail:
@@ -1100,6 +1136,11 @@ dbmdb_restore(struct ldbminfo *li, char *src_dir, Slapi_Task *task)
     /* Check that all files are present and not empty */
     for (pt=backupfilelists; *pt; pt++) {
         pathname = slapi_ch_smprintf("%s/%s", src_dir, *pt);
+        if (stat(pathname, &sbuf) < 0 && strcmp(*pt, DBMAPFILE) == 0 && dbmdb_backup_has_image(src_dir)) {
+            /* The map is compressed or incremental */
+            slapi_ch_free_string(&pathname);
+            continue;
+        }
         if (stat(pathname, &sbuf) < 0 || sbuf.st_size == 0) {
             slapi_log_err(SLAPI_LOG_ERR, "dbmdb_restore",
                 "Backup directory %s does not contain a complete backup.\n", src_dir);
@@ -1131,8 +1172,15 @@ dbmdb_restore(struct ldbminfo *li, char *src_dir, Slapi_Task *task)
     dbmdb_delete_db(li);
 
     /* Copy db and info files */
-    if (dbmdb_restore_file(li, task, src_dir, DBMAPFILE) ||
-        dbmdb_restore_file(li, task, src_dir, INFOFILE)) {
+    pathname = slapi_ch_smprintf("%s/%s", src_dir, DBMAPFILE);
+    if (stat(pathname, &sbuf) == 0) {
+        return_value = dbmdb_restore_file(li, task, src_dir, DBMAPFILE);
+    } else {
+        /* Compressed or incremental backup */
+        return_value = dbmdb_restore_image(li, src_dir, task);
+    }
+    slapi_ch_free_string(&pathname);
+    if (return_value || dbmdb_restore_file(li, task, src_dir, INFOFILE)) {
         return_value = -1;
         goto error_out;
     }
@@ -2972,6 +3020,7 @@ dbmdb_public_delete_db(Slapi_Backend *be, dbi_db_t *db)
 IDList *
 dbmdb_idl_new_fetch(backend *be, dbi_db_t *db, dbi_val_t *inkey, dbi_txn_t *txn, struct attrinfo *a, int *flag_err, int allidslimit)
 {
+    struct ldbminfo *li = (struct ldbminfo *)be->be_database->plg_private;
     char *index_id = get_index_name(be, db, a);
     MDB_cursor *cursor = NULL;
     dbi_txn_t *s_txn = NULL;
@@ -3012,8 +3061,10 @@ dbmdb_idl_new_fetch(backend *be, dbi_db_t *db, dbi_val_t *inkey, dbi_txn_t *txn,
         goto error;
     }
 
-    /* Allocate an idlist to populate into */
-    if (count>0) {
+    /* Allocate an idlist to populate into, large lists are kept compressed */
+    if (li->li_idl_bitmap_threshold && count > (size_t)li->li_idl_bitmap_threshold) {
+        idl = idl_from_bitmap(idl_bitmap_new());
+    } else if (count>0) {
         idl = idl_alloc(count);
     } else {
         idl = idl_alloc(IDLIST_MIN_BLOCK_SIZE);
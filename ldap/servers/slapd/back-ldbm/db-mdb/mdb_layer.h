@@ -42,6 +42,13 @@
 #define CONFIG_MDB_MAX_READERS    "nsslapd-mdb-max-readers"
 #define CONFIG_MDB_MAX_DBS        "nsslapd-mdb-max-dbs"
 #define CONFIG_MDB_IMPORT_STATS   "nsslapd-mdb-import-stats"
+#define CONFIG_MDB_IMPORT_SORTED_RUNS "nsslapd-mdb-import-sorted-runs"
+#define CONFIG_MDB_IMPORT_RUN_SIZE "nsslapd-mdb-import-run-size"
+#define CONFIG_MDB_EXPORT_THREADS "nsslapd-mdb-export-threads"
+#define CONFIG_MDB_REINDEX_SHADOW "nsslapd-mdb-reindex-shadow"
+#define CONFIG_MDB_GROUP_COMMIT   "nsslapd-mdb-group-commit"
+#define CONFIG_MDB_GROUP_COMMIT_BATCH_SIZE "nsslapd-mdb-group-commit-batch-size"
+#define CONFIG_MDB_GROUP_COMMIT_WINDOW "nsslapd-mdb-group-commit-window"
 
 #define DBMDB_DB_MINSIZE             ( 4LL * MEGABYTE )
 #define DBMDB_DISK_RESERVE(disksize) ((disksize)*2ULL/1000ULL)
@@ -49,6 +56,9 @@
 #define DBMDB_READERS_DEFAULT        126  /* default value as described in mdb_env_set_maxreaders */
 #define DBMDB_DBS_MARGIN             10
 #define DBMDB_DBS_DEFAULT            128
+#define DBMDB_EXPORT_THREADS_MAX     64
+#define DBMDB_IMPORT_RUN_SIZE_MIN    ( 64 * 1024 )
+#define DBMDB_IMPORT_RUN_SIZE_MAX    ( 1024 * MEGABYTE )
 
 /* txn flags */
 #define TXNFL_DBI                    1
@@ -64,6 +74,10 @@
 #define DSE_INDEX           "dse_index.ldif"        /* dse file in backup */
 #define DBMAPFILE           "data.mdb"
 #define INFOFILE            "INFO.mdb"
+#define DBMAPFILE_GZ        "data.mdb.gz"           /* compressed map file in backup */
+#define DBMAPFILE_DELTA     "data.mdb.delta"        /* changed pages in incremental backup */
+#define DBMAPFILE_PAGES     "data.mdb.pages"        /* page checksums in backup */
+#define DBMAPFILE_BASE      "data.mdb.base"         /* base directory of incremental backup */
 #define DBNAMES             "__DBNAMES"
 #define CHANGELOG_PATTERN   "changelog"   /* pattern in changelog dbi name */
 #define RECNOCACHE_PREFIX   "~recno-cache/"
@@ -78,6 +92,13 @@ typedef struct
     int max_dbs;
     uint64_t max_size;
     int import_stats;
+    int import_sorted_runs;       /* Load the import index records from sorted runs */
+    int import_run_size;          /* Size in bytes of the in memory import run */
+    int export_threads;           /* Number of db2ldif formatting threads (0 means no pipeline) */
+    int reindex_shadow;           /* Online reindex builds the indexes aside then switch them over */
+    int group_commit;
+    int group_commit_batch_size;  /* Number of commits that triggers the sync */
+    int group_commit_window;      /* Max time (in microseconds) a commit waits for others */
 } dbmdb_cfg_t;
 
 /* config parameters limits */
@@ -158,6 +179,22 @@ typedef struct {
     cumuled_time_t lifetime;
 } dbmdb_perfctrs_txn_t;
 
+/*
+ * Group commit: the env is open with MDB_NOSYNC and the committed write txns
+ * are flushed to disk together by a single mdb_env_sync (see dbmdb_group_sync_wait)
+ */
+typedef struct {
+    int enabled;
+    pthread_mutex_t lock;
+    pthread_cond_t cv;
+    uint64_t committed;           /* Number of committed write txns */
+    uint64_t synced;              /* Write txns up to this number are on disk (or failed) */
+    uint64_t failed;              /* Write txns up to this number failed to sync */
+    int failed_rc;
+    int syncing;                  /* A thread is running mdb_env_sync */
+    uint64_t nbsyncs;             /* Number of mdb_env_sync calls */
+} dbmdb_group_commit_t;
+
 /* structure which holds our stuff */
 typedef struct dbmdb_ctx_t
 {
@@ -179,6 +216,7 @@ typedef struct dbmdb_ctx_t
     perfctrs_private *perf_private;  /* Performance counter data (shared memory) */
     dbmdb_perfctrs_txn_t perf_rotxn; /* Read Only Txn Performance counter */
     dbmdb_perfctrs_txn_t perf_rwtxn; /* Read Write Txn Performance counter */
+    dbmdb_group_commit_t group_commit; /* Group commit of the write txns */
 } dbmdb_ctx_t;
 
 /*
@@ -302,6 +340,7 @@ int dbmdb_cleanup(struct ldbminfo *li);
 int dbmdb_txn_begin(struct ldbminfo *li, back_txnid parent_txn, back_txn *txn, PRBool use_lock);
 int dbmdb_txn_commit(struct ldbminfo *li, back_txn *txn, PRBool use_lock);
 int dbmdb_txn_abort(struct ldbminfo *li, back_txn *txn, PRBool use_lock);
+int dbmdb_txn_sync(struct ldbminfo *li);
 int dbmdb_get_db(backend *be, char *indexname, int open_flag, struct attrinfo *ai, dbi_db_t **ppDB);
 int dbmdb_rm_db_file(backend *be, struct attrinfo *a, PRBool use_lock, int no_force_chkpt);
 int dbmdb_delete_db(struct ldbminfo *li);
@@ -382,6 +421,9 @@ int dbmdb_idl_new_compare_dups(dbmdb_dbi_t * db __attribute__((unused)), const M
 int dbmdb_delete_indices(ldbm_instance *inst);
 uint32_t dbmdb_get_optimal_block_size(struct ldbminfo *li);
 int dbmdb_copyfile(char *source, char *destination, int overwrite, int mode, Slapi_Task *task);
+int dbmdb_backup_stream(dbmdb_ctx_t *conf, const char *dest_dir, const char *base_dir, int compress, Slapi_Task *task);
+int dbmdb_backup_has_image(const char *dir);
+int dbmdb_restore_image(struct ldbminfo *li, const char *src_dir, Slapi_Task *task);
 int dbmdb_delete_instance_dir(backend *be);
 uint64_t dbmdb_database_size(struct ldbminfo *li);
 
@@ -512,6 +554,10 @@ void shutdown_mdbtxn(void);
 int dbmdb_start_txn(const char *funcname, dbi_txn_t *parent_txn, int flags, dbi_txn_t **txn);
 int dbmdb_end_txn(const char *funcname, int rc, dbi_txn_t **txn);
 void init_mdbtxn(dbmdb_ctx_t *ctx);
+void dbmdb_group_commit_init(dbmdb_ctx_t *ctx);
+void dbmdb_group_sync_defer(int defer);
+int dbmdb_group_sync_deferred(void);
+uint64_t dbmdb_group_sync_count(dbmdb_ctx_t *ctx);
 MDB_txn *dbmdb_txn(dbi_txn_t *txn);
 int dbmdb_is_read_only_txn_thread(void);
 int dbmdb_has_a_txn(void);
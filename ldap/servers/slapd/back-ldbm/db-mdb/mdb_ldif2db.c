@@ -19,6 +19,7 @@
 
 #include "mdb_import.h"
 #include "../vlv_srch.h"
+#include "zlib.h"
 
 #define DB2INDEX_ANCESTORID 0x1   /* index ancestorid */
 #define DB2INDEX_ENTRYRDN 0x2     /* index entryrdn */
@@ -38,6 +39,8 @@ typedef struct _export_args
     NIDS idindex;
     ID lastid;
     int fd;
+    gzFile gzfd;                       /* Set when exporting to a .gz file */
+    struct export_pipeline *pipeline;  /* Set when formatting entries in parallel */
     Slapi_Task *task;
     char **include_suffix;
     char **exclude_suffix;
@@ -411,56 +414,79 @@ dbmdb_fetch_subtrees(backend *be, char **include, int *err)
         }
     } /* for (i = 0; include[i]; i++) */
 
+    /* the callers walk b_ids */
+    idl_expand(&idltotal);
     return idltotal;
 }
 
 
+/* Write a chunk of the ldif file (either directly or through the gzip stream) */
 static int
-dbmdb_export_one_entry(struct ldbminfo *li,
-                 ldbm_instance *inst,
-                 export_args *expargs)
+dbmdb_export_write(export_args *expargs, const char *buf, size_t len)
+{
+    if (len == 0) {
+        return 0;
+    }
+    if (expargs->gzfd) {
+        return (gzwrite(expargs->gzfd, buf, len) <= 0) ? -1 : 0;
+    }
+    return (write(expargs->fd, buf, len) < 0) ? -1 : 0;
+}
+
+/*
+ * Filter, decrypt and convert an entry to its ldif form.
+ * *ldif is left NULL if the entry must not be exported.
+ * Does not use expargs fields that changes while exporting, so it may be
+ * called by the export pipeline worker threads.
+ */
+static void
+dbmdb_export_format_entry(struct ldbminfo *li,
+                          ldbm_instance *inst,
+                          export_args *expargs,
+                          struct backentry *ep,
+                          char **ldif,
+                          int *len)
 {
     backend *be = inst->inst_be;
     int rc = 0;
-    int wrc = 0;
     Slapi_Attr *this_attr = NULL, *next_attr = NULL;
     char *type = NULL;
-    MDB_val data = {0};
-    int len = 0;
+    char *str = NULL;
 
-    if (!dbmdb_back_ok_to_dump(backentry_get_ndn(expargs->ep),
+    *ldif = NULL;
+    *len = 0;
+    if (!dbmdb_back_ok_to_dump(backentry_get_ndn(ep),
                               expargs->include_suffix,
                               expargs->exclude_suffix)) {
-        goto bail; /* go to next loop */
+        return;
     }
     if (!(expargs->options & SLAPI_DUMP_STATEINFO) &&
-        slapi_entry_flag_is_set(expargs->ep->ep_entry,
+        slapi_entry_flag_is_set(ep->ep_entry,
                                 SLAPI_ENTRY_FLAG_TOMBSTONE)) {
         /* We only dump the tombstones if the user needs to create
          * a replica from the ldif */
-        goto bail; /* go to next loop */
+        return;
     }
-    (*expargs->cnt)++;
 
     /* do not output attributes that are in the "exclude" list */
     /* Also, decrypt any encrypted attributes, if we're asked to */
-    rc = slapi_entry_first_attr(expargs->ep->ep_entry, &this_attr);
+    rc = slapi_entry_first_attr(ep->ep_entry, &this_attr);
     while (0 == rc) {
         int dump_uniqueid = (expargs->options & SLAPI_DUMP_UNIQUEID) ? 1 : 0;
-        rc = slapi_entry_next_attr(expargs->ep->ep_entry,
+        rc = slapi_entry_next_attr(ep->ep_entry,
                                    this_attr, &next_attr);
         slapi_attr_get_type(this_attr, &type);
         if (dbmdb_ldbm_exclude_attr_from_export(li, type, dump_uniqueid)) {
-            slapi_entry_delete_values(expargs->ep->ep_entry, type, NULL);
+            slapi_entry_delete_values(ep->ep_entry, type, NULL);
         }
         this_attr = next_attr;
     }
     if (expargs->decrypt) {
         /* Decrypt in place */
-        rc = attrcrypt_decrypt_entry(be, expargs->ep);
+        rc = attrcrypt_decrypt_entry(be, ep);
         if (rc) {
             slapi_log_err(SLAPI_LOG_ERR, "dbmdb_export_one_entry", "Failed to decrypt entry [%s] : %d\n",
-                          slapi_sdn_get_dn(&expargs->ep->ep_entry->e_sdn), rc);
+                          slapi_sdn_get_dn(&ep->ep_entry->e_sdn), rc);
         }
     }
     /*
@@ -468,7 +494,7 @@ dbmdb_export_one_entry(struct ldbminfo *li,
      * If it is not, put "{CLEAR}" in front of the password value.
      */
     {
-        char *pw = slapi_entry_attr_get_charptr(expargs->ep->ep_entry,
+        char *pw = slapi_entry_attr_get_charptr(ep->ep_entry,
                                                 "userpassword");
         if (pw && !slapi_is_encoded(pw)) {
             /* clear password does not have {CLEAR} storage scheme */
@@ -478,48 +504,57 @@ dbmdb_export_one_entry(struct ldbminfo *li,
             val.bv_len = strlen(val.bv_val);
             vals[0] = &val;
             vals[1] = NULL;
-            rc = slapi_entry_attr_replace(expargs->ep->ep_entry,
+            rc = slapi_entry_attr_replace(ep->ep_entry,
                                           "userpassword", vals);
             if (rc) {
                 slapi_log_err(SLAPI_LOG_ERR,
                               "dbmdb_export_one_entry", "%s: Failed to add clear password storage scheme: %d\n",
-                              slapi_sdn_get_dn(&expargs->ep->ep_entry->e_sdn), rc);
+                              slapi_sdn_get_dn(&ep->ep_entry->e_sdn), rc);
             }
             slapi_ch_free_string(&val.bv_val);
         }
         slapi_ch_free_string(&pw);
     }
-    data.mv_data = slapi_entry2str_with_options(expargs->ep->ep_entry,
-                                                &len, expargs->options);
-    data.mv_size = len + 1;
+    str = slapi_entry2str_with_options(ep->ep_entry, len, expargs->options);
+    if (str && (expargs->printkey & EXPORT_PRINTKEY)) {
+        *ldif = slapi_ch_smprintf("# entry-id: %lu\n%s", (u_long)ep->ep_id, str);
+        *len = strlen(*ldif);
+        slapi_ch_free_string(&str);
+    } else {
+        *ldif = str;
+    }
+}
 
-    if (expargs->printkey & EXPORT_PRINTKEY) {
-        char idstr[32];
+/* Write an entry formatted by dbmdb_export_format_entry and log the progress */
+static int
+dbmdb_export_write_entry(ldbm_instance *inst,
+                         export_args *expargs,
+                         ID id,
+                         NIDS idindex,
+                         const char *ldif,
+                         int len)
+{
+    int wrc = 0;
 
-        sprintf(idstr, "# entry-id: %lu\n", (u_long)expargs->ep->ep_id);
-        wrc = write(expargs->fd, idstr, strlen(idstr));
-        if (wrc < 0) {
-            goto bail;
-        }
+    if (!ldif) {
+        return 0;
     }
-    wrc = write(expargs->fd, data.mv_data, len);
-    if (wrc < 0) {
-        goto bail;
+    (*expargs->cnt)++;
+    wrc = dbmdb_export_write(expargs, ldif, len);
+    if (!wrc) {
+        wrc = dbmdb_export_write(expargs, "\n", 1);
     }
-    wrc = write(expargs->fd, "\n", 1);
     if (wrc < 0) {
-        goto bail;
+        slapi_log_err(SLAPI_LOG_INFO, "dbmdb_export_one_entry", "export %s: Failed to write in export file. errno=%d\n", inst->inst_name, errno);
+        return wrc;
     }
-    slapi_ch_free(&data.mv_data);
-    data.mv_size = 0;
-    rc = 0;
     if ((*expargs->cnt) % 1000 == 0) {
         int percent;
 
         if (expargs->idl) {
-            percent = (expargs->idindex * 100 / expargs->idl->b_nids);
+            percent = (idindex * 100 / expargs->idl->b_nids);
         } else {
-            percent = (expargs->ep->ep_id * 100 / expargs->lastid);
+            percent = (id * 100 / expargs->lastid);
         }
         if (expargs->task) {
             slapi_task_log_status(expargs->task,
@@ -533,11 +568,270 @@ dbmdb_export_one_entry(struct ldbminfo *li,
                       inst->inst_name, *expargs->cnt, percent);
         *expargs->lastcnt = *expargs->cnt;
     }
-bail:
-    if (wrc < 0) {
-        slapi_log_err(SLAPI_LOG_INFO, "dbmdb_export_one_entry", "export %s: Failed to write in export file. errno=%d\n", inst->inst_name, errno);
-        rc = wrc;
+    return 0;
+}
+
+/*
+ * Export pipeline (used when nsslapd-mdb-export-threads is not 0)
+ *
+ * The db2ldif thread keeps on reading id2entry and building the entries
+ * (that must be done in order because the parents may have to be exported
+ * first) but hands them over to the pipeline instead of formatting them.
+ * The worker threads filter, decrypt and convert the entries to ldif
+ * and the writer thread writes them in the order they were submitted.
+ */
+#define EXPORT_PIPELINE_ITEMS_PER_THREAD 64
+
+typedef struct export_item
+{
+    struct export_item *next;
+    struct backentry *ep;
+    ID id;
+    NIDS idindex;
+    char *ldif;       /* Formatted entry (NULL if the entry is skipped) */
+    int len;
+    int done;         /* The worker has formatted the entry */
+} ExportItem_t;
+
+typedef struct export_pipeline
+{
+    struct ldbminfo *li;
+    ldbm_instance *inst;
+    export_args *eargs;
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cv;    /* Workers wait for entries to format */
+    pthread_cond_t done_cv;    /* Writer waits for the first entry to be formatted */
+    pthread_cond_t room_cv;    /* Submitter waits for room in the queue */
+    ExportItem_t *head;        /* Items in submission order */
+    ExportItem_t *tail;
+    ExportItem_t *todo;        /* First item not yet taken by a worker */
+    int nbitems;
+    int maxitems;
+    int stop;
+    int rc;                    /* First write error */
+    int nbworkers;
+    PRThread **workers;
+    PRThread *writer;
+} ExportPipeline_t;
+
+static void
+dbmdb_export_worker(void *param)
+{
+    ExportPipeline_t *pl = param;
+    ExportItem_t *item = NULL;
+    int failed = 0;
+
+    slapi_set_thread_name("export-worker");
+    pthread_mutex_lock(&pl->mutex);
+    for (;;) {
+        while (!pl->todo && !pl->stop) {
+            pthread_cond_wait(&pl->work_cv, &pl->mutex);
+        }
+        item = pl->todo;
+        if (!item) {
+            break;
+        }
+        pl->todo = item->next;
+        failed = pl->rc;
+        pthread_mutex_unlock(&pl->mutex);
+
+        if (!failed) {
+            dbmdb_export_format_entry(pl->li, pl->inst, pl->eargs, item->ep, &item->ldif, &item->len);
+        }
+        backentry_free(&item->ep);
+
+        pthread_mutex_lock(&pl->mutex);
+        item->done = 1;
+        if (item == pl->head) {
+            pthread_cond_signal(&pl->done_cv);
+        }
+    }
+    pthread_mutex_unlock(&pl->mutex);
+}
+
+static void
+dbmdb_export_writer(void *param)
+{
+    ExportPipeline_t *pl = param;
+    ExportItem_t *item = NULL;
+    int rc = 0;
+
+    slapi_set_thread_name("export-writer");
+    pthread_mutex_lock(&pl->mutex);
+    for (;;) {
+        while (!(pl->head && pl->head->done) && !(pl->stop && !pl->head)) {
+            pthread_cond_wait(&pl->done_cv, &pl->mutex);
+        }
+        item = pl->head;
+        if (!item) {
+            break;
+        }
+        pl->head = item->next;
+        if (!pl->head) {
+            pl->tail = NULL;
+        }
+        pl->nbitems--;
+        pthread_cond_signal(&pl->room_cv);
+        pthread_mutex_unlock(&pl->mutex);
+
+        if (!rc) {
+            /* After a failure, the remaining entries are just discarded */
+            rc = dbmdb_export_write_entry(pl->inst, pl->eargs, item->id, item->idindex,
+                                          item->ldif, item->len);
+        }
+        slapi_ch_free_string(&item->ldif);
+        slapi_ch_free((void **)&item);
+
+        pthread_mutex_lock(&pl->mutex);
+        if (rc && !pl->rc) {
+            pl->rc = rc;
+        }
+    }
+    pthread_mutex_unlock(&pl->mutex);
+}
+
+static ExportPipeline_t *
+dbmdb_export_pipeline_start(struct ldbminfo *li, ldbm_instance *inst, export_args *eargs, int nbworkers)
+{
+    ExportPipeline_t *pl = (ExportPipeline_t *)slapi_ch_calloc(1, sizeof(ExportPipeline_t));
+    int i;
+
+    pl->li = li;
+    pl->inst = inst;
+    pl->eargs = eargs;
+    pl->maxitems = nbworkers * EXPORT_PIPELINE_ITEMS_PER_THREAD;
+    pthread_mutex_init(&pl->mutex, NULL);
+    pthread_cond_init(&pl->work_cv, NULL);
+    pthread_cond_init(&pl->done_cv, NULL);
+    pthread_cond_init(&pl->room_cv, NULL);
+    pl->workers = (PRThread **)slapi_ch_calloc(nbworkers, sizeof(PRThread *));
+
+    pl->writer = PR_CreateThread(PR_USER_THREAD, (VFP)dbmdb_export_writer, pl,
+                                 PR_PRIORITY_NORMAL, PR_GLOBAL_THREAD, PR_JOINABLE_THREAD,
+                                 SLAPD_DEFAULT_THREAD_STACKSIZE);
+    for (i = 0; pl->writer && i < nbworkers; i++) {
+        pl->workers[i] = PR_CreateThread(PR_USER_THREAD, (VFP)dbmdb_export_worker, pl,
+                                         PR_PRIORITY_NORMAL, PR_GLOBAL_THREAD, PR_JOINABLE_THREAD,
+                                         SLAPD_DEFAULT_THREAD_STACKSIZE);
+        if (!pl->workers[i]) {
+            break;
+        }
+        pl->nbworkers++;
+    }
+    if (!pl->writer || !pl->nbworkers) {
+        slapi_log_err(SLAPI_LOG_ERR, "dbmdb_export_pipeline_start",
+                      "export %s: PR_CreateThread failed. " SLAPI_COMPONENT_NAME_NSPR " error %d (%s). "
+                      "Exporting without worker threads.\n",
+                      inst->inst_name, PR_GetError(), slapd_pr_strerror(PR_GetError()));
+        pthread_mutex_lock(&pl->mutex);
+        pl->stop = 1;
+        pthread_cond_broadcast(&pl->done_cv);
+        pthread_mutex_unlock(&pl->mutex);
+        if (pl->writer) {
+            (void)PR_JoinThread(pl->writer);
+        }
+        pthread_mutex_destroy(&pl->mutex);
+        pthread_cond_destroy(&pl->work_cv);
+        pthread_cond_destroy(&pl->done_cv);
+        pthread_cond_destroy(&pl->room_cv);
+        slapi_ch_free((void **)&pl->workers);
+        slapi_ch_free((void **)&pl);
+        return NULL;
+    }
+    slapi_log_err(SLAPI_LOG_INFO, "dbmdb_export_pipeline_start",
+                  "export %s: Formatting entries with %d threads.\n",
+                  inst->inst_name, pl->nbworkers);
+    return pl;
+}
+
+/* Wait until all the submitted entries are written then release the pipeline */
+static int
+dbmdb_export_pipeline_stop(ExportPipeline_t **ppl)
+{
+    ExportPipeline_t *pl = *ppl;
+    int rc = 0;
+    int i;
+
+    if (!pl) {
+        return 0;
+    }
+    pthread_mutex_lock(&pl->mutex);
+    pl->stop = 1;
+    pthread_cond_broadcast(&pl->work_cv);
+    pthread_cond_broadcast(&pl->done_cv);
+    pthread_mutex_unlock(&pl->mutex);
+    for (i = 0; i < pl->nbworkers; i++) {
+        (void)PR_JoinThread(pl->workers[i]);
+    }
+    (void)PR_JoinThread(pl->writer);
+    rc = pl->rc;
+    pthread_mutex_destroy(&pl->mutex);
+    pthread_cond_destroy(&pl->work_cv);
+    pthread_cond_destroy(&pl->done_cv);
+    pthread_cond_destroy(&pl->room_cv);
+    slapi_ch_free((void **)&pl->workers);
+    slapi_ch_free((void **)ppl);
+    return rc;
+}
+
+/* Queue expargs->ep (the pipeline takes the ownership of the entry) */
+static int
+dbmdb_export_pipeline_submit(ExportPipeline_t *pl, export_args *expargs)
+{
+    ExportItem_t *item = (ExportItem_t *)slapi_ch_calloc(1, sizeof(ExportItem_t));
+    int rc = 0;
+
+    item->ep = expargs->ep;
+    item->id = expargs->ep->ep_id;
+    item->idindex = expargs->idindex;
+    expargs->ep = NULL;
+
+    pthread_mutex_lock(&pl->mutex);
+    while (pl->nbitems >= pl->maxitems && !pl->rc) {
+        pthread_cond_wait(&pl->room_cv, &pl->mutex);
+    }
+    rc = pl->rc;
+    if (rc) {
+        pthread_mutex_unlock(&pl->mutex);
+        backentry_free(&item->ep);
+        slapi_ch_free((void **)&item);
+        return rc;
     }
+    if (pl->tail) {
+        pl->tail->next = item;
+    } else {
+        pl->head = item;
+    }
+    pl->tail = item;
+    if (!pl->todo) {
+        pl->todo = item;
+    }
+    pl->nbitems++;
+    pthread_cond_signal(&pl->work_cv);
+    pthread_mutex_unlock(&pl->mutex);
+    return 0;
+}
+
+/*
+ * Export expargs->ep. When the export pipeline is used, the entry is
+ * handed over to it and expargs->ep is set to NULL, so callers must free
+ * expargs->ep rather than their own reference.
+ */
+static int
+dbmdb_export_one_entry(struct ldbminfo *li,
+                 ldbm_instance *inst,
+                 export_args *expargs)
+{
+    char *ldif = NULL;
+    int len = 0;
+    int rc = 0;
+
+    if (expargs->pipeline) {
+        return dbmdb_export_pipeline_submit(expargs->pipeline, expargs);
+    }
+    dbmdb_export_format_entry(li, inst, expargs, expargs->ep, &ldif, &len);
+    rc = dbmdb_export_write_entry(inst, expargs, expargs->ep->ep_id, expargs->idindex, ldif, len);
+    slapi_ch_free_string(&ldif);
     return rc;
 }
 
@@ -594,7 +888,10 @@ dbmdb_db2ldif(Slapi_PBlock *pb)
     int32_t skip_ruv = 0;
     dbmdb_cursor_t cur = {0};
     uint size = 0;
+    char *ldif = NULL;
+    size_t ldif_size = 0;
     int wrc = 0;
+    size_t fname_len = 0;
     int return_orig_dn = config_get_return_orig_dn();
 
     slapi_log_err(SLAPI_LOG_TRACE, "dbmdb_db2ldif", "=>\n");
@@ -744,9 +1041,23 @@ dbmdb_db2ldif(Slapi_PBlock *pb)
             return_value = -1;
             goto bye;
         }
+        fname_len = strlen(fname);
+        if (fname_len > 3 && strcasecmp(fname + fname_len - 3, ".gz") == 0) {
+            /* Compress the ldif on the fly (gzclose will close fd) */
+            eargs.gzfd = gzdopen(fd, "wb");
+            if (eargs.gzfd == NULL) {
+                slapi_task_log_notice(task, "Backend %s: can't compress %s", inst->inst_name, fname);
+                slapi_log_err(SLAPI_LOG_ERR, "dbmdb_db2ldif",
+                              "db2ldif: %s: can't compress %s\n", inst->inst_name, fname);
+                we_start_the_backends = 0;
+                return_value = -1;
+                goto bye;
+            }
+        }
     } else { /* '-' */
         fd = STDOUT_FILENO;
     }
+    eargs.fd = fd;
 
     if (we_start_the_backends) {
         if (0 != dbmdb_start(li, DBLAYER_EXPORT_MODE)) {
@@ -852,7 +1163,7 @@ dbmdb_db2ldif(Slapi_PBlock *pb)
                  */
 
         sprintf(vstr, "version: %d\n\n", myversion);
-        wrc = write(fd, vstr, strlen(vstr));
+        wrc = dbmdb_export_write(&eargs, vstr, strlen(vstr));
         if (wrc < 0) {
             goto bye;
         } else {
@@ -865,10 +1176,12 @@ dbmdb_db2ldif(Slapi_PBlock *pb)
     eargs.printkey = printkey;
     eargs.idl = idl;
     eargs.lastid = lastid;
-    eargs.fd = fd;
     eargs.task = task;
     eargs.include_suffix = include_suffix;
     eargs.exclude_suffix = exclude_suffix;
+    if (keepgoing && MDB_CONFIG(li)->dsecfg.export_threads > 0) {
+        eargs.pipeline = dbmdb_export_pipeline_start(li, inst, &eargs, MDB_CONFIG(li)->dsecfg.export_threads);
+    }
 
     while (keepgoing) {
         /*
@@ -921,6 +1234,9 @@ dbmdb_db2ldif(Slapi_PBlock *pb)
                     eargs.cnt = &cnt;
                     eargs.lastcnt = &lastcnt;
                     wrc = dbmdb_export_one_entry(li, inst, &eargs);
+                    /* eargs.ep is NULL if the entry was handed over to the export pipeline */
+                    pending_ruv = eargs.ep;
+                    eargs.ep = NULL;
                     backentry_free(&pending_ruv);
                     if (wrc) {
                         break;
@@ -943,9 +1259,18 @@ dbmdb_db2ldif(Slapi_PBlock *pb)
         }
 
         /* call post-entry plugin */
+        size = data.mv_size;
         plugin_call_entryfetch_plugins((char **)&data.mv_data, &size);
         data.mv_size = size;
 
+        /* binary id2entry records are exported from their LDIF form */
+        slapi_ch_free_string(&ldif);
+        ldif = id2entry_data2str(data.mv_data, data.mv_size, &ldif_size);
+        if (ldif) {
+            data.mv_data = ldif;
+            data.mv_size = ldif_size;
+        }
+
         ep = backentry_alloc();
         char *rdn = NULL;
 
@@ -1122,6 +1447,8 @@ dbmdb_db2ldif(Slapi_PBlock *pb)
         eargs.cnt = &cnt;
         eargs.lastcnt = &lastcnt;
         rc = dbmdb_export_one_entry(li, inst, &eargs);
+        ep = eargs.ep;
+        eargs.ep = NULL;
         backentry_free(&ep);
         if (rc && !return_value) {
             return_value = rc;
@@ -1131,6 +1458,12 @@ dbmdb_db2ldif(Slapi_PBlock *pb)
     if (return_value == MDB_NOTFOUND)
         return_value = 0;
 
+    /* Wait until the queued entries are written */
+    rc = dbmdb_export_pipeline_stop(&eargs.pipeline);
+    if (rc && !return_value) {
+        return_value = rc;
+    }
+
     /* done cycling thru entries to write */
     if (lastcnt != cnt) {
         if (task) {
@@ -1152,14 +1485,20 @@ dbmdb_db2ldif(Slapi_PBlock *pb)
     }
 
 bye:
+    (void)dbmdb_export_pipeline_stop(&eargs.pipeline);
     if (idl) {
         idl_free(&idl);
     }
+    slapi_ch_free_string(&ldif);
     dbmdb_close_cursor(&cur, 1);
 
     dblayer_release_id2entry(be, db);
 
-    if (fd > STDERR_FILENO) {
+    if (eargs.gzfd) {
+        if (gzclose(eargs.gzfd) != Z_OK && !wrc) {
+            wrc = -1;
+        }
+    } else if (fd > STDERR_FILENO) {
         close(fd);
     }
     if (wrc) {
@@ -1351,6 +1690,8 @@ _get_and_add_parent_rdns(backend *be,
     struct backentry *ep = NULL;
     char *rdn = NULL;
     MDB_val key, data;
+    char *ldif = NULL;
+    size_t ldif_size = 0;
     char *pid_str = NULL;
     ID storedid;
     ID temp_pid = NOID;
@@ -1413,6 +1754,12 @@ _get_and_add_parent_rdns(backend *be,
                           "Failed to position cursor at ID " ID_FMT "\n", id);
             goto bail;
         }
+        /* binary id2entry records are processed in their LDIF form */
+        ldif = id2entry_data2str(data.mv_data, data.mv_size, &ldif_size);
+        if (ldif) {
+            data.mv_data = ldif;
+            data.mv_size = ldif_size;
+        }
         /* rdn is allocated in get_value_from_string */
         rc = get_value_from_string((const char *)data.mv_data, "rdn", &rdn);
         if (rc) {
@@ -1495,10 +1842,13 @@ _get_and_add_parent_rdns(backend *be,
         }
         eargs->ep = ep;
         rc = dbmdb_export_one_entry(li, inst, eargs);
+        /* eargs->ep is NULL if the entry was handed over to the export pipeline */
+        ep = eargs->ep;
+        eargs->ep = NULL;
         if (rc) {
             slapi_log_err(SLAPI_LOG_ERR, "_get_and_add_parent_rdns",
-                          "Failed to export an entry %s\n",
-                          slapi_sdn_get_dn(slapi_entry_get_sdn(ep->ep_entry)));
+                          "Failed to export an entry (rdn: %s, ID: %d)\n",
+                          rdn, id);
             goto bail;
         }
         rc = idl_append_extend(&(eargs->pre_exported_idl), id);
@@ -1511,6 +1861,7 @@ _get_and_add_parent_rdns(backend *be,
 bail:
     backentry_free(&ep);
     slapi_rdn_done(&mysrdn);
+    slapi_ch_free_string(&ldif);
     slapi_ch_free_string(&rdn);
     return rc;
 }
@@ -315,6 +315,8 @@ dbmdb_dbmonitor_search(Slapi_PBlock *pb __attribute__((unused)),
     MSET("grantTimeRWtxn");
     PR_snprintf(buf, sizeof(buf), "%lu", ctx->perf_rwtxn.lifetime.ns/ctx->perf_rwtxn.lifetime.nbsamples);
     MSET("lifeTimeRWtxn");
+    PR_snprintf(buf, sizeof(buf), "%lu", dbmdb_group_sync_count(ctx));
+    MSET("groupCommitSyncs");
 
     PR_snprintf(buf, sizeof(buf), "%lu", ctx->perf_rotxn.nbwaiting);
     MSET("waitingROtxn");
@@ -30,7 +30,14 @@ typedef struct dbmdb_txn_t {
 } dbmdb_txn_t;
 
 
+/* Per thread group commit state (see dbmdb_group_sync_defer) */
+typedef struct {
+    int defer;                    /* dbmdb_end_txn must not wait for the sync */
+    uint64_t ticket;              /* Committed txn still to wait for, 0 if none */
+} dbmdb_group_sync_tls_t;
+
 static PRUintn thread_private_mdb_txn_stack;
+static PRUintn thread_private_mdb_group_sync;
 static dbmdb_ctx_t *g_ctx;  /* Global dbmdb context */
 
 static void
@@ -55,11 +62,19 @@ cleanup_mdbtxn_stack(void *arg)
     }
 }
 
+static void
+cleanup_group_sync(void *arg)
+{
+    dbmdb_group_sync_tls_t *tls = (dbmdb_group_sync_tls_t *)arg;
+    slapi_ch_free((void**)&tls);
+}
+
 void
 init_mdbtxn(dbmdb_ctx_t *ctx)
 {
     g_ctx = ctx;
     PR_NewThreadPrivateIndex(&thread_private_mdb_txn_stack, cleanup_mdbtxn_stack);
+    PR_NewThreadPrivateIndex(&thread_private_mdb_group_sync, cleanup_group_sync);
 }
 
 static dbmdb_txn_t **get_mdbtxnanchor(void)
@@ -207,6 +222,156 @@ int dbmdb_start_txn(const char *funcname, dbi_txn_t *parent_txn, int flags, dbi_
     return rc;
 }
 
+/*
+ * Group commit
+ *
+ * When nsslapd-mdb-group-commit is on, the env is open with MDB_NOSYNC so
+ * that committing a write txn only releases the LMDB writer lock, and
+ * dbmdb_end_txn() then waits here until its txn is on disk before
+ * returning. The first waiting thread becomes the leader: it waits for up
+ * to nsslapd-mdb-group-commit-window microseconds, or until
+ * nsslapd-mdb-group-commit-batch-size txns are waiting, then flushes all
+ * the txns committed so far with a single mdb_env_sync and releases their
+ * threads together. So the operations are still only acknowledged once
+ * they are durable, but concurrent ones share the cost of the fsyncs.
+ *
+ * Note: the LMDB write txn itself cannot be shared between the threads
+ * (a write txn belongs to the thread that began it), so each operation
+ * keeps its own txn and its own abort semantics.
+ */
+void
+dbmdb_group_commit_init(dbmdb_ctx_t *ctx)
+{
+    dbmdb_group_commit_t *gc = &ctx->group_commit;
+    pthread_condattr_t condAttr;
+
+    pthread_mutex_init(&gc->lock, NULL);
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&gc->cv, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+}
+
+static dbmdb_group_sync_tls_t *
+dbmdb_group_sync_tls(void)
+{
+    dbmdb_group_sync_tls_t *tls = (dbmdb_group_sync_tls_t *)PR_GetThreadPrivate(thread_private_mdb_group_sync);
+    if (!tls) {
+        tls = (dbmdb_group_sync_tls_t *)slapi_ch_calloc(1, sizeof(dbmdb_group_sync_tls_t));
+        PR_SetThreadPrivate(thread_private_mdb_group_sync, tls);
+    }
+    return tls;
+}
+
+/* Register a committed write txn, returns the number to wait for */
+static uint64_t
+dbmdb_group_sync_enter(dbmdb_ctx_t *ctx)
+{
+    dbmdb_group_commit_t *gc = &ctx->group_commit;
+    uint64_t mytxn;
+
+    pthread_mutex_lock(&gc->lock);
+    mytxn = ++gc->committed;
+    if (gc->committed - gc->synced >= ctx->dsecfg.group_commit_batch_size) {
+        /* Batch is full: wake up the leader */
+        pthread_cond_broadcast(&gc->cv);
+    }
+    pthread_mutex_unlock(&gc->lock);
+    return mytxn;
+}
+
+/* Wait until the write txn 'mytxn' is on disk */
+static int
+dbmdb_group_sync_wait(dbmdb_ctx_t *ctx, uint64_t mytxn)
+{
+    dbmdb_group_commit_t *gc = &ctx->group_commit;
+    uint64_t batch_size = ctx->dsecfg.group_commit_batch_size;
+    int rc = 0;
+
+    pthread_mutex_lock(&gc->lock);
+    while (gc->synced < mytxn) {
+        if (gc->syncing) {
+            /* The leader is syncing (maybe not including our txn) */
+            pthread_cond_wait(&gc->cv, &gc->lock);
+        } else {
+            /* We are the leader: let the batch fill up, then sync it */
+            struct timespec deadline = {0};
+            uint64_t target;
+
+            clock_gettime(CLOCK_MONOTONIC, &deadline);
+            deadline.tv_nsec += (long)ctx->dsecfg.group_commit_window * 1000;
+            deadline.tv_sec += deadline.tv_nsec / 1000000000;
+            deadline.tv_nsec %= 1000000000;
+            while (!gc->syncing && gc->committed - gc->synced < batch_size &&
+                   pthread_cond_timedwait(&gc->cv, &gc->lock, &deadline) == 0) {
+            }
+            if (gc->syncing || gc->synced >= mytxn) {
+                /* Someone else took the lead meanwhile */
+                continue;
+            }
+            target = gc->committed;
+            gc->syncing = 1;
+            pthread_mutex_unlock(&gc->lock);
+
+            rc = mdb_env_sync(ctx->env, 1);
+
+            pthread_mutex_lock(&gc->lock);
+            if (rc) {
+                slapi_log_err(SLAPI_LOG_ERR, "dbmdb_group_sync_wait",
+                              "Failed to sync the committed txns. err=%d %s\n", rc, mdb_strerror(rc));
+                gc->failed = target;
+                gc->failed_rc = rc;
+            }
+            gc->synced = target;
+            gc->syncing = 0;
+            gc->nbsyncs++;
+            pthread_cond_broadcast(&gc->cv);
+        }
+    }
+    rc = (mytxn <= gc->failed) ? gc->failed_rc : 0;
+    pthread_mutex_unlock(&gc->lock);
+
+    return rc;
+}
+
+/*
+ * dblayer_txn_commit() commits while holding the backend serial lock, so
+ * waiting for the sync there would keep the other operations of the backend
+ * out of the batch. While 'defer' is set, dbmdb_end_txn() only registers
+ * the committed txn and dbmdb_group_sync_deferred() waits for it once the
+ * caller has released its locks.
+ */
+void
+dbmdb_group_sync_defer(int defer)
+{
+    dbmdb_group_sync_tls()->defer = defer;
+}
+
+int
+dbmdb_group_sync_deferred(void)
+{
+    dbmdb_group_sync_tls_t *tls = dbmdb_group_sync_tls();
+    uint64_t mytxn = tls->ticket;
+
+    if (mytxn == 0) {
+        return 0;
+    }
+    tls->ticket = 0;
+    return dbmdb_group_sync_wait(g_ctx, mytxn);
+}
+
+uint64_t
+dbmdb_group_sync_count(dbmdb_ctx_t *ctx)
+{
+    dbmdb_group_commit_t *gc = &ctx->group_commit;
+    uint64_t nbsyncs;
+
+    pthread_mutex_lock(&gc->lock);
+    nbsyncs = gc->nbsyncs;
+    pthread_mutex_unlock(&gc->lock);
+    return nbsyncs;
+}
+
 int dbmdb_end_txn(const char *funcname, int rc, dbi_txn_t **txn)
 {
     dbmdb_txn_t *ltxn = (dbmdb_txn_t*)*txn;
@@ -224,6 +389,15 @@ int dbmdb_end_txn(const char *funcname, int rc, dbi_txn_t **txn)
             TXN_ABORT(ltxn->txn);
         } else {
             rc = TXN_COMMIT(ltxn->txn);
+            if (rc == 0 && ltxn->parent == NULL && g_ctx->group_commit.enabled) {
+                dbmdb_group_sync_tls_t *tls = dbmdb_group_sync_tls();
+                uint64_t mytxn = dbmdb_group_sync_enter(g_ctx);
+                if (tls->defer) {
+                    tls->ticket = mytxn;
+                } else {
+                    rc = dbmdb_group_sync_wait(g_ctx, mytxn);
+                }
+            }
         }
         GET_HRTIME(&hr_time_now);
         slapi_timespec_diff(&hr_time_now, &ltxn->hr_time_start, &hr_elapsed);
@@ -784,6 +784,25 @@ dblayer_txn_begin(backend *be, back_txnid parent_txn, back_txn *txn)
 }
 
 
+/*
+ * Some db layers (lmdb group commit) do not wait for the commit to be on
+ * disk in dblayer_txn_commit_fn but in dblayer_txn_sync_fn, so that the
+ * caller can release its locks before waiting.
+ */
+static int
+dblayer_txn_sync(struct ldbminfo *li, int rc)
+{
+    dblayer_private *priv = (dblayer_private *)li->li_dblayer_private;
+
+    if (priv->dblayer_txn_sync_fn) {
+        int sync_rc = priv->dblayer_txn_sync_fn(li);
+        if (rc == 0) {
+            rc = sync_rc;
+        }
+    }
+    return rc;
+}
+
 int
 dblayer_txn_commit_ext(struct ldbminfo *li, back_txn *txn, PRBool use_lock)
 {
@@ -793,7 +812,7 @@ dblayer_txn_commit_ext(struct ldbminfo *li, back_txn *txn, PRBool use_lock)
     priv = (dblayer_private *)li->li_dblayer_private;
     PR_ASSERT(NULL != priv);
 
-    return priv->dblayer_txn_commit_fn(li, txn, use_lock);
+    return dblayer_txn_sync(li, priv->dblayer_txn_commit_fn(li, txn, use_lock));
 }
 
 int
@@ -814,10 +833,13 @@ dblayer_txn_commit(backend *be, back_txn *txn)
         }
         rc = dblayer_txn_commit_ext(li, txn, PR_TRUE);
     } else {
-        rc = dblayer_txn_commit_ext(li, txn, PR_TRUE);
+        dblayer_private *priv = (dblayer_private *)li->li_dblayer_private;
+        rc = priv->dblayer_txn_commit_fn(li, txn, PR_TRUE);
         if (SERIALLOCK(li)) {
             dblayer_unlock_backend(be);
         }
+        /* Wait for the commit to be durable without holding the backend lock */
+        rc = dblayer_txn_sync(li, rc);
     }
     return rc;
 }
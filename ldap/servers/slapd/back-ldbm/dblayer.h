@@ -75,6 +75,7 @@ typedef int dblayer_restore_fn_t(struct ldbminfo *li, char *src_dir, Slapi_Task
 typedef int dblayer_txn_begin_fn_t(struct ldbminfo *li, back_txnid parent_txn, back_txn *txn, PRBool use_lock);
 typedef int dblayer_txn_commit_fn_t(struct ldbminfo *li, back_txn *txn, PRBool use_lock);
 typedef int dblayer_txn_abort_fn_t(struct ldbminfo *li, back_txn *txn, PRBool use_lock);
+typedef int dblayer_txn_sync_fn_t(struct ldbminfo *li);
 typedef int dblayer_get_info_fn_t(Slapi_Backend *be, int cmd, void **info);
 typedef int dblayer_set_info_fn_t(Slapi_Backend *be, int cmd, void **info);
 typedef int dblayer_back_ctrl_fn_t(Slapi_Backend *be, int cmd, void *info);
@@ -158,6 +159,7 @@ struct dblayer_private
     dblayer_txn_begin_fn_t *dblayer_txn_begin_fn;
     dblayer_txn_commit_fn_t *dblayer_txn_commit_fn;
     dblayer_txn_abort_fn_t *dblayer_txn_abort_fn;
+    dblayer_txn_sync_fn_t *dblayer_txn_sync_fn; /* optional: wait until the commit is durable */
     dblayer_get_info_fn_t *dblayer_get_info_fn;
     dblayer_set_info_fn_t *dblayer_set_info_fn;
     dblayer_back_ctrl_fn_t *dblayer_back_ctrl_fn;
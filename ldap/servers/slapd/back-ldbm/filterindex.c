@@ -554,7 +554,7 @@ extensible_candidates(
 
                                 strncpy(key_str, key[0]->bv_val, lenght_str);
                                 key_str[lenght_str] = '\0';
-                                slapi_log_err(SLAPI_LOG_FILTER, "extensible_candidates", "=> idl (%s) = (%d)\n", key_str, idl3->b_ids[0]);
+                                slapi_log_err(SLAPI_LOG_FILTER, "extensible_candidates", "=> idl (%s) = (%d)\n", key_str, idl_firstid(idl3));
                             }
                             if (unindexed) {
                                 int pr_idx = -1;
@@ -725,6 +725,199 @@ filter_is_subtype(Slapi_Filter *f)
     return issubtype;
 }
 
+/*
+ * Filter planner
+ * --------------
+ *
+ * The components of an AND are otherwise read from the indexes in filter
+ * order (slapi_filter_optimise only moves some filter types ahead of the
+ * others). With nsslapd-filter-planner on, list_candidates first asks the
+ * indexes how many ids each component would return (index_read_estimate)
+ * and then:
+ *
+ * - reads the components from the most to the least selective one, so that
+ *   the FILTER_TEST_THRESHOLD shortcut triggers as early as possible,
+ * - does not read a component at all when its estimate is more than
+ *   FILTER_PLAN_SKIP_RATIO times the smallest idl read so far: checking it
+ *   with the filter test on the few candidates left is cheaper.
+ *
+ * Components that can't be estimated keep their relative order after the
+ * estimated ones, and are always read. The estimates, and what was done
+ * with each component, are logged with the LDAP_STAT_READ_INDEX stats.
+ */
+struct filter_plan_step
+{
+    Slapi_Filter *f;
+    int64_t estimate; /* -1 when unknown */
+    size_t pos;       /* position in the filter, to keep the sort stable */
+};
+
+/*
+ * Estimate the number of candidates of a filter from its index keys, or
+ * return -1 if that can't be done cheaply.
+ */
+static int64_t
+filter_estimate(backend *be, Slapi_Filter *f, back_txn *txn)
+{
+    int64_t estimate = -1;
+    size_t count = 0;
+    char *type = NULL;
+    struct berval *bval = NULL;
+    Slapi_Filter *sub = NULL;
+
+    if (f->f_flags & (SLAPI_FILTER_INVALID_ATTR_WARN | SLAPI_FILTER_INVALID_ATTR_UNDEFINE)) {
+        return -1;
+    }
+
+    switch (slapi_filter_get_choice(f)) {
+    case LDAP_FILTER_EQUALITY: {
+        Slapi_Attr sattr;
+        Slapi_Value sv;
+        Slapi_Value **ivals = NULL;
+
+        if (slapi_filter_get_ava(f, &type, &bval) != 0) {
+            break;
+        }
+        slapi_attr_init(&sattr, type);
+        slapi_value_init_berval(&sv, bval);
+        slapi_attr_assertion2keys_ava_sv(&sattr, &sv, &ivals, LDAP_FILTER_EQUALITY);
+        value_done(&sv);
+        /* keys2idl intersects the ids of the keys, keep the smallest */
+        for (size_t i = 0; ivals && ivals[i]; i++) {
+            if (index_read_estimate(be, type, indextype_EQUALITY, slapi_value_get_berval(ivals[i]), txn, &count) == 0 &&
+                (estimate < 0 || (int64_t)count < estimate)) {
+                estimate = (int64_t)count;
+            }
+        }
+        valuearray_free(&ivals);
+        attr_done(&sattr);
+        break;
+    }
+    case LDAP_FILTER_PRESENT:
+        if (slapi_filter_get_type(f, &type) == 0 &&
+            index_read_estimate(be, type, indextype_PRESENCE, NULL, txn, &count) == 0) {
+            estimate = (int64_t)count;
+        }
+        break;
+    case LDAP_FILTER_OR:
+        estimate = 0;
+        for (sub = slapi_filter_list_first(f); sub != NULL; sub = slapi_filter_list_next(f, sub)) {
+            int64_t sub_estimate = filter_estimate(be, sub, txn);
+            if (sub_estimate < 0) {
+                return -1;
+            }
+            estimate += sub_estimate;
+        }
+        break;
+    case LDAP_FILTER_AND:
+        for (sub = slapi_filter_list_first(f); sub != NULL; sub = slapi_filter_list_next(f, sub)) {
+            int64_t sub_estimate = filter_estimate(be, sub, txn);
+            if (sub_estimate >= 0 && (estimate < 0 || sub_estimate < estimate)) {
+                estimate = sub_estimate;
+            }
+        }
+        break;
+    default:
+        break;
+    }
+    return estimate;
+}
+
+static int
+filter_plan_step_cmp(const void *a, const void *b)
+{
+    const struct filter_plan_step *sa = (const struct filter_plan_step *)a;
+    const struct filter_plan_step *sb = (const struct filter_plan_step *)b;
+
+    if (sa->estimate != sb->estimate) {
+        if (sa->estimate < 0) {
+            return 1;
+        }
+        if (sb->estimate < 0) {
+            return -1;
+        }
+        return (sa->estimate < sb->estimate) ? -1 : 1;
+    }
+    return (sa->pos < sb->pos) ? -1 : (sa->pos > sb->pos);
+}
+
+/*
+ * Order the components of an AND filter on their estimates. Returns NULL
+ * when there is nothing to plan: fewer than two components, or none of
+ * them could be estimated.
+ */
+static struct filter_plan_step *
+filter_plan_and(Slapi_PBlock *pb, backend *be, Slapi_Filter *flist, size_t *plan_count)
+{
+    struct filter_plan_step *plan = NULL;
+    back_txn txn = {NULL};
+    Slapi_Filter *f = NULL;
+    size_t count = 0;
+    size_t estimated = 0;
+
+    for (f = slapi_filter_list_first(flist); f != NULL; f = slapi_filter_list_next(flist, f)) {
+        count++;
+    }
+    if (count < 2) {
+        return NULL;
+    }
+
+    slapi_pblock_get(pb, SLAPI_TXN, &txn.back_txn_txn);
+    plan = (struct filter_plan_step *)slapi_ch_calloc(count, sizeof(struct filter_plan_step));
+    count = 0;
+    for (f = slapi_filter_list_first(flist); f != NULL; f = slapi_filter_list_next(flist, f)) {
+        plan[count].f = f;
+        plan[count].pos = count;
+        /* NOT components are subtracted, their size does not matter */
+        plan[count].estimate = (LDAP_FILTER_NOT == slapi_filter_get_choice(f)) ? -1 : filter_estimate(be, f, &txn);
+        if (plan[count].estimate >= 0) {
+            estimated++;
+        }
+        count++;
+    }
+    if (estimated == 0) {
+        slapi_ch_free((void **)&plan);
+        return NULL;
+    }
+    qsort(plan, count, sizeof(struct filter_plan_step), filter_plan_step_cmp);
+    *plan_count = count;
+    return plan;
+}
+
+/* Iterate over the components of flist, in the planned order if there is a plan */
+static Slapi_Filter *
+filter_plan_next(struct filter_plan_step *plan, size_t plan_count, size_t *plan_i, Slapi_Filter *flist, Slapi_Filter *f)
+{
+    if (plan == NULL) {
+        return f ? slapi_filter_list_next(flist, f) : slapi_filter_list_first(flist);
+    }
+    if (f != NULL) {
+        (*plan_i)++;
+    }
+    return (*plan_i < plan_count) ? plan[*plan_i].f : NULL;
+}
+
+/* Record the estimate of a planned component, and its actual size or that it was skipped */
+static void
+filter_plan_stat(Op_stat *op_stat, struct filter_plan_step *step, int32_t skipped, NIDS count, struct timespec *start)
+{
+    struct component_keys_lookup *key_stat;
+    char buf[BUFSIZ];
+
+    if ((op_stat == NULL) || (op_stat->search_stat == NULL)) {
+        return;
+    }
+    key_stat = (struct component_keys_lookup *)slapi_ch_calloc(1, sizeof(struct component_keys_lookup));
+    clock_gettime(CLOCK_MONOTONIC, &(key_stat->key_lookup_end));
+    key_stat->key_lookup_start = start ? *start : key_stat->key_lookup_end;
+    key_stat->filter = slapi_ch_strdup(slapi_filter_to_string(step->f, buf, sizeof(buf)));
+    key_stat->estimate = step->estimate;
+    key_stat->skipped = skipped;
+    key_stat->id_lookup_cnt = (int)count;
+    key_stat->next = op_stat->search_stat->keys_lookup;
+    op_stat->search_stat->keys_lookup = key_stat;
+}
+
 static IDList *
 list_candidates(
     Slapi_PBlock *pb,
@@ -749,6 +942,11 @@ list_candidates(
     int is_and = 0;
     IDListSet *idl_set = NULL;
     back_search_result_set *sr = NULL;
+    struct ldbminfo *li = (struct ldbminfo *)be->be_database->plg_private;
+    struct filter_plan_step *plan = NULL;
+    size_t plan_count = 0;
+    size_t plan_i = 0;
+    Op_stat *op_stat = NULL;
 
     slapi_pblock_get(pb, SLAPI_SEARCH_RESULT_SET, &sr);
 
@@ -847,11 +1045,18 @@ list_candidates(
     if (ftype == LDAP_FILTER_OR || ftype == LDAP_FILTER_AND) {
         idl_set = idl_set_create();
     }
+    if (ftype == LDAP_FILTER_AND && li->li_filter_planner && sr != NULL) {
+        plan = filter_plan_and(pb, be, flist, &plan_count);
+        if (plan && (LDAP_STAT_READ_INDEX & config_get_statlog_level())) {
+            op_stat = op_stat_get_operation_extension(pb);
+        }
+    }
 
     idl = NULL;
     nextf = NULL;
-    for (f_head = f = slapi_filter_list_first(flist); f != NULL;
-         f = slapi_filter_list_next(flist, f)) {
+    for (f_head = f = filter_plan_next(plan, plan_count, &plan_i, flist, NULL); f != NULL;
+         f = filter_plan_next(plan, plan_count, &plan_i, flist, f)) {
+        struct timespec plan_start = {0};
 
         /* Look for NOT foo type filter elements where foo is simple equality */
         isnot = (LDAP_FILTER_NOT == slapi_filter_get_choice(f)) &&
@@ -887,6 +1092,20 @@ list_candidates(
                                      LDAP_FILTER_EQUALITY, nextf, range, err, allidslimit);
             }
         } else {
+            int64_t min_nids = plan ? idl_set_minimum_size(idl_set) : -1;
+
+            if (min_nids >= 0 && plan[plan_i].estimate > min_nids * FILTER_PLAN_SKIP_RATIO) {
+                /* Leave this one to the filter test, see filter_plan_and */
+                slapi_log_err(SLAPI_LOG_FILTER, "list_candidates",
+                              "Planner skips a component of %" PRId64 " estimated ids, smallest idl has %" PRId64 " ids\n",
+                              plan[plan_i].estimate, min_nids);
+                filter_plan_stat(op_stat, &plan[plan_i], 1, 0, NULL);
+                sr->sr_flags |= SR_FLAG_MUST_APPLY_FILTER_TEST;
+                continue;
+            }
+            if (op_stat) {
+                clock_gettime(CLOCK_MONOTONIC, &plan_start);
+            }
             if (fpairs[0] == f) {
                 continue;
             } else if (fpairs[1] == f) {
@@ -921,6 +1140,9 @@ list_candidates(
         if (tmp == NULL) {
             tmp = idl_alloc(0);
         }
+        if (op_stat && plan[plan_i].estimate >= 0) {
+            filter_plan_stat(op_stat, &plan[plan_i], 0, IDL_NIDS(tmp), &plan_start);
+        }
 
         /*
          * At this point we have the idl set from the subfilter. In idl_set,
@@ -983,6 +1205,7 @@ apply_set_op:
     slapi_log_err(SLAPI_LOG_TRACE, "list_candidates", "<= idl len %lu\n", (u_long)IDL_NIDS(idl));
 out:
     idl_set_destroy(idl_set);
+    slapi_ch_free((void **)&plan);
     if (is_and) {
         /*
          * Sets IS_AND back to 0 only when this function set 1.
@@ -999,6 +1222,112 @@ out:
     return (idl);
 }
 
+/* Offset of a relative positional key "abc#+1" in its component, -1 if it is not one */
+static long
+substring_key_rel_offset(Slapi_Value *key, size_t gramlen)
+{
+    const struct berval *bv = slapi_value_get_berval(key);
+
+    if (bv->bv_len < gramlen + 3 ||
+        bv->bv_val[gramlen] != INDEX_SUBSTRPOS_SEP || bv->bv_val[gramlen + 1] != INDEX_SUBSTRPOS_REL) {
+        return -1;
+    }
+    return strtol(bv->bv_val + gramlen + 2, NULL, 10);
+}
+
+/*
+ * Candidates of the n relative keys of a component: the union over the
+ * alignments r of the component in the value of the intersection of the
+ * keys "abc#<(r + i) mod positions>" of its grams.
+ */
+static IDList *
+substring_component_idl(Slapi_PBlock *pb, backend *be, char *type, Slapi_Value **keys, size_t n, size_t gramlen, int positions, int *err, int *unindexed, back_txn *txn, int allidslimit)
+{
+    IDListSet *idl_set = idl_set_create();
+    IDList *idl = NULL;
+
+    for (int r = 0; r < positions; r++) {
+        Slapi_Value **aligned = (Slapi_Value **)slapi_ch_calloc(n + 1, sizeof(Slapi_Value *));
+
+        for (size_t i = 0; i < n; i++) {
+            long offset = substring_key_rel_offset(keys[i], gramlen);
+            char *key = slapi_ch_smprintf("%.*s%c%x", (int)gramlen, slapi_value_get_string(keys[i]),
+                                          INDEX_SUBSTRPOS_SEP, (int)((r + offset) % positions));
+            aligned[i] = slapi_value_new_string_passin(key);
+        }
+        idl = keys2idl(pb, be, type, indextype_SUB, aligned, err, unindexed, txn, allidslimit);
+        valuearray_free(&aligned);
+        if (idl == NULL || *err) {
+            idl_free(&idl);
+            break;
+        }
+        idl_set_insert_idl(idl_set, idl);
+    }
+    idl = idl_set_union(idl_set, be);
+    idl_set_destroy(idl_set);
+
+    return idl;
+}
+
+/*
+ * Candidates of the keys of a substring index with nsSubStrPositions, see
+ * slap.h for the keys. The keys whose offset is known (the begin and end
+ * keys, the keys of the initial component) are read as they are. The
+ * relative keys of an any or final component are grouped, a component
+ * starts again at offset 0, and only the entries that have the grams of the
+ * component at consecutive offsets are kept.
+ */
+static IDList *
+substring_positional_keys2idl(
+    Slapi_PBlock *pb,
+    backend *be,
+    char *type,
+    struct attrinfo *ai,
+    Slapi_Value **ivals,
+    int *err,
+    int *unindexed,
+    back_txn *txn,
+    int allidslimit)
+{
+    int positions = ai->ai_substr_lens[INDEX_SUBSTRPOSITIONS];
+    /* the syntax plugin has set the default length if it was not configured */
+    size_t gramlen = (size_t)ai->ai_substr_lens[INDEX_SUBSTRMIDDLE];
+    size_t nkeys = (size_t)valuearray_count(ivals);
+    Slapi_Value **fixed = (Slapi_Value **)slapi_ch_calloc(nkeys + 1, sizeof(Slapi_Value *));
+    IDListSet *idl_set = idl_set_create();
+    IDList *idl = NULL;
+    size_t nfixed = 0;
+    size_t i = 0;
+
+    while (i < nkeys && *err == 0) {
+        size_t first = i;
+
+        if (substring_key_rel_offset(ivals[i], gramlen) < 0) {
+            fixed[nfixed++] = ivals[i++];
+            continue;
+        }
+        for (i++; i < nkeys && substring_key_rel_offset(ivals[i], gramlen) > 0; i++)
+            ; /* NULL */
+        idl = substring_component_idl(pb, be, type, ivals + first, i - first, gramlen, positions,
+                                      err, unindexed, txn, allidslimit);
+        idl_set_insert_idl(idl_set, idl);
+    }
+    if (nfixed > 0 && *err == 0) {
+        idl = keys2idl(pb, be, type, indextype_SUB, fixed, err, unindexed, txn, allidslimit);
+        if (idl == NULL) {
+            idl = idl_alloc(0);
+        }
+        idl_set_insert_idl(idl_set, idl);
+    }
+    /* the values belong to ivals */
+    slapi_ch_free((void **)&fixed);
+
+    idl = idl_set_intersect(idl_set, be);
+    idl_set_destroy(idl_set);
+
+    return idl;
+}
+
 static IDList *
 substring_candidates(
     Slapi_PBlock *pb,
@@ -1062,7 +1391,11 @@ substring_candidates(
         idl = idl_alloc(0);
     } else {
         slapi_pblock_get(pb, SLAPI_TXN, &txn.back_txn_txn);
-        idl = keys2idl(pb, be, type, indextype_SUB, ivals, err, &unindexed, &txn, allidslimit);
+        if (ai->ai_substr_lens && ai->ai_substr_lens[INDEX_SUBSTRPOSITIONS] > 0) {
+            idl = substring_positional_keys2idl(pb, be, type, ai, ivals, err, &unindexed, &txn, allidslimit);
+        } else {
+            idl = keys2idl(pb, be, type, indextype_SUB, ivals, err, &unindexed, &txn, allidslimit);
+        }
     }
     if (unindexed) {
         Operation *pb_op;
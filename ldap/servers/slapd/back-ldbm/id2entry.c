@@ -30,7 +30,8 @@ id2entry_add_ext(backend *be, struct backentry *e, back_txn *txn, int encrypt, i
     dbi_txn_t *db_txn = NULL;
     dbi_val_t data = {0};
     dbi_val_t key = {0};
-    int len, rc;
+    size_t dsize = 0;
+    int rc;
     char temp_id[sizeof(ID)];
     struct backentry *encrypted_entry = NULL;
     char *entrydn = NULL;
@@ -64,7 +65,6 @@ id2entry_add_ext(backend *be, struct backentry *e, back_txn *txn, int encrypt, i
     }
 
     {
-        int options = SLAPI_DUMP_STATEINFO | SLAPI_DUMP_UNIQUEID;
         Slapi_Entry *entry_to_use = encrypted_entry ? encrypted_entry->ep_entry : e->ep_entry;
         memset(&data, 0, sizeof(data));
         entrydn = slapi_entry_get_dn(entry_to_use);
@@ -75,7 +75,6 @@ id2entry_add_ext(backend *be, struct backentry *e, back_txn *txn, int encrypt, i
         Slapi_DN *sdn =
             slapi_sdn_dup(slapi_entry_get_sdn_const(entry_to_use));
         struct backdn *bdn = backdn_init(sdn, e->ep_id, 0);
-        options |= SLAPI_DUMP_RDN_ENTRY;
 
         /* If the ID already exists in the DN cache && the DNs do not match,
          * replace it. */
@@ -97,8 +96,8 @@ id2entry_add_ext(backend *be, struct backentry *e, back_txn *txn, int encrypt, i
                       "id2entry_add_ext", "(dncache) ( %lu, \"%s\" )\n",
                       (u_long)e->ep_id, slapi_entry_get_dn_const(entry_to_use));
 
-        data.dptr = slapi_entry2str_with_options(entry_to_use, &len, options);
-        data.dsize = len + 1;
+        data.dptr = id2entry_entry2data(be, entry_to_use, &dsize);
+        data.dsize = dsize;
     }
 
     if (NULL != txn) {
@@ -338,10 +337,17 @@ id2entry(backend *be, ID id, back_txn *txn, int *err)
 
     char *rdn = NULL;
     int rc = 0;
+    int binary = entrybin_is_binary(data.dptr, data.dsize);
 
     /* rdn is allocated in get_value_from_string */
-    rc = get_value_from_string((const char *)data.dptr, "rdn", &rdn);
-    if (rc) {
+    if (binary) {
+        rc = entrybin_get_value(data.dptr, data.dsize, "rdn", &rdn);
+    } else {
+        rc = get_value_from_string((const char *)data.dptr, "rdn", &rdn);
+    }
+    if (rc && binary) {
+        ee = NULL;
+    } else if (rc) {
         /* data.dptr may not include rdn: ..., try "dn: ..." */
         ee = slapi_str2entry(data.dptr, SLAPI_STR2ENTRY_NO_ENTRYDN);
     } else {
@@ -356,7 +362,8 @@ id2entry(backend *be, ID id, back_txn *txn, int *err)
         } else {
             Slapi_DN *sdn = NULL;
             if (config_get_return_orig_dn() &&
-                !get_value_from_string((const char *)data.dptr, SLAPI_ATTR_DS_ENTRYDN, &normdn))
+                !(binary ? entrybin_get_value(data.dptr, data.dsize, SLAPI_ATTR_DS_ENTRYDN, &normdn)
+                         : get_value_from_string((const char *)data.dptr, SLAPI_ATTR_DS_ENTRYDN, &normdn)))
             {
                 srdn = slapi_rdn_new_all_dn(normdn);
             } else {
@@ -391,8 +398,13 @@ id2entry(backend *be, ID id, back_txn *txn, int *err)
                               normdn, id);
             }
         }
-        ee = slapi_str2entry_ext((const char *)normdn, (const Slapi_RDN *)srdn, data.dptr,
-                                 SLAPI_STR2ENTRY_NO_ENTRYDN);
+        if (binary) {
+            ee = bin2entry((const char *)normdn, (const Slapi_RDN *)srdn, data.dptr, data.dsize,
+                           SLAPI_STR2ENTRY_NO_ENTRYDN);
+        } else {
+            ee = slapi_str2entry_ext((const char *)normdn, (const Slapi_RDN *)srdn, data.dptr,
+                                     SLAPI_STR2ENTRY_NO_ENTRYDN);
+        }
         slapi_ch_free_string(&rdn);
         slapi_ch_free_string(&normdn);
         slapi_rdn_free(&srdn);
@@ -463,9 +475,14 @@ id2entry(backend *be, ID id, back_txn *txn, int *err)
                           backentry_get_ndn(e));
         }
     } else {
-        slapi_log_err(SLAPI_LOG_ERR, ID2ENTRY,
-                      "str2entry returned NULL for id %lu, string=\"%s\"\n",
-                      (u_long)id, (char *)data.data);
+        if (binary) {
+            slapi_log_err(SLAPI_LOG_ERR, ID2ENTRY,
+                          "bin2entry returned NULL for id %lu\n", (u_long)id);
+        } else {
+            slapi_log_err(SLAPI_LOG_ERR, ID2ENTRY,
+                          "str2entry returned NULL for id %lu, string=\"%s\"\n",
+                          (u_long)id, (char *)data.data);
+        }
         e = NULL;
     }
 
@@ -477,3 +494,51 @@ bail:
                   "<= id2entry( %lu ) %p (disk)\n", (u_long)id, e);
     return (e);
 }
+
+/*
+ * Flatten an entry the way it is stored in id2entry: in the binary entry
+ * format if nsslapd-id2entry-binary-format is on, as "rdn: ..." LDIF with
+ * the state information otherwise.  Records already stored keep their
+ * format until the entry is written again, and id2entry() reads both.
+ * The returned buffer must be freed with slapi_ch_free.
+ */
+char *
+id2entry_entry2data(backend *be, Slapi_Entry *e, size_t *size)
+{
+    ldbm_instance *inst = (ldbm_instance *)be->be_instance_info;
+    char *data = NULL;
+    int len = 0;
+
+    if (inst->inst_li->li_id2entry_binary) {
+        return entry2bin(e, size);
+    }
+    data = slapi_entry2str_with_options(e, &len,
+                                        SLAPI_DUMP_STATEINFO | SLAPI_DUMP_UNIQUEID | SLAPI_DUMP_RDN_ENTRY);
+    *size = len + 1;
+    return data;
+}
+
+/*
+ * The offline readers of id2entry (export, reindex, upgradedn) work on the
+ * LDIF form of the record.  If data (already passed to the entryfetch
+ * plugins) holds a binary record, return a newly allocated LDIF copy of it
+ * and its size; return NULL if the record is LDIF already or is invalid.
+ */
+char *
+id2entry_data2str(const void *data, size_t size, size_t *str_size)
+{
+    char *str = NULL;
+    int len = 0;
+
+    if (!entrybin_is_binary(data, size)) {
+        return NULL;
+    }
+    str = entrybin2str(data, size, &len);
+    if (str == NULL) {
+        slapi_log_err(SLAPI_LOG_ERR, "id2entry_data2str",
+                      "Unable to decode binary id2entry record\n");
+        return NULL;
+    }
+    *str_size = len + 1;
+    return str;
+}
@@ -1180,6 +1180,11 @@ idl_insert(IDList **idl, ID id)
         return;
     }
 
+    if (IDL_BITMAP(*idl)) {
+        idl_append(*idl, id);
+        return;
+    }
+
     i = nids = (*idl)->b_nids;
 
     if (nids > 0) {
@@ -1558,6 +1563,16 @@ idl_delete(IDList **idl, ID id)
         return (4); /* cannot delete from allids block */
     }
 
+    if (IDL_BITMAP(*idl)) {
+        if (idl_bitmap_remove((*idl)->b_bitmap, id)) {
+            return (3); /* id not there */
+        }
+        if (--((*idl)->b_nids) == 0) {
+            return (2); /* id deleted, block empty */
+        }
+        return (0);
+    }
+
     /* find the id to delete */
     for (i = 0; i < (*idl)->b_nids && id > (*idl)->b_ids[i]; i++) {
         ; /* NULL */
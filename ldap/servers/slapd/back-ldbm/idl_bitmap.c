@@ -0,0 +1,735 @@
+/** BEGIN COPYRIGHT BLOCK
+ * Copyright (C) 2026 Red Hat, Inc.
+ * All rights reserved.
+ *
+ * License: GPL (version 3 or any later version).
+ * See LICENSE for details.
+ * END COPYRIGHT BLOCK **/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "back-ldbm.h"
+
+/*
+ * Compressed bitmap of IDs, used by idl_common.c for the IDLists that are
+ * too large to be kept as a flat array.
+ *
+ * The 32 bits ID space is cut into chunks of 65536 ids sharing the same
+ * high 16 bits. Each non empty chunk is a container that holds the low
+ * 16 bits of its ids either:
+ *
+ *  - as a sorted array of uint16_t, while it has no more than
+ *    IDL_BITMAP_ARRAY_MAX ids, or
+ *  - as a bitset of 65536 bits (8KB) when it is denser than that.
+ *
+ * So an id costs at most 2 bytes instead of the 4 bytes of b_ids[], and
+ * much less in a dense range, which is what the large index keys look like
+ * (objectclass=person, ...). The containers are kept sorted on their key.
+ *
+ * The set operations work container by container: two bitsets are merged
+ * 64 ids at a time with plain word operations, an array is probed against
+ * a bitset, and two arrays are merged like the IDLists are.
+ */
+
+#define IDL_BITMAP_WORDS     1024 /* 65536 bits per bitset container */
+#define IDL_BITMAP_ARRAY_MAX 4096 /* above this an array is bigger than a bitset */
+
+#define IDL_BITMAP_KEY(id)     ((uint16_t)((id) >> 16))
+#define IDL_BITMAP_LOW(id)     ((uint16_t)((id)&0xffff))
+#define IDL_BITMAP_ID(key, lo) (((ID)(key) << 16) | (ID)(lo))
+
+typedef struct idl_container
+{
+    uint16_t key;    /* high 16 bits of the ids of the container */
+    uint32_t card;   /* number of ids in the container */
+    uint32_t size;   /* allocated slots of array */
+    uint16_t *array; /* sorted low 16 bits, when the container is an array */
+    uint64_t *words; /* IDL_BITMAP_WORDS words, when the container is a bitset */
+} idl_container;
+
+struct idl_bitmap
+{
+    NIDS card;        /* number of ids in the bitmap */
+    uint32_t nc;      /* containers in use */
+    uint32_t maxc;    /* containers allocated */
+    idl_container *c; /* the containers, sorted on key */
+    /*
+     * Position of the last idl_bitmap_select, so that the iterators that
+     * walk the list one id at a time do not restart from the first
+     * container each time.
+     */
+    uint32_t sel_c;     /* container */
+    NIDS sel_base;      /* rank of the first id of that container */
+    uint32_t sel_word;  /* word, when the container is a bitset */
+    uint32_t sel_wbase; /* rank of the first id of that word in the container */
+};
+
+static void
+idl_bitmap_reset_cursor(IDBitmap *bm)
+{
+    bm->sel_c = 0;
+    bm->sel_base = 0;
+    bm->sel_word = 0;
+    bm->sel_wbase = 0;
+}
+
+static void
+idl_container_free(idl_container *c)
+{
+    slapi_ch_free((void **)&c->array);
+    slapi_ch_free((void **)&c->words);
+    c->card = 0;
+    c->size = 0;
+}
+
+static uint32_t
+idl_container_popcount(const uint64_t *words)
+{
+    uint32_t card = 0;
+
+    for (size_t w = 0; w < IDL_BITMAP_WORDS; w++) {
+        card += __builtin_popcountll(words[w]);
+    }
+    return card;
+}
+
+static void
+idl_container_to_bitset(idl_container *c)
+{
+    uint64_t *words = (uint64_t *)slapi_ch_calloc(IDL_BITMAP_WORDS, sizeof(uint64_t));
+
+    for (size_t i = 0; i < c->card; i++) {
+        words[c->array[i] >> 6] |= (uint64_t)1 << (c->array[i] & 63);
+    }
+    slapi_ch_free((void **)&c->array);
+    c->size = 0;
+    c->words = words;
+}
+
+static void
+idl_container_to_array(idl_container *c)
+{
+    uint16_t *array = (uint16_t *)slapi_ch_malloc(sizeof(uint16_t) * (c->card ? c->card : 1));
+    uint32_t n = 0;
+
+    for (size_t w = 0; w < IDL_BITMAP_WORDS; w++) {
+        uint64_t bits = c->words[w];
+        while (bits) {
+            array[n++] = (uint16_t)((w << 6) + __builtin_ctzll(bits));
+            bits &= bits - 1;
+        }
+    }
+    slapi_ch_free((void **)&c->words);
+    c->array = array;
+    c->size = c->card ? c->card : 1;
+}
+
+/* A bitset that got sparse takes less room as an array */
+static void
+idl_container_shrink(idl_container *c)
+{
+    if (c->words && c->card <= IDL_BITMAP_ARRAY_MAX) {
+        idl_container_to_array(c);
+    }
+}
+
+static void
+idl_container_copy(idl_container *dst, const idl_container *src)
+{
+    *dst = *src;
+    if (src->words) {
+        dst->words = (uint64_t *)slapi_ch_malloc(sizeof(uint64_t) * IDL_BITMAP_WORDS);
+        memcpy(dst->words, src->words, sizeof(uint64_t) * IDL_BITMAP_WORDS);
+    } else {
+        dst->size = src->card ? src->card : 1;
+        dst->array = (uint16_t *)slapi_ch_malloc(sizeof(uint16_t) * dst->size);
+        memcpy(dst->array, src->array, sizeof(uint16_t) * src->card);
+    }
+}
+
+/*
+ * Binary search of lo in an array container.
+ * Returns its index, or -(insertion point + 1) when it is not there.
+ */
+static int32_t
+idl_container_search(const idl_container *c, uint16_t lo)
+{
+    int32_t low = 0;
+    int32_t high = (int32_t)c->card - 1;
+
+    while (low <= high) {
+        int32_t mid = (low + high) >> 1;
+        if (c->array[mid] < lo) {
+            low = mid + 1;
+        } else if (c->array[mid] > lo) {
+            high = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+    return -(low + 1);
+}
+
+static int
+idl_container_contains(const idl_container *c, uint16_t lo)
+{
+    if (c->words) {
+        return (c->words[lo >> 6] >> (lo & 63)) & 1;
+    }
+    return idl_container_search(c, lo) >= 0;
+}
+
+/*
+ * Binary search of a container key, the last container is checked first
+ * because the lists are mostly built in increasing id order.
+ * Returns its index, or -(insertion point + 1) when it is not there.
+ */
+static int32_t
+idl_bitmap_find(const IDBitmap *bm, uint16_t key)
+{
+    int32_t low = 0;
+    int32_t high = (int32_t)bm->nc - 1;
+
+    if (bm->nc == 0) {
+        return -1;
+    }
+    if (bm->c[high].key == key) {
+        return high;
+    }
+    if (bm->c[high].key < key) {
+        return -(high + 2);
+    }
+    while (low <= high) {
+        int32_t mid = (low + high) >> 1;
+        if (bm->c[mid].key < key) {
+            low = mid + 1;
+        } else if (bm->c[mid].key > key) {
+            high = mid - 1;
+        } else {
+            return mid;
+        }
+    }
+    return -(low + 1);
+}
+
+static idl_container *
+idl_bitmap_insert_container(IDBitmap *bm, uint32_t pos, uint16_t key)
+{
+    if (bm->nc == bm->maxc) {
+        bm->maxc = bm->maxc ? bm->maxc * 2 : 4;
+        bm->c = (idl_container *)slapi_ch_realloc((char *)bm->c, sizeof(idl_container) * bm->maxc);
+    }
+    if (pos < bm->nc) {
+        memmove(&bm->c[pos + 1], &bm->c[pos], sizeof(idl_container) * (bm->nc - pos));
+    }
+    bm->nc++;
+    memset(&bm->c[pos], 0, sizeof(idl_container));
+    bm->c[pos].key = key;
+    return &bm->c[pos];
+}
+
+/* Append a container built by a set operation, the keys come in order */
+static void
+idl_bitmap_push(IDBitmap *bm, idl_container *c)
+{
+    if (c->card == 0) {
+        idl_container_free(c);
+        return;
+    }
+    idl_container_shrink(c);
+    *idl_bitmap_insert_container(bm, bm->nc, c->key) = *c;
+    bm->card += c->card;
+}
+
+IDBitmap *
+idl_bitmap_new(void)
+{
+    return (IDBitmap *)slapi_ch_calloc(1, sizeof(IDBitmap));
+}
+
+void
+idl_bitmap_free(IDBitmap **bm)
+{
+    if ((NULL == bm) || (NULL == *bm)) {
+        return;
+    }
+    for (size_t i = 0; i < (*bm)->nc; i++) {
+        idl_container_free(&(*bm)->c[i]);
+    }
+    slapi_ch_free((void **)&(*bm)->c);
+    slapi_ch_free((void **)bm);
+}
+
+IDBitmap *
+idl_bitmap_dup(const IDBitmap *bm)
+{
+    IDBitmap *new = idl_bitmap_new();
+
+    new->card = bm->card;
+    new->nc = new->maxc = bm->nc;
+    if (bm->nc) {
+        new->c = (idl_container *)slapi_ch_malloc(sizeof(idl_container) * bm->nc);
+        for (size_t i = 0; i < bm->nc; i++) {
+            idl_container_copy(&new->c[i], &bm->c[i]);
+        }
+    }
+    return new;
+}
+
+NIDS
+idl_bitmap_cardinality(const IDBitmap *bm)
+{
+    return bm ? bm->card : 0;
+}
+
+size_t
+idl_bitmap_sizeof(const IDBitmap *bm)
+{
+    size_t size = 0;
+
+    if (NULL == bm) {
+        return 0;
+    }
+    size = sizeof(IDBitmap) + sizeof(idl_container) * bm->maxc;
+    for (size_t i = 0; i < bm->nc; i++) {
+        if (bm->c[i].words) {
+            size += sizeof(uint64_t) * IDL_BITMAP_WORDS;
+        } else {
+            size += sizeof(uint16_t) * bm->c[i].size;
+        }
+    }
+    return size;
+}
+
+/*
+ * idl_bitmap_add - add an id to a bitmap.
+ * Adding the ids in increasing order is the fast path.
+ *
+ * returns
+ *    0 - added
+ *    1 - already in there
+ */
+int
+idl_bitmap_add(IDBitmap *bm, ID id)
+{
+    uint16_t key = IDL_BITMAP_KEY(id);
+    uint16_t lo = IDL_BITMAP_LOW(id);
+    int32_t pos = idl_bitmap_find(bm, key);
+    idl_container *c = NULL;
+
+    if (pos < 0) {
+        c = idl_bitmap_insert_container(bm, (uint32_t)(-pos - 1), key);
+    } else {
+        c = &bm->c[pos];
+    }
+
+    if (c->words) {
+        uint64_t bit = (uint64_t)1 << (lo & 63);
+        if (c->words[lo >> 6] & bit) {
+            return 1;
+        }
+        c->words[lo >> 6] |= bit;
+    } else {
+        int32_t i = (int32_t)c->card;
+        if (c->card && c->array[c->card - 1] >= lo) {
+            i = idl_container_search(c, lo);
+            if (i >= 0) {
+                return 1;
+            }
+            i = -i - 1;
+        }
+        if (c->card == c->size) {
+            c->size = c->size ? c->size * 2 : 4;
+            c->array = (uint16_t *)slapi_ch_realloc((char *)c->array, sizeof(uint16_t) * c->size);
+        }
+        if ((uint32_t)i < c->card) {
+            memmove(&c->array[i + 1], &c->array[i], sizeof(uint16_t) * (c->card - i));
+        }
+        c->array[i] = lo;
+    }
+    c->card++;
+    bm->card++;
+    if (!c->words && c->card > IDL_BITMAP_ARRAY_MAX) {
+        idl_container_to_bitset(c);
+    }
+    idl_bitmap_reset_cursor(bm);
+    return 0;
+}
+
+/*
+ * idl_bitmap_remove - remove an id from a bitmap.
+ *
+ * returns
+ *    0 - removed
+ *    1 - not in there
+ */
+int
+idl_bitmap_remove(IDBitmap *bm, ID id)
+{
+    uint16_t lo = IDL_BITMAP_LOW(id);
+    int32_t pos = idl_bitmap_find(bm, IDL_BITMAP_KEY(id));
+    idl_container *c = NULL;
+
+    if (pos < 0) {
+        return 1;
+    }
+    c = &bm->c[pos];
+    if (c->words) {
+        uint64_t bit = (uint64_t)1 << (lo & 63);
+        if (!(c->words[lo >> 6] & bit)) {
+            return 1;
+        }
+        c->words[lo >> 6] &= ~bit;
+    } else {
+        int32_t i = idl_container_search(c, lo);
+        if (i < 0) {
+            return 1;
+        }
+        memmove(&c->array[i], &c->array[i + 1], sizeof(uint16_t) * (c->card - i - 1));
+    }
+    c->card--;
+    bm->card--;
+    if (c->card == 0) {
+        idl_container_free(c);
+        memmove(&bm->c[pos], &bm->c[pos + 1], sizeof(idl_container) * (bm->nc - pos - 1));
+        bm->nc--;
+    } else {
+        idl_container_shrink(c);
+    }
+    idl_bitmap_reset_cursor(bm);
+    return 0;
+}
+
+int
+idl_bitmap_contains(const IDBitmap *bm, ID id)
+{
+    int32_t pos = idl_bitmap_find(bm, IDL_BITMAP_KEY(id));
+
+    if (pos < 0) {
+        return 0;
+    }
+    return idl_container_contains(&bm->c[pos], IDL_BITMAP_LOW(id));
+}
+
+/* Smallest low 16 bits of the container that is >= lo, or -1 */
+static int32_t
+idl_container_next(const idl_container *c, uint32_t lo)
+{
+    if (lo > 0xffff) {
+        return -1;
+    }
+    if (c->words) {
+        size_t w = lo >> 6;
+        uint64_t bits = c->words[w] & (~(uint64_t)0 << (lo & 63));
+        for (;;) {
+            if (bits) {
+                return (int32_t)((w << 6) + __builtin_ctzll(bits));
+            }
+            if (++w == IDL_BITMAP_WORDS) {
+                return -1;
+            }
+            bits = c->words[w];
+        }
+    } else {
+        int32_t i = idl_container_search(c, (uint16_t)lo);
+        if (i < 0) {
+            i = -i - 1;
+        }
+        return ((uint32_t)i < c->card) ? c->array[i] : -1;
+    }
+}
+
+/*
+ * idl_bitmap_next - return the smallest id of the bitmap that is greater
+ * than id, or NOID.
+ */
+ID
+idl_bitmap_next(const IDBitmap *bm, ID id)
+{
+    int32_t pos = idl_bitmap_find(bm, IDL_BITMAP_KEY(id));
+    uint32_t i = 0;
+
+    if (pos >= 0) {
+        int32_t lo = idl_container_next(&bm->c[pos], (uint32_t)IDL_BITMAP_LOW(id) + 1);
+        if (lo >= 0) {
+            return IDL_BITMAP_ID(bm->c[pos].key, lo);
+        }
+        i = (uint32_t)pos + 1;
+    } else {
+        i = (uint32_t)(-pos - 1);
+    }
+    if (i < bm->nc) {
+        return IDL_BITMAP_ID(bm->c[i].key, idl_container_next(&bm->c[i], 0));
+    }
+    return NOID;
+}
+
+/*
+ * idl_bitmap_select - return the id at position pos (starting at 0) of the
+ * bitmap, or NOID. This is how the IDList iterators walk a bitmap: the
+ * position of the previous call is remembered, so walking the list
+ * forward or backward costs about the same as walking b_ids[].
+ */
+ID
+idl_bitmap_select(IDBitmap *bm, NIDS pos)
+{
+    idl_container *c = NULL;
+    uint32_t r = 0;
+    uint64_t bits = 0;
+
+    if (pos >= bm->card) {
+        return NOID;
+    }
+
+    /* Move to the container holding pos */
+    while (pos < bm->sel_base) {
+        bm->sel_c--;
+        bm->sel_base -= bm->c[bm->sel_c].card;
+        bm->sel_word = 0;
+        bm->sel_wbase = 0;
+    }
+    while (pos >= bm->sel_base + bm->c[bm->sel_c].card) {
+        bm->sel_base += bm->c[bm->sel_c].card;
+        bm->sel_c++;
+        bm->sel_word = 0;
+        bm->sel_wbase = 0;
+    }
+    c = &bm->c[bm->sel_c];
+    r = pos - bm->sel_base;
+
+    if (!c->words) {
+        return IDL_BITMAP_ID(c->key, c->array[r]);
+    }
+
+    /* Then to the word holding it */
+    while (r < bm->sel_wbase) {
+        bm->sel_word--;
+        bm->sel_wbase -= __builtin_popcountll(c->words[bm->sel_word]);
+    }
+    while (r >= bm->sel_wbase + __builtin_popcountll(c->words[bm->sel_word])) {
+        bm->sel_wbase += __builtin_popcountll(c->words[bm->sel_word]);
+        bm->sel_word++;
+    }
+    bits = c->words[bm->sel_word];
+    for (r -= bm->sel_wbase; r > 0; r--) {
+        bits &= bits - 1;
+    }
+    return IDL_BITMAP_ID(c->key, (bm->sel_word << 6) + __builtin_ctzll(bits));
+}
+
+/*
+ * idl_bitmap_to_array - copy the ids of the bitmap, in increasing order, to
+ * ids which must have room for idl_bitmap_cardinality(bm) ids.
+ */
+NIDS
+idl_bitmap_to_array(const IDBitmap *bm, ID *ids)
+{
+    NIDS n = 0;
+
+    for (size_t i = 0; i < bm->nc; i++) {
+        const idl_container *c = &bm->c[i];
+        if (c->words) {
+            for (size_t w = 0; w < IDL_BITMAP_WORDS; w++) {
+                uint64_t bits = c->words[w];
+                while (bits) {
+                    ids[n++] = IDL_BITMAP_ID(c->key, (w << 6) + __builtin_ctzll(bits));
+                    bits &= bits - 1;
+                }
+            }
+        } else {
+            for (size_t j = 0; j < c->card; j++) {
+                ids[n++] = IDL_BITMAP_ID(c->key, c->array[j]);
+            }
+        }
+    }
+    return n;
+}
+
+static void
+idl_container_and(const idl_container *a, const idl_container *b, idl_container *n)
+{
+    memset(n, 0, sizeof(idl_container));
+    n->key = a->key;
+
+    if (a->words && b->words) {
+        n->words = (uint64_t *)slapi_ch_malloc(sizeof(uint64_t) * IDL_BITMAP_WORDS);
+        for (size_t w = 0; w < IDL_BITMAP_WORDS; w++) {
+            n->words[w] = a->words[w] & b->words[w];
+        }
+        n->card = idl_container_popcount(n->words);
+    } else if (a->words || b->words) {
+        const idl_container *arr = a->words ? b : a;
+        const idl_container *set = a->words ? a : b;
+        n->size = arr->card;
+        n->array = (uint16_t *)slapi_ch_malloc(sizeof(uint16_t) * n->size);
+        for (size_t i = 0; i < arr->card; i++) {
+            if (idl_container_contains(set, arr->array[i])) {
+                n->array[n->card++] = arr->array[i];
+            }
+        }
+    } else {
+        size_t ai = 0, bi = 0;
+        n->size = a->card < b->card ? a->card : b->card;
+        n->array = (uint16_t *)slapi_ch_malloc(sizeof(uint16_t) * n->size);
+        while (ai < a->card && bi < b->card) {
+            if (a->array[ai] < b->array[bi]) {
+                ai++;
+            } else if (a->array[ai] > b->array[bi]) {
+                bi++;
+            } else {
+                n->array[n->card++] = a->array[ai];
+                ai++, bi++;
+            }
+        }
+    }
+}
+
+static void
+idl_container_or(const idl_container *a, const idl_container *b, idl_container *n)
+{
+    memset(n, 0, sizeof(idl_container));
+    n->key = a->key;
+
+    if (a->words || b->words) {
+        const idl_container *set = a->words ? a : b;
+        const idl_container *other = a->words ? b : a;
+        idl_container_copy(n, set);
+        if (other->words) {
+            for (size_t w = 0; w < IDL_BITMAP_WORDS; w++) {
+                n->words[w] |= other->words[w];
+            }
+        } else {
+            for (size_t i = 0; i < other->card; i++) {
+                n->words[other->array[i] >> 6] |= (uint64_t)1 << (other->array[i] & 63);
+            }
+        }
+        n->card = idl_container_popcount(n->words);
+    } else {
+        size_t ai = 0, bi = 0;
+        n->size = a->card + b->card;
+        n->array = (uint16_t *)slapi_ch_malloc(sizeof(uint16_t) * n->size);
+        while (ai < a->card && bi < b->card) {
+            if (a->array[ai] < b->array[bi]) {
+                n->array[n->card++] = a->array[ai++];
+            } else if (a->array[ai] > b->array[bi]) {
+                n->array[n->card++] = b->array[bi++];
+            } else {
+                n->array[n->card++] = a->array[ai];
+                ai++, bi++;
+            }
+        }
+        for (; ai < a->card; ai++) {
+            n->array[n->card++] = a->array[ai];
+        }
+        for (; bi < b->card; bi++) {
+            n->array[n->card++] = b->array[bi];
+        }
+        if (n->card > IDL_BITMAP_ARRAY_MAX) {
+            idl_container_to_bitset(n);
+        }
+    }
+}
+
+static void
+idl_container_andnot(const idl_container *a, const idl_container *b, idl_container *n)
+{
+    memset(n, 0, sizeof(idl_container));
+    n->key = a->key;
+
+    if (a->words) {
+        idl_container_copy(n, a);
+        if (b->words) {
+            for (size_t w = 0; w < IDL_BITMAP_WORDS; w++) {
+                n->words[w] &= ~b->words[w];
+            }
+        } else {
+            for (size_t i = 0; i < b->card; i++) {
+                n->words[b->array[i] >> 6] &= ~((uint64_t)1 << (b->array[i] & 63));
+            }
+        }
+        n->card = idl_container_popcount(n->words);
+    } else {
+        n->size = a->card;
+        n->array = (uint16_t *)slapi_ch_malloc(sizeof(uint16_t) * n->size);
+        for (size_t i = 0; i < a->card; i++) {
+            if (!idl_container_contains(b, a->array[i])) {
+                n->array[n->card++] = a->array[i];
+            }
+        }
+    }
+}
+
+/*
+ * idl_bitmap_and - return a intersection b
+ */
+IDBitmap *
+idl_bitmap_and(const IDBitmap *a, const IDBitmap *b)
+{
+    IDBitmap *n = idl_bitmap_new();
+    idl_container c;
+    size_t ai = 0, bi = 0;
+
+    while (ai < a->nc && bi < b->nc) {
+        if (a->c[ai].key < b->c[bi].key) {
+            ai++;
+        } else if (a->c[ai].key > b->c[bi].key) {
+            bi++;
+        } else {
+            idl_container_and(&a->c[ai], &b->c[bi], &c);
+            idl_bitmap_push(n, &c);
+            ai++, bi++;
+        }
+    }
+    return n;
+}
+
+/*
+ * idl_bitmap_or - return a union b
+ */
+IDBitmap *
+idl_bitmap_or(const IDBitmap *a, const IDBitmap *b)
+{
+    IDBitmap *n = idl_bitmap_new();
+    idl_container c;
+    size_t ai = 0, bi = 0;
+
+    while (ai < a->nc || bi < b->nc) {
+        if (bi == b->nc || (ai < a->nc && a->c[ai].key < b->c[bi].key)) {
+            idl_container_copy(&c, &a->c[ai++]);
+        } else if (ai == a->nc || a->c[ai].key > b->c[bi].key) {
+            idl_container_copy(&c, &b->c[bi++]);
+        } else {
+            idl_container_or(&a->c[ai], &b->c[bi], &c);
+            ai++, bi++;
+        }
+        idl_bitmap_push(n, &c);
+    }
+    return n;
+}
+
+/*
+ * idl_bitmap_andnot - return a intersection ~b (or a minus b)
+ */
+IDBitmap *
+idl_bitmap_andnot(const IDBitmap *a, const IDBitmap *b)
+{
+    IDBitmap *n = idl_bitmap_new();
+    idl_container c;
+    size_t ai = 0, bi = 0;
+
+    while (ai < a->nc) {
+        while (bi < b->nc && b->c[bi].key < a->c[ai].key) {
+            bi++;
+        }
+        if (bi < b->nc && b->c[bi].key == a->c[ai].key) {
+            idl_container_andnot(&a->c[ai], &b->c[bi], &c);
+        } else {
+            idl_container_copy(&c, &a->c[ai]);
+        }
+        idl_bitmap_push(n, &c);
+        ai++;
+    }
+    return n;
+}
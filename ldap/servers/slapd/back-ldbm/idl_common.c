@@ -21,7 +21,7 @@ idl_sizeof(IDList *idl)
     if (NULL == idl) {
         return 0;
     }
-    return sizeof(IDList) + (idl->b_nmax * sizeof(ID));
+    return sizeof(IDList) + (idl->b_nmax * sizeof(ID)) + idl_bitmap_sizeof(idl->b_bitmap);
 }
 
 NIDS
@@ -83,9 +83,91 @@ idl_free(IDList **idl)
         return;
     }
 
+    idl_bitmap_free(&(*idl)->b_bitmap);
     slapi_ch_free((void **)idl);
 }
 
+/*
+ * Large id lists can be held in the compressed bitmap of idl_bitmap.c
+ * rather than in b_ids. Such a list has b_bitmap set and b_nids gives the
+ * number of ids in the bitmap. The set operations, the iterators,
+ * idl_firstid/idl_nextid, idl_id_is_in_idlist and idl_append/idl_insert
+ * handle both forms; the code that reads b_ids directly must call
+ * idl_expand first.
+ */
+
+/* Make an IDList of a bitmap, the IDList owns the bitmap */
+IDList *
+idl_from_bitmap(IDBitmap *bm)
+{
+    IDList *idl = idl_alloc(0);
+
+    idl->b_bitmap = bm;
+    idl->b_nids = idl_bitmap_cardinality(bm);
+
+    return idl;
+}
+
+/*
+ * idl_compress - turn an id list into its bitmap form.
+ * returns 1 if the list was replaced, 0 if it was left as is.
+ */
+int
+idl_compress(IDList **idl)
+{
+    IDBitmap *bm = NULL;
+
+    if ((NULL == idl) || (NULL == *idl) || ALLIDS(*idl) || IDL_BITMAP(*idl)) {
+        return 0;
+    }
+
+    bm = idl_bitmap_new();
+    for (NIDS i = 0; i < (*idl)->b_nids; i++) {
+        idl_bitmap_add(bm, (*idl)->b_ids[i]);
+    }
+    idl_free(idl);
+    *idl = idl_from_bitmap(bm);
+
+    return 1;
+}
+
+/*
+ * idl_compress_threshold - turn an id list into its bitmap form once it
+ * holds more than threshold ids. A threshold of 0 never compresses.
+ * returns 1 if the list was replaced, 0 if it was left as is.
+ */
+int
+idl_compress_threshold(IDList **idl, int threshold)
+{
+    if ((threshold <= 0) || (NULL == idl) || (NULL == *idl) || IDL_BITMAP(*idl) ||
+        ((*idl)->b_nids <= (NIDS)threshold)) {
+        return 0;
+    }
+
+    return idl_compress(idl);
+}
+
+/*
+ * idl_expand - turn a bitmap id list back into an array of ids.
+ * returns 1 if the list was replaced, 0 if it was left as is.
+ */
+int
+idl_expand(IDList **idl)
+{
+    IDList *n = NULL;
+
+    if ((NULL == idl) || (NULL == *idl) || !IDL_BITMAP(*idl)) {
+        return 0;
+    }
+
+    n = idl_alloc((*idl)->b_nids);
+    n->b_nids = idl_bitmap_to_array((*idl)->b_bitmap, n->b_ids);
+    idl_free(idl);
+    *idl = n;
+
+    return 1;
+}
+
 
 /*
  * idl_append - append an id to an id list.
@@ -105,6 +187,11 @@ idl_append(IDList *idl, ID id)
     if (NULL == idl) {
         return 2;
     }
+    if (IDL_BITMAP(idl)) {
+        int rc = idl_bitmap_add(idl->b_bitmap, id);
+        idl->b_nids = idl_bitmap_cardinality(idl->b_bitmap);
+        return rc;
+    }
     if (ALLIDS(idl) || ((idl->b_nids) && (idl->b_ids[idl->b_nids - 1] == id))) {
         return (1); /* already there */
     }
@@ -135,6 +222,11 @@ idl_append_extend(IDList **orig_idl, ID id)
         return 0;
     }
 
+    if (IDL_BITMAP(idl)) {
+        idl_append(idl, id);
+        return 0;
+    }
+
     if (idl->b_nids == idl->b_nmax) {
         /* No more room, need to extend */
         idl->b_nmax = idl->b_nmax * 2;
@@ -159,6 +251,9 @@ idl_dup(IDList *idl)
     if (idl == NULL) {
         return (NULL);
     }
+    if (IDL_BITMAP(idl)) {
+        return idl_from_bitmap(idl_bitmap_dup(idl->b_bitmap));
+    }
 
     new = idl_alloc(idl->b_nmax);
     memcpy(new, idl, idl_sizeof(idl));
@@ -344,6 +439,9 @@ idl_id_is_in_idlist(IDList *idl, ID id)
     if (ALLIDS(idl)) {
         return 1; /* in the list */
     }
+    if (IDL_BITMAP(idl)) {
+        return idl_bitmap_contains(idl->b_bitmap, id);
+    }
 
     for (NIDS i = 0; i < idl->b_nids; i++) {
         if (id == idl->b_ids[i]) {
@@ -377,6 +475,19 @@ idl_compare(IDList *a, IDList *b)
         return 0;
     }
 
+    /* Walk the lists, one of them is not an array */
+    if (IDL_BITMAP(a) || IDL_BITMAP(b)) {
+        idl_iterator ai = idl_iterator_init(a);
+        idl_iterator bi = idl_iterator_init(b);
+        for (size_t i = 0; i < a->b_nids; i++) {
+            if (idl_iterator_dereference_increment(&ai, a) !=
+                idl_iterator_dereference_increment(&bi, b)) {
+                return 1;
+            }
+        }
+        return 0;
+    }
+
     /* Same size, and not the same array. Lets check! */
     for (size_t i = 0; i < a->b_nids; i++) {
         if (a->b_ids[i] != b->b_ids[i]) {
@@ -387,6 +498,125 @@ idl_compare(IDList *a, IDList *b)
     return 0;
 }
 
+/*
+ * idl_gallop - return the index of the first id of idl, at or after
+ * start, that is >= id, or idl->b_nids if there is none.
+ *
+ * The step from start doubles until it goes past id, then a binary search
+ * runs over the last step. This costs O(log d) where d is the distance to
+ * the result, so walking a large list with the ids of a much smaller one
+ * skips most of the large list.
+ */
+NIDS
+idl_gallop(const IDList *idl, NIDS start, ID id)
+{
+    size_t lo = start;
+    size_t hi = start;
+    size_t step = 1;
+
+    if (start >= idl->b_nids || idl->b_ids[start] >= id) {
+        return start;
+    }
+    /* b_ids[lo] < id */
+    for (;;) {
+        hi = lo + step;
+        if (hi >= idl->b_nids) {
+            hi = idl->b_nids;
+            break;
+        }
+        if (idl->b_ids[hi] >= id) {
+            break;
+        }
+        lo = hi;
+        step <<= 1;
+    }
+    /* b_ids[lo] < id <= b_ids[hi], or hi == b_nids */
+    while (lo + 1 < hi) {
+        size_t mid = lo + ((hi - lo) >> 1);
+        if (idl->b_ids[mid] < id) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return (NIDS)hi;
+}
+
+/*
+ * Set operations where a or b is a bitmap. Two bitmaps are merged
+ * container by container, an array is probed against a bitmap.
+ */
+static IDList *
+idl_intersection_bitmap(IDList *a, IDList *b)
+{
+    IDList *arr = NULL;
+    IDList *n = NULL;
+    NIDS ni = 0;
+
+    if (IDL_BITMAP(a) && IDL_BITMAP(b)) {
+        return idl_from_bitmap(idl_bitmap_and(a->b_bitmap, b->b_bitmap));
+    }
+
+    arr = IDL_BITMAP(a) ? b : a;
+    n = idl_alloc(arr->b_nids);
+    for (NIDS i = 0; i < arr->b_nids; i++) {
+        if (idl_bitmap_contains(arr == a ? b->b_bitmap : a->b_bitmap, arr->b_ids[i])) {
+            n->b_ids[ni++] = arr->b_ids[i];
+        }
+    }
+    n->b_nids = ni;
+
+    return n;
+}
+
+static IDList *
+idl_union_bitmap(IDList *a, IDList *b)
+{
+    IDList *arr = NULL;
+    IDBitmap *bm = NULL;
+
+    if (IDL_BITMAP(a) && IDL_BITMAP(b)) {
+        return idl_from_bitmap(idl_bitmap_or(a->b_bitmap, b->b_bitmap));
+    }
+
+    arr = IDL_BITMAP(a) ? b : a;
+    bm = idl_bitmap_dup(arr == a ? b->b_bitmap : a->b_bitmap);
+    for (NIDS i = 0; i < arr->b_nids; i++) {
+        idl_bitmap_add(bm, arr->b_ids[i]);
+    }
+
+    return idl_from_bitmap(bm);
+}
+
+static IDList *
+idl_notin_bitmap(IDList *a, IDList *b)
+{
+    IDList *n = NULL;
+    NIDS ni = 0;
+
+    if (IDL_BITMAP(a) && IDL_BITMAP(b)) {
+        return idl_from_bitmap(idl_bitmap_andnot(a->b_bitmap, b->b_bitmap));
+    }
+
+    if (IDL_BITMAP(a)) {
+        IDBitmap *bm = idl_bitmap_dup(a->b_bitmap);
+        for (NIDS i = 0; i < b->b_nids; i++) {
+            idl_bitmap_remove(bm, b->b_ids[i]);
+        }
+        return idl_from_bitmap(bm);
+    }
+
+    n = idl_alloc(a->b_nids);
+    for (NIDS i = 0; i < a->b_nids; i++) {
+        if (!idl_bitmap_contains(b->b_bitmap, a->b_ids[i])) {
+            n->b_ids[ni++] = a->b_ids[i];
+        }
+    }
+    n->b_nids = ni;
+
+    return n;
+}
+
 /*
  * idl_intersection - return a intersection b
  */
@@ -415,9 +645,32 @@ idl_intersection(
         slapi_be_set_flag(be, SLAPI_BE_FLAG_DONT_BYPASS_FILTERTEST);
         return (idl_dup(a));
     }
+    if (IDL_BITMAP(a) || IDL_BITMAP(b)) {
+        return idl_intersection_bitmap(a, b);
+    }
 
     n = idl_dup(idl_min(a, b));
 
+    /* Walk the small list and gallop in the large one */
+    if (a->b_nids > b->b_nids) {
+        IDList *t = a;
+        a = b;
+        b = t;
+    }
+    if (b->b_nids / IDL_GALLOP_RATIO > a->b_nids) {
+        for (ni = 0, ai = 0, bi = 0; ai < a->b_nids; ai++) {
+            bi = idl_gallop(b, bi, a->b_ids[ai]);
+            if (bi == b->b_nids) {
+                break;
+            }
+            if (b->b_ids[bi] == a->b_ids[ai]) {
+                n->b_ids[ni++] = a->b_ids[ai];
+            }
+        }
+        n->b_nids = ni;
+        return (n);
+    }
+
     for (ni = 0, ai = 0, bi = 0; ai < a->b_nids; ai++) {
         for (; bi < b->b_nids && b->b_ids[bi] < a->b_ids[ai]; bi++)
             ; /* NULL */
@@ -458,6 +711,9 @@ idl_union(
     if (ALLIDS(a) || ALLIDS(b)) {
         return (idl_allids(be));
     }
+    if (IDL_BITMAP(a) || IDL_BITMAP(b)) {
+        return idl_union_bitmap(a, b);
+    }
 
     if (b->b_nids < a->b_nids) {
         n = a;
@@ -535,18 +791,26 @@ idl_notin(
         n = idl_alloc(SLAPD_LDBM_MIN_MAXIDS);
         ni = 0;
 
-        for (ai = 1, bi = 0; ai < a->b_nids && ni < n->b_nmax &&
-                             bi < b->b_nmax;
-             ai++) {
-            if (b->b_ids[bi] == ai) {
-                bi++;
-            } else {
-                n->b_ids[ni++] = ai;
+        if (IDL_BITMAP(b)) {
+            for (ai = 1; ai < a->b_nids && ni < n->b_nmax; ai++) {
+                if (!idl_bitmap_contains(b->b_bitmap, ai)) {
+                    n->b_ids[ni++] = ai;
+                }
+            }
+        } else {
+            for (ai = 1, bi = 0; ai < a->b_nids && ni < n->b_nmax &&
+                                 bi < b->b_nmax;
+                 ai++) {
+                if (b->b_ids[bi] == ai) {
+                    bi++;
+                } else {
+                    n->b_ids[ni++] = ai;
+                }
             }
-        }
 
-        for (; ai < a->b_nids && ni < n->b_nmax; ai++) {
-            n->b_ids[ni++] = ai;
+            for (; ai < a->b_nids && ni < n->b_nmax; ai++) {
+                n->b_ids[ni++] = ai;
+            }
         }
 
         if (ni == n->b_nmax) {
@@ -559,6 +823,11 @@ idl_notin(
         return (1);
     }
 
+    if (IDL_BITMAP(a) || IDL_BITMAP(b)) {
+        *new_result = idl_notin_bitmap(a, b);
+        return (1);
+    }
+
     /* This is the case we're interested in, we want to detect where a and b don't overlap */
     {
         size_t ahii, aloi, bhii, bloi;
@@ -621,6 +890,9 @@ idl_firstid(IDList *idl)
     if (ALLIDS(idl)) {
         return (idl->b_nids == 1 ? NOID : 1);
     }
+    if (IDL_BITMAP(idl)) {
+        return idl_bitmap_select(idl->b_bitmap, 0);
+    }
 
     return (idl->b_ids[0]);
 }
@@ -636,6 +908,9 @@ idl_nextid(IDList *idl, ID id)
     if (ALLIDS(idl)) {
         return (++id < idl->b_nids ? id : NOID);
     }
+    if (IDL_BITMAP(idl)) {
+        return idl_bitmap_next(idl->b_bitmap, id);
+    }
 
     for (i = 0; i < idl->b_nids && idl->b_ids[i] < id; i++) {
         ; /* NULL */
@@ -692,6 +967,8 @@ idl_iterator_dereference(idl_iterator i, const IDList *idl)
          * entries in id2entry start at 1, not 0, so we have off by one here.
          */
         return (ID)i + 1;
+    } else if (IDL_BITMAP(idl)) {
+        return idl_bitmap_select(idl->b_bitmap, (NIDS)i);
     } else {
         return idl->b_ids[i];
     }
@@ -271,6 +271,8 @@ idl_new_fetch(
                 idl_free(&idl);
                 goto error;
             }
+            /* large lists are kept compressed, see idl_bitmap.c */
+            idl_compress_threshold(&idl, li->li_idl_bitmap_threshold);
 
             count++;
         }
@@ -1217,7 +1219,7 @@ int idl_new_store_block(
     dbi_cursor_t cursor = {0};
     dbi_val_t data = {0};
     ID id = 0;
-    size_t x = 0;
+    idl_iterator current;
     char *index_id = get_index_name(be, db, a);
 #if defined(DB_ALLIDS_ON_WRITE)
     dbi_recno_t count;
@@ -1258,10 +1260,10 @@ int idl_new_store_block(
         goto error;
     }
 
-    /* Iterate over the IDs in the idl */
-    for (x = 0; x < idl->b_nids; x++) {
+    /* Iterate over the IDs in the idl, which may be held as a bitmap */
+    current = idl_iterator_init(idl);
+    while ((id = idl_iterator_dereference_increment(&current, idl)) != NOID) {
         /* insert an id */
-        id = idl->b_ids[x];
         ret = dblayer_cursor_op(&cursor, DBI_OP_ADD, key, &data);
         if (0 != ret) {
             if (DBI_RC_KEYEXIST == ret) {
@@ -41,100 +41,119 @@
  *
  * (1,2,3,4) (1,5,6) (1), ()
  *
- * We start with a pointer at the head of each:
- *
- * (1,2,3,4) (1,5,6) (1), ()
- *  ^         ^       ^   ^
- *
- * if the idl is empty, we prune it:
- *
- * (1,2,3,4) (1,5,6) (1)
- *  ^         ^       ^
- *
- * Now we check the min id for all sets. In this case the
- * sets agree it's 1, so we add 1 to the result set.
- *
- * now we move the pointers along and prune the empty set
- *
- * (1,2,3,4) (1,5,6)
- *    ^         ^
- *
- * Now the next min is 2 - when we examine the second list
- * because 5 > 2, we ignore this for now. Finally we then
- * insert 2. We advance the pointer.
- *
- * (1,2,3,4) (1,5,6)
- *      ^       ^
- * We continue this until we exhaust the first list, or the
- * second.
+ * Empty sets are pruned, and each remaining set gets a pointer at its
+ * head. The sets are put in a min-heap ordered on the id under their
+ * pointer, so the root of the heap is the set holding the smallest id:
+ *
+ *           (1,5,6)
+ *            ^
+ *     (1,2,3,4)   (1)
+ *      ^           ^
+ *
+ * We take the id of the root, 1, insert it in the result unless it is
+ * the id we inserted last, advance the root pointer and sift the root
+ * down to restore the heap:
+ *
+ *              (1)
+ *               ^
+ *     (1,2,3,4)   (1,5,6)
+ *      ^              ^
+ *
+ * The root is again 1, which we already have, so we only advance it. This
+ * set is now exhausted, so it is dropped from the heap. We continue until
+ * the heap is empty. Each id costs O(log k) instead of a scan of all the k
+ * sets, which matters for the wide OR filters, (|(uid=a)(uid=b)...) with
+ * hundreds of terms.
+ *
+ * Sifting on every id mispredicts a lot of branches though, and with only a
+ * few sets it is faster to union them pairwise (see idl_set_fold): each pass
+ * is a plain linear merge. The heap is only used from IDL_SET_HEAP_MIN sets.
  *
  * k-way intersection
  * ------------------
  *
- * k-way intersection intersects multiple idls at the same time.
- * it works by continually iterating over our lists to build a
- * quorum, where all idls agree on the current minimal element.
+ * k-way intersection intersects multiple idls at the same time. We sort
+ * the idls by size, and walk the smallest one: an id can only be in the
+ * result if it is in the smallest idl. For each of its ids we look for it
+ * in the other idls, from the smallest to the largest one.
  *
  * given:
  *
- * (1,2,3,4,5,6) (1,2,5,6) (3,5,6)
- *
- * we start our pointers at the start as in k-way union
- *
- * (1,2,3,4,5,6) (1,2,5,6) (3,5,6)
- *  ^             ^         ^
- *  | min=0, q=0
- *
- * since min=0, we set this to the min of the first list. Because
- * the first list "agrees" that 1 is the min, we set quorum to 1.
- *
- * (1,2,3,4,5,6) (1,2,5,6) (3,5,6)
- *  ^             ^         ^
- *  | min=1, q=1
+ * (3,5,6) (1,2,5,6) (1,2,3,4,5,6)
+ *  ^       ^         ^
  *
- * Now we move to the next list. It also has 1 as the min, so we
- * increase the quorum.
+ * we look for 3 in the second idl. We find 5 there, so 3 can't be in the
+ * result. Rather than trying 3 in the other idls we move the pointer of
+ * the smallest idl to 5 directly:
  *
- * (1,2,3,4,5,6) (1,2,5,6) (3,5,6)
- *  ^             ^         ^
- *                | min=1, q=2
+ * (3,5,6) (1,2,5,6) (1,2,3,4,5,6)
+ *    ^         ^     ^
  *
- * When we advance to the third list we see 3 is the min. So we reset
- * min to 3, and q to 1 (since only this list thinks 3 is min so far)
- *
- * (1,2,3,4,5,6) (1,2,5,6) (3,5,6)
- *  ^             ^         ^
- *                          | min=3, q=1
- *
- * We now go back to the first list. Since 1 < min, we advance our
- * pointer til either we exceed min or equal it. In this case we
- * equal it and add to quorum.
- *
- * (1,2,3,4,5,6) (1,2,5,6) (3,5,6)
- *      ^         ^         ^
- *      | min=3, q=2
- *
- * When we get to the next list, we repeat this. We advance to 5.
- *
- * (1,2,3,4,5,6) (1,2,5,6) (3,5,6)
- *      ^             ^     ^
- *                    | min=5, q=1
- *
- * Next when we get to list 3 we have 5, and finall list 1 we have 5
- *
- * (1,2,3,4,5,6) (1,2,5,6) (3,5,6)
- *      ^             ^       ^
- *                            | min=5, q=2
- *
- * (1,2,3,4,5,6) (1,2,5,6) (3,5,6)
- *          ^         ^       ^
- *          | min=5, q=3
- *
- * We finally have quorum! Now we insert 5 to the result_list, and
- * advance all our idl by 1.
+ * 5 is in the second and the third idl, so we insert it and move on to 6.
+ * When an idl is exhausted nothing more can be inserted and we are done.
  *
+ * The search of an id in an idl starts from where the previous search
+ * ended, and gallops: it tries the next id, then 2, 4, 8 ... ids further,
+ * and finishes with a binary search. When the idls have very different
+ * sizes, such as (objectclass=person) and (uid=foo), this only looks at a
+ * few ids of the large idls.
  *
+ * Lists held as compressed bitmaps (see idl_bitmap.c) have no b_ids, sets
+ * with such lists are combined pairwise by idl_set_fold instead.
+ */
+
+/*
+ * Below this many sets, idl_set_union merges them pairwise rather than
+ * through a heap. Measured with the idl_set cmocka test, the heap only
+ * catches up with the pairwise merges around 48 disjoint sets.
  */
+#define IDL_SET_HEAP_MIN 64
+
+/*
+ * An entry of the idl_set_union heap. The current id of the set is kept
+ * next to it so that sifting does not chase the idl pointers.
+ */
+struct idl_set_heap_entry
+{
+    ID id;
+    IDList *idl;
+};
+
+/* Restore the min-heap of idl_set_union below position i */
+static void
+idl_set_heap_down(struct idl_set_heap_entry *heap, size_t heap_size, size_t i)
+{
+    struct idl_set_heap_entry top = heap[i];
+
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= heap_size) {
+            break;
+        }
+        if (child + 1 < heap_size && heap[child + 1].id < heap[child].id) {
+            child++;
+        }
+        if (top.id <= heap[child].id) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = top;
+}
+
+/* Sort the idls of idl_set_intersect, smallest first */
+static int
+idl_set_cmp_size(const void *a, const void *b)
+{
+    const IDList *idl_a = *(const IDList **)a;
+    const IDList *idl_b = *(const IDList **)b;
+
+    if (idl_a->b_nids < idl_b->b_nids) {
+        return -1;
+    }
+    return idl_a->b_nids > idl_b->b_nids ? 1 : 0;
+}
 
 IDListSet *
 idl_set_create()
@@ -197,6 +216,9 @@ idl_set_insert_idl(IDListSet *idl_set, IDList *idl)
      * Track this for max possible union size of these sets.
      */
     idl_set->total_size += idl->b_nids;
+    if (IDL_BITMAP(idl)) {
+        idl_set->bitmaps += 1;
+    }
 
     idl->next = idl_set->head;
     idl_set->head = idl;
@@ -227,6 +249,56 @@ idl_set_insert_complement_idl(IDListSet *idl_set, IDList *idl)
     idl_set->complement_head = idl;
 }
 
+/*
+ * The k-way union and intersection walk b_ids, which a list held as a
+ * compressed bitmap does not have. When the set contains such lists they
+ * are combined pairwise with idl_union / idl_intersection instead, which
+ * merge two bitmaps word by word and probe an array against a bitmap.
+ * The fold starts from first, the smallest list for an intersection.
+ */
+static IDList *
+idl_set_fold(IDListSet *idl_set, backend *be, IDList *first, IDList *(*fn)(backend *, IDList *, IDList *))
+{
+    IDList *result_list = first;
+    IDList **prev = &idl_set->head;
+    IDList *idl = NULL;
+    IDList *next = NULL;
+
+    /*
+     * Take first out of the set before folding: it is freed as soon as it
+     * has been combined with another list, and must not be reached again
+     * while walking the set.
+     */
+    while (*prev != first) {
+        prev = &((*prev)->next);
+    }
+    *prev = first->next;
+
+    for (idl = idl_set->head; idl != NULL; idl = next) {
+        IDList *tmp = fn(be, result_list, idl);
+        next = idl->next;
+        idl_free(&result_list);
+        idl_free(&idl);
+        result_list = tmp;
+    }
+    idl_set->head = NULL;
+
+    return result_list;
+}
+
+/*
+ * Size of the smallest idl inserted in the set so far, or -1 if there is
+ * none yet (nothing or only allids was inserted).
+ */
+int64_t
+idl_set_minimum_size(IDListSet *idl_set)
+{
+    if (idl_set == NULL || idl_set->minimum == NULL) {
+        return -1;
+    }
+    return (int64_t)idl_set->minimum->b_nids;
+}
+
 int64_t
 idl_set_union_shortcut(IDListSet *idl_set)
 {
@@ -264,82 +336,53 @@ idl_set_union(IDListSet *idl_set, backend *be)
         idl_free(&(idl_set->head->next));
         idl_free(&(idl_set->head));
         return result_list;
+    } else if (idl_set->bitmaps || idl_set->count < IDL_SET_HEAP_MIN) {
+        return idl_set_fold(idl_set, be, idl_set->head, idl_union);
     }
 
     /*
      * Allocate a new set based on the size of our sets.
      */
     IDList *result_list = idl_alloc(idl_set->total_size);
+    struct idl_set_heap_entry *heap = (struct idl_set_heap_entry *)slapi_ch_malloc(sizeof(struct idl_set_heap_entry) * idl_set->count);
     IDList *idl = NULL;
-    IDList *idl_del = NULL;
-    IDList *prev_idl = NULL;
-    NIDS last_min = 0;
-    NIDS next_min = 0;
+    IDList *next_idl = NULL;
+    size_t heap_size = 0;
 
-    /*
-     * Now we iterate over our sets - if the current itr is
-     * cur_min and ! in the new set, add it. While we do this
-     * we are finding the next_min to repeat.
-     *
-     * we continue until we exhaust every set we have.
-     *
-     * check for idl_set->head->next NULL?
-     */
-    while (idl_set->head != NULL) {
-        prev_idl = NULL;
-        idl = idl_set->head;
-        /* now find the next smallest */
-        while (idl) {
-            /*
-             * Did our head value get inserted last round?
-             */
-            if (idl->b_ids[idl->itr] == last_min && last_min != 0) {
-                /*
-                 * Our value was previously inserted - advance itr.
-                 */
-                idl->itr += 1;
-            }
-            /*
-             * Nothing left to search in this idl
-             * itr should never be >, but lets be safe.
-             */
-            if (idl->itr >= idl->b_nids) {
-                if (prev_idl) {
-                    prev_idl->next = idl->next;
-                } else {
-                    /*
-                     * This is our base case: when we strike the last
-                     * idl, and prev is null,  and next is null, we are done!
-                     */
-                    PR_ASSERT(idl == idl_set->head);
-                    idl_set->head = idl->next;
-                }
-                idl_del = idl;
-                idl = idl_del->next;
-                idl_free(&idl_del);
-                /* No need to touch prev_idl. */
-            } else {
-                /*
-                 * Now check our value and see if it's this iterations
-                 * smallest candidate.
-                 */
-                if (idl->b_ids[idl->itr] < next_min || next_min == 0) {
-                    next_min = idl->b_ids[idl->itr];
-                }
-                /* Go to the next idl. */
-                prev_idl = idl;
-                idl = idl->next;
-            }
+    for (idl = idl_set->head; idl != NULL; idl = idl->next) {
+        if (idl->b_nids > 0) {
+            idl->itr = 0;
+            heap[heap_size].id = idl->b_ids[0];
+            heap[heap_size].idl = idl;
+            heap_size++;
+        }
+    }
+    for (size_t i = heap_size / 2; i-- > 0;) {
+        idl_set_heap_down(heap, heap_size, i);
+    }
+
+    while (heap_size > 0) {
+        idl = heap[0].idl;
+        /* idl_append skips the id if it is the last one inserted */
+        idl_append(result_list, heap[0].id);
+        idl->itr += 1;
+        if (idl->itr < idl->b_nids) {
+            heap[0].id = idl->b_ids[idl->itr];
+        } else {
+            /* Nothing left in this idl, drop it from the heap */
+            heap[0] = heap[--heap_size];
         }
-        /* Insert the current smallest value we have */
-        /* next_min can be 0 because we freed all idls remaining */
-        if (next_min > 0) {
-            idl_append(result_list, next_min);
+        if (heap_size > 1) {
+            idl_set_heap_down(heap, heap_size, 0);
         }
+    }
+    slapi_ch_free((void **)&heap);
 
-        last_min = next_min;
-        next_min = 0;
+    for (idl = idl_set->head; idl != NULL; idl = next_idl) {
+        next_idl = idl->next;
+        idl_free(&idl);
     }
+    idl_set->head = NULL;
 
     return result_list;
 }
@@ -390,6 +433,8 @@ idl_set_intersect(IDListSet *idl_set, backend *be)
         result_list = idl_intersection(be, idl_set->head, idl_set->head->next);
         idl_free(&(idl_set->head->next));
         idl_free(&(idl_set->head));
+    } else if (idl_set->bitmaps) {
+        result_list = idl_set_fold(idl_set, be, idl_set->minimum, idl_intersection);
     } else {
         /*
          * Must have at least 2 idls or more, so do a k-way intersection.
@@ -398,123 +443,52 @@ idl_set_intersect(IDListSet *idl_set, backend *be)
          *
          * we don't care if we have allids here, because we'll ignore it anyway.
          */
-        result_list = idl_alloc(idl_set->minimum->b_nids);
+        IDList **idls = (IDList **)slapi_ch_malloc(sizeof(IDList *) * idl_set->count);
         IDList *idl = NULL;
+        IDList *next_idl = NULL;
+        IDList *min_idl = NULL;
+        size_t count = 0;
+        NIDS mi = 0;
 
-        /* The previous value we inserted. */
-        NIDS last_min = 0;
-        /* The next minimum we have found */
-        NIDS next_min = 0;
+        for (idl = idl_set->head; idl != NULL; idl = idl->next) {
+            idl->itr = 0;
+            idls[count++] = idl;
+        }
+        qsort(idls, count, sizeof(IDList *), idl_set_cmp_size);
+        min_idl = idls[0];
+        result_list = idl_alloc(min_idl->b_nids);
 
-        uint64_t finished = 0;
-        uint64_t quorum = 0;
+        while (mi < min_idl->b_nids) {
+            ID id = min_idl->b_ids[mi];
+            size_t k = 1;
 
-        while (idl_set->head != NULL) {
-            idl = idl_set->head;
-            /* now find the next smallest */
-            while (idl && finished == 0) {
-                /*
-                 * Did our head value get inserted last round?
-                 */
-                if (idl->b_ids[idl->itr] == last_min && last_min != 0) {
-                    /*
-                     * Our value was previously inserted - advance itr.
-                     */
-                    idl->itr += 1;
-                }
-                /*
-                 * Nothing left to search in this idl
-                 * itr should never be >, but lets be safe.
-                 */
+            for (; k < count; k++) {
+                idl = idls[k];
+                idl->itr = idl_gallop(idl, idl->itr, id);
                 if (idl->itr >= idl->b_nids) {
-                    /*
-                     * This is our base case: when we have emptied *one*
-                     * idl, intersections of the remaining values can never be
-                     * valid.
-                     */
-                    finished = 1;
-                    /*
-                     * ensure we don't insert, we're done.
-                     */
-                    quorum = 0;
-                } else {
-                    /*
-                     * Still data in IDLs
-                     */
-                    if (next_min == 0) {
-                        /* Must be head: so put our value as next_min */
-                        next_min = idl->b_ids[idl->itr];
-                    } else if (next_min < idl->b_ids[idl->itr]) {
-                        /*
-                         * Must be a diff id. mark it as skip, nothing can be
-                         * inserted this iteration.
-                         */
-                        quorum = 1;
-                        /*
-                         * Because this is our minimum value of this IDL, set the next_min
-                         * to it.
-                         */
-                        next_min = idl->b_ids[idl->itr];
-                    } else if (next_min > idl->b_ids[idl->itr]) {
-                        /*
-                         * We must be behind the next_min. We need to advance til we are
-                         * eq or greater.
-                         *
-                         * I tried optimising this to lookahead and jump by blocks of 256
-                         * or 64, and it made it slower. Probably not worth it :(
-                         */
-                        while (idl->itr < idl->b_nids && next_min > idl->b_ids[idl->itr]) {
-                            idl->itr += 1;
-                        }
-                        /*
-                         * Right, made it here. Are we out of ids?
-                         */
-                        if (idl->itr >= idl->b_nids) {
-                            finished = 1;
-                            quorum = 0;
-                        } else if (next_min < idl->b_ids[idl->itr]) {
-                            /* okay, we don't have next_min. Update and reset */
-                            next_min = idl->b_ids[idl->itr];
-                            quorum = 1;
-                        } else {
-                            /* Great! we match! */
-                            quorum += 1;
-                        }
-                    } else {
-                        /*
-                         * Must be in agreeance - this head is the next_min
-                         */
-                        quorum += 1;
-                    }
-                    /*
-                     * check if all the idls agree this is the smallest value
-                     * so we insert it!
-                     */
-                    if (next_min > 0 && quorum == idl_set->count) {
-                        idl_append(result_list, next_min);
-                        last_min = next_min;
-                        next_min = 0;
-                        quorum = 0;
-                    }
-                    /* Go to the next idl. */
-                    idl = idl->next;
+                    /* This idl is exhausted, no other id can match */
+                    mi = min_idl->b_nids;
+                    break;
                 }
-            }
-
-            if (finished) {
-                /*
-                 * We emptied an IDL - drain them all.
-                 */
-                IDList *idl_del = NULL;
-                idl = idl_set->head;
-                while (idl) {
-                    idl_del = idl;
-                    idl = idl_del->next;
-                    idl_free(&idl_del);
+                if (idl->b_ids[idl->itr] != id) {
+                    /* No id of the smallest idl below this one can match */
+                    mi = idl_gallop(min_idl, mi, idl->b_ids[idl->itr]);
+                    break;
                 }
-                idl_set->head = NULL;
             }
+            if (k == count) {
+                /* We have quorum! */
+                idl_append(result_list, id);
+                mi++;
+            }
+        }
+        slapi_ch_free((void **)&idls);
+
+        for (idl = idl_set->head; idl != NULL; idl = next_idl) {
+            next_idl = idl->next;
+            idl_free(&idl);
         }
+        idl_set->head = NULL;
     }
 
     /* Now, that we have the "smallest" intersection possible, we need to subtract
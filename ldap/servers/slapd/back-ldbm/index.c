@@ -23,6 +23,7 @@ static const char *errmsg = "database index operation failed";
 
 static int is_indexed(const char *indextype, int indexmask, char **index_rules);
 static int index_get_allids(int *allids, const char *indextype, struct attrinfo *ai, const struct berval *val, unsigned int flags);
+static void index_stats_record(Slapi_PBlock *pb, backend *be, char *type, const char *indextype, IDList *idl, int unindexed, struct timespec *start);
 
 static Slapi_Value **
 valuearray_minus_valuearray(
@@ -942,18 +943,8 @@ prepare_key(backend *be, struct attrinfo *a, char **buf, size_t *buflen,
 }
 
 
-/*
- * Extended version of index_read.
- * The unindexed flag can be used to distinguish between a
- * return of allids due to the attr not being indexed or
- * the value really being allids.
- * You can pass in the value of the allidslimit (aka idlistscanlimit)
- * with this version of the function
- * if the value is 0, it will use the old method of getting the value
- * from the attrinfo*.
- */
-IDList *
-index_read_ext_allids(
+static IDList *
+index_read_ext_allids_internal(
     Slapi_PBlock *pb,
     backend *be,
     char *type,
@@ -1177,6 +1168,244 @@ index_read_ext_allids(
     return (idl);
 }
 
+/*
+ * Extended version of index_read.
+ * The unindexed flag can be used to distinguish between a
+ * return of allids due to the attr not being indexed or
+ * the value really being allids.
+ * You can pass in the value of the allidslimit (aka idlistscanlimit)
+ * with this version of the function
+ * if the value is 0, it will use the old method of getting the value
+ * from the attrinfo*.
+ */
+IDList *
+index_read_ext_allids(
+    Slapi_PBlock *pb,
+    backend *be,
+    char *type,
+    const char *indextype,
+    const struct berval *val,
+    back_txn *txn,
+    int *err,
+    int *unindexed,
+    int allidslimit)
+{
+    struct ldbminfo *li = (struct ldbminfo *)be->be_database->plg_private;
+    struct timespec start;
+    int notindexed = 0;
+    IDList *idl;
+
+    if (!li->li_index_stats) {
+        return index_read_ext_allids_internal(pb, be, type, indextype, val, txn, err, unindexed, allidslimit);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    idl = index_read_ext_allids_internal(pb, be, type, indextype, val, txn, err, &notindexed, allidslimit);
+    index_stats_record(pb, be, type, indextype, idl, notindexed, &start);
+    if (unindexed != NULL) {
+        *unindexed = notindexed;
+    }
+    return idl;
+}
+
+/*
+ * Index key cardinality estimates, used by the filter planner (see
+ * list_candidates) to order and prune the components of AND filters.
+ *
+ * The number of ids under a key is read without fetching them: a cursor is
+ * positioned on the key and its duplicates are counted, which is cheap with
+ * both mdb_cursor_count and DBC->count. The counts are cached per index in a
+ * small direct mapped table and trusted for INDEX_ESTIMATE_TTL seconds. They
+ * only steer the planner, so a stale count costs time but never correctness.
+ */
+struct index_estimate
+{
+    char *ie_key;
+    size_t ie_keylen;
+    size_t ie_count;
+    time_t ie_stamp;
+};
+
+struct index_estimates
+{
+    pthread_mutex_t ies_lock;
+    struct index_estimate ies_slots[INDEX_ESTIMATE_SLOTS];
+};
+
+static struct index_estimates *
+index_estimates_get(struct attrinfo *ai)
+{
+    struct index_estimates *ies = __atomic_load_n(&ai->ai_estimates, __ATOMIC_ACQUIRE);
+    struct index_estimates *expected = NULL;
+
+    if (ies != NULL) {
+        return ies;
+    }
+    ies = (struct index_estimates *)slapi_ch_calloc(1, sizeof(struct index_estimates));
+    pthread_mutex_init(&ies->ies_lock, NULL);
+    if (!__atomic_compare_exchange_n(&ai->ai_estimates, &expected, ies, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        /* Another thread installed its table first */
+        index_estimates_free(&ies);
+        ies = expected;
+    }
+    return ies;
+}
+
+void
+index_estimates_free(struct index_estimates **ies)
+{
+    if (ies == NULL || *ies == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < INDEX_ESTIMATE_SLOTS; i++) {
+        slapi_ch_free_string(&(*ies)->ies_slots[i].ie_key);
+    }
+    pthread_mutex_destroy(&(*ies)->ies_lock);
+    slapi_ch_free((void **)ies);
+}
+
+static struct index_estimate *
+index_estimate_slot(struct index_estimates *ies, const dbi_val_t *key)
+{
+    const unsigned char *p = (const unsigned char *)key->data;
+    uint32_t hash = 2166136261U;
+
+    for (size_t i = 0; i < key->size; i++) {
+        hash = (hash ^ p[i]) * 16777619U;
+    }
+    return &ies->ies_slots[hash % INDEX_ESTIMATE_SLOTS];
+}
+
+/*
+ * index_read_estimate - estimate the number of ids index_read_ext_allids
+ * would return for the same arguments.
+ *
+ * Returns 0 and sets *count on success. Returns -1 when no estimate can be
+ * made: the attribute is not indexed for indextype, the index is configured
+ * not to be used, or the backend still uses the old idl format where the ids
+ * of a key are not stored as duplicates.
+ */
+int
+index_read_estimate(
+    backend *be,
+    char *type,
+    const char *indextype,
+    const struct berval *val,
+    back_txn *txn,
+    size_t *count)
+{
+    dbi_db_t *db = NULL;
+    dbi_txn_t *db_txn = NULL;
+    dbi_cursor_t cursor = {0};
+    dbi_val_t key = {0};
+    dbi_val_t data = {0};
+    dbi_recno_t recno = 0;
+    char buf[BUFSIZ];
+    char typebuf[SLAPD_TYPICAL_ATTRIBUTE_NAME_MAX_LENGTH];
+    char *basetmp, *basetype;
+    char *prefix = NULL;
+    struct attrinfo *ai = NULL;
+    struct index_estimates *ies = NULL;
+    struct index_estimate *slot = NULL;
+    int allidslimit = 0;
+    time_t now = slapi_current_rel_time_t();
+    int rc = -1;
+
+    if (!idl_get_idl_new()) {
+        return -1;
+    }
+    prefix = index_index2prefix(indextype);
+    if (prefix == NULL) {
+        return -1;
+    }
+    basetype = typebuf;
+    if ((basetmp = slapi_attr_basetype(type, typebuf, sizeof(typebuf))) != NULL) {
+        basetype = basetmp;
+    }
+    ainfo_get(be, basetype, &ai);
+    if (ai == NULL) {
+        goto done;
+    }
+    if (*prefix == '=' && (0 == PL_strcasecmp(basetype, LDBM_ENTRYDN_STR))) {
+        /* index_read_ext_allids answers this one from entryrdn */
+        *count = 1;
+        rc = 0;
+        goto done;
+    }
+    if (!is_indexed(indextype, ai->ai_indexmask, ai->ai_index_rules) ||
+        (index_get_allids(&allidslimit, indextype, ai, val, 0) && allidslimit == 0)) {
+        goto done;
+    }
+    if (dblayer_get_index_file(be, ai, &db, DBOPEN_CREATE) != 0) {
+        goto done;
+    }
+
+    if (val != NULL) {
+        if (prepare_key(be, ai, NULL, 0, 0, prefix, val, &key) != 0) {
+            goto release;
+        }
+    } else {
+        dblayer_value_concat(be, &key, buf, sizeof(buf), prefix, strlen(prefix),
+                             "", 1, NULL, 0);
+    }
+
+    ies = index_estimates_get(ai);
+    slot = index_estimate_slot(ies, &key);
+    pthread_mutex_lock(&ies->ies_lock);
+    if (slot->ie_key && slot->ie_keylen == key.size &&
+        memcmp(slot->ie_key, key.data, key.size) == 0 &&
+        now - slot->ie_stamp < INDEX_ESTIMATE_TTL) {
+        *count = slot->ie_count;
+        rc = 0;
+    }
+    pthread_mutex_unlock(&ies->ies_lock);
+    if (rc == 0) {
+        goto free_key;
+    }
+
+    if (NULL != txn) {
+        db_txn = txn->back_txn_txn;
+    }
+    if (dblayer_new_cursor(be, db, db_txn, &cursor) != 0) {
+        goto free_key;
+    }
+    dblayer_value_init(be, &data);
+    rc = dblayer_cursor_op(&cursor, DBI_OP_MOVE_TO_KEY, &key, &data);
+    if (rc == DBI_RC_NOTFOUND) {
+        recno = 0;
+        rc = 0;
+    } else if (rc == 0) {
+        rc = dblayer_cursor_get_count(&cursor, &recno);
+    }
+    dblayer_value_free(be, &data);
+    dblayer_cursor_op(&cursor, DBI_OP_CLOSE, NULL, NULL);
+    if (rc != 0) {
+        slapi_log_err(SLAPI_LOG_BACKLDBM, "index_read_estimate",
+                      "Could not count key %s in index %s: %d\n", (char *)key.data, basetype, rc);
+        rc = -1;
+        goto free_key;
+    }
+
+    *count = (size_t)recno;
+    pthread_mutex_lock(&ies->ies_lock);
+    if (slot->ie_keylen != key.size) {
+        slot->ie_key = slapi_ch_realloc(slot->ie_key, key.size);
+        slot->ie_keylen = key.size;
+    }
+    memcpy(slot->ie_key, key.data, key.size);
+    slot->ie_count = *count;
+    slot->ie_stamp = now;
+    pthread_mutex_unlock(&ies->ies_lock);
+
+free_key:
+    dblayer_value_free(be, &key);
+release:
+    dblayer_release_index_file(be, ai, db);
+done:
+    index_free_prefix(prefix);
+    slapi_ch_free_string(&basetmp);
+    return rc;
+}
+
 IDList *
 index_read_ext(
     backend *be,
@@ -1425,8 +1654,8 @@ static void set_range_limit(
 }
 
 
-IDList *
-index_range_read_ext(
+static IDList *
+index_range_read_ext_internal(
     Slapi_PBlock *pb,
     backend *be,
     char *type,
@@ -1438,6 +1667,7 @@ index_range_read_ext(
     int range,
     back_txn *txn,
     int *err,
+    int *unindexed,
     int allidslimit)
 {
     struct ldbminfo *li = (struct ldbminfo *)be->be_database->plg_private;
@@ -1529,6 +1759,7 @@ index_range_read_ext(
 
         /* Mark that the search has an unindexed component */
         slapi_pblock_set_flag_operation_notes(pb, SLAPI_OP_NOTE_UNINDEXED);
+        *unindexed = 1;
 
         idl = idl_allids(be);
         slapi_log_err(SLAPI_LOG_TRACE,
@@ -1573,6 +1804,7 @@ index_range_read_ext(
         if (rc == 0 && strncmp(hkey.data, hkeybuf, 2) == 0) {
             /* equality index hashed value found ==> unindexed search */
             slapi_pblock_set_flag_operation_notes(pb, SLAPI_OP_NOTE_UNINDEXED);
+            *unindexed = 1;
             dblayer_value_free(be, &hkey);
             idl = idl_allids(be);
             slapi_log_err(SLAPI_LOG_TRACE,
@@ -1830,8 +2062,8 @@ index_range_read_ext(
                 break;
             }
         }
-        /* sort idl */
-        if (idl && !ALLIDS(idl)) {
+        /* sort idl, a bitmap is always in order */
+        if (idl && !ALLIDS(idl) && !IDL_BITMAP(idl)) {
             qsort((void *)&idl->b_ids[0], idl->b_nids,
                   (size_t)sizeof(ID), idl_sort_cmp);
         }
@@ -1845,6 +2077,9 @@ index_range_read_ext(
     if (idl != NULL) {
         if (ALLIDS(idl)) {
             slapi_log_err(SLAPI_LOG_FILTER, "index_range_read_ext", "idl=ALLIDS\n");
+        } else if (IDL_BITMAP(idl)) {
+            slapi_log_err(SLAPI_LOG_FILTER,
+                          "index_range_read_ext", "idl=bitmap b_nids=%d\n", idl->b_nids);
         } else {
             slapi_log_err(SLAPI_LOG_FILTER,
                           "index_range_read_ext", "idl->b_nids=%d\n", idl->b_nids);
@@ -1871,6 +2106,35 @@ error:
     return (idl);
 }
 
+IDList *
+index_range_read_ext(
+    Slapi_PBlock *pb,
+    backend *be,
+    char *type,
+    const char *indextype,
+    int
+    operator,
+    struct berval *val,
+    struct berval *nextval,
+    int range,
+    back_txn *txn,
+    int *err,
+    int allidslimit)
+{
+    struct ldbminfo *li = (struct ldbminfo *)be->be_database->plg_private;
+    struct timespec start;
+    int notindexed = 0;
+    IDList *idl;
+
+    if (!li->li_index_stats) {
+        return index_range_read_ext_internal(pb, be, type, indextype, operator, val, nextval, range, txn, err, &notindexed, allidslimit);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    idl = index_range_read_ext_internal(pb, be, type, indextype, operator, val, nextval, range, txn, err, &notindexed, allidslimit);
+    index_stats_record(pb, be, type, indextype, idl, notindexed, &start);
+    return idl;
+}
+
 IDList *
 index_range_read(
     Slapi_PBlock *pb,
@@ -1888,6 +2152,285 @@ index_range_read(
     return index_range_read_ext(pb, be, type, indextype, operator, val, nextval, range, txn, err, 0);
 }
 
+/*
+ * Index usage statistics.
+ *
+ * Every index read is accounted to the attribute and index type it was made
+ * for: the number of reads, the ids they returned, how many returned ALLIDS
+ * and the time they took. Reads of an attribute that is not indexed for the
+ * requested type are counted apart, as they are the ones turning a search
+ * into a full scan. The reads made for a search are also remembered in its
+ * result set, so that index_stats_filter_test can count the searches that
+ * still had to run the filter test on the candidates of these indexes. The
+ * counters are only kept in memory and are published, with the advice
+ * derived from them, by ldbm_instance_index_stats_search.
+ */
+static int
+index_stats_slot(const char *indextype)
+{
+    if (strcmp(indextype, indextype_EQUALITY) == 0) {
+        return INDEX_STATS_EQ;
+    } else if (strcmp(indextype, indextype_PRESENCE) == 0) {
+        return INDEX_STATS_PRES;
+    } else if (strcmp(indextype, indextype_SUB) == 0) {
+        return INDEX_STATS_SUB;
+    } else if (strcmp(indextype, indextype_APPROX) == 0) {
+        return INDEX_STATS_APPROX;
+    }
+    return INDEX_STATS_RULES;
+}
+
+static struct index_stats *
+index_stats_get(struct attrinfo *ai)
+{
+    struct index_stats *iss = __atomic_load_n(&ai->ai_stats, __ATOMIC_ACQUIRE);
+    struct index_stats *expected = NULL;
+
+    if (iss != NULL) {
+        return iss;
+    }
+    iss = (struct index_stats *)slapi_ch_calloc(1, sizeof(struct index_stats));
+    if (!__atomic_compare_exchange_n(&ai->ai_stats, &expected, iss, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        /* Another thread installed its counters first */
+        index_stats_free(&iss);
+        iss = expected;
+    }
+    return iss;
+}
+
+/*
+ * Counters of an attribute that falls back on the default index
+ * configuration. The list only grows, up to INDEX_STATS_OTHER_MAX types,
+ * so the entries can be used without holding the lock.
+ */
+static struct index_stats *
+index_stats_get_other(ldbm_instance *inst, const char *type)
+{
+    struct index_stats_other *iso;
+    int count = 0;
+
+    PR_Lock(inst->inst_index_stats_mutex);
+    for (iso = inst->inst_index_stats_other; iso; iso = iso->iso_next, count++) {
+        if (strcasecmp(iso->iso_type, type) == 0) {
+            break;
+        }
+    }
+    if (iso == NULL && count < INDEX_STATS_OTHER_MAX) {
+        iso = (struct index_stats_other *)slapi_ch_calloc(1, sizeof(struct index_stats_other));
+        iso->iso_type = slapi_ch_strdup(type);
+        iso->iso_next = inst->inst_index_stats_other;
+        inst->inst_index_stats_other = iso;
+    }
+    PR_Unlock(inst->inst_index_stats_mutex);
+    return iso ? &iso->iso_stats : NULL;
+}
+
+static void
+index_stats_record(Slapi_PBlock *pb, backend *be, char *type, const char *indextype, IDList *idl, int unindexed, struct timespec *start)
+{
+    ldbm_instance *inst = (ldbm_instance *)be->be_instance_info;
+    back_search_result_set *sr = NULL;
+    struct index_stats *iss = NULL;
+    struct index_stat *is;
+    struct attrinfo *ai = NULL;
+    char typebuf[SLAPD_TYPICAL_ATTRIBUTE_NAME_MAX_LENGTH];
+    char *basetmp, *basetype;
+    struct timespec now;
+    uint64_t usec;
+
+    basetype = typebuf;
+    if ((basetmp = slapi_attr_basetype(type, typebuf, sizeof(typebuf))) != NULL) {
+        basetype = basetmp;
+    }
+    ainfo_get(be, basetype, &ai);
+    if (ai == NULL) {
+        slapi_ch_free_string(&basetmp);
+        return;
+    }
+    if (strcmp(ai->ai_type, LDBM_PSEUDO_ATTR_DEFAULT) == 0) {
+        iss = index_stats_get_other(inst, basetype);
+    } else {
+        iss = index_stats_get(ai);
+    }
+    slapi_ch_free_string(&basetmp);
+    if (iss == NULL) {
+        return;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    usec = (uint64_t)(now.tv_sec - start->tv_sec) * 1000000 +
+           (now.tv_nsec - start->tv_nsec) / 1000;
+
+    is = &iss->iss_types[index_stats_slot(indextype)];
+    __atomic_add_fetch(&is->is_lookups, 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&is->is_usec, usec, __ATOMIC_RELAXED);
+    if (unindexed) {
+        __atomic_add_fetch(&is->is_unindexed, 1, __ATOMIC_RELAXED);
+    } else if (idl != NULL && ALLIDS(idl)) {
+        __atomic_add_fetch(&is->is_allids, 1, __ATOMIC_RELAXED);
+    } else if (idl != NULL) {
+        __atomic_add_fetch(&is->is_candidates, IDL_NIDS(idl), __ATOMIC_RELAXED);
+    }
+
+    /* Remember the index for the filter test decision of the search */
+    if (pb != NULL) {
+        slapi_pblock_get(pb, SLAPI_SEARCH_RESULT_SET, &sr);
+    }
+    if (sr != NULL && sr->sr_index_stats_count < INDEX_STATS_SEARCH_MAX) {
+        for (size_t i = 0; i < sr->sr_index_stats_count; i++) {
+            if (sr->sr_index_stats[i] == is) {
+                return;
+            }
+        }
+        sr->sr_index_stats[sr->sr_index_stats_count++] = is;
+    }
+}
+
+/*
+ * The candidates of the search could not be trusted as they are and each of
+ * them goes through the filter test: count it against every index read to
+ * build them.
+ */
+void
+index_stats_filter_test(back_search_result_set *sr)
+{
+    for (size_t i = 0; i < sr->sr_index_stats_count; i++) {
+        __atomic_add_fetch(&sr->sr_index_stats[i]->is_filtertest, 1, __ATOMIC_RELAXED);
+    }
+    sr->sr_index_stats_count = 0;
+}
+
+void
+index_stats_free(struct index_stats **iss)
+{
+    slapi_ch_free((void **)iss);
+}
+
+void
+index_stats_instance_free(ldbm_instance *inst)
+{
+    struct index_stats_other *iso = inst->inst_index_stats_other;
+
+    while (iso) {
+        struct index_stats_other *next = iso->iso_next;
+        slapi_ch_free_string(&iso->iso_type);
+        slapi_ch_free((void **)&iso);
+        iso = next;
+    }
+    inst->inst_index_stats_other = NULL;
+}
+
+static const char *index_stats_names[INDEX_STATS_TYPES] = {"pres", "eq", "approx", "sub", "matchingrule"};
+
+struct index_stats_report
+{
+    Slapi_Entry *isr_entry;
+    int isr_count;
+};
+
+static void
+index_stats_report_one(struct index_stats_report *isr, const char *type, struct index_stats *iss, int indexmask)
+{
+    Slapi_Entry *e = isr->isr_entry;
+    char atype[64];
+    char buf[BUFSIZ];
+
+    for (size_t i = 0; i < INDEX_STATS_TYPES; i++) {
+        struct index_stat is;
+
+        is.is_lookups = __atomic_load_n(&iss->iss_types[i].is_lookups, __ATOMIC_RELAXED);
+        if (is.is_lookups == 0) {
+            continue;
+        }
+        is.is_candidates = __atomic_load_n(&iss->iss_types[i].is_candidates, __ATOMIC_RELAXED);
+        is.is_allids = __atomic_load_n(&iss->iss_types[i].is_allids, __ATOMIC_RELAXED);
+        is.is_unindexed = __atomic_load_n(&iss->iss_types[i].is_unindexed, __ATOMIC_RELAXED);
+        is.is_usec = __atomic_load_n(&iss->iss_types[i].is_usec, __ATOMIC_RELAXED);
+        is.is_filtertest = __atomic_load_n(&iss->iss_types[i].is_filtertest, __ATOMIC_RELAXED);
+
+#define INDEX_STATS_SET(_attr, _fmt, _val)                             \
+    do {                                                              \
+        snprintf(atype, sizeof(atype), _attr "-%d", isr->isr_count);  \
+        snprintf(buf, sizeof(buf), _fmt, _val);                       \
+        slapi_entry_attr_set_charptr(e, atype, buf);                  \
+    } while (0)
+
+        INDEX_STATS_SET("indexName", "%s", type);
+        INDEX_STATS_SET("indexType", "%s", index_stats_names[i]);
+        INDEX_STATS_SET("indexLookups", "%" PRIu64, is.is_lookups);
+        INDEX_STATS_SET("indexCandidates", "%" PRIu64, is.is_candidates);
+        INDEX_STATS_SET("indexAllIds", "%" PRIu64, is.is_allids);
+        INDEX_STATS_SET("indexUnindexed", "%" PRIu64, is.is_unindexed);
+        INDEX_STATS_SET("indexFilterTests", "%" PRIu64, is.is_filtertest);
+        INDEX_STATS_SET("indexTimeUsec", "%" PRIu64, is.is_usec);
+#undef INDEX_STATS_SET
+
+        if (is.is_unindexed > 0) {
+            snprintf(buf, sizeof(buf),
+                     "%s: missing %s index, %" PRIu64 " unindexed lookups",
+                     type, index_stats_names[i], is.is_unindexed);
+            slapi_entry_add_string(e, "indexAdvice", buf);
+        } else if (indexmask && is.is_lookups >= INDEX_STATS_ADVICE_MIN_LOOKUPS &&
+                   is.is_allids * 100 >= is.is_lookups * INDEX_STATS_ADVICE_ALLIDS_PCT) {
+            snprintf(buf, sizeof(buf),
+                     "%s: %s index returned allids for %" PRIu64 " of %" PRIu64 " lookups",
+                     type, index_stats_names[i], is.is_allids, is.is_lookups);
+            slapi_entry_add_string(e, "indexAdvice", buf);
+        }
+        isr->isr_count++;
+    }
+}
+
+static int32_t
+index_stats_report_attr(caddr_t data, caddr_t arg)
+{
+    struct attrinfo *ai = (struct attrinfo *)data;
+    struct index_stats *iss = __atomic_load_n(&ai->ai_stats, __ATOMIC_ACQUIRE);
+
+    if (iss != NULL) {
+        index_stats_report_one((struct index_stats_report *)arg, ai->ai_type, iss, ai->ai_indexmask);
+    }
+    return 0;
+}
+
+/*
+ * Search callback of cn=index-stats,cn=<instance>: one numbered set of
+ * indexName-N, indexType-N and counters per attribute and index type that
+ * has been read, and an indexAdvice value for each index that is missing or
+ * that does not narrow the searches using it.
+ */
+int
+ldbm_instance_index_stats_search(Slapi_PBlock *pb __attribute__((unused)),
+                                 Slapi_Entry *e,
+                                 Slapi_Entry *entryAfter __attribute__((unused)),
+                                 int *returncode,
+                                 char *returntext __attribute__((unused)),
+                                 void *arg)
+{
+    ldbm_instance *inst = (ldbm_instance *)arg;
+    struct index_stats_report isr = {e, 0};
+    struct index_stats_other *iso;
+    char buf[32];
+
+    /* an index deleted meanwhile would free its stats under us */
+    PR_Lock(inst->inst_attrs_mutex);
+    avl_apply(inst->inst_attrs, index_stats_report_attr, (caddr_t)&isr, -1, AVL_INORDER);
+    PR_Unlock(inst->inst_attrs_mutex);
+
+    PR_Lock(inst->inst_index_stats_mutex);
+    iso = inst->inst_index_stats_other;
+    PR_Unlock(inst->inst_index_stats_mutex);
+    for (; iso; iso = iso->iso_next) {
+        index_stats_report_one(&isr, iso->iso_type, &iso->iso_stats, 0);
+    }
+
+    snprintf(buf, sizeof(buf), "%d", isr.isr_count);
+    slapi_entry_attr_set_charptr(e, "indexCount", buf);
+
+    *returncode = LDAP_SUCCESS;
+    return SLAPI_DSE_CALLBACK_OK;
+}
+
 
 static int
 addordel_values_sv(
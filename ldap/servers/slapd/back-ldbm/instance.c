@@ -91,6 +91,18 @@ ldbm_instance_create(backend *be, char *name)
         goto error;
     }
 
+    if ((inst->inst_index_stats_mutex = PR_NewLock()) == NULL) {
+        slapi_log_err(SLAPI_LOG_ERR, "ldbm_instance_create", "PR_NewLock failed\n");
+        rc = -1;
+        goto error;
+    }
+
+    if ((inst->inst_attrs_mutex = PR_NewLock()) == NULL) {
+        slapi_log_err(SLAPI_LOG_ERR, "ldbm_instance_create", "PR_NewLock failed\n");
+        rc = -1;
+        goto error;
+    }
+
     /* Keeps track of how many operations are currently using this instance */
     inst->inst_ref_count = slapi_counter_new();
 
@@ -657,6 +669,9 @@ ldbm_instance_destructor(void **arg)
     PR_DestroyLock(inst->inst_nextid_mutex);
     PR_DestroyCondVar(inst->inst_indexer_cv);
     attrinfo_deletetree(inst);
+    index_stats_instance_free(inst);
+    PR_DestroyLock(inst->inst_index_stats_mutex);
+    PR_DestroyLock(inst->inst_attrs_mutex);
     slapi_ch_free((void **)&inst->inst_dataversion);
     slapi_ch_free_string(&inst->cache_debug_pattern);
     slapi_re_free(inst->cache_debug_re);
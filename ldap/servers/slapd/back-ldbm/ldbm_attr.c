@@ -58,6 +58,8 @@ attrinfo_delete(struct attrinfo **pp)
         slapi_ch_free((void **)&((*pp)->ai_attrcrypt));
         attr_done(&((*pp)->ai_sattr));
         attrinfo_delete_idlistinfo(&(*pp)->ai_idlistinfo);
+        index_estimates_free(&(*pp)->ai_estimates);
+        index_stats_free(&(*pp)->ai_stats);
         if ((*pp)->ai_dblayer) {
             /* attriinfo is deleted.  Cleaning up the backpointer at the same time. */
             ((dblayer_handle *)((*pp)->ai_dblayer))->dblayer_handle_ai_backpointer = NULL;
@@ -105,7 +107,9 @@ void
 attrinfo_delete_from_tree(backend *be, struct attrinfo *ai)
 {
     ldbm_instance *inst = (ldbm_instance *)be->be_instance_info;
+    PR_Lock(inst->inst_attrs_mutex);
     avl_delete(&inst->inst_attrs, (caddr_t)ai, ainfo_cmp);
+    PR_Unlock(inst->inst_attrs_mutex);
 }
 
 /*
@@ -682,6 +686,7 @@ attr_index_config(
     int mr_count = 0;
     char myreturntext[SLAPI_DSE_RETURNTEXT_SIZE];
     int substrval = 0;
+    int dup = 0;
 
     /* Get the cn */
     if (0 == slapi_entry_attr_find(e, "cn", &attr)) {
@@ -777,6 +782,7 @@ attr_index_config(
      * nsSubStrBegin: 2
      * nsSubStrMiddle: 2
      * nsSubStrEnd: 2
+     * nsSubStrPositions: 4
      */
     substrval = slapi_entry_attr_get_int(e, INDEX_ATTR_SUBSTRBEGIN);
     if (substrval) {
@@ -797,6 +803,13 @@ attr_index_config(
         }
         substrlens[INDEX_SUBSTREND] = substrval;
     }
+    substrval = slapi_entry_attr_get_int(e, INDEX_ATTR_SUBSTRPOSITIONS);
+    if (substrval) {
+        if (!substrlens) {
+            substrlens = (int *)slapi_ch_calloc(1, sizeof(int) * INDEX_SUBSTRLEN);
+        }
+        substrlens[INDEX_SUBSTRPOSITIONS] = substrval;
+    }
     a->ai_substr_lens = substrlens;
 
     if (0 == slapi_entry_attr_find(e, "nsMatchingRule", &attr)) {
@@ -819,6 +832,7 @@ attr_index_config(
              *   nsMatchingRule: nsSubstrBegin=2
              *   nsMatchingRule: nsSubstrMiddle=2
              *   nsMatchingRule: nsSubstrEnd=2
+             *   nsMatchingRule: nsSubstrPositions=4
              */
             if (PL_strcasestr(attrValue->bv_val, INDEX_ATTR_SUBSTRBEGIN)) {
                 if (!a->ai_substr_lens || !a->ai_substr_lens[INDEX_SUBSTRBEGIN]) {
@@ -838,6 +852,12 @@ attr_index_config(
                 }
                 do_continue = 1; /* done with j - next j */
             }
+            if (PL_strcasestr(attrValue->bv_val, INDEX_ATTR_SUBSTRPOSITIONS)) {
+                if (!a->ai_substr_lens || !a->ai_substr_lens[INDEX_SUBSTRPOSITIONS]) {
+                    _set_attr_substrlen(INDEX_SUBSTRPOSITIONS, attrValue->bv_val, &substrlens);
+                }
+                do_continue = 1; /* done with j - next j */
+            }
             /* check if this is a simple ordering specification
                for an attribute that has no ordering matching rule */
             if (slapi_matchingrule_is_ordering(attrValue->bv_val, attrsyntax_oid) &&
@@ -905,6 +925,16 @@ attr_index_config(
             slapi_ch_free((void **)&official_rules);
         }
     }
+    /* the offset modulo is a single hex digit of the keys */
+    if (a->ai_substr_lens && a->ai_substr_lens[INDEX_SUBSTRPOSITIONS] &&
+        (a->ai_substr_lens[INDEX_SUBSTRPOSITIONS] < 2 ||
+         a->ai_substr_lens[INDEX_SUBSTRPOSITIONS] > INDEX_SUBSTRPOS_MAX)) {
+        slapi_log_err(SLAPI_LOG_WARNING, "attr_index_config", "%s: line %d: "
+                      "%s must be between 2 and %d, got %d (ignored)\n",
+                      fname, lineno, INDEX_ATTR_SUBSTRPOSITIONS, INDEX_SUBSTRPOS_MAX,
+                      a->ai_substr_lens[INDEX_SUBSTRPOSITIONS]);
+        a->ai_substr_lens[INDEX_SUBSTRPOSITIONS] = 0;
+    }
     if ((return_value = attr_index_idlistsize_config(e, a, myreturntext))) {
         slapi_create_errormsg(err_buf, SLAPI_DSE_RETURNTEXT_SIZE,
                               "Error: %s: Failed to parse idscanlimit info: %d:%s\n",
@@ -947,7 +977,10 @@ attr_index_config(
         }
     }
 
-    if (avl_insert(&inst->inst_attrs, (caddr_t)a, ainfo_cmp, ainfo_dup) != 0) {
+    PR_Lock(inst->inst_attrs_mutex);
+    dup = avl_insert(&inst->inst_attrs, (caddr_t)a, ainfo_cmp, ainfo_dup);
+    PR_Unlock(inst->inst_attrs_mutex);
+    if (dup != 0) {
         /* duplicate - existing version updated */
         attrinfo_delete(&a);
     }
@@ -968,9 +1001,14 @@ attr_create_empty(backend *be, char *type, struct attrinfo **ai)
 {
     ldbm_instance *inst = (ldbm_instance *)be->be_instance_info;
     struct attrinfo *a = attrinfo_new();
+    int rc;
+
     slapi_attr_init(&a->ai_sattr, type);
     a->ai_type = slapi_ch_strdup(type);
-    if (avl_insert(&inst->inst_attrs, (caddr_t)a, ainfo_cmp, ainfo_dup) != 0) {
+    PR_Lock(inst->inst_attrs_mutex);
+    rc = avl_insert(&inst->inst_attrs, (caddr_t)a, ainfo_cmp, ainfo_dup);
+    PR_Unlock(inst->inst_attrs_mutex);
+    if (rc != 0) {
         /* duplicate - existing version updated */
         attrinfo_delete(&a);
         ainfo_get(be, type, &a);
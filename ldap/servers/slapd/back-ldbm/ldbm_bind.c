@@ -84,7 +84,7 @@ ldbm_back_bind(Slapi_PBlock *pb)
         }
         bvals = attr_get_present_values(attr);
         slapi_value_init_berval(&cv, cred);
-        if (slapi_pw_find_sv(bvals, &cv) != 0) {
+        if (slapi_pw_verify_sv(slapi_entry_get_ndn(e->ep_entry), bvals, &cv) != 0) {
             slapi_pblock_set(pb, SLAPI_PB_RESULT_TEXT, "Invalid credentials");
             slapi_send_ldap_result(pb, LDAP_INVALID_CREDENTIALS, NULL, NULL, 0, NULL);
             CACHE_RETURN(&inst->inst_cache, &e);
@@ -1058,6 +1058,153 @@ ldbm_config_dynamic_lists_url_attr_get(void *arg)
     return (void *)slapi_ch_strdup(li->li_dynamic_lists_url_attr);
 }
 
+static int
+ldbm_config_id2entry_binary_set(void *arg, void *value, char *errorbuf __attribute__((unused)), int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int val = (int)((uintptr_t)value);
+
+    if (apply) {
+        li->li_id2entry_binary = val;
+    }
+    return LDAP_SUCCESS;
+}
+
+static void *
+ldbm_config_id2entry_binary_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)li->li_id2entry_binary);
+}
+
+static int
+ldbm_config_idl_bitmap_threshold_set(void *arg, void *value, char *errorbuf, int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int val = (int)((uintptr_t)value);
+
+    if (val < 0) {
+        slapi_create_errormsg(errorbuf, SLAPI_DSE_RETURNTEXT_SIZE,
+                              "Invalid value for %s (%d). Must be 0 (disabled) or a positive number of ids",
+                              CONFIG_IDL_BITMAP_THRESHOLD, val);
+        slapi_log_err(SLAPI_LOG_ERR, "ldbm_config_idl_bitmap_threshold_set",
+                      "Invalid value for %s (%d). Must be 0 (disabled) or a positive number of ids\n",
+                      CONFIG_IDL_BITMAP_THRESHOLD, val);
+        return LDAP_UNWILLING_TO_PERFORM;
+    }
+    if (apply) {
+        li->li_idl_bitmap_threshold = val;
+    }
+    return LDAP_SUCCESS;
+}
+
+static void *
+ldbm_config_idl_bitmap_threshold_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)li->li_idl_bitmap_threshold);
+}
+
+static int
+ldbm_config_filter_planner_set(void *arg, void *value, char *errorbuf __attribute__((unused)), int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int val = (int)((uintptr_t)value);
+
+    if (apply) {
+        li->li_filter_planner = val;
+    }
+    return LDAP_SUCCESS;
+}
+
+static void *
+ldbm_config_filter_planner_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)li->li_filter_planner);
+}
+
+static int
+ldbm_config_index_stats_set(void *arg, void *value, char *errorbuf __attribute__((unused)), int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int val = (int)((uintptr_t)value);
+
+    if (apply) {
+        li->li_index_stats = val;
+    }
+    return LDAP_SUCCESS;
+}
+
+static void *
+ldbm_config_index_stats_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)li->li_index_stats);
+}
+
+static int
+ldbm_config_search_scan_threads_set(void *arg, void *value, char *errorbuf, int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int val = (int)((uintptr_t)value);
+
+    if (val < 0 || val > 256) {
+        slapi_create_errormsg(errorbuf, SLAPI_DSE_RETURNTEXT_SIZE,
+                              "Invalid value for %s (%d). Must be between 0 (disabled) and 256",
+                              CONFIG_SEARCH_SCAN_THREADS, val);
+        slapi_log_err(SLAPI_LOG_ERR, "ldbm_config_search_scan_threads_set",
+                      "Invalid value for %s (%d). Must be between 0 (disabled) and 256\n",
+                      CONFIG_SEARCH_SCAN_THREADS, val);
+        return LDAP_UNWILLING_TO_PERFORM;
+    }
+    if (apply) {
+        li->li_search_scan_threads = val;
+    }
+    return LDAP_SUCCESS;
+}
+
+static void *
+ldbm_config_search_scan_threads_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)li->li_search_scan_threads);
+}
+
+static int
+ldbm_config_search_scan_min_candidates_set(void *arg, void *value, char *errorbuf, int phase __attribute__((unused)), int apply)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+    int val = (int)((uintptr_t)value);
+
+    if (val < 0) {
+        slapi_create_errormsg(errorbuf, SLAPI_DSE_RETURNTEXT_SIZE,
+                              "Invalid value for %s (%d). Must be 0 or a positive number of candidates",
+                              CONFIG_SEARCH_SCAN_MIN_CANDIDATES, val);
+        slapi_log_err(SLAPI_LOG_ERR, "ldbm_config_search_scan_min_candidates_set",
+                      "Invalid value for %s (%d). Must be 0 or a positive number of candidates\n",
+                      CONFIG_SEARCH_SCAN_MIN_CANDIDATES, val);
+        return LDAP_UNWILLING_TO_PERFORM;
+    }
+    if (apply) {
+        li->li_search_scan_min_candidates = val;
+    }
+    return LDAP_SUCCESS;
+}
+
+static void *
+ldbm_config_search_scan_min_candidates_get(void *arg)
+{
+    struct ldbminfo *li = (struct ldbminfo *)arg;
+
+    return (void *)((uintptr_t)li->li_search_scan_min_candidates);
+}
+
 /*------------------------------------------------------------------------
  * Configuration array for ldbm and dblayer variables
  *----------------------------------------------------------------------*/
@@ -1090,6 +1237,12 @@ static config_info ldbm_config[] = {
     {CONFIG_DYNAMIC_LISTS_ATTR, CONFIG_TYPE_STRING, "member", &ldbm_config_dynamic_lists_attr_get, &ldbm_config_dynamic_lists_attr_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
     {CONFIG_DYNAMIC_LISTS_OC, CONFIG_TYPE_STRING, "groupOfUrls", &ldbm_config_dynamic_lists_oc_get, &ldbm_config_dynamic_lists_oc_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
     {CONFIG_DYNAMIC_LISTS_URL_ATTR, CONFIG_TYPE_STRING, "memberURL", &ldbm_config_dynamic_lists_url_attr_get, &ldbm_config_dynamic_lists_url_attr_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
+    {CONFIG_ID2ENTRY_BINARY_FORMAT, CONFIG_TYPE_ONOFF, "off", &ldbm_config_id2entry_binary_get, &ldbm_config_id2entry_binary_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
+    {CONFIG_IDL_BITMAP_THRESHOLD, CONFIG_TYPE_INT, "4096", &ldbm_config_idl_bitmap_threshold_get, &ldbm_config_idl_bitmap_threshold_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
+    {CONFIG_FILTER_PLANNER, CONFIG_TYPE_ONOFF, "on", &ldbm_config_filter_planner_get, &ldbm_config_filter_planner_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
+    {CONFIG_INDEX_STATS, CONFIG_TYPE_ONOFF, "on", &ldbm_config_index_stats_get, &ldbm_config_index_stats_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
+    {CONFIG_SEARCH_SCAN_THREADS, CONFIG_TYPE_INT, "0", &ldbm_config_search_scan_threads_get, &ldbm_config_search_scan_threads_set, CONFIG_FLAG_ALWAYS_SHOW},
+    {CONFIG_SEARCH_SCAN_MIN_CANDIDATES, CONFIG_TYPE_INT, "10000", &ldbm_config_search_scan_min_candidates_get, &ldbm_config_search_scan_min_candidates_set, CONFIG_FLAG_ALWAYS_SHOW | CONFIG_FLAG_ALLOW_RUNNING_CHANGE},
     {NULL, 0, NULL, NULL, NULL, 0}};
 
 void
@@ -151,6 +151,13 @@ struct config_info
 #define CONFIG_DYNAMIC_LISTS_OC "nsslapd-dynamic-lists-oc"
 #define CONFIG_DYNAMIC_LISTS_URL_ATTR "nsslapd-dynamic-lists-url-attr"
 
+#define CONFIG_ID2ENTRY_BINARY_FORMAT "nsslapd-id2entry-binary-format"
+#define CONFIG_IDL_BITMAP_THRESHOLD "nsslapd-idl-bitmap-threshold"
+#define CONFIG_FILTER_PLANNER "nsslapd-filter-planner"
+#define CONFIG_INDEX_STATS "nsslapd-index-stats"
+#define CONFIG_SEARCH_SCAN_THREADS "nsslapd-search-scan-threads"
+#define CONFIG_SEARCH_SCAN_MIN_CANDIDATES "nsslapd-search-scan-min-candidates"
+
 #define LDBM_INSTANCE_CONFIG_DONT_WRITE 1
 
 /* Some fuctions in ldbm_config.c used by ldbm_instance_config.c */
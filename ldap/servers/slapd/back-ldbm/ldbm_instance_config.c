@@ -47,6 +47,11 @@ static char *ldbm_instance_skeleton_entries[] =
         "objectclass:extensibleObject\n"
         "cn:encrypted attribute keys\n",
 
+        "dn:cn=index-stats, cn=%s, cn=%s, cn=plugins, cn=config\n"
+        "objectclass:top\n"
+        "objectclass:extensibleObject\n"
+        "cn:index-stats\n",
+
         ""};
 
 
@@ -815,6 +820,29 @@ ldbm_instance_config_load_dse_info(ldbm_instance *inst)
     slapi_config_register_callback(SLAPI_OPERATION_MODIFY, DSE_FLAG_PREOP, dn,
                                    LDAP_SCOPE_SUBTREE, ldbm_instance_attrcrypt_filter,
                                    ldbm_instance_attrcrypt_config_modify_callback, (void *)inst);
+    slapi_ch_free_string(&dn);
+
+    /* Callbacks to publish the index usage statistics */
+    dn = slapi_create_dn_string("cn=index-stats,cn=%s,cn=%s,cn=plugins,cn=config",
+                                inst->inst_name, li->li_plugin->plg_name);
+    if (NULL == dn) {
+        slapi_log_err(SLAPI_LOG_ERR,
+                      "ldbm_instance_config_load_dse_info",
+                      "failed create index stats dn for plugin %s, "
+                      "instance %s\n",
+                      inst->inst_li->li_plugin->plg_name, inst->inst_name);
+        rval = 1;
+        goto bail;
+    }
+    slapi_config_register_callback(SLAPI_OPERATION_SEARCH, DSE_FLAG_PREOP, dn,
+                                   LDAP_SCOPE_BASE, "(objectclass=*)",
+                                   ldbm_instance_index_stats_search, (void *)inst);
+    slapi_config_register_callback(SLAPI_OPERATION_ADD, DSE_FLAG_PREOP, dn,
+                                   LDAP_SCOPE_BASE, "(objectclass=*)",
+                                   ldbm_instance_deny_config, (void *)inst);
+    slapi_config_register_callback(SLAPI_OPERATION_MODIFY, DSE_FLAG_PREOP, dn,
+                                   LDAP_SCOPE_BASE, "(objectclass=*)",
+                                   ldbm_instance_deny_config, (void *)inst);
     rval = 0;
 bail:
     slapi_ch_free_string(&dn);
@@ -1092,6 +1120,28 @@ ldbm_instance_unregister_callbacks(ldbm_instance *inst)
     slapi_config_remove_callback(SLAPI_OPERATION_MODIFY, DSE_FLAG_PREOP, dn,
                                  LDAP_SCOPE_SUBTREE, ldbm_instance_attrcrypt_filter,
                                  ldbm_instance_attrcrypt_config_modify_callback);
+    slapi_ch_free_string(&dn);
+
+    /* now the cn=index-stats entry */
+    dn = slapi_create_dn_string("cn=index-stats,cn=%s,cn=%s,cn=plugins,cn=config",
+                                inst->inst_name, li->li_plugin->plg_name);
+    if (NULL == dn) {
+        slapi_log_err(SLAPI_LOG_ERR,
+                      "ldbm_instance_unregister_callbacks",
+                      "failed create index stats dn for plugin %s, "
+                      "instance %s\n",
+                      inst->inst_li->li_plugin->plg_name, inst->inst_name);
+        goto bail;
+    }
+    slapi_config_remove_callback(SLAPI_OPERATION_SEARCH, DSE_FLAG_PREOP, dn,
+                                 LDAP_SCOPE_BASE, "(objectclass=*)",
+                                 ldbm_instance_index_stats_search);
+    slapi_config_remove_callback(SLAPI_OPERATION_ADD, DSE_FLAG_PREOP, dn,
+                                 LDAP_SCOPE_BASE, "(objectclass=*)",
+                                 ldbm_instance_deny_config);
+    slapi_config_remove_callback(SLAPI_OPERATION_MODIFY, DSE_FLAG_PREOP, dn,
+                                 LDAP_SCOPE_BASE, "(objectclass=*)",
+                                 ldbm_instance_deny_config);
 
     vlv_remove_callbacks(inst);
 bail:
@@ -358,91 +358,23 @@ ldbm_back_search_cleanup(Slapi_PBlock *pb,
 static int
 ldbm_search_compile_filter(Slapi_Filter *f, void *arg __attribute__((unused)))
 {
-    int rc = SLAPI_FILTER_SCAN_CONTINUE;
-    if (f->f_choice == LDAP_FILTER_SUBSTRINGS) {
-        char pat[BUFSIZ];
-        char *p, *end, *bigpat = NULL;
-        size_t size = 0;
-        Slapi_Regex *re = NULL;
-        char *re_result = NULL;
-        int i = 0;
-
-        PR_ASSERT(NULL == f->f_un.f_un_sub.sf_private);
-        /*
-         * construct a regular expression corresponding to the filter
-         */
-        pat[0] = '\0';
-        p = pat;
-        end = pat + sizeof(pat) - 2; /* leave room for null */
-
-        if (f->f_sub_initial != NULL) {
-            size = strlen(f->f_sub_initial) + 1; /* add 1 for "^" */
-        }
-
-        while (f->f_sub_any && f->f_sub_any[i]) {
-            size += strlen(f->f_sub_any[i++]) + 2; /* add 2 for ".*" */
-        }
-
-        if (f->f_sub_final != NULL) {
-            size += strlen(f->f_sub_final) + 3; /* add 3 for ".*" and "$" */
-        }
-
-        size *= 2; /* doubled in case all filter chars need escaping (regex special chars) */
-        size++;    /* add 1 for null */
-
-        if (p + size > end) {
-            bigpat = slapi_ch_malloc(size);
-            p = bigpat;
-        }
-        if (f->f_sub_initial != NULL) {
-            *p++ = '^';
-            p = filter_strcpy_special_ext(p, f->f_sub_initial, FILTER_STRCPY_ESCAPE_RECHARS);
-        }
-        for (i = 0; f->f_sub_any && f->f_sub_any[i]; i++) {
-            /* ".*" + value */
-            *p++ = '.';
-            *p++ = '*';
-            p = filter_strcpy_special_ext(p, f->f_sub_any[i], FILTER_STRCPY_ESCAPE_RECHARS);
-        }
-        if (f->f_sub_final != NULL) {
-            /* ".*" + value */
-            *p++ = '.';
-            *p++ = '*';
-            p = filter_strcpy_special_ext(p, f->f_sub_final, FILTER_STRCPY_ESCAPE_RECHARS);
-            strcat(p, "$");
-        }
-
-        /* compile the regex */
-        p = bigpat ? bigpat : pat;
-        re = slapi_re_comp(p, &re_result);
-        if (NULL == re) {
-            slapi_log_err(SLAPI_LOG_ERR, "ldbm_search_compile_filter", "re_comp (%s) failed (%s): %s\n",
-                          pat, p, re_result ? re_result : "unknown");
-            slapi_ch_free_string(&re_result);
-            rc = SLAPI_FILTER_SCAN_ERROR;
-        } else {
-            char ebuf[BUFSIZ];
-            slapi_log_err(SLAPI_LOG_TRACE, "ldbm_search_compile_filter", "re_comp (%s)\n",
-                          escape_string(p, ebuf));
-            f->f_un.f_un_sub.sf_private = (void *)re;
-        }
-    } else if (f->f_choice == LDAP_FILTER_EQUALITY) {
+    /*
+     * Substring filters are matched directly by the string syntax
+     * (string_filter_sub), so there is no regex to precompile here.
+     */
+    if (f->f_choice == LDAP_FILTER_EQUALITY) {
         /* store the flags in the ava_private - should be ok - points
            to itself - no dangling references */
         f->f_un.f_un_ava.ava_private = &f->f_flags;
     }
-    return rc;
+    return SLAPI_FILTER_SCAN_CONTINUE;
 }
 
 static int
 ldbm_search_free_compiled_filter(Slapi_Filter *f, void *arg __attribute__((unused)))
 {
     int rc = SLAPI_FILTER_SCAN_CONTINUE;
-    if ((f->f_choice == LDAP_FILTER_SUBSTRINGS) &&
-        (f->f_un.f_un_sub.sf_private)) {
-        slapi_re_free((Slapi_Regex *)f->f_un.f_un_sub.sf_private);
-        f->f_un.f_un_sub.sf_private = NULL;
-    } else if (f->f_choice == LDAP_FILTER_EQUALITY) {
+    if (f->f_choice == LDAP_FILTER_EQUALITY) {
         /* clear the flags in the ava_private */
         f->f_un.f_un_ava.ava_private = NULL;
     }
@@ -496,6 +428,7 @@ ldbm_back_search(Slapi_PBlock *pb)
     /* end Fix for defect #394184 */
 
     int lookup_returned_allids = 0;
+    int filter_bypassed = 0;
     int backend_count = 1;
     static int print_once = 1;
     back_txn txn = {NULL};
@@ -910,6 +843,8 @@ ldbm_back_search(Slapi_PBlock *pb)
                          * input to ldapsearch> <#candidates> | <unsortable> */
                         sort_log_access(pb, sort_control, candidates, PR_FALSE);
                     }
+                    /* the sort reorders b_ids in place */
+                    idl_expand(&candidates);
                     sort_return_value = sort_candidates(be, lookthrough_limit,
                                                         &expire_time, pb, candidates,
                                                         sort_control,
@@ -1122,8 +1057,13 @@ ldbm_back_search(Slapi_PBlock *pb)
         }
         if (can_skip_filter_test(pb, filter, scope, candidates) == 0) {
             sr->sr_flags |= SR_FLAG_MUST_APPLY_FILTER_TEST;
+        } else if (!(sr->sr_flags & SR_FLAG_MUST_APPLY_FILTER_TEST)) {
+            filter_bypassed = 1;
         }
     }
+    if (!filter_bypassed) {
+        index_stats_filter_test(sr);
+    }
 
     /* if we need to perform the filter test, pre-digest the filter to
        speed up the filter test */
@@ -1746,6 +1686,8 @@ ldbm_back_next_search_entry(Slapi_PBlock *pb)
     Slapi_Operation *op;
     int reverse_list = 0;
     int32_t internal_op = 0;
+    int caller_txn = 0;
+    int scan_rc = LDBM_SCAN_ENTRY;
 
     slapi_pblock_get(pb, SLAPI_SEARCH_TARGET_SDN, &basesdn);
     if (NULL == basesdn) {
@@ -1790,6 +1732,8 @@ ldbm_back_next_search_entry(Slapi_PBlock *pb)
     if (!txn.back_txn_txn) {
         dblayer_txn_init(li, &txn);
         slapi_pblock_set(pb, SLAPI_TXN, txn.back_txn_txn);
+    } else {
+        caller_txn = 1;
     }
 
     if (sr->sr_norm_filter) {
@@ -1802,6 +1746,23 @@ ldbm_back_next_search_entry(Slapi_PBlock *pb)
         filter_intent = sr->sr_norm_filter_intent;
     }
 
+    if (!(sr->sr_flags & SR_FLAG_SCAN_CHECKED)) {
+        /*
+         * Large candidate lists may be read ahead by the scan threads, unless
+         * the candidates are read in a given order or from a given position
+         * (reverse order, VLV and paged results), or within the transaction
+         * of the caller, which the scan threads cannot share.
+         */
+        sr->sr_flags |= SR_FLAG_SCAN_CHECKED;
+        if (!reverse_list && !caller_txn && !sr->sr_virtuallistview &&
+            !op_is_pagedresults(op) && !operation_is_flag_set(op, OP_FLAG_BULK_IMPORT)) {
+            /* Dynamic list values are only added by this thread, the filter must be tested after */
+            int must_test = (sr->sr_flags & SR_FLAG_MUST_APPLY_FILTER_TEST) &&
+                            !(li->li_dynamic_lists_enabled && !internal_op);
+            sr->sr_scan = ldbm_search_scan_new(pb, be, sr, filter, must_test);
+        }
+    }
+
     if (op_is_pagedresults(op)) {
         int myslimit;
         /* On Simple Paged Results search, sizelimit is appied for each page. */
@@ -1910,6 +1871,10 @@ ldbm_back_next_search_entry(Slapi_PBlock *pb)
                 /* we're done */
                 id = NOID;
             }
+        } else if (sr->sr_scan) {
+            /* The candidates are read ahead by the scan threads */
+            e = NULL;
+            scan_rc = ldbm_search_scan_next(sr->sr_scan, &id, &e);
         } else {
             /* Process the candidate list in the normal order. */
             id = idl_iterator_dereference_increment(&(sr->sr_current), sr->sr_candidates);
@@ -1928,8 +1893,16 @@ ldbm_back_next_search_entry(Slapi_PBlock *pb)
 
         ++sr->sr_lookthroughcount; /* checked above */
 
+        if (scan_rc == LDBM_SCAN_SKIP) {
+            /* The scan threads found that it does not match the filter */
+            continue;
+        }
+
         /* Make sure the backend is available */
         if (be->be_state != BE_STATE_STARTED) {
+            if (sr->sr_scan && e) {
+                CACHE_RETURN(&inst->inst_cache, &e);
+            }
             slapi_send_ldap_result(pb, LDAP_UNWILLING_TO_PERFORM, NULL,
                                    "Backend is stopped", 0, NULL);
             slapi_pblock_set(pb, SLAPI_SEARCH_RESULT_ENTRY, NULL);
@@ -1938,13 +1911,15 @@ ldbm_back_next_search_entry(Slapi_PBlock *pb)
             goto bail;
         }
 
-        /* get the entry */
-        e = operation_get_target_entry(op);
-        if ((e == NULL) || (id != operation_get_target_entry_id(op))) {
-            /* if the entry is not the target_entry (base search)
-             * we need to fetch it from the entry cache (it was not
-             * referenced in the operation) */
-            e = id2entry(be, id, &txn, &err);
+        /* get the entry, unless the scan threads did */
+        if (sr->sr_scan == NULL || e == NULL) {
+            e = operation_get_target_entry(op);
+            if ((e == NULL) || (id != operation_get_target_entry_id(op))) {
+                /* if the entry is not the target_entry (base search)
+                 * we need to fetch it from the entry cache (it was not
+                 * referenced in the operation) */
+                e = id2entry(be, id, &txn, &err);
+            }
         }
         if (e == NULL) {
             if (err != 0 && err != DBI_RC_NOTFOUND) {
@@ -2098,7 +2073,8 @@ ldbm_back_next_search_entry(Slapi_PBlock *pb)
                         filter_test = slapi_vattr_filter_test(pb, e->ep_entry, filter_intent, ACL_CHECK_FLAG);
                         slapi_log_err(SLAPI_LOG_FILTER, "ldbm_back_next_search_entry",
                                       "Applying filter test intermediate value %d \n", filter_test);
-                        if (filter_test == 0) {
+                        /* The scan threads may have tested the filter as executed already */
+                        if (filter_test == 0 && scan_rc != LDBM_SCAN_MATCHED) {
                             filter_test = slapi_vattr_filter_test(pb, e->ep_entry, filter, 0);
                         }
                     }
@@ -2251,6 +2227,7 @@ delete_search_result_set(Slapi_PBlock *pb, back_search_result_set **sr)
         pagedresults_set_search_result_pb(pb, NULL, 0);
         slapi_pblock_set(pb, SLAPI_SEARCH_RESULT_SET, NULL);
     }
+    ldbm_search_scan_free(&((*sr)->sr_scan));
     if (NULL != (*sr)->sr_candidates) {
         idl_free(&((*sr)->sr_candidates));
     }
@@ -0,0 +1,461 @@
+/** BEGIN COPYRIGHT BLOCK
+ * Copyright (C) 2026 Red Hat, Inc.
+ * All rights reserved.
+ *
+ * License: GPL (version 3 or any later version).
+ * See LICENSE for details.
+ * END COPYRIGHT BLOCK **/
+
+#ifdef HAVE_CONFIG_H
+#include <config.h>
+#endif
+
+#include "back-ldbm.h"
+
+/*
+ * Parallel scan of the candidate list of a search.
+ *
+ * ldbm_back_next_search_entry reads the candidates one by one: id2entry,
+ * filter test, ACL check and scope test, all on the worker thread of the
+ * operation. For the large candidate lists of unindexed searches, a pool of
+ * nsslapd-search-scan-threads threads reads ahead of the worker: the list is
+ * cut in chunks of LDBM_SCAN_CHUNK_IDS ids, each claimed by one thread that
+ * loads the entries in the entry cache and drops the ones failing the
+ * filter. The worker then consumes the chunks in the candidate list order,
+ * and still runs all the checks on the entries it gets, so the results,
+ * the limits and the abandon handling are those of the sequential scan.
+ * When the next chunk is not ready, the worker does not wait for the scan
+ * threads: it claims the next unclaimed chunk and reads it itself.
+ *
+ * The scan threads only test the filter as executed, without access
+ * control: the ACL plugin keeps per operation state that only the worker
+ * thread may use. Filters with extensible match components are not tested
+ * by the scan threads, as matching rule plugins may keep state in them.
+ *
+ * At most LDBM_SCAN_WINDOW chunks per scan thread are read ahead of the
+ * worker, so a slow client holds a bounded number of entries in the cache.
+ *
+ * The state of a scan is protected by its own ss_lock, the pool lock only
+ * protects the list of scans the scan threads pick their chunks from. The
+ * lock order is the pool lock, then ss_lock. The chunk being consumed
+ * belongs to the worker: handing out its entries does not take any lock.
+ */
+
+#define LDBM_SCAN_CHUNK_IDS 256
+#define LDBM_SCAN_WINDOW 2
+
+#define LDBM_SCAN_CHUNK_FREE 0
+#define LDBM_SCAN_CHUNK_CLAIMED 1
+#define LDBM_SCAN_CHUNK_READY 2
+
+typedef struct ldbm_scan_chunk
+{
+    int sc_state;
+    size_t sc_nids;
+    size_t sc_next; /* next id handed to the worker */
+    ID sc_ids[LDBM_SCAN_CHUNK_IDS];
+    struct backentry *sc_entries[LDBM_SCAN_CHUNK_IDS]; /* NULL: not loaded, the worker reads it */
+    char sc_dropped[LDBM_SCAN_CHUNK_IDS];              /* failed the filter */
+    char sc_matched[LDBM_SCAN_CHUNK_IDS];              /* passed the filter */
+} ldbm_scan_chunk;
+
+struct ldbm_search_scan
+{
+    backend *ss_be;
+    const IDList *ss_candidates;
+    idl_iterator ss_current;
+    Slapi_Filter *ss_filter; /* NULL: do not test the filter */
+    int ss_managedsait;
+    int ss_filter_normalized;
+    ID ss_target_id;
+    size_t ss_window;
+    ldbm_scan_chunk *ss_chunks;
+    ldbm_scan_chunk *ss_current_chunk; /* ready chunk being consumed by the worker */
+    uint64_t ss_claimed;  /* chunks taken from the candidate list */
+    uint64_t ss_consumed; /* chunks handed to the worker */
+    int ss_busy;          /* chunks being read */
+    int ss_eof;
+    int32_t ss_stop;
+    pthread_mutex_t ss_lock;
+    pthread_cond_t ss_ready_cv;
+    struct ldbm_search_scan *ss_next; /* protected by the pool lock */
+};
+
+static struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;
+    ldbm_search_scan *scans;
+    int32_t nthreads;
+    PRThread **tids;
+    int32_t running;
+    int shutdown;
+} scan_pool;
+
+static int
+ldbm_search_scan_check_filter(Slapi_Filter *f, void *arg __attribute__((unused)))
+{
+    if (f->f_choice == LDAP_FILTER_EXTENDED) {
+        return SLAPI_FILTER_SCAN_STOP;
+    }
+    return SLAPI_FILTER_SCAN_CONTINUE;
+}
+
+/* Take the next chunk of the candidate list, with ss_lock held */
+static ldbm_scan_chunk *
+ldbm_search_scan_claim(ldbm_search_scan *ss)
+{
+    ldbm_scan_chunk *chunk;
+    ID id;
+
+    if (ss->ss_stop || ss->ss_eof || ss->ss_claimed >= ss->ss_consumed + ss->ss_window) {
+        return NULL;
+    }
+    chunk = &ss->ss_chunks[ss->ss_claimed % ss->ss_window];
+    chunk->sc_nids = 0;
+    chunk->sc_next = 0;
+    while (chunk->sc_nids < LDBM_SCAN_CHUNK_IDS &&
+           (id = idl_iterator_dereference_increment(&ss->ss_current, ss->ss_candidates)) != NOID) {
+        chunk->sc_ids[chunk->sc_nids++] = id;
+    }
+    if (chunk->sc_nids < LDBM_SCAN_CHUNK_IDS) {
+        ss->ss_eof = 1;
+    }
+    if (chunk->sc_nids == 0) {
+        pthread_cond_broadcast(&ss->ss_ready_cv);
+        return NULL;
+    }
+    chunk->sc_state = LDBM_SCAN_CHUNK_CLAIMED;
+    ss->ss_claimed++;
+    ss->ss_busy++;
+    return chunk;
+}
+
+static void
+ldbm_search_scan_read(ldbm_search_scan *ss, ldbm_scan_chunk *chunk)
+{
+    Slapi_PBlock *pb = NULL;
+    Slapi_Attr *attr;
+    int err = 0;
+
+    if (ss->ss_filter) {
+        /* A private pblock: the vattr code keeps its loop detection in it */
+        pb = slapi_pblock_new();
+        slapi_pblock_set(pb, SLAPI_BACKEND, ss->ss_be);
+        slapi_pblock_set(pb, SLAPI_PLUGIN_SYNTAX_FILTER_NORMALIZED, &ss->ss_filter_normalized);
+    }
+    for (size_t i = 0; i < chunk->sc_nids; i++) {
+        struct backentry *e;
+
+        chunk->sc_entries[i] = NULL;
+        chunk->sc_dropped[i] = 0;
+        chunk->sc_matched[i] = 0;
+        if (slapi_atomic_load_32(&ss->ss_stop, __ATOMIC_RELAXED) ||
+            chunk->sc_ids[i] == ss->ss_target_id) {
+            /* The target entry is referenced by the operation, leave it to the worker */
+            continue;
+        }
+        if ((e = id2entry(ss->ss_be, chunk->sc_ids[i], NULL, &err)) == NULL) {
+            /* The worker reads it again and reports the error */
+            continue;
+        }
+        if (pb && (ss->ss_managedsait || slapi_entry_attr_find(e->ep_entry, "ref", &attr) != 0)) {
+            int filter_test = slapi_vattr_filter_test(pb, e->ep_entry, ss->ss_filter, 0);
+            if (filter_test == -1) {
+                CACHE_RETURN(&((ldbm_instance *)ss->ss_be->be_instance_info)->inst_cache, &e);
+                chunk->sc_dropped[i] = 1;
+                continue;
+            }
+            /* On an error the worker tests it again and reports it */
+            chunk->sc_matched[i] = (filter_test == 0);
+        }
+        chunk->sc_entries[i] = e;
+    }
+    slapi_pblock_destroy(pb);
+}
+
+/* A chunk was read, ss may be freed as soon as ss_lock is released */
+static void
+ldbm_search_scan_ready(ldbm_search_scan *ss, ldbm_scan_chunk *chunk)
+{
+    pthread_mutex_lock(&ss->ss_lock);
+    chunk->sc_state = LDBM_SCAN_CHUNK_READY;
+    ss->ss_busy--;
+    pthread_cond_broadcast(&ss->ss_ready_cv);
+    pthread_mutex_unlock(&ss->ss_lock);
+}
+
+/* Wake up a scan thread, there may be a chunk to claim */
+static void
+ldbm_search_scan_wakeup(void)
+{
+    pthread_mutex_lock(&scan_pool.lock);
+    pthread_cond_signal(&scan_pool.work_cv);
+    pthread_mutex_unlock(&scan_pool.lock);
+}
+
+static void
+ldbm_search_scan_thread(void *arg __attribute__((unused)))
+{
+    slapi_set_thread_name("search-scan");
+
+    pthread_mutex_lock(&scan_pool.lock);
+    while (!scan_pool.shutdown) {
+        ldbm_scan_chunk *chunk = NULL;
+        ldbm_search_scan *ss;
+
+        for (ss = scan_pool.scans; ss; ss = ss->ss_next) {
+            pthread_mutex_lock(&ss->ss_lock);
+            chunk = ldbm_search_scan_claim(ss);
+            pthread_mutex_unlock(&ss->ss_lock);
+            if (chunk != NULL) {
+                break;
+            }
+        }
+        if (chunk == NULL) {
+            pthread_cond_wait(&scan_pool.work_cv, &scan_pool.lock);
+            continue;
+        }
+        /* Let the next chunk be claimed by another thread */
+        pthread_cond_signal(&scan_pool.work_cv);
+        pthread_mutex_unlock(&scan_pool.lock);
+
+        ldbm_search_scan_read(ss, chunk);
+        ldbm_search_scan_ready(ss, chunk);
+
+        pthread_mutex_lock(&scan_pool.lock);
+    }
+    pthread_mutex_unlock(&scan_pool.lock);
+}
+
+/*
+ * Start the scan threads. With nsslapd-search-scan-threads set to 0, the
+ * default, the candidates are only read by the worker threads.
+ */
+int
+ldbm_search_scan_start(struct ldbminfo *li)
+{
+    int32_t nthreads = li->li_search_scan_threads;
+    int rc;
+
+    if (scan_pool.tids || nthreads <= 0) {
+        return 0;
+    }
+    if ((rc = pthread_mutex_init(&scan_pool.lock, NULL)) != 0 ||
+        (rc = pthread_cond_init(&scan_pool.work_cv, NULL)) != 0) {
+        slapi_log_err(SLAPI_LOG_ERR, "ldbm_search_scan_start",
+                      "Cannot initialize the search scan threads. error %d (%s)\n",
+                      rc, strerror(rc));
+        return -1;
+    }
+    scan_pool.tids = (PRThread **)slapi_ch_calloc(nthreads, sizeof(PRThread *));
+    for (int32_t i = 0; i < nthreads; i++) {
+        if ((scan_pool.tids[i] = PR_CreateThread(PR_USER_THREAD,
+                                                 (VFP)ldbm_search_scan_thread, NULL,
+                                                 PR_PRIORITY_NORMAL, PR_GLOBAL_THREAD, PR_JOINABLE_THREAD,
+                                                 SLAPD_DEFAULT_THREAD_STACKSIZE)) == NULL) {
+            slapi_log_err(SLAPI_LOG_ERR, "ldbm_search_scan_start",
+                          "PR_CreateThread failed. " SLAPI_COMPONENT_NAME_NSPR " error %d (%s)\n",
+                          PR_GetError(), slapd_pr_strerror(PR_GetError()));
+            break;
+        }
+        scan_pool.nthreads++;
+    }
+    if (scan_pool.nthreads > 0) {
+        slapi_atomic_store_32(&(scan_pool.running), 1, __ATOMIC_RELEASE);
+    }
+    slapi_log_err(SLAPI_LOG_INFO, "ldbm_search_scan_start",
+                  "Started %d search scan threads\n", scan_pool.nthreads);
+
+    return scan_pool.nthreads == nthreads ? 0 : -1;
+}
+
+/* Stop the scan threads, once the searches are over */
+void
+ldbm_search_scan_stop(void)
+{
+    if (scan_pool.tids == NULL) {
+        return;
+    }
+    slapi_atomic_store_32(&(scan_pool.running), 0, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&scan_pool.lock);
+    scan_pool.shutdown = 1;
+    pthread_cond_broadcast(&scan_pool.work_cv);
+    pthread_mutex_unlock(&scan_pool.lock);
+    for (int32_t i = 0; i < scan_pool.nthreads; i++) {
+        (void)PR_JoinThread(scan_pool.tids[i]);
+    }
+    slapi_ch_free((void **)&scan_pool.tids);
+    scan_pool.nthreads = 0;
+    scan_pool.shutdown = 0;
+}
+
+/*
+ * Hand the candidates of sr to the scan threads, when they are running and
+ * there are at least nsslapd-search-scan-min-candidates of them. filter is
+ * the filter as executed, tested by the scan threads when must_test is set.
+ * Returns NULL when the worker should read the candidates itself.
+ */
+ldbm_search_scan *
+ldbm_search_scan_new(Slapi_PBlock *pb, backend *be, back_search_result_set *sr, Slapi_Filter *filter, int must_test)
+{
+    struct ldbminfo *li = (struct ldbminfo *)be->be_database->plg_private;
+    Slapi_Operation *op = NULL;
+    ldbm_search_scan *ss;
+    int filt_errs = 0;
+
+    if (!slapi_atomic_load_32(&(scan_pool.running), __ATOMIC_ACQUIRE) ||
+        sr->sr_candidates == NULL ||
+        sr->sr_candidates->b_nids < (NIDS)li->li_search_scan_min_candidates) {
+        return NULL;
+    }
+    slapi_pblock_get(pb, SLAPI_OPERATION, &op);
+
+    ss = (ldbm_search_scan *)slapi_ch_calloc(1, sizeof(ldbm_search_scan));
+    ss->ss_be = be;
+    ss->ss_candidates = sr->sr_candidates;
+    ss->ss_current = sr->sr_current;
+    if (must_test && slapi_filter_apply(filter, ldbm_search_scan_check_filter, NULL, &filt_errs) == SLAPI_FILTER_SCAN_NOMORE) {
+        ss->ss_filter = filter;
+    }
+    slapi_pblock_get(pb, SLAPI_MANAGEDSAIT, &ss->ss_managedsait);
+    slapi_pblock_get(pb, SLAPI_PLUGIN_SYNTAX_FILTER_NORMALIZED, &ss->ss_filter_normalized);
+    ss->ss_target_id = operation_get_target_entry(op) ? operation_get_target_entry_id(op) : NOID;
+    ss->ss_window = (size_t)scan_pool.nthreads * LDBM_SCAN_WINDOW;
+    ss->ss_chunks = (ldbm_scan_chunk *)slapi_ch_calloc(ss->ss_window, sizeof(ldbm_scan_chunk));
+    pthread_mutex_init(&ss->ss_lock, NULL);
+    pthread_cond_init(&ss->ss_ready_cv, NULL);
+
+    pthread_mutex_lock(&scan_pool.lock);
+    ss->ss_next = scan_pool.scans;
+    scan_pool.scans = ss;
+    pthread_cond_broadcast(&scan_pool.work_cv);
+    pthread_mutex_unlock(&scan_pool.lock);
+
+    return ss;
+}
+
+/*
+ * Make the next chunk in the candidate list order the current chunk of the
+ * worker. While it is being read by a scan thread, the worker reads the
+ * next unclaimed chunk itself rather than waiting. Returns NULL at the end
+ * of the candidate list.
+ */
+static ldbm_scan_chunk *
+ldbm_search_scan_next_chunk(ldbm_search_scan *ss)
+{
+    ldbm_scan_chunk *chunk = NULL;
+
+    pthread_mutex_lock(&ss->ss_lock);
+    for (;;) {
+        ldbm_scan_chunk *next = &ss->ss_chunks[ss->ss_consumed % ss->ss_window];
+        ldbm_scan_chunk *own;
+
+        if (ss->ss_consumed < ss->ss_claimed && next->sc_state == LDBM_SCAN_CHUNK_READY) {
+            chunk = next;
+            break;
+        }
+        if ((own = ldbm_search_scan_claim(ss)) != NULL) {
+            pthread_mutex_unlock(&ss->ss_lock);
+            ldbm_search_scan_read(ss, own);
+            pthread_mutex_lock(&ss->ss_lock);
+            own->sc_state = LDBM_SCAN_CHUNK_READY;
+            ss->ss_busy--;
+            continue;
+        }
+        if (ss->ss_eof && ss->ss_consumed == ss->ss_claimed) {
+            break;
+        }
+        /* Nothing left to claim, the next chunk is being read by a scan thread */
+        pthread_cond_wait(&ss->ss_ready_cv, &ss->ss_lock);
+    }
+    pthread_mutex_unlock(&ss->ss_lock);
+
+    return chunk;
+}
+
+/*
+ * Get the next candidate of the scan, in the candidate list order.
+ * Returns LDBM_SCAN_ENTRY with *id and *e set: *e is the entry with a cache
+ * reference, or NULL if the worker has to read it. LDBM_SCAN_MATCHED is
+ * returned instead when the entry was read and passed the filter given to
+ * ldbm_search_scan_new, so that the worker does not test it again. Returns
+ * LDBM_SCAN_SKIP with *id set if the entry failed the filter, and
+ * LDBM_SCAN_DONE at the end of the list.
+ */
+int
+ldbm_search_scan_next(ldbm_search_scan *ss, ID *id, struct backentry **e)
+{
+    ldbm_scan_chunk *chunk = ss->ss_current_chunk;
+    int rc;
+
+    if (chunk == NULL && (chunk = ss->ss_current_chunk = ldbm_search_scan_next_chunk(ss)) == NULL) {
+        *id = NOID;
+        return LDBM_SCAN_DONE;
+    }
+
+    *id = chunk->sc_ids[chunk->sc_next];
+    *e = chunk->sc_entries[chunk->sc_next];
+    chunk->sc_entries[chunk->sc_next] = NULL;
+    if (chunk->sc_dropped[chunk->sc_next]) {
+        rc = LDBM_SCAN_SKIP;
+    } else if (chunk->sc_matched[chunk->sc_next]) {
+        rc = LDBM_SCAN_MATCHED;
+    } else {
+        rc = LDBM_SCAN_ENTRY;
+    }
+    if (++chunk->sc_next == chunk->sc_nids) {
+        /* The chunk can be claimed again, there is room in the window */
+        ss->ss_current_chunk = NULL;
+        pthread_mutex_lock(&ss->ss_lock);
+        chunk->sc_state = LDBM_SCAN_CHUNK_FREE;
+        ss->ss_consumed++;
+        pthread_mutex_unlock(&ss->ss_lock);
+        ldbm_search_scan_wakeup();
+    }
+
+    return rc;
+}
+
+/* Stop the scan and release the entries read ahead of the worker */
+void
+ldbm_search_scan_free(ldbm_search_scan **ssp)
+{
+    ldbm_search_scan *ss = *ssp;
+    ldbm_instance *inst;
+
+    if (ss == NULL) {
+        return;
+    }
+    inst = (ldbm_instance *)ss->ss_be->be_instance_info;
+
+    pthread_mutex_lock(&scan_pool.lock);
+    for (ldbm_search_scan **p = &scan_pool.scans; *p; p = &(*p)->ss_next) {
+        if (*p == ss) {
+            *p = ss->ss_next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&scan_pool.lock);
+
+    /* No new chunk can be claimed, wait for the ones being read */
+    pthread_mutex_lock(&ss->ss_lock);
+    slapi_atomic_store_32(&ss->ss_stop, 1, __ATOMIC_RELAXED);
+    while (ss->ss_busy > 0) {
+        pthread_cond_wait(&ss->ss_ready_cv, &ss->ss_lock);
+    }
+    pthread_mutex_unlock(&ss->ss_lock);
+
+    for (uint64_t seq = ss->ss_consumed; seq < ss->ss_claimed; seq++) {
+        ldbm_scan_chunk *chunk = &ss->ss_chunks[seq % ss->ss_window];
+        for (size_t i = chunk->sc_next; i < chunk->sc_nids; i++) {
+            if (chunk->sc_entries[i]) {
+                CACHE_RETURN(&inst->inst_cache, &chunk->sc_entries[i]);
+            }
+        }
+    }
+    pthread_cond_destroy(&ss->ss_ready_cv);
+    pthread_mutex_destroy(&ss->ss_lock);
+    slapi_ch_free((void **)&ss->ss_chunks);
+    slapi_ch_free((void **)ssp);
+}
@@ -185,6 +185,8 @@ int id2entry_add(backend *be, struct backentry *e, back_txn *txn);
 int id2entry_add_ext(backend *be, struct backentry *e, back_txn *txn, int encrypt, int *cache_res);
 int id2entry_delete(backend *be, struct backentry *e, back_txn *txn);
 struct backentry *id2entry(backend *be, ID id, back_txn *txn, int *err);
+char *id2entry_entry2data(backend *be, Slapi_Entry *e, size_t *size);
+char *id2entry_data2str(const void *data, size_t size, size_t *str_size);
 
 /*
  * idl.c
@@ -240,6 +242,29 @@ IDList *idl_lmdb_range_fetch(backend *be, dbi_db_t *db, dbi_val_t *lowerkey, dbi
 char *get_index_name(backend *be, dbi_db_t *db, struct attrinfo *a);
 
 int64_t idl_compare(IDList *a, IDList *b);
+NIDS idl_gallop(const IDList *idl, NIDS start, ID id);
+IDList *idl_from_bitmap(IDBitmap *bm);
+int idl_compress(IDList **idl);
+int idl_compress_threshold(IDList **idl, int threshold);
+int idl_expand(IDList **idl);
+
+/*
+ * idl_bitmap.c
+ */
+IDBitmap *idl_bitmap_new(void);
+void idl_bitmap_free(IDBitmap **bm);
+IDBitmap *idl_bitmap_dup(const IDBitmap *bm);
+NIDS idl_bitmap_cardinality(const IDBitmap *bm);
+size_t idl_bitmap_sizeof(const IDBitmap *bm);
+int idl_bitmap_add(IDBitmap *bm, ID id);
+int idl_bitmap_remove(IDBitmap *bm, ID id);
+int idl_bitmap_contains(const IDBitmap *bm, ID id);
+ID idl_bitmap_next(const IDBitmap *bm, ID id);
+ID idl_bitmap_select(IDBitmap *bm, NIDS pos);
+NIDS idl_bitmap_to_array(const IDBitmap *bm, ID *ids);
+IDBitmap *idl_bitmap_and(const IDBitmap *a, const IDBitmap *b);
+IDBitmap *idl_bitmap_or(const IDBitmap *a, const IDBitmap *b);
+IDBitmap *idl_bitmap_andnot(const IDBitmap *a, const IDBitmap *b);
 
 /*
  * idl_set.c
@@ -248,6 +273,7 @@ IDListSet *idl_set_create(void);
 void idl_set_destroy(IDListSet *idl_set);
 void idl_set_insert_idl(IDListSet *idl_set, IDList *idl);
 void idl_set_insert_complement_idl(IDListSet *idl_set, IDList *idl);
+int64_t idl_set_minimum_size(IDListSet *idl_set);
 int64_t idl_set_union_shortcut(IDListSet *idl_set);
 int64_t idl_set_intersection_shortcut(IDListSet *idl_set);
 IDList *idl_set_union(IDListSet *idl_set, backend *be);
@@ -266,6 +292,12 @@ int id_array_init(Id_Array *new_guy, int size);
 IDList *index_read(backend *be, const char *type, const char *indextype, const struct berval *val, back_txn *txn, int *err);
 IDList *index_read_ext(backend *be, char *type, const char *indextype, const struct berval *val, back_txn *txn, int *err, int *unindexed);
 IDList *index_read_ext_allids(Slapi_PBlock *pb, backend *be, char *type, const char *indextype, const struct berval *val, back_txn *txn, int *err, int *unindexed, int allidslimit);
+int index_read_estimate(backend *be, char *type, const char *indextype, const struct berval *val, back_txn *txn, size_t *count);
+void index_estimates_free(struct index_estimates **ies);
+void index_stats_free(struct index_stats **iss);
+void index_stats_instance_free(ldbm_instance *inst);
+void index_stats_filter_test(back_search_result_set *sr);
+int ldbm_instance_index_stats_search(Slapi_PBlock *pb, Slapi_Entry *e, Slapi_Entry *entryAfter, int *returncode, char *returntext, void *arg);
 IDList *index_range_read(Slapi_PBlock *pb, backend *be, char *type, const char *indextype, int ftype, struct berval *val, struct berval *nextval, int range, back_txn *txn, int *err);
 IDList *index_range_read_ext(Slapi_PBlock *pb, backend *be, char *type, const char *indextype, int ftype, struct berval *val, struct berval *nextval, int range, back_txn *txn, int *err, int allidslimit);
 const char *encode(const struct berval *data, char buf[BUFSIZ]);
@@ -542,6 +574,15 @@ int search_get_tune(struct ldbminfo *li);
 int compute_lookthrough_limit(Slapi_PBlock *pb, struct ldbminfo *li);
 int compute_allids_limit(Slapi_PBlock *pb, struct ldbminfo *li);
 
+/*
+ * ldbm_search_scan.c
+ */
+int ldbm_search_scan_start(struct ldbminfo *li);
+void ldbm_search_scan_stop(void);
+ldbm_search_scan *ldbm_search_scan_new(Slapi_PBlock *pb, backend *be, back_search_result_set *sr, Slapi_Filter *filter, int must_test);
+int ldbm_search_scan_next(ldbm_search_scan *ss, ID *id, struct backentry **e);
+void ldbm_search_scan_free(ldbm_search_scan **ss);
+
 
 /*
  * matchrule.c
@@ -28,7 +28,17 @@ struct baggage_carrier
 };
 typedef struct baggage_carrier baggage_carrier;
 
-static int slapd_qsort(baggage_carrier *bc, IDList *list, sort_spec *s);
+/* A candidate and the sort keys extracted from its entry */
+struct sort_item
+{
+    ID id;
+    struct berval **keys; /* lowest value for each sort spec, NULL if absent */
+};
+typedef struct sort_item sort_item;
+
+static int sort_check(baggage_carrier *bc);
+static int sort_items_build(baggage_carrier *bc, IDList *list, sort_spec *s, size_t nspec, sort_item *items, struct berval **keys);
+static int slapd_qsort(baggage_carrier *bc, sort_item *items, NIDS num, sort_spec *s);
 static int print_out_sort_spec(char *buffer, sort_spec *s, int *size);
 
 static void
@@ -165,6 +175,10 @@ sort_candidates(backend *be, int lookthrough_limit, struct timespec *expire_time
     int return_value = LDAP_SUCCESS;
     baggage_carrier bc = {0};
     sort_spec_thing *this_s = NULL;
+    sort_item *items = NULL;
+    struct berval **keys = NULL;
+    size_t nspec = 0;
+    size_t nkeys = 0;
 
     /* We refuse to sort a non-existent IDlist */
     if (NULL == candidates) {
@@ -210,7 +224,36 @@ sort_candidates(backend *be, int lookthrough_limit, struct timespec *expire_time
     bc.lookthrough_limit = lookthrough_limit;
     bc.check_counter = 1;
 
-    return_value = slapd_qsort(&bc, candidates, s);
+    if (candidates->b_nids < 2) {
+        return LDAP_SUCCESS; /* nothing to do */
+    }
+    /* Fix for bugid #394184, SD, 20 Jul 00 */
+    if (lookthrough_limit != -1 && (lookthrough_limit <= (int)candidates->b_nids)) {
+        return LDAP_ADMINLIMIT_EXCEEDED;
+    }
+
+    /* Extract the sort keys once, then sort the candidates on them */
+    for (this_s = s; this_s; this_s = this_s->next) {
+        nspec++;
+    }
+    nkeys = (size_t)candidates->b_nids * nspec;
+    items = (sort_item *)slapi_ch_malloc(candidates->b_nids * sizeof(sort_item));
+    keys = (struct berval **)slapi_ch_calloc(nkeys, sizeof(struct berval *));
+
+    return_value = sort_items_build(&bc, candidates, s, nspec, items, keys);
+    if (LDAP_SUCCESS == return_value) {
+        return_value = slapd_qsort(&bc, items, candidates->b_nids, s);
+    }
+    if (LDAP_SUCCESS == return_value) {
+        for (NIDS i = 0; i < candidates->b_nids; i++) {
+            candidates->b_ids[i] = items[i].id;
+        }
+    }
+    for (size_t i = 0; i < nkeys; i++) {
+        ber_bvfree(keys[i]);
+    }
+    slapi_ch_free((void **)&keys);
+    slapi_ch_free((void **)&items);
     slapi_log_err(SLAPI_LOG_TRACE, "Sorting done", "<=\n");
 
     return return_value;
@@ -455,66 +498,127 @@ sort_attr_compare(struct berval **value_a, struct berval **value_b, value_compar
     return compare_fn(compare_value_a, compare_value_b);
 }
 
-/* Comparison routine, called by qsort.
- * The job here is to return the correct value
- * for the operation a < b
- * Returns:
- * <0 when  a < b
- * 0  when a == b
- * >0 when a > b
+/*
+ * Extract the sort key of one sort spec from an entry: the lowest value
+ * (per X.511) of the attribute, or of its matching rule ordering keys.
+ * *key is set to NULL if the entry lacks the attribute.
+ * Returns 0 on success, or -1 if the matching rule could not produce keys.
  */
 static int
-compare_entries_sv(ID *id_a, ID *id_b, sort_spec *s, baggage_carrier *bc, int *error)
+sort_extract_key(Slapi_Entry *e, sort_spec_thing *this_one, struct berval **key)
+{
+    Slapi_Attr *attr = NULL;
+    struct berval **values = NULL;
+    Slapi_Value **va = NULL;
+
+    *key = NULL;
+    slapi_entry_attr_find(e, this_one->type, &attr);
+    if (NULL == attr) {
+        return 0;
+    }
+    va = valueset_get_valuearray(&attr->a_present_values);
+    /* Somewhere in here, we need to go sideways for match rule case
+     * we need to call the match rule plugin to get the attribute values
+     * converted into ordering keys. The plugin owns the memory of the keys,
+     * so the lowest one is duplicated before the next call garbles it. */
+    if (NULL == this_one->matchrule) {
+        /* Non-match rule case */
+        valuearray_get_bervalarray(va, &values);
+        if (values && values[0]) {
+            *key = slapi_ch_bvdup(attr_value_lowest(values, this_one->compare_fn));
+        }
+        ber_bvecfree(values);
+    } else {
+        /* Match rule case */
+        matchrule_values_to_keys(this_one->mr_pb, va, &values);
+        if (va && !values) {
+            return -1;
+        }
+        if (values && values[0]) {
+            *key = slapi_ch_bvdup(attr_value_lowest(values, this_one->compare_fn));
+        }
+    }
+    return 0;
+}
+
+/*
+ * Fetch each candidate entry once and extract the keys of all the sort
+ * specs, so that the comparisons done by the sort don't have to go
+ * through the entry cache (or the database) and the matching rule
+ * plugins again and again.
+ */
+static int
+sort_items_build(baggage_carrier *bc, IDList *list, sort_spec *s, size_t nspec, sort_item *items, struct berval **keys)
 {
-    /* We get passed the IDs, but need to fetch the entries in order to
-     * perform the comparison .
-     */
-    struct backentry *a = NULL;
-    struct backentry *b = NULL;
-    int result = 0;
-    sort_spec_thing *this_one = NULL;
     backend *be = bc->be;
     ldbm_instance *inst = (ldbm_instance *)be->be_instance_info;
-    int err;
     back_txn txn = {NULL};
+    int return_value = LDAP_SUCCESS;
+    int err = 0;
 
     slapi_pblock_get(bc->pb, SLAPI_TXN, &txn.back_txn_txn);
-    *error = 1;
-    a = id2entry(be, *id_a, &txn, &err);
-    if (NULL == a) {
-        if (0 != err) {
-            slapi_log_err(SLAPI_LOG_TRACE, "compare_entries_sv", "db err %d\n", err);
+    for (NIDS i = 0; i < list->b_nids; i++) {
+        struct backentry *e = NULL;
+        sort_spec_thing *this_one = NULL;
+        size_t k = 0;
+
+        items[i].id = list->b_ids[i];
+        items[i].keys = &keys[i * nspec];
+
+        if (LDAP_SUCCESS != (return_value = sort_check(bc))) {
+            return return_value;
         }
-        /* Were up a creek without paddle here */
-        /* Best to log error and set some flag */
-        return 0;
-    }
-    b = id2entry(be, *id_b, &txn, &err);
-    if (NULL == b) {
-        if (0 != err) {
-            slapi_log_err(SLAPI_LOG_TRACE, "compare_entries_sv", "db err %d\n", err);
+        e = id2entry(be, items[i].id, &txn, &err);
+        if (NULL == e) {
+            if (0 != err) {
+                slapi_log_err(SLAPI_LOG_TRACE, "sort_items_build", "db err %d\n", err);
+            }
+            /*
+             * The entry was deleted since the candidates were built: keep it
+             * with no keys, it sorts last and is skipped when the results
+             * are sent.
+             */
+            continue;
+        }
+        for (this_one = (sort_spec_thing *)s; this_one; this_one = this_one->next, k++) {
+            if (sort_extract_key(e->ep_entry, this_one, &items[i].keys[k])) {
+                return_value = LDAP_OPERATIONS_ERROR;
+                break;
+            }
+        }
+        CACHE_RETURN(&inst->inst_cache, &e);
+        if (LDAP_SUCCESS != return_value) {
+            return return_value;
         }
-        CACHE_RETURN(&inst->inst_cache, &a);
-        return 0;
     }
-    /* OK, now we have the entries, so we work our way down the attribute list comparing as we go */
-    for (this_one = (sort_spec_thing *)s; this_one; this_one = this_one->next) {
+    return LDAP_SUCCESS;
+}
+
+/* Comparison routine, called by qsort.
+ * The job here is to return the correct value
+ * for the operation a < b
+ * Returns:
+ * <0 when  a < b
+ * 0  when a == b
+ * >0 when a > b
+ */
+static int
+compare_sort_items(sort_item *a, sort_item *b, sort_spec *s)
+{
+    sort_spec_thing *this_one = NULL;
+    int result = 0;
+    size_t k = 0;
 
-        char *type = this_one->type;
-        int order = this_one->order;
-        Slapi_Attr *attr_a = NULL;
-        Slapi_Attr *attr_b = NULL;
-        struct berval **value_a = NULL;
-        struct berval **value_b = NULL;
+    /* We work our way down the attribute list comparing as we go */
+    for (this_one = (sort_spec_thing *)s; this_one; this_one = this_one->next, k++) {
+        struct berval *key_a = a->keys[k];
+        struct berval *key_b = b->keys[k];
 
-        /* Get the two attribute values from the entries */
-        slapi_entry_attr_find(a->ep_entry, type, &attr_a);
-        slapi_entry_attr_find(b->ep_entry, type, &attr_b);
         /* What do we do if one or more of the entries lacks this attribute ? */
         /* if one lacks the attribute */
-        if (NULL == attr_a) {
+        if (NULL == key_a) {
             /* then if the other does too, they're equal */
-            if (NULL == attr_b) {
+            if (NULL == key_b) {
                 result = 0;
                 continue;
             } else {
@@ -526,50 +630,16 @@ compare_entries_sv(ID *id_a, ID *id_b, sort_spec *s, baggage_carrier *bc, int *e
                 break;
             }
         }
-        if (NULL == attr_b) {
+        if (NULL == key_b) {
             result = -1;
             break;
         }
-        /* Somewhere in here, we need to go sideways for match rule case
-         * we need to call the match rule plugin to get the attribute values
-         * converted into ordering keys. Then we proceed as usual to use those,
-         * but ensuring that we don't leak memory anywhere. This works as follows:
-         * the code assumes that the attrs are references into the entry, so
-         * doesn't try to free them. We need to note at the right place that
-         * we're on the matchrule path, and accordingly free the keys---this turns out
-         * to be when we free the indexer */
-        if (NULL == this_one->matchrule) {
-            /* Non-match rule case */
-            valuearray_get_bervalarray(valueset_get_valuearray(&attr_a->a_present_values), &value_a);
-            valuearray_get_bervalarray(valueset_get_valuearray(&attr_b->a_present_values), &value_b);
-        } else {
-            /* Match rule case */
-            Slapi_Value **va_a = valueset_get_valuearray(&attr_a->a_present_values);
-            Slapi_Value **va_b = valueset_get_valuearray(&attr_b->a_present_values);
-
-            matchrule_values_to_keys(this_one->mr_pb, va_a, &value_a);
-            /* Plugin owns the memory ==> duplicate the key before next call garble it */
-            value_a = slapi_ch_bvecdup(value_a);
-            matchrule_values_to_keys(this_one->mr_pb, va_b, &value_b);
-
-            if ((va_a && !value_a) || (va_b && !value_b)) {
-                result = 0;
-                goto bail;
-            }
-        }
         /* Compare them */
-        if (!order) {
-            result = sort_attr_compare(value_a, value_b, this_one->compare_fn);
+        if (!this_one->order) {
+            result = this_one->compare_fn(key_a, key_b);
         } else {
             /* If reverse, invert the sense of the comparison */
-            result = sort_attr_compare(value_b, value_a, this_one->compare_fn);
-        }
-        /* Time to free up the attributes allocated above */
-        if (NULL != this_one->matchrule) {
-            ber_bvecfree(value_a);
-        } else {
-            ber_bvecfree(value_a);
-            ber_bvecfree(value_b);
+            result = this_one->compare_fn(key_b, key_a);
         }
         /* Are they equal ? */
         if (0 != result) {
@@ -578,10 +648,6 @@ compare_entries_sv(ID *id_a, ID *id_b, sort_spec *s, baggage_carrier *bc, int *e
         }
         /* If so, proceed to the next attribute for comparison */
     }
-    *error = 0;
-bail:
-    CACHE_RETURN(&inst->inst_cache, &a);
-    CACHE_RETURN(&inst->inst_cache, &b);
     return result;
 }
 
@@ -630,8 +696,8 @@ sort_check(baggage_carrier *bc)
 /* End fix for bug # 394184 */
 
 /* prototypes for local routines */
-static void shortsort(baggage_carrier *bc, ID *lo, ID *hi, sort_spec *s);
-static void swap(ID *a, ID *b);
+static void shortsort(sort_item *lo, sort_item *hi, sort_spec *s);
+static void swap(sort_item *a, sort_item *b);
 
 /* this parameter defines the cutoff between using quick sort and
    insertion sort for arrays; arrays with lengths shorter or equal to the
@@ -656,17 +722,15 @@ static void swap(ID *a, ID *b);
  * -6: Abandoned             now is: LDAP_OTHER
  */
 static int
-slapd_qsort(baggage_carrier *bc, IDList *list, sort_spec *s)
+slapd_qsort(baggage_carrier *bc, sort_item *items, NIDS num, sort_spec *s)
 {
-    ID *lo, *hi;       /* ends of sub-array currently sorting */
-    ID *mid;           /* points to middle of subarray */
-    ID *loguy, *higuy; /* traveling pointers for partition step */
-    NIDS size;         /* size of the sub-array */
-    ID *lostk[30], *histk[30];
+    sort_item *lo, *hi;       /* ends of sub-array currently sorting */
+    sort_item *mid;           /* points to middle of subarray */
+    sort_item *loguy, *higuy; /* traveling pointers for partition step */
+    NIDS size;                /* size of the sub-array */
+    sort_item *lostk[30], *histk[30];
     int stkptr; /* stack for saving sub-array to be processed */
-    NIDS num = list->b_nids;
     int return_value = LDAP_SUCCESS;
-    int error = 0;
 
     /* Note: the number of stack entries required is no more than
        1 + log2(size), so 30 is sufficient for any array */
@@ -675,14 +739,8 @@ slapd_qsort(baggage_carrier *bc, IDList *list, sort_spec *s)
 
     stkptr = 0; /* initialize stack */
 
-    lo = &(list->b_ids[0]);
-    hi = &(list->b_ids[num - 1]); /* initialize limits */
-
-    /* Fix for bugid #394184, SD, 20 Jul 00 */
-    if (bc->lookthrough_limit != -1 && (bc->lookthrough_limit <= (int)list->b_nids)) {
-        return LDAP_ADMINLIMIT_EXCEEDED;
-    }
-/* end Fix for bugid #394184 */
+    lo = &(items[0]);
+    hi = &(items[num - 1]); /* initialize limits */
 
 /* this entry point is for pseudo-recursion calling: setting
        lo and hi and jumping to here is like recursion, but stkptr is
@@ -693,7 +751,7 @@ recurse:
 
     /* below a certain size, it is faster to use a O(n^2) sorting method */
     if (size <= CUTOFF) {
-        shortsort(bc, lo, hi, s);
+        shortsort(lo, hi, s);
     } else {
         /* First we pick a partititioning element.  The efficiency of the
            algorithm demands that we find one that is approximately the
@@ -724,19 +782,15 @@ recurse:
                A[i] >= A[lo] for higuy <= i <= hi */
 
             do {
-                if (error)
-                    return LDAP_OPERATIONS_ERROR;
                 loguy++;
-            } while (loguy <= hi && compare_entries_sv(loguy, lo, s, bc, &error) <= 0);
+            } while (loguy <= hi && compare_sort_items(loguy, lo, s) <= 0);
 
             /* lo < loguy <= hi+1, A[i] <= A[lo] for lo <= i < loguy,
                either loguy > hi or A[loguy] > A[lo] */
 
             do {
-                if (error)
-                    return LDAP_OPERATIONS_ERROR;
                 higuy--;
-            } while (higuy > lo && compare_entries_sv(higuy, lo, s, bc, &error) >= 0);
+            } while (higuy > lo && compare_sort_items(higuy, lo, s) >= 0);
 
             /* lo-1 <= higuy <= hi, A[i] >= A[lo] for higuy < i <= hi,
                either higuy <= lo or A[higuy] < A[lo] */
@@ -820,13 +874,11 @@ recurse:
 
 static void
 shortsort(
-    baggage_carrier *bc,
-    ID *lo,
-    ID *hi,
+    sort_item *lo,
+    sort_item *hi,
     sort_spec *s)
 {
-    ID *p, *max;
-    int error = 0;
+    sort_item *p, *max;
 
     /* Note: in assertions below, i and j are alway inside original bound of
        array to sort. */
@@ -836,7 +888,7 @@ shortsort(
         max = lo;
         for (p = lo + 1; p <= hi; p++) {
             /* A[i] <= A[max] for lo <= i < p */
-            if (compare_entries_sv(p, max, s, bc, &error) > 0) {
+            if (compare_sort_items(p, max, s) > 0) {
                 max = p;
             }
             /* A[i] <= A[max] for lo <= i <= p */
@@ -857,9 +909,9 @@ shortsort(
 }
 
 static void
-swap(ID *a, ID *b)
+swap(sort_item *a, sort_item *b)
 {
-    ID tmp;
+    sort_item tmp;
 
     if (a != b) {
         tmp = *a;
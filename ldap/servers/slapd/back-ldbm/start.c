@@ -169,6 +169,9 @@ ldbm_back_start(Slapi_PBlock *pb)
     /* initialize the USN counter */
     ldbm_usn_init(li);
 
+    /* start the threads reading the candidates of large searches */
+    ldbm_search_scan_start(li);
+
     slapi_log_err(SLAPI_LOG_TRACE, "ldbm_back_start", "ldbm backend done starting\n");
 
     return (0);
@@ -161,32 +161,41 @@ slapd_bootstrap_config(const char *configdir)
         return 0;
     }
 
-    if ((rc = PR_GetFileInfo64(configfile, &prfinfo)) != PR_SUCCESS) {
+    /* Apply the changes journaled by a server that did not stop cleanly */
+    if (dse_journal_fold(configdir, &buf) == 0) {
+        slapi_log_err(SLAPI_LOG_ERR, "slapd_bootstrap_config",
+                      "The journal of config file %s could not be applied\n", configfile);
+        return 0;
+    }
+
+    if (buf == NULL && (rc = PR_GetFileInfo64(configfile, &prfinfo)) != PR_SUCCESS) {
         PRErrorCode prerr = PR_GetError();
         slapi_log_err(SLAPI_LOG_ERR, "slapd_bootstrap_config",
                       "The given config file %s could not be accessed, " SLAPI_COMPONENT_NAME_NSPR " error %d (%s)\n",
                       configfile, prerr, slapd_pr_strerror(prerr));
         return rc;
-    } else if ((prfd = PR_Open(configfile, PR_RDONLY,
-                               SLAPD_DEFAULT_FILE_MODE)) == NULL) {
+    } else if (buf == NULL && (prfd = PR_Open(configfile, PR_RDONLY,
+                                              SLAPD_DEFAULT_FILE_MODE)) == NULL) {
         PRErrorCode prerr = PR_GetError();
         slapi_log_err(SLAPI_LOG_ERR, "slapd_bootstrap_config",
                       "The given config file %s could not be opened for reading, " SLAPI_COMPONENT_NAME_NSPR " error %d (%s)\n",
                       configfile, prerr, slapd_pr_strerror(prerr));
         return rc; /* Fail */
     } else {
-        /* read the entire file into core */
-        buf = slapi_ch_malloc(prfinfo.size + 1);
-        if ((nr = slapi_read_buffer(prfd, buf, prfinfo.size)) < 0) {
-            slapi_log_err(SLAPI_LOG_ERR, "slapd_bootstrap_config",
-                          "Could only read %d of %ld bytes from config file %s\n",
-                          nr, (long int)prfinfo.size, configfile);
-            rc = 0; /* Fail */
-            done = 1;
-        }
+        if (buf == NULL) {
+            /* read the entire file into core */
+            buf = slapi_ch_malloc(prfinfo.size + 1);
+            if ((nr = slapi_read_buffer(prfd, buf, prfinfo.size)) < 0) {
+                slapi_log_err(SLAPI_LOG_ERR, "slapd_bootstrap_config",
+                              "Could only read %d of %ld bytes from config file %s\n",
+                              nr, (long int)prfinfo.size, configfile);
+                rc = 0; /* Fail */
+                done = 1;
+            }
 
-        (void)PR_Close(prfd);
-        buf[nr] = '\0';
+            (void)PR_Close(prfd);
+            buf[nr] = '\0';
+        }
 
         if (!done) {
             char workpath[MAXPATHLEN + 1];
@@ -47,6 +47,9 @@ static const char *requires_restart[] = {
     "cn=config:nsslapd-db-locks",
     "cn=config:nsslapd-maxdescriptors",
     "cn=config:nsslapd-numlisteners",
+    "cn=config:nsslapd-workqueue-sharding",
+    "cn=config:" CONFIG_ACCESSLOG_ASYNC_WRITER_ATTRIBUTE,
+    "cn=config:" CONFIG_PWVERIFY_THREADS_ATTRIBUTE,
     "cn=config:" CONFIG_RETURN_EXACT_CASE_ATTRIBUTE,
     "cn=config:" CONFIG_SCHEMA_IGNORE_TRAILING_SPACES,
     "cn=config,cn=ldbm:nsslapd-idlistscanlimit",
@@ -52,11 +52,17 @@ static int32_t max_threads = 0;
 static int32_t *threads_indexes = NULL;
 
 /*
- * We maintain a global work queue of items that have not yet
- * been handed off to an operation thread.
+ * We maintain a work queue of items that have not yet been handed off
+ * to an operation thread.  The queue is split into shards, one per
+ * connection table list, so that each ct_list_thread feeds its own queue
+ * and workers do not all serialize on a single mutex.  Every worker has a
+ * home shard; when it is empty the worker steals from the other shards
+ * before going to sleep.  With nsslapd-workqueue-sharding off (or a single
+ * listener) there is only one shard, which is the historical global queue.
  */
 static void add_work_q(work_q_item *, struct Slapi_op_stack *);
-static work_q_item *get_work_q(struct Slapi_op_stack **);
+static work_q_item *get_work_q(int32_t shard, struct Slapi_op_stack **);
+static void work_q_wakeup(int32_t shard);
 struct Slapi_work_q
 {
     PRStackElem stackelem; /* must be first in struct for PRStack to work */
@@ -65,15 +71,23 @@ struct Slapi_work_q
     struct Slapi_work_q *next_work_item;
 };
 
-static struct Slapi_work_q *head_work_q = NULL; /* global work queue head */
-static struct Slapi_work_q *tail_work_q = NULL; /* global work queue tail */
-static pthread_mutex_t work_q_lock;             /* protects head_conn_q and tail_conn_q */
-static pthread_cond_t work_q_cv;                /* used by operation threads to wait for work -
-                                                 * when there is a conn in the queue waiting
-                                                 * to be processed */
-static PRInt32 work_q_size;                     /* size of conn_q */
+struct Slapi_work_q_shard
+{
+    pthread_mutex_t lock;          /* protects head, tail and waiters */
+    pthread_cond_t cv;             /* used by the workers homed on this shard to wait for work */
+    struct Slapi_work_q *head;     /* shard work queue head */
+    struct Slapi_work_q *tail;     /* shard work queue tail */
+    int32_t waiters;               /* number of workers sleeping on cv */
+    int32_t size;                  /* size of this shard */
+    int32_t size_max;              /* high water mark of size */
+    uint64_t steals;               /* items taken from this shard by workers homed elsewhere */
+};
+
+static struct Slapi_work_q_shard *work_q_shards = NULL;
+static int32_t work_q_nshards = 0;
+static PRInt32 work_q_size;                     /* total size of all the shards */
 static PRInt32 work_q_size_max;                 /* high water mark of work_q_size */
-#define WORK_Q_EMPTY (work_q_size == 0)
+#define WORK_Q_EMPTY (slapi_atomic_load_32((int32_t *)&work_q_size, __ATOMIC_SEQ_CST) == 0)
 static PRStack *work_q_stack;         /* stack of work_q structs so we don't have to malloc/free every time */
 static PRInt32 work_q_stack_size;     /* size of work_q_stack */
 static PRInt32 work_q_stack_size_max; /* max size of work_q_stack */
@@ -439,13 +453,17 @@ init_op_threads()
     pthread_condattr_t condAttr;
     int32_t rc;
 
-    /* Initialize the locks and cv */
-    if ((rc = pthread_mutex_init(&work_q_lock, NULL)) != 0) {
-        slapi_log_err(SLAPI_LOG_ERR, "init_op_threads",
-                      "Cannot create new lock.  error %d (%s)\n",
-                      rc, strerror(rc));
-        exit(-1);
+    /* One shard per connection table list, or a single global queue */
+    if (config_get_workqueue_sharding()) {
+        work_q_nshards = config_get_num_listeners();
     }
+    if (work_q_nshards < 1) {
+        work_q_nshards = 1;
+    }
+    work_q_shards = (struct Slapi_work_q_shard *)slapi_ch_calloc(work_q_nshards,
+                                                                 sizeof(struct Slapi_work_q_shard));
+
+    /* Initialize the locks and cv */
     if ((rc = pthread_condattr_init(&condAttr)) != 0) {
         slapi_log_err(SLAPI_LOG_ERR, "init_op_threads",
                       "Cannot create new condition attribute variable.  error %d (%s)\n",
@@ -456,11 +474,20 @@ init_op_threads()
                       "Cannot set condition attr clock.  error %d (%s)\n",
                       rc, strerror(rc));
         exit(-1);
-    } else if ((rc = pthread_cond_init(&work_q_cv, &condAttr)) != 0) {
-        slapi_log_err(SLAPI_LOG_ERR, "init_op_threads",
-                      "Cannot create new condition variable.  error %d (%s)\n",
-                      rc, strerror(rc));
-        exit(-1);
+    }
+    for (size_t i = 0; i < work_q_nshards; i++) {
+        if ((rc = pthread_mutex_init(&work_q_shards[i].lock, NULL)) != 0) {
+            slapi_log_err(SLAPI_LOG_ERR, "init_op_threads",
+                          "Cannot create new lock.  error %d (%s)\n",
+                          rc, strerror(rc));
+            exit(-1);
+        }
+        if ((rc = pthread_cond_init(&work_q_shards[i].cv, &condAttr)) != 0) {
+            slapi_log_err(SLAPI_LOG_ERR, "init_op_threads",
+                          "Cannot create new condition variable.  error %d (%s)\n",
+                          rc, strerror(rc));
+            exit(-1);
+        }
     }
     pthread_condattr_destroy(&condAttr); /* no longer needed */
 
@@ -1040,33 +1067,97 @@ connection_make_new_pb(Slapi_PBlock *pb, Connection *conn)
     connection_add_operation(conn, stack_obj->op);
 }
 
+/*
+ * Wake up one idle worker, looking for sleeping workers starting at shard.
+ */
+static void
+work_q_wakeup(int32_t shard)
+{
+    for (int32_t i = 0; i < work_q_nshards; i++) {
+        struct Slapi_work_q_shard *wq = &work_q_shards[(shard + i) % work_q_nshards];
+        if (slapi_atomic_load_32(&wq->waiters, __ATOMIC_SEQ_CST) > 0) {
+            pthread_mutex_lock(&wq->lock);
+            pthread_cond_signal(&wq->cv);
+            pthread_mutex_unlock(&wq->lock);
+            return;
+        }
+    }
+}
+
+/*
+ * Pop an item from the home shard, or steal one from another shard.
+ * Called without any shard lock held.
+ */
+static work_q_item *
+work_q_take(int32_t home, struct Slapi_op_stack **op_stack_obj)
+{
+    work_q_item *wqitem = NULL;
+
+    for (int32_t i = 0; i < work_q_nshards && wqitem == NULL; i++) {
+        int32_t shard = (home + i) % work_q_nshards;
+        if (slapi_atomic_load_32(&work_q_shards[shard].size, __ATOMIC_ACQUIRE) == 0) {
+            continue;
+        }
+        pthread_mutex_lock(&work_q_shards[shard].lock);
+        wqitem = get_work_q(shard, op_stack_obj);
+        if (wqitem && shard != home) {
+            work_q_shards[shard].steals++;
+        }
+        pthread_mutex_unlock(&work_q_shards[shard].lock);
+    }
+    return wqitem;
+}
+
 int
-connection_wait_for_new_work(Slapi_PBlock *pb, int32_t interval)
+connection_wait_for_new_work(Slapi_PBlock *pb, int32_t home, int32_t interval)
 {
     int ret = CONN_FOUND_WORK_TO_DO;
     work_q_item *wqitem = NULL;
     struct Slapi_op_stack *op_stack_obj = NULL;
+    struct Slapi_work_q_shard *wq = &work_q_shards[home];
 
-    pthread_mutex_lock(&work_q_lock);
-
-    while (!op_shutdown && WORK_Q_EMPTY) {
-        if (interval == 0 ) {
-            pthread_cond_wait(&work_q_cv, &work_q_lock);
-        } else {
-            struct timespec current_time = {0};
-            clock_gettime(CLOCK_MONOTONIC, &current_time);
-            current_time.tv_sec += interval;
-            pthread_cond_timedwait(&work_q_cv, &work_q_lock, &current_time);
+    while (!op_shutdown && (wqitem = work_q_take(home, &op_stack_obj)) == NULL) {
+        pthread_mutex_lock(&wq->lock);
+        /*
+         * Register as a waiter before the last emptiness check: add_work_q
+         * bumps work_q_size before looking at the waiters, so either we see
+         * the new item here or the producer sees us and signals this shard.
+         */
+        slapi_atomic_incr_32(&wq->waiters, __ATOMIC_SEQ_CST);
+        if (!op_shutdown && WORK_Q_EMPTY) {
+            if (interval == 0) {
+                pthread_cond_wait(&wq->cv, &wq->lock);
+            } else {
+                struct timespec current_time = {0};
+                clock_gettime(CLOCK_MONOTONIC, &current_time);
+                current_time.tv_sec += interval;
+                if (pthread_cond_timedwait(&wq->cv, &wq->lock, &current_time) == ETIMEDOUT) {
+                    slapi_atomic_decr_32(&wq->waiters, __ATOMIC_SEQ_CST);
+                    pthread_mutex_unlock(&wq->lock);
+                    break;
+                }
+            }
         }
+        slapi_atomic_decr_32(&wq->waiters, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&wq->lock);
+    }
+
+    if (wqitem && work_q_nshards > 1 && !WORK_Q_EMPTY) {
+        /*
+         * Several producers may have signalled the same sleeper, pass the
+         * wakeup on so the remaining items do not wait for a busy worker.
+         */
+        work_q_wakeup((home + 1) % work_q_nshards);
     }
 
-    if (op_shutdown) {
-        slapi_log_err(SLAPI_LOG_TRACE, "connection_wait_for_new_work", "shutdown\n");
-        ret = CONN_SHUTDOWN;
-    } else if (NULL == (wqitem = get_work_q(&op_stack_obj))) {
-        /* not sure how this can happen */
-        slapi_log_err(SLAPI_LOG_TRACE, "connection_wait_for_new_work", "no work to do\n");
-        ret = CONN_NOWORK;
+    if (NULL == wqitem) {
+        if (op_shutdown) {
+            slapi_log_err(SLAPI_LOG_TRACE, "connection_wait_for_new_work", "shutdown\n");
+            ret = CONN_SHUTDOWN;
+        } else {
+            slapi_log_err(SLAPI_LOG_TRACE, "connection_wait_for_new_work", "no work to do\n");
+            ret = CONN_NOWORK;
+        }
     } else {
         Connection *conn = wqitem;
         /* make new pb */
@@ -1080,7 +1171,6 @@ connection_wait_for_new_work(Slapi_PBlock *pb, int32_t interval)
         }
     }
 
-    pthread_mutex_unlock(&work_q_lock);
     return ret;
 }
 
@@ -1722,6 +1812,7 @@ connection_threadmain(void *arg)
     int doshutdown = 0;
     int maxthreads = 0;
     bool is_busy = false;
+    int32_t home_shard = (*snmp_vars_idx - 1) % work_q_nshards;
 
 #if defined(hpux)
     /* Arrange to ignore SIGPIPE signals. */
@@ -1757,7 +1848,7 @@ connection_threadmain(void *arg)
                we should finish the op now.  Client might be thinking it's
                done sending the request and wait for the response forever.
                [blackflag 624234] */
-            ret = connection_wait_for_new_work(pb, interval);
+            ret = connection_wait_for_new_work(pb, home_shard, interval);
 
             switch (ret) {
             case CONN_NOWORK:
@@ -1911,7 +2002,7 @@ connection_threadmain(void *arg)
             thread_turbo_flag = 0;
             slapi_log_err(SLAPI_LOG_CONNS, "connection_threadmain",
                           "conn %" PRIu64 " leaving turbo mode - pb_q is not empty %d\n",
-                          conn->c_connid, work_q_size);
+                          conn->c_connid, get_work_q_size());
         }
 #endif
 
@@ -2218,63 +2309,87 @@ connection_activity(Connection *conn, int maxthreads)
     return 0;
 }
 
-/* add_work_q():  will add a work_q_item to the end of the global work queue. The work queue
-    is implemented as a single link list. */
+/* add_work_q():  will add a work_q_item to the end of the work queue shard of the
+    connection table list the connection belongs to. Each shard is implemented as a
+    single link list. */
 
 static void
 add_work_q(work_q_item *wqitem, struct Slapi_op_stack *op_stack_obj)
 {
     struct Slapi_work_q *new_work_q = NULL;
+    struct Slapi_work_q_shard *wq = NULL;
+    int32_t shard = 0;
+    int32_t size;
 
     slapi_log_err(SLAPI_LOG_TRACE, "add_work_q", "=>\n");
 
+    if (wqitem->c_ct_list > 0) {
+        shard = wqitem->c_ct_list % work_q_nshards;
+    }
+    wq = &work_q_shards[shard];
+
     new_work_q = create_work_q();
     new_work_q->work_item = wqitem;
     new_work_q->op_stack_obj = op_stack_obj;
     new_work_q->next_work_item = NULL;
     fgot_start(op_stack_obj->op, FGOT_WQ);
 
-    pthread_mutex_lock(&work_q_lock);
-    if (tail_work_q == NULL) {
-        tail_work_q = new_work_q;
-        head_work_q = new_work_q;
+    pthread_mutex_lock(&wq->lock);
+    if (wq->tail == NULL) {
+        wq->tail = new_work_q;
+        wq->head = new_work_q;
     } else {
-        tail_work_q->next_work_item = new_work_q;
-        tail_work_q = new_work_q;
+        wq->tail->next_work_item = new_work_q;
+        wq->tail = new_work_q;
+    }
+    size = slapi_atomic_incr_32(&wq->size, __ATOMIC_ACQ_REL);
+    if (size > wq->size_max) {
+        wq->size_max = size;
     }
-    PR_AtomicIncrement(&work_q_size); /* increment q size */
-    if (work_q_size > work_q_size_max) {
-        work_q_size_max = work_q_size;
+    size = slapi_atomic_incr_32((int32_t *)&work_q_size, __ATOMIC_SEQ_CST); /* increment q size */
+    if (size > slapi_atomic_load_32((int32_t *)&work_q_size_max, __ATOMIC_ACQUIRE)) {
+        slapi_atomic_store_32((int32_t *)&work_q_size_max, size, __ATOMIC_RELEASE);
+    }
+    if (slapi_atomic_load_32(&wq->waiters, __ATOMIC_SEQ_CST) > 0) {
+        pthread_cond_signal(&wq->cv); /* notify waiters in connection_wait_for_new_work */
+        pthread_mutex_unlock(&wq->lock);
+        return;
+    }
+    pthread_mutex_unlock(&wq->lock);
+
+    /* Nobody idle on this shard, wake up a worker that can steal the item */
+    if (work_q_nshards > 1) {
+        work_q_wakeup((shard + 1) % work_q_nshards);
     }
-    pthread_cond_signal(&work_q_cv); /* notify waiters in connection_wait_for_new_work */
-    pthread_mutex_unlock(&work_q_lock);
 }
 
-/* get_work_q(): will get a work_q_item from the beginning of the work queue, return NULL if
-    the queue is empty.  This should only be called from connection_wait_for_new_work
-    with the work_q_lock held */
+/* get_work_q(): will get a work_q_item from the beginning of a work queue shard, return
+    NULL if the shard is empty.  This should only be called from work_q_take
+    with the shard lock held */
 
 static work_q_item *
-get_work_q(struct Slapi_op_stack **op_stack_obj)
+get_work_q(int32_t shard, struct Slapi_op_stack **op_stack_obj)
 {
+    struct Slapi_work_q_shard *wq = &work_q_shards[shard];
     struct Slapi_work_q *tmp = NULL;
     work_q_item *wqitem;
 
     slapi_log_err(SLAPI_LOG_TRACE, "get_work_q", "=>\n");
-    if (head_work_q == NULL) {
+    if (wq->head == NULL) {
         slapi_log_err(SLAPI_LOG_TRACE, "get_work_q", "The work queue is empty.\n");
         return NULL;
     }
 
-    tmp = head_work_q;
-    if (head_work_q == tail_work_q) {
-        tail_work_q = NULL;
+    tmp = wq->head;
+    if (wq->head == wq->tail) {
+        wq->tail = NULL;
     }
-    head_work_q = tmp->next_work_item;
+    wq->head = tmp->next_work_item;
 
     wqitem = tmp->work_item;
     *op_stack_obj = tmp->op_stack_obj;
-    PR_AtomicDecrement(&work_q_size); /* decrement q size */
+    slapi_atomic_decr_32(&wq->size, __ATOMIC_ACQ_REL);
+    slapi_atomic_decr_32((int32_t *)&work_q_size, __ATOMIC_SEQ_CST); /* decrement q size */
     /* Free the memory used by the item found. */
     destroy_work_q(&tmp);
     fgot_end((*op_stack_obj)->op, FGOT_WQ);
@@ -2313,6 +2428,25 @@ get_work_q_size_max(void)
     return val > 0 ? val : 0;
 }
 
+int32_t
+get_work_q_nshards(void)
+{
+    return work_q_nshards;
+}
+
+/* Fill in the depth, high water mark and steal count of a work queue shard */
+void
+get_work_q_shard_stats(int32_t shard, int32_t *size, int32_t *size_max, uint64_t *steals)
+{
+    struct Slapi_work_q_shard *wq = &work_q_shards[shard];
+
+    pthread_mutex_lock(&wq->lock);
+    *size = wq->size;
+    *size_max = wq->size_max;
+    *steals = wq->steals;
+    pthread_mutex_unlock(&wq->lock);
+}
+
 int32_t
 get_busy_worker_count(void)
 {
@@ -2341,9 +2475,11 @@ op_thread_cleanup()
                   op_stack_size, work_q_size_max, work_q_stack_size_max);
 
     PR_AtomicIncrement(&op_shutdown);
-    pthread_mutex_lock(&work_q_lock);
-    pthread_cond_broadcast(&work_q_cv); /* tell any thread waiting in connection_wait_for_new_work to shutdown */
-    pthread_mutex_unlock(&work_q_lock);
+    for (size_t i = 0; i < work_q_nshards; i++) {
+        pthread_mutex_lock(&work_q_shards[i].lock);
+        pthread_cond_broadcast(&work_q_shards[i].cv); /* tell any thread waiting in connection_wait_for_new_work to shutdown */
+        pthread_mutex_unlock(&work_q_shards[i].lock);
+    }
 }
 
 /* do this after all worker threads have terminated */
@@ -2376,6 +2512,12 @@ connection_post_shutdown_cleanup()
     }
     PR_DestroyStack(op_stack);
     op_stack = NULL;
+    for (size_t i = 0; i < work_q_nshards; i++) {
+        pthread_mutex_destroy(&work_q_shards[i].lock);
+        pthread_cond_destroy(&work_q_shards[i].cv);
+    }
+    slapi_ch_free((void **)&work_q_shards);
+    work_q_nshards = 0;
     slapi_log_err(SLAPI_LOG_INFO, "connection_post_shutdown_cleanup",
                   "slapd shutting down - freed %d work q stack objects - freed %d op stack objects\n",
                   work_cnt, stack_cnt);
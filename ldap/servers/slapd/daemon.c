@@ -1476,6 +1476,8 @@ slapd_daemon(daemon_ports_t *ports)
     slapi_log_err(SLAPI_LOG_TRACE, "slapd_daemon",
                   "slapd shutting down - waiting for backends to close down\n");
 
+    /* Write the pending bind state updates while the backends are up */
+    pw_bind_state_stop();
     pageresult_lock_cleanup();
     eq_stop(); /* deprecated */
     eq_stop_rel();
@@ -1517,7 +1519,12 @@ slapd_daemon(daemon_ports_t *ports)
      * access & security logs when we can guarantee that the buffered content
      * is "complete".
      */
+    result_flush_stop();
     logs_flush();
+    log_access_writer_stop();
+    pw_verify_stop();
+    /* Leave a complete dse.ldif behind */
+    dse_journal_stop();
 
     be_cleanupall();
     plugin_dependency_freeall();
@@ -357,7 +357,10 @@ op_shared_delete(Slapi_PBlock *pb)
         slapi_pblock_set(pb, SLAPI_PLUGIN, be->be_database);
         set_db_default_result_handlers(pb);
         if (be->be_delete != NULL) {
-            if ((rc = (*be->be_delete)(pb)) == 0) {
+            pw_bind_state_discard(sdn);
+            rc = (*be->be_delete)(pb);
+            pw_bind_state_release(sdn);
+            if (rc == 0) {
                 /* we don't perform acl check for internal operations */
                 /* Dont update aci store for remote acis              */
                 if ((!internal_op) &&
@@ -367,6 +370,8 @@ op_shared_delete(Slapi_PBlock *pb)
                 if (operation_is_flag_set(operation, OP_FLAG_ACTION_LOG_AUDIT))
                     write_audit_log_entry(pb); /* Record the operation in the audit log */
 
+                pw_verify_cache_invalidate(sdn);
+
                 slapi_pblock_get(pb, SLAPI_ENTRY_PRE_OP, &ecopy);
                 do_ps_service(ecopy, NULL, LDAP_CHANGETYPE_DELETE, 0);
             } else {
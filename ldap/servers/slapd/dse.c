@@ -29,6 +29,14 @@
  * the entire contents on every modification will
  * be insufficient.
  *
+ * When nsslapd-dse-journal-delay is set, the server
+ * appends the modified entries of dse.ldif to a journal
+ * (dse.ldif.journal) and syncs it instead, and the whole
+ * file is only rewritten once the delay has expired, when
+ * the journal gets too large, before a backup and at
+ * shutdown. A journal left by a crash is folded into
+ * dse.ldif when the file is read.
+ *
  */
 
 #include <sys/types.h>
@@ -104,6 +112,11 @@ struct dse
     int dse_readonly_error_reported; /* used to ensure that read-only errors are logged only once */
     pthread_mutex_t dse_backup_lock; /* used to block write when online backup is in progress */
     bool dse_backup_in_progress;     /* tell that online backup is in progress (protected by dse_rwlock) */
+    char *dse_journal;               /* changes appended since dse_filename was last written */
+    PRFileDesc *dse_journal_fd;
+    PRInt64 dse_journal_size;        /* bytes in dse_journal, 0 if it does not exist */
+    PRInt64 dse_journal_limit;       /* dse_filename is rewritten when the journal grows over this */
+    Slapi_Eq_Context dse_journal_ev; /* pending rewrite of dse_filename */
 };
 
 struct dse_node
@@ -147,11 +160,23 @@ static int dse_pre_modify_plugin(Slapi_Entry *entryBefore, Slapi_Entry *entryAft
 */
 static int dont_ever_write_dse_files = 1;
 
+/*
+  The journal is only used while the server runs: dse_journal_start() is
+  called once the event queue is up, and dse_journal_stop() writes the
+  whole file back at shutdown so that dse.ldif is complete when the
+  server is stopped.
+*/
+static int dse_journal_started = 0;
+
 /* Forward declarations */
 static int entry_dn_cmp(caddr_t d1, caddr_t d2);
 static int dupentry_disallow(caddr_t d1, caddr_t d2);
 static int dupentry_merge(caddr_t d1, caddr_t d2);
 static int dse_write_entry(caddr_t data, caddr_t arg);
+static char *dse_entry2ldif(struct dse *pdse, const Slapi_Entry *e, PRInt32 *len);
+static int dse_persist_nolock(struct dse *pdse, const Slapi_Entry *e, int deleted);
+static void dse_journal_reset(struct dse *pdse);
+static int dse_journal_replay(struct dse *pdse, char **contents);
 static int ldif_record_end(char *p);
 static int dse_call_callback(struct dse *pdse, Slapi_PBlock *pb, int operation, int flags, Slapi_Entry *entryBefore, Slapi_Entry *entryAfter, int *returncode, char *returntext);
 
@@ -212,6 +237,10 @@ dse_backup_lock_cb(struct dse *pdse)
 {
     pthread_mutex_lock(&pdse->dse_backup_lock);
     slapi_rwlock_wrlock(pdse->dse_rwlock);
+    /* The copy of the file must include the journaled changes */
+    if (pdse->dse_journal_size > 0) {
+        dse_write_file_nolock(pdse);
+    }
     pdse->dse_backup_in_progress = true;
     slapi_rwlock_unlock(pdse->dse_rwlock);
 }
@@ -490,6 +519,22 @@ dse_new_with_filelist(char *filename, char *tmpfilename, char *backfilename, cha
     return newdse;
 }
 
+/*
+ * Keep a journal of the changes made to the primary file of a dse, see
+ * dse_persist_nolock(). Must be called before dse_read_file() so that a
+ * journal left behind by a crash is replayed.
+ */
+void
+dse_set_journal(struct dse *pdse, const char *journalfilename)
+{
+    slapi_ch_free_string(&pdse->dse_journal);
+    if (!strstr(journalfilename, pdse->dse_configdir)) {
+        pdse->dse_journal = slapi_ch_smprintf("%s/%s", pdse->dse_configdir, journalfilename);
+    } else {
+        pdse->dse_journal = slapi_ch_strdup(journalfilename);
+    }
+}
+
 static int
 dse_internal_delete_entry(caddr_t data)
 {
@@ -515,6 +560,10 @@ dse_destroy(struct dse *pdse)
     slapi_ch_free((void **)&(pdse->dse_fileback));
     slapi_ch_free((void **)&(pdse->dse_filestartOK));
     slapi_ch_free((void **)&(pdse->dse_configdir));
+    if (pdse->dse_journal_fd) {
+        (void)PR_Close(pdse->dse_journal_fd);
+    }
+    slapi_ch_free_string(&pdse->dse_journal);
     dse_callback_deletelist(&pdse->dse_callback);
     charray_free(pdse->dse_filelist);
     nentries = avl_free(pdse->dse_tree, dse_internal_delete_entry);
@@ -739,8 +788,12 @@ dse_check_file(char *filename, char *backupname)
     }
 }
 
+/*
+ * Read the entries of a dse file. When contents is set, it is used as the
+ * contents of the file: dse_journal_replay() applies a journal in memory.
+ */
 static int
-dse_read_one_file(struct dse *pdse, const char *filename, Slapi_PBlock *pb, int primary_file)
+dse_read_one_file(struct dse *pdse, const char *filename, const char *contents, Slapi_PBlock *pb, int primary_file)
 {
     Slapi_Entry *e = NULL;
     char *entrystr = NULL;
@@ -755,18 +808,20 @@ dse_read_one_file(struct dse *pdse, const char *filename, Slapi_PBlock *pb, int
     slapi_pblock_get(pb, SLAPI_SCHEMA_FLAGS, &schema_flags);
 
     if ((NULL != pdse) && (NULL != filename)) {
-        /* check if the "real" file exists and cam be used, if not try tmp as backup */
-        rc = dse_check_file((char *)filename, pdse->dse_tmpfile);
-        if (!rc) {
-            rc = dse_check_file((char *)filename, pdse->dse_fileback);
+        if (NULL == contents) {
+            /* check if the "real" file exists and cam be used, if not try tmp as backup */
+            rc = dse_check_file((char *)filename, pdse->dse_tmpfile);
+            if (!rc) {
+                rc = dse_check_file((char *)filename, pdse->dse_fileback);
+            }
         }
 
-        if ((rc = PR_GetFileInfo64(filename, &prfinfo)) != PR_SUCCESS) {
+        if (NULL == contents && (rc = PR_GetFileInfo64(filename, &prfinfo)) != PR_SUCCESS) {
             slapi_log_err(SLAPI_LOG_ERR, "dse_read_one_file",
                           "The configuration file %s could not be accessed, error %d\n",
                           filename, rc);
             rc = 0; /* Fail */
-        } else if ((prfd = PR_Open(filename, PR_RDONLY, SLAPD_DEFAULT_DSE_FILE_MODE)) == NULL) {
+        } else if (NULL == contents && (prfd = PR_Open(filename, PR_RDONLY, SLAPD_DEFAULT_DSE_FILE_MODE)) == NULL) {
             slapi_log_err(SLAPI_LOG_ERR, "dse_read_one_file",
                           "The configuration file %s could not be read. " SLAPI_COMPONENT_NAME_NSPR " %d (%s)\n",
                           filename,
@@ -774,18 +829,22 @@ dse_read_one_file(struct dse *pdse, const char *filename, Slapi_PBlock *pb, int
             rc = 0; /* Fail */
         } else {
             int done = 0;
-            /* read the entire file into core */
-            buf = slapi_ch_malloc(prfinfo.size + 1);
-            if ((nr = slapi_read_buffer(prfd, buf, prfinfo.size)) < 0) {
-                slapi_log_err(SLAPI_LOG_ERR, "dse_read_one_file",
-                              "Could only read %d of %ld bytes from config file %s\n",
-                              nr, (long int)prfinfo.size, filename);
-                rc = 0; /* Fail */
-                done = 1;
-            }
+            if (NULL != contents) {
+                buf = slapi_ch_strdup(contents);
+            } else {
+                /* read the entire file into core */
+                buf = slapi_ch_malloc(prfinfo.size + 1);
+                if ((nr = slapi_read_buffer(prfd, buf, prfinfo.size)) < 0) {
+                    slapi_log_err(SLAPI_LOG_ERR, "dse_read_one_file",
+                                  "Could only read %d of %ld bytes from config file %s\n",
+                                  nr, (long int)prfinfo.size, filename);
+                    rc = 0; /* Fail */
+                    done = 1;
+                }
 
-            (void)PR_Close(prfd);
-            buf[nr] = '\0';
+                (void)PR_Close(prfd);
+                buf[nr] = '\0';
+            }
 
             if (!done) {
                 int lineno = 1;
@@ -898,20 +957,26 @@ dse_read_file(struct dse *pdse, Slapi_PBlock *pb)
     int ii;
     char **filelist = 0;
     char *filename = 0;
+    char *contents = NULL;
 
     filelist = charray_dup(pdse->dse_filelist);
     filename = slapi_ch_strdup(pdse->dse_filename);
 
     for (ii = 0; rc && filelist && filelist[ii]; ++ii) {
         if (strcasecmp(filename, filelist[ii]) != 0) {
-            rc = dse_read_one_file(pdse, filelist[ii], pb, 0 /* not primary */);
+            rc = dse_read_one_file(pdse, filelist[ii], NULL, pb, 0 /* not primary */);
         }
     }
 
+    if (rc && pdse->dse_journal) {
+        rc = dse_journal_replay(pdse, &contents);
+    }
+
     if (rc) {
-        rc = dse_read_one_file(pdse, filename, pb, 1 /* primary file */);
+        rc = dse_read_one_file(pdse, filename, contents, pb, 1 /* primary file */);
     }
 
+    slapi_ch_free_string(&contents);
     charray_free(filelist);
     slapi_ch_free((void **)&filename);
 
@@ -1138,6 +1203,23 @@ check_if_readonly(struct dse *pdse)
     return ro;
 }
 
+/* fsync the config directory so that a rename in it sticks */
+static void
+dse_sync_configdir(struct dse *pdse)
+{
+    int fp_configdir =
+#ifdef O_PATH
+        open(pdse->dse_configdir, O_PATH | O_DIRECTORY)
+#else
+        open(pdse->dse_configdir, O_RDONLY | O_DIRECTORY)
+#endif
+        ;
+    if (fp_configdir != -1) {
+        fsync(fp_configdir);
+        close(fp_configdir);
+    }
+}
+
 /*
  * Write the AVL tree of entries back to the LDIF file.
  */
@@ -1170,6 +1252,10 @@ dse_write_file_nolock(struct dse *pdse)
                 (void)PR_Close(fpw.fpw_prfd);
                 fpw.fpw_prfd = NULL;
             } else {
+                if (pdse->dse_journal_size > 0) {
+                    /* the journal is removed once the file is renamed */
+                    (void)PR_Sync(fpw.fpw_prfd);
+                }
                 (void)PR_Close(fpw.fpw_prfd);
                 fpw.fpw_prfd = NULL;
                 if (pdse->dse_fileback != NULL) {
@@ -1193,16 +1279,9 @@ dse_write_file_nolock(struct dse *pdse)
                  * We have now written to the tmp location, and renamed it
                  * we need to open and fsync the dir to make the rename stick.
                  */
-                int fp_configdir =
-#ifdef O_PATH
-                    open(pdse->dse_configdir, O_PATH | O_DIRECTORY)
-#else
-                    open(pdse->dse_configdir, O_RDONLY | O_DIRECTORY)
-#endif
-                    ;
-                if (fp_configdir != -1) {
-                    fsync(fp_configdir);
-                    close(fp_configdir);
+                dse_sync_configdir(pdse);
+                if (rc == 0) {
+                    dse_journal_reset(pdse);
                 }
             }
         }
@@ -1228,40 +1307,512 @@ dse_write_entry(caddr_t data, caddr_t arg)
     PRInt32 len;
 
     if (NULL != n && NULL != n->entry) {
-        int returncode;
-        char returntext[SLAPI_DSE_RETURNTEXT_SIZE] = "";
-        /* need to make a duplicate here for two reasons:
-           1) we don't want to hold on to the raw data in the node for any longer
-           than we have to; we will usually be inside the dse write lock, but . . .
-           2) the write callback may modify the entry, so we want to pass it a
-           writeable copy rather than the raw avl tree data pointer
-        */
-        Slapi_Entry *ec = slapi_entry_dup(n->entry);
-        if (dse_call_callback(fpw->fpw_pdse, NULL, DSE_OPERATION_WRITE,
-                              DSE_FLAG_PREOP, ec, NULL, &returncode, returntext) == SLAPI_DSE_CALLBACK_OK) {
-            /*
-             * 3-August-2000 mcs: We used to pass the SLAPI_DUMP_NOOPATTRS
-             * option to slapi_entry2str_with_options() so that operational
-             * attributes were NOT stored in the DSE LDIF files.  But now
-             * we store all attribute types.
-             */
-            if ((s = slapi_entry2str_with_options(ec, &len, 0)) != NULL) {
-                if (slapi_write_buffer(fpw->fpw_prfd, s, len) != len) {
-                    fpw->fpw_rc = PR_GetOSError();
-                    ;
-                    slapi_ch_free((void **)&s);
-                    return STOP_TRAVERSAL;
-                }
-                if (slapi_write_buffer(fpw->fpw_prfd, "\n", 1) != 1) {
-                    fpw->fpw_rc = PR_GetOSError();
-                    ;
-                    slapi_ch_free((void **)&s);
-                    return STOP_TRAVERSAL;
-                }
+        if ((s = dse_entry2ldif(fpw->fpw_pdse, n->entry, &len)) != NULL) {
+            if (slapi_write_buffer(fpw->fpw_prfd, s, len) != len) {
+                fpw->fpw_rc = PR_GetOSError();
+                slapi_ch_free((void **)&s);
+                return STOP_TRAVERSAL;
+            }
+            if (slapi_write_buffer(fpw->fpw_prfd, "\n", 1) != 1) {
+                fpw->fpw_rc = PR_GetOSError();
                 slapi_ch_free((void **)&s);
+                return STOP_TRAVERSAL;
             }
+            slapi_ch_free((void **)&s);
         }
-        slapi_entry_free(ec);
+    }
+    return 0;
+}
+
+/*
+ * Return the LDIF of an entry as it is stored in the file, or NULL
+ * if a write callback tells that the entry must not be stored.
+ */
+static char *
+dse_entry2ldif(struct dse *pdse, const Slapi_Entry *e, PRInt32 *len)
+{
+    int returncode;
+    char returntext[SLAPI_DSE_RETURNTEXT_SIZE] = "";
+    char *s = NULL;
+    /* need to make a duplicate here for two reasons:
+       1) we don't want to hold on to the raw data in the node for any longer
+       than we have to; we will usually be inside the dse write lock, but . . .
+       2) the write callback may modify the entry, so we want to pass it a
+       writeable copy rather than the raw avl tree data pointer
+    */
+    Slapi_Entry *ec = slapi_entry_dup(e);
+    if (dse_call_callback(pdse, NULL, DSE_OPERATION_WRITE,
+                          DSE_FLAG_PREOP, ec, NULL, &returncode, returntext) == SLAPI_DSE_CALLBACK_OK) {
+        /*
+         * 3-August-2000 mcs: We used to pass the SLAPI_DUMP_NOOPATTRS
+         * option to slapi_entry2str_with_options() so that operational
+         * attributes were NOT stored in the DSE LDIF files.  But now
+         * we store all attribute types.
+         */
+        s = slapi_entry2str_with_options(ec, len, 0);
+    }
+    slapi_entry_free(ec);
+    return s;
+}
+
+/*
+ * The journal
+ *
+ * It starts with a header identifying the dse.ldif it applies to (inode,
+ * size and modification time), followed by LDIF records separated by an
+ * empty line: the new contents of an added or modified entry, or the
+ * entry preceded by a "# delete" line when it was removed. A record is
+ * synced before the operation returns, so a change is as durable as when
+ * the whole file is rewritten. Records are full entries, so replaying a
+ * journal twice gives the same file.
+ *
+ * Once the whole file has been rewritten the journal is removed. If the
+ * server stops between both steps, the header no longer matches the new
+ * file and the journal is ignored. The same happens if dse.ldif was
+ * edited by hand after a crash: the edited file wins.
+ */
+#define DSE_JOURNAL_HEADER "# dse journal: %lu %lld %lld\n"
+#define DSE_JOURNAL_DELETE "# delete\n"
+#define DSE_JOURNAL_MIN_LIMIT (256 * 1024)
+
+static int
+dse_journal_identity(struct dse *pdse, unsigned long *ino, long long *size, long long *mtime)
+{
+    struct stat sbuf;
+
+    if (stat(pdse->dse_filename, &sbuf) != 0) {
+        return -1;
+    }
+    *ino = (unsigned long)sbuf.st_ino;
+    *size = (long long)sbuf.st_size;
+    *mtime = (long long)sbuf.st_mtime;
+    return 0;
+}
+
+/* Forget about the journal once dse_filename is complete */
+static void
+dse_journal_reset(struct dse *pdse)
+{
+    if (pdse->dse_journal_fd) {
+        (void)PR_Close(pdse->dse_journal_fd);
+        pdse->dse_journal_fd = NULL;
+    }
+    if (pdse->dse_journal_size > 0) {
+        if (PR_Delete(pdse->dse_journal) != PR_SUCCESS && PR_GetError() != PR_FILE_NOT_FOUND_ERROR) {
+            /* The header no longer matches dse_filename so it is ignored anyway */
+            slapi_log_err(SLAPI_LOG_WARNING, "dse_journal_reset",
+                          "Cannot remove the journal \"%s\": " SLAPI_COMPONENT_NAME_NSPR " %d (%s)\n",
+                          pdse->dse_journal, PR_GetError(), slapd_pr_strerror(PR_GetError()));
+        }
+        pdse->dse_journal_size = 0;
+    }
+}
+
+/* Append the current state of an entry to the journal and sync it */
+static int
+dse_journal_append(struct dse *pdse, const Slapi_Entry *e, int deleted)
+{
+    char *s = NULL;
+    char *record = NULL;
+    PRInt32 len = 0;
+    PRInt32 reclen;
+    int rc = -1;
+
+    if (pdse->dse_journal_fd == NULL) {
+        unsigned long ino;
+        long long size, mtime;
+        char header[128];
+        PRInt32 hlen;
+
+        if (pdse->dse_journal_size > 0) {
+            /* A write failed: the file must be rewritten before journaling again */
+            return -1;
+        }
+        if (dse_journal_identity(pdse, &ino, &size, &mtime) != 0) {
+            /* dse_filename does not exist yet: write it instead */
+            return -1;
+        }
+        pdse->dse_journal_fd = PR_Open(pdse->dse_journal, PR_WRONLY | PR_CREATE_FILE | PR_TRUNCATE,
+                                       SLAPD_DEFAULT_DSE_FILE_MODE);
+        if (pdse->dse_journal_fd == NULL) {
+            slapi_log_err(SLAPI_LOG_ERR, "dse_journal_append",
+                          "Cannot open the journal \"%s\": " SLAPI_COMPONENT_NAME_NSPR " %d (%s)\n",
+                          pdse->dse_journal, PR_GetError(), slapd_pr_strerror(PR_GetError()));
+            return -1;
+        }
+        hlen = PR_snprintf(header, sizeof(header), DSE_JOURNAL_HEADER, ino, size, mtime);
+        if (slapi_write_buffer(pdse->dse_journal_fd, header, hlen) != hlen) {
+            goto done;
+        }
+        /* The journal itself must survive a crash, not only its records */
+        dse_sync_configdir(pdse);
+        pdse->dse_journal_size = hlen;
+        pdse->dse_journal_limit = size > DSE_JOURNAL_MIN_LIMIT ? size : DSE_JOURNAL_MIN_LIMIT;
+    }
+
+    if (!deleted) {
+        struct dse_node *n = dse_find_node(pdse, slapi_entry_get_sdn_const(e));
+        if (n && n->entry) {
+            s = dse_entry2ldif(pdse, n->entry, &len);
+        }
+    }
+    if (s == NULL) {
+        /* Removed from the tree, or not stored in the file */
+        deleted = 1;
+        s = slapi_entry2str_with_options((Slapi_Entry *)e, &len, 0);
+        if (s == NULL) {
+            goto done;
+        }
+    }
+    record = slapi_ch_smprintf("%s%s\n", deleted ? DSE_JOURNAL_DELETE : "", s);
+    reclen = strlen(record);
+    if (slapi_write_buffer(pdse->dse_journal_fd, record, reclen) != reclen ||
+        PR_Sync(pdse->dse_journal_fd) != PR_SUCCESS) {
+        goto done;
+    }
+    pdse->dse_journal_size += reclen;
+    rc = 0;
+
+done:
+    if (rc) {
+        slapi_log_err(SLAPI_LOG_ERR, "dse_journal_append",
+                      "Cannot write the journal \"%s\": OS error %d (%s)\n",
+                      pdse->dse_journal, PR_GetOSError(), slapd_system_strerror(PR_GetOSError()));
+        (void)PR_Close(pdse->dse_journal_fd);
+        pdse->dse_journal_fd = NULL;
+        /* Make sure that what was written is removed once the file is rewritten */
+        pdse->dse_journal_size = 1;
+    }
+    slapi_ch_free_string(&record);
+    slapi_ch_free_string(&s);
+    return rc;
+}
+
+/* Read a whole file in a NUL terminated buffer */
+static char *
+dse_read_whole_file(const char *filename)
+{
+    PRFileInfo64 prfinfo;
+    PRFileDesc *prfd = NULL;
+    PRInt32 nr;
+    char *buf = NULL;
+
+    if (PR_GetFileInfo64(filename, &prfinfo) != PR_SUCCESS ||
+        (prfd = PR_Open(filename, PR_RDONLY, SLAPD_DEFAULT_DSE_FILE_MODE)) == NULL) {
+        return NULL;
+    }
+    buf = slapi_ch_malloc(prfinfo.size + 1);
+    if ((nr = slapi_read_buffer(prfd, buf, prfinfo.size)) < 0) {
+        slapi_ch_free_string(&buf);
+    } else {
+        buf[nr] = '\0';
+    }
+    (void)PR_Close(prfd);
+    return buf;
+}
+
+/* Return the normalized DN of an LDIF record */
+static char *
+dse_record_ndn(const char *record)
+{
+    const char *next = record + strspn(record, "\r\n");
+    const char *line = ldif_getline_ro(&next);
+    struct berval copy = {0};
+    struct berval type = {0, NULL};
+    struct berval value = {0, NULL};
+    int freeval = 0;
+    char *ndn = NULL;
+
+    if (line == NULL) {
+        return NULL;
+    }
+    dup_ldif_line(&copy, line, next);
+    if (slapi_ldif_parse_line(copy.bv_val, &type, &value, &freeval) >= 0 &&
+        type.bv_val && value.bv_val && type.bv_len == 2 &&
+        strncasecmp(type.bv_val, "dn", 2) == 0) {
+        char *dn = slapi_ch_malloc(value.bv_len + 1);
+        Slapi_DN *sdn = NULL;
+
+        memcpy(dn, value.bv_val, value.bv_len);
+        dn[value.bv_len] = '\0';
+        sdn = slapi_sdn_new_dn_passin(dn);
+        ndn = slapi_ch_strdup(slapi_sdn_get_ndn(sdn));
+        slapi_sdn_free(&sdn);
+    }
+    if (freeval) {
+        slapi_ch_free_string(&value.bv_val);
+    }
+    slapi_ch_free_string(&copy.bv_val);
+    return ndn;
+}
+
+typedef struct _dse_record
+{
+    char *ndn;
+    char *text; /* NULL once deleted */
+} DseRecord;
+
+/*
+ * Fold the journal left by a server that did not stop cleanly into the
+ * primary file, before it is read.
+ *
+ * When the dse files may be written, the result is written to the primary
+ * file, the journal is removed and *contents is left NULL. Otherwise
+ * (offline tools) nothing is changed on disk: *contents gets the primary
+ * file with the journal applied, to be read instead of the file.
+ *
+ * Return 1 for OK, 0 for Fail.
+ */
+static int
+dse_journal_replay(struct dse *pdse, char **contents)
+{
+    DseRecord *records = NULL;
+    size_t nrecords = 0;
+    size_t maxrecords = 0;
+    size_t total = 0;
+    char *jbuf = NULL;
+    char *fbuf = NULL;
+    char *merged = NULL;
+    char *rec = NULL;
+    char *lastp = NULL;
+    char *start = NULL;
+    char *end = NULL;
+    char *pt = NULL;
+    unsigned long ino, jino;
+    long long size, jsize, mtime, jmtime;
+    PRFileDesc *prfd = NULL;
+    PRInt32 len;
+    int writable = !dont_ever_write_dse_files;
+    int applied = 0;
+    int rc = 0; /* Fail */
+
+    *contents = NULL;
+    if ((jbuf = dse_read_whole_file(pdse->dse_journal)) == NULL || *jbuf == '\0') {
+        /* No journal: dse_filename is complete */
+        slapi_ch_free_string(&jbuf);
+        return 1;
+    }
+    /* dse_read_one_file() restores a missing file from the backups, do it first */
+    if (!dse_check_file(pdse->dse_filename, pdse->dse_tmpfile)) {
+        (void)dse_check_file(pdse->dse_filename, pdse->dse_fileback);
+    }
+    if (sscanf(jbuf, "# dse journal: %lu %lld %lld", &jino, &jsize, &jmtime) != 3 ||
+        dse_journal_identity(pdse, &ino, &size, &mtime) != 0 ||
+        ino != jino || size != jsize || mtime != jmtime) {
+        if (writable) {
+            char *ignored = slapi_ch_smprintf("%s.ignored", pdse->dse_journal);
+            slapi_log_err(SLAPI_LOG_WARNING, "dse_journal_replay",
+                          "The journal %s does not apply to %s (it was written or replaced since), "
+                          "moving it to %s\n", pdse->dse_journal, pdse->dse_filename, ignored);
+            (void)slapi_destructive_rename(pdse->dse_journal, ignored);
+            slapi_ch_free_string(&ignored);
+        } else {
+            slapi_log_err(SLAPI_LOG_WARNING, "dse_journal_replay",
+                          "The journal %s does not apply to %s (it was written or replaced since), "
+                          "ignoring it\n", pdse->dse_journal, pdse->dse_filename);
+        }
+        slapi_ch_free_string(&jbuf);
+        return 1;
+    }
+    if ((fbuf = dse_read_whole_file(pdse->dse_filename)) == NULL) {
+        slapi_log_err(SLAPI_LOG_ERR, "dse_journal_replay",
+                      "Cannot read %s to apply the journal %s\n", pdse->dse_filename, pdse->dse_journal);
+        goto done;
+    }
+
+    while ((rec = dse_read_next_entry(fbuf, &lastp)) != NULL) {
+        if (nrecords == maxrecords) {
+            maxrecords = maxrecords ? 2 * maxrecords : 64;
+            records = (DseRecord *)slapi_ch_realloc((char *)records, maxrecords * sizeof(DseRecord));
+        }
+        records[nrecords].ndn = dse_record_ndn(rec);
+        records[nrecords].text = rec;
+        nrecords++;
+    }
+
+    /* Skip the header, and the end of a record that was not completely written */
+    start = strchr(jbuf, '\n');
+    end = start ? strstr(start++, "\n\n") : NULL;
+    while (end) {
+        char *next = strstr(end + 2, "\n\n");
+        if (next == NULL) {
+            break;
+        }
+        end = next;
+    }
+    if (end == NULL) {
+        start = NULL;
+    } else {
+        end[2] = '\0';
+    }
+    lastp = NULL;
+    while (start && (rec = dse_read_next_entry(start, &lastp)) != NULL) {
+        int deleted = (strncmp(rec, DSE_JOURNAL_DELETE, strlen(DSE_JOURNAL_DELETE)) == 0);
+        char *ndn = dse_record_ndn(rec);
+        size_t i;
+
+        if (ndn == NULL) {
+            slapi_log_err(SLAPI_LOG_ERR, "dse_journal_replay",
+                          "Invalid record in the journal %s: %.64s\n", pdse->dse_journal, rec);
+            break;
+        }
+        for (i = 0; i < nrecords; i++) {
+            if (records[i].ndn && strcmp(records[i].ndn, ndn) == 0) {
+                break;
+            }
+        }
+        if (i == nrecords) {
+            if (nrecords == maxrecords) {
+                maxrecords = maxrecords ? 2 * maxrecords : 64;
+                records = (DseRecord *)slapi_ch_realloc((char *)records, maxrecords * sizeof(DseRecord));
+            }
+            records[nrecords].ndn = ndn;
+            records[nrecords].text = NULL;
+            nrecords++;
+        } else {
+            slapi_ch_free_string(&ndn);
+        }
+        records[i].text = deleted ? NULL : rec;
+        applied++;
+    }
+    if (applied == 0) {
+        if (writable) {
+            (void)PR_Delete(pdse->dse_journal);
+        }
+        rc = 1;
+        goto done;
+    }
+
+    /* The primary file with the journal applied */
+    for (size_t i = 0; i < nrecords; i++) {
+        if (records[i].text) {
+            total += strlen(records[i].text) + 2;
+        }
+    }
+    pt = merged = slapi_ch_malloc(total + 1);
+    for (size_t i = 0; i < nrecords; i++) {
+        if (records[i].text) {
+            size_t reclen = strlen(records[i].text);
+            memcpy(pt, records[i].text, reclen);
+            memcpy(pt + reclen, "\n\n", 2);
+            pt += reclen + 2;
+        }
+    }
+    *pt = '\0';
+
+    if (!writable) {
+        slapi_log_err(SLAPI_LOG_INFO, "dse_journal_replay",
+                      "Applied %d changes from the journal %s, %s is left unchanged\n",
+                      applied, pdse->dse_journal, pdse->dse_filename);
+        *contents = merged;
+        merged = NULL;
+        rc = 1;
+        goto done;
+    }
+
+    /* Write the result like dse_write_file_nolock() does */
+    if ((prfd = PR_Open(pdse->dse_tmpfile, PR_RDWR | PR_CREATE_FILE | PR_TRUNCATE, SLAPD_DEFAULT_DSE_FILE_MODE)) == NULL) {
+        slapi_log_err(SLAPI_LOG_ERR, "dse_journal_replay",
+                      "Cannot open temporary DSE file \"%s\": OS error %d (%s)\n",
+                      pdse->dse_tmpfile, PR_GetOSError(), slapd_system_strerror(PR_GetOSError()));
+        goto done;
+    }
+    len = (PRInt32)total;
+    if (slapi_write_buffer(prfd, merged, len) != len) {
+        slapi_log_err(SLAPI_LOG_ERR, "dse_journal_replay",
+                      "Cannot write temporary DSE file \"%s\": OS error %d (%s)\n",
+                      pdse->dse_tmpfile, PR_GetOSError(), slapd_system_strerror(PR_GetOSError()));
+        goto done;
+    }
+    (void)PR_Sync(prfd);
+    (void)PR_Close(prfd);
+    prfd = NULL;
+    if (slapi_destructive_rename(pdse->dse_tmpfile, pdse->dse_filename) != 0) {
+        slapi_log_err(SLAPI_LOG_ERR, "dse_journal_replay",
+                      "Cannot rename temporary DSE file \"%s\" to \"%s\": OS error %d (%s)\n",
+                      pdse->dse_tmpfile, pdse->dse_filename, errno, slapd_system_strerror(errno));
+        goto done;
+    }
+    dse_sync_configdir(pdse);
+    (void)PR_Delete(pdse->dse_journal);
+    slapi_log_err(SLAPI_LOG_INFO, "dse_journal_replay",
+                  "Applied %d changes from the journal %s to %s\n",
+                  applied, pdse->dse_journal, pdse->dse_filename);
+    rc = 1;
+
+done:
+    if (prfd) {
+        (void)PR_Close(prfd);
+    }
+    for (size_t i = 0; i < nrecords; i++) {
+        slapi_ch_free_string(&records[i].ndn);
+    }
+    slapi_ch_free((void **)&records);
+    slapi_ch_free_string(&merged);
+    slapi_ch_free_string(&fbuf);
+    slapi_ch_free_string(&jbuf);
+    return rc;
+}
+
+/*
+ * Apply the journal of dse.ldif in configdir before slapd_bootstrap_config()
+ * reads the file. *contents is set as by dse_journal_replay().
+ *
+ * Return 1 for OK, 0 for Fail.
+ */
+int
+dse_journal_fold(const char *configdir, char **contents)
+{
+    struct dse *pdse = dse_new(DSE_FILENAME, DSE_TMPFILE, DSE_BACKFILE, DSE_STARTOKFILE, configdir);
+    int rc = 0;
+
+    *contents = NULL;
+    if (pdse != NULL) {
+        dse_set_journal(pdse, DSE_JOURNALFILE);
+        rc = dse_journal_replay(pdse, contents);
+        dse_destroy(pdse);
+    }
+    return rc;
+}
+
+/* Event queue callback: write the journaled changes to dse_filename */
+static void
+dse_journal_write_ev(time_t when __attribute__((unused)), void *arg)
+{
+    struct dse *pdse = (struct dse *)arg;
+
+    dse_lock_write(pdse, DSE_USE_LOCK);
+    pdse->dse_journal_ev = NULL;
+    if (pdse->dse_journal_size > 0) {
+        dse_write_file_nolock(pdse);
+    }
+    dse_lock_unlock(pdse, DSE_USE_LOCK);
+}
+
+/*
+ * Store a change of entry e in dse_filename. The entry is read from the
+ * tree unless it was deleted. The caller holds the write lock.
+ *
+ * With nsslapd-dse-journal-delay set, the change is appended to the
+ * journal and the rewrite of the whole file is delayed, so that a burst
+ * of changes is written once.
+ */
+static int
+dse_persist_nolock(struct dse *pdse, const Slapi_Entry *e, int deleted)
+{
+    int32_t delay = config_get_dse_journal_delay();
+
+    if (pdse->dse_journal == NULL || !dse_journal_started || delay == 0 ||
+        dont_ever_write_dse_files || slapi_config_get_readonly() ||
+        dse_journal_append(pdse, e, deleted) != 0) {
+        return dse_write_file_nolock(pdse);
+    }
+    if (pdse->dse_journal_size > pdse->dse_journal_limit) {
+        return dse_write_file_nolock(pdse);
+    }
+    if (pdse->dse_journal_ev == NULL) {
+        pdse->dse_journal_ev = slapi_eq_once_rel(dse_journal_write_ev, pdse,
+                                                 slapi_current_rel_time_t() + delay);
     }
     return 0;
 }
@@ -1304,7 +1855,7 @@ dse_add_entry_pb(struct dse *pdse, Slapi_Entry *e, Slapi_PBlock *pb)
             dse_node_delete(&n);
         }
         if (!dont_write_file) {
-            dse_write_file_nolock(pdse);
+            dse_persist_nolock(pdse, e, 0);
         }
     } else {                 /* duplicate entry ignored */
         dse_node_delete(&n); /* This also deletes the contained entry */
@@ -1479,7 +2030,7 @@ dse_replace_entry(struct dse *pdse, Slapi_Entry *e, int write_file, int use_lock
         dse_lock_write(pdse, use_lock);
         rc = avl_insert(&(pdse->dse_tree), (caddr_t)n, entry_dn_cmp, dupentry_replace);
         if (write_file)
-            dse_write_file_nolock(pdse);
+            dse_persist_nolock(pdse, e, 0);
         /* If the entry was replaced i.e. not added as a new entry, we need to
            free the old data, which is set in dupentry_replace */
         if (DSE_ENTRY_WAS_REPLACED == rc) {
@@ -1583,7 +2134,7 @@ dse_delete_entry(struct dse *pdse, Slapi_PBlock *pb, const Slapi_Entry *e)
         /* Decrement the numsubordinate count of the parent entry */
         dse_updateNumSubOfParent(pdse, slapi_entry_get_sdn_const(e),
                                  SLAPI_OPERATION_DELETE);
-        dse_write_file_nolock(pdse);
+        dse_persist_nolock(pdse, e, 1);
     }
     dse_lock_unlock(pdse, DSE_USE_LOCK);
 
@@ -1644,7 +2195,7 @@ dse_bind(Slapi_PBlock *pb) /* JCM There should only be one exit point from this
         bvals = attr_get_present_values(attr);
 
         slapi_value_init_berval(&cv, cred);
-        if (slapi_pw_find_sv(bvals, &cv) != 0) {
+        if (slapi_pw_verify_sv(slapi_entry_get_ndn(ec), bvals, &cv) != 0) {
             slapi_pblock_set(pb, SLAPI_PB_RESULT_TEXT, "Invalid credentials");
             slapi_send_ldap_result(pb, LDAP_INVALID_CREDENTIALS, NULL, NULL, 0, NULL);
             slapi_entry_free(ec);
@@ -2985,6 +3536,38 @@ dse_unset_dont_ever_write_dse_files()
     dont_ever_write_dse_files = 0;
 }
 
+/* Write the journaled changes of the config DSE to dse.ldif */
+static void
+dse_journal_flush(void)
+{
+    Slapi_Backend *be = slapi_be_select_by_instance_name(DSE_BACKEND);
+    if (be != NULL) {
+        struct dse *pdse = (struct dse *)be->be_database->plg_private;
+        if (pdse != NULL) {
+            dse_lock_write(pdse, DSE_USE_LOCK);
+            if (pdse->dse_journal_size > 0) {
+                dse_write_file_nolock(pdse);
+            }
+            dse_lock_unlock(pdse, DSE_USE_LOCK);
+        }
+    }
+}
+
+/* Called once the event queue runs, that rewrites the file after a change */
+void
+dse_journal_start()
+{
+    dse_journal_started = 1;
+}
+
+/* Called at shutdown, once the event queue is stopped */
+void
+dse_journal_stop()
+{
+    dse_journal_started = 0;
+    dse_journal_flush();
+}
+
 static dse_search_set *
 dse_search_set_new(void)
 {
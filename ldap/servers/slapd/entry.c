@@ -1778,6 +1778,655 @@ slapi_entry2str_with_options(Slapi_Entry *e, int *len, int options)
     return entry2str_internal_ext(e, len, options);
 }
 
+/*
+ * Binary entry format, used for the id2entry records when
+ * nsslapd-id2entry-binary-format is on.
+ *
+ * Unlike the LDIF form there is nothing to tokenize, unwrap or base64
+ * decode: the attribute type is stored once per attribute instead of once
+ * per value (along with the value's CSN options), values are length
+ * prefixed and CSNs are kept in binary.  All integers are big endian.
+ *
+ *    magic[3] version[1]
+ *    u32 rdn length, rdn
+ *    u32 uniqueid length, uniqueid
+ *    u32 attribute count
+ *    attribute:
+ *        u8  flags (ENTRYBIN_ATTR_*)
+ *        u16 type length, type
+ *        csn attribute deletion csn, if ENTRYBIN_ATTR_ADCSN is set
+ *        u32 present value count, u32 deleted value count
+ *        value:
+ *            u8 csn count, [u8 csn type, csn]*
+ *            u32 value length, value
+ *    csn: u32 time, u16 seqnum, u16 replica id, u16 subseqnum
+ *
+ * The magic starts with a NUL byte, which can never start an LDIF entry,
+ * so both formats can be mixed in the same id2entry database.
+ */
+#define ENTRYBIN_MAGIC "\0EB"
+#define ENTRYBIN_MAGIC_LEN 3
+#define ENTRYBIN_VERSION 1
+#define ENTRYBIN_HEADER_LEN (ENTRYBIN_MAGIC_LEN + 1)
+#define ENTRYBIN_CSN_LEN 10
+#define ENTRYBIN_MAX_CSNS 255
+
+#define ENTRYBIN_ATTR_DELETED 0x1
+#define ENTRYBIN_ATTR_ADCSN 0x2
+
+typedef struct entrybin_reader
+{
+    const unsigned char *p;
+    const unsigned char *end;
+} entrybin_reader;
+
+static unsigned char *
+entrybin_put_uint16(unsigned char *p, uint16_t v)
+{
+    p[0] = (unsigned char)(v >> 8);
+    p[1] = (unsigned char)v;
+    return p + 2;
+}
+
+static unsigned char *
+entrybin_put_uint32(unsigned char *p, uint32_t v)
+{
+    p[0] = (unsigned char)(v >> 24);
+    p[1] = (unsigned char)(v >> 16);
+    p[2] = (unsigned char)(v >> 8);
+    p[3] = (unsigned char)v;
+    return p + 4;
+}
+
+static unsigned char *
+entrybin_put_csn(unsigned char *p, const CSN *csn)
+{
+    p = entrybin_put_uint32(p, (uint32_t)csn->tstamp);
+    p = entrybin_put_uint16(p, csn->seqnum);
+    p = entrybin_put_uint16(p, csn->rid);
+    return entrybin_put_uint16(p, csn->subseqnum);
+}
+
+static unsigned char *
+entrybin_put_string(unsigned char *p, const char *s, size_t len)
+{
+    p = entrybin_put_uint32(p, (uint32_t)len);
+    if (len) {
+        memcpy(p, s, len);
+    }
+    return p + len;
+}
+
+static int
+entrybin_get_uint8(entrybin_reader *r, uint8_t *v)
+{
+    if (r->end - r->p < 1) {
+        return -1;
+    }
+    *v = r->p[0];
+    r->p += 1;
+    return 0;
+}
+
+static int
+entrybin_get_uint16(entrybin_reader *r, uint16_t *v)
+{
+    if (r->end - r->p < 2) {
+        return -1;
+    }
+    *v = ((uint16_t)r->p[0] << 8) | (uint16_t)r->p[1];
+    r->p += 2;
+    return 0;
+}
+
+static int
+entrybin_get_uint32(entrybin_reader *r, uint32_t *v)
+{
+    if (r->end - r->p < 4) {
+        return -1;
+    }
+    *v = ((uint32_t)r->p[0] << 24) | ((uint32_t)r->p[1] << 16) |
+         ((uint32_t)r->p[2] << 8) | (uint32_t)r->p[3];
+    r->p += 4;
+    return 0;
+}
+
+static int
+entrybin_get_bytes(entrybin_reader *r, size_t len, const char **s)
+{
+    if ((size_t)(r->end - r->p) < len) {
+        return -1;
+    }
+    *s = (const char *)r->p;
+    r->p += len;
+    return 0;
+}
+
+static int
+entrybin_get_string(entrybin_reader *r, const char **s, uint32_t *len)
+{
+    if (entrybin_get_uint32(r, len)) {
+        return -1;
+    }
+    return entrybin_get_bytes(r, *len, s);
+}
+
+static int
+entrybin_get_csn(entrybin_reader *r, CSN *csn)
+{
+    uint32_t tstamp = 0;
+
+    csn_init(csn);
+    if (entrybin_get_uint32(r, &tstamp) ||
+        entrybin_get_uint16(r, &csn->seqnum) ||
+        entrybin_get_uint16(r, &csn->rid) ||
+        entrybin_get_uint16(r, &csn->subseqnum)) {
+        return -1;
+    }
+    csn->tstamp = (time_t)tstamp;
+    return 0;
+}
+
+/*
+ * Read one value record. The csns are only collected when csnset is not NULL,
+ * and maxcsn is raised to the highest of them.
+ */
+static int
+entrybin_get_value_record(entrybin_reader *r, CSNSet **csnset, CSN **maxcsn, struct berval *bv)
+{
+    uint8_t ncsns = 0;
+    uint32_t vlen = 0;
+    const char *s = NULL;
+
+    if (entrybin_get_uint8(r, &ncsns)) {
+        return -1;
+    }
+    for (size_t i = 0; i < ncsns; i++) {
+        uint8_t t = 0;
+        CSN csn;
+        if (entrybin_get_uint8(r, &t) || entrybin_get_csn(r, &csn)) {
+            return -1;
+        }
+        if (csnset) {
+            csnset_add_csn(csnset, (CSNType)t, &csn);
+            if (*maxcsn == NULL) {
+                *maxcsn = csn_dup(&csn);
+            } else if (csn_compare(*maxcsn, &csn) < 0) {
+                csn_init_by_csn(*maxcsn, &csn);
+            }
+        }
+    }
+    if (entrybin_get_string(r, &s, &vlen)) {
+        return -1;
+    }
+    bv->bv_val = (char *)s;
+    bv->bv_len = vlen;
+    return 0;
+}
+
+static int
+entrybin_skip_attr(const Slapi_Attr *a)
+{
+    if (is_type_protected(a->a_type) || strcasecmp(a->a_type, SLAPI_ATTR_UNIQUEID) == 0) {
+        /* uniqueid has its own slot in the header */
+        return 1;
+    }
+    return valueset_isempty(&a->a_present_values) &&
+           valueset_isempty(&a->a_deleted_values) &&
+           (a->a_deletioncsn == NULL);
+}
+
+static size_t
+entrybin_size_valueset(const Slapi_ValueSet *vs, uint32_t *nvalues)
+{
+    size_t len = 0;
+
+    *nvalues = 0;
+    if (!valueset_isempty(vs)) {
+        Slapi_Value **va = valueset_get_valuearray(vs);
+        for (size_t i = 0; va[i] != NULL; i++) {
+            size_t ncsns = 0;
+            for (const CSNSet *n = va[i]->v_csnset; n != NULL && ncsns < ENTRYBIN_MAX_CSNS; n = n->next) {
+                ncsns++;
+            }
+            len += 1 + ncsns * (1 + ENTRYBIN_CSN_LEN) + 4 + va[i]->bv.bv_len;
+            (*nvalues)++;
+        }
+    }
+    return len;
+}
+
+static unsigned char *
+entrybin_put_valueset(unsigned char *p, const Slapi_ValueSet *vs)
+{
+    if (!valueset_isempty(vs)) {
+        Slapi_Value **va = valueset_get_valuearray(vs);
+        for (size_t i = 0; va[i] != NULL; i++) {
+            unsigned char *ncsnsp = p++;
+            size_t ncsns = 0;
+            for (const CSNSet *n = va[i]->v_csnset; n != NULL && ncsns < ENTRYBIN_MAX_CSNS; n = n->next) {
+                *p++ = (unsigned char)n->type;
+                p = entrybin_put_csn(p, &n->csn);
+                ncsns++;
+            }
+            *ncsnsp = (unsigned char)ncsns;
+            p = entrybin_put_string(p, va[i]->bv.bv_val, va[i]->bv.bv_len);
+        }
+    }
+    return p;
+}
+
+static size_t
+entrybin_size_attrlist(const Slapi_Attr *attrlist, uint32_t *nattrs)
+{
+    size_t len = 0;
+    uint32_t nvalues;
+
+    for (const Slapi_Attr *a = attrlist; a; a = a->a_next) {
+        if (entrybin_skip_attr(a)) {
+            continue;
+        }
+        len += 1 + 2 + strlen(a->a_type) + 4 + 4;
+        if (a->a_deletioncsn) {
+            len += ENTRYBIN_CSN_LEN;
+        }
+        len += entrybin_size_valueset(&a->a_present_values, &nvalues);
+        len += entrybin_size_valueset(&a->a_deleted_values, &nvalues);
+        (*nattrs)++;
+    }
+    return len;
+}
+
+static unsigned char *
+entrybin_put_attrlist(unsigned char *p, const Slapi_Attr *attrlist, int attr_state)
+{
+    uint32_t npresent, ndeleted;
+
+    for (const Slapi_Attr *a = attrlist; a; a = a->a_next) {
+        size_t typelen;
+        uint8_t aflags = 0;
+
+        if (entrybin_skip_attr(a)) {
+            continue;
+        }
+        if (attr_state == ATTRIBUTE_DELETED) {
+            aflags |= ENTRYBIN_ATTR_DELETED;
+        }
+        if (a->a_deletioncsn) {
+            aflags |= ENTRYBIN_ATTR_ADCSN;
+        }
+        *p++ = aflags;
+        typelen = strlen(a->a_type);
+        p = entrybin_put_uint16(p, (uint16_t)typelen);
+        memcpy(p, a->a_type, typelen);
+        p += typelen;
+        if (a->a_deletioncsn) {
+            p = entrybin_put_csn(p, a->a_deletioncsn);
+        }
+        entrybin_size_valueset(&a->a_present_values, &npresent);
+        entrybin_size_valueset(&a->a_deleted_values, &ndeleted);
+        p = entrybin_put_uint32(p, npresent);
+        p = entrybin_put_uint32(p, ndeleted);
+        p = entrybin_put_valueset(p, &a->a_present_values);
+        p = entrybin_put_valueset(p, &a->a_deleted_values);
+    }
+    return p;
+}
+
+/*
+ * Returns 1 if data holds an entry in the binary format.
+ */
+int
+entrybin_is_binary(const char *data, size_t len)
+{
+    return (data != NULL) && (len >= ENTRYBIN_HEADER_LEN) &&
+           (memcmp(data, ENTRYBIN_MAGIC, ENTRYBIN_MAGIC_LEN) == 0);
+}
+
+/*
+ * Flatten an entry with its state information into the binary format.
+ * This is the binary counterpart of slapi_entry2str_with_options() with
+ * SLAPI_DUMP_STATEINFO | SLAPI_DUMP_UNIQUEID | SLAPI_DUMP_RDN_ENTRY.
+ * The returned buffer must be freed with slapi_ch_free.
+ */
+char *
+entry2bin(Slapi_Entry *e, size_t *len)
+{
+    const char *rdn = NULL;
+    const char *uniqueid = slapi_entry_get_uniqueid(e);
+    size_t rdnlen, uniqueidlen;
+    size_t elen = ENTRYBIN_HEADER_LEN;
+    uint32_t nattrs = 0;
+    unsigned char *ebuf, *p;
+
+    if (NULL == slapi_entry_get_rdn_const(e) &&
+        NULL != slapi_entry_get_dn_const(e)) {
+        /* e_srdn is not filled in, use e_sdn */
+        slapi_rdn_init_all_sdn(&e->e_srdn, slapi_entry_get_sdn_const(e));
+    }
+    rdn = slapi_entry_get_rdn_const(e);
+    rdnlen = rdn ? strlen(rdn) : 0;
+    uniqueidlen = uniqueid ? strlen(uniqueid) : 0;
+
+    elen += 4 + rdnlen + 4 + uniqueidlen + 4;
+    elen += entrybin_size_attrlist(e->e_attrs, &nattrs);
+    elen += entrybin_size_attrlist(e->e_deleted_attrs, &nattrs);
+
+    p = ebuf = (unsigned char *)slapi_ch_malloc(elen);
+    memcpy(p, ENTRYBIN_MAGIC, ENTRYBIN_MAGIC_LEN);
+    p += ENTRYBIN_MAGIC_LEN;
+    *p++ = ENTRYBIN_VERSION;
+    p = entrybin_put_string(p, rdn, rdnlen);
+    p = entrybin_put_string(p, uniqueid, uniqueidlen);
+    p = entrybin_put_uint32(p, nattrs);
+    p = entrybin_put_attrlist(p, e->e_attrs, ATTRIBUTE_PRESENT);
+    p = entrybin_put_attrlist(p, e->e_deleted_attrs, ATTRIBUTE_DELETED);
+
+    if ((size_t)(p - ebuf) != elen) {
+        /* this should not happen */
+        slapi_log_err(SLAPI_LOG_NOTICE, "entry2bin",
+                      "Array boundary wrote: bufsize=%ld wrote=%ld\n",
+                      (long int)elen, (long int)(p - ebuf));
+    }
+    *len = p - ebuf;
+    return (char *)ebuf;
+}
+
+/*
+ * Build an entry from its binary form. As with slapi_str2entry_ext, normdn
+ * (and srdn when known) gives the entry DN; if normdn is NULL only the
+ * stored rdn is set. Supports SLAPI_STR2ENTRY_IGNORE_STATE and
+ * SLAPI_STR2ENTRY_NO_ENTRYDN.
+ */
+Slapi_Entry *
+bin2entry(const char *normdn, const Slapi_RDN *srdn, const char *data, size_t len, int flags)
+{
+    entrybin_reader r;
+    Slapi_Entry *e = NULL;
+    int read_stateinfo = !(flags & SLAPI_STR2ENTRY_IGNORE_STATE);
+    CSN *maxcsn = NULL;
+    CSNSet *valuecsnset = NULL;
+    char *type = NULL;
+    size_t typebuf_len = 0;
+    unsigned long attr_val_cnt = 0;
+    const char *s = NULL;
+    uint32_t slen = 0;
+    uint32_t nattrs = 0;
+
+    if (!entrybin_is_binary(data, len)) {
+        slapi_log_err(SLAPI_LOG_ERR, "bin2entry", "Not a binary entry\n");
+        return NULL;
+    }
+    if (data[ENTRYBIN_MAGIC_LEN] != ENTRYBIN_VERSION) {
+        slapi_log_err(SLAPI_LOG_ERR, "bin2entry",
+                      "Unsupported binary entry version %d\n", data[ENTRYBIN_MAGIC_LEN]);
+        return NULL;
+    }
+    r.p = (const unsigned char *)data + ENTRYBIN_HEADER_LEN;
+    r.end = (const unsigned char *)data + len;
+
+    e = slapi_entry_alloc();
+    slapi_entry_init(e, NULL, NULL);
+
+    if (normdn) {
+        /* normdn is consumed in e */
+        slapi_entry_set_normdn(e, slapi_ch_strdup(normdn));
+        if (srdn) {
+            /* we can use the rdn generated in entryrdn_lookup_dn */
+            slapi_entry_set_srdn(e, srdn);
+        } else {
+            slapi_entry_set_rdn(e, (char *)normdn);
+        }
+    }
+
+    if (entrybin_get_string(&r, &s, &slen)) {
+        goto bad;
+    }
+    if (NULL == slapi_entry_get_rdn_const(e) && slen) {
+        char *rdn = slapi_ch_malloc(slen + 1);
+        memcpy(rdn, s, slen);
+        rdn[slen] = '\0';
+        slapi_entry_set_rdn(e, rdn);
+        slapi_ch_free_string(&rdn);
+    }
+    if (entrybin_get_string(&r, &s, &slen)) {
+        goto bad;
+    }
+    if (slen) {
+        char *uniqueid = slapi_ch_malloc(slen + 1);
+        memcpy(uniqueid, s, slen);
+        uniqueid[slen] = '\0';
+        /* uniqueid is consumed in e */
+        slapi_entry_set_uniqueid(e, uniqueid);
+    }
+    if (entrybin_get_uint32(&r, &nattrs)) {
+        goto bad;
+    }
+
+    for (uint32_t i = 0; i < nattrs; i++) {
+        Slapi_Attr **a = NULL;
+        uint8_t aflags = 0;
+        uint16_t typelen = 0;
+        uint32_t nvalues[2] = {0, 0};
+        CSN adcsn;
+        int is_objectclass;
+
+        if (entrybin_get_uint8(&r, &aflags) ||
+            entrybin_get_uint16(&r, &typelen) ||
+            entrybin_get_bytes(&r, typelen, &s)) {
+            goto bad;
+        }
+        if (typebuf_len < (size_t)typelen + 1) {
+            typebuf_len = (size_t)typelen + 1;
+            type = slapi_ch_realloc(type, typebuf_len);
+        }
+        memcpy(type, s, typelen);
+        type[typelen] = '\0';
+        if ((aflags & ENTRYBIN_ATTR_ADCSN) && entrybin_get_csn(&r, &adcsn)) {
+            goto bad;
+        }
+        if (entrybin_get_uint32(&r, &nvalues[0]) || entrybin_get_uint32(&r, &nvalues[1])) {
+            goto bad;
+        }
+
+        if ((aflags & ENTRYBIN_ATTR_DELETED) && !read_stateinfo) {
+            /* ignore deleted attributes */
+        } else if ((flags & SLAPI_STR2ENTRY_NO_ENTRYDN) &&
+                   strcasecmp(type, SLAPI_ATTR_ENTRYDN) == 0) {
+            /* If SLAPI_STR2ENTRY_NO_ENTRYDN is set, skip entrydn */
+        } else {
+            Slapi_Attr **alist = (aflags & ENTRYBIN_ATTR_DELETED) ? &e->e_deleted_attrs : &e->e_attrs;
+            if (attrlist_append_nosyntax_init(alist, type, &a) == 0 /* Found */) {
+                slapi_log_err(SLAPI_LOG_ERR, "bin2entry",
+                              "Duplicate attribute %s\n", type);
+                goto bad;
+            }
+            if ((aflags & ENTRYBIN_ATTR_ADCSN) && read_stateinfo) {
+                attr_set_deletion_csn(*a, &adcsn);
+                if (maxcsn == NULL) {
+                    maxcsn = csn_dup(&adcsn);
+                } else if (csn_compare(maxcsn, &adcsn) < 0) {
+                    csn_init_by_csn(maxcsn, &adcsn);
+                }
+            }
+        }
+        is_objectclass = (a != NULL) && (strcasecmp(type, SLAPI_ATTR_OBJECTCLASS) == 0);
+
+        for (int deleted = 0; deleted < 2; deleted++) {
+            for (uint32_t j = 0; j < nvalues[deleted]; j++) {
+                struct berval bv = {0};
+                Slapi_Value *svalue = NULL;
+                int keep = (a != NULL) && (!deleted || read_stateinfo);
+
+                if (entrybin_get_value_record(&r, (keep && read_stateinfo) ? &valuecsnset : NULL, &maxcsn, &bv)) {
+                    goto bad;
+                }
+                if (!keep) {
+                    continue;
+                }
+                if (++attr_val_cnt >= ENTRY_MAX_ATTRIBUTE_VALUE_COUNT) {
+                    slapi_log_err(SLAPI_LOG_ERR, "bin2entry",
+                                  "entry %s exceeded max attribute value count %ld\n",
+                                  slapi_entry_get_dn_const(e) ? (char *)slapi_entry_get_dn_const(e) : "unknown",
+                                  attr_val_cnt);
+                    goto bad;
+                }
+                if (!deleted && is_objectclass) {
+                    if (bv.bv_len == SLAPI_ATTR_VALUE_SUBENTRY_LENGTH &&
+                        PL_strncasecmp(bv.bv_val, SLAPI_ATTR_VALUE_SUBENTRY, bv.bv_len) == 0)
+                        e->e_flags |= SLAPI_ENTRY_FLAG_LDAPSUBENTRY;
+                    if (bv.bv_len == SLAPI_ATTR_VALUE_TOMBSTONE_LENGTH &&
+                        PL_strncasecmp(bv.bv_val, SLAPI_ATTR_VALUE_TOMBSTONE, bv.bv_len) == 0)
+                        e->e_flags |= SLAPI_ENTRY_FLAG_TOMBSTONE;
+                }
+                svalue = value_new(&bv, CSN_TYPE_NONE, NULL);
+                if (slapi_attr_is_dn_syntax_attr(*a)) {
+                    /* same invariant as str2entry_fast: DN values are normalized */
+                    if (value_dn_normalize_value(svalue) == 0) {
+                        (*a)->a_flags |= SLAPI_ATTR_FLAG_NORMALIZED_CES;
+                    }
+                }
+                svalue->v_csnset = valuecsnset;
+                valuecsnset = NULL;
+                {
+                    const CSN *distinguishedcsn = csnset_get_csn_of_type(svalue->v_csnset, CSN_TYPE_VALUE_DISTINGUISHED);
+                    if (distinguishedcsn != NULL) {
+                        entry_add_dncsn_ext(e, distinguishedcsn, ENTRY_DNCSN_INCREASING);
+                    }
+                }
+                /* consumes the value */
+                slapi_valueset_add_attr_value_ext(*a,
+                                                  deleted ? &(*a)->a_deleted_values : &(*a)->a_present_values,
+                                                  svalue, SLAPI_VALUE_FLAG_PASSIN);
+            }
+        }
+    }
+    if (r.p != r.end) {
+        goto bad;
+    }
+
+    if (read_stateinfo && maxcsn) {
+        e->e_maxcsn = maxcsn;
+        maxcsn = NULL;
+    }
+
+    /* If this is a tombstone, it requires a special treatment for rdn. */
+    if ((e->e_flags & SLAPI_ENTRY_FLAG_TOMBSTONE) && slapi_entry_get_dn_const(e)) {
+        if (_entry_set_tombstone_rdn(e, slapi_entry_get_dn_const(e))) {
+            slapi_log_err(SLAPI_LOG_TRACE, "bin2entry",
+                          "tombstone entry has badly formatted dn: %s\n",
+                          slapi_entry_get_dn_const(e));
+            slapi_entry_free(e);
+            e = NULL;
+        }
+    }
+    goto done;
+
+bad:
+    slapi_log_err(SLAPI_LOG_ERR, "bin2entry", "Malformed binary entry (dn: %s)\n",
+                  normdn ? normdn : "unknown");
+    slapi_entry_free(e);
+    e = NULL;
+done:
+    csnset_free(&valuecsnset);
+    csn_free(&maxcsn);
+    slapi_ch_free_string(&type);
+    return e;
+}
+
+/*
+ * Binary counterpart of get_value_from_string(): return in value a copy of
+ * the first present value of type ("rdn" returns the stored rdn).
+ * Returns 0 if the value was found.
+ */
+int
+entrybin_get_value(const char *data, size_t len, const char *type, char **value)
+{
+    entrybin_reader r;
+    const char *s = NULL;
+    uint32_t slen = 0;
+    uint32_t nattrs = 0;
+    size_t typelen = strlen(type);
+
+    *value = NULL;
+    if (!entrybin_is_binary(data, len) || data[ENTRYBIN_MAGIC_LEN] != ENTRYBIN_VERSION) {
+        return -1;
+    }
+    r.p = (const unsigned char *)data + ENTRYBIN_HEADER_LEN;
+    r.end = (const unsigned char *)data + len;
+
+    if (entrybin_get_string(&r, &s, &slen)) {
+        return -1;
+    }
+    if (strcasecmp(type, SLAPI_ATTR_RDN) == 0) {
+        goto found;
+    }
+    if (entrybin_get_string(&r, &s, &slen) ||
+        entrybin_get_uint32(&r, &nattrs)) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < nattrs; i++) {
+        uint8_t aflags = 0;
+        uint16_t atypelen = 0;
+        uint32_t nvalues[2] = {0, 0};
+        CSN adcsn;
+        const char *atype = NULL;
+        struct berval bv = {0};
+
+        if (entrybin_get_uint8(&r, &aflags) ||
+            entrybin_get_uint16(&r, &atypelen) ||
+            entrybin_get_bytes(&r, atypelen, &atype)) {
+            return -1;
+        }
+        if ((aflags & ENTRYBIN_ATTR_ADCSN) && entrybin_get_csn(&r, &adcsn)) {
+            return -1;
+        }
+        if (entrybin_get_uint32(&r, &nvalues[0]) || entrybin_get_uint32(&r, &nvalues[1])) {
+            return -1;
+        }
+        if (!(aflags & ENTRYBIN_ATTR_DELETED) && nvalues[0] > 0 &&
+            atypelen == typelen && PL_strncasecmp(atype, type, typelen) == 0) {
+            if (entrybin_get_value_record(&r, NULL, NULL, &bv)) {
+                return -1;
+            }
+            s = bv.bv_val;
+            slen = bv.bv_len;
+            goto found;
+        }
+        for (uint64_t j = 0; j < (uint64_t)nvalues[0] + nvalues[1]; j++) {
+            if (entrybin_get_value_record(&r, NULL, NULL, &bv)) {
+                return -1;
+            }
+        }
+    }
+    return -1;
+
+found:
+    *value = slapi_ch_malloc(slen + 1);
+    memcpy(*value, s, slen);
+    (*value)[slen] = '\0';
+    return 0;
+}
+
+/*
+ * Convert an entry in the binary format to the LDIF form written by
+ * id2entry ("rdn: ..." with the state information), for the code that
+ * still parses the stored LDIF.
+ */
+char *
+entrybin2str(const char *data, size_t len, int *slen)
+{
+    Slapi_Entry *e = bin2entry(NULL, NULL, data, len, 0);
+    char *s = NULL;
+
+    if (e) {
+        s = slapi_entry2str_with_options(e, slen,
+                                         SLAPI_DUMP_STATEINFO | SLAPI_DUMP_UNIQUEID | SLAPI_DUMP_RDN_ENTRY);
+        slapi_entry_free(e);
+    }
+    return s;
+}
+
 static int entry_type = -1; /* The type number assigned by the Factory for 'Entry' */
 
 int
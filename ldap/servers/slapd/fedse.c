@@ -2638,6 +2638,9 @@ init_dse_file(const char *configdir, Slapi_DN *config)
     if (pfedse == NULL) {
         pfedse = dse_new(DSE_FILENAME, DSE_TMPFILE, DSE_BACKFILE, DSE_STARTOKFILE, configdir);
         rc = (pfedse != NULL);
+        if (rc) {
+            dse_set_journal(pfedse, DSE_JOURNALFILE);
+        }
     }
     if (rc) {
         Slapi_PBlock *pb = slapi_pblock_new();
@@ -189,6 +189,7 @@ slapi_onoff_t init_errorlog_compress_enabled;
 slapi_onoff_t init_errorlogbuffering;
 slapi_onoff_t init_accesslog_logging_enabled;
 slapi_onoff_t init_accesslogbuffering;
+slapi_onoff_t init_accesslog_async_writer;
 slapi_onoff_t init_securitylog_logging_enabled;
 slapi_onoff_t init_securitylogbuffering;
 slapi_onoff_t init_external_libs_debug_enabled;
@@ -253,6 +254,7 @@ slapi_onoff_t init_ndn_cache_enabled;
 slapi_onoff_t init_sasl_mapping_fallback;
 slapi_onoff_t init_return_orig_type;
 slapi_onoff_t init_enable_turbo_mode;
+slapi_onoff_t init_workqueue_sharding;
 slapi_onoff_t init_connection_nocanon;
 slapi_onoff_t init_plugin_logging;
 slapi_int_t init_connection_buffer;
@@ -857,6 +859,14 @@ static struct config_get_and_set
      NULL, 0,
      (void **)&global_slapdFrontendConfig.accesslogbuffering,
      CONFIG_ON_OFF, NULL, &init_accesslogbuffering, NULL},
+    {CONFIG_ACCESSLOG_ASYNC_WRITER_ATTRIBUTE, config_set_accesslog_async_writer,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.accesslog_async_writer,
+     CONFIG_ON_OFF, (ConfigGetFunc)config_get_accesslog_async_writer, &init_accesslog_async_writer, NULL},
+    {CONFIG_ACCESSLOG_ASYNC_OVERFLOW_ATTRIBUTE, config_set_accesslog_async_overflow,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.accesslog_async_overflow,
+     CONFIG_STRING, NULL, SLAPD_INIT_ACCESSLOG_ASYNC_OVERFLOW, NULL},
     {CONFIG_AUDITLOG_BUFFERING_ATTRIBUTE, config_set_auditlogbuffering,
      NULL, 0,
      (void **)&global_slapdFrontendConfig.auditlogbuffering,
@@ -1234,6 +1244,10 @@ static struct config_get_and_set
      NULL, 0,
      (void **)&global_slapdFrontendConfig.enable_turbo_mode,
      CONFIG_ON_OFF, (ConfigGetFunc)config_get_enable_turbo_mode, &init_enable_turbo_mode, NULL},
+    {CONFIG_WORKQUEUE_SHARDING, config_set_workqueue_sharding,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.workqueue_sharding,
+     CONFIG_ON_OFF, (ConfigGetFunc)config_get_workqueue_sharding, &init_workqueue_sharding, NULL},
     {CONFIG_CONNECTION_BUFFER, config_set_connection_buffer,
      NULL, 0,
      (void **)&global_slapdFrontendConfig.connection_buffer,
@@ -1484,6 +1498,51 @@ static struct config_get_and_set
      (void **)&global_slapdFrontendConfig.maxcontrols_per_op,
      CONFIG_INT, (ConfigGetFunc)config_get_maxcontrolsperop,
      SLAPD_DEFAULT_MAXCONTROLS_PER_OP_STR, NULL},
+    {CONFIG_RESULT_BATCH_SIZE_ATTRIBUTE, config_set_result_batch_size,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.result_batch_size,
+     CONFIG_INT, (ConfigGetFunc)config_get_result_batch_size,
+     SLAPD_DEFAULT_RESULT_BATCH_SIZE_STR, NULL},
+    {CONFIG_RESULT_BATCH_ENTRIES_ATTRIBUTE, config_set_result_batch_entries,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.result_batch_entries,
+     CONFIG_INT, (ConfigGetFunc)config_get_result_batch_entries,
+     SLAPD_DEFAULT_RESULT_BATCH_ENTRIES_STR, NULL},
+    {CONFIG_RESULT_BATCH_DELAY_ATTRIBUTE, config_set_result_batch_delay,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.result_batch_delay,
+     CONFIG_INT, (ConfigGetFunc)config_get_result_batch_delay,
+     SLAPD_DEFAULT_RESULT_BATCH_DELAY_STR, NULL},
+    {CONFIG_PWVERIFY_THREADS_ATTRIBUTE, config_set_pwverify_threads,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.pwverify_threads,
+     CONFIG_INT, (ConfigGetFunc)config_get_pwverify_threads,
+     SLAPD_DEFAULT_PWVERIFY_THREADS_STR, NULL},
+    {CONFIG_PWVERIFY_CACHE_TTL_ATTRIBUTE, config_set_pwverify_cache_ttl,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.pwverify_cache_ttl,
+     CONFIG_INT, (ConfigGetFunc)config_get_pwverify_cache_ttl,
+     SLAPD_DEFAULT_PWVERIFY_CACHE_TTL_STR, NULL},
+    {CONFIG_PWVERIFY_CACHE_SIZE_ATTRIBUTE, config_set_pwverify_cache_size,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.pwverify_cache_size,
+     CONFIG_INT, (ConfigGetFunc)config_get_pwverify_cache_size,
+     SLAPD_DEFAULT_PWVERIFY_CACHE_SIZE_STR, NULL},
+    {CONFIG_BIND_STATE_WRITE_WINDOW_ATTRIBUTE, config_set_bind_state_write_window,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.bind_state_write_window,
+     CONFIG_INT, (ConfigGetFunc)config_get_bind_state_write_window,
+     SLAPD_DEFAULT_BIND_STATE_WRITE_WINDOW_STR, NULL},
+    {CONFIG_BIND_STATE_WRITE_BATCH_ATTRIBUTE, config_set_bind_state_write_batch,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.bind_state_write_batch,
+     CONFIG_INT, (ConfigGetFunc)config_get_bind_state_write_batch,
+     SLAPD_DEFAULT_BIND_STATE_WRITE_BATCH_STR, NULL},
+    {CONFIG_DSE_JOURNAL_DELAY_ATTRIBUTE, config_set_dse_journal_delay,
+     NULL, 0,
+     (void **)&global_slapdFrontendConfig.dse_journal_delay,
+     CONFIG_INT, (ConfigGetFunc)config_get_dse_journal_delay,
+     SLAPD_DEFAULT_DSE_JOURNAL_DELAY_STR, NULL},
     {CONFIG_IGNORED_CRITICALITY_LIST_ATTRIBUTE,
      config_set_ignored_criticality_list, NULL, 0,
      (void **)&global_slapdFrontendConfig.ignored_criticality_list,
@@ -1959,6 +2018,8 @@ FrontendConfig_init(void)
     cfg->accesslog_log_format = slapi_ch_strdup(SLAPD_INIT_LOG_FORMAT);
     cfg->accesslog_time_format = slapi_ch_strdup(SLAPD_INIT_ACCESS_LOG_TIME_FORMAT);
     init_accesslogbuffering = cfg->accesslogbuffering = LDAP_ON;
+    init_accesslog_async_writer = cfg->accesslog_async_writer = LDAP_ON;
+    cfg->accesslog_async_overflow = slapi_ch_strdup(SLAPD_INIT_ACCESSLOG_ASYNC_OVERFLOW);
     init_csnlogging = cfg->csnlogging = LDAP_ON;
     init_accesslog_compress_enabled = cfg->accesslog_compress = LDAP_OFF;
     cfg->statloglevel = SLAPD_DEFAULT_STATLOG_LEVEL;
@@ -2058,6 +2119,7 @@ FrontendConfig_init(void)
     cfg->unhashed_pw_switch = SLAPD_DEFAULT_UNHASHED_PW_SWITCH;
     init_return_orig_type = cfg->return_orig_type = LDAP_OFF;
     init_enable_turbo_mode = cfg->enable_turbo_mode = LDAP_ON;
+    init_workqueue_sharding = cfg->workqueue_sharding = LDAP_ON;
     init_connection_buffer = cfg->connection_buffer = CONNECTION_BUFFER_ON;
     init_connection_nocanon = cfg->connection_nocanon = LDAP_ON;
     init_plugin_logging = cfg->plugin_logging = LDAP_OFF;
@@ -2068,6 +2130,15 @@ FrontendConfig_init(void)
     init_global_backend_local = LDAP_OFF;
     cfg->maxsimplepaged_per_conn = SLAPD_DEFAULT_MAXSIMPLEPAGED_PER_CONN;
     cfg->maxcontrols_per_op = SLAPD_DEFAULT_MAXCONTROLS_PER_OP;
+    cfg->result_batch_size = SLAPD_DEFAULT_RESULT_BATCH_SIZE;
+    cfg->result_batch_entries = SLAPD_DEFAULT_RESULT_BATCH_ENTRIES;
+    cfg->result_batch_delay = SLAPD_DEFAULT_RESULT_BATCH_DELAY;
+    cfg->pwverify_threads = SLAPD_DEFAULT_PWVERIFY_THREADS;
+    cfg->pwverify_cache_ttl = SLAPD_DEFAULT_PWVERIFY_CACHE_TTL;
+    cfg->pwverify_cache_size = SLAPD_DEFAULT_PWVERIFY_CACHE_SIZE;
+    cfg->bind_state_write_window = SLAPD_DEFAULT_BIND_STATE_WRITE_WINDOW;
+    cfg->bind_state_write_batch = SLAPD_DEFAULT_BIND_STATE_WRITE_BATCH;
+    cfg->dse_journal_delay = SLAPD_DEFAULT_DSE_JOURNAL_DELAY;
     cfg->maxbersize = SLAPD_DEFAULT_MAXBERSIZE;
     cfg->logging_backend = slapi_ch_strdup(SLAPD_INIT_LOGGING_BACKEND_INTERNAL);
     cfg->rootdn = slapi_ch_strdup(SLAPD_DEFAULT_DIRECTORY_MANAGER);
@@ -8380,6 +8451,73 @@ config_set_accesslogbuffering(const char *attrname, char *value, char *errorbuf,
     return retVal;
 }
 
+int32_t
+config_set_accesslog_async_writer(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    int32_t retVal = LDAP_SUCCESS;
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+
+    retVal = config_set_onoff(attrname,
+                              value,
+                              &(slapdFrontendConfig->accesslog_async_writer),
+                              errorbuf,
+                              apply);
+
+    return retVal;
+}
+
+int32_t
+config_get_accesslog_async_writer(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return slapi_atomic_load_32(&(slapdFrontendConfig->accesslog_async_writer), __ATOMIC_ACQUIRE);
+}
+
+int32_t
+config_set_accesslog_async_overflow(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+
+    if (config_value_is_null(attrname, value, errorbuf, 0)) {
+        return LDAP_OPERATIONS_ERROR;
+    }
+
+    if (strcasecmp(value, "block") && strcasecmp(value, "drop")) {
+        slapi_create_errormsg(errorbuf, SLAPI_DSE_RETURNTEXT_SIZE,
+                              "%s: \"%s\" is invalid, the acceptable values "
+                              "are \"block\" and \"drop\"",
+                              attrname, value);
+        return LDAP_UNWILLING_TO_PERFORM;
+    }
+
+    if (apply) {
+        CFG_LOCK_WRITE(slapdFrontendConfig);
+        slapi_ch_free_string(&slapdFrontendConfig->accesslog_async_overflow);
+        slapdFrontendConfig->accesslog_async_overflow = slapi_ch_strdup(value);
+        CFG_UNLOCK_WRITE(slapdFrontendConfig);
+    }
+
+    return LDAP_SUCCESS;
+}
+
+int32_t
+config_get_accesslog_async_overflow(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    int32_t retVal;
+
+    /* map string value to int to avoid excessive freeing and duping */
+    CFG_LOCK_READ(slapdFrontendConfig);
+    if (strcasecmp(slapdFrontendConfig->accesslog_async_overflow, "drop") == 0) {
+        retVal = LOG_ASYNC_OVERFLOW_DROP;
+    } else {
+        retVal = LOG_ASYNC_OVERFLOW_BLOCK;
+    }
+    CFG_UNLOCK_READ(slapdFrontendConfig);
+
+    return retVal;
+}
+
 int32_t
 config_set_errorlogbuffering(const char *attrname, char *value, char *errorbuf, int apply)
 {
@@ -8974,6 +9112,13 @@ config_get_enable_turbo_mode(void)
     return slapi_atomic_load_32(&(slapdFrontendConfig->enable_turbo_mode), __ATOMIC_ACQUIRE);
 }
 
+int32_t
+config_get_workqueue_sharding(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return slapi_atomic_load_32(&(slapdFrontendConfig->workqueue_sharding), __ATOMIC_ACQUIRE);
+}
+
 int32_t
 config_get_connection_nocanon(void)
 {
@@ -9027,6 +9172,18 @@ config_set_enable_turbo_mode(const char *attrname, char *value, char *errorbuf,
     return retVal;
 }
 
+int32_t
+config_set_workqueue_sharding(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    int32_t retVal = LDAP_SUCCESS;
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+
+    retVal = config_set_onoff(attrname, value,
+                              &(slapdFrontendConfig->workqueue_sharding),
+                              errorbuf, apply);
+    return retVal;
+}
+
 int32_t
 config_set_connection_nocanon(const char *attrname, char *value, char *errorbuf, int apply)
 {
@@ -10218,6 +10375,229 @@ config_get_maxcontrolsperop()
     return retVal;
 }
 
+/*
+ * nsslapd-result-batch-size and nsslapd-result-batch-entries: search
+ * result entries are written to the client once either threshold is
+ * reached. 0 bytes, or a single entry, writes every entry on its own.
+ */
+static int
+config_set_result_batch_value(const char *attrname, char *value, char *errorbuf, int apply, slapi_int_t *field)
+{
+    long size;
+    char *endp;
+
+    if (config_value_is_null(attrname, value, errorbuf, 0)) {
+        return LDAP_OPERATIONS_ERROR;
+    }
+
+    errno = 0;
+    size = strtol(value, &endp, 10);
+    if (*endp != '\0' || errno == ERANGE || size < 0 || size > INT32_MAX) {
+        slapi_create_errormsg(errorbuf, SLAPI_DSE_RETURNTEXT_SIZE,
+                              "(%s) value (%s) is invalid, must be a positive integer\n",
+                              attrname, value);
+        return LDAP_OPERATIONS_ERROR;
+    }
+
+    if (!apply) {
+        return LDAP_SUCCESS;
+    }
+
+    slapi_atomic_store_32(field, (int32_t)size, __ATOMIC_RELEASE);
+    return LDAP_SUCCESS;
+}
+
+int
+config_set_result_batch_size(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return config_set_result_batch_value(attrname, value, errorbuf, apply,
+                                         &(slapdFrontendConfig->result_batch_size));
+}
+
+int
+config_set_result_batch_entries(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return config_set_result_batch_value(attrname, value, errorbuf, apply,
+                                         &(slapdFrontendConfig->result_batch_entries));
+}
+
+int32_t
+config_get_result_batch_size(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return slapi_atomic_load_32(&(slapdFrontendConfig->result_batch_size), __ATOMIC_ACQUIRE);
+}
+
+int32_t
+config_get_result_batch_entries(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return slapi_atomic_load_32(&(slapdFrontendConfig->result_batch_entries), __ATOMIC_ACQUIRE);
+}
+
+static int config_set_bounded_int_value(const char *attrname, char *value, char *errorbuf, int apply, slapi_int_t *field, long min, long max);
+
+/*
+ * nsslapd-result-batch-delay: milliseconds the oldest batched entry may
+ * wait before the batch is written anyway.
+ */
+int
+config_set_result_batch_delay(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return config_set_bounded_int_value(attrname, value, errorbuf, apply,
+                                        &(slapdFrontendConfig->result_batch_delay), 1, 60000);
+}
+
+int32_t
+config_get_result_batch_delay(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return slapi_atomic_load_32(&(slapdFrontendConfig->result_batch_delay), __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Password verification for binds, see pw_verify.c.
+ *
+ * nsslapd-pwverify-threads: size of the pool hashing bind passwords, -1
+ * sizes it on the number of CPUs, 0 hashes on the worker thread. It is read
+ * at startup only.
+ * nsslapd-pwverify-cache-ttl: seconds a successful bind password is
+ * remembered, 0 disables the cache.
+ * nsslapd-pwverify-cache-size: number of bind passwords remembered.
+ */
+static int
+config_set_bounded_int_value(const char *attrname, char *value, char *errorbuf, int apply, slapi_int_t *field, long min, long max)
+{
+    long num;
+    char *endp;
+
+    if (config_value_is_null(attrname, value, errorbuf, 0)) {
+        return LDAP_OPERATIONS_ERROR;
+    }
+
+    errno = 0;
+    num = strtol(value, &endp, 10);
+    if (*endp != '\0' || errno == ERANGE || num < min || num > max) {
+        slapi_create_errormsg(errorbuf, SLAPI_DSE_RETURNTEXT_SIZE,
+                              "(%s) value (%s) is invalid, must be between %ld and %ld\n",
+                              attrname, value, min, max);
+        return LDAP_OPERATIONS_ERROR;
+    }
+
+    if (!apply) {
+        return LDAP_SUCCESS;
+    }
+
+    slapi_atomic_store_32(field, (int32_t)num, __ATOMIC_RELEASE);
+    return LDAP_SUCCESS;
+}
+
+int
+config_set_pwverify_threads(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return config_set_bounded_int_value(attrname, value, errorbuf, apply,
+                                        &(slapdFrontendConfig->pwverify_threads), -1, 256);
+}
+
+int
+config_set_pwverify_cache_ttl(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return config_set_bounded_int_value(attrname, value, errorbuf, apply,
+                                        &(slapdFrontendConfig->pwverify_cache_ttl), 0, 86400);
+}
+
+int
+config_set_pwverify_cache_size(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return config_set_bounded_int_value(attrname, value, errorbuf, apply,
+                                        &(slapdFrontendConfig->pwverify_cache_size), 1, 1048576);
+}
+
+int32_t
+config_get_pwverify_threads(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return slapi_atomic_load_32(&(slapdFrontendConfig->pwverify_threads), __ATOMIC_ACQUIRE);
+}
+
+int32_t
+config_get_pwverify_cache_ttl(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return slapi_atomic_load_32(&(slapdFrontendConfig->pwverify_cache_ttl), __ATOMIC_ACQUIRE);
+}
+
+int32_t
+config_get_pwverify_cache_size(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return slapi_atomic_load_32(&(slapdFrontendConfig->pwverify_cache_size), __ATOMIC_ACQUIRE);
+}
+
+/*
+ * Bind state write-behind, see pw_retry.c.
+ *
+ * nsslapd-bind-state-write-window: milliseconds the password retry counters
+ * and login times written by binds are held and merged per entry before
+ * being applied, 0 writes them at once.
+ * nsslapd-bind-state-write-batch: entries updated per backend transaction.
+ */
+int
+config_set_bind_state_write_window(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return config_set_bounded_int_value(attrname, value, errorbuf, apply,
+                                        &(slapdFrontendConfig->bind_state_write_window), 0, 60000);
+}
+
+int
+config_set_bind_state_write_batch(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return config_set_bounded_int_value(attrname, value, errorbuf, apply,
+                                        &(slapdFrontendConfig->bind_state_write_batch), 1, 10000);
+}
+
+int32_t
+config_get_bind_state_write_window(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return slapi_atomic_load_32(&(slapdFrontendConfig->bind_state_write_window), __ATOMIC_ACQUIRE);
+}
+
+int32_t
+config_get_bind_state_write_batch(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return slapi_atomic_load_32(&(slapdFrontendConfig->bind_state_write_batch), __ATOMIC_ACQUIRE);
+}
+
+/*
+ * nsslapd-dse-journal-delay: seconds the changes made to dse.ldif are kept
+ * in its journal before the file is rewritten, 0 rewrites it on every
+ * change. See dse.c.
+ */
+int
+config_set_dse_journal_delay(const char *attrname, char *value, char *errorbuf, int apply)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return config_set_bounded_int_value(attrname, value, errorbuf, apply,
+                                        &(slapdFrontendConfig->dse_journal_delay), 0, 3600);
+}
+
+int32_t
+config_get_dse_journal_delay(void)
+{
+    slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
+    return slapi_atomic_load_32(&(slapdFrontendConfig->dse_journal_delay), __ATOMIC_ACQUIRE);
+}
+
 int32_t
 config_set_extract_pem(const char *attrname, char *value, char *errorbuf, int apply)
 {
@@ -46,6 +46,7 @@
 PRUintn logbuf_tsdindex;
 struct logbufinfo *logbuf_accum;
 static struct logging_opts loginfo;
+static LogWriter access_writer;
 static int detached = 0;
 
 typedef int open_log(int32_t state, int32_t flags);
@@ -135,6 +136,8 @@ static void log_append_audit_buffer(time_t tnl, LogBufferInfo *lbi, char *msg, s
 static void log_append_auditfail_buffer(time_t tnl, LogBufferInfo *lbi, char *msg, size_t size);
 static void log_append_error_buffer(time_t tnl, LogBufferInfo *lbi, char *msg, size_t size, int locked);
 static void log_flush_buffer(LogBufferInfo *lbi, int type, int sync_now, int locked);
+static int log_writer_append(LogWriter *lw, time_t tnl, int buffering, char *msg1, size_t size1, char *msg2, size_t size2);
+static void log_writer_drain(LogWriter *lw);
 static void log_write_title(LOGFD fp);
 static void log_write_json_title(LOGFD fp, int32_t log_format);
 static void vslapd_log_emergency_error(LOGFD fp, const char *msg, int locked);
@@ -6868,6 +6871,11 @@ log_append_access_buffer(time_t tnl, LogBufferInfo *lbi, char *msg1, size_t size
     size_t size = size1 + size2;
     char *insert_point = NULL;
 
+    if (log_writer_append(&access_writer, tnl, slapdFrontendConfig->accesslogbuffering,
+                          msg1, size1, msg2, size2)) {
+        return;
+    }
+
     /* While holding the lock, we determine if there is space in the buffer for our payload,
        and if we need to flush.
      */
@@ -6906,6 +6914,11 @@ log_append_access_json_buffer(time_t tnl, LogBufferInfo *lbi, char *msg, size_t
     slapdFrontendConfig_t *slapdFrontendConfig = getFrontendConfig();
     char *insert_point = NULL;
 
+    if (log_writer_append(&access_writer, tnl, slapdFrontendConfig->accesslogbuffering,
+                          msg, size, NULL, 0)) {
+        return;
+    }
+
     /* While holding the lock, we determine if there is space in the buffer for our payload,
        and if we need to flush.
      */
@@ -6937,6 +6950,306 @@ log_append_access_json_buffer(time_t tnl, LogBufferInfo *lbi, char *msg, size_t
     }
 }
 
+/*
+ * Access log writer thread
+ *
+ * When it runs, the buffered access log lines are appended to the active
+ * buffer of the writer instead of loginfo.log_access_buffer. Only the space
+ * reservation is done under lw->lock (never any I/O), and a full buffer is
+ * swapped with a spare one and queued for the writer thread, which writes
+ * it out under the access log lock like log_flush_buffer() always did.
+ * If all the buffers are queued, the line either waits for the writer or
+ * is dropped and counted, depending on nsslapd-accesslog-async-overflow.
+ */
+
+/* Queue the active buffer for the writer, the caller holds lw->lock and checked nspare */
+static void
+log_writer_queue_active(LogWriter *lw)
+{
+    lw->queue[(lw->queue_head + lw->queue_len) % LOG_WRITER_NBUFFERS] = lw->active;
+    lw->queue_len++;
+    lw->queued++;
+    lw->active = lw->spare[--lw->nspare];
+    pthread_cond_signal(&lw->work_cv);
+}
+
+/*
+ * Reserve size bytes in the active buffer and take a copy reference on it.
+ * Returns NULL if the line must be dropped.
+ */
+static LogBufferInfo *
+log_writer_reserve(LogWriter *lw, time_t tnl, size_t size, char **insert_point)
+{
+    LogBufferInfo *lbi = NULL;
+
+    pthread_mutex_lock(&lw->lock);
+    for (;;) {
+        lbi = lw->active;
+        if ((lbi->current - lbi->top) + size <= lbi->maxsize) {
+            /*
+             * Time to rotate: hand what we have to the writer (it does the
+             * rotation), unless it has not caught up with the previous one yet.
+             */
+            if (!(tnl >= loginfo.log_access_rotationsyncclock &&
+                  loginfo.log_access_rotationsync_enabled &&
+                  lbi->current != lbi->top &&
+                  lw->nspare > 0 && lw->queue_len == 0 && !lw->busy)) {
+                break;
+            }
+        }
+        if (lw->nspare > 0) {
+            log_writer_queue_active(lw);
+            continue;
+        }
+        if (config_get_accesslog_async_overflow() == LOG_ASYNC_OVERFLOW_DROP) {
+            lw->dropped++;
+            pthread_mutex_unlock(&lw->lock);
+            return NULL;
+        }
+        lw->blocked++;
+        pthread_cond_wait(&lw->free_cv, &lw->lock);
+    }
+    *insert_point = lbi->current;
+    lbi->current += size;
+    /* Increment the copy refcount, log_flush_buffer() waits for it */
+    slapi_atomic_incr_64(&(lbi->refcount), __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&lw->lock);
+
+    return lbi;
+}
+
+/*
+ * A line that does not fit in a buffer is written directly to the file,
+ * after what was buffered before it.
+ */
+static void
+log_writer_write_direct(LogWriter *lw, char *msg1, size_t size1, char *msg2, size_t size2)
+{
+    LogBufferInfo lbi;
+    char *line = slapi_ch_malloc(size1 + size2);
+
+    memcpy(line, msg1, size1);
+    if (size2) {
+        memcpy(line + size1, msg2, size2);
+    }
+    log_writer_drain(lw);
+
+    lbi.top = line;
+    lbi.current = line + size1 + size2;
+    lbi.maxsize = size1 + size2;
+    lbi.lock = NULL;
+    lbi.refcount = 0;
+    LOG_ACCESS_LOCK_WRITE();
+    log_flush_buffer(&lbi, SLAPD_ACCESS_LOG, 0 /* do not sync to disk right now */, 1);
+    LOG_ACCESS_UNLOCK_WRITE();
+    slapi_ch_free_string(&line);
+}
+
+/*
+ * Append an access log line through the writer thread.
+ * Returns 0 if the writer is not running, or if the line is not buffered:
+ * then the caller has to append (and flush) it itself.
+ *
+ * lw->appenders counts the threads past the running check, so that
+ * log_access_writer_stop() can wait for them before the final drain.
+ */
+static int
+log_writer_append(LogWriter *lw, time_t tnl, int buffering, char *msg1, size_t size1, char *msg2, size_t size2)
+{
+    LogBufferInfo *lbi = NULL;
+    char *insert_point = NULL;
+    int rc = 1;
+
+    slapi_atomic_incr_32(&(lw->appenders), __ATOMIC_SEQ_CST);
+    if (!slapi_atomic_load_32(&(lw->running), __ATOMIC_SEQ_CST)) {
+        rc = 0;
+    } else if (!buffering) {
+        /* Keep the lines ordered: write out what was buffered first */
+        log_writer_drain(lw);
+        rc = 0;
+    } else if (size1 + size2 > LOG_BUFFER_MAXSIZE) {
+        log_writer_write_direct(lw, msg1, size1, msg2, size2);
+    } else {
+        lbi = log_writer_reserve(lw, tnl, size1 + size2, &insert_point);
+        if (lbi) {
+            memcpy(insert_point, msg1, size1);
+            if (size2) {
+                memcpy(insert_point + size1, msg2, size2);
+            }
+            slapi_atomic_decr_64(&(lbi->refcount), __ATOMIC_RELEASE);
+        }
+    }
+    slapi_atomic_decr_32(&(lw->appenders), __ATOMIC_SEQ_CST);
+    return rc;
+}
+
+/*
+ * Queue the active buffer and wait until the writer has written out
+ * everything that was appended before the call.
+ */
+static void
+log_writer_drain(LogWriter *lw)
+{
+    uint64_t target;
+
+    pthread_mutex_lock(&lw->lock);
+    while (lw->active->current != lw->active->top && lw->nspare == 0) {
+        pthread_cond_wait(&lw->free_cv, &lw->lock);
+    }
+    if (lw->active->current != lw->active->top) {
+        log_writer_queue_active(lw);
+    }
+    target = lw->queued;
+    while (lw->flushes < target) {
+        pthread_cond_wait(&lw->free_cv, &lw->lock);
+    }
+    pthread_mutex_unlock(&lw->lock);
+}
+
+static void
+log_writer_thread(void *arg)
+{
+    LogWriter *lw = (LogWriter *)arg;
+
+    slapi_set_thread_name("log-writer");
+
+    pthread_mutex_lock(&lw->lock);
+    while (!lw->shutdown || lw->queue_len > 0) {
+        LogBufferInfo *lbi = NULL;
+        struct timespec start = {0};
+        struct timespec end = {0};
+        uint64_t usec = 0;
+
+        if (lw->queue_len == 0) {
+            pthread_cond_wait(&lw->work_cv, &lw->lock);
+            continue;
+        }
+        lbi = lw->queue[lw->queue_head];
+        lw->queue_head = (lw->queue_head + 1) % LOG_WRITER_NBUFFERS;
+        lw->queue_len--;
+        lw->busy = 1;
+        pthread_mutex_unlock(&lw->lock);
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        LOG_ACCESS_LOCK_WRITE();
+        log_flush_buffer(lbi, SLAPD_ACCESS_LOG, 0 /* do not sync to disk right now */, 1);
+        LOG_ACCESS_UNLOCK_WRITE();
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        usec = (uint64_t)(end.tv_sec - start.tv_sec) * 1000000 +
+               (end.tv_nsec - start.tv_nsec) / 1000;
+
+        pthread_mutex_lock(&lw->lock);
+        lw->busy = 0;
+        lw->spare[lw->nspare++] = lbi;
+        lw->flushes++;
+        lw->flush_usec += usec;
+        if (usec > lw->flush_usec_max) {
+            lw->flush_usec_max = usec;
+        }
+        pthread_cond_broadcast(&lw->free_cv);
+    }
+    pthread_mutex_unlock(&lw->lock);
+}
+
+static LogBufferInfo *
+log_writer_create_buffer(void)
+{
+    LogBufferInfo *lbi = log_create_buffer(LOG_BUFFER_MAXSIZE);
+
+    lbi->lock = NULL; /* lw->lock protects it */
+    return lbi;
+}
+
+/*
+ * Start the access log writer thread, if nsslapd-accesslog-async-writer
+ * is on. Without it, the workers keep flushing the access log themselves.
+ */
+int
+log_access_writer_start(void)
+{
+    LogWriter *lw = &access_writer;
+    int rc = 0;
+
+    if (!config_get_accesslog_async_writer() || lw->tid) {
+        return 0;
+    }
+
+    if ((rc = pthread_mutex_init(&lw->lock, NULL)) != 0 ||
+        (rc = pthread_cond_init(&lw->work_cv, NULL)) != 0 ||
+        (rc = pthread_cond_init(&lw->free_cv, NULL)) != 0) {
+        slapi_log_err(SLAPI_LOG_ERR, "log_access_writer_start",
+                      "Cannot initialize the access log writer. error %d (%s)\n",
+                      rc, strerror(rc));
+        return -1;
+    }
+    lw->active = log_writer_create_buffer();
+    for (size_t i = 1; i < LOG_WRITER_NBUFFERS; i++) {
+        lw->spare[lw->nspare++] = log_writer_create_buffer();
+    }
+
+    if ((lw->tid = PR_CreateThread(PR_USER_THREAD,
+                                   (VFP)log_writer_thread, (void *)lw,
+                                   PR_PRIORITY_NORMAL, PR_GLOBAL_THREAD, PR_JOINABLE_THREAD,
+                                   SLAPD_DEFAULT_THREAD_STACKSIZE)) == NULL) {
+        slapi_log_err(SLAPI_LOG_ERR, "log_access_writer_start",
+                      "PR_CreateThread failed. " SLAPI_COMPONENT_NAME_NSPR " error %d (%s)\n",
+                      PR_GetError(), slapd_pr_strerror(PR_GetError()));
+        return -1;
+    }
+    slapi_atomic_store_32(&(lw->running), 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/* Write out what is still buffered and stop the access log writer thread */
+void
+log_access_writer_stop(void)
+{
+    LogWriter *lw = &access_writer;
+
+    if (!slapi_atomic_load_32(&(lw->running), __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    /*
+     * From now on the lines are flushed by the threads logging them. Wait
+     * for the threads that still append through the writer, so that no line
+     * lands in the active buffer after the final drain.
+     */
+    slapi_atomic_store_32(&(lw->running), 0, __ATOMIC_SEQ_CST);
+    while (slapi_atomic_load_32(&(lw->appenders), __ATOMIC_SEQ_CST) > 0) {
+        DS_Sleep(PR_MillisecondsToInterval(1));
+    }
+    log_writer_drain(lw);
+
+    pthread_mutex_lock(&lw->lock);
+    lw->shutdown = 1;
+    pthread_cond_signal(&lw->work_cv);
+    pthread_mutex_unlock(&lw->lock);
+    (void)PR_JoinThread(lw->tid);
+}
+
+void
+log_access_writer_get_stats(int32_t *queue_depth, uint64_t *flushes, uint64_t *flush_usec_avg,
+                            uint64_t *flush_usec_max, uint64_t *dropped, uint64_t *blocked)
+{
+    LogWriter *lw = &access_writer;
+
+    *queue_depth = 0;
+    *flushes = *flush_usec_avg = *flush_usec_max = *dropped = *blocked = 0;
+    if (lw->tid == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&lw->lock);
+    *queue_depth = lw->queue_len + lw->busy;
+    *flushes = lw->flushes;
+    *flush_usec_avg = lw->flushes ? lw->flush_usec / lw->flushes : 0;
+    *flush_usec_max = lw->flush_usec_max;
+    *dropped = lw->dropped;
+    *blocked = lw->blocked;
+    pthread_mutex_unlock(&lw->lock);
+}
+
 static time_t
 log_update_sync_clock(int32_t log_type, int32_t secs)
 {
@@ -7171,6 +7484,14 @@ log_flush_buffer(LogBufferInfo *lbi, int log_type, int sync_now, int locked)
 void
 logs_flush()
 {
+    if (slapi_atomic_load_32(&(access_writer.running), __ATOMIC_ACQUIRE)) {
+        log_writer_drain(&access_writer);
+        LOG_ACCESS_LOCK_WRITE();
+        if (loginfo.log_access_fdes) {
+            PR_Sync(loginfo.log_access_fdes);
+        }
+        LOG_ACCESS_UNLOCK_WRITE();
+    }
     LOG_ACCESS_LOCK_WRITE();
     log_flush_buffer(loginfo.log_access_buffer, SLAPD_ACCESS_LOG,
                      1 /* sync to disk now */, 1 /* locked*/);
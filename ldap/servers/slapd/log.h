@@ -102,6 +102,38 @@ struct logbufinfo
 };
 typedef struct logbufinfo LogBufferInfo;
 
+/*
+ * Access log writer thread.  The worker threads only reserve space in the
+ * active buffer and copy their line into it; full buffers are queued and
+ * written out (including the rotation checks) by the writer thread.
+ */
+#define LOG_WRITER_NBUFFERS 4
+
+struct logwriter
+{
+    pthread_mutex_t lock;                       /* protects the fields below */
+    pthread_cond_t work_cv;                     /* a buffer was queued */
+    pthread_cond_t free_cv;                     /* a queued buffer was written */
+    LogBufferInfo *active;                      /* buffer the lines are appended to */
+    LogBufferInfo *queue[LOG_WRITER_NBUFFERS];  /* full buffers, oldest first */
+    int32_t queue_head;
+    int32_t queue_len;
+    LogBufferInfo *spare[LOG_WRITER_NBUFFERS];  /* written buffers, ready for reuse */
+    int32_t nspare;
+    int32_t busy;                               /* a buffer is being written */
+    int32_t running;                            /* lines go through the writer */
+    int32_t appenders;                          /* threads in log_writer_append() */
+    int32_t shutdown;
+    PRThread *tid;
+    uint64_t queued;                            /* buffers queued so far */
+    uint64_t flushes;                           /* buffers written so far */
+    uint64_t flush_usec;                        /* time spent writing them */
+    uint64_t flush_usec_max;
+    uint64_t dropped;                           /* lines dropped on overflow */
+    uint64_t blocked;                           /* appends that waited for a buffer */
+};
+typedef struct logwriter LogWriter;
+
 struct logging_opts
 {
     /* These are access log specific */
@@ -1044,9 +1044,14 @@ main(int argc, char **argv)
         return_value = 1;
         goto cleanup;
     }
+    (void)log_access_writer_start();
+    (void)result_flush_start();
+    (void)pw_verify_start();
+    (void)pw_bind_state_start();
 
     eq_start(); /* must be done after plugins started - DEPRECATED */
     eq_start_rel(); /* must be done after plugins started */
+    dse_journal_start(); /* dse.ldif rewrites are scheduled in the event queue */
 
     vattr_check(); /* Check if it exists virtual attribute definitions */
 
@@ -1100,7 +1100,16 @@ op_shared_modify(Slapi_PBlock *pb, int pw_change, char *old_pw)
         slapi_pblock_set(pb, SLAPI_PLUGIN, be->be_database);
         set_db_default_result_handlers(pb);
         if (be->be_modify != NULL) {
-            if ((rc = (*be->be_modify)(pb)) == 0) {
+            /* The pending bind state updates would undo this one */
+            int bind_state_held = pw_bind_state_mods_match(mods);
+            if (bind_state_held) {
+                pw_bind_state_discard(sdn);
+            }
+            rc = (*be->be_modify)(pb);
+            if (bind_state_held) {
+                pw_bind_state_release(sdn);
+            }
+            if (rc == 0) {
                 /* acl is not used for internal operations */
                 /* don't update aci store for remote acis  */
                 if ((!internal_op) &&
@@ -1116,6 +1125,14 @@ op_shared_modify(Slapi_PBlock *pb, int pw_change, char *old_pw)
                     update_pw_info(pb, old_pw);
                 }
 
+                /* pw_change is not set for replicated operations, look at the mods */
+                slapi_pblock_get(pb, SLAPI_MODIFY_MODS, &mods);
+                for (size_t i = 0; mods && mods[i]; i++) {
+                    if (strcasecmp(mods[i]->mod_type, SLAPI_USERPWD_ATTR) == 0) {
+                        pw_verify_cache_invalidate(sdn);
+                        break;
+                    }
+                }
                 slapi_pblock_get(pb, SLAPI_ENTRY_POST_OP, &pse);
                 do_ps_service(pse, NULL, LDAP_CHANGETYPE_MODIFY, 0);
             } else {
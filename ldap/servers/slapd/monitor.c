@@ -124,6 +124,27 @@ monitor_info(Slapi_PBlock *pb __attribute__((unused)),
     val.bv_val = buf;
     attrlist_replace(&e->e_attrs, "maxworkqueue", vals);
 
+    /*
+     * One value per work queue shard, formatted like the connection
+     * attribute: shard:currentworkqueue:maxworkqueue:steals
+     */
+    val.bv_len = snprintf(buf, sizeof(buf), "%" PRId32, get_work_q_nshards());
+    val.bv_val = buf;
+    attrlist_replace(&e->e_attrs, "workqueueshards", vals);
+
+    attrlist_delete(&e->e_attrs, "workqueueshard");
+    for (int32_t i = 0; i < get_work_q_nshards(); i++) {
+        int32_t size = 0;
+        int32_t size_max = 0;
+        uint64_t steals = 0;
+
+        get_work_q_shard_stats(i, &size, &size_max, &steals);
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRId32 ":%" PRId32 ":%" PRId32 ":%" PRIu64,
+                              i, size, size_max, steals);
+        val.bv_val = buf;
+        attrlist_merge(&e->e_attrs, "workqueueshard", vals);
+    }
+
     val.bv_len = snprintf(buf, sizeof(buf), "%" PRId32, get_busy_worker_count());
     val.bv_val = buf;
     attrlist_replace(&e->e_attrs, "currentbusyworkers", vals);
@@ -132,6 +153,115 @@ monitor_info(Slapi_PBlock *pb __attribute__((unused)),
     val.bv_val = buf;
     attrlist_replace(&e->e_attrs, "maxbusyworkers", vals);
 
+    /* Access log writer thread, the latencies are in microseconds */
+    {
+        int32_t queue_depth = 0;
+        uint64_t flushes = 0;
+        uint64_t flush_avg = 0;
+        uint64_t flush_max = 0;
+        uint64_t dropped = 0;
+        uint64_t blocked = 0;
+
+        log_access_writer_get_stats(&queue_depth, &flushes, &flush_avg, &flush_max, &dropped, &blocked);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRId32, queue_depth);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "accesslogqueuedepth", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, flushes);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "accesslogflushes", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, flush_avg);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "accesslogflushlatencyavg", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, flush_max);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "accesslogflushlatencymax", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, dropped);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "accesslogdropped", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, blocked);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "accesslogblocked", vals);
+    }
+
+    /* Bind password verification threads and verified password cache */
+    {
+        int32_t threads = 0;
+        int32_t queue_depth = 0;
+        uint64_t verified = 0;
+        int32_t cache_entries = 0;
+        uint64_t cache_hits = 0;
+        uint64_t cache_misses = 0;
+        uint64_t cache_evictions = 0;
+
+        pw_verify_get_stats(&threads, &queue_depth, &verified,
+                            &cache_entries, &cache_hits, &cache_misses, &cache_evictions);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRId32, threads);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "pwverifythreads", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRId32, queue_depth);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "pwverifyqueuedepth", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, verified);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "pwverifyops", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRId32, cache_entries);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "pwverifycacheentries", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, cache_hits);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "pwverifycachehits", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, cache_misses);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "pwverifycachemisses", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, cache_evictions);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "pwverifycacheevictions", vals);
+    }
+
+    /* Bind state write-behind */
+    {
+        int32_t pending = 0;
+        uint64_t queued = 0;
+        uint64_t merged = 0;
+        uint64_t written = 0;
+        uint64_t batches = 0;
+
+        pw_bind_state_get_stats(&pending, &queued, &merged, &written, &batches);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRId32, pending);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "bindstatepending", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, queued);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "bindstatequeued", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, merged);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "bindstatemerged", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, written);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "bindstatewritten", vals);
+
+        val.bv_len = snprintf(buf, sizeof(buf), "%" PRIu64, batches);
+        val.bv_val = buf;
+        attrlist_replace(&e->e_attrs, "bindstatebatches", vals);
+    }
+
     *returncode = LDAP_SUCCESS;
     return SLAPI_DSE_CALLBACK_OK;
 }
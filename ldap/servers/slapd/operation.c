@@ -233,6 +233,8 @@ operation_done(Slapi_Operation **op, Connection *conn)
             ldap_controls_free((*op)->o_results.result_controls);
             (*op)->o_results.result_controls = NULL;
         }
+        /* the search ended without sending its result */
+        result_batch_release(*op);
         slapi_ch_free_string(&(*op)->o_results.result_matched);
         slapi_ch_free_string(&(*op)->o_results.result_text);
         int options = 0;
@@ -731,6 +733,7 @@ op_stat_destructor(void *extension, void *object __attribute__((unused)), void *
             slapi_ch_free_string(&keys->attribute_type);
             slapi_ch_free_string(&keys->key);
             slapi_ch_free_string(&keys->index_type);
+            slapi_ch_free_string(&keys->filter);
             slapi_ch_free((void **) &keys);
             keys = next;
         }
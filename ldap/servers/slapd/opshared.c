@@ -1594,7 +1594,10 @@ send_results_ext(Slapi_PBlock *pb, int send_result, int *nentries, int pagesize,
     *    rc = iterate_with_lookahead(pb, be, send_result, nentries);
     * } else {
     */
+    result_batch_begin(pb, PR_FALSE);
     rc = iterate(pb, be, send_result, nentries, pagesize, pr_stat);
+    /* a failed write disconnects the client, as for a single entry */
+    result_batch_end(pb);
     /*
         }
     } else { // if (be->be_next_search_entry_ext != NULL)
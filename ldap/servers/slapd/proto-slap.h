@@ -386,6 +386,8 @@ int config_set_minssf(const char *attrname, char *value, char *errorbuf, int app
 int config_set_minssf_exclude_rootdse(const char *attrname, char *value, char *errorbuf, int apply);
 int config_set_validate_cert_switch(const char *attrname, char *value, char *errorbuf, int apply);
 int config_set_accesslogbuffering(const char *attrname, char *value, char *errorbuf, int apply);
+int config_set_accesslog_async_writer(const char *attrname, char *value, char *errorbuf, int apply);
+int config_set_accesslog_async_overflow(const char *attrname, char *value, char *errorbuf, int apply);
 int config_set_auditlogbuffering(const char *attrname, char *value, char *errorbuf, int apply);
 int config_set_securitylogbuffering(const char *attrname, char *value, char *errorbuf, int apply);
 int config_set_errorlogbuffering(const char *attrname, char *value, char *errorbuf, int apply);
@@ -427,6 +429,15 @@ int config_set_localuser(const char *attrname, char *value, char *errorbuf, int
 
 int config_set_maxsimplepaged_per_conn(const char *attrname, char *value, char *errorbuf, int apply);
 int config_set_maxcontrolsperop(const char *attrname, char *value, char *errorbuf, int apply);
+int config_set_result_batch_size(const char *attrname, char *value, char *errorbuf, int apply);
+int config_set_result_batch_entries(const char *attrname, char *value, char *errorbuf, int apply);
+int config_set_result_batch_delay(const char *attrname, char *value, char *errorbuf, int apply);
+int config_set_pwverify_threads(const char *attrname, char *value, char *errorbuf, int apply);
+int config_set_pwverify_cache_ttl(const char *attrname, char *value, char *errorbuf, int apply);
+int config_set_pwverify_cache_size(const char *attrname, char *value, char *errorbuf, int apply);
+int config_set_bind_state_write_window(const char *attrname, char *value, char *errorbuf, int apply);
+int config_set_bind_state_write_batch(const char *attrname, char *value, char *errorbuf, int apply);
+int config_set_dse_journal_delay(const char *attrname, char *value, char *errorbuf, int apply);
 
 int log_external_libs_debug_set_log_fn(void);
 int log_set_backend(const char *attrname, char *value, int logtype, char *errorbuf, int apply);
@@ -533,6 +544,8 @@ char *config_get_auditlog_display_attrs(void);
 int config_get_auditlog_log_format(void);
 char *config_get_auditlog_time_format(void);
 int config_get_accesslog_log_format(void);
+int config_get_accesslog_async_writer(void);
+int config_get_accesslog_async_overflow(void);
 char *config_get_accesslog_time_format(void);
 int config_get_errorlog_log_format(void);
 char *config_get_errorlog_time_format(void);
@@ -603,6 +616,8 @@ int config_get_unhashed_pw_switch(void);
 int config_get_sasl_maxbufsize(void);
 int config_get_enable_turbo_mode(void);
 int config_set_enable_turbo_mode(const char *attrname, char *value, char *errorbuf, int apply);
+int config_get_workqueue_sharding(void);
+int config_set_workqueue_sharding(const char *attrname, char *value, char *errorbuf, int apply);
 int config_get_connection_buffer(void);
 int config_set_connection_buffer(const char *attrname, char *value, char *errorbuf, int apply);
 int config_get_connection_nocanon(void);
@@ -634,6 +649,15 @@ int config_get_malloc_mmap_threshold(void);
 
 int config_get_maxsimplepaged_per_conn(void);
 int config_get_maxcontrolsperop(void);
+int32_t config_get_result_batch_size(void);
+int32_t config_get_result_batch_entries(void);
+int32_t config_get_result_batch_delay(void);
+int32_t config_get_pwverify_threads(void);
+int32_t config_get_pwverify_cache_ttl(void);
+int32_t config_get_pwverify_cache_size(void);
+int32_t config_get_bind_state_write_window(void);
+int32_t config_get_bind_state_write_batch(void);
+int32_t config_get_dse_journal_delay(void);
 int config_get_extract_pem(void);
 
 int32_t config_get_enable_upgrade_hash(void);
@@ -794,6 +818,10 @@ struct dse_callback *dse_register_callback(struct dse *pdse, int operation, int
 void dse_remove_callback(struct dse *pdse, int operation, int flags, const Slapi_DN *base, int scope, const char *filter, dseCallbackFn fn);
 void dse_set_dont_ever_write_dse_files(void);
 void dse_unset_dont_ever_write_dse_files(void);
+void dse_set_journal(struct dse *pdse, const char *journalfilename);
+int dse_journal_fold(const char *configdir, char **contents);
+void dse_journal_start(void);
+void dse_journal_stop(void);
 int dse_next_search_entry(Slapi_PBlock *pb);
 char *dse_read_next_entry(char *buf, char **lastp);
 void dse_search_set_release(void **ss);
@@ -882,6 +910,9 @@ int slapd_log_audit(char *buffer, PRBool json);
 int slapd_log_auditfail(char *buffer, PRBool json);
 int32_t slapd_log_access_json(char *buffer);
 void logs_flush(void);
+int log_access_writer_start(void);
+void log_access_writer_stop(void);
+void log_access_writer_get_stats(int32_t *queue_depth, uint64_t *flushes, uint64_t *flush_usec_avg, uint64_t *flush_usec_max, uint64_t *dropped, uint64_t *blocked);
 
 int access_log_openf(char *pathname, int locked);
 int security_log_openf(char *pathname, int locked);
@@ -1080,12 +1111,29 @@ void add_password_attrs(Slapi_PBlock *pb, Operation *op, Slapi_Entry *e);
 
 int add_shadow_ext_password_attrs(Slapi_PBlock *pb, Slapi_Entry **e);
 
+/*
+ * pw_verify.c
+ */
+int pw_verify_start(void);
+void pw_verify_stop(void);
+void pw_verify_cache_invalidate(const Slapi_DN *sdn);
+void pw_verify_get_stats(int32_t *threads, int32_t *queue_depth, uint64_t *verified, int32_t *cache_entries, uint64_t *cache_hits, uint64_t *cache_misses, uint64_t *cache_evictions);
+
 /*
  * pw_retry.c
  */
 int update_pw_retry(Slapi_PBlock *pb);
 int update_tpr_pw_usecount(Slapi_PBlock *pb, Slapi_Entry *e, int32_t use_count);
 void pw_apply_mods(const Slapi_DN *sdn, Slapi_Mods *mods);
+char *pw_bind_state_attr_get_charptr(const Slapi_Entry *e, const char *type);
+int pw_bind_state_attr_get_int(const Slapi_Entry *e, const char *type);
+void pw_bind_state_overlay(Slapi_Entry *e);
+void pw_bind_state_discard(const Slapi_DN *sdn);
+void pw_bind_state_release(const Slapi_DN *sdn);
+int pw_bind_state_mods_match(LDAPMod **mods);
+int pw_bind_state_start(void);
+void pw_bind_state_stop(void);
+void pw_bind_state_get_stats(int32_t *pending, uint64_t *queued, uint64_t *merged, uint64_t *written, uint64_t *batches);
 void pw_set_componentID(struct slapi_componentid *cid);
 struct slapi_componentid *pw_get_componentID(void);
 
@@ -1123,6 +1171,11 @@ void send_ldap_result(Slapi_PBlock *pb, int err, char *matched, char *text, int
 int send_ldap_search_entry_ext(Slapi_PBlock *pb, Slapi_Entry *e, LDAPControl **ectrls, char **attrs, int attrsonly, int send_result, int nentries, struct berval **urls);
 void send_ldap_result_ext(Slapi_PBlock *pb, int err, char *matched, char *text, int nentries, struct berval **urls, BerElement *ber);
 int send_ldap_intermediate(Slapi_PBlock *pb, LDAPControl **ectrls, char *responseName, struct berval *responseValue);
+void result_batch_begin(Slapi_PBlock *pb, PRBool ps_drain);
+void result_batch_end(Slapi_PBlock *pb);
+void result_batch_release(Operation *op);
+int result_flush_start(void);
+void result_flush_stop(void);
 void send_nobackend_ldap_result(Slapi_PBlock *pb);
 int send_ldap_referral(Slapi_PBlock *pb, Slapi_Entry *e, struct berval **refs, struct berval ***urls);
 int send_ldapv3_referral(Slapi_PBlock *pb, struct berval **urls);
@@ -1546,6 +1599,7 @@ void subentry_create_filter(Slapi_Filter **filter);
 void vattr_init(void);
 void vattr_cleanup(void);
 void vattr_check(void);
+int vattr_type_is_virtual(const Slapi_Entry *e, const char *type);
 
 /*
  * slapd_plhash.c - supplement to NSPR plhash
@@ -1575,6 +1629,8 @@ int32_t connection_has_psearch(Connection *c);
 void free_worker_thread_indexes(void);
 int32_t get_work_q_size(void);
 int32_t get_work_q_size_max(void);
+int32_t get_work_q_nshards(void);
+void get_work_q_shard_stats(int32_t shard, int32_t *size, int32_t *size_max, uint64_t *steals);
 int32_t get_busy_worker_count(void);
 int32_t get_max_busy_worker_count(void);
 
@@ -39,6 +39,9 @@ typedef struct _ps_entry_queue_node
     struct _ps_entry_queue_node *pe_next;
 } PSEQNode;
 
+struct _ps_bucket;
+struct _ps_guard;
+
 /*
  * Information about a single persistent search
  */
@@ -52,9 +55,48 @@ typedef struct _psearch
     time_t ps_lasttime;
     ber_int_t ps_changetypes;
     int ps_send_entchg_controls;
+    pthread_cond_t ps_cvar;       /* the ps thread sleeps on this */
+    struct _ps_bucket *ps_bucket; /* dispatch index bucket of the search base */
+    struct _ps_guard *ps_guard;   /* equality required by the filter, or NULL */
+    struct _psearch *ps_idx_prev; /* searches of the same bucket or guard */
+    struct _psearch *ps_idx_next;
     struct _psearch *ps_next;
 } PSearch;
 
+/*
+ * Dispatch index of the persistent searches.
+ *
+ * The searches are hashed on their normalized base DN, so a change only
+ * visits the buckets of the entry DN and of its ancestors. In a bucket,
+ * a search whose filter requires an equality assertion (the filter
+ * itself, or a component of a top level AND) is hashed on the
+ * "type=key" of that assertion, key being its equality index key. It is
+ * only evaluated when the entry has a value with that key. Searches
+ * without such an assertion are evaluated for every change in the bucket.
+ */
+typedef struct _ps_guard
+{
+    char *g_key;      /* "type=key", hash key of b_guards */
+    char *g_type;     /* attribute type of the assertion */
+    PSearch *g_head;  /* searches requiring this equality */
+} PS_Guard;
+
+typedef struct _ps_guard_type
+{
+    char *gt_type;    /* attribute type used by some guards of the bucket */
+    int gt_refcnt;    /* number of searches guarded on that type */
+    struct _ps_guard_type *gt_next;
+} PS_GuardType;
+
+typedef struct _ps_bucket
+{
+    char *b_ndn;                 /* normalized search base, hash key */
+    PSearch *b_unguarded;        /* searches evaluated for every change */
+    PLHashTable *b_guards;       /* g_key -> PS_Guard */
+    PS_GuardType *b_guard_types; /* distinct types of b_guards */
+    int b_count;                 /* number of searches in the bucket */
+} PS_Bucket;
+
 /*
  * A list of outstanding persistent searches.
  */
@@ -62,8 +104,8 @@ typedef struct _psearch_list
 {
     Slapi_RWLock *pl_rwlock;     /* R/W lock struct to serialize access */
     PSearch *pl_head;            /* Head of list */
-    pthread_mutex_t pl_cvarlock; /* Lock for cvar */
-    pthread_cond_t pl_cvar;      /* ps threads sleep on this */
+    PLHashTable *pl_buckets;     /* dispatch index: base ndn -> PS_Bucket */
+    pthread_mutex_t pl_cvarlock; /* Lock for the ps_cvar of the searches */
 } PSearch_List;
 
 /*
@@ -90,6 +132,10 @@ static PSearch *psearch_alloc(void);
 static void ps_add_ps(PSearch *ps);
 static void ps_remove(PSearch *dps);
 static void pe_ch_free(PSEQNode **pe);
+static void ps_index_add(PSearch *ps);
+static void ps_index_remove(PSearch *ps);
+static void ps_wakeup(PSearch *ps);
+static int ps_service_one(PSearch *ps, Slapi_Entry *e, Slapi_Entry *eprev, ber_int_t chgtype, ber_int_t chgnum, LDAPControl **ctrl);
 static int create_entrychange_control(ber_int_t chgtype, ber_int_t chgnum, const char *prevdn, LDAPControl **ctrlp);
 
 
@@ -117,12 +163,8 @@ ps_init_psearch_system()
                           rc, strerror(rc));
             exit(1);
         }
-        if ((rc = pthread_cond_init(&(psearch_list->pl_cvar), NULL)) != 0) {
-            slapi_log_err(SLAPI_LOG_ERR, "housekeeping_start",
-                          "housekeeping cannot create new condition variable.  error %d (%s)\n",
-                          rc, strerror(rc));
-            exit(1);
-        }
+        psearch_list->pl_buckets = PL_NewHashTable(64, PL_HashString, PL_CompareStrings,
+                                                   PL_CompareValues, NULL, NULL);
         psearch_list->pl_head = NULL;
     }
 }
@@ -191,6 +233,7 @@ ps_add(Slapi_PBlock *pb, ber_int_t changetypes, int send_entchg_controls)
             ps_remove(ps);
             PR_DestroyLock(ps->ps_lock);
             ps->ps_lock = NULL;
+            pthread_cond_destroy(&(ps->ps_cvar));
             slapi_ch_free((void **)&ps->ps_pblock);
             slapi_ch_free((void **)&ps);
         }
@@ -224,6 +267,7 @@ ps_remove(PSearch *dps)
                 }
             }
         }
+        ps_index_remove(dps);
         PSL_UNLOCK_WRITE();
     }
 }
@@ -310,9 +354,9 @@ ps_send_results(void *arg)
         }
         if (NULL == ps->ps_eq_head) {
             /* Nothing to do */
-            pthread_cond_wait(&(psearch_list->pl_cvar), &(psearch_list->pl_cvarlock));
+            pthread_cond_wait(&(ps->ps_cvar), &(psearch_list->pl_cvarlock));
         } else {
-            /* dequeue the item */
+            /* dequeue all the pending items, they are written as one batch */
             int attrsonly;
             char **attrs;
             LDAPControl **ectrls;
@@ -322,56 +366,60 @@ ps_send_results(void *arg)
             PR_Lock(ps->ps_lock);
 
             peq = ps->ps_eq_head;
-            ps->ps_eq_head = peq->pe_next;
-            if (NULL == ps->ps_eq_head) {
-                ps->ps_eq_tail = NULL;
-            }
+            ps->ps_eq_head = NULL;
+            ps->ps_eq_tail = NULL;
 
             PR_Unlock(ps->ps_lock);
 
-            /* Get all the information we need to send the result */
-            ec = peq->pe_entry;
-            slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_ATTRS, &attrs);
-            slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_ATTRSONLY, &attrsonly);
-            if (!ps->ps_send_entchg_controls || peq->pe_ctrls[0] == NULL) {
-                ectrls = NULL;
-            } else {
-                ectrls = peq->pe_ctrls;
-            }
-
             /*
-             * Send the result.  Since send_ldap_search_entry can block for
+             * Send the results.  Since send_ldap_search_entry can block for
              * up to 30 minutes, we relinquish all locks before calling it.
              */
             pthread_mutex_unlock(&(psearch_list->pl_cvarlock));
 
-            /*
-             * The entry is in the right scope and matches the filter
-             * but we need to redo the filter test here to check access
-             * controls. See the comments at the slapi_filter_test()
-             * call in ps_service_persistent_searches().
-            */
+            slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_ATTRS, &attrs);
+            slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_ATTRSONLY, &attrsonly);
             slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_FILTER, &f);
+            result_batch_begin(ps->ps_pblock, PR_TRUE);
 
-            /* See if the entry meets the filter and ACL criteria */
-            if (slapi_vattr_filter_test(ps->ps_pblock, ec, f,
-                                        1 /* verify_access */) == 0) {
-                int rc = 0;
-                slapi_pblock_set(ps->ps_pblock, SLAPI_SEARCH_RESULT_ENTRY, ec);
-                rc = send_ldap_search_entry(ps->ps_pblock, ec,
-                                            ectrls, attrs, attrsonly);
-                if (rc) {
-                    slapi_log_err(SLAPI_LOG_CONNS, "ps_send_results",
-                                  "conn=%" PRIu64 " op=%d Error %d sending entry %s with op status %d\n",
-                                  pb_conn->c_connid, pb_op ? pb_op->o_opid: -1,
-                                  rc, slapi_entry_get_dn_const(ec), pb_op ? pb_op->o_status : -1);
+            for (; peq; peq = peqnext) {
+                peqnext = peq->pe_next;
+
+                /* Get all the information we need to send the result */
+                ec = peq->pe_entry;
+                if (!ps->ps_send_entchg_controls || peq->pe_ctrls[0] == NULL) {
+                    ectrls = NULL;
+                } else {
+                    ectrls = peq->pe_ctrls;
                 }
+
+                /*
+                 * The entry is in the right scope and matches the filter
+                 * but we need to redo the filter test here to check access
+                 * controls. See the comments at the slapi_filter_test()
+                 * call in ps_service_persistent_searches().
+                 */
+                if (!slapi_op_abandoned(ps->ps_pblock) &&
+                    slapi_vattr_filter_test(ps->ps_pblock, ec, f,
+                                            1 /* verify_access */) == 0) {
+                    int rc = 0;
+                    slapi_pblock_set(ps->ps_pblock, SLAPI_SEARCH_RESULT_ENTRY, ec);
+                    rc = send_ldap_search_entry(ps->ps_pblock, ec,
+                                                ectrls, attrs, attrsonly);
+                    if (rc) {
+                        slapi_log_err(SLAPI_LOG_CONNS, "ps_send_results",
+                                      "conn=%" PRIu64 " op=%d Error %d sending entry %s with op status %d\n",
+                                      pb_conn->c_connid, pb_op ? pb_op->o_opid: -1,
+                                      rc, slapi_entry_get_dn_const(ec), pb_op ? pb_op->o_status : -1);
+                    }
+                }
+
+                /* Deallocate our wrapper for this entry */
+                pe_ch_free(&peq);
             }
+            result_batch_end(ps->ps_pblock);
 
             pthread_mutex_lock(&(psearch_list->pl_cvarlock));
-
-            /* Deallocate our wrapper for this entry */
-            pe_ch_free(&peq);
         }
     }
     pthread_mutex_unlock(&(psearch_list->pl_cvarlock));
@@ -424,6 +472,7 @@ ps_send_results(void *arg)
 
     PR_DestroyLock(ps->ps_lock);
     ps->ps_lock = NULL;
+    pthread_cond_destroy(&(ps->ps_cvar));
 
     slapi_ch_free((void **)&ps->ps_pblock);
     for (peq = ps->ps_eq_head; peq; peq = peqnext) {
@@ -452,6 +501,13 @@ psearch_alloc(void)
         slapi_ch_free((void **)&ps);
         return (NULL);
     }
+    if (pthread_cond_init(&(ps->ps_cvar), NULL) != 0) {
+        slapi_log_err(SLAPI_LOG_ERR, "psearch_alloc", "Cannot create new condition variable.  "
+                                                      "Persistent search abandoned.\n");
+        PR_DestroyLock(ps->ps_lock);
+        slapi_ch_free((void **)&ps);
+        return (NULL);
+    }
     slapi_atomic_store_64(&(ps->ps_complete), 0, __ATOMIC_RELEASE);
     ps->ps_eq_head = ps->ps_eq_tail = (PSEQNode *)NULL;
     ps->ps_lasttime = (time_t)0L;
@@ -471,25 +527,423 @@ ps_add_ps(PSearch *ps)
         PSL_LOCK_WRITE();
         ps->ps_next = psearch_list->pl_head;
         psearch_list->pl_head = ps;
+        ps_index_add(ps);
         PSL_UNLOCK_WRITE();
     }
 }
 
 
 /*
- * Wake up all threads sleeping on
- * the psearch_list condition variable.
+ * Wake up the thread of a persistent search.
+ * The caller holds the list lock, so ps cannot go away.
+ */
+static void
+ps_wakeup(PSearch *ps)
+{
+    pthread_mutex_lock(&(psearch_list->pl_cvarlock));
+    pthread_cond_signal(&(ps->ps_cvar));
+    pthread_mutex_unlock(&(psearch_list->pl_cvarlock));
+}
+
+/*
+ * Wake up all the persistent search threads,
+ * e.g. to let them notice an abandon.
  */
 void
 ps_wakeup_all()
 {
+    PSearch *ps;
+
     if (PS_IS_INITIALIZED()) {
+        PSL_LOCK_READ();
         pthread_mutex_lock(&(psearch_list->pl_cvarlock));
-        pthread_cond_broadcast(&(psearch_list->pl_cvar));
+        for (ps = psearch_list->pl_head; NULL != ps; ps = ps->ps_next) {
+            pthread_cond_signal(&(ps->ps_cvar));
+        }
         pthread_mutex_unlock(&(psearch_list->pl_cvarlock));
+        PSL_UNLOCK_READ();
+    }
+}
+
+/*
+ * Returns the base of ps, the pblock holds it as a Slapi_DN from now on.
+ */
+static Slapi_DN *
+ps_get_base(PSearch *ps)
+{
+    Slapi_DN *base = NULL;
+    char *origbase = NULL;
+
+    slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_TARGET_SDN, &base);
+    if (NULL == base) {
+        slapi_pblock_get(ps->ps_pblock, SLAPI_ORIGINAL_TARGET_DN, &origbase);
+        base = slapi_sdn_new_dn_byref(origbase);
+        slapi_pblock_set(ps->ps_pblock, SLAPI_SEARCH_TARGET_SDN, base);
     }
+    return base;
 }
 
+/*
+ * Builds the "type=key" guard key, the type is lower cased.
+ * Returns NULL if the key cannot be used as a string.
+ */
+static char *
+ps_guard_key(const char *type, const struct berval *bv)
+{
+    char *key;
+    char *p;
+
+    if (bv == NULL || bv->bv_val == NULL || memchr(bv->bv_val, '\0', bv->bv_len) != NULL) {
+        return NULL;
+    }
+    key = slapi_ch_smprintf("%s=%.*s", type, (int)bv->bv_len, bv->bv_val);
+    for (p = key; *p != '='; p++) {
+        *p = tolower(*p);
+    }
+    return key;
+}
+
+/*
+ * Looks for an equality assertion every entry matching f must satisfy,
+ * and returns its guard key, or NULL.
+ */
+static char *
+ps_filter_guard_key(Slapi_Filter *f, char **type)
+{
+    Slapi_Filter *fi = NULL;
+    char *key = NULL;
+
+    switch (slapi_filter_get_choice(f)) {
+    case LDAP_FILTER_EQUALITY: {
+        struct berval *bv = NULL;
+        Slapi_Value *sval = NULL;
+        Slapi_Value **ivals = NULL;
+        Slapi_Attr sattr;
+
+        if (slapi_filter_get_ava(f, type, &bv) != 0 || *type == NULL) {
+            return NULL;
+        }
+        slapi_attr_init(&sattr, *type);
+        sval = slapi_value_new_berval(bv);
+        slapi_attr_assertion2keys_ava_sv(&sattr, sval, &ivals, LDAP_FILTER_EQUALITY);
+        if (ivals && ivals[0] && ivals[1] == NULL) {
+            key = ps_guard_key(*type, slapi_value_get_berval(ivals[0]));
+        }
+        valuearray_free(&ivals);
+        slapi_value_free(&sval);
+        attr_done(&sattr);
+        break;
+    }
+    case LDAP_FILTER_AND:
+        /* any equality component will do, objectclass is the least selective */
+        for (fi = slapi_filter_list_first(f); fi && key == NULL; fi = slapi_filter_list_next(f, fi)) {
+            char *ftype = NULL;
+            if (slapi_filter_get_choice(fi) == LDAP_FILTER_EQUALITY &&
+                slapi_filter_get_attribute_type(fi, &ftype) == 0 &&
+                ftype && strcasecmp(ftype, SLAPI_ATTR_OBJECTCLASS) != 0) {
+                key = ps_filter_guard_key(fi, type);
+            }
+        }
+        for (fi = slapi_filter_list_first(f); fi && key == NULL; fi = slapi_filter_list_next(f, fi)) {
+            key = ps_filter_guard_key(fi, type);
+        }
+        break;
+    default:
+        break;
+    }
+    return key;
+}
+
+static void
+ps_list_link(PSearch **head, PSearch *ps)
+{
+    ps->ps_idx_prev = NULL;
+    ps->ps_idx_next = *head;
+    if (*head) {
+        (*head)->ps_idx_prev = ps;
+    }
+    *head = ps;
+}
+
+static void
+ps_list_unlink(PSearch **head, PSearch *ps)
+{
+    if (ps->ps_idx_prev) {
+        ps->ps_idx_prev->ps_idx_next = ps->ps_idx_next;
+    } else {
+        *head = ps->ps_idx_next;
+    }
+    if (ps->ps_idx_next) {
+        ps->ps_idx_next->ps_idx_prev = ps->ps_idx_prev;
+    }
+    ps->ps_idx_prev = ps->ps_idx_next = NULL;
+}
+
+/*
+ * Adds ps to the dispatch index. The caller holds the list write lock.
+ */
+static void
+ps_index_add(PSearch *ps)
+{
+    Slapi_DN *base = ps_get_base(ps);
+    Slapi_Filter *f = NULL;
+    PS_Bucket *b;
+    char *type = NULL;
+    char *key;
+
+    slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_FILTER, &f);
+
+    b = (PS_Bucket *)PL_HashTableLookup(psearch_list->pl_buckets, slapi_sdn_get_ndn(base));
+    if (b == NULL) {
+        b = (PS_Bucket *)slapi_ch_calloc(1, sizeof(PS_Bucket));
+        b->b_ndn = slapi_ch_strdup(slapi_sdn_get_ndn(base));
+        PL_HashTableAdd(psearch_list->pl_buckets, b->b_ndn, b);
+    }
+    b->b_count++;
+    ps->ps_bucket = b;
+
+    key = f ? ps_filter_guard_key(f, &type) : NULL;
+    if (key == NULL) {
+        ps_list_link(&b->b_unguarded, ps);
+        return;
+    }
+
+    if (b->b_guards == NULL) {
+        b->b_guards = PL_NewHashTable(64, PL_HashString, PL_CompareStrings,
+                                      PL_CompareValues, NULL, NULL);
+    }
+    ps->ps_guard = (PS_Guard *)PL_HashTableLookup(b->b_guards, key);
+    if (ps->ps_guard == NULL) {
+        PS_GuardType *gt;
+
+        ps->ps_guard = (PS_Guard *)slapi_ch_calloc(1, sizeof(PS_Guard));
+        ps->ps_guard->g_key = key;
+        ps->ps_guard->g_type = slapi_ch_strdup(type);
+        PL_HashTableAdd(b->b_guards, key, ps->ps_guard);
+        for (gt = b->b_guard_types; gt && strcasecmp(gt->gt_type, type); gt = gt->gt_next)
+            ;
+        if (gt == NULL) {
+            gt = (PS_GuardType *)slapi_ch_calloc(1, sizeof(PS_GuardType));
+            gt->gt_type = slapi_ch_strdup(type);
+            gt->gt_next = b->b_guard_types;
+            b->b_guard_types = gt;
+        }
+        gt->gt_refcnt++;
+    } else {
+        slapi_ch_free_string(&key);
+    }
+    ps_list_link(&ps->ps_guard->g_head, ps);
+}
+
+/*
+ * Removes ps from the dispatch index. The caller holds the list write lock.
+ */
+static void
+ps_index_remove(PSearch *ps)
+{
+    PS_Bucket *b = ps->ps_bucket;
+    PS_Guard *g = ps->ps_guard;
+
+    if (b == NULL) {
+        return;
+    }
+    if (g) {
+        ps_list_unlink(&g->g_head, ps);
+        if (g->g_head == NULL) {
+            PS_GuardType **gtp;
+
+            for (gtp = &b->b_guard_types; *gtp; gtp = &(*gtp)->gt_next) {
+                if (strcasecmp((*gtp)->gt_type, g->g_type) == 0) {
+                    if (--(*gtp)->gt_refcnt == 0) {
+                        PS_GuardType *gt = *gtp;
+                        *gtp = gt->gt_next;
+                        slapi_ch_free_string(&gt->gt_type);
+                        slapi_ch_free((void **)&gt);
+                    }
+                    break;
+                }
+            }
+            PL_HashTableRemove(b->b_guards, g->g_key);
+            slapi_ch_free_string(&g->g_key);
+            slapi_ch_free_string(&g->g_type);
+            slapi_ch_free((void **)&g);
+        }
+        ps->ps_guard = NULL;
+    } else {
+        ps_list_unlink(&b->b_unguarded, ps);
+    }
+    ps->ps_bucket = NULL;
+
+    if (--b->b_count == 0) {
+        PL_HashTableRemove(psearch_list->pl_buckets, b->b_ndn);
+        if (b->b_guards) {
+            PL_HashTableDestroy(b->b_guards);
+        }
+        slapi_ch_free_string(&b->b_ndn);
+        slapi_ch_free((void **)&b);
+    }
+}
+
+/*
+ * Adds to keys the guard keys of the real values of type (and of its
+ * subtypes) in e.
+ */
+static void
+ps_entry_guard_keys(Slapi_Entry *e, const char *type, char ***keys)
+{
+    Slapi_Attr *a = NULL;
+    int rc;
+
+    for (rc = slapi_entry_first_attr(e, &a); rc == 0 && a; rc = slapi_entry_next_attr(e, a, &a)) {
+        Slapi_Value **ivals = NULL;
+        char *atype = NULL;
+
+        slapi_attr_get_type(a, &atype);
+        if (slapi_attr_type_cmp(type, atype, SLAPI_TYPE_CMP_SUBTYPE) != 0) {
+            continue;
+        }
+        slapi_attr_values2keys_sv(a, valueset_get_valuearray(&a->a_present_values), &ivals, LDAP_FILTER_EQUALITY);
+        for (size_t i = 0; ivals && ivals[i]; i++) {
+            char *key = ps_guard_key(type, slapi_value_get_berval(ivals[i]));
+            size_t j;
+
+            /* the keys are compared exactly, like in b_guards */
+            for (j = 0; key && *keys && (*keys)[j] && strcmp((*keys)[j], key); j++)
+                ;
+            if (key && (*keys == NULL || (*keys)[j] == NULL)) {
+                charray_add(keys, key);
+            } else {
+                slapi_ch_free_string(&key);
+            }
+        }
+        valuearray_free(&ivals);
+    }
+}
+
+
+typedef struct _ps_dispatch_ctx
+{
+    Slapi_Entry *e;
+    Slapi_Entry *eprev;
+    ber_int_t chgtype;
+    ber_int_t chgnum;
+    LDAPControl **ctrl;
+    const char *type;
+    int matched;
+} PS_Dispatch_Ctx;
+
+/*
+ * PL_HashTableEnumerateEntries callback servicing all the searches
+ * guarded on a given type.
+ */
+static PRIntn
+ps_service_guard_type(PLHashEntry *he, PRIntn i __attribute__((unused)), void *arg)
+{
+    PS_Dispatch_Ctx *ctx = (PS_Dispatch_Ctx *)arg;
+    PS_Guard *g = (PS_Guard *)he->value;
+    PSearch *ps;
+
+    if (strcasecmp(g->g_type, ctx->type) == 0) {
+        for (ps = g->g_head; NULL != ps; ps = ps->ps_idx_next) {
+            ctx->matched += ps_service_one(ps, ctx->e, ctx->eprev, ctx->chgtype, ctx->chgnum, ctx->ctrl);
+        }
+    }
+    return HT_ENUMERATE_NEXT;
+}
+
+/*
+ * Enqueues e on ps if it matches its changetypes, scope and filter,
+ * and wakes up the ps thread. Returns 1 if e was enqueued.
+ * The caller holds the list read lock.
+ */
+static int
+ps_service_one(PSearch *ps, Slapi_Entry *e, Slapi_Entry *eprev, ber_int_t chgtype, ber_int_t chgnum, LDAPControl **ctrl)
+{
+    PSEQNode *pe = NULL;
+    Slapi_Filter *f;
+    int scope;
+    Connection *pb_conn = NULL;
+    Operation *pb_op = NULL;
+
+    slapi_pblock_get(ps->ps_pblock, SLAPI_OPERATION, &pb_op);
+    slapi_pblock_get(ps->ps_pblock, SLAPI_CONNECTION, &pb_conn);
+
+    /* Skip the node that doesn't meet the changetype,
+     * or is unable to use the change in ps_send_results()
+     */
+    if ((ps->ps_changetypes & chgtype) == 0 || pb_op == NULL ||
+        slapi_op_abandoned(ps->ps_pblock)) {
+        return 0;
+    }
+
+    slapi_log_err(SLAPI_LOG_CONNS, "ps_service_persistent_searches",
+                  "conn=%" PRIu64 " op=%d entry %s with chgtype %d "
+                  "matches the ps changetype %d\n",
+                  pb_conn ? pb_conn->c_connid : -1,
+                  pb_op->o_opid,
+                  slapi_entry_get_dn_const(e), chgtype, ps->ps_changetypes);
+
+    slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_FILTER, &f);
+    slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_SCOPE, &scope);
+
+    /*
+     * See if the entry meets the scope and filter criteria.
+     * We cannot do the acl check here as this thread
+     * would then potentially clash with the ps_send_results()
+     * thread on the aclpb in ps->ps_pblock.
+     * By avoiding the acl check in this thread, and leaving all the acl
+     * checking to the ps_send_results() thread we avoid
+     * the ps_pblock contention problem.
+     * The lesson here is "Do not give multiple threads arbitary access
+     * to the same pblock" this kind of muti-threaded access
+     * to the same pblock must be done carefully--there is currently no
+     * generic satisfactory way to do this.
+    */
+    if (slapi_sdn_scope_test(slapi_entry_get_sdn_const(e), ps_get_base(ps), scope) &&
+        slapi_vattr_filter_test(ps->ps_pblock, e, f, 0 /* verify_access */) == 0) {
+        PSEQNode *pOldtail;
+
+        /* The scope and the filter match - enqueue it */
+        pe = (PSEQNode *)slapi_ch_calloc(1, sizeof(PSEQNode));
+        pe->pe_entry = slapi_entry_dup(e);
+        if (ps->ps_send_entchg_controls) {
+            /* create_entrychange_control() is more
+             * expensive than slapi_dup_control()
+             */
+            if (*ctrl == NULL) {
+                int rc;
+                rc = create_entrychange_control(chgtype, chgnum,
+                                                eprev ? slapi_entry_get_dn_const(eprev) : NULL,
+                                                ctrl);
+                if (rc != LDAP_SUCCESS) {
+                    slapi_log_err(SLAPI_LOG_ERR, "ps_service_persistent_searches",
+                                  "Unable to create EntryChangeNotification control for"
+                                  " entry \"%s\" -- control won't be sent.\n",
+                                  slapi_entry_get_dn_const(e));
+                }
+            }
+            if (*ctrl) {
+                pe->pe_ctrls[0] = slapi_dup_control(*ctrl);
+            }
+        }
+
+        /* Put it on the end of the list for this pers search */
+        PR_Lock(ps->ps_lock);
+        pOldtail = ps->ps_eq_tail;
+        ps->ps_eq_tail = pe;
+        if (NULL == ps->ps_eq_head) {
+            ps->ps_eq_head = ps->ps_eq_tail;
+        } else {
+            pOldtail->pe_next = ps->ps_eq_tail;
+        }
+        PR_Unlock(ps->ps_lock);
+
+        /* Turn it loose, the other searches are left sleeping */
+        ps_wakeup(ps);
+        return 1;
+    }
+    return 0;
+}
 
 /*
  * Check if there are any persistent searches.  If so,
@@ -499,6 +953,10 @@ ps_wakeup_all()
  * If so, then enqueue the entry on that persistent search's
  * ps_entryqueue and signal it to wake up and send the entry.
  *
+ * Only the searches based on the entry DN or one of its ancestors
+ * are considered, and among them the searches whose filter requires
+ * an equality the entry does not satisfy are skipped (see PS_Bucket).
+ *
  * Note that if eprev is NULL we assume that the entry's DN
  * was not changed by the op. that called this function.  If
  * chgnum is 0 it is unknown so we won't ever send it to a
@@ -509,9 +967,8 @@ ps_service_persistent_searches(Slapi_Entry *e, Slapi_Entry *eprev, ber_int_t chg
 {
     LDAPControl *ctrl = NULL;
     PSearch *ps = NULL;
-    PSEQNode *pe = NULL;
     int matched = 0;
-    const char *edn;
+    const char *ndn;
 
     if (!PS_IS_INITIALIZED()) {
         return;
@@ -525,96 +982,44 @@ ps_service_persistent_searches(Slapi_Entry *e, Slapi_Entry *eprev, ber_int_t chg
     assert(psearch_list);
     assert(psearch_list->pl_rwlock);
     PSL_LOCK_READ();
-    edn = slapi_entry_get_dn_const(e);
-
-    for (ps = psearch_list ? psearch_list->pl_head : NULL; NULL != ps; ps = ps->ps_next) {
-        char *origbase = NULL;
-        Slapi_DN *base = NULL;
-        Slapi_Filter *f;
-        int scope;
-        Connection *pb_conn = NULL;
-        Operation *pb_op = NULL;
-
-        slapi_pblock_get(ps->ps_pblock, SLAPI_OPERATION, &pb_op);
-        slapi_pblock_get(ps->ps_pblock, SLAPI_CONNECTION, &pb_conn);
-
-        /* Skip the node that doesn't meet the changetype,
-         * or is unable to use the change in ps_send_results()
-         */
-        if ((ps->ps_changetypes & chgtype) == 0 || pb_op == NULL ||
-            slapi_op_abandoned(ps->ps_pblock)) {
-            continue;
-        }
 
-        slapi_log_err(SLAPI_LOG_CONNS, "ps_service_persistent_searches",
-                      "conn=%" PRIu64 " op=%d entry %s with chgtype %d "
-                      "matches the ps changetype %d\n",
-                      pb_conn ? pb_conn->c_connid : -1,
-                      pb_op->o_opid,
-                      edn, chgtype, ps->ps_changetypes);
+    /* walk up from the entry to the root DSE */
+    ndn = slapi_sdn_get_ndn(slapi_entry_get_sdn_const(e));
+    while (ndn && psearch_list->pl_head) {
+        PS_Bucket *b = (PS_Bucket *)PL_HashTableLookup(psearch_list->pl_buckets, ndn);
 
-        slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_FILTER, &f);
-        slapi_pblock_get(ps->ps_pblock, SLAPI_ORIGINAL_TARGET_DN, &origbase);
-        slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_TARGET_SDN, &base);
-        slapi_pblock_get(ps->ps_pblock, SLAPI_SEARCH_SCOPE, &scope);
-        if (NULL == base) {
-            base = slapi_sdn_new_dn_byref(origbase);
-            slapi_pblock_set(ps->ps_pblock, SLAPI_SEARCH_TARGET_SDN, base);
-        }
+        if (b) {
+            PS_GuardType *gt;
 
-        /*
-         * See if the entry meets the scope and filter criteria.
-         * We cannot do the acl check here as this thread
-         * would then potentially clash with the ps_send_results()
-         * thread on the aclpb in ps->ps_pblock.
-         * By avoiding the acl check in this thread, and leaving all the acl
-         * checking to the ps_send_results() thread we avoid
-         * the ps_pblock contention problem.
-         * The lesson here is "Do not give multiple threads arbitary access
-         * to the same pblock" this kind of muti-threaded access
-         * to the same pblock must be done carefully--there is currently no
-         * generic satisfactory way to do this.
-        */
-        if (slapi_sdn_scope_test(slapi_entry_get_sdn_const(e), base, scope) &&
-            slapi_vattr_filter_test(ps->ps_pblock, e, f, 0 /* verify_access */) == 0) {
-            PSEQNode *pOldtail;
-
-            /* The scope and the filter match - enqueue it */
-
-            matched++;
-            pe = (PSEQNode *)slapi_ch_calloc(1, sizeof(PSEQNode));
-            pe->pe_entry = slapi_entry_dup(e);
-            if (ps->ps_send_entchg_controls) {
-                /* create_entrychange_control() is more
-                 * expensive than slapi_dup_control()
-                 */
-                if (ctrl == NULL) {
-                    int rc;
-                    rc = create_entrychange_control(chgtype, chgnum,
-                                                    eprev ? slapi_entry_get_dn_const(eprev) : NULL,
-                                                    &ctrl);
-                    if (rc != LDAP_SUCCESS) {
-                        slapi_log_err(SLAPI_LOG_ERR, "ps_service_persistent_searches",
-                                      "Unable to create EntryChangeNotification control for"
-                                      " entry \"%s\" -- control won't be sent.\n",
-                                      slapi_entry_get_dn_const(e));
+            for (ps = b->b_unguarded; NULL != ps; ps = ps->ps_idx_next) {
+                matched += ps_service_one(ps, e, eprev, chgtype, chgnum, &ctrl);
+            }
+            for (gt = b->b_guard_types; NULL != gt; gt = gt->gt_next) {
+                if (vattr_type_is_virtual(e, gt->gt_type)) {
+                    /* the values are not in e, every guard of the type is a candidate */
+                    PS_Dispatch_Ctx ctx = {e, eprev, chgtype, chgnum, &ctrl, gt->gt_type, 0};
+                    PL_HashTableEnumerateEntries(b->b_guards, ps_service_guard_type, &ctx);
+                    matched += ctx.matched;
+                } else {
+                    char **keys = NULL;
+
+                    ps_entry_guard_keys(e, gt->gt_type, &keys);
+                    for (size_t i = 0; keys && keys[i]; i++) {
+                        PS_Guard *g = (PS_Guard *)PL_HashTableLookup(b->b_guards, keys[i]);
+                        for (ps = g ? g->g_head : NULL; NULL != ps; ps = ps->ps_idx_next) {
+                            matched += ps_service_one(ps, e, eprev, chgtype, chgnum, &ctrl);
+                        }
                     }
+                    charray_free(keys);
                 }
-                if (ctrl) {
-                    pe->pe_ctrls[0] = slapi_dup_control(ctrl);
-                }
-            }
-
-            /* Put it on the end of the list for this pers search */
-            PR_Lock(ps->ps_lock);
-            pOldtail = ps->ps_eq_tail;
-            ps->ps_eq_tail = pe;
-            if (NULL == ps->ps_eq_head) {
-                ps->ps_eq_head = ps->ps_eq_tail;
-            } else {
-                pOldtail->pe_next = ps->ps_eq_tail;
             }
-            PR_Unlock(ps->ps_lock);
+        }
+        if (*ndn == '\0') {
+            break;
+        }
+        ndn = slapi_dn_find_parent(ndn);
+        if (ndn == NULL) {
+            ndn = "";
         }
     }
 
@@ -623,8 +1028,6 @@ ps_service_persistent_searches(Slapi_Entry *e, Slapi_Entry *eprev, ber_int_t chg
     /* Were there any matches? */
     if (matched) {
         ldap_control_free(ctrl);
-        /* Turn 'em loose */
-        ps_wakeup_all();
         slapi_log_err(SLAPI_LOG_TRACE, "ps_service_persistent_searches", "Enqueued entry "
                       "\"%s\" on %d persistent search lists\n",
                       slapi_entry_get_dn_const(e), matched);
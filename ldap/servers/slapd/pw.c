@@ -2720,10 +2720,13 @@ slapi_check_tpr_limits(Slapi_PBlock *pb, Slapi_Entry *bind_target_entry, int sen
     /* Check entry TPR max use */
     if (pwpolicy->pw_tpr_maxuse >= 0) {
         uint use_count;
-        value = (char *) slapi_entry_attr_get_ref(bind_target_entry, "pwdTPRUseCount");
+        /* the count of the previous binds may not be written yet */
+        char *pending = slapi_bind_state_get_charptr(dn, "pwdTPRUseCount");
+        value = pending ? pending : (char *) slapi_entry_attr_get_ref(bind_target_entry, "pwdTPRUseCount");
         if (value) {
             /* max Use is enforced */
             use_count = strtoull(value, 0, 0);
+            slapi_ch_free_string(&pending);
             use_count++;
             update_tpr_pw_usecount(pb, bind_target_entry, (int32_t) use_count);
             if (use_count > pwpolicy->pw_tpr_maxuse) {
@@ -2891,17 +2894,18 @@ slapi_check_account_lock(Slapi_PBlock *pb, Slapi_Entry *bind_target_entry, int p
     /* check if account is locked out.  If so, send result and return 1 */
     {
         unsigned int maxfailure = pwpolicy->pw_maxfailure;
-        /* It's locked if passwordRetryCount >= maxfailure */
-        if (slapi_entry_attr_get_uint(bind_target_entry, "passwordRetryCount") < maxfailure) {
+        /* It's locked if passwordRetryCount >= maxfailure, the last failures may not be written yet */
+        if ((unsigned int)pw_bind_state_attr_get_int(bind_target_entry, "passwordRetryCount") < maxfailure) {
             /* Not locked */
             goto notlocked;
         }
     }
 
     /* locked but maybe it's time to unlock it */
-    accountUnlockTime = (char *)slapi_entry_attr_get_ref(bind_target_entry, "accountUnlockTime");
+    accountUnlockTime = pw_bind_state_attr_get_charptr(bind_target_entry, "accountUnlockTime");
     if (accountUnlockTime != NULL) {
         unlock_time = parse_genTime(accountUnlockTime);
+        slapi_ch_free_string(&accountUnlockTime);
 
         if (pwpolicy->pw_unlock == 0 &&
             unlock_time == NO_TIME) {
@@ -3039,7 +3043,7 @@ slapi_pwpolicy_is_locked(Slapi_PWPolicy *pwpolicy, Slapi_Entry *e, time_t *unloc
         /* Check if account is locked */
         if (pwpolicy->pw_lockout == 1) {
             /* Despite get_uint, we still compare to an int ... */
-            if ((int)slapi_entry_attr_get_uint(e, "passwordRetryCount") >= pwpolicy->pw_maxfailure) {
+            if (pw_bind_state_attr_get_int(e, "passwordRetryCount") >= pwpolicy->pw_maxfailure) {
                 is_locked = 1;
             }
         }
@@ -3051,7 +3055,7 @@ slapi_pwpolicy_is_locked(Slapi_PWPolicy *pwpolicy, Slapi_Entry *e, time_t *unloc
             time_t _unlock_time = (time_t)0;
             time_t cur_time;
 
-            unlock_time_str = slapi_entry_attr_get_charptr(e, "accountUnlockTime");
+            unlock_time_str = pw_bind_state_attr_get_charptr(e, "accountUnlockTime");
             if (unlock_time_str) {
                 _unlock_time = parse_genTime(unlock_time_str);
             }
@@ -114,7 +114,7 @@ need_new_pw(Slapi_PBlock *pb, Slapi_Entry *e, int pwresponse_req)
 
     /* after the user binds with authentication, clear the retry count */
     if (pwpolicy->pw_lockout == 1) {
-        if (slapi_entry_attr_get_int(e, "passwordRetryCount") > 0) {
+        if (pw_bind_state_attr_get_int(e, "passwordRetryCount") > 0) {
             slapi_mods_add_string(&smods, LDAP_MOD_REPLACE, "passwordRetryCount", "0");
         }
     }
@@ -138,7 +138,7 @@ need_new_pw(Slapi_PBlock *pb, Slapi_Entry *e, int pwresponse_req)
             slapi_mods_add_string(&smods, LDAP_MOD_REPLACE, "passwordExpWarned", "0");
 
             pw_apply_mods(sdn, &smods);
-        } else if (pwpolicy->pw_lockout == 1) {
+        } else if (pwpolicy->pw_lockout == 1 && slapi_bind_state_write(sdn, &smods) != 0) {
             pw_apply_mods(sdn, &smods);
         }
         slapi_mods_done(&smods);
@@ -24,6 +24,7 @@
 static int set_retry_cnt(Slapi_PBlock *pb, int count);
 static int set_retry_cnt_and_time(Slapi_PBlock *pb, int count, time_t cur_time);
 static int set_tpr_usecount(Slapi_PBlock *pb, int count);
+static void pw_apply_bind_mods(const Slapi_DN *sdn, Slapi_Mods *mods);
 
 /*
  * update_pw_retry() is called when bind operation fails with
@@ -52,6 +53,8 @@ update_pw_retry(Slapi_PBlock *pb)
     if (e == NULL) {
         return (1);
     }
+    /* the counters of the previous failures may not be written yet */
+    pw_bind_state_overlay(e);
 
     cur_time = slapi_current_utc_time();
 
@@ -151,7 +154,7 @@ set_retry_cnt_and_time(Slapi_PBlock *pb, int count, time_t cur_time)
 
     rc = set_retry_cnt_mods(pb, &smods, count);
 
-    pw_apply_mods(sdn, &smods);
+    pw_apply_bind_mods(sdn, &smods);
     slapi_mods_done(&smods);
 
     return rc;
@@ -255,7 +258,7 @@ set_retry_cnt(Slapi_PBlock *pb, int count)
     slapi_pblock_get(pb, SLAPI_TARGET_SDN, &sdn);
     slapi_mods_init(&smods, 0);
     rc = set_retry_cnt_mods(pb, &smods, count);
-    pw_apply_mods(sdn, &smods);
+    pw_apply_bind_mods(sdn, &smods);
     slapi_mods_done(&smods);
     return rc;
 }
@@ -275,7 +278,7 @@ set_tpr_usecount(Slapi_PBlock *pb, int count)
     slapi_pblock_get(pb, SLAPI_TARGET_SDN, &sdn);
     slapi_mods_init(&smods, 0);
     rc = set_tpr_usecount_mods(pb, &smods, count);
-    pw_apply_mods(sdn, &smods);
+    pw_apply_bind_mods(sdn, &smods);
     slapi_mods_done(&smods);
     return rc;
 }
@@ -357,6 +360,576 @@ pw_apply_mods(const Slapi_DN *sdn, Slapi_Mods *mods)
     return;
 }
 
+/*
+ * Bind state write-behind
+ *
+ * A bind writes the password retry counters (passwordRetryCount,
+ * retryCountResetTime, accountUnlockTime, pwdTPRUseCount) and, with the
+ * account policy plugin, the login time of the entry. With
+ * nsslapd-bind-state-write-window set, these replace mods are not applied
+ * at once but merged per entry (the last value of an attribute wins) and
+ * written by the bind-state thread when the window expires, up to
+ * nsslapd-bind-state-write-batch entries per backend transaction.
+ *
+ * The pending values are kept in an entry per DN, and what reads the bind
+ * state for the lockout (slapi_check_account_lock(), update_pw_retry()...)
+ * looks at them first, so a failure is counted even before it is written.
+ * A modify of one of these attributes from anywhere else, a password change
+ * or an unlock for instance, discards the pending values of the entry
+ * before its backend write, waits for the thread if it is writing them,
+ * and holds the entry until the write is done: meanwhile the binds on it
+ * write their updates themselves, so none can land after the modify.
+ */
+
+typedef struct bind_state_hold
+{
+    char *ndn;
+    int32_t count; /* operations writing the bind state of ndn */
+} bind_state_hold;
+
+typedef struct bind_state
+{
+    PLHashTable *pending;  /* ndn -> Slapi_Entry of the values to write */
+    PLHashTable *flushing; /* the ones being written by the thread */
+    PLHashTable *held;     /* ndn -> bind_state_hold, see pw_bind_state_discard() */
+    const char *applying;  /* ndn of the values the thread is writing */
+    int32_t npending;
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;
+    pthread_cond_t applied_cv;
+    PRThread *tid;
+    int32_t running;
+    int shutdown;
+    uint64_t queued;
+    uint64_t merged;
+    uint64_t written;
+    uint64_t batches;
+} bind_state;
+
+static bind_state bstate;
+
+static PLHashTable *
+bind_state_table_new(void)
+{
+    return PL_NewHashTable(64, PL_HashString, PL_CompareStrings, PL_CompareValues, NULL, NULL);
+}
+
+/* The pending values of ndn, the caller holds bstate.lock */
+static Slapi_Entry *
+bind_state_lookup(const char *ndn)
+{
+    Slapi_Entry *e = (Slapi_Entry *)PL_HashTableLookup(bstate.pending, ndn);
+
+    if (e == NULL && bstate.flushing) {
+        e = (Slapi_Entry *)PL_HashTableLookup(bstate.flushing, ndn);
+    }
+    return e;
+}
+
+/* Only replace mods with values can be merged */
+static int
+bind_state_mods_mergeable(Slapi_Mods *smods)
+{
+    LDAPMod *mod;
+
+    for (mod = slapi_mods_get_first_mod(smods); mod; mod = slapi_mods_get_next_mod(smods)) {
+        if ((mod->mod_op & ~LDAP_MOD_BVALUES) != LDAP_MOD_REPLACE ||
+            mod->mod_bvalues == NULL || mod->mod_bvalues[0] == NULL) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/* Replace the values of the mod in e, the caller holds bstate.lock */
+static void
+bind_state_merge_mod(Slapi_Entry *e, LDAPMod *mod)
+{
+    slapi_entry_attr_delete(e, mod->mod_type);
+    for (size_t i = 0; mod->mod_bvalues[i]; i++) {
+        if (mod->mod_op & LDAP_MOD_BVALUES) {
+            Slapi_Value *v = slapi_value_new_berval(mod->mod_bvalues[i]);
+            slapi_entry_add_value(e, mod->mod_type, v);
+            slapi_value_free(&v);
+        } else {
+            slapi_entry_add_string(e, mod->mod_type, mod->mod_values[i]);
+        }
+    }
+}
+
+/*
+ * Queue the replace mods of a bind on sdn for the bind-state thread.
+ * Returns 0 if they are queued, -1 if the caller has to apply them itself:
+ * the write-behind is disabled, or the mods are not all replace mods.
+ */
+int
+slapi_bind_state_write(const Slapi_DN *sdn, Slapi_Mods *smods)
+{
+    const char *ndn = slapi_sdn_get_ndn(sdn);
+    Slapi_Entry *e = NULL;
+    Slapi_Entry *flushing = NULL;
+    LDAPMod *mod = NULL;
+
+    if (!slapi_atomic_load_32(&(bstate.running), __ATOMIC_ACQUIRE) ||
+        config_get_bind_state_write_window() == 0 ||
+        ndn == NULL || slapi_mods_get_num_mods(smods) == 0 ||
+        !bind_state_mods_mergeable(smods)) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&bstate.lock);
+    if (bstate.shutdown || PL_HashTableLookup(bstate.held, ndn)) {
+        pthread_mutex_unlock(&bstate.lock);
+        return -1;
+    }
+    if ((e = (Slapi_Entry *)PL_HashTableLookup(bstate.pending, ndn)) != NULL) {
+        bstate.merged++;
+    } else {
+        /* Being written: start from those values, they are written first anyway */
+        if (bstate.flushing &&
+            (flushing = (Slapi_Entry *)PL_HashTableLookup(bstate.flushing, ndn)) != NULL) {
+            e = slapi_entry_dup(flushing);
+        } else {
+            e = slapi_entry_alloc();
+            slapi_entry_init(e, slapi_ch_strdup(ndn), NULL);
+        }
+        PL_HashTableAdd(bstate.pending, slapi_entry_get_ndn(e), e);
+        bstate.npending++;
+        pthread_cond_signal(&bstate.work_cv);
+    }
+    for (mod = slapi_mods_get_first_mod(smods); mod; mod = slapi_mods_get_next_mod(smods)) {
+        bind_state_merge_mod(e, mod);
+    }
+    bstate.queued++;
+    pthread_mutex_unlock(&bstate.lock);
+
+    return 0;
+}
+
+/*
+ * The pending value of a bind state attribute of ndn, or NULL.
+ * The caller frees it.
+ */
+char *
+slapi_bind_state_get_charptr(const char *ndn, const char *type)
+{
+    Slapi_Entry *e = NULL;
+    char *value = NULL;
+
+    if (!slapi_atomic_load_32(&(bstate.running), __ATOMIC_ACQUIRE) || ndn == NULL) {
+        return NULL;
+    }
+    pthread_mutex_lock(&bstate.lock);
+    if (bstate.npending > 0 || bstate.flushing) {
+        if ((e = bind_state_lookup(ndn)) != NULL) {
+            value = slapi_entry_attr_get_charptr(e, type);
+        }
+    }
+    pthread_mutex_unlock(&bstate.lock);
+
+    return value;
+}
+
+/* Like slapi_bind_state_get_charptr(), for all the values */
+char **
+slapi_bind_state_get_charray(const char *ndn, const char *type)
+{
+    Slapi_Entry *e = NULL;
+    char **values = NULL;
+
+    if (!slapi_atomic_load_32(&(bstate.running), __ATOMIC_ACQUIRE) || ndn == NULL) {
+        return NULL;
+    }
+    pthread_mutex_lock(&bstate.lock);
+    if (bstate.npending > 0 || bstate.flushing) {
+        if ((e = bind_state_lookup(ndn)) != NULL) {
+            values = slapi_entry_attr_get_charray(e, type);
+        }
+    }
+    pthread_mutex_unlock(&bstate.lock);
+
+    return values;
+}
+
+/* Value of the bind state attribute type of e, the pending one if any. The caller frees it. */
+char *
+pw_bind_state_attr_get_charptr(const Slapi_Entry *e, const char *type)
+{
+    char *value = slapi_bind_state_get_charptr(slapi_entry_get_ndn((Slapi_Entry *)e), type);
+
+    if (value == NULL) {
+        value = slapi_entry_attr_get_charptr(e, type);
+    }
+    return value;
+}
+
+int
+pw_bind_state_attr_get_int(const Slapi_Entry *e, const char *type)
+{
+    char *value = slapi_bind_state_get_charptr(slapi_entry_get_ndn((Slapi_Entry *)e), type);
+    int num;
+
+    if (value == NULL) {
+        return slapi_entry_attr_get_int(e, type);
+    }
+    num = atoi(value);
+    slapi_ch_free_string(&value);
+    return num;
+}
+
+/* Apply the pending values of e (a copy) to it */
+void
+pw_bind_state_overlay(Slapi_Entry *e)
+{
+    Slapi_Entry *pending = NULL;
+    Slapi_Attr *a = NULL;
+
+    if (!slapi_atomic_load_32(&(bstate.running), __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    pthread_mutex_lock(&bstate.lock);
+    if ((bstate.npending > 0 || bstate.flushing) &&
+        (pending = bind_state_lookup(slapi_entry_get_ndn(e))) != NULL) {
+        for (slapi_entry_first_attr(pending, &a); a; slapi_entry_next_attr(pending, a, &a)) {
+            char *type = NULL;
+
+            slapi_attr_get_type(a, &type);
+            slapi_entry_attr_replace_sv(e, type, valueset_get_valuearray(&a->a_present_values));
+        }
+    }
+    pthread_mutex_unlock(&bstate.lock);
+}
+
+/*
+ * Forget the pending values of sdn, called before the backend write of an
+ * operation (other than the bind-state thread) that modifies its bind state
+ * or deletes it. Values the thread is about to write are dropped from
+ * bstate.flushing too: they are no longer returned to the readers, and the
+ * thread skips them. If the thread is writing them, wait until it is done.
+ *
+ * sdn is then held until pw_bind_state_release(): the binds on it do not
+ * queue their updates, they write them through the backend like the
+ * operation does.
+ */
+void
+pw_bind_state_discard(const Slapi_DN *sdn)
+{
+    Slapi_Entry *e = NULL;
+    bind_state_hold *hold = NULL;
+    const char *ndn = NULL;
+
+    if (!slapi_atomic_load_32(&(bstate.running), __ATOMIC_ACQUIRE) ||
+        PR_GetCurrentThread() == bstate.tid ||
+        (ndn = slapi_sdn_get_ndn(sdn)) == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&bstate.lock);
+    if ((hold = (bind_state_hold *)PL_HashTableLookup(bstate.held, ndn)) == NULL) {
+        hold = (bind_state_hold *)slapi_ch_calloc(1, sizeof(bind_state_hold));
+        hold->ndn = slapi_ch_strdup(ndn);
+        PL_HashTableAdd(bstate.held, hold->ndn, hold);
+    }
+    hold->count++;
+    if (bstate.npending > 0 &&
+        (e = (Slapi_Entry *)PL_HashTableLookup(bstate.pending, ndn)) != NULL) {
+        PL_HashTableRemove(bstate.pending, ndn);
+        bstate.npending--;
+        slapi_entry_free(e);
+    }
+    /* The thread owns the entries being written, it frees this one */
+    if (bstate.flushing) {
+        PL_HashTableRemove(bstate.flushing, ndn);
+    }
+    while (bstate.applying && strcmp(bstate.applying, ndn) == 0) {
+        pthread_cond_wait(&bstate.applied_cv, &bstate.lock);
+    }
+    pthread_mutex_unlock(&bstate.lock);
+}
+
+/* The operation that called pw_bind_state_discard() on sdn is done */
+void
+pw_bind_state_release(const Slapi_DN *sdn)
+{
+    bind_state_hold *hold = NULL;
+    const char *ndn = NULL;
+
+    if (!slapi_atomic_load_32(&(bstate.running), __ATOMIC_ACQUIRE) ||
+        PR_GetCurrentThread() == bstate.tid ||
+        (ndn = slapi_sdn_get_ndn(sdn)) == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&bstate.lock);
+    if ((hold = (bind_state_hold *)PL_HashTableLookup(bstate.held, ndn)) != NULL &&
+        --hold->count == 0) {
+        PL_HashTableRemove(bstate.held, ndn);
+        slapi_ch_free_string(&hold->ndn);
+        slapi_ch_free((void **)&hold);
+    }
+    pthread_mutex_unlock(&bstate.lock);
+}
+
+/* Returns 1 if the mods change the bind state of the entry */
+int
+pw_bind_state_mods_match(LDAPMod **mods)
+{
+    static const char *types[] = {SLAPI_USERPWD_ATTR, "passwordRetryCount", "retryCountResetTime",
+                                  "accountUnlockTime", "pwdTPRUseCount", NULL};
+
+    for (size_t i = 0; mods && mods[i]; i++) {
+        for (size_t j = 0; types[j]; j++) {
+            if (strcasecmp(mods[i]->mod_type, types[j]) == 0) {
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+static void
+pw_apply_bind_mods(const Slapi_DN *sdn, Slapi_Mods *mods)
+{
+    if (slapi_bind_state_write(sdn, mods) != 0) {
+        pw_apply_mods(sdn, mods);
+    }
+}
+
+static PRIntn
+bind_state_collect(PLHashEntry *he, PRIntn i, void *arg)
+{
+    Slapi_Entry **entries = (Slapi_Entry **)arg;
+
+    entries[i] = (Slapi_Entry *)he->value;
+    return HT_ENUMERATE_NEXT;
+}
+
+static int
+bind_state_cmp_be(const void *a, const void *b)
+{
+    const Slapi_Backend *be_a = slapi_be_select(slapi_entry_get_sdn_const(*(Slapi_Entry *const *)a));
+    const Slapi_Backend *be_b = slapi_be_select(slapi_entry_get_sdn_const(*(Slapi_Entry *const *)b));
+
+    return (be_a > be_b) - (be_a < be_b);
+}
+
+/* Write the pending values of e */
+static void
+bind_state_apply(Slapi_Entry *e)
+{
+    Slapi_PBlock *pb = NULL;
+    Slapi_Mods smods;
+    Slapi_Attr *a = NULL;
+    int res = 0;
+
+    slapi_mods_init(&smods, 0);
+    for (slapi_entry_first_attr(e, &a); a; slapi_entry_next_attr(e, a, &a)) {
+        char *type = NULL;
+
+        slapi_attr_get_type(a, &type);
+        slapi_mods_add_mod_values(&smods, LDAP_MOD_REPLACE, type, valueset_get_valuearray(&a->a_present_values));
+    }
+
+    pb = slapi_pblock_new();
+    slapi_modify_internal_set_pb_ext(pb, slapi_entry_get_sdn_const(e),
+                                     slapi_mods_get_ldapmods_byref(&smods),
+                                     NULL, NULL, pw_get_componentID(),
+                                     OP_FLAG_SKIP_MODIFIED_ATTRS | SLAPI_OP_FLAG_NO_ACCESS_CHECK |
+                                         SLAPI_OP_FLAG_BYPASS_REFERRALS);
+    slapi_modify_internal_pb(pb);
+    slapi_pblock_get(pb, SLAPI_PLUGIN_INTOP_RESULT, &res);
+    if (res != LDAP_SUCCESS) {
+        slapi_log_err(SLAPI_LOG_WARNING, "bind_state_apply",
+                      "Modify error %d on entry '%s'\n", res, slapi_entry_get_dn_const(e));
+    }
+    slapi_pblock_destroy(pb);
+    slapi_mods_done(&smods);
+}
+
+/* Write the entries, batch_size per transaction of their backend */
+static void
+bind_state_apply_all(Slapi_Entry **entries, int32_t count, int32_t batch_size)
+{
+    int32_t i = 0;
+
+    /* Group the entries per backend, to batch them in its transactions */
+    qsort(entries, count, sizeof(Slapi_Entry *), bind_state_cmp_be);
+
+    while (i < count) {
+        Slapi_Backend *be = slapi_be_select(slapi_entry_get_sdn_const(entries[i]));
+        Slapi_PBlock *txn_pb = slapi_pblock_new();
+        int32_t n = 0;
+
+        slapi_pblock_set(txn_pb, SLAPI_BACKEND, be);
+        if (be == NULL || slapi_back_transaction_begin(txn_pb) != 0) {
+            /* No transaction, the modifies are applied one by one */
+            slapi_pblock_destroy(txn_pb);
+            txn_pb = NULL;
+        }
+        for (; i < count && n < batch_size &&
+               slapi_be_select(slapi_entry_get_sdn_const(entries[i])) == be;
+             i++) {
+            const char *ndn = slapi_entry_get_ndn(entries[i]);
+            int discarded = 0;
+
+            /*
+             * Skip the values pw_bind_state_discard() dropped meanwhile. Once
+             * applying is set, it waits for this write before returning.
+             */
+            pthread_mutex_lock(&bstate.lock);
+            discarded = PL_HashTableLookup(bstate.flushing, ndn) != entries[i];
+            if (!discarded) {
+                bstate.applying = ndn;
+            }
+            pthread_mutex_unlock(&bstate.lock);
+            if (!discarded) {
+                bind_state_apply(entries[i]);
+                n++;
+                pthread_mutex_lock(&bstate.lock);
+                bstate.applying = NULL;
+                pthread_cond_broadcast(&bstate.applied_cv);
+                pthread_mutex_unlock(&bstate.lock);
+            }
+        }
+        if (txn_pb) {
+            slapi_back_transaction_commit(txn_pb);
+            slapi_pblock_destroy(txn_pb);
+        }
+
+        pthread_mutex_lock(&bstate.lock);
+        bstate.written += n;
+        bstate.batches++;
+        pthread_mutex_unlock(&bstate.lock);
+    }
+}
+
+static void
+bind_state_thread(void *arg __attribute__((unused)))
+{
+    slapi_set_thread_name("bind-state");
+
+    pthread_mutex_lock(&bstate.lock);
+    while (!bstate.shutdown || bstate.npending > 0) {
+        struct timespec deadline = {0};
+        int32_t window = config_get_bind_state_write_window();
+        Slapi_Entry **entries = NULL;
+        int32_t count = 0;
+
+        if (bstate.npending == 0) {
+            pthread_cond_wait(&bstate.work_cv, &bstate.lock);
+            continue;
+        }
+
+        /* Let the binds of the window merge into the pending values */
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += window / 1000;
+        deadline.tv_nsec += (window % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        while (!bstate.shutdown &&
+               pthread_cond_timedwait(&bstate.work_cv, &bstate.lock, &deadline) != ETIMEDOUT)
+            ;
+
+        count = bstate.npending;
+        entries = (Slapi_Entry **)slapi_ch_calloc(count, sizeof(Slapi_Entry *));
+        PL_HashTableEnumerateEntries(bstate.pending, bind_state_collect, entries);
+        bstate.flushing = bstate.pending;
+        bstate.pending = bind_state_table_new();
+        bstate.npending = 0;
+        pthread_mutex_unlock(&bstate.lock);
+
+        bind_state_apply_all(entries, count, config_get_bind_state_write_batch());
+
+        /* Some entries may have been discarded from the table, free them all from the array */
+        pthread_mutex_lock(&bstate.lock);
+        PL_HashTableDestroy(bstate.flushing);
+        bstate.flushing = NULL;
+        pthread_mutex_unlock(&bstate.lock);
+        for (int32_t i = 0; i < count; i++) {
+            slapi_entry_free(entries[i]);
+        }
+        slapi_ch_free((void **)&entries);
+        pthread_mutex_lock(&bstate.lock);
+    }
+    pthread_mutex_unlock(&bstate.lock);
+}
+
+/*
+ * Start the bind-state thread. It only holds the bind state updates while
+ * nsslapd-bind-state-write-window is not 0.
+ */
+int
+pw_bind_state_start(void)
+{
+    pthread_condattr_t condAttr;
+    int rc = 0;
+
+    if (bstate.tid) {
+        return 0;
+    }
+    if ((rc = pthread_mutex_init(&bstate.lock, NULL)) != 0 ||
+        (rc = pthread_condattr_init(&condAttr)) != 0 ||
+        (rc = pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC)) != 0 ||
+        (rc = pthread_cond_init(&bstate.work_cv, &condAttr)) != 0 ||
+        (rc = pthread_cond_init(&bstate.applied_cv, NULL)) != 0) {
+        slapi_log_err(SLAPI_LOG_ERR, "pw_bind_state_start",
+                      "Cannot initialize the bind state writer. error %d (%s)\n",
+                      rc, strerror(rc));
+        return -1;
+    }
+    pthread_condattr_destroy(&condAttr);
+    bstate.pending = bind_state_table_new();
+    bstate.held = bind_state_table_new();
+
+    if ((bstate.tid = PR_CreateThread(PR_USER_THREAD,
+                                      (VFP)bind_state_thread, NULL,
+                                      PR_PRIORITY_NORMAL, PR_GLOBAL_THREAD, PR_JOINABLE_THREAD,
+                                      SLAPD_DEFAULT_THREAD_STACKSIZE)) == NULL) {
+        slapi_log_err(SLAPI_LOG_ERR, "pw_bind_state_start",
+                      "PR_CreateThread failed. " SLAPI_COMPONENT_NAME_NSPR " error %d (%s)\n",
+                      PR_GetError(), slapd_pr_strerror(PR_GetError()));
+        return -1;
+    }
+    slapi_atomic_store_32(&(bstate.running), 1, __ATOMIC_RELEASE);
+
+    return 0;
+}
+
+/* Write what is pending and stop the bind-state thread, the backends must still be up */
+void
+pw_bind_state_stop(void)
+{
+    if (!slapi_atomic_load_32(&(bstate.running), __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    pthread_mutex_lock(&bstate.lock);
+    bstate.shutdown = 1;
+    pthread_cond_signal(&bstate.work_cv);
+    pthread_mutex_unlock(&bstate.lock);
+    (void)PR_JoinThread(bstate.tid);
+
+    slapi_atomic_store_32(&(bstate.running), 0, __ATOMIC_RELEASE);
+    PL_HashTableDestroy(bstate.pending);
+    bstate.pending = NULL;
+}
+
+void
+pw_bind_state_get_stats(int32_t *pending, uint64_t *queued, uint64_t *merged, uint64_t *written, uint64_t *batches)
+{
+    *pending = 0;
+    *queued = *merged = *written = *batches = 0;
+    if (!slapi_atomic_load_32(&(bstate.running), __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    pthread_mutex_lock(&bstate.lock);
+    *pending = bstate.npending;
+    *queued = bstate.queued;
+    *merged = bstate.merged;
+    *written = bstate.written;
+    *batches = bstate.batches;
+    pthread_mutex_unlock(&bstate.lock);
+}
+
 /* Handle the component ID for the password policy */
 
 static struct slapi_componentid *pw_componentid = NULL;
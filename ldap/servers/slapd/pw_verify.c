@@ -23,6 +23,8 @@
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
+#include <pk11pub.h>
+#include <sechash.h>
 #include "slap.h"
 #include "fe.h"
 #include <rust-nsslapd-private.h>
@@ -34,11 +36,11 @@ pw_verify_root_dn(const char *dn, const Slapi_Value *cred)
     int result = LDAP_OPERATIONS_ERROR;
     char *root_pw = config_get_rootpw();
     if (root_pw != NULL && slapi_dn_isroot(dn)) {
-        /* Now build a slapi value to give to slapi_pw_find_sv */
+        /* Now build a slapi value to give to slapi_pw_verify_sv */
         Slapi_Value root_dn_pw_bval;
         slapi_value_init_string(&root_dn_pw_bval, root_pw);
         Slapi_Value *root_dn_pw_vals[] = {&root_dn_pw_bval, NULL};
-        result = slapi_pw_find_sv(root_dn_pw_vals, cred);
+        result = slapi_pw_verify_sv(dn, root_dn_pw_vals, cred);
         value_done(&root_dn_pw_bval);
     }
     slapi_ch_free_string(&root_pw);
@@ -181,3 +183,508 @@ pw_validate_be_dn(Slapi_PBlock *pb, Slapi_Entry **referral)
 
     return SLAPI_BIND_SUCCESS;
 }
+
+/*
+ * Bind password verification pool and verified password cache
+ *
+ * The password storage schemes run their KDF (PBKDF2, yescrypt, crypt...)
+ * on the thread that calls them. For binds, slapi_pw_verify_sv() hands the
+ * comparison to a small pool of dedicated threads (nsslapd-pwverify-threads)
+ * so that a bind storm uses at most that many CPUs for hashing and the rest
+ * stay available to the other operations.
+ *
+ * Only the CPU use is bounded. The worker thread of the bind waits for the
+ * pool to verify the password (and the queue gets longer than the pool), so
+ * a bind storm still holds as many worker threads as before, each one for
+ * at least as long. The other operations are only kept from starving while
+ * some worker threads are not busy with binds.
+ *
+ * A successful verification can also be remembered for
+ * nsslapd-pwverify-cache-ttl seconds. The cache is keyed by the normalized
+ * DN and holds an HMAC-SHA256, under a per-process random secret, of the DN,
+ * the supplied password and the stored userPassword values. The clear text
+ * password is never kept, and a changed userPassword can never match an old
+ * record even if it races with the invalidation done by modify and delete.
+ */
+
+#define PW_VERIFY_MAC_LENGTH SHA256_LENGTH
+#define PW_VERIFY_MAC_BLOCK 64 /* SHA256 block size */
+
+typedef struct pw_verify_job
+{
+    Slapi_Value **vals;
+    const Slapi_Value *cred;
+    int result;
+    int done;
+    pthread_cond_t done_cv;
+    struct pw_verify_job *next;
+} pw_verify_job;
+
+typedef struct pw_verify_record
+{
+    char *ndn;
+    unsigned char mac[PW_VERIFY_MAC_LENGTH];
+    time_t expire;
+    struct pw_verify_record *hnext; /* hash bucket chain */
+    struct pw_verify_record *prev;  /* LRU list, most recent first */
+    struct pw_verify_record *next;
+} pw_verify_record;
+
+static struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t work_cv;
+    pw_verify_job *head;
+    pw_verify_job *tail;
+    int32_t queue_len;
+    int32_t nthreads;
+    PRThread **tids;
+    int32_t running;
+    int shutdown;
+    uint64_t verified;
+} pw_pool;
+
+static struct
+{
+    pthread_mutex_t lock;
+    unsigned char secret[PW_VERIFY_MAC_BLOCK];
+    pw_verify_record **buckets;
+    size_t nbuckets;
+    pw_verify_record *lru_head;
+    pw_verify_record *lru_tail;
+    int32_t count;
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    int32_t ready;
+} pw_cache;
+
+/*
+ * HMAC-SHA256 of the DN, the supplied password and the stored values.
+ * Returns 0 on success.
+ */
+static int
+pw_verify_mac(const char *ndn, Slapi_Value **vals, const Slapi_Value *cred, unsigned char *mac)
+{
+    unsigned char pad[PW_VERIFY_MAC_BLOCK];
+    unsigned char inner[PW_VERIFY_MAC_LENGTH];
+    unsigned int len = 0;
+    const struct berval *bv = NULL;
+    PK11Context *ctx = NULL;
+    int rc = -1;
+
+    if ((ctx = PK11_CreateDigestContext(SEC_OID_SHA256)) == NULL) {
+        return rc;
+    }
+
+    /* inner hash: H((K ^ ipad) || ndn || 0 || cred || 0 || vals...) */
+    for (size_t i = 0; i < sizeof(pad); i++) {
+        pad[i] = pw_cache.secret[i] ^ 0x36;
+    }
+    PK11_DigestBegin(ctx);
+    PK11_DigestOp(ctx, pad, sizeof(pad));
+    PK11_DigestOp(ctx, (const unsigned char *)ndn, strlen(ndn) + 1);
+    bv = slapi_value_get_berval(cred);
+    PK11_DigestOp(ctx, (const unsigned char *)bv->bv_val, bv->bv_len);
+    PK11_DigestOp(ctx, (const unsigned char *)"", 1);
+    for (size_t i = 0; vals && vals[i]; i++) {
+        bv = slapi_value_get_berval(vals[i]);
+        PK11_DigestOp(ctx, (const unsigned char *)bv->bv_val, bv->bv_len);
+        PK11_DigestOp(ctx, (const unsigned char *)"", 1);
+    }
+    if (PK11_DigestFinal(ctx, inner, &len, sizeof(inner)) != SECSuccess || len != sizeof(inner)) {
+        goto done;
+    }
+
+    /* outer hash: H((K ^ opad) || inner) */
+    for (size_t i = 0; i < sizeof(pad); i++) {
+        pad[i] = pw_cache.secret[i] ^ 0x5c;
+    }
+    PK11_DigestBegin(ctx);
+    PK11_DigestOp(ctx, pad, sizeof(pad));
+    PK11_DigestOp(ctx, inner, sizeof(inner));
+    if (PK11_DigestFinal(ctx, mac, &len, PW_VERIFY_MAC_LENGTH) == SECSuccess && len == PW_VERIFY_MAC_LENGTH) {
+        rc = 0;
+    }
+
+done:
+    memset(pad, 0, sizeof(pad));
+    memset(inner, 0, sizeof(inner));
+    PK11_DestroyContext(ctx, PR_TRUE);
+    return rc;
+}
+
+static size_t
+pw_verify_cache_bucket(const char *ndn)
+{
+    /* djb2, the DN is already normalized */
+    size_t h = 5381;
+
+    for (const unsigned char *p = (const unsigned char *)ndn; *p; p++) {
+        h = (h << 5) + h + *p;
+    }
+    return h & (pw_cache.nbuckets - 1);
+}
+
+/* The caller holds pw_cache.lock */
+static pw_verify_record *
+pw_verify_cache_find(const char *ndn, pw_verify_record ***prevp)
+{
+    pw_verify_record **pp = &pw_cache.buckets[pw_verify_cache_bucket(ndn)];
+
+    for (; *pp; pp = &(*pp)->hnext) {
+        if (strcmp((*pp)->ndn, ndn) == 0) {
+            break;
+        }
+    }
+    if (prevp) {
+        *prevp = pp;
+    }
+    return *pp;
+}
+
+/* The caller holds pw_cache.lock */
+static void
+pw_verify_lru_unlink(pw_verify_record *r)
+{
+    if (r->prev) {
+        r->prev->next = r->next;
+    } else {
+        pw_cache.lru_head = r->next;
+    }
+    if (r->next) {
+        r->next->prev = r->prev;
+    } else {
+        pw_cache.lru_tail = r->prev;
+    }
+    r->prev = r->next = NULL;
+}
+
+/* The caller holds pw_cache.lock */
+static void
+pw_verify_lru_push(pw_verify_record *r)
+{
+    r->prev = NULL;
+    r->next = pw_cache.lru_head;
+    if (pw_cache.lru_head) {
+        pw_cache.lru_head->prev = r;
+    } else {
+        pw_cache.lru_tail = r;
+    }
+    pw_cache.lru_head = r;
+}
+
+/* Unlink and free the record of ndn, the caller holds pw_cache.lock */
+static void
+pw_verify_cache_remove(const char *ndn)
+{
+    pw_verify_record **pp = NULL;
+    pw_verify_record *r = pw_verify_cache_find(ndn, &pp);
+
+    if (r == NULL) {
+        return;
+    }
+    *pp = r->hnext;
+    pw_verify_lru_unlink(r);
+    pw_cache.count--;
+    slapi_ch_free_string(&r->ndn);
+    slapi_ch_free((void **)&r);
+}
+
+/* Returns 1 if the password of ndn was verified less than ttl seconds ago */
+static int
+pw_verify_cache_lookup(const char *ndn, const unsigned char *mac)
+{
+    pw_verify_record *r = NULL;
+    int hit = 0;
+
+    pthread_mutex_lock(&pw_cache.lock);
+    r = pw_verify_cache_find(ndn, NULL);
+    if (r && r->expire < slapi_current_rel_time_t()) {
+        pw_verify_cache_remove(ndn);
+        r = NULL;
+    }
+    if (r && memcmp(r->mac, mac, PW_VERIFY_MAC_LENGTH) == 0) {
+        pw_verify_lru_unlink(r);
+        pw_verify_lru_push(r);
+        pw_cache.hits++;
+        hit = 1;
+    } else {
+        pw_cache.misses++;
+    }
+    pthread_mutex_unlock(&pw_cache.lock);
+
+    return hit;
+}
+
+static void
+pw_verify_cache_store(const char *ndn, const unsigned char *mac, int32_t ttl)
+{
+    int32_t maxsize = config_get_pwverify_cache_size();
+    pw_verify_record *r = NULL;
+
+    pthread_mutex_lock(&pw_cache.lock);
+    if ((r = pw_verify_cache_find(ndn, NULL)) != NULL) {
+        pw_verify_lru_unlink(r);
+    } else {
+        while (pw_cache.count >= maxsize && pw_cache.lru_tail) {
+            pw_verify_cache_remove(pw_cache.lru_tail->ndn);
+            pw_cache.evictions++;
+        }
+        r = (pw_verify_record *)slapi_ch_calloc(1, sizeof(pw_verify_record));
+        r->ndn = slapi_ch_strdup(ndn);
+        r->hnext = pw_cache.buckets[pw_verify_cache_bucket(ndn)];
+        pw_cache.buckets[pw_verify_cache_bucket(ndn)] = r;
+        pw_cache.count++;
+    }
+    memcpy(r->mac, mac, PW_VERIFY_MAC_LENGTH);
+    r->expire = slapi_current_rel_time_t() + ttl;
+    pw_verify_lru_push(r);
+    pthread_mutex_unlock(&pw_cache.lock);
+}
+
+/*
+ * Forget the verified password of sdn. Called when its userPassword is
+ * modified or the entry is deleted.
+ */
+void
+pw_verify_cache_invalidate(const Slapi_DN *sdn)
+{
+    const char *ndn = NULL;
+
+    if (!slapi_atomic_load_32(&(pw_cache.ready), __ATOMIC_ACQUIRE) ||
+        sdn == NULL || (ndn = slapi_sdn_get_ndn(sdn)) == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&pw_cache.lock);
+    pw_verify_cache_remove(ndn);
+    pthread_mutex_unlock(&pw_cache.lock);
+}
+
+static void
+pw_verify_thread(void *arg __attribute__((unused)))
+{
+    slapi_set_thread_name("pw-verify");
+
+    pthread_mutex_lock(&pw_pool.lock);
+    while (!pw_pool.shutdown || pw_pool.head) {
+        pw_verify_job *job = pw_pool.head;
+
+        if (job == NULL) {
+            pthread_cond_wait(&pw_pool.work_cv, &pw_pool.lock);
+            continue;
+        }
+        if ((pw_pool.head = job->next) == NULL) {
+            pw_pool.tail = NULL;
+        }
+        pw_pool.queue_len--;
+        pthread_mutex_unlock(&pw_pool.lock);
+
+        job->result = slapi_pw_find_sv(job->vals, job->cred);
+
+        pthread_mutex_lock(&pw_pool.lock);
+        pw_pool.verified++;
+        job->done = 1;
+        pthread_cond_signal(&job->done_cv);
+    }
+    pthread_mutex_unlock(&pw_pool.lock);
+}
+
+/*
+ * Compare cred with vals on a pool thread, or on this one if the pool is not
+ * running. The calling thread blocks until the comparison is done.
+ */
+static int
+pw_verify_pool_find_sv(Slapi_Value **vals, const Slapi_Value *cred)
+{
+    pw_verify_job job = {0};
+
+    if (!slapi_atomic_load_32(&(pw_pool.running), __ATOMIC_ACQUIRE)) {
+        return slapi_pw_find_sv(vals, cred);
+    }
+
+    job.vals = vals;
+    job.cred = cred;
+    pthread_cond_init(&job.done_cv, NULL);
+
+    pthread_mutex_lock(&pw_pool.lock);
+    if (pw_pool.shutdown) {
+        pthread_mutex_unlock(&pw_pool.lock);
+        pthread_cond_destroy(&job.done_cv);
+        return slapi_pw_find_sv(vals, cred);
+    }
+    if (pw_pool.tail) {
+        pw_pool.tail->next = &job;
+    } else {
+        pw_pool.head = &job;
+    }
+    pw_pool.tail = &job;
+    pw_pool.queue_len++;
+    pthread_cond_signal(&pw_pool.work_cv);
+    while (!job.done) {
+        pthread_cond_wait(&job.done_cv, &pw_pool.lock);
+    }
+    pthread_mutex_unlock(&pw_pool.lock);
+    pthread_cond_destroy(&job.done_cv);
+
+    return job.result;
+}
+
+/*
+ * Like slapi_pw_find_sv(), for the password of a bind on ndn: vals are the
+ * userPassword values of the entry and cred the supplied password.
+ * Returns 0 if the password matches, non-zero otherwise.
+ */
+int
+slapi_pw_verify_sv(const char *ndn, Slapi_Value **vals, const Slapi_Value *cred)
+{
+    unsigned char mac[PW_VERIFY_MAC_LENGTH];
+    int32_t ttl = config_get_pwverify_cache_ttl();
+    int use_cache = 0;
+    int rc;
+
+    if (ttl > 0 && ndn && slapi_atomic_load_32(&(pw_cache.ready), __ATOMIC_ACQUIRE)) {
+        use_cache = (pw_verify_mac(ndn, vals, cred, mac) == 0);
+        if (use_cache && pw_verify_cache_lookup(ndn, mac)) {
+            return 0;
+        }
+    }
+
+    rc = pw_verify_pool_find_sv(vals, cred);
+
+    /* Only the successful verifications are remembered */
+    if (rc == 0 && use_cache) {
+        pw_verify_cache_store(ndn, mac, ttl);
+    }
+    memset(mac, 0, sizeof(mac));
+    return rc;
+}
+
+/*
+ * Set up the verified password cache and start the verification threads.
+ * With nsslapd-pwverify-threads set to 0 the passwords are verified by
+ * the worker threads themselves.
+ */
+int
+pw_verify_start(void)
+{
+    int32_t nthreads = config_get_pwverify_threads();
+    int32_t size = config_get_pwverify_cache_size();
+    int rc = 0;
+
+    if (pw_cache.ready || pw_pool.tids) {
+        return 0;
+    }
+
+    if ((rc = pthread_mutex_init(&pw_cache.lock, NULL)) != 0) {
+        slapi_log_err(SLAPI_LOG_ERR, "pw_verify_start",
+                      "Cannot initialize the verified password cache. error %d (%s)\n",
+                      rc, strerror(rc));
+        return -1;
+    }
+    if (PK11_GenerateRandom(pw_cache.secret, sizeof(pw_cache.secret)) != SECSuccess) {
+        slapi_log_err(SLAPI_LOG_ERR, "pw_verify_start",
+                      "Cannot generate the verified password cache secret, the cache is disabled. "
+                      SLAPI_COMPONENT_NAME_NSPR " error %d (%s)\n",
+                      PR_GetError(), slapd_pr_strerror(PR_GetError()));
+    } else {
+        /* Twice the cache size, rounded up to a power of 2 */
+        for (pw_cache.nbuckets = 16; pw_cache.nbuckets < (size_t)size * 2; pw_cache.nbuckets <<= 1)
+            ;
+        pw_cache.buckets = (pw_verify_record **)slapi_ch_calloc(pw_cache.nbuckets, sizeof(pw_verify_record *));
+        slapi_atomic_store_32(&(pw_cache.ready), 1, __ATOMIC_RELEASE);
+    }
+
+    if (nthreads < 0) {
+        /* Leave at least half of the CPUs to the other operations */
+        nthreads = (int32_t)util_get_capped_hardware_threads(2, 128) / 2;
+    }
+    if (nthreads == 0) {
+        return 0;
+    }
+
+    if ((rc = pthread_mutex_init(&pw_pool.lock, NULL)) != 0 ||
+        (rc = pthread_cond_init(&pw_pool.work_cv, NULL)) != 0) {
+        slapi_log_err(SLAPI_LOG_ERR, "pw_verify_start",
+                      "Cannot initialize the password verification threads. error %d (%s)\n",
+                      rc, strerror(rc));
+        return -1;
+    }
+    pw_pool.tids = (PRThread **)slapi_ch_calloc(nthreads, sizeof(PRThread *));
+    for (int32_t i = 0; i < nthreads; i++) {
+        if ((pw_pool.tids[i] = PR_CreateThread(PR_USER_THREAD,
+                                               (VFP)pw_verify_thread, NULL,
+                                               PR_PRIORITY_NORMAL, PR_GLOBAL_THREAD, PR_JOINABLE_THREAD,
+                                               SLAPD_DEFAULT_THREAD_STACKSIZE)) == NULL) {
+            slapi_log_err(SLAPI_LOG_ERR, "pw_verify_start",
+                          "PR_CreateThread failed. " SLAPI_COMPONENT_NAME_NSPR " error %d (%s)\n",
+                          PR_GetError(), slapd_pr_strerror(PR_GetError()));
+            break;
+        }
+        pw_pool.nthreads++;
+    }
+    if (pw_pool.nthreads > 0) {
+        slapi_atomic_store_32(&(pw_pool.running), 1, __ATOMIC_RELEASE);
+    }
+    slapi_log_err(SLAPI_LOG_INFO, "pw_verify_start",
+                  "Started %d password verification threads\n", pw_pool.nthreads);
+
+    return pw_pool.nthreads == nthreads ? 0 : -1;
+}
+
+/* Finish the queued verifications and stop the verification threads */
+void
+pw_verify_stop(void)
+{
+    pw_verify_record *r = NULL;
+
+    if (pw_pool.tids) {
+        slapi_atomic_store_32(&(pw_pool.running), 0, __ATOMIC_RELEASE);
+        pthread_mutex_lock(&pw_pool.lock);
+        pw_pool.shutdown = 1;
+        pthread_cond_broadcast(&pw_pool.work_cv);
+        pthread_mutex_unlock(&pw_pool.lock);
+        for (int32_t i = 0; i < pw_pool.nthreads; i++) {
+            (void)PR_JoinThread(pw_pool.tids[i]);
+        }
+        slapi_ch_free((void **)&pw_pool.tids);
+    }
+
+    if (slapi_atomic_load_32(&(pw_cache.ready), __ATOMIC_ACQUIRE)) {
+        slapi_atomic_store_32(&(pw_cache.ready), 0, __ATOMIC_RELEASE);
+        pthread_mutex_lock(&pw_cache.lock);
+        while ((r = pw_cache.lru_head) != NULL) {
+            pw_verify_cache_remove(r->ndn);
+        }
+        memset(pw_cache.secret, 0, sizeof(pw_cache.secret));
+        slapi_ch_free((void **)&pw_cache.buckets);
+        pthread_mutex_unlock(&pw_cache.lock);
+    }
+}
+
+void
+pw_verify_get_stats(int32_t *threads, int32_t *queue_depth, uint64_t *verified,
+                    int32_t *cache_entries, uint64_t *cache_hits, uint64_t *cache_misses,
+                    uint64_t *cache_evictions)
+{
+    *threads = slapi_atomic_load_32(&(pw_pool.running), __ATOMIC_ACQUIRE) ? pw_pool.nthreads : 0;
+    *queue_depth = 0;
+    *verified = 0;
+    if (*threads) {
+        pthread_mutex_lock(&pw_pool.lock);
+        *queue_depth = pw_pool.queue_len;
+        *verified = pw_pool.verified;
+        pthread_mutex_unlock(&pw_pool.lock);
+    }
+
+    *cache_entries = 0;
+    *cache_hits = *cache_misses = *cache_evictions = 0;
+    if (slapi_atomic_load_32(&(pw_cache.ready), __ATOMIC_ACQUIRE)) {
+        pthread_mutex_lock(&pw_cache.lock);
+        *cache_entries = pw_cache.count;
+        *cache_hits = pw_cache.hits;
+        *cache_misses = pw_cache.misses;
+        *cache_evictions = pw_cache.evictions;
+        pthread_mutex_unlock(&pw_cache.lock);
+    }
+}
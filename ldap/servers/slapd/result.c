@@ -32,6 +32,10 @@
 static long current_conn_count;
 static PRLock *current_conn_count_mutex;
 static int flush_ber(Slapi_PBlock *pb, Connection *conn, Operation *op, BerElement *ber, int type);
+static int flush_ber_write(Connection *conn, Operation *op, BerElement *ber, int32_t nentries);
+static int result_batch_append(Connection *conn, Operation *op, BerElement *ber);
+static int result_batch_write(Connection *conn, Operation *op);
+static void result_batch_drop(Operation *op);
 static char *notes2str(unsigned int notes, char *buf, size_t buflen);
 static void log_op_stat(Slapi_PBlock *pb, uint64_t connid, int32_t op_id, int32_t op_internal_id, int32_t op_nested_count, time_t start_time);
 static void log_result(Slapi_PBlock *pb, Operation *op, int err, ber_tag_t tag, int nentries);
@@ -1894,7 +1898,6 @@ flush_ber(
     BerElement *ber,
     int type)
 {
-    ber_len_t bytes;
     int rc = 0;
 
     switch (type) {
@@ -1917,50 +1920,19 @@ flush_ber(
         slapi_log_err(SLAPI_LOG_CONNS, "flush_ber",
                       "Skipped because the connection was marked to be closed or abandoned\n");
         ber_free(ber, 1);
+        /* the client will not read the pending entries either */
+        result_batch_drop(op);
         /* One of the failure can be because the client has reset the connection ( closed )
              * and the status needs to be updated to reflect it */
         op->o_status = SLAPI_OP_STATUS_ABANDONED;
         rc = -1;
+    } else if (type == _LDAP_SEND_ENTRY && op->o_batch) {
+        rc = result_batch_append(conn, op, ber);
+    } else if ((rc = result_batch_write(conn, op)) != 0) {
+        /* the pending entries must not be overtaken */
+        ber_free(ber, 1);
     } else {
-        ber_get_option(ber, LBER_OPT_BYTES_TO_WRITE, &bytes);
-
-        fgot_start(op, FGOT_WRITE);
-        PR_Lock(conn->c_pdumutex);
-        rc = ber_flush(conn->c_sb, ber, 1);
-        PR_Unlock(conn->c_pdumutex);
-        fgot_end(op, FGOT_WRITE);
-
-        if (rc != 0) {
-            int oserr = errno;
-            /* One of the failure can be because the client has reset the connection ( closed )
-             * and the status needs to be updated to reflect it */
-            op->o_status = SLAPI_OP_STATUS_ABANDONED;
-
-            slapi_log_err(SLAPI_LOG_CONNS, "flush_ber", "Failed, error %d (%s)\n",
-                          oserr, slapd_system_strerror(oserr));
-            if (op->o_flags & OP_FLAG_PS) {
-                /* We need to tell disconnect_server() not to ding
-            * all the psearches if one if them disconnected
-            * But we do need to terminate all persistent searches that are using
-            * this connection
-            *    op->o_flags |= OP_FLAG_PS_SEND_FAILED;
-            */
-            }
-            do_disconnect_server(conn, op->o_connid, op->o_opid);
-            ber_free(ber, 1);
-        } else {
-            PRUint64 b;
-            slapi_log_err(SLAPI_LOG_BER, "flush_ber",
-                          "Wrote %lu bytes to socket %d\n", bytes, conn->c_sd);
-            LL_I2L(b, bytes);
-            slapi_counter_add(g_get_per_thread_snmp_vars()->server_tbl.dsBytesSent, b);
-
-            if (type == _LDAP_SEND_ENTRY) {
-                slapi_counter_increment(g_get_per_thread_snmp_vars()->server_tbl.dsEntriesSent);
-            }
-            if (!config_check_referral_mode())
-                slapi_counter_add(g_get_per_thread_snmp_vars()->ops_tbl.dsBytesSent, bytes);
-        }
+        rc = flush_ber_write(conn, op, ber, type == _LDAP_SEND_ENTRY ? 1 : 0);
     }
 
     switch (type) {
@@ -1982,6 +1954,400 @@ flush_ber(
     return (rc);
 }
 
+/*
+ * Writes one (or a batch of) encoded PDU(s) to the connection.
+ * nentries is the number of search result entries in ber, for the
+ * snmp counters. Always frees the ber.
+ */
+static int
+flush_ber_write(Connection *conn, Operation *op, BerElement *ber, int32_t nentries)
+{
+    ber_len_t bytes;
+    int rc;
+
+    ber_get_option(ber, LBER_OPT_BYTES_TO_WRITE, &bytes);
+
+    fgot_start(op, FGOT_WRITE);
+    PR_Lock(conn->c_pdumutex);
+    rc = ber_flush(conn->c_sb, ber, 1);
+    PR_Unlock(conn->c_pdumutex);
+    fgot_end(op, FGOT_WRITE);
+
+    if (rc != 0) {
+        int oserr = errno;
+        /* One of the failure can be because the client has reset the connection ( closed )
+         * and the status needs to be updated to reflect it */
+        op->o_status = SLAPI_OP_STATUS_ABANDONED;
+
+        slapi_log_err(SLAPI_LOG_CONNS, "flush_ber", "Failed, error %d (%s)\n",
+                      oserr, slapd_system_strerror(oserr));
+        if (op->o_flags & OP_FLAG_PS) {
+            /* We need to tell disconnect_server() not to ding
+             * all the psearches if one if them disconnected
+             * But we do need to terminate all persistent searches that are using
+             * this connection
+             *    op->o_flags |= OP_FLAG_PS_SEND_FAILED;
+             */
+        }
+        do_disconnect_server(conn, op->o_connid, op->o_opid);
+        ber_free(ber, 1);
+    } else {
+        PRUint64 b;
+        slapi_log_err(SLAPI_LOG_BER, "flush_ber",
+                      "Wrote %lu bytes to socket %d\n", bytes, conn->c_sd);
+        LL_I2L(b, bytes);
+        slapi_counter_add(g_get_per_thread_snmp_vars()->server_tbl.dsBytesSent, b);
+
+        if (nentries > 0) {
+            slapi_counter_add(g_get_per_thread_snmp_vars()->server_tbl.dsEntriesSent, nentries);
+        }
+        if (!config_check_referral_mode())
+            slapi_counter_add(g_get_per_thread_snmp_vars()->ops_tbl.dsBytesSent, bytes);
+    }
+    return rc;
+}
+
+/*
+ * Search result batching
+ *
+ * While the front end iterates over the backend candidates, the encoded
+ * SearchResultEntry PDUs are appended to a per operation buffer and
+ * written with one ber_flush (one write through the connection I/O
+ * layers, TLS included) once nsslapd-result-batch-size bytes or
+ * nsslapd-result-batch-entries entries are pending. Any other PDU of the
+ * operation writes the pending entries first. The changes of a persistent
+ * search are only batched by its ps thread, for the changes which are
+ * already queued (ps_drain), so that a change is never held back.
+ *
+ * So that a search finding its entries slowly does not hold them back,
+ * the result-flush thread also writes a batch once its oldest entry has
+ * waited nsslapd-result-batch-delay milliseconds. b->lock serializes the
+ * operation thread and the result-flush thread on a batch, and
+ * result_batches_lock protects the list of the active batches.
+ */
+struct result_batch
+{
+    pthread_mutex_t lock;
+    BerElement *ber;            /* pending entries, NULL once dropped */
+    int32_t entries;            /* number of entries in ber */
+    int32_t max_entries;        /* write ber when it holds that many entries */
+    int32_t max_bytes;          /* or that many bytes */
+    struct timespec first;      /* when the oldest pending entry was added */
+    int32_t busy;               /* the result-flush thread is looking at it */
+    int32_t linked;             /* in result_batches */
+    Connection *conn;
+    Operation *op;
+    struct result_batch *prev;
+    struct result_batch *next;
+};
+
+static pthread_mutex_t result_batches_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t result_batches_cv;
+static struct result_batch *result_batches = NULL;
+static PRThread *result_flush_tid = NULL;
+static int32_t result_flush_shutdown = 0;
+
+void
+result_batch_begin(Slapi_PBlock *pb, PRBool ps_drain)
+{
+    Connection *conn = NULL;
+    Operation *op = NULL;
+    struct result_batch *b = NULL;
+    int32_t max_bytes;
+    int32_t max_entries;
+
+    slapi_pblock_get(pb, SLAPI_CONNECTION, &conn);
+    slapi_pblock_get(pb, SLAPI_OPERATION, &op);
+    if (conn == NULL || op == NULL || op->o_batch != NULL ||
+        operation_is_flag_set(op, OP_FLAG_INTERNAL) ||
+        (operation_is_flag_set(op, OP_FLAG_PS) && !ps_drain)) {
+        return;
+    }
+
+    max_bytes = config_get_result_batch_size();
+    max_entries = config_get_result_batch_entries();
+    if (max_bytes <= 0 || max_entries <= 1) {
+        /* batching is disabled */
+        return;
+    }
+    b = (struct result_batch *)slapi_ch_calloc(1, sizeof(struct result_batch));
+    pthread_mutex_init(&b->lock, NULL);
+    b->ber = ber_alloc_t(LBER_USE_DER);
+    b->max_bytes = max_bytes;
+    b->max_entries = max_entries;
+    b->conn = conn;
+    b->op = op;
+    op->o_batch = b;
+
+    pthread_mutex_lock(&result_batches_lock);
+    if (result_flush_tid && !result_flush_shutdown) {
+        b->next = result_batches;
+        if (result_batches) {
+            result_batches->prev = b;
+        }
+        result_batches = b;
+        b->linked = 1;
+        pthread_cond_signal(&result_batches_cv);
+    }
+    pthread_mutex_unlock(&result_batches_lock);
+}
+
+/*
+ * Unlink the batch of the operation and free it, without writing the
+ * pending entries.
+ */
+void
+result_batch_release(Operation *op)
+{
+    struct result_batch *b = op->o_batch;
+
+    if (b == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&result_batches_lock);
+    while (b->busy) {
+        pthread_cond_wait(&result_batches_cv, &result_batches_lock);
+    }
+    if (b->linked) {
+        if (b->prev) {
+            b->prev->next = b->next;
+        } else {
+            result_batches = b->next;
+        }
+        if (b->next) {
+            b->next->prev = b->prev;
+        }
+    }
+    pthread_mutex_unlock(&result_batches_lock);
+
+    op->o_batch = NULL;
+    if (b->ber) {
+        ber_free(b->ber, 1);
+    }
+    pthread_mutex_destroy(&b->lock);
+    slapi_ch_free((void **)&b);
+}
+
+/*
+ * Writes the pending entries and stops batching
+ */
+void
+result_batch_end(Slapi_PBlock *pb)
+{
+    Connection *conn = NULL;
+    Operation *op = NULL;
+
+    slapi_pblock_get(pb, SLAPI_CONNECTION, &conn);
+    slapi_pblock_get(pb, SLAPI_OPERATION, &op);
+    if (op == NULL || op->o_batch == NULL) {
+        return;
+    }
+    if (conn && !(conn->c_flags & CONN_FLAG_CLOSING) && !slapi_op_abandoned(pb)) {
+        result_batch_write(conn, op);
+    }
+    result_batch_release(op);
+}
+
+/*
+ * Writes the pending entries of the batch, b->lock is held. On failure the
+ * batch is dropped, and the following PDUs of the operation are written one
+ * by one.
+ */
+static int
+result_batch_write_nolock(struct result_batch *b)
+{
+    BerElement *ber = b->ber;
+    int32_t nentries = b->entries;
+    int rc;
+
+    if (ber == NULL || nentries == 0) {
+        return 0;
+    }
+
+    b->ber = NULL;
+    b->entries = 0;
+    rc = flush_ber_write(b->conn, b->op, ber, nentries);
+    if (rc == 0) {
+        b->ber = ber_alloc_t(LBER_USE_DER);
+    }
+    return rc;
+}
+
+/*
+ * Writes the pending entries, if any.
+ */
+static int
+result_batch_write(Connection *conn __attribute__((unused)), Operation *op)
+{
+    struct result_batch *b = op->o_batch;
+    int rc;
+
+    if (b == NULL) {
+        return 0;
+    }
+    pthread_mutex_lock(&b->lock);
+    rc = result_batch_write_nolock(b);
+    pthread_mutex_unlock(&b->lock);
+    return rc;
+}
+
+/*
+ * The client will not read the pending entries: drop them.
+ */
+static void
+result_batch_drop(Operation *op)
+{
+    struct result_batch *b = op->o_batch;
+
+    if (b == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&b->lock);
+    if (b->ber) {
+        ber_free(b->ber, 1);
+        b->ber = NULL;
+    }
+    b->entries = 0;
+    pthread_mutex_unlock(&b->lock);
+}
+
+/*
+ * Appends an encoded entry to the operation batch, and writes the
+ * batch once a threshold is reached. Always frees the ber.
+ */
+static int
+result_batch_append(Connection *conn, Operation *op, BerElement *ber)
+{
+    struct result_batch *b = op->o_batch;
+    struct berval bv = {0};
+    ber_len_t pending = 0;
+    int rc = 0;
+
+    pthread_mutex_lock(&b->lock);
+    if (b->ber == NULL) {
+        /* the batch was dropped */
+        pthread_mutex_unlock(&b->lock);
+        return flush_ber_write(conn, op, ber, 1);
+    }
+    if (ber_flatten2(ber, &bv, 0) != 0 ||
+        ber_write(b->ber, bv.bv_val, bv.bv_len, 0) != (ber_slen_t)bv.bv_len) {
+        /* could not buffer it, keep the PDU order and write it now */
+        if ((rc = result_batch_write_nolock(b)) != 0) {
+            ber_free(ber, 1);
+        } else {
+            rc = flush_ber_write(conn, op, ber, 1);
+        }
+        pthread_mutex_unlock(&b->lock);
+        return rc;
+    }
+    ber_free(ber, 1);
+    if (b->entries++ == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &b->first);
+    }
+
+    ber_get_option(b->ber, LBER_OPT_BYTES_TO_WRITE, &pending);
+    if (pending >= (ber_len_t)b->max_bytes || b->entries >= b->max_entries) {
+        rc = result_batch_write_nolock(b);
+    }
+    pthread_mutex_unlock(&b->lock);
+    return rc;
+}
+
+/*
+ * Writes the batches whose oldest entry waited longer than
+ * nsslapd-result-batch-delay. result_batches_lock is only dropped while a
+ * batch is being written, and the batch is marked busy meanwhile so that
+ * result_batch_release() waits for it.
+ */
+static void
+result_flush_thread(void *arg __attribute__((unused)))
+{
+    slapi_set_thread_name("result-flush");
+
+    pthread_mutex_lock(&result_batches_lock);
+    while (!result_flush_shutdown) {
+        int64_t delay_ms = config_get_result_batch_delay();
+        int64_t next_ms = delay_ms;
+        struct timespec now = {0};
+        struct timespec deadline = {0};
+
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        for (struct result_batch *b = result_batches; b; b = b->next) {
+            b->busy = 1;
+            pthread_mutex_unlock(&result_batches_lock);
+
+            pthread_mutex_lock(&b->lock);
+            if (b->entries > 0) {
+                int64_t waited_ms = (now.tv_sec - b->first.tv_sec) * 1000 +
+                                    (now.tv_nsec - b->first.tv_nsec) / 1000000;
+                if (waited_ms >= delay_ms) {
+                    if (!(b->conn->c_flags & CONN_FLAG_CLOSING)) {
+                        result_batch_write_nolock(b);
+                    }
+                } else if (delay_ms - waited_ms < next_ms) {
+                    next_ms = delay_ms - waited_ms;
+                }
+            }
+            pthread_mutex_unlock(&b->lock);
+
+            pthread_mutex_lock(&result_batches_lock);
+            b->busy = 0;
+        }
+        /* wake up result_batch_release() if it waits for one of them */
+        pthread_cond_broadcast(&result_batches_cv);
+
+        if (result_batches == NULL) {
+            pthread_cond_wait(&result_batches_cv, &result_batches_lock);
+            continue;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += next_ms / 1000;
+        deadline.tv_nsec += (next_ms % 1000) * 1000000;
+        if (deadline.tv_nsec >= 1000000000) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000;
+        }
+        pthread_cond_timedwait(&result_batches_cv, &result_batches_lock, &deadline);
+    }
+    pthread_mutex_unlock(&result_batches_lock);
+}
+
+int
+result_flush_start(void)
+{
+    pthread_condattr_t condAttr;
+
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&result_batches_cv, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+
+    if ((result_flush_tid = PR_CreateThread(PR_USER_THREAD,
+                                            (VFP)result_flush_thread, NULL,
+                                            PR_PRIORITY_NORMAL, PR_GLOBAL_THREAD, PR_JOINABLE_THREAD,
+                                            SLAPD_DEFAULT_THREAD_STACKSIZE)) == NULL) {
+        slapi_log_err(SLAPI_LOG_ERR, "result_flush_start",
+                      "PR_CreateThread failed. " SLAPI_COMPONENT_NAME_NSPR " error %d (%s)\n",
+                      PR_GetError(), slapd_pr_strerror(PR_GetError()));
+        return -1;
+    }
+    return 0;
+}
+
+void
+result_flush_stop(void)
+{
+    if (result_flush_tid == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&result_batches_lock);
+    result_flush_shutdown = 1;
+    pthread_cond_broadcast(&result_batches_cv);
+    pthread_mutex_unlock(&result_batches_lock);
+    (void)PR_JoinThread(result_flush_tid);
+    result_flush_tid = NULL;
+}
+
 /*
     Puts the default result handlers into the pblock.
     This routine is called before any server call to a
@@ -2188,6 +2554,39 @@ log_op_stat(Slapi_PBlock *pb, uint64_t connid, int32_t op_id, int32_t op_interna
                 for (key_info = op_stat->search_stat->keys_lookup; key_info; key_info = key_info->next) {
                     slapi_timespec_diff(&key_info->key_lookup_end, &key_info->key_lookup_start, &duration);
                     snprintf(stat_etime, ETIME_BUFSIZ, "%" PRId64 ".%.09" PRId64 "", (int64_t)duration.tv_sec, (int64_t)duration.tv_nsec);
+                    if (key_info->filter) {
+                        /* The filter planner estimate of an AND component, and what it did with it */
+                        char plan_result[32];
+
+                        if (key_info->skipped) {
+                            snprintf(plan_result, sizeof(plan_result), "skipped");
+                        } else {
+                            snprintf(plan_result, sizeof(plan_result), "count %d", key_info->id_lookup_cnt);
+                        }
+                        if (log_format != LOG_FORMAT_DEFAULT) {
+                            /* JSON logging */
+                            logpb.op_internal_id = internal_op ? op_internal_id : -1;
+                            logpb.op_nested_count = internal_op ? op_nested_count : -1;
+                            logpb.stat_filter = key_info->filter;
+                            logpb.stat_estimate = key_info->estimate;
+                            logpb.stat_skipped = key_info->skipped ? PR_TRUE : PR_FALSE;
+                            logpb.stat_count = key_info->id_lookup_cnt;
+                            slapd_log_access_stat(&logpb);
+                            logpb.stat_filter = NULL;
+                        } else if (internal_op) {
+                            slapi_log_stat(LDAP_STAT_READ_INDEX,
+                                           connid == 0 ? STAT_LOG_CONN_OP_FMT_INT_INT "STAT plan: filter=%s --> estimate %" PRId64 ", %s (duration %s)\n":
+                                                         STAT_LOG_CONN_OP_FMT_EXT_INT "STAT plan: filter=%s --> estimate %" PRId64 ", %s (duration %s)\n",
+                                           connid, op_id, op_internal_id, op_nested_count,
+                                           key_info->filter, key_info->estimate, plan_result, stat_etime);
+                        } else {
+                            slapi_log_stat(LDAP_STAT_READ_INDEX,
+                                           "conn=%" PRIu64 " op=%d STAT plan: filter=%s --> estimate %" PRId64 ", %s (duration %s)\n",
+                                           connid, op_id,
+                                           key_info->filter, key_info->estimate, plan_result, stat_etime);
+                        }
+                        continue;
+                    }
                     if (internal_op) {
                         if (log_format != LOG_FORMAT_DEFAULT) {
                             /* JSON logging */
@@ -306,6 +306,24 @@ typedef void (*VFPV)(); /* takes undefined arguments */
 #define SLAPD_DEFAULT_MAXSIMPLEPAGED_PER_CONN_STR "-1"
 #define SLAPD_DEFAULT_MAXCONTROLS_PER_OP 10
 #define SLAPD_DEFAULT_MAXCONTROLS_PER_OP_STR "10"
+#define SLAPD_DEFAULT_RESULT_BATCH_SIZE 65536
+#define SLAPD_DEFAULT_RESULT_BATCH_SIZE_STR "65536"
+#define SLAPD_DEFAULT_RESULT_BATCH_ENTRIES 256
+#define SLAPD_DEFAULT_RESULT_BATCH_ENTRIES_STR "256"
+#define SLAPD_DEFAULT_RESULT_BATCH_DELAY 50
+#define SLAPD_DEFAULT_RESULT_BATCH_DELAY_STR "50"
+#define SLAPD_DEFAULT_PWVERIFY_THREADS -1
+#define SLAPD_DEFAULT_PWVERIFY_THREADS_STR "-1"
+#define SLAPD_DEFAULT_PWVERIFY_CACHE_TTL 0
+#define SLAPD_DEFAULT_PWVERIFY_CACHE_TTL_STR "0"
+#define SLAPD_DEFAULT_PWVERIFY_CACHE_SIZE 4096
+#define SLAPD_DEFAULT_PWVERIFY_CACHE_SIZE_STR "4096"
+#define SLAPD_DEFAULT_BIND_STATE_WRITE_WINDOW 0
+#define SLAPD_DEFAULT_BIND_STATE_WRITE_WINDOW_STR "0"
+#define SLAPD_DEFAULT_BIND_STATE_WRITE_BATCH 64
+#define SLAPD_DEFAULT_BIND_STATE_WRITE_BATCH_STR "64"
+#define SLAPD_DEFAULT_DSE_JOURNAL_DELAY 0
+#define SLAPD_DEFAULT_DSE_JOURNAL_DELAY_STR "0"
 #define SLAPD_DEFAULT_LDAPSSOTOKEN_TTL 3600
 #define SLAPD_DEFAULT_LDAPSSOTOKEN_TTL_STR "3600"
 
@@ -353,6 +371,9 @@ typedef void (*VFPV)(); /* takes undefined arguments */
 #define LOG_FORMAT_DEFAULT 1
 #define LOG_FORMAT_JSON 0
 #define LOG_FORMAT_JSON_PRETTY JSON_C_TO_STRING_PRETTY
+#define SLAPD_INIT_ACCESSLOG_ASYNC_OVERFLOW  "block"
+#define LOG_ASYNC_OVERFLOW_BLOCK 0
+#define LOG_ASYNC_OVERFLOW_DROP 1
 
 #define SLAPD_DEFAULT_LOG_ROTATIONSYNCHOUR 0
 #define SLAPD_DEFAULT_LOG_ROTATIONSYNCHOUR_STR "0"
@@ -498,6 +519,7 @@ typedef void (*VFPV)(); /* takes undefined arguments */
 #define DSE_TMPFILE "dse.ldif.tmp"
 #define DSE_BACKFILE "dse.ldif.bak"
 #define DSE_STARTOKFILE "dse.ldif.startOK"
+#define DSE_JOURNALFILE "dse.ldif.journal"
 #define DSE_LDBM_FILENAME "ldbm.ldif"
 #define DSE_LDBM_TMPFILE "ldbm.ldif.tmp"
 /* for now, we are using the dse file for the base config file */
@@ -1658,6 +1680,7 @@ typedef struct op
     int32_t o_wmax;
     int32_t o_wqdepth;
     fgot_t o_fgots[FGOT_MAX];                        /* Fine grain operation timing counters */
+    struct result_batch *o_batch;                    /* search result entries not written yet, see result_batch_begin() */
 } Operation;
 
 /*
@@ -1961,10 +1984,21 @@ void *slapi_pblock_get_op_stack_elem(Slapi_PBlock *pb);
 void slapi_pblock_set_op_stack_elem(Slapi_PBlock *pb, void *stack_elem);
 
 /* index if substrlens */
-#define INDEX_SUBSTRBEGIN  0
-#define INDEX_SUBSTRMIDDLE 1
-#define INDEX_SUBSTREND    2
-#define INDEX_SUBSTRLEN    3 /* size of the substrlens */
+#define INDEX_SUBSTRBEGIN     0
+#define INDEX_SUBSTRMIDDLE    1
+#define INDEX_SUBSTREND       2
+#define INDEX_SUBSTRPOSITIONS 3 /* nsSubStrPositions, 0 if the keys carry no offset */
+#define INDEX_SUBSTRLEN       4 /* size of the substrlens */
+
+/*
+ * With nsSubStrPositions: N the middle substring keys of a value carry the
+ * offset of their gram in the value modulo N, as "abc#2" (hex digit). The
+ * assertion keys of a component whose offset in the value is not known
+ * carry the offset of the gram in the component instead, as "abc#+1".
+ */
+#define INDEX_SUBSTRPOS_SEP '#'
+#define INDEX_SUBSTRPOS_REL '+'
+#define INDEX_SUBSTRPOS_MAX 16
 
 /* The referral element */
 typedef struct ref
@@ -2361,6 +2395,8 @@ typedef struct _slapdEntryPoints
 #define CONFIG_PW_ADMIN_SKIP_INFO_ATTRIBUTE "passwordAdminSkipInfoUpdate"
 #define CONFIG_PW_SEND_EXPIRING "passwordSendExpiringTime"
 #define CONFIG_ACCESSLOG_BUFFERING_ATTRIBUTE "nsslapd-accesslog-logbuffering"
+#define CONFIG_ACCESSLOG_ASYNC_WRITER_ATTRIBUTE "nsslapd-accesslog-async-writer"
+#define CONFIG_ACCESSLOG_ASYNC_OVERFLOW_ATTRIBUTE "nsslapd-accesslog-async-overflow"
 #define CONFIG_SECURITYLOG_BUFFERING_ATTRIBUTE "nsslapd-securitylog-logbuffering"
 #define CONFIG_AUDITLOG_BUFFERING_ATTRIBUTE "nsslapd-auditlog-logbuffering"
 #define CONFIG_ERRORLOG_BUFFERING_ATTRIBUTE "nsslapd-errorlog-logbuffering"
@@ -2421,6 +2457,7 @@ typedef struct _slapdEntryPoints
 #define CONFIG_SASL_MAXBUFSIZE "nsslapd-sasl-max-buffer-size"
 #define CONFIG_SEARCH_RETURN_ORIGINAL_TYPE "nsslapd-search-return-original-type-switch"
 #define CONFIG_ENABLE_TURBO_MODE "nsslapd-enable-turbo-mode"
+#define CONFIG_WORKQUEUE_SHARDING "nsslapd-workqueue-sharding"
 #define CONFIG_CONNECTION_BUFFER "nsslapd-connection-buffer"
 #define CONFIG_CONNECTION_NOCANON "nsslapd-connection-nocanon"
 #define CONFIG_PLUGIN_LOGGING "nsslapd-plugin-logging"
@@ -2438,6 +2475,15 @@ typedef struct _slapdEntryPoints
 
 #define CONFIG_MAXSIMPLEPAGED_PER_CONN_ATTRIBUTE "nsslapd-maxsimplepaged-per-conn"
 #define CONFIG_MAXCONTROLS_PER_OP_ATTRIBUTE "nsslapd-maxcontrolsperop"
+#define CONFIG_RESULT_BATCH_SIZE_ATTRIBUTE "nsslapd-result-batch-size"
+#define CONFIG_RESULT_BATCH_ENTRIES_ATTRIBUTE "nsslapd-result-batch-entries"
+#define CONFIG_RESULT_BATCH_DELAY_ATTRIBUTE "nsslapd-result-batch-delay"
+#define CONFIG_PWVERIFY_THREADS_ATTRIBUTE "nsslapd-pwverify-threads"
+#define CONFIG_PWVERIFY_CACHE_TTL_ATTRIBUTE "nsslapd-pwverify-cache-ttl"
+#define CONFIG_PWVERIFY_CACHE_SIZE_ATTRIBUTE "nsslapd-pwverify-cache-size"
+#define CONFIG_BIND_STATE_WRITE_WINDOW_ATTRIBUTE "nsslapd-bind-state-write-window"
+#define CONFIG_BIND_STATE_WRITE_BATCH_ATTRIBUTE "nsslapd-bind-state-write-batch"
+#define CONFIG_DSE_JOURNAL_DELAY_ATTRIBUTE "nsslapd-dse-journal-delay"
 #define CONFIG_LOGGING_BACKEND "nsslapd-logging-backend"
 
 #define CONFIG_EXTRACT_PEM "nsslapd-extract-pemfiles"
@@ -2600,6 +2646,8 @@ typedef struct _slapdFrontendConfig
     char *accesslog_log_format;
     char *accesslog_time_format;
     slapi_onoff_t accesslogbuffering;
+    slapi_onoff_t accesslog_async_writer;
+    char *accesslog_async_overflow;
     slapi_onoff_t csnlogging;
     slapi_onoff_t accesslog_compress;
     int statloglevel;
@@ -2762,6 +2810,7 @@ typedef struct _slapdFrontendConfig
     slapi_onoff_t ignore_vattrs;
     slapi_onoff_t unhashed_pw_switch; /* switch to on/off/nolog unhashed pw */
     slapi_onoff_t enable_turbo_mode;
+    slapi_onoff_t workqueue_sharding; /* one work queue per listener, with work stealing */
     slapi_int_t connection_buffer;    /* values are CONNECTION_BUFFER_* below */
     slapi_onoff_t connection_nocanon; /* if "on" sets LDAP_OPT_X_SASL_NOCANON */
     slapi_onoff_t plugin_logging;     /* log all internal plugin operations */
@@ -2771,6 +2820,15 @@ typedef struct _slapdFrontendConfig
     slapi_onoff_t global_backend_lock;
     slapi_int_t maxsimplepaged_per_conn; /* max simple paged results reqs handled per connection */
     slapi_int_t maxcontrols_per_op;      /* max LDAP controls allowed per operation */
+    slapi_int_t result_batch_size;       /* bytes of search result entries written at once */
+    slapi_int_t result_batch_entries;    /* search result entries written at once */
+    slapi_int_t result_batch_delay;      /* ms the search result entries may wait */
+    slapi_int_t pwverify_threads;        /* password verification threads, -1 for auto, 0 to verify on the worker */
+    slapi_int_t pwverify_cache_ttl;      /* seconds a verified bind password is remembered, 0 to disable */
+    slapi_int_t pwverify_cache_size;     /* number of remembered bind passwords */
+    slapi_int_t bind_state_write_window; /* ms bind state updates are merged before being written, 0 to disable */
+    slapi_int_t bind_state_write_batch;  /* entries updated per transaction by the bind state writer */
+    slapi_int_t dse_journal_delay;       /* seconds dse.ldif changes stay in the journal, 0 to rewrite the file */
     slapi_onoff_t enable_nunc_stans; /* Despite the removal of NS, we have to leave the value in
                                       * case someone was setting it.
                                       */
@@ -328,6 +328,11 @@ int is_type_protected(const char *type);
 int entry_apply_mods_ignore_error(Slapi_Entry *e, LDAPMod **mods, int ignore_error);
 int slapi_entries_diff(Slapi_Entry **old_entries, Slapi_Entry **new_entries, int testall, const char *logging_prestr, const int force_update, void *plg_id);
 void set_attr_to_protected_list(char *attr, int flag);
+int entrybin_is_binary(const char *data, size_t len);
+char *entry2bin(Slapi_Entry *e, size_t *len);
+Slapi_Entry *bin2entry(const char *normdn, const Slapi_RDN *srdn, const char *data, size_t len, int flags);
+int entrybin_get_value(const char *data, size_t len, const char *type, char **value);
+char *entrybin2str(const char *data, size_t len, int *slen);
 
 /* entrywsi.c */
 int32_t entry_assign_operation_csn(Slapi_PBlock *pb, Slapi_Entry *e, Slapi_Entry *parententry, CSN **opcsn);
@@ -467,6 +472,9 @@ struct component_keys_lookup
     int id_lookup_cnt;
     struct timespec key_lookup_start;
     struct timespec key_lookup_end;
+    char *filter;     /* AND component placed by the filter planner, NULL for key reads */
+    int64_t estimate; /* ids of filter estimated from the index key counts */
+    int32_t skipped;  /* filter was left to the filter test rather than read */
     struct component_keys_lookup *next;
 };
 typedef struct op_search_stat
@@ -854,6 +862,12 @@ void task_cleanup(void);
 #define SLAPI_REP_BOOTSTRAP_CREDENTIALS "nsds5ReplicaBootstrapCredentials"
 int pw_rever_encode(Slapi_Value **vals, char *attr_name);
 int pw_rever_decode(char *cipher, char **plain, const char *attr_name);
+int slapi_pw_verify_sv(const char *ndn, Slapi_Value **vals, const Slapi_Value *cred);
+
+/* bind state write-behind, see pw_retry.c */
+int slapi_bind_state_write(const Slapi_DN *sdn, Slapi_Mods *smods);
+char *slapi_bind_state_get_charptr(const char *ndn, const char *type);
+char **slapi_bind_state_get_charray(const char *ndn, const char *type);
 
 int32_t update_pw_encoding(Slapi_PBlock *orig_pb, Slapi_Entry *e, Slapi_DN *sdn, char *cleartextpassword);
 
@@ -1346,6 +1360,11 @@ void bervalarray_add_berval_fast(struct berval ***vals, const struct berval *add
 #define SLAPI_DRYRUN             0x10             /* dryrun mode for upgradednformat */
 #define SLAPI_UPGRADEDNFORMAT_V1 0x20 /* taking care multipe spaces */
 
+/* db2archive options (carried by the SLAPI_SEQ_* pblock parameters) */
+#define SLAPI_BACKUP_INCREMENTAL_BASE SLAPI_SEQ_ATTRNAME /* directory of the backup to compare with */
+#define SLAPI_BACKUP_FLAGS            SLAPI_SEQ_TYPE
+#define SLAPI_BACKUP_FLAG_COMPRESS    0x1  /* compress the database map */
+
 
 /*
  * Macro to set port to the 'port' field of a NSPR PRNetAddr union.
@@ -1619,6 +1638,9 @@ typedef struct slapd_log_pblock {
     const char *stat_value;
     const char *stat_etime;
     int32_t stat_count;
+    const char *stat_filter;
+    int64_t stat_estimate;
+    PRBool stat_skipped;
     /*
      * VLV request:
      *   - VLV %d:%d:%d:%d (response status)
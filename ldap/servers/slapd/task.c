@@ -1534,8 +1534,11 @@ task_backup_thread(void *arg)
 
     slapi_task_finish(task, rv);
     char *seq_val = NULL;
+    char *incr_base = NULL;
     slapi_pblock_get(pb, SLAPI_SEQ_VAL, &seq_val);
+    slapi_pblock_get(pb, SLAPI_BACKUP_INCREMENTAL_BASE, &incr_base);
     slapi_ch_free((void **)&seq_val);
+    slapi_ch_free_string(&incr_base);
     slapi_pblock_destroy(pb);
     g_decr_active_threadcnt();
 }
@@ -1551,10 +1554,12 @@ task_backup_add(Slapi_PBlock *pb __attribute__((unused)),
     Slapi_Backend *be = NULL;
     PRThread *thread = NULL;
     const char *archive_dir = NULL;
+    const char *incr_base = NULL;
     const char *my_database_type = NULL;
     const char *database_type = "ldbm database";
     char *cookie = NULL;
     int rv = SLAPI_DSE_CALLBACK_OK;
+    int32_t backup_flags = 0;
     Slapi_PBlock *mypb = NULL;
     Slapi_Task *task = NULL;
 
@@ -1572,6 +1577,12 @@ task_backup_add(Slapi_PBlock *pb __attribute__((unused)),
         goto out;
     }
 
+    /* incremental backup and compression options */
+    incr_base = slapi_entry_attr_get_ref(e, "nsArchiveIncrementalBase");
+    if (slapi_entry_attr_get_bool(e, "nsArchiveCompress")) {
+        backup_flags |= SLAPI_BACKUP_FLAG_COMPRESS;
+    }
+
     /* database type */
     my_database_type = slapi_entry_attr_get_ref(e, "nsDatabaseType");
     if (NULL != my_database_type)
@@ -1622,7 +1633,10 @@ task_backup_add(Slapi_PBlock *pb __attribute__((unused)),
         goto out;
     }
     char *seq_val = slapi_ch_strdup(archive_dir);
+    char *seq_incr_base = slapi_ch_strdup(incr_base);
     slapi_pblock_set(mypb, SLAPI_SEQ_VAL, seq_val);
+    slapi_pblock_set(mypb, SLAPI_BACKUP_INCREMENTAL_BASE, seq_incr_base);
+    slapi_pblock_set(mypb, SLAPI_BACKUP_FLAGS, &backup_flags);
     slapi_pblock_set(mypb, SLAPI_PLUGIN, (be->be_database));
     slapi_pblock_set(mypb, SLAPI_BACKEND_TASK, task);
     int32_t task_flags = SLAPI_TASK_RUNNING_AS_TASK;
@@ -1638,6 +1652,7 @@ task_backup_add(Slapi_PBlock *pb __attribute__((unused)),
         *returncode = LDAP_OPERATIONS_ERROR;
         rv = SLAPI_DSE_CALLBACK_ERROR;
         slapi_ch_free((void **)&seq_val);
+        slapi_ch_free_string(&seq_incr_base);
         slapi_pblock_destroy(mypb);
         goto out;
     }
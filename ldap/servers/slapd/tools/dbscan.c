@@ -318,6 +318,198 @@ format(unsigned char *s, int len, unsigned char *buf, int buflen)
     return format_raw(s, len, 0, buf, buflen);
 }
 
+/*
+ * id2entry records in the binary entry format (nsslapd-id2entry-binary-format)
+ * Copied from entry.c: the record is decoded here without the server schema.
+ */
+#define ENTRYBIN_MAGIC "\0EB"
+#define ENTRYBIN_MAGIC_LEN 3
+#define ENTRYBIN_VERSION 1
+#define ENTRYBIN_HEADER_LEN (ENTRYBIN_MAGIC_LEN + 1)
+#define ENTRYBIN_ATTR_DELETED 0x1
+#define ENTRYBIN_ATTR_ADCSN 0x2
+/* sizeof(";vucsn-011111111222233334444") */
+#define ENTRYBIN_CSNOPT_LEN 28
+
+typedef struct entrybin_reader
+{
+    const unsigned char *p;
+    const unsigned char *end;
+} entrybin_reader;
+
+static int
+entrybin_get_uint(entrybin_reader *r, size_t n, uint32_t *v)
+{
+    if ((size_t)(r->end - r->p) < n) {
+        return -1;
+    }
+    for (*v = 0; n > 0; n--) {
+        *v = (*v << 8) | *r->p++;
+    }
+    return 0;
+}
+
+static int
+entrybin_get_bytes(entrybin_reader *r, uint32_t len, const unsigned char **s)
+{
+    if ((size_t)(r->end - r->p) < len) {
+        return -1;
+    }
+    *s = r->p;
+    r->p += len;
+    return 0;
+}
+
+/* Format a csn as the ";xxcsn-..." attribute option */
+static int
+entrybin_get_csnopt(entrybin_reader *r, uint8_t type, char *opt)
+{
+    static const char *csntypes[] = {"x1", "x2", "x1", "ad", "vu", "vd", "md"};
+    uint32_t tstamp, seqnum, rid, subseqnum;
+
+    if (entrybin_get_uint(r, 4, &tstamp) || entrybin_get_uint(r, 2, &seqnum) ||
+        entrybin_get_uint(r, 2, &rid) || entrybin_get_uint(r, 2, &subseqnum)) {
+        return -1;
+    }
+    snprintf(opt, ENTRYBIN_CSNOPT_LEN + 1, ";%scsn-%08x%04x%04x%04x",
+             type < COUNTOF(csntypes) ? csntypes[type] : "x1",
+             tstamp, seqnum, rid, subseqnum);
+    return 0;
+}
+
+/* Append len bytes to the string being built in *str */
+static void
+entrybin_append(char **str, size_t *slen, size_t *ssize, const void *s, size_t len)
+{
+    if (*slen + len + 1 > *ssize) {
+        *ssize = (*slen + len + 1) * 2;
+        *str = (char *)realloc(*str, *ssize);
+        if (*str == NULL) {
+            db_printf("Out of memory: Failed to alloc %zu bytes.\n", *ssize);
+            exit(1);
+        }
+    }
+    memcpy(*str + *slen, s, len);
+    *slen += len;
+    (*str)[*slen] = '\0';
+}
+
+#define ENTRYBIN_APPEND(s, len) entrybin_append(&str, &slen, &ssize, (s), (len))
+
+/*
+ * Convert a binary id2entry record to the LDIF form id2entry writes when
+ * the binary format is off ("rdn: ..." with the state information).
+ * The values are written as is (not base64 encoded), as dbscan always did.
+ * Returns a malloc'ed string, or NULL if the record is not a (valid)
+ * binary record.
+ */
+static char *
+entrybin2ldif(const unsigned char *data, size_t len, size_t *ldiflen)
+{
+    entrybin_reader r = {data + ENTRYBIN_HEADER_LEN, data + len};
+    char *str = NULL;
+    size_t slen = 0;
+    size_t ssize = 0;
+    const unsigned char *s = NULL;
+    uint32_t n = 0;
+    uint32_t nattrs = 0;
+    char csnopt[ENTRYBIN_CSNOPT_LEN + 1];
+
+    if (data == NULL || len < ENTRYBIN_HEADER_LEN ||
+        memcmp(data, ENTRYBIN_MAGIC, ENTRYBIN_MAGIC_LEN) != 0 ||
+        data[ENTRYBIN_MAGIC_LEN] != ENTRYBIN_VERSION) {
+        return NULL;
+    }
+    ENTRYBIN_APPEND("", 0);
+    if (entrybin_get_uint(&r, 4, &n) || entrybin_get_bytes(&r, n, &s)) {
+        goto bad;
+    }
+    ENTRYBIN_APPEND("rdn: ", 5);
+    ENTRYBIN_APPEND(s, n);
+    ENTRYBIN_APPEND("\n", 1);
+    if (entrybin_get_uint(&r, 4, &n) || entrybin_get_bytes(&r, n, &s)) {
+        goto bad;
+    }
+    if (n) {
+        ENTRYBIN_APPEND("nsUniqueId: ", 12);
+        ENTRYBIN_APPEND(s, n);
+        ENTRYBIN_APPEND("\n", 1);
+    }
+    if (entrybin_get_uint(&r, 4, &nattrs)) {
+        goto bad;
+    }
+    for (uint32_t i = 0; i < nattrs; i++) {
+        uint32_t aflags = 0;
+        uint32_t typelen = 0;
+        uint32_t nvalues[2] = {0, 0};
+        const unsigned char *type = NULL;
+        char adcsnopt[ENTRYBIN_CSNOPT_LEN + 1] = "";
+
+        if (entrybin_get_uint(&r, 1, &aflags) ||
+            entrybin_get_uint(&r, 2, &typelen) ||
+            entrybin_get_bytes(&r, typelen, &type)) {
+            goto bad;
+        }
+        if ((aflags & ENTRYBIN_ATTR_ADCSN) && entrybin_get_csnopt(&r, 3, adcsnopt)) {
+            goto bad;
+        }
+        if (entrybin_get_uint(&r, 4, &nvalues[0]) || entrybin_get_uint(&r, 4, &nvalues[1])) {
+            goto bad;
+        }
+        if (nvalues[0] == 0 && nvalues[1] == 0) {
+            /* a deleted attribute without values */
+            ENTRYBIN_APPEND(type, typelen);
+            ENTRYBIN_APPEND(adcsnopt, strlen(adcsnopt));
+            if (aflags & ENTRYBIN_ATTR_DELETED) {
+                ENTRYBIN_APPEND(";deletedattribute", 17);
+            }
+            ENTRYBIN_APPEND(": \n", 3);
+        }
+        for (int deleted = 0; deleted < 2; deleted++) {
+            for (uint32_t j = 0; j < nvalues[deleted]; j++) {
+                uint32_t ncsns = 0;
+                uint32_t vlen = 0;
+
+                ENTRYBIN_APPEND(type, typelen);
+                if (j == 0 && deleted == 0) {
+                    ENTRYBIN_APPEND(adcsnopt, strlen(adcsnopt));
+                }
+                if (aflags & ENTRYBIN_ATTR_DELETED) {
+                    ENTRYBIN_APPEND(";deletedattribute", 17);
+                }
+                if (entrybin_get_uint(&r, 1, &ncsns)) {
+                    goto bad;
+                }
+                for (uint32_t k = 0; k < ncsns; k++) {
+                    uint32_t t = 0;
+                    if (entrybin_get_uint(&r, 1, &t) || entrybin_get_csnopt(&r, (uint8_t)t, csnopt)) {
+                        goto bad;
+                    }
+                    ENTRYBIN_APPEND(csnopt, strlen(csnopt));
+                }
+                if (deleted) {
+                    ENTRYBIN_APPEND(";deleted", 8);
+                }
+                if (entrybin_get_uint(&r, 4, &vlen) || entrybin_get_bytes(&r, vlen, &s)) {
+                    goto bad;
+                }
+                ENTRYBIN_APPEND(": ", 2);
+                ENTRYBIN_APPEND(s, vlen);
+                ENTRYBIN_APPEND("\n", 1);
+            }
+        }
+    }
+    if (r.p != r.end) {
+        goto bad;
+    }
+    *ldiflen = slen;
+    return str;
+
+bad:
+    free(str);
+    return NULL;
+}
+
 static char *
 format_entry(unsigned char *s, int len, unsigned char *buf, int buflen)
 {
@@ -815,8 +1007,25 @@ display_item(dbi_cursor_t *cursor, dbi_val_t *key, dbi_val_t *data)
         } else if (file_type & ENTRYTYPE) {
             /* id2entry file */
             ID entry_id = id_stored_to_internal(key->data);
+            size_t ldiflen = 0;
+            char *ldif = entrybin2ldif(data->data, data->size, &ldiflen);
+
             printf("id %u\n", entry_id);
-            printf("\t%s\n", format_entry(data->data, data->size, buf, buflen));
+            if (ldif) {
+                if (truncatesiz <= 0 && (size_t)buflen < ldiflen + 1024) {
+                    buflen = ldiflen + 1024;
+                    buf = (unsigned char *)realloc(buf, buflen);
+                    if (!buf) {
+                        printf("\t(malloc failed -- %d bytes)\n", buflen);
+                        free(ldif);
+                        return;
+                    }
+                }
+                printf("\t%s\n", format_entry((unsigned char *)ldif, ldiflen, buf, buflen));
+                free(ldif);
+            } else {
+                printf("\t%s\n", format_entry(data->data, data->size, buf, buflen));
+            }
         } else {
             /* user didn't tell us what kind of file, dump it raw */
             printf("%s\n", format(key->data, key->size, buf, buflen));
@@ -2373,6 +2373,25 @@ vattr_map_namespace_sp_getlist(Slapi_DN *dn, const char *type_to_find)
     return return_list;
 }
 
+/*
+ * Tells whether a service provider may supply type (or its base type)
+ * for the entries of the backend holding e, i.e. whether a filter on
+ * type may match values which are not stored in e.
+ */
+int
+vattr_type_is_virtual(const Slapi_Entry *e, const char *type)
+{
+    char buf[SLAPD_TYPICAL_ATTRIBUTE_NAME_MAX_LENGTH];
+    Slapi_Backend *be = slapi_be_select(slapi_entry_get_sdn_const(e));
+    Slapi_DN *namespace_dn = (Slapi_DN *)slapi_be_getsuffix(be, 0);
+    char *basetype = slapi_attr_basetype(type, buf, sizeof(buf));
+    int rc;
+
+    rc = (vattr_map_namespace_sp_getlist(namespace_dn, basetype ? basetype : buf) != NULL);
+    slapi_ch_free_string(&basetype);
+    return rc;
+}
+
 
 /* Iterator function for the list */
 vattr_sp_handle *
@@ -2855,7 +2855,7 @@ class DirSrv(SimpleLDAPObject, object):
         return True
 
     def db2ldif(self, bename, suffixes, excludeSuffixes, encrypt, repl_data,
-                outputfile, export_cl=False, watch=False):
+                outputfile, export_cl=False, watch=False, compress=False):
         """
         @param bename - The backend name of the database to export
         @param suffixes - List/tuple of suffixes to export
@@ -2863,6 +2863,7 @@ class DirSrv(SimpleLDAPObject, object):
         @param encrypt - Perform attribute encryption
         @param repl_data - Export the replication data
         @param outputfile - The filename for the exported LDIF
+        @param compress - Compress the exported LDIF with gzip
         @return - True if export succeeded
         """
         DirSrvTools.lib389User(user=DEFAULT_USER)
@@ -2900,17 +2901,19 @@ class DirSrv(SimpleLDAPObject, object):
         if export_cl:
             cmd.append('-R')
         if outputfile is not None:
-            cmd.append('-a')
-            cmd.append(outputfile)
+            ldifname = outputfile
         else:
             # No output file specified.  Use the default ldif location/name
-            cmd.append('-a')
             tnow = Task.get_timestamp()
             if bename:
                 ldifname = os.path.join(self.ds_paths.ldif_dir, "%s-%s-%s.ldif" % (self.serverid, bename, tnow))
             else:
                 ldifname = os.path.join(self.ds_paths.ldif_dir, "%s-%s.ldif" % (self.serverid, tnow))
-            cmd.append(ldifname)
+        if compress and not ldifname.endswith('.gz'):
+            # ns-slapd compresses the exported LDIF when the file name ends with .gz
+            ldifname += '.gz'
+        cmd.append('-a')
+        cmd.append(ldifname)
 
         if watch:
             cmd.append('-V')
@@ -622,7 +622,11 @@ class Backend(DSLdapObject):
         else:
             config_attrs = DatabaseConfig.get_combined_flat_from_dse(self._instance)
 
-        mdb_only_attrs = ['nsslapd-mdb-max-size', 'nsslapd-mdb-max-readers', 'nsslapd-mdb-max-dbs']
+        mdb_only_attrs = ['nsslapd-mdb-max-size', 'nsslapd-mdb-max-readers', 'nsslapd-mdb-max-dbs',
+                          'nsslapd-mdb-group-commit', 'nsslapd-mdb-group-commit-batch-size',
+                          'nsslapd-mdb-group-commit-window', 'nsslapd-mdb-import-sorted-runs',
+                          'nsslapd-mdb-import-run-size', 'nsslapd-mdb-export-threads',
+                          'nsslapd-mdb-reindex-shadow']
         bdb_only_attrs = ['nsslapd-dbcachesize',
                           'nsslapd-dbncache',
                           'nsslapd-db-logdirectory',
@@ -1140,12 +1144,14 @@ class Backend(DSLdapObject):
         return task
 
     def export_ldif(self, ldif=None, use_id2entry=False, encrypted=False, min_base64=False, no_uniq_id=False,
-                    replication=False, not_folded=False, no_seq_num=False, include_suffixes=None, exclude_suffixes=None):
+                    replication=False, not_folded=False, no_seq_num=False, include_suffixes=None, exclude_suffixes=None,
+                    compress=False):
         """Do an export of the suffix"""
 
         bs = Backends(self._instance)
         task = bs.export_ldif(self.rdn, ldif, use_id2entry, encrypted, min_base64, no_uniq_id,
-                              replication, not_folded, no_seq_num, include_suffixes, exclude_suffixes)
+                              replication, not_folded, no_seq_num, include_suffixes, exclude_suffixes,
+                              compress)
         return task
 
     def get_vlv_searches(self, vlv_name=None):
@@ -1327,7 +1333,8 @@ class Backends(DSLdapObjects):
         return task
 
     def export_ldif(self, be_names, ldif=None, use_id2entry=False, encrypted=False, min_base64=False, no_dump_uniq_id=False,
-                    replication=False, not_folded=False, no_seq_num=False, include_suffixes=None, exclude_suffixes=None):
+                    replication=False, not_folded=False, no_seq_num=False, include_suffixes=None, exclude_suffixes=None,
+                    compress=False):
         """Do an export of the suffix"""
 
         task = ExportTask(self._instance)
@@ -1335,12 +1342,12 @@ class Backends(DSLdapObjects):
         if ldif == "":
             ldif = None
         if ldif is not None and not ldif.startswith("/"):
-            if ldif.endswith(".ldif"):
+            if ldif.endswith((".ldif", ".ldif.gz")):
                 task_properties['nsFilename'] = os.path.join(self._instance.ds_paths.ldif_dir, ldif)
             else:
                 task_properties['nsFilename'] = os.path.join(self._instance.ds_paths.ldif_dir, "%s.ldif" % ldif)
         elif ldif is not None and ldif.startswith("/"):
-            if ldif.endswith(".ldif"):
+            if ldif.endswith((".ldif", ".ldif.gz")):
                 task_properties['nsFilename'] = ldif
             else:
                 task_properties['nsFilename'] = "%s.ldif" % ldif
@@ -1349,6 +1356,9 @@ class Backends(DSLdapObjects):
             task_properties['nsFilename'] = os.path.join(self._instance.ds_paths.ldif_dir,
                                                          "%s-%s-%s.ldif" % (self._instance.serverid,
                                                                             "-".join(be_names), tnow))
+        if compress and not task_properties['nsFilename'].endswith(".gz"):
+            # The server compresses the exported LDIF when the file name ends with .gz
+            task_properties['nsFilename'] += ".gz"
         if include_suffixes is not None:
             task_properties['nsIncludeSuffix'] = include_suffixes
         if exclude_suffixes is not None:
@@ -1427,6 +1437,12 @@ class DatabaseConfig(DSLdapObject):
         'nsslapd-dynamic-lists-attr',
         'nsslapd-dynamic-lists-oc',
         'nsslapd-dynamic-lists-url-attr',
+        'nsslapd-id2entry-binary-format',
+        'nsslapd-idl-bitmap-threshold',
+        'nsslapd-filter-planner',
+        'nsslapd-index-stats',
+        'nsslapd-search-scan-threads',
+        'nsslapd-search-scan-min-candidates',
     ]
     _DB_ATTRS = {
         'bdb':
@@ -1458,6 +1474,13 @@ class DatabaseConfig(DSLdapObject):
                 'nsslapd-mdb-max-size',
                 'nsslapd-mdb-max-readers',
                 'nsslapd-mdb-max-dbs',
+                'nsslapd-mdb-group-commit',
+                'nsslapd-mdb-group-commit-batch-size',
+                'nsslapd-mdb-group-commit-window',
+                'nsslapd-mdb-import-sorted-runs',
+                'nsslapd-mdb-import-run-size',
+                'nsslapd-mdb-export-threads',
+                'nsslapd-mdb-reindex-shadow',
                 'nsslapd-cache-autosize',
             ]
     }
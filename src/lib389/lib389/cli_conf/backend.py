@@ -63,12 +63,25 @@ arg_to_attr = {
         'pagedidlistscanlimit': 'nsslapd-pagedidlistscanlimit',
         'rangelookthroughlimit': 'nsslapd-rangelookthroughlimit',
         'backend_opt_level': 'nsslapd-backend-opt-level',
+        'id2entry_binary_format': 'nsslapd-id2entry-binary-format',
+        'idl_bitmap_threshold': 'nsslapd-idl-bitmap-threshold',
+        'filter_planner': 'nsslapd-filter-planner',
+        'index_stats': 'nsslapd-index-stats',
+        'search_scan_threads': 'nsslapd-search-scan-threads',
+        'search_scan_min_candidates': 'nsslapd-search-scan-min-candidates',
         'deadlock_policy': 'nsslapd-db-deadlock-policy',
         'db_home_directory': 'nsslapd-db-home-directory',
         'db_lib': 'nsslapd-backend-implement',
         'mdb_max_size': 'nsslapd-mdb-max-size',
         'mdb_max_readers': 'nsslapd-mdb-max-readers',
         'mdb_max_dbs': 'nsslapd-mdb-max-dbs',
+        'mdb_group_commit': 'nsslapd-mdb-group-commit',
+        'mdb_group_commit_batch_size': 'nsslapd-mdb-group-commit-batch-size',
+        'mdb_group_commit_window': 'nsslapd-mdb-group-commit-window',
+        'mdb_import_sorted_runs': 'nsslapd-mdb-import-sorted-runs',
+        'mdb_import_run_size': 'nsslapd-mdb-import-run-size',
+        'mdb_export_threads': 'nsslapd-mdb-export-threads',
+        'mdb_reindex_shadow': 'nsslapd-mdb-reindex-shadow',
         # VLV attributes
         'search_base': 'vlvbase',
         'search_scope': 'vlvscope',
@@ -306,7 +319,8 @@ def backend_export(inst, basedn, log, args):
     task = mc.export_ldif(be_names=be_cn_names, ldif=args.ldif, use_id2entry=args.use_id2entry,
                           encrypted=args.encrypted, min_base64=args.min_base64, no_dump_uniq_id=args.no_dump_uniq_id,
                           replication=args.replication, not_folded=args.not_folded, no_seq_num=args.no_seq_num,
-                          include_suffixes=args.include_suffixes, exclude_suffixes=args.exclude_suffixes)
+                          include_suffixes=args.include_suffixes, exclude_suffixes=args.exclude_suffixes,
+                          compress=args.compress)
     if args.watch:
         task.watch()
     else:
@@ -1123,12 +1137,42 @@ def create_parser(subparsers):
                                                                       'range search request.')
     set_db_config_parser.add_argument('--backend-opt-level', help='Sets the backend optimization level for write performance (0, 1, 2, or 4). '
                                                                   'WARNING: This parameter can trigger experimental code.')
+    set_db_config_parser.add_argument('--id2entry-binary-format', help='Set to "on" to store the entries in a binary format instead of LDIF. '
+                                                                       'Existing entries are converted when they are next written. To convert '
+                                                                       'all the entries back to LDIF, set it to "off", then export and '
+                                                                       're-import the backend.')
+    set_db_config_parser.add_argument('--idl-bitmap-threshold', help='Sets the number of IDs above which an index key ID list is held in memory '
+                                                                     'as a compressed bitmap. Set to 0 to disable.')
+    set_db_config_parser.add_argument('--filter-planner', help='Set to "on" to read the components of AND filters from the most to the '
+                                                               'least selective one, using index key counts, and to leave very unselective '
+                                                               'ones to the filter test.')
+    set_db_config_parser.add_argument('--index-stats', help='Set to "on" to count the index reads of each backend and publish them, '
+                                                            'with advice on missing or unselective indexes, under cn=index-stats')
+    set_db_config_parser.add_argument('--search-scan-threads', help='Sets the number of threads reading the candidate entries of large '
+                                                                    'searches ahead of the worker thread. Set to 0 to disable (restart required)')
+    set_db_config_parser.add_argument('--search-scan-min-candidates', help='Sets the number of candidate entries from which a search is read '
+                                                                           'by the search scan threads')
     set_db_config_parser.add_argument('--deadlock-policy', help='Adjusts the backend database deadlock policy (Advanced setting)')
     set_db_config_parser.add_argument('--db-home-directory', help='Sets the directory for the database mmapped files (Advanced setting)')
     set_db_config_parser.add_argument('--db-lib', help='Sets which db lib is used. Valid values are: bdb or mdb')
     set_db_config_parser.add_argument('--mdb-max-size', help='Sets the lmdb database maximum size (accepts bytes, or with unit suffix: k, m, g, t)')
     set_db_config_parser.add_argument('--mdb-max-readers', help='Sets the lmdb database maximum number of readers (Advanced setting)')
     set_db_config_parser.add_argument('--mdb-max-dbs', help='Sets the lmdb database maximum number of sub databases (Advanced setting)')
+    set_db_config_parser.add_argument('--mdb-group-commit', help='Set to "on" to flush the lmdb write transactions of concurrent operations '
+                                                                 'to disk together (requires a server restart) (Advanced setting)')
+    set_db_config_parser.add_argument('--mdb-group-commit-batch-size', help='Sets the number of lmdb write transactions that triggers a '
+                                                                            'group commit flush (Advanced setting)')
+    set_db_config_parser.add_argument('--mdb-group-commit-window', help='Sets the maximum time, in microseconds, a lmdb write transaction '
+                                                                        'waits for others before being flushed (Advanced setting)')
+    set_db_config_parser.add_argument('--mdb-import-sorted-runs', help='Set to "on" to spill the import index records to sorted runs and '
+                                                                       'load them in key order with append writes (Advanced setting)')
+    set_db_config_parser.add_argument('--mdb-import-run-size', help='Sets the size in bytes of the in memory import run, a run is sorted '
+                                                                    'and spilled to disk when it is full (Advanced setting)')
+    set_db_config_parser.add_argument('--mdb-export-threads', help='Sets the number of threads formatting the entries during an lmdb export. '
+                                                                   '0 formats them in the exporting thread (Advanced setting)')
+    set_db_config_parser.add_argument('--mdb-reindex-shadow', help='Set to "on" to let an online lmdb reindex build the attribute indexes '
+                                                                   'aside so that searches keep using the current ones until they are '
+                                                                   'switched over (Advanced setting)')
     # Dynamic lists
     set_db_config_parser.add_argument('--enable-dynamic-lists', action='store_true', help='Enables dynamic lists')
     set_db_config_parser.add_argument('--disable-dynamic-lists', action='store_true', help='Disables dynamic lists')
@@ -1204,6 +1248,8 @@ def create_parser(subparsers):
                                help="Specifies the suffixes or the subtrees to be included")
     export_parser.add_argument('-x', '--exclude-suffixes', nargs='+',
                                help="Specifies the suffixes to be excluded")
+    export_parser.add_argument('-z', '--compress', action='store_true',
+                               help="Compresses the LDIF file with gzip (a \".gz\" suffix is added to the file name)")
     export_parser.add_argument('--timeout', default=0, type=int,
                                help="Set a timeout to wait for the export task.  Default is 0 (no timeout)")
     export_parser.add_argument('-w', '--watch', action='store_true',
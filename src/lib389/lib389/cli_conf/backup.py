@@ -25,6 +25,10 @@ def backup_create(inst, basedn, log, args):
 
     if args.db_type is not None:
         task_properties['nsDatabaseType'] = args.db_type
+    if args.incremental_base is not None:
+        task_properties['nsArchiveIncrementalBase'] = args.incremental_base
+    if args.compress:
+        task_properties['nsArchiveCompress'] = 'on'
 
     backup_task.create(properties=task_properties)
     if args.watch:
@@ -85,6 +89,11 @@ def create_parser(subparsers):
     create_backup_parser.add_argument('--timeout', type=int, default=120,
                                       help="Sets the task timeout.  Default is 120 seconds,")
     create_backup_parser.add_argument('--watch', action='store_true', help='Watch the status of the backup task')
+    create_backup_parser.add_argument('--incremental-base', default=None,
+                                      help="Only stores the database pages that changed since this earlier backup "
+                                           "(LMDB only). Restoring the backup also needs the base backup.")
+    create_backup_parser.add_argument('--compress', action='store_true',
+                                      help="Compresses the database map while it is streamed to the backup (LMDB only)")
 
     restore_parser = subcommands.add_parser('restore', help="Restores a database from a backup", formatter_class=CustomHelpFormatter)
     restore_parser.set_defaults(func=backup_restore)
@@ -30,6 +30,8 @@ arg_to_attr = {
     'autoaddoc': 'memberOfAutoAddOC',
     'deferredupdate': 'memberOfDeferredUpdate',
     'launchfixup': 'memberOfLaunchFixup',
+    'fixupthreads': 'memberOfFixupThreads',
+    'fixupbatchsize': 'memberOfFixupBatchSize',
     'config_entry': 'nsslapd-pluginConfigArea',
     'specific_group_filter': 'memberOfSpecificGroupFilter',
     'exclude_specific_group_filter': 'memberOfExcludeSpecificGroupFilter',
@@ -165,6 +167,12 @@ def _set_attr_parser_args(parser):
     parser.add_argument('--launchfixup', choices=['on', 'off'], type=str.lower,
                         help='Specify that if the server disorderly shutdown (crash, kill,..) then '
                              'at restart the memberof fixup task is launched automatically')
+    parser.add_argument('--fixupthreads', type=int,
+                        help='Specifies the number of worker threads the memberof fixup task uses. '
+                             'A value of 1 runs the fixup sequentially (memberOfFixupThreads)')
+    parser.add_argument('--fixupbatchsize', type=int,
+                        help='Specifies the number of entries a fixup worker thread updates in a '
+                             'single transaction (memberOfFixupBatchSize)')
     parser.add_argument('--specific-group-oc', nargs='+',
                         help='Set objectclasses for the specific groups to include/exclude. '
                               'Otherwise all other groups will be excluded. Note, this replaces '
@@ -69,7 +69,7 @@ def dbtasks_db2ldif(inst, log, args):
     # Export backend
     if not inst.db2ldif(bename=args.backend, encrypt=args.encrypted, repl_data=args.replication,
                         outputfile=args.ldif, suffixes=None, excludeSuffixes=None, export_cl=False,
-                        watch=args.watch):
+                        watch=args.watch, compress=getattr(args, 'compress', False)):
         log.fatal("db2ldif failed")
         return False
     else:
@@ -532,6 +532,8 @@ def create_parser(subcommands):
     #                                                         "This option also implies the '--replication' option is set.",
     #                             default=False, action='store_true')
     db2ldif_parser.add_argument('--encrypted', help="Export encrypted attributes", default=False, action='store_true')
+    db2ldif_parser.add_argument('--compress', help="Compress the LDIF with gzip (a \".gz\" suffix is added to the file name)",
+                                default=False, action='store_true')
     db2ldif_parser.add_argument('--watch', action='store_true', help='Watch the status of the db2ldif task')
     db2ldif_parser.set_defaults(func=dbtasks_db2ldif)
 
@@ -68,6 +68,63 @@ class Monitor(DSLdapObject):
         maxbusyworkers = self.get_attr_vals_utf8('maxbusyworkers')
         return (currentworkqueue, maxworkqueue, currentbusyworkers, maxbusyworkers)
 
+    def get_work_queue_shards(self):
+        """Get per shard work queue attributes value for cn=monitor
+
+        :returns: Value of workqueueshards and the values of workqueueshard
+                  (shard:currentworkqueue:maxworkqueue:steals) of cn=monitor
+        """
+        workqueueshards = self.get_attr_vals_utf8('workqueueshards')
+        workqueueshard = self.get_attr_vals_utf8('workqueueshard')
+        return (workqueueshards, workqueueshard)
+
+    def get_access_log_writer(self):
+        """Get access log writer thread attributes value for cn=monitor
+
+        :returns: Values of accesslogqueuedepth, accesslogflushes,
+                  accesslogflushlatencyavg, accesslogflushlatencymax,
+                  accesslogdropped and accesslogblocked of cn=monitor
+        """
+        accesslogqueuedepth = self.get_attr_vals_utf8('accesslogqueuedepth')
+        accesslogflushes = self.get_attr_vals_utf8('accesslogflushes')
+        accesslogflushlatencyavg = self.get_attr_vals_utf8('accesslogflushlatencyavg')
+        accesslogflushlatencymax = self.get_attr_vals_utf8('accesslogflushlatencymax')
+        accesslogdropped = self.get_attr_vals_utf8('accesslogdropped')
+        accesslogblocked = self.get_attr_vals_utf8('accesslogblocked')
+        return (accesslogqueuedepth, accesslogflushes, accesslogflushlatencyavg,
+                accesslogflushlatencymax, accesslogdropped, accesslogblocked)
+
+    def get_pw_verify(self):
+        """Get bind password verification attributes value for cn=monitor
+
+        :returns: Values of pwverifythreads, pwverifyqueuedepth, pwverifyops,
+                  pwverifycacheentries, pwverifycachehits, pwverifycachemisses
+                  and pwverifycacheevictions of cn=monitor
+        """
+        pwverifythreads = self.get_attr_vals_utf8('pwverifythreads')
+        pwverifyqueuedepth = self.get_attr_vals_utf8('pwverifyqueuedepth')
+        pwverifyops = self.get_attr_vals_utf8('pwverifyops')
+        pwverifycacheentries = self.get_attr_vals_utf8('pwverifycacheentries')
+        pwverifycachehits = self.get_attr_vals_utf8('pwverifycachehits')
+        pwverifycachemisses = self.get_attr_vals_utf8('pwverifycachemisses')
+        pwverifycacheevictions = self.get_attr_vals_utf8('pwverifycacheevictions')
+        return (pwverifythreads, pwverifyqueuedepth, pwverifyops, pwverifycacheentries,
+                pwverifycachehits, pwverifycachemisses, pwverifycacheevictions)
+
+    def get_bind_state(self):
+        """Get bind state write-behind attributes value for cn=monitor
+
+        :returns: Values of bindstatepending, bindstatequeued, bindstatemerged,
+                  bindstatewritten and bindstatebatches of cn=monitor
+        """
+        bindstatepending = self.get_attr_vals_utf8('bindstatepending')
+        bindstatequeued = self.get_attr_vals_utf8('bindstatequeued')
+        bindstatemerged = self.get_attr_vals_utf8('bindstatemerged')
+        bindstatewritten = self.get_attr_vals_utf8('bindstatewritten')
+        bindstatebatches = self.get_attr_vals_utf8('bindstatebatches')
+        return (bindstatepending, bindstatequeued, bindstatemerged,
+                bindstatewritten, bindstatebatches)
+
     def get_backends(self):
         """Get backends related attributes value for cn=monitor
 
@@ -353,6 +410,7 @@ class MonitorDatabase(DSLdapObject):
                 'commitrwtxn',
                 'granttimerwtxn',
                 'lifetimerwtxn',
+                'groupcommitsyncs',
                 'waitingrotxn',
                 'activerotxn',
                 'abortrotxn',
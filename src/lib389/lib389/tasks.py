@@ -699,6 +699,9 @@ class Tasks(object):
         @param args - is a dictionary that contains modifier of the task
                 wait: True/[False] - If True,  waits for the completion of the
                                      task before to return
+                incremental_base: backup that an LMDB backup only stores
+                                  the changed pages of
+                compress: True/[False] - compress the LMDB database map
 
         @return exit code
 
@@ -719,6 +722,10 @@ class Tasks(object):
             'nsArchiveDir': backup_dir,
             'nsDatabaseType': 'ldbm database'
         })
+        if args and args.get('incremental_base'):
+            entry.setValues('nsArchiveIncrementalBase', args['incremental_base'])
+        if args and args.get('compress', False):
+            entry.setValues('nsArchiveCompress', 'on')
 
         # start the task and possibly wait for task completion
         try:
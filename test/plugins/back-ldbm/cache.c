@@ -0,0 +1,127 @@
+/** BEGIN COPYRIGHT BLOCK
+ * Copyright (C) 2026 Red Hat, Inc.
+ * All rights reserved.
+ *
+ * License: GPL (version 3 or any later version).
+ * See LICENSE for details.
+ * END COPYRIGHT BLOCK **/
+
+#include "../../test_slapd.h"
+
+#include <back-ldbm.h>
+
+/*
+ * Check the reference counting of the entry cache when the references are
+ * taken and dropped on the lock free path (cache_find_shared and
+ * cache_return_shared): an entry that is already referenced stays off the
+ * LRU while other references come and go, cache_has_otherref() follows the
+ * count, and the last reference puts the entry back on the LRU.
+ */
+
+#define CACHE_TEST_DN "cn=cache test,dc=example,dc=com"
+#define CACHE_TEST_ID 42
+#define CACHE_TEST_THREADS 8
+#define CACHE_TEST_LOOPS 20000
+
+struct cache_test_ctx
+{
+    struct cache *cache;
+    struct backentry *e;
+    int failed;
+};
+
+static struct backentry *
+cache_test_entry(void)
+{
+    Slapi_Entry *e = slapi_entry_alloc();
+    struct backentry *bep;
+
+    slapi_entry_init(e, slapi_ch_strdup(CACHE_TEST_DN), NULL);
+    bep = backentry_init(e);
+    bep->ep_id = CACHE_TEST_ID;
+    return bep;
+}
+
+static int32_t
+cache_test_refcnt(struct backentry *e)
+{
+    return slapi_atomic_load_32(&e->ep_refcnt, __ATOMIC_ACQUIRE);
+}
+
+static void *
+cache_test_worker(void *arg)
+{
+    struct cache_test_ctx *ctx = (struct cache_test_ctx *)arg;
+
+    for (size_t i = 0; i < CACHE_TEST_LOOPS; i++) {
+        struct backentry *e = (i & 1) ? cache_find_id(ctx->cache, CACHE_TEST_ID)
+                                      : cache_find_dn(ctx->cache, CACHE_TEST_DN, strlen(CACHE_TEST_DN));
+        if (e != ctx->e || !cache_has_otherref(ctx->cache, e)) {
+            __atomic_store_n(&ctx->failed, 1, __ATOMIC_RELAXED);
+        }
+        CACHE_RETURN(ctx->cache, &e);
+    }
+    return NULL;
+}
+
+void
+test_plugin_back_ldbm_cache_shared(void **state __attribute__((unused)))
+{
+    ldbm_instance *inst = (ldbm_instance *)slapi_ch_calloc(1, sizeof(ldbm_instance));
+    struct cache cache = {0};
+    struct cache_test_ctx ctx = {0};
+    pthread_t threads[CACHE_TEST_THREADS];
+    struct backentry *e = cache_test_entry();
+    struct backentry *f1 = NULL;
+    struct backentry *f2 = NULL;
+
+    assert_int_equal(cache_init(&cache, inst, 10 * 1024 * 1024, -1, CACHE_TYPE_ENTRY), 1);
+    assert_int_equal(CACHE_ADD(&cache, e, NULL), 0);
+    assert_int_equal(cache_test_refcnt(e), 1);
+    assert_int_equal(cache_has_otherref(&cache, e), 0);
+
+    /* Further references are shared, the entry stays off the LRU */
+    f1 = cache_find_id(&cache, CACHE_TEST_ID);
+    assert_ptr_equal(f1, e);
+    f2 = cache_find_dn(&cache, CACHE_TEST_DN, strlen(CACHE_TEST_DN));
+    assert_ptr_equal(f2, e);
+    assert_int_equal(cache_test_refcnt(e), 3);
+    assert_int_equal(cache_has_otherref(&cache, e), 1);
+    CACHE_RETURN(&cache, &f2);
+    assert_int_equal(cache_test_refcnt(e), 2);
+    assert_null(cache.c_lruhead);
+    CACHE_RETURN(&cache, &f1);
+    assert_int_equal(cache_test_refcnt(e), 1);
+    assert_int_equal(cache_has_otherref(&cache, e), 0);
+    assert_null(cache.c_lruhead);
+
+    /* Many threads sharing the entry while we hold it */
+    ctx.cache = &cache;
+    ctx.e = e;
+    for (size_t i = 0; i < CACHE_TEST_THREADS; i++) {
+        assert_int_equal(pthread_create(&threads[i], NULL, cache_test_worker, &ctx), 0);
+    }
+    for (size_t i = 0; i < CACHE_TEST_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    assert_int_equal(ctx.failed, 0);
+    assert_int_equal(cache_test_refcnt(e), 1);
+    assert_null(cache.c_lruhead);
+
+    /* The last reference goes through the cache lock and onto the LRU */
+    f1 = e;
+    CACHE_RETURN(&cache, &f1);
+    assert_int_equal(cache_test_refcnt(e), 0);
+    assert_ptr_equal(cache.c_lruhead, e);
+    assert_int_equal(cache_is_in_cache(&cache, e), 1);
+
+    /* An unreferenced entry is taken back off the LRU by the slow path */
+    f1 = cache_find_id(&cache, CACHE_TEST_ID);
+    assert_ptr_equal(f1, e);
+    assert_int_equal(cache_test_refcnt(e), 1);
+    assert_null(cache.c_lruhead);
+    CACHE_RETURN(&cache, &f1);
+
+    cache_destroy_please(&cache, CACHE_TYPE_ENTRY);
+    slapi_ch_free((void **)&inst);
+}
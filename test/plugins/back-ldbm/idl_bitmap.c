@@ -0,0 +1,234 @@
+/** BEGIN COPYRIGHT BLOCK
+ * Copyright (C) 2026 Red Hat, Inc.
+ * All rights reserved.
+ *
+ * License: GPL (version 3 or any later version).
+ * See LICENSE for details.
+ * END COPYRIGHT BLOCK **/
+
+#include "../../test_slapd.h"
+
+#include <back-ldbm.h>
+
+/*
+ * Check the id lists held as compressed bitmaps (idl_bitmap.c) against a
+ * plain membership table: the iterators, idl_firstid/idl_nextid, the union
+ * and intersection of every mix of array and bitmap lists, the pairwise fold
+ * of an idl_set holding bitmaps, and the switch to the bitmap form past the
+ * nsslapd-idl-bitmap-threshold.
+ *
+ * The ids cross the 65536 ids chunks of the bitmap, and one chunk holds more
+ * than 4096 ids so that it is stored as a bitset rather than an array.
+ */
+
+#define IDL_BITMAP_TEST_RANGE 200000
+
+static IDList *
+idl_bitmap_test_make(unsigned char *seen, ID range, uint32_t step, uint32_t *seed)
+{
+    IDList *idl = NULL;
+
+    for (ID id = 1; id <= range; id++) {
+        *seed = *seed * 1103515245 + 12345;
+        /* dense between 70000 and 80000, sparse elsewhere */
+        if ((id > 70000 && id < 80000) ? (*seed >> 8) % 2 == 0 : (*seed >> 8) % step == 0) {
+            seen[id] = 1;
+            idl_append_extend(&idl, id);
+        }
+    }
+    /* around the chunk boundaries */
+    for (ID id = 65534; id <= 65537; id++) {
+        if (!seen[id]) {
+            seen[id] = 1;
+            idl_insert(&idl, id);
+        }
+    }
+    return idl;
+}
+
+/* idl holds exactly the ids set in expect, in order, whatever its form */
+static void
+idl_bitmap_test_assert_ids(IDList *idl, const unsigned char *expect, ID range)
+{
+    idl_iterator it = idl_iterator_init(idl);
+    NIDS count = 0;
+    ID id = NOID;
+    ID prev = 0;
+
+    while ((id = idl_iterator_dereference_increment(&it, idl)) != NOID) {
+        assert_true(id > prev);
+        assert_true(id <= range);
+        assert_true(expect[id]);
+        prev = id;
+        count++;
+    }
+    for (ID i = 1; i <= range; i++) {
+        if (expect[i]) {
+            count--;
+        }
+    }
+    assert_int_equal(count, 0);
+}
+
+void
+test_plugin_back_ldbm_idl_bitmap_iterate(void **state __attribute__((unused)))
+{
+    unsigned char *seen = (unsigned char *)slapi_ch_calloc(IDL_BITMAP_TEST_RANGE + 1, 1);
+    uint32_t seed = 11;
+    IDList *arr = idl_bitmap_test_make(seen, IDL_BITMAP_TEST_RANGE, 7, &seed);
+    IDList *bm = idl_dup(arr);
+    ID a = NOID;
+    ID b = NOID;
+
+    assert_int_equal(idl_compress(&bm), 1);
+    assert_true(IDL_BITMAP(bm));
+    assert_int_equal(bm->b_nids, arr->b_nids);
+    idl_bitmap_test_assert_ids(bm, seen, IDL_BITMAP_TEST_RANGE);
+
+    /* idl_firstid/idl_nextid walk both forms the same way */
+    for (a = idl_firstid(arr), b = idl_firstid(bm); a != NOID; a = idl_nextid(arr, a), b = idl_nextid(bm, b)) {
+        assert_int_equal(a, b);
+        assert_true(idl_id_is_in_idlist(bm, a));
+    }
+    assert_int_equal(b, NOID);
+    assert_false(idl_id_is_in_idlist(bm, IDL_BITMAP_TEST_RANGE + 1));
+
+    /* and an expanded bitmap is the array again */
+    assert_int_equal(idl_expand(&bm), 1);
+    assert_false(IDL_BITMAP(bm));
+    assert_int_equal(bm->b_nids, arr->b_nids);
+    assert_memory_equal(bm->b_ids, arr->b_ids, arr->b_nids * sizeof(ID));
+
+    idl_free(&arr);
+    idl_free(&bm);
+    slapi_ch_free((void **)&seen);
+}
+
+void
+test_plugin_back_ldbm_idl_bitmap_ops(void **state __attribute__((unused)))
+{
+    backend be = {0};
+    unsigned char *sa = (unsigned char *)slapi_ch_calloc(IDL_BITMAP_TEST_RANGE + 1, 1);
+    unsigned char *sb = (unsigned char *)slapi_ch_calloc(IDL_BITMAP_TEST_RANGE + 1, 1);
+    unsigned char *su = (unsigned char *)slapi_ch_calloc(IDL_BITMAP_TEST_RANGE + 1, 1);
+    unsigned char *si = (unsigned char *)slapi_ch_calloc(IDL_BITMAP_TEST_RANGE + 1, 1);
+    uint32_t seed = 23;
+    IDList *a = idl_bitmap_test_make(sa, IDL_BITMAP_TEST_RANGE, 5, &seed);
+    IDList *b = idl_bitmap_test_make(sb, IDL_BITMAP_TEST_RANGE, 3, &seed);
+
+    for (ID id = 1; id <= IDL_BITMAP_TEST_RANGE; id++) {
+        su[id] = sa[id] | sb[id];
+        si[id] = sa[id] & sb[id];
+    }
+
+    /* array/array, bitmap/array, array/bitmap and bitmap/bitmap */
+    for (int form = 0; form < 4; form++) {
+        IDList *la = idl_dup(a);
+        IDList *lb = idl_dup(b);
+        IDList *r = NULL;
+
+        if (form & 1) {
+            idl_compress(&la);
+        }
+        if (form & 2) {
+            idl_compress(&lb);
+        }
+
+        r = idl_union(&be, la, lb);
+        idl_bitmap_test_assert_ids(r, su, IDL_BITMAP_TEST_RANGE);
+        idl_free(&r);
+
+        r = idl_intersection(&be, la, lb);
+        idl_bitmap_test_assert_ids(r, si, IDL_BITMAP_TEST_RANGE);
+        idl_free(&r);
+
+        idl_free(&la);
+        idl_free(&lb);
+    }
+
+    idl_free(&a);
+    idl_free(&b);
+    slapi_ch_free((void **)&sa);
+    slapi_ch_free((void **)&sb);
+    slapi_ch_free((void **)&su);
+    slapi_ch_free((void **)&si);
+}
+
+void
+test_plugin_back_ldbm_idl_bitmap_fold(void **state __attribute__((unused)))
+{
+    backend be = {0};
+    unsigned char *seen[3];
+    unsigned char *su = (unsigned char *)slapi_ch_calloc(IDL_BITMAP_TEST_RANGE + 1, 1);
+    unsigned char *si = (unsigned char *)slapi_ch_calloc(IDL_BITMAP_TEST_RANGE + 1, 1);
+    IDList *idls[3];
+    uint32_t seed = 31;
+
+    /*
+     * The smallest list is inserted first so that it ends up at the tail of
+     * the set: the intersection fold starts from it rather than from the head.
+     */
+    for (size_t i = 0; i < 3; i++) {
+        seen[i] = (unsigned char *)slapi_ch_calloc(IDL_BITMAP_TEST_RANGE + 1, 1);
+        idls[i] = idl_bitmap_test_make(seen[i], IDL_BITMAP_TEST_RANGE, 9 - 3 * i, &seed);
+    }
+    idl_compress(&idls[1]);
+    for (ID id = 1; id <= IDL_BITMAP_TEST_RANGE; id++) {
+        su[id] = seen[0][id] | seen[1][id] | seen[2][id];
+        si[id] = seen[0][id] & seen[1][id] & seen[2][id];
+    }
+
+    for (int intersect = 0; intersect < 2; intersect++) {
+        IDListSet *idl_set = idl_set_create();
+        IDList *r = NULL;
+
+        for (size_t i = 0; i < 3; i++) {
+            idl_set_insert_idl(idl_set, idl_dup(idls[i]));
+        }
+        slapi_be_unset_flag(&be, SLAPI_BE_FLAG_DONT_BYPASS_FILTERTEST);
+        r = intersect ? idl_set_intersect(idl_set, &be) : idl_set_union(idl_set, &be);
+        idl_bitmap_test_assert_ids(r, intersect ? si : su, IDL_BITMAP_TEST_RANGE);
+        idl_free(&r);
+        idl_set_destroy(idl_set);
+    }
+
+    for (size_t i = 0; i < 3; i++) {
+        idl_free(&idls[i]);
+        slapi_ch_free((void **)&seen[i]);
+    }
+    slapi_ch_free((void **)&su);
+    slapi_ch_free((void **)&si);
+}
+
+void
+test_plugin_back_ldbm_idl_bitmap_threshold(void **state __attribute__((unused)))
+{
+    unsigned char *seen = (unsigned char *)slapi_ch_calloc(IDL_BITMAP_TEST_RANGE + 1, 1);
+    uint32_t seed = 47;
+    IDList *idl = idl_bitmap_test_make(seen, IDL_BITMAP_TEST_RANGE, 13, &seed);
+    IDList *allids = idl_alloc(0);
+    int nids = (int)idl->b_nids;
+
+    allids->b_nmax = ALLIDSBLOCK;
+    allids->b_nids = 1000;
+
+    /* 0 disables the bitmaps, and a list at the threshold stays an array */
+    assert_int_equal(idl_compress_threshold(&idl, 0), 0);
+    assert_int_equal(idl_compress_threshold(&idl, nids), 0);
+    assert_false(IDL_BITMAP(idl));
+
+    /* one id past it the list is compressed, only once */
+    assert_int_equal(idl_compress_threshold(&idl, nids - 1), 1);
+    assert_true(IDL_BITMAP(idl));
+    assert_int_equal(idl->b_nids, (NIDS)nids);
+    assert_int_equal(idl_compress_threshold(&idl, nids - 1), 0);
+    idl_bitmap_test_assert_ids(idl, seen, IDL_BITMAP_TEST_RANGE);
+
+    /* ALLIDS is never compressed */
+    assert_int_equal(idl_compress_threshold(&allids, 1), 0);
+    assert_true(ALLIDS(allids));
+
+    idl_free(&idl);
+    idl_free(&allids);
+    slapi_ch_free((void **)&seen);
+}
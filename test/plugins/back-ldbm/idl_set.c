@@ -0,0 +1,211 @@
+/** BEGIN COPYRIGHT BLOCK
+ * Copyright (C) 2026 Red Hat, Inc.
+ * All rights reserved.
+ *
+ * License: GPL (version 3 or any later version).
+ * See LICENSE for details.
+ * END COPYRIGHT BLOCK **/
+
+#include "../../test_slapd.h"
+
+#include <back-ldbm.h>
+#include <time.h>
+
+/*
+ * Check that the k-way idl_set union and intersection give the same answer
+ * as folding the lists pairwise, over a few id distributions that resemble
+ * real filters: a wide OR of many tiny lists (member=...), a few lists of
+ * very different sizes (the galloping case), and a few dense lists. Each
+ * case is run with array lists and with every other list as a bitmap. The
+ * time spent in each path is printed so the merge strategies can be compared
+ * when changing this code.
+ */
+
+struct idl_set_case
+{
+    const char *name;
+    size_t k;
+    NIDS nids;
+    ID range;
+    int skewed;
+};
+
+static struct idl_set_case idl_set_cases[] = {
+    {"wide or", 500, 5, 200000, 0},
+    {"skewed", 5, 50, 200000, 1},
+    {"dense", 4, 60000, 100000, 0},
+};
+
+static uint64_t
+idl_set_test_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static IDList *
+idl_set_test_make(NIDS nids, ID range, uint32_t *seed)
+{
+    unsigned char *seen = (unsigned char *)slapi_ch_calloc(range + 1, 1);
+    IDList *idl = idl_alloc(nids);
+
+    for (NIDS i = 0; i < nids; i++) {
+        *seed = *seed * 1103515245 + 12345;
+        seen[1 + (*seed >> 8) % range] = 1;
+    }
+    for (ID id = 1; id <= range; id++) {
+        if (seen[id]) {
+            idl_append(idl, id);
+        }
+    }
+    slapi_ch_free((void **)&seen);
+    return idl;
+}
+
+static IDList *
+idl_set_test_copy(IDList *idl)
+{
+    IDList *copy = idl_alloc(idl_length(idl));
+    idl_iterator it = idl_iterator_init(idl);
+    ID id;
+
+    while ((id = idl_iterator_dereference_increment(&it, idl)) != NOID) {
+        idl_append(copy, id);
+    }
+    if (IDL_BITMAP(idl)) {
+        idl_compress(&copy);
+    }
+    return copy;
+}
+
+static void
+idl_set_test_assert_equal(IDList *a, IDList *b)
+{
+    ID ida;
+    ID idb;
+    idl_iterator ita = idl_iterator_init(a);
+    idl_iterator itb = idl_iterator_init(b);
+
+    do {
+        ida = idl_iterator_dereference_increment(&ita, a);
+        idb = idl_iterator_dereference_increment(&itb, b);
+        assert_int_equal(ida, idb);
+    } while (ida != NOID);
+}
+
+/*
+ * When the smallest list of an intersection is under FILTER_TEST_THRESHOLD
+ * idl_set returns it as is and relies on the filter test, so the exact answer
+ * only has to be contained in it.
+ */
+static void
+idl_set_test_assert_subset(IDList *exact, IDList *candidates)
+{
+    ID id;
+    idl_iterator it = idl_iterator_init(exact);
+
+    while ((id = idl_iterator_dereference_increment(&it, exact)) != NOID) {
+        assert_true(idl_id_is_in_idlist(candidates, id));
+    }
+}
+
+static IDList *
+idl_set_test_run(backend *be, IDList **idls, size_t k, int intersect, uint64_t *elapsed)
+{
+    IDListSet *idl_set = idl_set_create();
+    IDList *result = NULL;
+    uint64_t start;
+
+    for (size_t i = 0; i < k; i++) {
+        idl_set_insert_idl(idl_set, idl_set_test_copy(idls[i]));
+    }
+    start = idl_set_test_now();
+    result = intersect ? idl_set_intersect(idl_set, be) : idl_set_union(idl_set, be);
+    *elapsed = idl_set_test_now() - start;
+    idl_set_destroy(idl_set);
+    return result;
+}
+
+static IDList *
+idl_set_test_fold(backend *be, IDList **idls, size_t k, int intersect, uint64_t *elapsed)
+{
+    IDList *result = idl_set_test_copy(idls[0]);
+    uint64_t start = idl_set_test_now();
+
+    for (size_t i = 1; i < k; i++) {
+        IDList *tmp = intersect ? idl_intersection(be, result, idls[i]) : idl_union(be, result, idls[i]);
+        idl_free(&result);
+        result = tmp;
+    }
+    *elapsed = idl_set_test_now() - start;
+    return result;
+}
+
+void
+test_plugin_back_ldbm_idl_set(void **state __attribute__((unused)))
+{
+    backend be = {0};
+    uint32_t seed = 42;
+
+    for (size_t c = 0; c < sizeof(idl_set_cases) / sizeof(idl_set_cases[0]); c++) {
+        struct idl_set_case *tc = &idl_set_cases[c];
+
+        for (int bitmaps = 0; bitmaps < 2; bitmaps++) {
+            IDList **idls = (IDList **)slapi_ch_calloc(tc->k, sizeof(IDList *));
+
+            for (size_t i = 0; i < tc->k; i++) {
+                NIDS nids = (tc->skewed && i > 0) ? tc->nids * 200 * i : tc->nids;
+                idls[i] = idl_set_test_make(nids, tc->range, &seed);
+                if (bitmaps && (i % 2)) {
+                    idl_compress(&idls[i]);
+                }
+            }
+
+            for (int intersect = 0; intersect < 2; intersect++) {
+                uint64_t set_ns = 0;
+                uint64_t fold_ns = 0;
+                IDList *set = NULL;
+                IDList *fold = NULL;
+
+                slapi_be_unset_flag(&be, SLAPI_BE_FLAG_DONT_BYPASS_FILTERTEST);
+                set = idl_set_test_run(&be, idls, tc->k, intersect, &set_ns);
+                fold = idl_set_test_fold(&be, idls, tc->k, intersect, &fold_ns);
+                if (slapi_be_is_flag_set(&be, SLAPI_BE_FLAG_DONT_BYPASS_FILTERTEST)) {
+                    idl_set_test_assert_subset(fold, set);
+                } else {
+                    idl_set_test_assert_equal(set, fold);
+                }
+                printf("idl_set %-8s %-9s bitmaps=%d k=%zu ids=%lu: set %" PRIu64 "us pairwise %" PRIu64 "us\n",
+                       tc->name, intersect ? "intersect" : "union", bitmaps, tc->k,
+                       (unsigned long)idl_length(set), set_ns / 1000, fold_ns / 1000);
+                idl_free(&set);
+                idl_free(&fold);
+            }
+
+            for (size_t i = 0; i < tc->k; i++) {
+                idl_free(&idls[i]);
+            }
+            slapi_ch_free((void **)&idls);
+        }
+    }
+}
+
+void
+test_plugin_back_ldbm_idl_gallop(void **state __attribute__((unused)))
+{
+    uint32_t seed = 7;
+    IDList *idl = idl_set_test_make(1000, 5000, &seed);
+
+    /* idl_gallop must agree with a linear scan from every starting point */
+    for (ID id = 0; id < 5100; id += 3) {
+        for (NIDS start = 0; start < idl->b_nids; start += 37) {
+            NIDS expect = start;
+            while (expect < idl->b_nids && idl->b_ids[expect] < id) {
+                expect++;
+            }
+            assert_int_equal(idl_gallop(idl, start, id), expect);
+        }
+    }
+    idl_free(&idl);
+}
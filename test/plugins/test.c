@@ -26,6 +26,13 @@ run_plugin_tests(void)
         cmocka_unit_test_setup_teardown(test_plugin_pwdstorage_pbkdf2_rounds,
                                         test_plugin_pwdstorage_nss_setup,
                                         test_plugin_pwdstorage_nss_stop),
+        cmocka_unit_test(test_plugin_back_ldbm_idl_set),
+        cmocka_unit_test(test_plugin_back_ldbm_idl_gallop),
+        cmocka_unit_test(test_plugin_back_ldbm_idl_bitmap_iterate),
+        cmocka_unit_test(test_plugin_back_ldbm_idl_bitmap_ops),
+        cmocka_unit_test(test_plugin_back_ldbm_idl_bitmap_fold),
+        cmocka_unit_test(test_plugin_back_ldbm_idl_bitmap_threshold),
+        cmocka_unit_test(test_plugin_back_ldbm_cache_shared),
     };
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
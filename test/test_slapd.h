@@ -95,3 +95,19 @@ int test_plugin_pwdstorage_nss_stop(void **state);
 
 void test_plugin_pwdstorage_pbkdf2_auth(void **state);
 void test_plugin_pwdstorage_pbkdf2_rounds(void **state);
+
+/* plugin-back-ldbm-idl-set */
+
+void test_plugin_back_ldbm_idl_set(void **state);
+void test_plugin_back_ldbm_idl_gallop(void **state);
+
+/* plugin-back-ldbm-idl-bitmap */
+
+void test_plugin_back_ldbm_idl_bitmap_iterate(void **state);
+void test_plugin_back_ldbm_idl_bitmap_ops(void **state);
+void test_plugin_back_ldbm_idl_bitmap_fold(void **state);
+void test_plugin_back_ldbm_idl_bitmap_threshold(void **state);
+
+/* plugin-back-ldbm-cache */
+
+void test_plugin_back_ldbm_cache_shared(void **state);